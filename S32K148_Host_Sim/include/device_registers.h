@@ -0,0 +1,87 @@
+/*
+** ###################################################################
+**     Abstract:
+**         Host build replacement for the common include file of the
+**         CMSIS register access layer headers.
+**
+**     Copyright (c) 2015 Freescale Semiconductor, Inc.
+**     Copyright 2016-2018 NXP
+**     All rights reserved.
+**
+**     THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+**     IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+**     OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+**     IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+**     INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+**     (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+**     SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+**     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+**     STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+**     IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+**     THE POSSIBILITY OF SUCH DAMAGE.
+**
+**     http:                 www.nxp.com
+**     mail:                 support@nxp.com
+** ###################################################################
+*/
+
+#ifndef DEVICE_REGISTERS_H
+#define DEVICE_REGISTERS_H
+
+/*
+ * This header shadows include/device_registers.h of a cookbook project when it is built with
+ * S32K148_Host_Sim/Makefile. The project's own S32K148.h is used unmodified: the simulator maps
+ * host memory at the peripheral base addresses, so only the Cortex-M4 instruction macros of
+ * s32_core_cm4.h need a host implementation.
+ */
+
+#if (defined(CPU_S32K148) )
+
+    #define S32K14x_SERIES
+
+    /* Specific core definitions */
+    #include "s32_core_cm4.h"
+
+    #if defined(CPU_S32K148)
+
+        #define S32K148_SERIES
+
+        /* Register definitions */
+        #include "S32K148.h"
+        /* CPU specific feature definitions */
+        #include "S32K148_features.h"
+    #endif
+
+#else
+    #error "No valid CPU defined!"
+#endif
+
+#if !defined(__x86_64__) || !defined(__linux__)
+    #error "The S32K148 host simulator supports x86-64 Linux hosts only"
+#endif
+
+#include "sim.h"
+
+/* Cortex-M4 instructions routed to the simulator core */
+#undef  BKPT_ASM
+#define BKPT_ASM                SIM_stop(3)
+#undef  ENABLE_INTERRUPTS
+#define ENABLE_INTERRUPTS()     SIM_irq_enable()
+#undef  DISABLE_INTERRUPTS
+#define DISABLE_INTERRUPTS()    SIM_irq_disable()
+#undef  STANDBY
+#define STANDBY()               SIM_wait_for_interrupt()
+#undef  NOP
+#define NOP()                   __asm volatile ("nop")
+#undef  REV_BYTES_32
+#define REV_BYTES_32(a, b)      ((b) = __builtin_bswap32((uint32_t)(a)))
+#undef  REV_BYTES_16
+#define REV_BYTES_16(a, b)      ((b) = (((uint32_t)(a) & 0xFF00FF00u) >> 8u) | (((uint32_t)(a) & 0x00FF00FFu) << 8u))
+
+#include "devassert.h"
+
+#endif /* DEVICE_REGISTERS_H */
+
+/*******************************************************************************
+ * EOF
+ ******************************************************************************/
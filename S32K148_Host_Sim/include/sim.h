@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+/*!
+ * Host peripheral simulator
+ * =============================================================================================
+ * The register blocks of S32K148.h are mapped into host memory at their real bus addresses, so
+ * CAN0, DMA, ADC0, LPUART1 and the rest of the instance macros resolve unchanged. Every page of
+ * the peripheral space is kept inaccessible: each driver access faults, is single stepped and
+ * handed to the behavioral model of the peripheral, which applies the write-1-to-clear,
+ * clear-on-read and command register semantics of the device and schedules its side effects
+ * (COCO after the conversion time, TDRE/RDRF per character, FRZACK handshakes, DMA minor loops,
+ * interrupts through the NVIC model).
+ *
+ * Time is counted in bus clock cycles. Each register access costs SIM_CYCLES_PER_ACCESS and a
+ * polling loop that keeps reading the same unchanged register is fast forwarded to the next
+ * scheduled model event, so busy-wait drivers run at host speed. A loop spinning on a RAM flag
+ * is fast forwarded the same way; other code running from RAM costs no time. Simulated time
+ * only depends on what the application does, never on the host clock, so a run is repeatable.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef SIM_BUS_CLOCK_HZ
+#define SIM_BUS_CLOCK_HZ		(40000000u)		/* BUS_CLK of the cookbook clock setup (NormalRUNmode_80MHz) */
+#endif
+
+#ifndef SIM_CYCLES_PER_ACCESS
+#define SIM_CYCLES_PER_ACCESS	(2u)			/* Bus cycles charged for one peripheral register access */
+#endif
+
+#ifndef SIM_RUN_MS
+#define SIM_RUN_MS				(1000u)			/* Simulated time after which the application is stopped */
+#endif
+
+#define SIM_MS_TO_CYCLES(ms)	((uint64_t)(ms) * (SIM_BUS_CLOCK_HZ / 1000u))
+#define SIM_US_TO_CYCLES(us)	((uint64_t)(us) * (SIM_BUS_CLOCK_HZ / 1000000u))
+
+/*!
+* @brief Access counters kept by the simulator core.
+*/
+typedef struct
+{
+	uint64_t reads;				/* Peripheral register reads trapped */
+	uint64_t writes;			/* Peripheral register writes trapped */
+	uint64_t polls_skipped;		/* Polling reads fast forwarded to the next event */
+	uint64_t irqs;				/* Interrupt handlers entered */
+	uint64_t dma_minor_loops;	/* eDMA minor loops executed */
+	uint64_t dma_bytes;			/* Bytes moved by the eDMA engine */
+} sim_stats_t;
+
+/* Core */
+void		SIM_init				(void);
+uint64_t	SIM_cycles				(void);
+void		SIM_advance				(uint64_t cycles);
+void		SIM_stats				(sim_stats_t *stats);
+void		SIM_report				(FILE *out);
+void		SIM_stop				(int status);
+
+/* Core interrupt masking used by ENABLE_INTERRUPTS / DISABLE_INTERRUPTS / STANDBY on the host */
+void		SIM_irq_enable			(void);
+void		SIM_irq_disable			(void);
+void		SIM_wait_for_interrupt	(void);
+
+/* Stimulus and observation hooks of the behavioral models */
+void		SIM_ADC_set_source		(uint16_t (*source)(uint8_t instance, uint8_t channel, uint64_t cycles));
+void		SIM_GPIO_set_input		(uint8_t port, uint8_t pin, uint8_t level);
+void		SIM_LPUART_inject		(uint8_t instance, const uint8_t *data, uint32_t length);
+void		SIM_LPUART_set_tx_hook	(void (*hook)(uint8_t instance, uint8_t data));
+void		SIM_LPSPI_set_device	(uint8_t instance, uint32_t (*transfer)(uint8_t instance, uint8_t pcs, uint32_t tx, uint8_t bits));
+void		SIM_NOR_attach			(uint8_t instance, uint8_t pcs, uint8_t *memory, uint32_t size);
+void		SIM_SAI_set_device		(uint32_t (*codec)(uint8_t instance, uint8_t line, uint8_t slot, const uint32_t *tx));
+void		SIM_CAN_inject			(uint8_t instance, uint32_t id, uint8_t extended, uint8_t dlc, uint8_t fd, const uint32_t *payload);
+void		SIM_CAN_set_tx_hook		(void (*hook)(uint8_t instance, uint32_t id, uint8_t dlc, const uint32_t *payload));
+
+#endif /* SIM_H_ */
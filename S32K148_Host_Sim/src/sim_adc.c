@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim_internal.h"
+
+/*!
+ * ADC model
+ * ===================================================
+ * Software trigger mode converts on a write to SC1[0] (continuously with SC3[ADCO]), hardware
+ * trigger mode converts the SC1[n] each PDB pre-trigger selects, in arrival order. The result
+ * comes from the stimulus registered with SIM_ADC_set_source, is scaled to CFG1[MODE], checked
+ * against the compare function (SC2[ACFE/ACFGT/ACREN], CV1/CV2) and latched into R[n] with
+ * COCO, which reading R[n] clears. Conversion time follows the PCC clock, CFG1[ADIV],
+ * CFG2[SMPLTS] and the hardware average of SC3.
+ */
+
+#define SIM_ADC_COUNT			(2u)
+#define SIM_ADC_CHANNELS		(32u)		/* SC1A..SC1AF: SC1[0..15] and aSC1[0..15] */
+#define SIM_ADC_QUEUE			(32u)
+#define SIM_ADC_CAL_ADCK		(14000u)	/* Calibration sequence length in ADC clocks */
+
+typedef struct
+{
+	uint8_t  queue[SIM_ADC_QUEUE];			/* Hardware triggered SC1 indexes waiting */
+	uint8_t  head;
+	uint8_t  count;
+	int16_t  active;						/* SC1 index being converted, -1 when idle */
+	bool     warned;
+} sim_adc_t;
+
+static ADC_Type * const adcs[SIM_ADC_COUNT] = ADC_BASE_PTRS;
+static const IRQn_Type adc_irqs[SIM_ADC_COUNT] = ADC_IRQS;
+static const uint32_t adc_pcc[SIM_ADC_COUNT] = { PCC_ADC0_INDEX, PCC_ADC1_INDEX };
+static sim_adc_t state[SIM_ADC_COUNT];
+static uint16_t (*source)(uint8_t instance, uint8_t channel, uint64_t cycles);
+
+/*!
+* @brief Default stimulus: a 12-bit triangle wave of about 200 ms per period, phase shifted
+* per channel so different inputs read different values.
+*/
+static uint16_t default_source(uint8_t instance, uint8_t channel, uint64_t cycles)
+{
+	uint32_t t = (uint32_t)((cycles / SIM_US_TO_CYCLES(25) + channel * 512u + instance * 256u) % 8190u);
+	return (uint16_t)((t < 4095u) ? t : 8190u - t);
+}
+
+void SIM_ADC_set_source(uint16_t (*fn)(uint8_t instance, uint8_t channel, uint64_t cycles))
+{
+	source = (fn != NULL) ? fn : default_source;
+}
+
+static volatile uint32_t *sc1_of(ADC_Type *adc, uint8_t n)
+{
+	return (n < ADC_SC1_COUNT) ? &adc->SC1[n] : &adc->aSC1[n - ADC_SC1_COUNT];
+}
+
+static volatile uint32_t *r_of(ADC_Type *adc, uint8_t n)
+{
+	return (n < ADC_R_COUNT) ? (volatile uint32_t *)&adc->R[n] : (volatile uint32_t *)&adc->aR[n - ADC_R_COUNT];
+}
+
+/*!
+* @brief Bus cycles for count ADC clocks, 0 when the ADC has no functional clock.
+*/
+static uint64_t adck_to_cycles(uint8_t instance, uint64_t count)
+{
+	ADC_Type *adc = SIM_VIEW(adcs[instance]);
+	uint32_t hz = sim_pcc_clock_hz(adc_pcc[instance]) >> ((adc->CFG1 & ADC_CFG1_ADIV_MASK) >> ADC_CFG1_ADIV_SHIFT);
+
+	if (hz == 0u)
+	{
+		if (!state[instance].warned)
+		{
+			fprintf(stderr, "sim: ADC%u has no functional clock (PCC)\n", instance);
+			state[instance].warned = true;
+		}
+		return 0;
+	}
+	return (count * SIM_BUS_CLOCK_HZ + hz - 1u) / hz;
+}
+
+static bool compare_ok(ADC_Type *adc, uint32_t result)
+{
+	uint32_t sc2 = adc->SC2;
+	uint32_t cv1 = adc->CV[0];
+	uint32_t cv2 = adc->CV[1];
+	bool gt = (sc2 & ADC_SC2_ACFGT_MASK) != 0u;
+
+	if (!(sc2 & ADC_SC2_ACFE_MASK))
+	{
+		return true;
+	}
+	if (!(sc2 & ADC_SC2_ACREN_MASK))
+	{
+		return gt ? (result >= cv1) : (result < cv1);
+	}
+	if (cv1 <= cv2)
+	{
+		return gt ? ((result >= cv1) && (result <= cv2)) : ((result < cv1) || (result > cv2));
+	}
+	return gt ? ((result >= cv1) || (result <= cv2)) : ((result < cv1) && (result > cv2));
+}
+
+static void convert_done(uint32_t arg);
+
+static void convert_start(uint8_t instance, uint8_t n)
+{
+	ADC_Type *adc = SIM_VIEW(adcs[instance]);
+	uint32_t mode = (adc->CFG1 & ADC_CFG1_MODE_MASK) >> ADC_CFG1_MODE_SHIFT;
+	uint32_t adck = ((adc->CFG2 & ADC_CFG2_SMPLTS_MASK) >> ADC_CFG2_SMPLTS_SHIFT) + 1u
+				  + ((mode == 0u) ? 15u : (mode == 2u) ? 17u : 20u);
+	uint64_t cycles;
+
+	if (adc->SC3 & ADC_SC3_AVGE_MASK)
+	{
+		adck <<= 2u + ((adc->SC3 & ADC_SC3_AVGS_MASK) >> ADC_SC3_AVGS_SHIFT);	/* 4, 8, 16 or 32 samples */
+	}
+	cycles = adck_to_cycles(instance, adck);
+	state[instance].active = n;
+	adc->SC2 |= ADC_SC2_ADACT_MASK;
+	if (cycles != 0u)
+	{
+		sim_schedule(cycles, convert_done, ((uint32_t)instance << 8) | n);
+	}
+}
+
+static void next_trigger(uint8_t instance)
+{
+	sim_adc_t *s = &state[instance];
+	if (s->count != 0u)
+	{
+		uint8_t n = s->queue[s->head];
+		s->head = (uint8_t)((s->head + 1u) % SIM_ADC_QUEUE);
+		s->count--;
+		convert_start(instance, n);
+	}
+}
+
+static void convert_done(uint32_t arg)
+{
+	uint8_t   instance = (uint8_t)(arg >> 8);
+	uint8_t   n = (uint8_t)arg;
+	ADC_Type *adc = SIM_VIEW(adcs[instance]);
+	volatile uint32_t *sc1 = sc1_of(adc, n);
+	uint8_t   channel = (uint8_t)(*sc1 & ADC_SC1_ADCH_MASK);
+	uint32_t  mode = (adc->CFG1 & ADC_CFG1_MODE_MASK) >> ADC_CFG1_MODE_SHIFT;
+	int32_t   result = (int32_t)(source(instance, channel, sim_now()) & 0xFFFu);
+
+	result -= (int8_t)(adc->USR_OFS & 0xFFu);							/* User offset, two's complement */
+	result = (result < 0) ? 0 : (result > 0xFFF) ? 0xFFF : result;
+	result >>= (mode == 0u) ? 4u : (mode == 2u) ? 2u : 0u;				/* 8, 12 or 10-bit */
+
+	state[instance].active = -1;
+	adc->SC2 &= ~ADC_SC2_ADACT_MASK;
+
+	if (compare_ok(adc, (uint32_t)result))
+	{
+		*r_of(adc, n) = (uint32_t)result;
+		*sc1 |= ADC_SC1_COCO_MASK;
+		if (*sc1 & ADC_SC1_AIEN_MASK)
+		{
+			sim_irq_raise(adc_irqs[instance]);
+		}
+		if (adc->SC2 & ADC_SC2_DMAEN_MASK)
+		{
+			sim_dma_request((uint8_t)(EDMA_REQ_ADC0 + instance));
+		}
+	}
+
+	if (adc->SC2 & ADC_SC2_ADTRG_MASK)
+	{
+		next_trigger(instance);
+	}
+	else if ((adc->SC3 & ADC_SC3_ADCO_MASK) && ((*sc1 & ADC_SC1_ADCH_MASK) != ADC_SC1_ADCH_MASK))
+	{
+		convert_start(instance, 0);										/* Continuous conversion */
+	}
+}
+
+static void calibration_done(uint32_t instance)
+{
+	ADC_Type *adc = SIM_VIEW(adcs[instance]);
+
+	adc->SC3 &= ~ADC_SC3_CAL_MASK;
+	adc->CLPS = 0x2Au;													/* Typical calibration results */
+	adc->CLP3 = 0x1A4u;
+	adc->CLP2 = 0xD2u;
+	adc->CLP1 = 0x69u;
+	adc->CLP0 = 0x35u;
+	adc->CLPX = 0x0u;
+	adc->CLP9 = 0x0u;
+	adc->SC1[0] |= ADC_SC1_COCO_MASK;
+	if (adc->SC1[0] & ADC_SC1_AIEN_MASK)
+	{
+		sim_irq_raise(adc_irqs[instance]);
+	}
+}
+
+void sim_adc_trigger(uint8_t instance, uint8_t sc1)
+{
+	ADC_Type  *adc = SIM_VIEW(adcs[instance]);
+	sim_adc_t *s = &state[instance];
+
+	if (!(adc->SC2 & ADC_SC2_ADTRG_MASK) || ((*sc1_of(adc, sc1) & ADC_SC1_ADCH_MASK) == ADC_SC1_ADCH_MASK))
+	{
+		return;
+	}
+	if (s->count < SIM_ADC_QUEUE)
+	{
+		s->queue[(s->head + s->count) % SIM_ADC_QUEUE] = sc1;
+		s->count++;
+	}
+	if (s->active < 0)
+	{
+		next_trigger(instance);
+	}
+}
+
+void sim_adc_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	ADC_Type  *adc = SIM_VIEW(adcs[instance]);
+	sim_adc_t *s = &state[instance];
+	int16_t   n = -1;
+
+	if (offset < 0x40u)
+	{
+		n = (int16_t)(offset >> 2);
+	}
+	else if ((offset >= 0x108u) && (offset < 0x148u))
+	{
+		n = (int16_t)(ADC_SC1_COUNT + ((offset - 0x108u) >> 2));
+	}
+
+	if (n >= 0)
+	{
+		/* A write to SC1n clears its COCO and aborts the conversion in progress on it */
+		*sc1_of(adc, (uint8_t)n) = new_word & ~ADC_SC1_COCO_MASK;
+		if (s->active == n)
+		{
+			sim_cancel(convert_done, ((uint32_t)instance << 8) | (uint32_t)n);
+			s->active = -1;
+			adc->SC2 &= ~ADC_SC2_ADACT_MASK;
+		}
+		if ((n == 0) && !(adc->SC2 & ADC_SC2_ADTRG_MASK) && ((new_word & ADC_SC1_ADCH_MASK) != ADC_SC1_ADCH_MASK))
+		{
+			if (s->active >= 0)
+			{
+				sim_cancel(convert_done, ((uint32_t)instance << 8) | (uint32_t)s->active);
+			}
+			convert_start(instance, 0);
+		}
+	}
+	else if (offset == 0x90u)												/* SC2: ADACT is status */
+	{
+		adc->SC2 = (new_word & ~ADC_SC2_ADACT_MASK) | (old_word & ADC_SC2_ADACT_MASK);
+		if (!(new_word & ADC_SC2_ADTRG_MASK))
+		{
+			s->count = 0;
+		}
+	}
+	else if (offset == 0x94u)												/* SC3 */
+	{
+		if ((new_word & ADC_SC3_CAL_MASK) && !(old_word & ADC_SC3_CAL_MASK))
+		{
+			uint64_t cycles = adck_to_cycles(instance, SIM_ADC_CAL_ADCK);
+			adc->SC1[0] &= ~ADC_SC1_COCO_MASK;
+			if (cycles != 0u)
+			{
+				sim_schedule(cycles, calibration_done, instance);
+			}
+		}
+	}
+}
+
+void sim_adc_read(uint8_t instance, uint32_t offset)
+{
+	ADC_Type *adc = SIM_VIEW(adcs[instance]);
+
+	if ((offset >= 0x48u) && (offset < 0x88u))
+	{
+		*sc1_of(adc, (uint8_t)((offset - 0x48u) >> 2)) &= ~ADC_SC1_COCO_MASK;
+	}
+	else if ((offset >= 0x188u) && (offset < 0x1C8u))
+	{
+		*sc1_of(adc, (uint8_t)(ADC_SC1_COUNT + ((offset - 0x188u) >> 2))) &= ~ADC_SC1_COCO_MASK;
+	}
+}
+
+void sim_adc_reset(void)
+{
+	uint8_t instance;
+	uint8_t n;
+
+	if (source == NULL)
+	{
+		source = default_source;
+	}
+	for (instance = 0; instance < SIM_ADC_COUNT; instance++)
+	{
+		ADC_Type *adc = SIM_VIEW(adcs[instance]);
+		for (n = 0; n < SIM_ADC_CHANNELS; n++)
+		{
+			*sc1_of(adc, n) = ADC_SC1_ADCH_MASK;							/* Module disabled */
+		}
+		adc->CFG2 = ADC_CFG2_SMPLTS(12);
+		adc->UG   = 0x4u;
+		adc->G    = 0x2F0u;
+		state[instance].active = -1;
+		state[instance].count  = 0;
+		state[instance].head   = 0;
+		state[instance].warned = false;
+	}
+}
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim_internal.h"
+
+/*!
+ * SCG, PCC, SMC, SIM and WDOG models
+ * ===================================================
+ * Oscillators and the SPLL report VLD a short start-up time after being enabled, RCCR is
+ * mirrored to CSR (the system clock switch), SMC reports the requested run mode, a rising
+ * SIM_MISCTRL1[SW_TRG] pulses the TRGMUX SIM_SW_TRIG source and the watchdog enforces its
+ * timeout and window on the simulated LPO/bus clock.
+ */
+
+#define SIM_OSC_STARTUP		SIM_US_TO_CYCLES(20)		/* Start-up time of SOSC, SIRC, FIRC and SPLL */
+#define SIM_LPO_HZ			(128000u)
+#define SIM_WDOG_UNLOCK		(0xD928C520u)
+#define SIM_WDOG_REFRESH	(0xB480A602u)
+
+enum
+{
+	SCG_CSR_OFFSET     = 0x010u,
+	SCG_RCCR_OFFSET    = 0x014u,
+	SCG_SOSCCSR_OFFSET = 0x100u,
+	SCG_SIRCCSR_OFFSET = 0x200u,
+	SCG_FIRCCSR_OFFSET = 0x300u,
+	SCG_SPLLCSR_OFFSET = 0x600u
+};
+
+static uint64_t wdog_refreshed;
+
+/*!
+* @brief Oscillator start-up complete: arg is the CSR offset inside SCG.
+*/
+static void scg_valid(uint32_t offset)
+{
+	volatile uint32_t *csr = (volatile uint32_t *)((uint8_t *)SIM_VIEW(SCG) + offset);
+	if (*csr & 1u)												/* xxxEN is bit 0 for every source */
+	{
+		*csr |= SCG_SOSCCSR_SOSCVLD_MASK;						/* xxxVLD is bit 24 for every source */
+	}
+}
+
+void sim_scg_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	SCG_Type *scg = SIM_VIEW(SCG);
+	(void)instance;
+
+	switch (offset)
+	{
+		case SCG_RCCR_OFFSET:
+			SIM_RO(scg->CSR) = new_word;								/* Clock switch completes immediately */
+			break;
+		case SCG_SOSCCSR_OFFSET:
+		case SCG_SIRCCSR_OFFSET:
+		case SCG_FIRCCSR_OFFSET:
+		case SCG_SPLLCSR_OFFSET:
+		{
+			volatile uint32_t *csr = (volatile uint32_t *)((uint8_t *)scg + offset);
+			*csr = (new_word & ~SCG_SOSCCSR_SOSCVLD_MASK) | (old_word & SCG_SOSCCSR_SOSCVLD_MASK);
+			if (!(new_word & 1u))
+			{
+				*csr &= ~SCG_SOSCCSR_SOSCVLD_MASK;				/* Disabled source is no longer valid */
+			}
+			else if (!(old_word & SCG_SOSCCSR_SOSCVLD_MASK))
+			{
+				sim_schedule(SIM_OSC_STARTUP, scg_valid, offset);
+			}
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+void sim_smc_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	SMC_Type *smc = SIM_VIEW(SMC);
+	(void)instance;
+	(void)old_word;
+
+	if (offset == 0x0Cu)										/* PMCTRL */
+	{
+		switch ((new_word & SMC_PMCTRL_RUNM_MASK) >> SMC_PMCTRL_RUNM_SHIFT)
+		{
+			case 2u:  SIM_RO(smc->PMSTAT) = 0x04u; break;				/* VLPR */
+			case 3u:  SIM_RO(smc->PMSTAT) = 0x80u; break;				/* HSRUN */
+			default:  SIM_RO(smc->PMSTAT) = 0x01u; break;				/* RUN */
+		}
+	}
+}
+
+void sim_misc_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	(void)instance;
+
+	if ((offset == 0x6Cu) && (new_word & ~old_word & SIM_MISCTRL1_SW_TRG_MASK))	/* MISCTRL1 */
+	{
+		sim_trgmux_pulse(TRGMUX_TRIG_SOURCE_SIM_SW_TRIG);
+	}
+}
+
+/*!
+* @brief Watchdog timeout period in bus cycles for the current CS/TOVAL setting.
+*/
+static uint64_t wdog_cycles(uint32_t value)
+{
+	WDOG_Type *wdog = SIM_VIEW(WDOG);
+	uint64_t ticks = (uint64_t)value * ((wdog->CS & WDOG_CS_PRES_MASK) ? 256u : 1u);
+
+	switch ((wdog->CS & WDOG_CS_CLK_MASK) >> WDOG_CS_CLK_SHIFT)
+	{
+		case 0u:  return ticks;									/* Bus clock */
+		case 1u:  return ticks * (SIM_BUS_CLOCK_HZ / SIM_LPO_HZ);	/* LPO 128 kHz */
+		default:  return ticks * (SIM_BUS_CLOCK_HZ / 8000000u);	/* SIRC / SOSC 8 MHz */
+	}
+}
+
+static void wdog_reset(uint32_t arg)
+{
+	(void)arg;
+	fprintf(stderr, "sim: watchdog reset\n");
+	SIM_stop(5);
+}
+
+static void wdog_timeout(uint32_t arg)
+{
+	WDOG_Type *wdog = SIM_VIEW(WDOG);
+	(void)arg;
+
+	wdog->CS |= WDOG_CS_FLG_MASK;
+	if (wdog->CS & WDOG_CS_INT_MASK)
+	{
+		sim_irq_raise(WDOG_EWM_IRQn);
+		sim_schedule(SIM_MS_TO_CYCLES(4), wdog_reset, 0);		/* RCM reset delay before the reset */
+	}
+	else
+	{
+		wdog_reset(0);
+	}
+}
+
+static void wdog_restart(void)
+{
+	WDOG_Type *wdog = SIM_VIEW(WDOG);
+	sim_cancel(wdog_timeout, 0);
+	wdog_refreshed = sim_now();
+	if (wdog->CS & WDOG_CS_EN_MASK)
+	{
+		sim_schedule(wdog_cycles(wdog->TOVAL), wdog_timeout, 0);
+	}
+}
+
+void sim_wdog_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	WDOG_Type *wdog = SIM_VIEW(WDOG);
+	(void)instance;
+
+	switch (offset)
+	{
+		case 0x0u:												/* CS */
+			wdog->CS = (SIM_W1C(old_word, new_word, WDOG_CS_FLG_MASK) | WDOG_CS_RCS_MASK) & ~WDOG_CS_ULK_MASK;
+			wdog_restart();
+			break;
+		case 0x4u:												/* CNT */
+			if (new_word == SIM_WDOG_UNLOCK)
+			{
+				wdog->CS |= WDOG_CS_ULK_MASK;
+			}
+			else if (new_word == SIM_WDOG_REFRESH)
+			{
+				if ((wdog->CS & WDOG_CS_WIN_MASK) && (sim_now() - wdog_refreshed < wdog_cycles(wdog->WIN)))
+				{
+					fprintf(stderr, "sim: watchdog refreshed inside the closed window\n");
+					wdog_reset(0);
+				}
+				wdog_restart();
+			}
+			wdog->CNT = 0;
+			break;
+		default:
+			break;
+	}
+}
+
+/*!
+* @brief Frequency of the asynchronous (DIV2) clock a PCC entry selects, 0 when gated or off.
+*/
+uint32_t sim_pcc_clock_hz(uint32_t pcc_index)
+{
+	SCG_Type *scg = SIM_VIEW(SCG);
+	PCC_Type *pcc = SIM_VIEW(PCC);
+	uint32_t  entry = pcc->PCCn[pcc_index];
+	uint32_t  source_hz;
+	uint32_t  div;
+
+	if (!(entry & PCC_PCCn_CGC_MASK))
+	{
+		return 0;
+	}
+	switch ((entry & PCC_PCCn_PCS_MASK) >> PCC_PCCn_PCS_SHIFT)
+	{
+		case 1u:												/* SOSCDIV2 */
+			source_hz = (scg->SOSCCSR & SCG_SOSCCSR_SOSCVLD_MASK) ? 8000000u : 0u;
+			div = (scg->SOSCDIV & SCG_SOSCDIV_SOSCDIV2_MASK) >> SCG_SOSCDIV_SOSCDIV2_SHIFT;
+			break;
+		case 2u:												/* SIRCDIV2 */
+			source_hz = (scg->SIRCCSR & SCG_SIRCCSR_SIRCVLD_MASK) ? 8000000u : 0u;
+			div = (scg->SIRCDIV & SCG_SIRCDIV_SIRCDIV2_MASK) >> SCG_SIRCDIV_SIRCDIV2_SHIFT;
+			break;
+		case 3u:												/* FIRCDIV2 */
+			source_hz = (scg->FIRCCSR & SCG_FIRCCSR_FIRCVLD_MASK) ? 48000000u : 0u;
+			div = (scg->FIRCDIV & SCG_FIRCDIV_FIRCDIV2_MASK) >> SCG_FIRCDIV_FIRCDIV2_SHIFT;
+			break;
+		case 6u:												/* SPLLDIV2, SOSC reference */
+			source_hz = (scg->SPLLCSR & SCG_SPLLCSR_SPLLVLD_MASK)
+					  ? 8000000u / (((scg->SPLLCFG & SCG_SPLLCFG_PREDIV_MASK) >> SCG_SPLLCFG_PREDIV_SHIFT) + 1u)
+					    * (((scg->SPLLCFG & SCG_SPLLCFG_MULT_MASK) >> SCG_SPLLCFG_MULT_SHIFT) + 16u) / 2u
+					  : 0u;
+			div = (scg->SPLLDIV & SCG_SPLLDIV_SPLLDIV2_MASK) >> SCG_SPLLDIV_SPLLDIV2_SHIFT;
+			break;
+		default:
+			return 0;
+	}
+	return (div == 0u) ? 0u : source_hz >> (div - 1u);
+}
+
+void sim_clocks_reset(void)
+{
+	SCG_Type  *scg  = SIM_VIEW(SCG);
+	PCC_Type  *pcc  = SIM_VIEW(PCC);
+	SMC_Type  *smc  = SIM_VIEW(SMC);
+	WDOG_Type *wdog = SIM_VIEW(WDOG);
+	uint32_t i;
+
+	SIM_RO(scg->CSR) = SCG_CSR_SCS(3);								/* FIRC is the reset system clock */
+	scg->RCCR    = SCG_RCCR_SCS(3);
+	scg->SIRCCSR = SCG_SIRCCSR_SIRCEN_MASK | SCG_SIRCCSR_SIRCVLD_MASK;
+	scg->FIRCCSR = SCG_FIRCCSR_FIRCEN_MASK | SCG_FIRCCSR_FIRCVLD_MASK;
+
+	for (i = 0; i < PCC_PCCn_COUNT; i++)
+	{
+		pcc->PCCn[i] = PCC_PCCn_PR_MASK;						/* Every module present */
+	}
+
+	SIM_RO(smc->PMSTAT) = 0x01u;										/* RUN */
+
+	wdog->CS     = 0x00002100u;									/* Disabled by SystemInit() (DISABLE_WDOG) */
+	wdog->TOVAL  = 0x0000FFFFu;
+	wdog->WIN    = 0;
+	wdog_restart();
+}
@@ -0,0 +1,676 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "sim_internal.h"
+
+#define SIM_PAGE_SIZE		(0x1000u)
+#define SIM_TRAP_FLAG		(0x100u)				/* EFLAGS.TF: single step the faulting instruction */
+#define SIM_EVENT_COUNT		(64u)
+#define SIM_POLL_DEPTH		(8u)					/* Distinct registers a polling loop may read */
+#define SIM_POLL_REPEATS	(2u)					/* Same value read again this often: a polling loop */
+#define SIM_IDLE_QUANTUM	SIM_MS_TO_CYCLES(1)		/* Time skipped when nothing is scheduled */
+
+/*!
+ * Memory regions of the S32K148 peripheral space
+ * ===================================================
+ * Each region is a memfd mapped twice: the bus view at the device address (kept PROT_NONE so
+ * every driver access traps) and the model view, which the behavioral models use freely.
+ */
+typedef struct
+{
+	uint32_t base;
+	uint32_t size;
+	uint8_t *model;
+} sim_region_t;
+
+static sim_region_t regions[] =
+{
+	{ 0x40000000u, 0x00080000u, NULL },		/* AIPS peripherals (DMA ... RCM) */
+	{ 0x400FF000u, 0x00001000u, NULL },		/* GPIO PTA-PTE */
+	{ 0xE0000000u, 0x00100000u, NULL },		/* Private peripheral bus (DWT, SysTick, NVIC, SCB, MCM) */
+	{ SIM_FLASH_BASE, SIM_FLASH_SIZE, NULL },	/* Upper P-Flash block, written through the FTFC */
+};
+
+#define SIM_REGION_COUNT	(sizeof(regions) / sizeof(regions[0]))
+
+static const sim_block_t blocks[] =
+{
+	{ DMA_BASE,       0x2000u, 0u, sim_dma_write,     NULL },
+	{ DMAMUX_BASE,    0x1000u, 0u, sim_dmamux_write,  NULL },
+	{ CAN0_BASE,      0x1000u, 0u, sim_flexcan_write, sim_flexcan_read },
+	{ CAN1_BASE,      0x1000u, 1u, sim_flexcan_write, sim_flexcan_read },
+	{ ADC1_BASE,      0x1000u, 1u, sim_adc_write,     sim_adc_read },
+	{ CAN2_BASE,      0x1000u, 2u, sim_flexcan_write, sim_flexcan_read },
+	{ LPSPI0_BASE,    0x1000u, 0u, sim_lpspi_write,   sim_lpspi_read },
+	{ LPSPI1_BASE,    0x1000u, 1u, sim_lpspi_write,   sim_lpspi_read },
+	{ LPSPI2_BASE,    0x1000u, 2u, sim_lpspi_write,   sim_lpspi_read },
+	{ PDB1_BASE,      0x1000u, 1u, sim_pdb_write,     sim_pdb_read },
+	{ CRC_BASE,       0x1000u, 0u, sim_crc_write,     sim_crc_read },
+	{ PDB0_BASE,      0x1000u, 0u, sim_pdb_write,     sim_pdb_read },
+	{ LPIT0_BASE,     0x1000u, 0u, sim_lpit_write,    sim_lpit_read },
+	{ ADC0_BASE,      0x1000u, 0u, sim_adc_write,     sim_adc_read },
+	{ LPTMR0_BASE,    0x1000u, 0u, sim_lptmr_write,   sim_lptmr_read },
+	{ PORTA_BASE,     0x1000u, 0u, sim_port_write,    NULL },
+	{ PORTB_BASE,     0x1000u, 1u, sim_port_write,    NULL },
+	{ PORTC_BASE,     0x1000u, 2u, sim_port_write,    NULL },
+	{ PORTD_BASE,     0x1000u, 3u, sim_port_write,    NULL },
+	{ PORTE_BASE,     0x1000u, 4u, sim_port_write,    NULL },
+	{ WDOG_BASE,      0x1000u, 0u, sim_wdog_write,    NULL },
+	{ SAI0_BASE,      0x1000u, 0u, sim_sai_write,     sim_sai_read },
+	{ SAI1_BASE,      0x1000u, 1u, sim_sai_write,     sim_sai_read },
+	{ SCG_BASE,       0x1000u, 0u, sim_scg_write,     NULL },
+	{ LPUART0_BASE,   0x1000u, 0u, sim_lpuart_write,  sim_lpuart_read },
+	{ LPUART1_BASE,   0x1000u, 1u, sim_lpuart_write,  sim_lpuart_read },
+	{ LPUART2_BASE,   0x1000u, 2u, sim_lpuart_write,  sim_lpuart_read },
+	{ SMC_BASE,       0x1000u, 0u, sim_smc_write,     NULL },
+	{ SIM_BASE,       0x1000u, 0u, sim_misc_write,    NULL },
+	{ FTFC_BASE,      0x1000u, 0u, sim_ftfc_write,    NULL },
+	{ SIM_FLASH_BASE, SIM_FLASH_SIZE, 0u, sim_flash_write, NULL },
+	{ PTA_BASE,       0x0040u, 0u, sim_gpio_write,    NULL },
+	{ PTB_BASE,       0x0040u, 1u, sim_gpio_write,    NULL },
+	{ PTC_BASE,       0x0040u, 2u, sim_gpio_write,    NULL },
+	{ PTD_BASE,       0x0040u, 3u, sim_gpio_write,    NULL },
+	{ PTE_BASE,       0x0040u, 4u, sim_gpio_write,    NULL },
+	{ S32_NVIC_BASE,  0x0E04u, 0u, sim_nvic_write,    NULL },
+};
+
+#define SIM_BLOCK_COUNT		(sizeof(blocks) / sizeof(blocks[0]))
+
+typedef struct
+{
+	uint64_t     at;
+	sim_event_fn fn;
+	uint32_t     arg;
+	bool         used;
+} sim_event_t;
+
+typedef struct
+{
+	uint32_t address;
+	uint32_t value;
+	uint8_t  repeats;
+} sim_poll_t;
+
+sim_stats_t sim_stats;
+
+static sim_event_t events[SIM_EVENT_COUNT];
+static uint64_t now;
+static uint64_t run_limit;
+static volatile sig_atomic_t stepping;		/* A trapped instruction is being single stepped */
+static volatile sig_atomic_t busy;			/* Model code is running, defer the spin detector */
+static volatile uint64_t accesses_at_tick;
+static bool primask;
+static greg_t core_context[REG_RIP + 1];	/* General purpose registers and RIP at the last spin detector tick */
+
+static struct
+{
+	uint32_t address;
+	uint32_t old_word;
+	uint8_t  size;
+	bool     write;
+} trap;
+static uint8_t access_size;					/* Width in bytes of the access being dispatched */
+
+static sim_poll_t polls[SIM_POLL_DEPTH];
+static uint8_t poll_count;
+
+static sim_region_t *region_of(uint32_t address)
+{
+	uint8_t i;
+	for (i = 0; i < SIM_REGION_COUNT; i++)
+	{
+		if ((address >= regions[i].base) && (address - regions[i].base < regions[i].size))
+		{
+			return &regions[i];
+		}
+	}
+	return NULL;
+}
+
+static const sim_block_t *block_of(uint32_t address)
+{
+	uint8_t i;
+	for (i = 0; i < SIM_BLOCK_COUNT; i++)
+	{
+		if ((address >= blocks[i].base) && (address - blocks[i].base < blocks[i].size))
+		{
+			return &blocks[i];
+		}
+	}
+	return NULL;
+}
+
+bool sim_is_register(uint32_t address)
+{
+	return region_of(address) != NULL;
+}
+
+void *sim_view(uint32_t address)
+{
+	sim_region_t *region = region_of(address);
+	return region ? (void *)(region->model + (address - region->base)) : NULL;
+}
+
+/*!
+ * Event queue
+ * ===================================================
+ */
+uint64_t sim_now(void)
+{
+	return now;
+}
+
+void sim_schedule(uint64_t delay, sim_event_fn fn, uint32_t arg)
+{
+	uint8_t i;
+	for (i = 0; i < SIM_EVENT_COUNT; i++)
+	{
+		if (!events[i].used)
+		{
+			events[i].at   = now + delay;
+			events[i].fn   = fn;
+			events[i].arg  = arg;
+			events[i].used = true;
+			return;
+		}
+	}
+	fprintf(stderr, "sim: event queue full\n");
+	abort();
+}
+
+void sim_cancel(sim_event_fn fn, uint32_t arg)
+{
+	uint8_t i;
+	for (i = 0; i < SIM_EVENT_COUNT; i++)
+	{
+		if (events[i].used && (events[i].fn == fn) && (events[i].arg == arg))
+		{
+			events[i].used = false;
+		}
+	}
+}
+
+bool sim_is_scheduled(sim_event_fn fn, uint32_t arg)
+{
+	uint8_t i;
+	for (i = 0; i < SIM_EVENT_COUNT; i++)
+	{
+		if (events[i].used && (events[i].fn == fn) && (events[i].arg == arg))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static sim_event_t *next_event(void)
+{
+	sim_event_t *next = NULL;
+	uint8_t i;
+	for (i = 0; i < SIM_EVENT_COUNT; i++)
+	{
+		if (events[i].used && ((next == NULL) || (events[i].at < next->at)))
+		{
+			next = &events[i];
+		}
+	}
+	return next;
+}
+
+/*!
+* @brief Move simulated time to target, firing every event due on the way in time order.
+*/
+static void advance_to(uint64_t target)
+{
+	sim_event_t *event;
+	while (((event = next_event()) != NULL) && (event->at <= target))
+	{
+		sim_event_fn fn = event->fn;
+		uint32_t     arg = event->arg;
+		if (event->at > now)
+		{
+			now = event->at;
+		}
+		event->used = false;
+		fn(arg);
+	}
+	if (target > now)
+	{
+		now = target;
+	}
+	if (now >= run_limit)
+	{
+		SIM_stop(0);
+	}
+}
+
+/*!
+* @brief Skip to the next scheduled event, or by one idle quantum when nothing is pending.
+*/
+static void advance_idle(void)
+{
+	sim_event_t *event = next_event();
+	advance_to(((event != NULL) && (event->at < now + SIM_IDLE_QUANTUM)) ? event->at : now + SIM_IDLE_QUANTUM);
+}
+
+/*!
+ * Register access dispatch
+ * ===================================================
+ */
+static bool is_poll(uint32_t address, uint32_t value)
+{
+	uint8_t i;
+	for (i = 0; i < poll_count; i++)
+	{
+		if (polls[i].address == address)
+		{
+			polls[i].repeats = (polls[i].value == value) ? (uint8_t)(polls[i].repeats + 1u) : 0u;
+			polls[i].value = value;
+			return polls[i].repeats >= SIM_POLL_REPEATS;	/* A second look is not a loop yet */
+		}
+	}
+	if (poll_count < SIM_POLL_DEPTH)
+	{
+		polls[poll_count].address = address;
+		polls[poll_count].value = value;
+		polls[poll_count].repeats = 0u;
+		poll_count++;
+	}
+	return false;
+}
+
+static void dispatch(uint32_t address, uint32_t old_word, uint32_t new_word, bool write)
+{
+	const sim_block_t *block = block_of(address);
+
+	busy = 1;
+	if (write)
+	{
+		sim_stats.writes++;
+		poll_count = 0;
+		advance_to(now + SIM_CYCLES_PER_ACCESS);
+		if ((block != NULL) && (block->write != NULL))
+		{
+			block->write(block->instance, address - block->base, old_word, new_word);
+		}
+	}
+	else
+	{
+		sim_stats.reads++;
+		if (is_poll(address & ~3u, new_word))
+		{
+			sim_stats.polls_skipped++;
+			advance_idle();
+		}
+		else
+		{
+			advance_to(now + SIM_CYCLES_PER_ACCESS);
+		}
+		if ((block != NULL) && (block->read != NULL))
+		{
+			block->read(block->instance, address - block->base);
+		}
+	}
+	busy = 0;
+}
+
+uint8_t sim_access_size(void)
+{
+	return access_size;
+}
+
+uint32_t sim_bus_read(uint32_t address, uint8_t size)
+{
+	uint32_t value = 0;
+	access_size = size;
+	if (sim_is_register(address))
+	{
+		const sim_block_t *block = block_of(address);
+		memcpy(&value, sim_view(address), size);
+		if ((block != NULL) && (block->read != NULL))
+		{
+			block->read(block->instance, address - block->base);
+		}
+	}
+	else
+	{
+		memcpy(&value, (const void *)(uintptr_t)address, size);
+	}
+	return value;
+}
+
+void sim_bus_write(uint32_t address, uint32_t value, uint8_t size)
+{
+	access_size = size;
+	if (sim_is_register(address))
+	{
+		const sim_block_t *block = block_of(address);
+		uint32_t *word = sim_view(address & ~3u);
+		uint32_t old_word = *word;
+		memcpy(sim_view(address), &value, size);
+		if ((block != NULL) && (block->write != NULL))
+		{
+			block->write(block->instance, address - block->base, old_word, *word);
+		}
+	}
+	else
+	{
+		memcpy((void *)(uintptr_t)address, &value, size);
+	}
+}
+
+/*!
+ * Trap handlers
+ * ===================================================
+ * SIGSEGV: a driver touched the bus view. Open the page, remember the old word and single step.
+ * SIGTRAP: the instruction completed. Close the page and hand the access to the model.
+ */
+static void set_page(uint32_t address, int protection)
+{
+	mprotect((void *)(uintptr_t)(address & ~(SIM_PAGE_SIZE - 1u)), SIM_PAGE_SIZE, protection);
+}
+
+/*!
+* @brief Operand width of the x86-64 instruction at code, enough of the decoder for the loads,
+* stores and read-modify-writes a compiler emits for volatile register accesses.
+*/
+static uint8_t decode_size(const uint8_t *code)
+{
+	bool operand16 = false;
+
+	for (;; code++)
+	{
+		if (*code == 0x66u)
+		{
+			operand16 = true;
+		}
+		else if ((*code != 0xF2u) && (*code != 0xF3u) && (*code != 0x2Eu) && (*code != 0x3Eu) &&
+				 (*code != 0x26u) && (*code != 0x36u) && (*code != 0x64u) && (*code != 0x65u) &&
+				 (*code != 0x67u))
+		{
+			break;
+		}
+	}
+	if ((*code & 0xF0u) == 0x40u)									/* REX */
+	{
+		if (*code & 0x08u)
+		{
+			return 8u;
+		}
+		code++;
+	}
+	switch (*code)
+	{
+		case 0x00u: case 0x02u: case 0x08u: case 0x0Au: case 0x20u: case 0x22u:
+		case 0x30u: case 0x32u: case 0x38u: case 0x3Au: case 0x80u: case 0x84u:
+		case 0x86u: case 0x88u: case 0x8Au: case 0xA0u: case 0xA2u: case 0xC6u:
+		case 0xF6u:
+			return 1u;
+		case 0x0Fu:
+			if ((code[1] == 0xB6u) || (code[1] == 0xBEu))
+			{
+				return 1u;
+			}
+			if ((code[1] == 0xB7u) || (code[1] == 0xBFu))
+			{
+				return 2u;
+			}
+			break;
+		default:
+			break;
+	}
+	return operand16 ? 2u : 4u;
+}
+
+static void segv_handler(int sig, siginfo_t *info, void *context)
+{
+	ucontext_t *uc = context;
+	uintptr_t fault = (uintptr_t)info->si_addr;
+	(void)sig;
+
+	if ((fault > UINT32_MAX) || stepping || !sim_is_register((uint32_t)fault))
+	{
+		signal(SIGSEGV, SIG_DFL);									/* Genuine fault: let it crash */
+		return;
+	}
+	trap.address  = (uint32_t)fault;
+	trap.write    = (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+	trap.old_word = *(uint32_t *)sim_view(trap.address & ~3u);
+	trap.size     = decode_size((const uint8_t *)uc->uc_mcontext.gregs[REG_RIP]);
+	stepping = 1;
+	set_page(trap.address, PROT_READ | PROT_WRITE);
+	uc->uc_mcontext.gregs[REG_EFL] |= SIM_TRAP_FLAG;
+}
+
+static void trap_handler(int sig, siginfo_t *info, void *context)
+{
+	ucontext_t *uc = context;
+	uint32_t new_word;
+	(void)sig;
+	(void)info;
+
+	if (!stepping)
+	{
+		fprintf(stderr, "sim: breakpoint\n");
+		SIM_stop(3);
+	}
+	uc->uc_mcontext.gregs[REG_EFL] &= ~(greg_t)SIM_TRAP_FLAG;
+	new_word = *(uint32_t *)sim_view(trap.address & ~3u);
+	set_page(trap.address, PROT_NONE);
+	stepping = 0;
+
+	access_size = trap.size;
+	dispatch(trap.address, trap.old_word, new_word, trap.write);
+	sim_irq_dispatch();
+}
+
+/*!
+* @brief Spin detector, on a CPU time timer. It never decides how far simulated time moves: if
+* the application made no register access since the last tick and its registers have not
+* changed either, it is spinning on a RAM flag that only an interrupt can set, and the models
+* run event by event until one wakes it (or up to SIM_RUN_MS when none is scheduled). A core
+* that computes in RAM is left alone; it costs no simulated time. Each spin ends at the same
+* simulated instant whenever the tick catches it, so a run gives the same trace on any host.
+*/
+static void spin_handler(int sig, siginfo_t *info, void *context)
+{
+	ucontext_t *uc = context;
+	uint64_t total = sim_stats.reads + sim_stats.writes;
+	bool spinning;
+	(void)sig;
+	(void)info;
+
+	if (stepping || busy)
+	{
+		return;
+	}
+	spinning = (total == accesses_at_tick) &&
+			   (memcmp(core_context, uc->uc_mcontext.gregs, sizeof(core_context)) == 0);
+	memcpy(core_context, uc->uc_mcontext.gregs, sizeof(core_context));
+	accesses_at_tick = total;
+	if (spinning)
+	{
+		uint64_t irqs = sim_stats.irqs;
+		sim_event_t *event;
+		busy = 1;
+		do																/* Run events until one wakes the core */
+		{
+			event = next_event();
+			advance_to((event != NULL) ? event->at : run_limit);
+		} while (!sim_irq_pending() && (sim_stats.irqs == irqs));		/* Handlers run by an event woke it too */
+		busy = 0;
+		sim_irq_dispatch();
+	}
+}
+
+/*!
+ * Public API
+ * ===================================================
+ */
+void SIM_init(void)
+{
+	struct sigaction action;
+	struct itimerval timer;
+	uint8_t i;
+
+	for (i = 0; i < SIM_REGION_COUNT; i++)
+	{
+		int fd = memfd_create("s32k148", 0);
+		void *bus;
+		if ((fd < 0) || (ftruncate(fd, regions[i].size) != 0))
+		{
+			perror("sim: memfd");
+			exit(2);
+		}
+		bus = mmap((void *)(uintptr_t)regions[i].base, regions[i].size, PROT_NONE,
+				   MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+		regions[i].model = mmap(NULL, regions[i].size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if ((bus != (void *)(uintptr_t)regions[i].base) || (regions[i].model == MAP_FAILED))
+		{
+			fprintf(stderr, "sim: cannot map peripheral space at 0x%08X (link with -no-pie)\n", regions[i].base);
+			exit(2);
+		}
+		close(fd);
+	}
+
+	memset(&sim_stats, 0, sizeof(sim_stats));
+	memset(events, 0, sizeof(events));
+	now = 0;
+	run_limit = SIM_MS_TO_CYCLES(SIM_RUN_MS);
+
+	sim_nvic_reset();
+	sim_clocks_reset();
+	sim_port_reset();
+	sim_dma_reset();
+	sim_adc_reset();
+	sim_pdb_reset();
+	sim_flexcan_reset();
+	sim_lpuart_reset();
+	sim_lpspi_reset();
+	sim_crc_reset();
+	sim_timers_reset();
+	sim_flash_reset();
+	sim_sai_reset();
+	sim_nor_reset();
+
+	memset(&action, 0, sizeof(action));
+	action.sa_flags = SA_SIGINFO | SA_NODEFER;					/* Handlers nest when an ISR runs from a trap */
+	action.sa_sigaction = segv_handler;
+	sigaction(SIGSEGV, &action, NULL);
+	action.sa_sigaction = trap_handler;
+	sigaction(SIGTRAP, &action, NULL);
+
+	memset(&action, 0, sizeof(action));
+	action.sa_sigaction = spin_handler;
+	action.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigaction(SIGVTALRM, &action, NULL);
+	timer.it_interval.tv_sec = 0;
+	timer.it_interval.tv_usec = 1000;
+	timer.it_value = timer.it_interval;
+	setitimer(ITIMER_VIRTUAL, &timer, NULL);					/* Ticks only while the core runs */
+}
+
+uint64_t SIM_cycles(void)
+{
+	return now;
+}
+
+void SIM_advance(uint64_t cycles)
+{
+	busy = 1;
+	advance_to(now + cycles);
+	busy = 0;
+	sim_irq_dispatch();
+}
+
+void SIM_stats(sim_stats_t *stats)
+{
+	*stats = sim_stats;
+}
+
+void SIM_report(FILE *out)
+{
+	fprintf(out, "\nsim: %llu bus cycles (%.3f ms at %u Hz)\n", (unsigned long long)now,
+			(double)now * 1000.0 / (double)SIM_BUS_CLOCK_HZ, SIM_BUS_CLOCK_HZ);
+	fprintf(out, "sim: %llu register reads, %llu writes, %llu polls skipped\n",
+			(unsigned long long)sim_stats.reads, (unsigned long long)sim_stats.writes,
+			(unsigned long long)sim_stats.polls_skipped);
+	fprintf(out, "sim: %llu interrupts, %llu DMA minor loops, %llu DMA bytes\n",
+			(unsigned long long)sim_stats.irqs, (unsigned long long)sim_stats.dma_minor_loops,
+			(unsigned long long)sim_stats.dma_bytes);
+}
+
+void SIM_stop(int status)
+{
+	struct itimerval timer;
+	memset(&timer, 0, sizeof(timer));
+	setitimer(ITIMER_VIRTUAL, &timer, NULL);
+	fflush(stdout);
+	SIM_report(stderr);
+	exit(status);
+}
+
+void SIM_irq_enable(void)
+{
+	primask = false;
+	sim_irq_dispatch();
+}
+
+void SIM_irq_disable(void)
+{
+	primask = true;
+}
+
+bool sim_primask(void)
+{
+	return primask;
+}
+
+void SIM_wait_for_interrupt(void)
+{
+	uint64_t irqs = sim_stats.irqs;
+	while ((sim_stats.irqs == irqs) && !(primask && sim_irq_pending()))	/* WFI also wakes on masked IRQs */
+	{
+		busy = 1;
+		advance_idle();
+		busy = 0;
+		sim_irq_dispatch();
+	}
+}
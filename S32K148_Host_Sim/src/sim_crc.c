@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim_internal.h"
+
+/*!
+ * CRC model
+ * ===================================================
+ * 16-bit (GPOLY[15:0]) or 32-bit (CTRL[TCRC]) CRC, fed most significant byte first with the
+ * 1, 2 or 4 bytes of each DATA write, after the input transposition of CTRL[TOT]. With
+ * CTRL[WAS] the write loads the seed instead. DATA reads the register through CTRL[TOTR] and
+ * CTRL[FXOR], as the device does, so a 16-bit result transposed by bytes reads from DATAH.
+ */
+
+static uint32_t crc;								/* CRC register before output transposition */
+
+static uint32_t reverse_bits(uint32_t value, uint8_t bits)
+{
+	uint32_t result = 0;
+	uint8_t  i;
+	for (i = 0; i < bits; i++)
+	{
+		result = (result << 1) | ((value >> i) & 1u);
+	}
+	return result;
+}
+
+/*!
+* @brief CTRL[TOT]/[TOTR] transposition of a size byte value: 1 bits in bytes, 2 bits and
+* bytes, 3 bytes only.
+*/
+static uint32_t transpose(uint32_t value, uint8_t size, uint32_t mode)
+{
+	uint32_t result = 0;
+	uint8_t  i;
+
+	switch (mode)
+	{
+		case 1u:
+			for (i = 0; i < size; i++)
+			{
+				result |= reverse_bits((value >> (8u * i)) & 0xFFu, 8u) << (8u * i);
+			}
+			return result;
+		case 2u:
+			return reverse_bits(value, (uint8_t)(8u * size));
+		case 3u:
+			for (i = 0; i < size; i++)
+			{
+				result |= ((value >> (8u * i)) & 0xFFu) << (8u * (size - 1u - i));
+			}
+			return result;
+		default:
+			return value;
+	}
+}
+
+static void publish(void)
+{
+	CRC_Type *regs = SIM_VIEW(CRC);
+	uint32_t ctrl = regs->CTRL;
+	uint32_t value = crc;
+
+	if (ctrl & CRC_CTRL_FXOR_MASK)
+	{
+		value ^= (ctrl & CRC_CTRL_TCRC_MASK) ? 0xFFFFFFFFu : 0x0000FFFFu;
+	}
+	regs->DATAu.DATA = transpose(value, 4u, (ctrl & CRC_CTRL_TOTR_MASK) >> CRC_CTRL_TOTR_SHIFT);
+}
+
+static void feed(uint32_t value, uint8_t size)
+{
+	CRC_Type *regs = SIM_VIEW(CRC);
+	uint32_t ctrl = regs->CTRL;
+	bool     wide = (ctrl & CRC_CTRL_TCRC_MASK) != 0u;
+	uint32_t poly = wide ? regs->GPOLY : (regs->GPOLY & 0xFFFFu);
+	uint32_t top  = wide ? 0x80000000u : 0x8000u;
+	uint32_t mask = wide ? 0xFFFFFFFFu : 0xFFFFu;
+	uint32_t reg  = crc & mask;
+	int8_t   byte;
+	uint8_t  bit;
+
+	value = transpose(value, size, (ctrl & CRC_CTRL_TOT_MASK) >> CRC_CTRL_TOT_SHIFT);
+	if (ctrl & CRC_CTRL_WAS_MASK)
+	{
+		crc = value;													/* Seed */
+		return;
+	}
+	for (byte = (int8_t)(size - 1u); byte >= 0; byte--)
+	{
+		reg ^= ((value >> (8u * (uint8_t)byte)) & 0xFFu) << (wide ? 24u : 8u);
+		for (bit = 0; bit < 8u; bit++)
+		{
+			reg = (reg & top) ? ((reg << 1) ^ poly) : (reg << 1);
+		}
+		reg &= mask;
+	}
+	crc = (crc & ~mask) | reg;
+}
+
+void sim_crc_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	uint8_t size = sim_access_size();
+	(void)instance;
+	(void)old_word;
+
+	if (offset < 4u)
+	{
+		if (size == 1u)
+		{
+			feed(SIM_BYTE(new_word, offset), 1u);
+		}
+		else if (size == 2u)
+		{
+			feed(SIM_HALF(new_word, offset), 2u);
+		}
+		else
+		{
+			feed(new_word, 4u);
+		}
+	}
+	publish();
+}
+
+void sim_crc_read(uint8_t instance, uint32_t offset)
+{
+	(void)instance;
+	(void)offset;
+}
+
+void sim_crc_reset(void)
+{
+	CRC_Type *regs = SIM_VIEW(CRC);
+	crc = 0xFFFFFFFFu;
+	regs->GPOLY = 0x00001021u;
+	regs->CTRL  = 0;
+	publish();
+}
@@ -0,0 +1,496 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "sim_internal.h"
+
+/*!
+ * eDMA and DMAMUX models
+ * ===================================================
+ * A service request (SSRT/CSR[START], a DMAMUX routed hardware request, an always enabled
+ * source or a channel link) runs exactly one minor loop, as the engine does. The minor loop is
+ * executed as an event after the time its beats take, through sim_bus_read/sim_bus_write so a
+ * DMA access to ADC0->R[n] or LPUART1->DATA has the same side effects as a CPU access.
+ *
+ * Supported: SSIZE/DSIZE 1/2/4/16/32 bytes, SMOD/DMOD, SOFF/DOFF, minor loop mapping with
+ * MLOFF (CR[EMLM]), SLAST/DLASTSGA, scatter/gather, minor and major channel linking,
+ * INTHALF/INTMAJOR, DREQ, DONE/ACTIVE/START, the byte wide command registers and the
+ * configuration errors of ES (alignment, NBYTES, scatter/gather address).
+ */
+
+#define SIM_DMA_CHANNELS		(16u)
+#define SIM_DMA_SETUP_CYCLES	(2u)		/* Arbitration and TCD read before the first beat */
+#define SIM_DMA_ALL				(0x40u)		/* CAxx / SAxx bit of the command registers */
+
+enum
+{
+	DMA_CSR_START      = 0x0001u,
+	DMA_CSR_INTMAJOR   = 0x0002u,
+	DMA_CSR_INTHALF    = 0x0004u,
+	DMA_CSR_DREQ       = 0x0008u,
+	DMA_CSR_ESG        = 0x0010u,
+	DMA_CSR_MAJORELINK = 0x0020u,
+	DMA_CSR_ACTIVE     = 0x0040u,
+	DMA_CSR_DONE       = 0x0080u
+};
+
+enum
+{
+	DMA_ES_SGE = 0x00000004u,
+	DMA_ES_NCE = 0x00000008u,
+	DMA_ES_DAE = 0x00000020u,
+	DMA_ES_SAE = 0x00000080u,
+	DMA_ES_VLD = 0x80000000u
+};
+
+static uint64_t pending_sources;			/* Hardware requests not yet served, one bit per source */
+
+static uint8_t size_of(uint32_t code)
+{
+	static const uint8_t sizes[8] = { 1u, 2u, 4u, 0u, 16u, 32u, 0u, 0u };
+	return sizes[code & 7u];
+}
+
+/*!
+* @brief Apply an offset to a TCD address, keeping the bits above the modulo field fixed.
+*/
+static uint32_t step(uint32_t address, int32_t offset, uint32_t mod)
+{
+	if (mod == 0u)
+	{
+		return address + (uint32_t)offset;
+	}
+	else
+	{
+		uint32_t mask = (1u << mod) - 1u;
+		return (address & ~mask) | ((address + (uint32_t)offset) & mask);
+	}
+}
+
+static uint16_t iter_count(uint16_t iter)
+{
+	return (iter & DMA_TCD_CITER_ELINKYES_ELINK_MASK) ? (iter & DMA_TCD_CITER_ELINKYES_CITER_LE_MASK)
+													  : (iter & DMA_TCD_CITER_ELINKNO_CITER_MASK);
+}
+
+static void channel_error(uint8_t ch, uint32_t cause)
+{
+	DMA_Type *dma = SIM_VIEW(DMA);
+	SIM_RO(dma->ES) = DMA_ES_VLD | DMA_ES_ERRCHN(ch) | cause;
+	dma->ERR |= 1u << ch;
+	dma->TCD[ch].CSR &= (uint16_t)~(DMA_CSR_START | DMA_CSR_ACTIVE);
+	if (dma->EEI & (1u << ch))
+	{
+		sim_irq_raise(DMA_Error_IRQn);
+	}
+}
+
+static void service(uint32_t ch);
+static void route(void);
+
+static void start(uint8_t ch)
+{
+	DMA_Type *dma = SIM_VIEW(DMA);
+	uint32_t nbytes = dma->TCD[ch].NBYTES.MLNO;
+
+	if (dma->CR & DMA_CR_EMLM_MASK)
+	{
+		nbytes &= (nbytes & (DMA_TCD_NBYTES_MLOFFYES_SMLOE_MASK | DMA_TCD_NBYTES_MLOFFYES_DMLOE_MASK))
+				  ? DMA_TCD_NBYTES_MLOFFYES_NBYTES_MASK : DMA_TCD_NBYTES_MLOFFNO_NBYTES_MASK;
+	}
+	if (!sim_is_scheduled(service, ch))
+	{
+		sim_schedule(SIM_DMA_SETUP_CYCLES + (nbytes + 3u) / 4u * SIM_CYCLES_PER_ACCESS, service, ch);
+	}
+}
+
+/*!
+* @brief Load the next TCD from memory for scatter/gather.
+*/
+static bool scatter_gather(uint8_t ch)
+{
+	DMA_Type *dma = SIM_VIEW(DMA);
+	uint32_t address = dma->TCD[ch].DLASTSGA;
+	uint32_t words[8];
+	uint8_t i;
+
+	if (address & 0x1Fu)
+	{
+		channel_error(ch, DMA_ES_SGE);
+		return false;
+	}
+	for (i = 0; i < 8u; i++)
+	{
+		words[i] = sim_bus_read(address + 4u * i, 4u);
+	}
+	for (i = 0; i < 8u; i++)
+	{
+		((volatile uint32_t *)&dma->TCD[ch])[i] = words[i];
+	}
+	return true;
+}
+
+static void link(uint8_t ch)
+{
+	DMA_Type *dma = SIM_VIEW(DMA);
+	dma->TCD[ch].CSR |= DMA_CSR_START;
+	start(ch);
+}
+
+/*!
+* @brief Execute one minor loop of channel ch and the major loop completion when due.
+*/
+static void service(uint32_t ch)
+{
+	DMA_Type *dma = SIM_VIEW(DMA);
+	uint16_t attr  = dma->TCD[ch].ATTR;
+	uint8_t  ssize = size_of((attr & DMA_TCD_ATTR_SSIZE_MASK) >> DMA_TCD_ATTR_SSIZE_SHIFT);
+	uint8_t  dsize = size_of((attr & DMA_TCD_ATTR_DSIZE_MASK) >> DMA_TCD_ATTR_DSIZE_SHIFT);
+	uint32_t smod  = (attr & DMA_TCD_ATTR_SMOD_MASK) >> DMA_TCD_ATTR_SMOD_SHIFT;
+	uint32_t dmod  = (attr & DMA_TCD_ATTR_DMOD_MASK) >> DMA_TCD_ATTR_DMOD_SHIFT;
+	uint32_t nbytes = dma->TCD[ch].NBYTES.MLNO;
+	int32_t  mloff = 0;
+	bool     smloe = false;
+	bool     dmloe = false;
+	uint32_t saddr = dma->TCD[ch].SADDR;
+	uint32_t daddr = dma->TCD[ch].DADDR;
+	int16_t  soff  = (int16_t)dma->TCD[ch].SOFF;
+	int16_t  doff  = (int16_t)dma->TCD[ch].DOFF;
+	uint8_t  stage[64];
+	uint32_t staged = 0;
+	uint32_t done = 0;
+	uint16_t citer;
+	uint16_t biter;
+	uint16_t count;
+
+	if (dma->CR & DMA_CR_EMLM_MASK)
+	{
+		smloe = (nbytes & DMA_TCD_NBYTES_MLOFFYES_SMLOE_MASK) != 0u;
+		dmloe = (nbytes & DMA_TCD_NBYTES_MLOFFYES_DMLOE_MASK) != 0u;
+		if (smloe || dmloe)
+		{
+			mloff  = ((int32_t)(nbytes << 2)) >> 12;						/* Sign extend MLOFF[29:10] */
+			nbytes &= DMA_TCD_NBYTES_MLOFFYES_NBYTES_MASK;
+		}
+		else
+		{
+			nbytes &= DMA_TCD_NBYTES_MLOFFNO_NBYTES_MASK;
+		}
+	}
+	if ((nbytes == 0u) || (ssize == 0u) || (dsize == 0u) || (nbytes % ssize) || (nbytes % dsize))
+	{
+		channel_error((uint8_t)ch, DMA_ES_NCE);
+		return;
+	}
+	if ((saddr % ssize) || (soff % ssize))
+	{
+		channel_error((uint8_t)ch, DMA_ES_SAE);
+		return;
+	}
+	if ((daddr % dsize) || (doff % dsize))
+	{
+		channel_error((uint8_t)ch, DMA_ES_DAE);
+		return;
+	}
+
+	dma->TCD[ch].CSR = (uint16_t)((dma->TCD[ch].CSR & ~(DMA_CSR_START | DMA_CSR_DONE)) | DMA_CSR_ACTIVE);
+
+	/* Read source beats into the staging buffer, drain it in destination beats */
+	while (done < nbytes)
+	{
+		uint32_t i;
+		for (i = 0; i < ssize; i += 4u)
+		{
+			uint8_t  width = (ssize < 4u) ? ssize : 4u;
+			uint32_t value = sim_bus_read(saddr + i, width);
+			memcpy(&stage[staged], &value, width);
+			staged += width;
+		}
+		saddr = step(saddr, soff, smod);
+		done += ssize;
+		while (staged >= dsize)
+		{
+			for (i = 0; i < dsize; i += 4u)
+			{
+				uint8_t  width = (dsize < 4u) ? dsize : 4u;
+				uint32_t value = 0;
+				memcpy(&value, &stage[i], width);
+				sim_bus_write(daddr + i, value, width);
+			}
+			daddr = step(daddr, doff, dmod);
+			staged -= dsize;
+			memmove(stage, &stage[dsize], staged);
+		}
+	}
+	if (smloe)
+	{
+		saddr += (uint32_t)mloff;
+	}
+	if (dmloe)
+	{
+		daddr += (uint32_t)mloff;
+	}
+	sim_stats.dma_minor_loops++;
+	sim_stats.dma_bytes += nbytes;
+
+	citer = dma->TCD[ch].CITER.ELINKNO;
+	biter = dma->TCD[ch].BITER.ELINKNO;
+	count = (uint16_t)(iter_count(citer) - 1u);
+	dma->TCD[ch].CSR &= (uint16_t)~DMA_CSR_ACTIVE;
+
+	if (count != 0u)
+	{
+		/* Minor loop done, major loop continues */
+		dma->TCD[ch].SADDR = saddr;
+		dma->TCD[ch].DADDR = daddr;
+		if (citer & DMA_TCD_CITER_ELINKYES_ELINK_MASK)
+		{
+			dma->TCD[ch].CITER.ELINKYES = (uint16_t)((citer & ~DMA_TCD_CITER_ELINKYES_CITER_LE_MASK) | count);
+			link((uint8_t)((citer & DMA_TCD_CITER_ELINKYES_LINKCH_MASK) >> DMA_TCD_CITER_ELINKYES_LINKCH_SHIFT));
+		}
+		else
+		{
+			dma->TCD[ch].CITER.ELINKNO = (uint16_t)((citer & ~DMA_TCD_CITER_ELINKNO_CITER_MASK) | count);
+		}
+		if ((dma->TCD[ch].CSR & DMA_CSR_INTHALF) && (count == iter_count(biter) / 2u))
+		{
+			dma->INT |= 1u << ch;
+			sim_irq_raise((IRQn_Type)(DMA0_IRQn + ch));
+		}
+	}
+	else
+	{
+		/* Major loop done */
+		uint16_t csr = dma->TCD[ch].CSR;
+		dma->TCD[ch].SADDR = saddr + dma->TCD[ch].SLAST;
+		dma->TCD[ch].DADDR = (csr & DMA_CSR_ESG) ? daddr : daddr + dma->TCD[ch].DLASTSGA;
+		dma->TCD[ch].CITER.ELINKNO = biter;
+		if ((citer & DMA_TCD_CITER_ELINKYES_ELINK_MASK) && !(csr & DMA_CSR_MAJORELINK))
+		{
+			link((uint8_t)((citer & DMA_TCD_CITER_ELINKYES_LINKCH_MASK) >> DMA_TCD_CITER_ELINKYES_LINKCH_SHIFT));
+		}
+		if (csr & DMA_CSR_INTMAJOR)
+		{
+			dma->INT |= 1u << ch;
+			sim_irq_raise((IRQn_Type)(DMA0_IRQn + ch));
+		}
+		if (csr & DMA_CSR_DREQ)
+		{
+			dma->ERQ &= ~(1u << ch);
+		}
+		if (csr & DMA_CSR_ESG)
+		{
+			if (!scatter_gather((uint8_t)ch))
+			{
+				return;
+			}
+			if (dma->TCD[ch].CSR & DMA_CSR_START)
+			{
+				start((uint8_t)ch);
+			}
+		}
+		else
+		{
+			dma->TCD[ch].CSR |= DMA_CSR_DONE;
+		}
+		if (csr & DMA_CSR_MAJORELINK)
+		{
+			link((uint8_t)((csr & DMA_TCD_CSR_MAJORLINKCH_MASK) >> DMA_TCD_CSR_MAJORLINKCH_SHIFT));
+		}
+	}
+
+	/* Requests raised during the minor loop, and always enabled sources, once ERQ/DREQ are applied */
+	route();
+}
+
+/*!
+* @brief Serve latched hardware requests on every channel routed and enabled for them.
+*/
+static void route(void)
+{
+	DMA_Type    *dma = SIM_VIEW(DMA);
+	DMAMUX_Type *mux = SIM_VIEW(DMAMUX);
+	uint8_t ch;
+
+	for (ch = 0; ch < SIM_DMA_CHANNELS; ch++)
+	{
+		uint8_t cfg = mux->CHCFG[ch];
+		uint8_t source = cfg & DMAMUX_CHCFG_SOURCE_MASK;
+		bool always = (source == EDMA_REQ_DMAMUX_ALWAYS_ENABLED0) || (source == EDMA_REQ_DMAMUX_ALWAYS_ENABLED1);
+
+		if (!(cfg & DMAMUX_CHCFG_ENBL_MASK) || (cfg & DMAMUX_CHCFG_TRIG_MASK) || !(dma->ERQ & (1u << ch)) ||
+			(dma->TCD[ch].CSR & DMA_CSR_ACTIVE))
+		{
+			continue;											/* Busy channels take the request when they finish */
+		}
+		if (always || (pending_sources & (1ull << source)))
+		{
+			pending_sources &= ~(1ull << source);
+			start(ch);
+		}
+	}
+}
+
+void sim_dma_request(uint8_t source)
+{
+	pending_sources |= 1ull << source;
+	route();
+}
+
+/*!
+* @brief Level request sources (FIFO watermarks) drop a request that is no longer asserted, so a
+* request latched while the channel was filling or draining the FIFO does not start another burst.
+*/
+void sim_dma_request_clear(uint8_t source)
+{
+	pending_sources &= ~(1ull << source);
+}
+
+bool sim_dma_source_enabled(uint8_t source)
+{
+	DMA_Type    *dma = SIM_VIEW(DMA);
+	DMAMUX_Type *mux = SIM_VIEW(DMAMUX);
+	uint8_t ch;
+
+	for (ch = 0; ch < SIM_DMA_CHANNELS; ch++)
+	{
+		if ((mux->CHCFG[ch] == (DMAMUX_CHCFG_ENBL_MASK | source)) && (dma->ERQ & (1u << ch)))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void sim_dma_periodic(uint8_t ch)
+{
+	DMA_Type    *dma = SIM_VIEW(DMA);
+	DMAMUX_Type *mux = SIM_VIEW(DMAMUX);
+	uint8_t cfg = mux->CHCFG[ch];
+	uint8_t source = cfg & DMAMUX_CHCFG_SOURCE_MASK;
+	bool always = (source == EDMA_REQ_DMAMUX_ALWAYS_ENABLED0) || (source == EDMA_REQ_DMAMUX_ALWAYS_ENABLED1);
+
+	if ((cfg & (DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_TRIG_MASK)) == (DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_TRIG_MASK) &&
+		(dma->ERQ & (1u << ch)) && (always || (pending_sources & (1ull << source))))
+	{
+		pending_sources &= ~(1ull << source);
+		start(ch);
+	}
+}
+
+/*!
+* @brief Apply a command register byte: bit 6 selects all channels, else bits 3:0 the channel.
+*/
+static uint32_t command_mask(uint8_t value)
+{
+	return (value & SIM_DMA_ALL) ? 0xFFFFu : (1u << (value & 0x0Fu));
+}
+
+void sim_dma_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	DMA_Type *dma = SIM_VIEW(DMA);
+	uint8_t value = SIM_BYTE(new_word, offset);
+	uint32_t mask = command_mask(value);
+	uint8_t ch;
+	(void)instance;
+
+	if ((offset >= 0x18u) && (offset < 0x20u))
+	{
+		if (value & 0x80u)												/* NOP bit */
+		{
+			mask = 0;
+		}
+		switch (offset)
+		{
+			case 0x18u: dma->EEI &= ~mask;									break;	/* CEEI */
+			case 0x19u: dma->EEI |= mask;									break;	/* SEEI */
+			case 0x1Au: dma->ERQ &= ~mask;									break;	/* CERQ */
+			case 0x1Bu: dma->ERQ |= mask;									break;	/* SERQ */
+			case 0x1Du:																	/* SSRT */
+				for (ch = 0; ch < SIM_DMA_CHANNELS; ch++)
+				{
+					if (mask & (1u << ch))
+					{
+						link(ch);
+					}
+				}
+				break;
+			case 0x1Eu: dma->ERR &= ~mask;									break;	/* CERR */
+			case 0x1Fu: dma->INT &= ~mask;									break;	/* CINT */
+			default:																	/* CDNE */
+				for (ch = 0; ch < SIM_DMA_CHANNELS; ch++)
+				{
+					if (mask & (1u << ch))
+					{
+						dma->TCD[ch].CSR &= (uint16_t)~DMA_CSR_DONE;
+					}
+				}
+				break;
+		}
+		*(volatile uint32_t *)&dma->CEEI = 0;							/* Command registers read as zero */
+		route();
+	}
+	else if (offset == 0x0Cu)											/* ERQ */
+	{
+		route();
+	}
+	else if (offset == 0x24u)											/* INT, write 1 to clear */
+	{
+		dma->INT = old_word & ~new_word;
+	}
+	else if (offset == 0x2Cu)											/* ERR, write 1 to clear */
+	{
+		dma->ERR = old_word & ~new_word;
+	}
+	else if ((offset >= 0x1000u) && ((offset & 0x1Fu) >= 0x1Cu) && ((offset & 0x1Fu) < 0x1Eu))
+	{
+		ch = (uint8_t)((offset - 0x1000u) >> 5);						/* TCD CSR */
+		if ((dma->TCD[ch].CSR & DMA_CSR_START) && !(old_word & DMA_CSR_START))
+		{
+			start(ch);
+		}
+	}
+}
+
+void sim_dmamux_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	(void)instance;
+	(void)offset;
+	(void)old_word;
+	(void)new_word;
+	route();
+}
+
+void sim_dma_reset(void)
+{
+	pending_sources = 0;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "sim_internal.h"
+
+/*!
+ * FTFC / P-Flash model
+ * ===================================================
+ * The upper P-Flash block (SIM_FLASH_BASE, where applications keep their data sectors) is a
+ * region of its own: reads return the array, CPU stores are dropped as on the device. The FTFC
+ * executes Erase Flash Sector and Program Phrase launched by writing FSTAT[CCIF]; CCIF is back
+ * after the typical command time, and other commands or addresses set ACCERR.
+ */
+
+#define SIM_FLASH_ERASE_US		(12000u)			/* Erase Flash Sector, typical */
+#define SIM_FLASH_PROGRAM_US	(90u)				/* Program Phrase, typical */
+#define SIM_FLASH_SECTOR		(0x1000u)
+#define SIM_FLASH_PHRASE		(8u)
+#define SIM_FLASH_FSTAT_ERRORS	(FTFC_FSTAT_RDCOLERR_MASK | FTFC_FSTAT_ACCERR_MASK | FTFC_FSTAT_FPVIOL_MASK)
+
+static uint8_t *array(uint32_t address)
+{
+	return (uint8_t *)sim_view(address);
+}
+
+static bool in_array(uint32_t address, uint32_t size)
+{
+	return (address >= SIM_FLASH_BASE) && (address - SIM_FLASH_BASE + size <= SIM_FLASH_SIZE);
+}
+
+static uint32_t command_address(const FTFC_Type *ftfc)
+{
+	return ((uint32_t)ftfc->FCCOB[2] << 16) | ((uint32_t)ftfc->FCCOB[1] << 8) | ftfc->FCCOB[0];	/* FCCOB1-3 */
+}
+
+static void command_done(uint32_t arg)
+{
+	FTFC_Type *ftfc = SIM_VIEW(FTFC);
+	uint32_t   address = command_address(ftfc);
+	uint8_t   *cell = array(address);
+	uint8_t    i;
+	(void)arg;
+
+	if (ftfc->FCCOB[3] == 0x09u)												/* Erase Flash Sector */
+	{
+		memset(cell, 0xFF, SIM_FLASH_SECTOR);
+	}
+	else
+	{
+		for (i = 0; i < SIM_FLASH_PHRASE; i++)									/* Program Phrase: FCCOB4-B */
+		{
+			if (cell[i] != 0xFFu)
+			{
+				ftfc->FSTAT |= FTFC_FSTAT_MGSTAT0_MASK;							/* Not erased: verify fails */
+			}
+			cell[i] &= ftfc->FCCOB[4u + i];
+		}
+	}
+	ftfc->FSTAT |= FTFC_FSTAT_CCIF_MASK;
+}
+
+static void launch(FTFC_Type *ftfc)
+{
+	uint32_t address = command_address(ftfc);
+
+	ftfc->FSTAT &= (uint8_t)~FTFC_FSTAT_MGSTAT0_MASK;
+	switch (ftfc->FCCOB[3])
+	{
+		case 0x09u:
+			if (((address % SIM_FLASH_SECTOR) == 0u) && in_array(address, SIM_FLASH_SECTOR))
+			{
+				ftfc->FSTAT &= (uint8_t)~FTFC_FSTAT_CCIF_MASK;
+				sim_schedule(SIM_US_TO_CYCLES(SIM_FLASH_ERASE_US), command_done, 0u);
+				return;
+			}
+			break;
+		case 0x07u:
+			if (((address % SIM_FLASH_PHRASE) == 0u) && in_array(address, SIM_FLASH_PHRASE))
+			{
+				ftfc->FSTAT &= (uint8_t)~FTFC_FSTAT_CCIF_MASK;
+				sim_schedule(SIM_US_TO_CYCLES(SIM_FLASH_PROGRAM_US), command_done, 0u);
+				return;
+			}
+			break;
+		default:
+			break;
+	}
+	ftfc->FSTAT |= FTFC_FSTAT_ACCERR_MASK;										/* Not modeled: command not run */
+}
+
+void sim_ftfc_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	FTFC_Type *ftfc = SIM_VIEW(FTFC);
+	uint8_t    old_fstat = SIM_BYTE(old_word, 0u);
+	uint8_t    written;
+	(void)instance;
+
+	if ((offset != 0u) || (sim_access_size() != 1u))
+	{
+		return;																	/* FCCOB and configuration bytes are plain storage */
+	}
+	written = SIM_BYTE(new_word, 0u);
+	ftfc->FSTAT = (uint8_t)(old_fstat & ~(written & SIM_FLASH_FSTAT_ERRORS));	/* Error flags are w1c, CCIF launches */
+	if ((written & FTFC_FSTAT_CCIF_MASK) && (old_fstat & FTFC_FSTAT_CCIF_MASK) &&
+		!(ftfc->FSTAT & (FTFC_FSTAT_ACCERR_MASK | FTFC_FSTAT_FPVIOL_MASK)))
+	{
+		launch(ftfc);
+	}
+}
+
+void sim_flash_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	(void)instance;
+	(void)new_word;
+	*(uint32_t *)array(SIM_FLASH_BASE + (offset & ~3u)) = old_word;			/* Flash is written by the FTFC only */
+}
+
+void sim_flash_reset(void)
+{
+	memset(array(SIM_FLASH_BASE), 0xFF, SIM_FLASH_SIZE);
+	SIM_VIEW(FTFC)->FSTAT = FTFC_FSTAT_CCIF_MASK;
+}
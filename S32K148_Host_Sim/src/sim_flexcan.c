@@ -0,0 +1,684 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "sim_internal.h"
+
+/*!
+ * FlexCAN model
+ * ===================================================
+ * CAN0, CAN1 and CAN2 share one simulated bus. MCR reports the MDIS/FRZ/HALT handshakes
+ * (LPMACK, FRZACK, NOTRDY) immediately. A message buffer written with CODE = DATA (0xC) takes
+ * part in arbitration (lowest ID, or lowest MB with CTRL1[LBUF]) and is sent after the frame
+ * time given by CBT/CTRL1 and FDCBT; the frame is then received by the other controllers (and
+ * by the sender unless MCR[SRXDIS]) through the RX MB matching rules: RXMGMASK, RX14MASK,
+ * RX15MASK or RXIMR with MCR[IRMQ], EMPTY before FULL/OVERRUN, MB lock on C/S read released by
+ * a TIMER read. MB size follows FDCTRL[MBDSR0] with MCR[FDEN].
+ *
+ * The legacy RX FIFO (MCR[RFEN]) is six frames deep with ID filter table format A; output is
+ * MB0, IFLAG1 bits 5/6/7 are frame available / warning / overflow and RXFIR holds the filter
+ * hit. With MCR[DMA] the frame available condition is a DMA request instead, and reading the
+ * last word of the output MB pops the FIFO.
+ *
+ * SIM_CAN_inject puts a frame on the bus; payload words use the RAMn byte order (byte 0 in
+ * bits 31:24).
+ */
+
+#define SIM_CAN_COUNT			(3u)
+#define SIM_CAN_FIFO_DEPTH		(6u)
+#define SIM_CAN_SOSC_HZ			(8000000u)		/* CTRL1[CLKSRC] = 0: oscillator clock */
+
+enum
+{
+	MB_CODE_RX_INACTIVE = 0x0u,
+	MB_CODE_RX_FULL     = 0x2u,
+	MB_CODE_RX_EMPTY    = 0x4u,
+	MB_CODE_RX_OVERRUN  = 0x6u,
+	MB_CODE_TX_INACTIVE = 0x8u,
+	MB_CODE_TX_ABORT    = 0x9u,
+	MB_CODE_TX_DATA     = 0xCu
+};
+
+#define MB_CS_EDL				(0x80000000u)
+#define MB_CS_BRS				(0x40000000u)
+#define MB_CS_CODE_SHIFT		(24u)
+#define MB_CS_CODE_MASK			(0x0F000000u)
+#define MB_CS_SRR				(0x00400000u)
+#define MB_CS_IDE				(0x00200000u)
+#define MB_CS_RTR				(0x00100000u)
+#define MB_CS_DLC_SHIFT			(16u)
+#define MB_CS_DLC_MASK			(0x000F0000u)
+#define MB_ID_MASK				(0x1FFFFFFFu)
+#define MB_ID_STD_SHIFT			(18u)
+
+#define IFLAG_FIFO_AVAILABLE	(1u << 5)
+#define IFLAG_FIFO_WARNING		(1u << 6)
+#define IFLAG_FIFO_OVERFLOW		(1u << 7)
+
+typedef struct
+{
+	uint32_t cs;						/* EDL, BRS, SRR, IDE, RTR and DLC as in the MB C/S word */
+	uint32_t id;						/* MB ID word (standard ID in bits 28:18) */
+	uint32_t data[16];
+	uint16_t hit;						/* RX FIFO filter element that accepted the frame */
+} sim_can_frame_t;
+
+typedef struct
+{
+	int16_t         tx_mb;				/* MB being transmitted, -1 when the controller is idle */
+	int16_t         locked;				/* MB locked by a C/S read, -1 when none */
+	bool            held_valid;			/* Frame waiting for the locked MB (serial message buffer) */
+	uint8_t         held_mb;
+	sim_can_frame_t held;
+	sim_can_frame_t fifo[SIM_CAN_FIFO_DEPTH];
+	uint8_t         fifo_count;
+} sim_can_t;
+
+static CAN_Type * const cans[SIM_CAN_COUNT] = CAN_BASE_PTRS;
+static const IRQn_Type irqs_0_15[SIM_CAN_COUNT] = CAN_ORed_0_15_MB_IRQS;
+static const IRQn_Type irqs_16_31[SIM_CAN_COUNT] = CAN_ORed_16_31_MB_IRQS;
+static sim_can_t state[SIM_CAN_COUNT];
+static void (*tx_hook)(uint8_t instance, uint32_t id, uint8_t dlc, const uint32_t *payload);
+
+static const uint8_t dlc_bytes[16] = { 0u, 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u, 12u, 16u, 20u, 24u, 32u, 48u, 64u };
+
+void SIM_CAN_set_tx_hook(void (*hook)(uint8_t instance, uint32_t id, uint8_t dlc, const uint32_t *payload))
+{
+	tx_hook = hook;
+}
+
+/*!
+ * Message buffer geometry
+ * ===================================================
+ */
+static uint32_t payload_bytes(CAN_Type *can)
+{
+	if (!(can->MCR & CAN_MCR_FDEN_MASK))
+	{
+		return 8u;
+	}
+	return 8u << ((can->FDCTRL & CAN_FDCTRL_MBDSR0_MASK) >> CAN_FDCTRL_MBDSR0_SHIFT);
+}
+
+static uint32_t mb_words(CAN_Type *can)
+{
+	return 2u + payload_bytes(can) / 4u;
+}
+
+static uint32_t mb_count(CAN_Type *can)
+{
+	uint32_t fit = CAN_RAMn_COUNT / mb_words(can);
+	uint32_t last = (can->MCR & CAN_MCR_MAXMB_MASK) + 1u;
+	return (last < fit) ? last : fit;
+}
+
+static volatile uint32_t *mb_of(CAN_Type *can, uint32_t mb)
+{
+	return &can->RAMn[mb * mb_words(can)];
+}
+
+/*!
+* @brief First MB available to the matching process: the RX FIFO area and filter table (MB0
+* up to the last filter element) is skipped when the FIFO is enabled.
+*/
+static uint32_t first_mb(CAN_Type *can)
+{
+	if (can->MCR & CAN_MCR_RFEN_MASK)
+	{
+		uint32_t filters = 8u * (((can->CTRL2 & CAN_CTRL2_RFFN_MASK) >> CAN_CTRL2_RFFN_SHIFT) + 1u);
+		return 6u + filters / 4u;
+	}
+	return 0u;
+}
+
+static bool running(CAN_Type *can)
+{
+	return !(can->MCR & (CAN_MCR_MDIS_MASK | CAN_MCR_NOTRDY_MASK));
+}
+
+static void set_flag(uint8_t instance, uint32_t mb)
+{
+	CAN_Type *can = SIM_VIEW(cans[instance]);
+	can->IFLAG1 |= 1u << mb;
+	if (can->IMASK1 & (1u << mb))
+	{
+		sim_irq_raise((mb < 16u) ? irqs_0_15[instance] : irqs_16_31[instance]);
+	}
+}
+
+/*!
+ * Bit timing
+ * ===================================================
+ */
+static uint64_t bit_cycles(CAN_Type *can, bool data_phase)
+{
+	uint32_t hz = (can->CTRL1 & CAN_CTRL1_CLKSRC_MASK) ? SIM_BUS_CLOCK_HZ : SIM_CAN_SOSC_HZ;
+	uint32_t presdiv;
+	uint32_t tq;
+
+	if (data_phase)
+	{
+		uint32_t fdcbt = can->FDCBT;
+		presdiv = ((fdcbt & CAN_FDCBT_FPRESDIV_MASK) >> CAN_FDCBT_FPRESDIV_SHIFT) + 1u;
+		tq = 1u + ((fdcbt & CAN_FDCBT_FPROPSEG_MASK) >> CAN_FDCBT_FPROPSEG_SHIFT)
+				+ ((fdcbt & CAN_FDCBT_FPSEG1_MASK) >> CAN_FDCBT_FPSEG1_SHIFT) + 1u
+				+ ((fdcbt & CAN_FDCBT_FPSEG2_MASK) >> CAN_FDCBT_FPSEG2_SHIFT) + 1u;
+	}
+	else if (can->CBT & CAN_CBT_BTF_MASK)
+	{
+		uint32_t cbt = can->CBT;
+		presdiv = ((cbt & CAN_CBT_EPRESDIV_MASK) >> CAN_CBT_EPRESDIV_SHIFT) + 1u;
+		tq = 1u + ((cbt & CAN_CBT_EPROPSEG_MASK) >> CAN_CBT_EPROPSEG_SHIFT) + 1u
+				+ ((cbt & CAN_CBT_EPSEG1_MASK) >> CAN_CBT_EPSEG1_SHIFT) + 1u
+				+ ((cbt & CAN_CBT_EPSEG2_MASK) >> CAN_CBT_EPSEG2_SHIFT) + 1u;
+	}
+	else
+	{
+		uint32_t ctrl1 = can->CTRL1;
+		presdiv = ((ctrl1 & CAN_CTRL1_PRESDIV_MASK) >> CAN_CTRL1_PRESDIV_SHIFT) + 1u;
+		tq = 1u + ((ctrl1 & CAN_CTRL1_PROPSEG_MASK) >> CAN_CTRL1_PROPSEG_SHIFT) + 1u
+				+ ((ctrl1 & CAN_CTRL1_PSEG1_MASK) >> CAN_CTRL1_PSEG1_SHIFT) + 1u
+				+ ((ctrl1 & CAN_CTRL1_PSEG2_MASK) >> CAN_CTRL1_PSEG2_SHIFT) + 1u;
+	}
+	return ((uint64_t)presdiv * tq * SIM_BUS_CLOCK_HZ + hz - 1u) / hz;
+}
+
+/*!
+* @brief Frame duration: arbitration and trailer at the nominal rate, control, data and CRC
+* at the data rate when the frame switches bit rate. Classic frames add 20 % for stuffing.
+*/
+static uint64_t frame_cycles(CAN_Type *can, const sim_can_frame_t *frame)
+{
+	bool     ide = (frame->cs & MB_CS_IDE) != 0u;
+	bool     edl = (frame->cs & MB_CS_EDL) != 0u;
+	bool     brs = edl && (frame->cs & MB_CS_BRS) && (can->FDCTRL & CAN_FDCTRL_FDRATE_MASK);
+	uint32_t bytes = dlc_bytes[(frame->cs & MB_CS_DLC_MASK) >> MB_CS_DLC_SHIFT];
+	uint32_t arbitration = ide ? 32u : 13u;
+	uint32_t trailer = 13u;													/* ACK, EOF and intermission */
+	uint32_t data;
+
+	if (!edl)
+	{
+		bytes = (bytes > 8u) ? 8u : bytes;
+		data = 7u + 8u * bytes + 16u;
+		return (uint64_t)(arbitration + data + trailer) * 6u / 5u * bit_cycles(can, false);
+	}
+	data = 8u + 8u * bytes + ((bytes <= 16u) ? 22u : 27u);					/* Fixed stuff bits included */
+	return (uint64_t)(arbitration + 3u + trailer) * bit_cycles(can, false)
+		 + (uint64_t)data * bit_cycles(can, brs);
+}
+
+static uint16_t timer_now(CAN_Type *can)
+{
+	return (uint16_t)(sim_now() / bit_cycles(can, false));
+}
+
+/*!
+ * Reception
+ * ===================================================
+ */
+static uint32_t rx_mask(CAN_Type *can, uint32_t mb)
+{
+	if (can->MCR & CAN_MCR_IRMQ_MASK)
+	{
+		return can->RXIMR[mb];
+	}
+	return (mb == 14u) ? can->RX14MASK : (mb == 15u) ? can->RX15MASK : can->RXMGMASK;
+}
+
+static void store(CAN_Type *can, volatile uint32_t *mb, const sim_can_frame_t *frame, uint32_t code)
+{
+	uint32_t words = payload_bytes(can) / 4u;
+	uint32_t i;
+
+	for (i = 0; i < words; i++)
+	{
+		mb[2u + i] = frame->data[i];
+	}
+	mb[1] = (mb[1] & ~MB_ID_MASK) | (frame->id & MB_ID_MASK);
+	mb[0] = frame->cs | (code << MB_CS_CODE_SHIFT) | timer_now(can);
+}
+
+/*!
+* @brief Filter element of the RX FIFO table in format A: RTR 31, IDE 30, ID 29:1.
+*/
+static uint32_t fifo_element(const sim_can_frame_t *frame)
+{
+	uint32_t element = (frame->cs & MB_CS_RTR) ? 0x80000000u : 0u;
+	if (frame->cs & MB_CS_IDE)
+	{
+		element |= 0x40000000u | ((frame->id & MB_ID_MASK) << 1);
+	}
+	else
+	{
+		element |= ((frame->id >> MB_ID_STD_SHIFT) & 0x7FFu) << 19;
+	}
+	return element;
+}
+
+static void fifo_output(uint8_t instance)
+{
+	CAN_Type  *can = SIM_VIEW(cans[instance]);
+	sim_can_t *s = &state[instance];
+
+	if (s->fifo_count == 0u)
+	{
+		return;
+	}
+	store(can, &can->RAMn[0], &s->fifo[0], 0u);
+	SIM_RO(can->RXFIR) = s->fifo[0].hit;
+	if (can->MCR & CAN_MCR_DMA_MASK)
+	{
+		can->IFLAG1 |= IFLAG_FIFO_AVAILABLE;
+		sim_dma_request((uint8_t)(EDMA_REQ_FLEXCAN0 + instance));
+	}
+	else
+	{
+		set_flag(instance, 5u);
+	}
+}
+
+static void fifo_pop(uint8_t instance)
+{
+	sim_can_t *s = &state[instance];
+	if (s->fifo_count != 0u)
+	{
+		s->fifo_count--;
+		memmove(&s->fifo[0], &s->fifo[1], s->fifo_count * sizeof(sim_can_frame_t));
+	}
+	fifo_output(instance);
+}
+
+static bool fifo_receive(uint8_t instance, sim_can_frame_t *frame)
+{
+	CAN_Type  *can = SIM_VIEW(cans[instance]);
+	sim_can_t *s = &state[instance];
+	uint32_t   filters = 8u * (((can->CTRL2 & CAN_CTRL2_RFFN_MASK) >> CAN_CTRL2_RFFN_SHIFT) + 1u);
+	uint32_t   element = fifo_element(frame);
+	uint32_t   k;
+
+	for (k = 0; k < filters; k++)
+	{
+		uint32_t mask = ((can->MCR & CAN_MCR_IRMQ_MASK) && (k < CAN_RXIMR_COUNT)) ? can->RXIMR[k] : can->RXFGMASK;
+		if (((can->RAMn[24u + k] ^ element) & mask) == 0u)
+		{
+			break;
+		}
+	}
+	if (k == filters)
+	{
+		return false;
+	}
+	if (s->fifo_count == SIM_CAN_FIFO_DEPTH)
+	{
+		set_flag(instance, 7u);											/* Overflow: frame lost */
+		return true;
+	}
+	frame->hit = (uint16_t)k;
+	s->fifo[s->fifo_count++] = *frame;
+	if (s->fifo_count == SIM_CAN_FIFO_DEPTH - 1u)
+	{
+		set_flag(instance, 6u);											/* Almost full */
+	}
+	if (s->fifo_count == 1u)
+	{
+		fifo_output(instance);
+	}
+	return true;
+}
+
+static void receive(uint8_t instance, sim_can_frame_t *frame)
+{
+	CAN_Type  *can = SIM_VIEW(cans[instance]);
+	sim_can_t *s = &state[instance];
+	uint32_t   count = mb_count(can);
+	int32_t    full = -1;
+	uint32_t   mb;
+
+	if (!running(can) || (can->MCR & CAN_MCR_HALT_MASK))
+	{
+		return;
+	}
+	if ((can->MCR & CAN_MCR_RFEN_MASK) && fifo_receive(instance, frame))
+	{
+		return;
+	}
+	for (mb = first_mb(can); mb < count; mb++)
+	{
+		volatile uint32_t *buf = mb_of(can, mb);
+		uint32_t code = (buf[0] & MB_CS_CODE_MASK) >> MB_CS_CODE_SHIFT;
+		uint32_t mask = rx_mask(can, mb);
+		bool ide = (buf[0] & MB_CS_IDE) != 0u;
+
+		if (((code != MB_CODE_RX_EMPTY) && (code != MB_CODE_RX_FULL) && (code != MB_CODE_RX_OVERRUN)) ||
+			(ide != ((frame->cs & MB_CS_IDE) != 0u)) ||
+			((ide ? ((buf[1] ^ frame->id) & mask & MB_ID_MASK)
+				  : ((buf[1] ^ frame->id) & mask & (0x7FFu << MB_ID_STD_SHIFT))) != 0u))
+		{
+			continue;
+		}
+		if (code == MB_CODE_RX_EMPTY)
+		{
+			full = (int32_t)mb;
+			break;
+		}
+		full = (int32_t)mb | 0x10000;									/* Last FULL match, overrun if no EMPTY */
+	}
+	if (full < 0)
+	{
+		return;
+	}
+	mb = (uint32_t)full & 0xFFFFu;
+	if (s->locked == (int16_t)mb)
+	{
+		s->held = *frame;												/* Wait in the serial message buffer */
+		s->held_mb = (uint8_t)mb;
+		s->held_valid = true;
+		return;
+	}
+	store(can, mb_of(can, mb), frame, (full & 0x10000) ? MB_CODE_RX_OVERRUN : MB_CODE_RX_FULL);
+	set_flag(instance, mb);
+}
+
+static void bus_deliver(uint8_t sender, sim_can_frame_t *frame)
+{
+	CAN_Type *can = SIM_VIEW(cans[sender]);
+	uint8_t instance;
+
+	for (instance = 0; instance < SIM_CAN_COUNT; instance++)
+	{
+		if ((instance == sender) ? !(can->MCR & CAN_MCR_SRXDIS_MASK) : !(can->CTRL1 & CAN_CTRL1_LPB_MASK))
+		{
+			sim_can_frame_t copy = *frame;
+			receive(instance, &copy);
+		}
+	}
+}
+
+void SIM_CAN_inject(uint8_t instance, uint32_t id, uint8_t extended, uint8_t dlc, uint8_t fd, const uint32_t *payload)
+{
+	sim_can_frame_t frame;
+
+	memset(&frame, 0, sizeof(frame));
+	frame.cs = ((uint32_t)(dlc & 0xFu) << MB_CS_DLC_SHIFT) | (fd ? (MB_CS_EDL | MB_CS_BRS) : 0u);
+	if (extended)
+	{
+		frame.cs |= MB_CS_IDE | MB_CS_SRR;
+		frame.id = id & MB_ID_MASK;
+	}
+	else
+	{
+		frame.id = (id & 0x7FFu) << MB_ID_STD_SHIFT;
+	}
+	if (payload != NULL)
+	{
+		memcpy(frame.data, payload, (dlc_bytes[dlc & 0xFu] + 3u) / 4u * sizeof(uint32_t));
+	}
+	receive(instance, &frame);
+	sim_irq_dispatch();
+}
+
+/*!
+ * Transmission
+ * ===================================================
+ */
+static void tx_done(uint32_t instance);
+
+/*!
+* @brief Start the next transmission: lowest ID wins, or lowest MB with CTRL1[LBUF]. With
+* MCR[LPRIOEN] the PRIO field of the ID word is compared before the ID.
+*/
+static void tx_arbitrate(uint8_t instance)
+{
+	CAN_Type  *can = SIM_VIEW(cans[instance]);
+	sim_can_t *s = &state[instance];
+	uint32_t   count = mb_count(can);
+	uint64_t   best_id = UINT64_MAX;
+	int16_t    best = -1;
+	uint32_t   mb;
+
+	if ((s->tx_mb >= 0) || !running(can) || (can->MCR & CAN_MCR_HALT_MASK))
+	{
+		return;
+	}
+	for (mb = first_mb(can); mb < count; mb++)
+	{
+		volatile uint32_t *buf = mb_of(can, mb);
+		uint64_t arbitration;
+		if (((buf[0] & MB_CS_CODE_MASK) >> MB_CS_CODE_SHIFT) != MB_CODE_TX_DATA)
+		{
+			continue;
+		}
+		if (can->CTRL1 & CAN_CTRL1_LBUF_MASK)
+		{
+			best = (int16_t)mb;
+			break;
+		}
+		/* Compare IDs as they go on the wire: base ID first, then IDE, then the extension */
+		arbitration = (buf[0] & MB_CS_IDE) ? (((buf[1] & MB_ID_MASK) << 1) | 1u)
+										   : (((buf[1] >> MB_ID_STD_SHIFT) & 0x7FFu) << 19);
+		if (can->MCR & CAN_MCR_LPRIOEN_MASK)
+		{
+			arbitration |= (uint64_t)(buf[1] >> 29) << 30;
+		}
+		if (arbitration < best_id)
+		{
+			best_id = arbitration;
+			best = (int16_t)mb;
+		}
+	}
+	if (best >= 0)
+	{
+		volatile uint32_t *buf = mb_of(can, (uint32_t)best);
+		sim_can_frame_t frame;
+		frame.cs = buf[0];
+		s->tx_mb = best;
+		sim_schedule(frame_cycles(can, &frame), tx_done, instance);
+	}
+}
+
+static void tx_done(uint32_t instance)
+{
+	CAN_Type  *can = SIM_VIEW(cans[instance]);
+	sim_can_t *s = &state[instance];
+	uint32_t   mb = (uint32_t)s->tx_mb;
+	volatile uint32_t *buf = mb_of(can, mb);
+	uint32_t   code = (buf[0] & MB_CS_CODE_MASK) >> MB_CS_CODE_SHIFT;
+
+	s->tx_mb = -1;
+	if ((code == MB_CODE_TX_DATA) || (code == MB_CODE_TX_ABORT))
+	{
+		sim_can_frame_t frame;
+		uint32_t words = payload_bytes(can) / 4u;
+		uint32_t i;
+
+		memset(&frame, 0, sizeof(frame));
+		frame.cs = buf[0] & (MB_CS_EDL | MB_CS_BRS | MB_CS_SRR | MB_CS_IDE | MB_CS_RTR | MB_CS_DLC_MASK);
+		frame.id = buf[1] & MB_ID_MASK;
+		for (i = 0; i < words; i++)
+		{
+			frame.data[i] = buf[2u + i];
+		}
+		buf[0] = (buf[0] & ~(MB_CS_CODE_MASK | 0xFFFFu)) | (MB_CODE_TX_INACTIVE << MB_CS_CODE_SHIFT) | timer_now(can);
+		set_flag((uint8_t)instance, mb);
+		if (tx_hook != NULL)
+		{
+			tx_hook((uint8_t)instance, (frame.cs & MB_CS_IDE) ? frame.id : (frame.id >> MB_ID_STD_SHIFT),
+					(uint8_t)((frame.cs & MB_CS_DLC_MASK) >> MB_CS_DLC_SHIFT), frame.data);
+		}
+		bus_deliver((uint8_t)instance, &frame);
+	}
+	tx_arbitrate((uint8_t)instance);
+}
+
+/*!
+ * Register hooks
+ * ===================================================
+ */
+static void mcr_update(uint8_t instance, uint32_t new_word)
+{
+	CAN_Type *can = SIM_VIEW(cans[instance]);
+	uint32_t mcr = new_word & ~(CAN_MCR_LPMACK_MASK | CAN_MCR_FRZACK_MASK | CAN_MCR_NOTRDY_MASK | CAN_MCR_SOFTRST_MASK);
+
+	if (new_word & CAN_MCR_SOFTRST_MASK)
+	{
+		mcr = 0xD890000Fu & ~(CAN_MCR_LPMACK_MASK | CAN_MCR_FRZACK_MASK | CAN_MCR_NOTRDY_MASK);
+		can->IMASK1 = 0;
+		can->IFLAG1 = 0;
+		can->CTRL1 &= CAN_CTRL1_CLKSRC_MASK;
+	}
+	if (mcr & CAN_MCR_MDIS_MASK)
+	{
+		mcr |= CAN_MCR_LPMACK_MASK | CAN_MCR_NOTRDY_MASK;
+	}
+	else if ((mcr & CAN_MCR_FRZ_MASK) && (mcr & CAN_MCR_HALT_MASK))
+	{
+		mcr |= CAN_MCR_FRZACK_MASK | CAN_MCR_NOTRDY_MASK;
+	}
+	can->MCR = mcr;
+	if (running(can) && !(mcr & CAN_MCR_HALT_MASK))
+	{
+		can->ESR1 |= CAN_ESR1_SYNCH_MASK | CAN_ESR1_IDLE_MASK;
+		tx_arbitrate(instance);
+	}
+	else
+	{
+		can->ESR1 &= ~(CAN_ESR1_SYNCH_MASK | CAN_ESR1_IDLE_MASK);
+	}
+}
+
+void sim_flexcan_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	CAN_Type  *can = SIM_VIEW(cans[instance]);
+	sim_can_t *s = &state[instance];
+
+	if (offset == 0x00u)
+	{
+		mcr_update(instance, new_word);
+	}
+	else if (offset == 0x28u)											/* IMASK1: pending flags raise at unmask */
+	{
+		if (new_word & ~old_word & can->IFLAG1)
+		{
+			sim_irq_raise(irqs_0_15[instance]);
+		}
+	}
+	else if (offset == 0x30u)											/* IFLAG1, write 1 to clear */
+	{
+		can->IFLAG1 = old_word & ~new_word;
+		if ((can->MCR & CAN_MCR_RFEN_MASK) && (old_word & new_word & IFLAG_FIFO_AVAILABLE))
+		{
+			fifo_pop(instance);
+		}
+	}
+	else if (offset == 0x20u)											/* ESR1: interrupt flags are w1c */
+	{
+		can->ESR1 = SIM_W1C(old_word, new_word, 0x003B0006u);
+	}
+	else if ((offset >= 0x80u) && (offset < 0x80u + 4u * CAN_RAMn_COUNT))
+	{
+		uint32_t word = (offset - 0x80u) >> 2;
+		uint32_t mb = word / mb_words(can);
+		if (((word % mb_words(can)) == 0u) && (mb < mb_count(can)))
+		{
+			uint32_t code = (new_word & MB_CS_CODE_MASK) >> MB_CS_CODE_SHIFT;
+			if (s->locked == (int16_t)mb)
+			{
+				s->locked = -1;											/* Rewriting C/S releases the lock */
+			}
+			if ((code == MB_CODE_TX_ABORT) && (can->MCR & CAN_MCR_AEN_MASK) && (s->tx_mb != (int16_t)mb))
+			{
+				set_flag(instance, mb);									/* Aborted before it reached the bus */
+			}
+			if (code == MB_CODE_TX_DATA)
+			{
+				tx_arbitrate(instance);
+			}
+		}
+	}
+}
+
+void sim_flexcan_read(uint8_t instance, uint32_t offset)
+{
+	CAN_Type  *can = SIM_VIEW(cans[instance]);
+	sim_can_t *s = &state[instance];
+
+	if (offset == 0x08u)												/* TIMER: update and release the lock */
+	{
+		can->TIMER = timer_now(can);
+		if (s->locked >= 0)
+		{
+			s->locked = -1;
+			if (s->held_valid)
+			{
+				s->held_valid = false;
+				store(can, mb_of(can, s->held_mb), &s->held, MB_CODE_RX_FULL);
+				set_flag(instance, s->held_mb);
+			}
+		}
+	}
+	else if ((can->MCR & CAN_MCR_RFEN_MASK) && (can->MCR & CAN_MCR_DMA_MASK) && (offset == 0x8Cu))
+	{
+		can->IFLAG1 &= ~IFLAG_FIFO_AVAILABLE;							/* DMA read the whole output MB */
+		fifo_pop(instance);
+	}
+	else if ((offset >= 0x80u) && (offset < 0x80u + 4u * CAN_RAMn_COUNT))
+	{
+		uint32_t word = (offset - 0x80u) >> 2;
+		uint32_t mb = word / mb_words(can);
+		uint32_t code = (mb_of(can, mb)[0] & MB_CS_CODE_MASK) >> MB_CS_CODE_SHIFT;
+		if (((word % mb_words(can)) == 0u) && (mb >= first_mb(can)) && (mb < mb_count(can)) &&
+			((code == MB_CODE_RX_FULL) || (code == MB_CODE_RX_OVERRUN)))
+		{
+			s->locked = (int16_t)mb;
+		}
+	}
+}
+
+void sim_flexcan_reset(void)
+{
+	uint8_t instance;
+	for (instance = 0; instance < SIM_CAN_COUNT; instance++)
+	{
+		CAN_Type *can = SIM_VIEW(cans[instance]);
+		memset(&state[instance], 0, sizeof(state[instance]));
+		state[instance].tx_mb  = -1;
+		state[instance].locked = -1;
+		can->MCR      = 0xD890000Fu;										/* MDIS, FRZ, HALT, NOTRDY, LPMACK, MAXMB 15 */
+		can->RXMGMASK = 0xFFFFFFFFu;
+		can->RX14MASK = 0xFFFFFFFFu;
+		can->RX15MASK = 0xFFFFFFFFu;
+		can->RXFGMASK = 0xFFFFFFFFu;
+		can->CBT      = 0;
+		can->FDCTRL   = 0x80000100u;
+	}
+}
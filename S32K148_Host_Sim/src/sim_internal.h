@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SIM_INTERNAL_H_
+#define SIM_INTERNAL_H_
+
+#include <stdbool.h>
+#include "device_registers.h"
+
+/*!
+* @brief Register block served by a behavioral model.
+*
+* Offsets are the byte offset of the accessed address from the block base. The words passed to
+* the write hook are the aligned 32-bit word holding that address before and after the driver's
+* store, so byte and halfword registers are decoded by the model from the offset.
+*/
+typedef struct
+{
+	uint32_t base;															/* Bus address of the block */
+	uint32_t size;															/* Block size in bytes */
+	uint8_t  instance;														/* Instance number passed to the hooks */
+	void (*write)(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+	void (*read) (uint8_t instance, uint32_t offset);
+} sim_block_t;
+
+typedef void (*sim_event_fn)(uint32_t arg);
+
+/* Upper P-Flash block modeled with the FTFC (data sectors of the applications) */
+#define SIM_FLASH_BASE		(0x00100000u)
+#define SIM_FLASH_SIZE		(0x00080000u)
+
+/* Register view used by the models: same storage as the bus view, never trapped */
+void *	sim_view			(uint32_t address);
+#define SIM_VIEW(instance)	((__typeof__(instance))sim_view((uint32_t)(uintptr_t)(instance)))
+bool	sim_is_register		(uint32_t address);
+
+/* Bus accesses issued by a model (eDMA) that must reach the other models' hooks */
+uint32_t sim_bus_read		(uint32_t address, uint8_t size);
+void	 sim_bus_write		(uint32_t address, uint32_t value, uint8_t size);
+uint8_t	 sim_access_size	(void);						/* Width of the access being served by a hook */
+
+/* Event queue, time in bus cycles */
+uint64_t sim_now			(void);
+void	sim_schedule		(uint64_t delay, sim_event_fn fn, uint32_t arg);
+void	sim_cancel			(sim_event_fn fn, uint32_t arg);
+bool	sim_is_scheduled	(sim_event_fn fn, uint32_t arg);
+
+/* NVIC */
+void	sim_irq_raise		(IRQn_Type irq);
+void	sim_irq_dispatch	(void);
+bool	sim_irq_pending		(void);
+bool	sim_primask			(void);
+void	sim_nvic_reset		(void);
+void	sim_nvic_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+
+/* eDMA hardware requests (dma_request_source_t numbering of S32K148_features.h) */
+void	sim_dma_request		(uint8_t source);
+void	sim_dma_request_clear(uint8_t source);			/* Level request deasserted */
+bool	sim_dma_source_enabled(uint8_t source);
+void	sim_dma_periodic	(uint8_t channel);			/* LPIT trigger of DMAMUX channels 0-3 (CHCFG[TRIG]) */
+
+/* Serial NOR flash on an LPSPI chip select (SIM_NOR_attach), bits = 0 when PCS is negated */
+bool	 sim_nor_selected	(uint8_t instance, uint8_t pcs);
+uint32_t sim_nor_transfer	(uint8_t instance, uint32_t tx, uint8_t bits, uint8_t lines);
+
+/* Functional clock of a peripheral: DIV2 output selected by PCC[PCS], 0 when off */
+uint32_t sim_pcc_clock_hz	(uint32_t pcc_index);
+
+/* Statistics shared by the models */
+extern sim_stats_t sim_stats;
+
+/* Model entry points */
+void	sim_clocks_reset	(void);
+void	sim_port_reset		(void);
+void	sim_dma_reset		(void);
+void	sim_adc_reset		(void);
+void	sim_pdb_reset		(void);
+void	sim_flexcan_reset	(void);
+void	sim_lpuart_reset	(void);
+void	sim_lpspi_reset		(void);
+void	sim_crc_reset		(void);
+void	sim_timers_reset	(void);
+void	sim_flash_reset		(void);
+void	sim_sai_reset		(void);
+void	sim_nor_reset		(void);
+
+void	sim_scg_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_smc_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_misc_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_wdog_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_port_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_gpio_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_dma_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_dmamux_write	(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_adc_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_adc_read		(uint8_t instance, uint32_t offset);
+void	sim_adc_trigger		(uint8_t instance, uint8_t sc1);
+void	sim_pdb_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_pdb_read		(uint8_t instance, uint32_t offset);
+void	sim_trgmux_pulse	(uint8_t source);				/* TRGMUX source edge, starts the PDBs selecting it */
+void	sim_flexcan_write	(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_flexcan_read	(uint8_t instance, uint32_t offset);
+void	sim_lpuart_write	(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_lpuart_read		(uint8_t instance, uint32_t offset);
+void	sim_lpspi_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_lpspi_read		(uint8_t instance, uint32_t offset);
+void	sim_crc_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_crc_read		(uint8_t instance, uint32_t offset);
+void	sim_lpit_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_lpit_read		(uint8_t instance, uint32_t offset);
+void	sim_lptmr_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_lptmr_read		(uint8_t instance, uint32_t offset);
+void	sim_ftfc_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_flash_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_sai_write		(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word);
+void	sim_sai_read		(uint8_t instance, uint32_t offset);
+
+/* Helpers for the write hooks */
+#define SIM_RO(reg)					(*(volatile uint32_t *)(uintptr_t)&(reg))	/* Model side store to an __I register */
+#define SIM_BYTE(word, offset)		((uint8_t)((word) >> (((offset) & 3u) * 8u)))
+#define SIM_HALF(word, offset)		((uint16_t)((word) >> (((offset) & 2u) * 8u)))
+#define SIM_W1C(old, written, mask)	(((old) & (mask) & ~(written)) | ((written) & ~(mask)))
+
+#endif /* SIM_INTERNAL_H_ */
@@ -0,0 +1,422 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "sim_internal.h"
+
+/*!
+ * LPSPI model (master mode)
+ * ===================================================
+ * TCR and TDR writes share the 4 entry TX FIFO as on the device: a command entry changes the
+ * frame size, PCS, WIDTH and masks of the following data, and ends the transfer in progress
+ * unless it continues it (CONT with CONTC). Each TDR word is clocked out in min(32, frame
+ * left) bits over 1, 2 or 4 lines (TCR[WIDTH]) at the SCK rate of CCR[SCKDIV] and
+ * TCR[PRESCALE], with the PCSSCK, SCKPCS and DBT delays around the chip select. TXMSK clocks a
+ * frame without TX data, RXMSK discards the received word, BYSW swaps the bytes of the words
+ * going through the FIFOs, and a full RX FIFO stalls the master unless CFGR1[NOSTALL]. TDF/RDF follow the watermarks of FCR, the other flags are w1c,
+ * and IER/DER raise LPSPIn_IRQn and the TX/RX DMA requests.
+ *
+ * The slave is the callback of SIM_LPSPI_set_device, called for each word with the bits
+ * clocked and with bits = 0 when PCS is negated. Without one, SIN reads back SOUT. A serial NOR
+ * attached with SIM_NOR_attach answers on its own chip select instead (sim_nor.c).
+ */
+
+#define SIM_LPSPI_COUNT		(3u)
+#define SIM_LPSPI_FIFO		(4u)
+
+typedef struct
+{
+	uint32_t value;
+	bool     command;
+} sim_lpspi_entry_t;
+
+typedef struct
+{
+	sim_lpspi_entry_t tx[SIM_LPSPI_FIFO];
+	uint8_t  tx_count;
+	uint32_t rx[SIM_LPSPI_FIFO];
+	uint8_t  rx_count;
+	uint32_t command;						/* TCR in effect */
+	uint32_t frame_left;					/* Bits of the current frame still to clock */
+	uint32_t masked_left;					/* Bits of a TXMSK frame still to clock */
+	uint32_t word;							/* Word on the wire */
+	uint8_t  word_bits;
+	bool     busy;
+	bool     open;							/* PCS asserted */
+	bool     warned;
+} sim_lpspi_t;
+
+static LPSPI_Type * const lpspis[SIM_LPSPI_COUNT] = LPSPI_BASE_PTRS;
+static const IRQn_Type lpspi_irqs[SIM_LPSPI_COUNT] = LPSPI_IRQS;
+static const uint32_t lpspi_pcc[SIM_LPSPI_COUNT] = { PCC_LPSPI0_INDEX, PCC_LPSPI1_INDEX, PCC_LPSPI2_INDEX };
+static sim_lpspi_t state[SIM_LPSPI_COUNT];
+static uint32_t (*device)(uint8_t instance, uint8_t pcs, uint32_t tx, uint8_t bits);
+
+void SIM_LPSPI_set_device(uint8_t instance, uint32_t (*transfer)(uint8_t instance, uint8_t pcs, uint32_t tx, uint8_t bits))
+{
+	(void)instance;
+	device = transfer;
+}
+
+static uint8_t pcs_of(uint32_t command)
+{
+	return (uint8_t)((command & LPSPI_TCR_PCS_MASK) >> LPSPI_TCR_PCS_SHIFT);
+}
+
+/*!
+* @brief Clock a word through the slave selected by the command in effect, bits = 0 negates PCS.
+*/
+static uint32_t slave(uint8_t instance, uint32_t command, uint32_t tx, uint8_t bits)
+{
+	uint8_t pcs = pcs_of(command);
+
+	if (sim_nor_selected(instance, pcs))
+	{
+		return sim_nor_transfer(instance, tx, bits, (uint8_t)(1u << ((command & LPSPI_TCR_WIDTH_MASK) >> LPSPI_TCR_WIDTH_SHIFT)));
+	}
+	if (device != NULL)
+	{
+		return device(instance, pcs, tx, bits);
+	}
+	return tx;
+}
+
+static void update(uint8_t instance)
+{
+	LPSPI_Type  *spi = SIM_VIEW(lpspis[instance]);
+	sim_lpspi_t *s = &state[instance];
+	uint32_t sr = spi->SR & ~(LPSPI_SR_TDF_MASK | LPSPI_SR_RDF_MASK | LPSPI_SR_MBF_MASK);
+
+	if (s->tx_count <= ((spi->FCR & LPSPI_FCR_TXWATER_MASK) >> LPSPI_FCR_TXWATER_SHIFT))
+	{
+		sr |= LPSPI_SR_TDF_MASK;
+	}
+	if (s->rx_count > ((spi->FCR & LPSPI_FCR_RXWATER_MASK) >> LPSPI_FCR_RXWATER_SHIFT))
+	{
+		sr |= LPSPI_SR_RDF_MASK;
+	}
+	if (s->busy || s->open)
+	{
+		sr |= LPSPI_SR_MBF_MASK;
+	}
+	spi->SR = sr;
+	SIM_RO(spi->FSR) = LPSPI_FSR_TXCOUNT(s->tx_count) | LPSPI_FSR_RXCOUNT(s->rx_count);
+	SIM_RO(spi->RDR) = (s->rx_count != 0u) ? s->rx[0] : 0u;
+	SIM_RO(spi->RSR) = (s->rx_count == 0u) ? LPSPI_RSR_RXEMPTY_MASK : 0u;
+
+	if (spi->IER & sr & 0x3F03u)
+	{
+		sim_irq_raise(lpspi_irqs[instance]);
+	}
+	if ((spi->DER & LPSPI_DER_TDDE_MASK) && (sr & LPSPI_SR_TDF_MASK))
+	{
+		sim_dma_request((uint8_t)(EDMA_REQ_LPSPI0_TX + 2u * instance));
+	}
+	else
+	{
+		sim_dma_request_clear((uint8_t)(EDMA_REQ_LPSPI0_TX + 2u * instance));
+	}
+	if ((spi->DER & LPSPI_DER_RDDE_MASK) && (sr & LPSPI_SR_RDF_MASK))
+	{
+		sim_dma_request((uint8_t)(EDMA_REQ_LPSPI0_RX + 2u * instance));
+	}
+	else
+	{
+		sim_dma_request_clear((uint8_t)(EDMA_REQ_LPSPI0_RX + 2u * instance));
+	}
+}
+
+/*!
+* @brief Bus cycles for count prescaled functional clocks, 0 when the LPSPI has no clock.
+*/
+static uint64_t clocks_to_cycles(uint8_t instance, uint64_t count)
+{
+	sim_lpspi_t *s = &state[instance];
+	uint32_t hz = sim_pcc_clock_hz(lpspi_pcc[instance]);
+
+	if (hz == 0u)
+	{
+		if (!s->warned)
+		{
+			fprintf(stderr, "sim: LPSPI%u has no functional clock (PCC)\n", instance);
+			s->warned = true;
+		}
+		return 0;
+	}
+	count <<= (s->command & LPSPI_TCR_PRESCALE_MASK) >> LPSPI_TCR_PRESCALE_SHIFT;
+	return (count * SIM_BUS_CLOCK_HZ + hz - 1u) / hz;
+}
+
+static void close_transfer(uint8_t instance)
+{
+	LPSPI_Type  *spi = SIM_VIEW(lpspis[instance]);
+	sim_lpspi_t *s = &state[instance];
+
+	if (s->open)
+	{
+		s->open = false;
+		(void)slave(instance, s->command, 0u, 0u);
+		spi->SR |= LPSPI_SR_TCF_MASK;
+	}
+}
+
+static void word_done(uint32_t instance);
+
+/*!
+* @brief Execute TX FIFO entries until a word goes on the wire or the master idles.
+*/
+static void process(uint8_t instance)
+{
+	LPSPI_Type  *spi = SIM_VIEW(lpspis[instance]);
+	sim_lpspi_t *s = &state[instance];
+
+	while (!s->busy && (spi->CR & LPSPI_CR_MEN_MASK))
+	{
+		uint32_t sckdiv = (spi->CCR & LPSPI_CCR_SCKDIV_MASK) >> LPSPI_CCR_SCKDIV_SHIFT;
+		uint32_t lines = 1u << ((s->command & LPSPI_TCR_WIDTH_MASK) >> LPSPI_TCR_WIDTH_SHIFT);
+		uint64_t clocks;
+		uint64_t cycles;
+		bool masked = s->masked_left != 0u;
+
+		if (!masked)
+		{
+			if (s->tx_count == 0u)
+			{
+				if (!(s->command & LPSPI_TCR_CONT_MASK))
+				{
+					close_transfer(instance);
+				}
+				return;
+			}
+			if (s->tx[0].command)
+			{
+				uint32_t command = s->tx[0].value;
+				if (s->open && !((s->command & LPSPI_TCR_CONT_MASK) && (command & LPSPI_TCR_CONTC_MASK)))
+				{
+					close_transfer(instance);
+				}
+				if (!(command & LPSPI_TCR_CONTC_MASK) || !s->open)
+				{
+					s->command = command;
+				}
+				else
+				{
+					s->command = (s->command & ~0x00FFFFFFu) | (command & 0x00FFFFFFu);	/* CONTC keeps PCS and timing */
+				}
+				s->frame_left = 0;
+				s->masked_left = (command & LPSPI_TCR_TXMSK_MASK) ? (command & LPSPI_TCR_FRAMESZ_MASK) + 1u : 0u;
+				s->tx_count--;
+				memmove(&s->tx[0], &s->tx[1], s->tx_count * sizeof(s->tx[0]));
+				continue;
+			}
+		}
+		if (!(s->command & LPSPI_TCR_RXMSK_MASK) && (s->rx_count == SIM_LPSPI_FIFO) &&
+			!(spi->CFGR1 & LPSPI_CFGR1_NOSTALL_MASK))
+		{
+			return;															/* Stalled on a full RX FIFO */
+		}
+		if (s->frame_left == 0u)
+		{
+			s->frame_left = (s->command & LPSPI_TCR_FRAMESZ_MASK) + 1u;
+		}
+		s->word_bits = (uint8_t)((s->frame_left < 32u) ? s->frame_left : 32u);
+		if (masked)
+		{
+			s->word = 0;
+			s->masked_left -= s->word_bits;
+		}
+		else
+		{
+			s->word = s->tx[0].value;
+			if (s->command & LPSPI_TCR_BYSW_MASK)
+			{
+				s->word = __builtin_bswap32(s->word);
+			}
+			s->tx_count--;
+			memmove(&s->tx[0], &s->tx[1], s->tx_count * sizeof(s->tx[0]));
+		}
+
+		clocks = ((uint64_t)s->word_bits + lines - 1u) / lines * (sckdiv + 2u);
+		if (!s->open)
+		{
+			clocks += ((spi->CCR & LPSPI_CCR_PCSSCK_MASK) >> LPSPI_CCR_PCSSCK_SHIFT) + 1u;
+		}
+		if ((s->frame_left == s->word_bits) && !(s->command & LPSPI_TCR_CONT_MASK))
+		{
+			clocks += ((spi->CCR & LPSPI_CCR_SCKPCS_MASK) >> LPSPI_CCR_SCKPCS_SHIFT) + 1u
+					+ ((spi->CCR & LPSPI_CCR_DBT_MASK) >> LPSPI_CCR_DBT_SHIFT) + 2u;
+		}
+		cycles = clocks_to_cycles(instance, clocks);
+		if (cycles == 0u)
+		{
+			return;
+		}
+		s->open = true;
+		s->busy = true;
+		sim_schedule(cycles, word_done, instance);
+		update(instance);
+	}
+}
+
+static void word_done(uint32_t instance)
+{
+	LPSPI_Type  *spi = SIM_VIEW(lpspis[instance]);
+	sim_lpspi_t *s = &state[instance];
+	uint32_t rx = slave((uint8_t)instance, s->command, s->word, s->word_bits);
+	bool multi = (s->command & LPSPI_TCR_WIDTH_MASK) != 0u;
+
+	if (s->word_bits < 32u)
+	{
+		rx &= (1u << s->word_bits) - 1u;
+	}
+	if (s->command & LPSPI_TCR_BYSW_MASK)
+	{
+		rx = __builtin_bswap32(rx);
+	}
+	s->busy = false;
+	s->frame_left -= s->word_bits;
+	spi->SR |= LPSPI_SR_WCF_MASK;
+
+	/* Multi-line transfers are half duplex: data is received only in TXMSK frames */
+	if (!(s->command & LPSPI_TCR_RXMSK_MASK) && (!multi || (s->command & LPSPI_TCR_TXMSK_MASK)))
+	{
+		if (s->rx_count < SIM_LPSPI_FIFO)
+		{
+			s->rx[s->rx_count++] = rx;
+		}
+		else
+		{
+			spi->SR |= LPSPI_SR_REF_MASK;
+		}
+	}
+	if (s->frame_left == 0u)
+	{
+		spi->SR |= LPSPI_SR_FCF_MASK;
+		if (!(s->command & LPSPI_TCR_CONT_MASK))
+		{
+			close_transfer((uint8_t)instance);
+		}
+	}
+	process((uint8_t)instance);
+	update((uint8_t)instance);
+}
+
+static void push(uint8_t instance, uint32_t value, bool command)
+{
+	sim_lpspi_t *s = &state[instance];
+	if (s->tx_count < SIM_LPSPI_FIFO)
+	{
+		s->tx[s->tx_count].value = value;
+		s->tx[s->tx_count].command = command;
+		s->tx_count++;
+	}
+}
+
+void sim_lpspi_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	LPSPI_Type  *spi = SIM_VIEW(lpspis[instance]);
+	sim_lpspi_t *s = &state[instance];
+
+	switch (offset)
+	{
+		case 0x10u:																/* CR */
+			spi->CR = new_word & ~(LPSPI_CR_RST_MASK | LPSPI_CR_RTF_MASK | LPSPI_CR_RRF_MASK);
+			if (new_word & (LPSPI_CR_RST_MASK | LPSPI_CR_RTF_MASK))
+			{
+				s->tx_count = 0;
+				s->masked_left = 0;
+			}
+			if (new_word & (LPSPI_CR_RST_MASK | LPSPI_CR_RRF_MASK))
+			{
+				s->rx_count = 0;
+			}
+			if (new_word & LPSPI_CR_RST_MASK)
+			{
+				sim_cancel(word_done, instance);
+				s->busy = false;
+				s->open = false;
+				spi->SR = 0;
+				spi->IER = 0;
+				spi->DER = 0;
+				spi->CFGR0 = 0;
+				spi->CFGR1 = 0;
+				spi->CCR = 0;
+				spi->FCR = 0;
+				spi->TCR = 0x0000001Fu;
+				s->command = 0x0000001Fu;
+			}
+			break;
+		case 0x14u:																/* SR: flags are w1c */
+			spi->SR = SIM_W1C(old_word, new_word, LPSPI_SR_WCF_MASK | LPSPI_SR_FCF_MASK | LPSPI_SR_TCF_MASK |
+							  LPSPI_SR_TEF_MASK | LPSPI_SR_REF_MASK | LPSPI_SR_DMF_MASK);
+			break;
+		case 0x60u:																/* TCR: command into the TX FIFO */
+			push(instance, new_word, true);
+			break;
+		case 0x64u:																/* TDR */
+			push(instance, new_word, false);
+			spi->TDR = 0;
+			break;
+		default:
+			break;
+	}
+	process(instance);
+	update(instance);
+}
+
+void sim_lpspi_read(uint8_t instance, uint32_t offset)
+{
+	sim_lpspi_t *s = &state[instance];
+
+	if ((offset == 0x74u) && (s->rx_count != 0u))								/* RDR */
+	{
+		s->rx_count--;
+		memmove(&s->rx[0], &s->rx[1], s->rx_count * sizeof(s->rx[0]));
+		process(instance);
+		update(instance);
+	}
+}
+
+void sim_lpspi_reset(void)
+{
+	uint8_t instance;
+	for (instance = 0; instance < SIM_LPSPI_COUNT; instance++)
+	{
+		LPSPI_Type *spi = SIM_VIEW(lpspis[instance]);
+		memset(&state[instance], 0, sizeof(state[instance]));
+		state[instance].command = 0x0000001Fu;
+		SIM_RO(spi->VERID) = 0x01000004u;
+		SIM_RO(spi->PARAM) = 0x00000202u;										/* 4 word TX and RX FIFOs */
+		spi->TCR = 0x0000001Fu;
+		update(instance);
+	}
+}
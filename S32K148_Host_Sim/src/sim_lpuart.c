@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "sim_internal.h"
+
+/*!
+ * LPUART model
+ * ===================================================
+ * Characters take their frame time at the baud rate given by the PCC clock, BAUD[SBR] and
+ * BAUD[OSR]. The transmitter is a buffer (a 4 entry FIFO with FIFO[TXFE]) in front of the
+ * shift register: TDRE follows the buffer level and TXWATER, TC is set once the shifter idles.
+ * Received characters (SIM_LPUART_inject, or the transmitter with CTRL[LOOPS]) arrive one per
+ * frame time into a 1 or 4 entry buffer with RDRF, OR on overflow and IDLE after the line goes
+ * quiet. TIE/TCIE/RIE/ILIE/ORIE raise LPUARTn_RxTx_IRQn, TDMAE/RDMAE raise DMA requests.
+ * Transmitted characters go to stdout unless a hook is set.
+ */
+
+#define SIM_LPUART_COUNT		(3u)
+#define SIM_LPUART_FIFO			(4u)
+#define SIM_LPUART_INPUT		(256u)
+
+typedef struct
+{
+	uint16_t tx[SIM_LPUART_FIFO + 1u];				/* Buffer plus the character in the shifter */
+	uint8_t  tx_count;
+	bool     shifting;
+	uint16_t rx[SIM_LPUART_FIFO];
+	uint8_t  rx_count;
+	uint8_t  input[SIM_LPUART_INPUT];				/* Characters still on the wire */
+	uint16_t input_head;
+	uint16_t input_count;
+	bool     warned;
+} sim_lpuart_t;
+
+static LPUART_Type * const lpuarts[SIM_LPUART_COUNT] = LPUART_BASE_PTRS;
+static const IRQn_Type lpuart_irqs[SIM_LPUART_COUNT] = LPUART_RX_TX_IRQS;
+static const uint32_t lpuart_pcc[SIM_LPUART_COUNT] = { PCC_LPUART0_INDEX, PCC_LPUART1_INDEX, PCC_LPUART2_INDEX };
+static sim_lpuart_t state[SIM_LPUART_COUNT];
+static void (*tx_hook)(uint8_t instance, uint8_t data);
+
+void SIM_LPUART_set_tx_hook(void (*hook)(uint8_t instance, uint8_t data))
+{
+	tx_hook = hook;
+}
+
+static uint8_t depth(LPUART_Type *uart, uint32_t enable)
+{
+	return (uart->FIFO & enable) ? SIM_LPUART_FIFO : 1u;
+}
+
+static uint8_t tx_level(const sim_lpuart_t *s)
+{
+	return (uint8_t)(s->tx_count - (s->shifting ? 1u : 0u));
+}
+
+/*!
+* @brief Frame time of one character in bus cycles, 0 when the LPUART has no clock.
+*/
+static uint64_t char_cycles(uint8_t instance)
+{
+	LPUART_Type *uart = SIM_VIEW(lpuarts[instance]);
+	uint32_t hz = sim_pcc_clock_hz(lpuart_pcc[instance]);
+	uint32_t sbr = uart->BAUD & LPUART_BAUD_SBR_MASK;
+	uint32_t osr = ((uart->BAUD & LPUART_BAUD_OSR_MASK) >> LPUART_BAUD_OSR_SHIFT) + 1u;
+	uint32_t bits = 1u + 8u + ((uart->CTRL & LPUART_CTRL_M_MASK) ? 1u : 0u) + ((uart->CTRL & LPUART_CTRL_PE_MASK) ? 1u : 0u)
+				  + ((uart->BAUD & LPUART_BAUD_SBNS_MASK) ? 2u : 1u);
+
+	if ((hz == 0u) || (sbr == 0u))
+	{
+		if (!state[instance].warned)
+		{
+			fprintf(stderr, "sim: LPUART%u has no functional clock (PCC) or baud rate\n", instance);
+			state[instance].warned = true;
+		}
+		return 0;
+	}
+	return ((uint64_t)bits * sbr * ((osr < 4u) ? 16u : osr) * SIM_BUS_CLOCK_HZ + hz - 1u) / hz;
+}
+
+/*!
+* @brief Recompute the status flags and raise the interrupt and DMA requests they enable.
+*/
+static void update(uint8_t instance)
+{
+	LPUART_Type  *uart = SIM_VIEW(lpuarts[instance]);
+	sim_lpuart_t *s = &state[instance];
+	uint32_t stat = uart->STAT & ~(LPUART_STAT_TDRE_MASK | LPUART_STAT_TC_MASK | LPUART_STAT_RDRF_MASK);
+	uint32_t txwater = (uart->FIFO & LPUART_FIFO_TXFE_MASK) ? (uart->WATER & LPUART_WATER_TXWATER_MASK) : 0u;
+	uint32_t rxwater = (uart->FIFO & LPUART_FIFO_RXFE_MASK)
+					 ? ((uart->WATER & LPUART_WATER_RXWATER_MASK) >> LPUART_WATER_RXWATER_SHIFT) : 0u;
+	uint32_t ctrl = uart->CTRL;
+	bool irq;
+
+	if (tx_level(s) <= txwater)
+	{
+		stat |= LPUART_STAT_TDRE_MASK;
+	}
+	if ((s->tx_count == 0u) && !s->shifting)
+	{
+		stat |= LPUART_STAT_TC_MASK;
+	}
+	if (s->rx_count > rxwater)
+	{
+		stat |= LPUART_STAT_RDRF_MASK;
+	}
+	uart->STAT = stat;
+	uart->DATA = (s->rx_count != 0u) ? s->rx[0] : 0u;
+	uart->FIFO = (uart->FIFO & ~(LPUART_FIFO_TXEMPT_MASK | LPUART_FIFO_RXEMPT_MASK))
+			   | ((tx_level(s) == 0u) ? LPUART_FIFO_TXEMPT_MASK : 0u)
+			   | ((s->rx_count == 0u) ? LPUART_FIFO_RXEMPT_MASK : 0u);
+	uart->WATER = (uart->WATER & ~(LPUART_WATER_TXCOUNT_MASK | LPUART_WATER_RXCOUNT_MASK))
+				| LPUART_WATER_TXCOUNT(tx_level(s)) | LPUART_WATER_RXCOUNT(s->rx_count);
+
+	irq = ((ctrl & LPUART_CTRL_TIE_MASK)  && (stat & LPUART_STAT_TDRE_MASK) && !(uart->BAUD & LPUART_BAUD_TDMAE_MASK)) ||
+		  ((ctrl & LPUART_CTRL_TCIE_MASK) && (stat & LPUART_STAT_TC_MASK)) ||
+		  ((ctrl & LPUART_CTRL_RIE_MASK)  && (stat & LPUART_STAT_RDRF_MASK) && !(uart->BAUD & LPUART_BAUD_RDMAE_MASK)) ||
+		  ((ctrl & LPUART_CTRL_ILIE_MASK) && (stat & LPUART_STAT_IDLE_MASK)) ||
+		  ((ctrl & LPUART_CTRL_ORIE_MASK) && (stat & LPUART_STAT_OR_MASK));
+	if (irq)
+	{
+		sim_irq_raise(lpuart_irqs[instance]);
+	}
+	if ((uart->BAUD & LPUART_BAUD_TDMAE_MASK) && (stat & LPUART_STAT_TDRE_MASK) && (ctrl & LPUART_CTRL_TE_MASK))
+	{
+		sim_dma_request((uint8_t)(EDMA_REQ_LPUART0_TX + 2u * instance));
+	}
+	if ((uart->BAUD & LPUART_BAUD_RDMAE_MASK) && (stat & LPUART_STAT_RDRF_MASK))
+	{
+		sim_dma_request((uint8_t)(EDMA_REQ_LPUART0_RX + 2u * instance));
+	}
+}
+
+static void receive_char(uint8_t instance, uint16_t data)
+{
+	LPUART_Type  *uart = SIM_VIEW(lpuarts[instance]);
+	sim_lpuart_t *s = &state[instance];
+
+	if (!(uart->CTRL & LPUART_CTRL_RE_MASK))
+	{
+		return;
+	}
+	if (s->rx_count < depth(uart, LPUART_FIFO_RXFE_MASK))
+	{
+		s->rx[s->rx_count++] = data;
+	}
+	else
+	{
+		uart->STAT |= LPUART_STAT_OR_MASK;								/* Receiver overrun: character lost */
+	}
+}
+
+static void line_idle(uint32_t instance)
+{
+	LPUART_Type *uart = SIM_VIEW(lpuarts[instance]);
+	uart->STAT |= LPUART_STAT_IDLE_MASK;
+	update((uint8_t)instance);
+}
+
+static void rx_next(uint32_t instance)
+{
+	sim_lpuart_t *s = &state[instance];
+	uint64_t cycles = char_cycles((uint8_t)instance);
+
+	if (s->input_count == 0u)
+	{
+		return;
+	}
+	receive_char((uint8_t)instance, s->input[s->input_head]);
+	s->input_head = (uint16_t)((s->input_head + 1u) % SIM_LPUART_INPUT);
+	s->input_count--;
+	update((uint8_t)instance);
+	sim_cancel(line_idle, instance);
+	if (s->input_count != 0u)
+	{
+		sim_schedule(cycles, rx_next, instance);
+	}
+	else
+	{
+		sim_schedule(cycles, line_idle, instance);
+	}
+}
+
+void SIM_LPUART_inject(uint8_t instance, const uint8_t *data, uint32_t length)
+{
+	sim_lpuart_t *s = &state[instance];
+	uint64_t cycles = char_cycles(instance);
+	uint32_t i;
+
+	for (i = 0; (i < length) && (s->input_count < SIM_LPUART_INPUT); i++)
+	{
+		s->input[(s->input_head + s->input_count) % SIM_LPUART_INPUT] = data[i];
+		s->input_count++;
+	}
+	if ((cycles != 0u) && !sim_is_scheduled(rx_next, instance))
+	{
+		sim_schedule(cycles, rx_next, instance);
+	}
+}
+
+static void tx_shift(uint8_t instance);
+
+static void tx_done(uint32_t instance)
+{
+	LPUART_Type  *uart = SIM_VIEW(lpuarts[instance]);
+	sim_lpuart_t *s = &state[instance];
+	uint8_t data = (uint8_t)s->tx[0];
+
+	s->shifting = false;
+	s->tx_count--;
+	memmove(&s->tx[0], &s->tx[1], s->tx_count * sizeof(s->tx[0]));
+	if (tx_hook != NULL)
+	{
+		tx_hook((uint8_t)instance, data);
+	}
+	else
+	{
+		putchar(data);
+	}
+	if (uart->CTRL & LPUART_CTRL_LOOPS_MASK)
+	{
+		receive_char((uint8_t)instance, data);
+	}
+	tx_shift((uint8_t)instance);
+	update((uint8_t)instance);
+}
+
+/*!
+* @brief Move the next character into the shift register. tx[0] is the character on the wire
+* while shifting, so the buffer holds one more entry than its depth.
+*/
+static void tx_shift(uint8_t instance)
+{
+	sim_lpuart_t *s = &state[instance];
+	uint64_t cycles;
+
+	if (s->shifting || (s->tx_count == 0u))
+	{
+		return;
+	}
+	cycles = char_cycles(instance);
+	if (cycles != 0u)
+	{
+		s->shifting = true;
+		sim_schedule(cycles, tx_done, instance);
+	}
+}
+
+void sim_lpuart_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	LPUART_Type  *uart = SIM_VIEW(lpuarts[instance]);
+	sim_lpuart_t *s = &state[instance];
+
+	switch (offset)
+	{
+		case 0x14u:																/* STAT: flags are w1c */
+			uart->STAT = SIM_W1C(old_word, new_word, LPUART_STAT_LBKDIF_MASK | LPUART_STAT_RXEDGIF_MASK |
+								 LPUART_STAT_IDLE_MASK | LPUART_STAT_OR_MASK | LPUART_STAT_NF_MASK |
+								 LPUART_STAT_FE_MASK | LPUART_STAT_PF_MASK | LPUART_STAT_MA1F_MASK |
+								 LPUART_STAT_MA2F_MASK);
+			break;
+		case 0x1Cu:																/* DATA */
+		case 0x1Du:
+		case 0x1Eu:
+		case 0x1Fu:
+			if ((uart->CTRL & LPUART_CTRL_TE_MASK) && (tx_level(s) < depth(uart, LPUART_FIFO_TXFE_MASK)))
+			{
+				s->tx[s->tx_count++] = (uint16_t)(new_word & 0x3FFu);
+				tx_shift(instance);
+			}
+			else
+			{
+				uart->FIFO |= LPUART_FIFO_TXOF_MASK;
+			}
+			break;
+		case 0x28u:																/* FIFO: flush and w1c flags */
+			uart->FIFO = SIM_W1C(old_word, new_word, LPUART_FIFO_TXOF_MASK | LPUART_FIFO_RXUF_MASK)
+					   & ~(LPUART_FIFO_TXFLUSH_MASK | LPUART_FIFO_RXFLUSH_MASK);
+			if (new_word & LPUART_FIFO_TXFLUSH_MASK)
+			{
+				s->tx_count = s->shifting ? 1u : 0u;
+			}
+			if (new_word & LPUART_FIFO_RXFLUSH_MASK)
+			{
+				s->rx_count = 0;
+			}
+			break;
+		case 0x08u:																/* GLOBAL: software reset */
+			if (new_word & LPUART_GLOBAL_RST_MASK)
+			{
+				sim_cancel(tx_done, instance);
+				s->tx_count = 0;
+				s->shifting = false;
+				s->rx_count = 0;
+				uart->CTRL  = 0;
+				uart->BAUD  = 0x0F000004u;
+				uart->FIFO  = 0;
+				uart->WATER = 0;
+			}
+			break;
+		default:
+			break;
+	}
+	update(instance);
+}
+
+void sim_lpuart_read(uint8_t instance, uint32_t offset)
+{
+	sim_lpuart_t *s = &state[instance];
+	LPUART_Type  *uart = SIM_VIEW(lpuarts[instance]);
+
+	if ((offset >= 0x1Cu) && (offset < 0x20u))
+	{
+		if (s->rx_count != 0u)
+		{
+			s->rx_count--;
+			memmove(&s->rx[0], &s->rx[1], s->rx_count * sizeof(s->rx[0]));
+		}
+		else
+		{
+			uart->FIFO |= LPUART_FIFO_RXUF_MASK;
+		}
+		update(instance);
+	}
+}
+
+void sim_lpuart_reset(void)
+{
+	uint8_t instance;
+	for (instance = 0; instance < SIM_LPUART_COUNT; instance++)
+	{
+		LPUART_Type *uart = SIM_VIEW(lpuarts[instance]);
+		memset(&state[instance], 0, sizeof(state[instance]));
+		SIM_RO(uart->VERID) = 0x04010003u;
+		SIM_RO(uart->PARAM) = 0x00000202u;										/* 4 entry TX and RX FIFOs */
+		uart->BAUD  = 0x0F000004u;
+		uart->STAT  = LPUART_STAT_TDRE_MASK | LPUART_STAT_TC_MASK;
+		uart->FIFO  = 0x00C00011u;
+	}
+}
@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "sim_internal.h"
+
+/*!
+ * Serial NOR flash model (W25Q style, 3 byte addresses)
+ * ===================================================
+ * A device attached with SIM_NOR_attach answers on one chip select of an LPSPI. The words
+ * clocked by the LPSPI are split into bytes, MSB first, and each byte is checked against the
+ * line count its phase expects (command on 1 line, address and data as the instruction
+ * defines), so a driver sending a phase on the wrong width is reported and ignored, as the
+ * device would misread it. Dummy phases are counted in SCK clocks.
+ *
+ * 	06/04		write enable / disable
+ * 	05/35		read status register 1 (BUSY, WEL) / 2 (QE)
+ * 	01/31		write status registers 1-2 / 2
+ * 	9F			JEDEC ID: EF 40 log2(size)
+ * 	03/0B		read / fast read (8 dummy clocks), 1-1-1
+ * 	6B/EB		fast read quad output 1-1-4 (8 dummy clocks) / quad I/O 1-4-4 (M7-0 and 4 dummy clocks)
+ * 	02/32		page program 1-1-1 / quad page program 1-1-4
+ * 	20/D8		4 KB sector / 64 KB block erase
+ *
+ * Program, erase and status writes need WEL, act when PCS is negated and keep BUSY for their
+ * typical time; only the status reads are accepted meanwhile. Quad instructions need QE.
+ * Programming only clears bits and wraps inside the 256 byte page.
+ */
+
+#define SIM_NOR_COUNT		(3u)				/* One device per LPSPI */
+#define SIM_NOR_PAGE		(256u)
+#define SIM_NOR_SECTOR		(0x1000u)
+#define SIM_NOR_BLOCK		(0x10000u)
+#define SIM_NOR_PROGRAM_US	(700u)				/* Page program, typical */
+#define SIM_NOR_SECTOR_US	(45000u)			/* Sector erase, typical */
+#define SIM_NOR_BLOCK_US	(150000u)			/* 64 KB block erase, typical */
+#define SIM_NOR_STATUS_US	(10000u)			/* Write status register, typical */
+
+#define SIM_NOR_SR1_BUSY	(0x01u)
+#define SIM_NOR_SR1_WEL		(0x02u)
+#define SIM_NOR_SR2_QE		(0x02u)
+
+/* Instruction flags */
+#define SIM_NOR_ADDRESS		(0x01u)				/* 3 address bytes follow the opcode */
+#define SIM_NOR_OUTPUT		(0x02u)				/* The device drives the data phase */
+#define SIM_NOR_WRITE		(0x04u)				/* Needs WEL, executed when PCS is negated */
+#define SIM_NOR_QUAD		(0x08u)				/* Needs QE */
+
+typedef enum
+{
+	PHASE_COMMAND,
+	PHASE_ADDRESS,
+	PHASE_DUMMY,
+	PHASE_DATA,
+	PHASE_IGNORE
+} sim_nor_phase_t;
+
+typedef struct
+{
+	uint8_t opcode;
+	uint8_t flags;
+	uint8_t address_lines;
+	uint8_t dummy_clocks;
+	uint8_t data_lines;
+	uint32_t busy_us;
+} sim_nor_command_t;
+
+static const sim_nor_command_t commands[] =
+{
+	{ 0x06u, 0u,                                                 0u, 0u, 0u, 0u },
+	{ 0x04u, 0u,                                                 0u, 0u, 0u, 0u },
+	{ 0x05u, SIM_NOR_OUTPUT,                                     0u, 0u, 1u, 0u },
+	{ 0x35u, SIM_NOR_OUTPUT,                                     0u, 0u, 1u, 0u },
+	{ 0x01u, SIM_NOR_WRITE,                                      0u, 0u, 1u, SIM_NOR_STATUS_US },
+	{ 0x31u, SIM_NOR_WRITE,                                      0u, 0u, 1u, SIM_NOR_STATUS_US },
+	{ 0x9Fu, SIM_NOR_OUTPUT,                                     0u, 0u, 1u, 0u },
+	{ 0x03u, SIM_NOR_ADDRESS | SIM_NOR_OUTPUT,                   1u, 0u, 1u, 0u },
+	{ 0x0Bu, SIM_NOR_ADDRESS | SIM_NOR_OUTPUT,                   1u, 8u, 1u, 0u },
+	{ 0x6Bu, SIM_NOR_ADDRESS | SIM_NOR_OUTPUT | SIM_NOR_QUAD,    1u, 8u, 4u, 0u },
+	{ 0xEBu, SIM_NOR_ADDRESS | SIM_NOR_OUTPUT | SIM_NOR_QUAD,    4u, 6u, 4u, 0u },
+	{ 0x02u, SIM_NOR_ADDRESS | SIM_NOR_WRITE,                    1u, 0u, 1u, SIM_NOR_PROGRAM_US },
+	{ 0x32u, SIM_NOR_ADDRESS | SIM_NOR_WRITE | SIM_NOR_QUAD,     1u, 0u, 4u, SIM_NOR_PROGRAM_US },
+	{ 0x20u, SIM_NOR_ADDRESS | SIM_NOR_WRITE,                    1u, 0u, 0u, SIM_NOR_SECTOR_US },
+	{ 0xD8u, SIM_NOR_ADDRESS | SIM_NOR_WRITE,                    1u, 0u, 0u, SIM_NOR_BLOCK_US },
+};
+
+typedef struct
+{
+	uint8_t *memory;
+	uint32_t size;
+	uint8_t  pcs;
+	uint8_t  sr1;
+	uint8_t  sr2;
+	sim_nor_phase_t phase;
+	const sim_nor_command_t *command;		/* Instruction of the transfer in progress */
+	uint32_t address;
+	uint8_t  address_bytes;
+	uint8_t  dummy_left;					/* Dummy clocks still expected */
+	uint32_t count;							/* Data bytes of the transfer */
+	uint8_t  page[SIM_NOR_PAGE];			/* Program / status data, 0xFF where not written */
+} sim_nor_t;
+
+static sim_nor_t nors[SIM_NOR_COUNT];
+
+void SIM_NOR_attach(uint8_t instance, uint8_t pcs, uint8_t *memory, uint32_t size)
+{
+	sim_nor_t *nor = &nors[instance];
+
+	memset(nor, 0, sizeof(*nor));
+	nor->memory = memory;
+	nor->size = size;
+	nor->pcs = pcs;
+}
+
+bool sim_nor_selected(uint8_t instance, uint8_t pcs)
+{
+	return (instance < SIM_NOR_COUNT) && (nors[instance].memory != NULL) && (nors[instance].pcs == pcs);
+}
+
+static void ready(uint32_t instance)
+{
+	nors[instance].sr1 &= (uint8_t)~(SIM_NOR_SR1_BUSY | SIM_NOR_SR1_WEL);
+}
+
+static void reject(uint8_t instance, const char *what, uint8_t lines)
+{
+	sim_nor_t *nor = &nors[instance];
+
+	fprintf(stderr, "sim: NOR on LPSPI%u: %s of opcode %02X on %u line(s), ignored\n",
+			instance, what, nor->command->opcode, lines);
+	nor->phase = PHASE_IGNORE;
+}
+
+static uint8_t output(sim_nor_t *nor)
+{
+	uint32_t index = nor->count++;
+
+	switch (nor->command->opcode)
+	{
+		case 0x05u: return nor->sr1;
+		case 0x35u: return nor->sr2;
+		case 0x9Fu:
+		{
+			uint8_t capacity = 0;
+			while ((1u << capacity) < nor->size)
+			{
+				capacity++;
+			}
+			return (index == 0u) ? 0xEFu : ((index == 1u) ? 0x40u : ((index == 2u) ? capacity : 0x00u));
+		}
+		default:    return nor->memory[(nor->address + index) & (nor->size - 1u)];
+	}
+}
+
+/*!
+* @brief One byte on the bus: the byte clocked in, the byte driven by the device.
+*/
+static uint8_t step(uint8_t instance, uint8_t in, uint8_t lines)
+{
+	sim_nor_t *nor = &nors[instance];
+	const sim_nor_command_t *command = nor->command;
+	uint8_t i;
+
+	switch (nor->phase)
+	{
+		case PHASE_COMMAND:
+			nor->phase = PHASE_IGNORE;
+			command = NULL;
+			for (i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+			{
+				if (commands[i].opcode == in)
+				{
+					command = &commands[i];
+				}
+			}
+			if ((command == NULL) || (lines != 1u) ||
+				((nor->sr1 & SIM_NOR_SR1_BUSY) && (in != 0x05u) && (in != 0x35u)) ||
+				((command->flags & SIM_NOR_QUAD) && !(nor->sr2 & SIM_NOR_SR2_QE)))
+			{
+				return 0xFFu;										/* Unknown, busy or not enabled */
+			}
+			nor->command = command;
+			nor->address = 0;
+			nor->address_bytes = 0;
+			nor->dummy_left = command->dummy_clocks;
+			nor->count = 0;
+			memset(nor->page, 0xFF, sizeof(nor->page));
+			nor->phase = (command->flags & SIM_NOR_ADDRESS) ? PHASE_ADDRESS :
+						 ((command->dummy_clocks != 0u) ? PHASE_DUMMY : PHASE_DATA);
+			return 0xFFu;
+		case PHASE_ADDRESS:
+			if (lines != command->address_lines)
+			{
+				reject(instance, "address", lines);
+				return 0xFFu;
+			}
+			nor->address = (nor->address << 8) | in;
+			if (++nor->address_bytes == 3u)
+			{
+				nor->address &= nor->size - 1u;
+				nor->phase = (nor->dummy_left != 0u) ? PHASE_DUMMY : PHASE_DATA;
+			}
+			return 0xFFu;
+		case PHASE_DUMMY:
+			if ((8u / lines) > nor->dummy_left)
+			{
+				reject(instance, "dummy clocks", lines);
+				return 0xFFu;
+			}
+			nor->dummy_left -= (uint8_t)(8u / lines);
+			if (nor->dummy_left == 0u)
+			{
+				nor->phase = PHASE_DATA;
+			}
+			return 0xFFu;
+		case PHASE_DATA:
+			if (lines != command->data_lines)
+			{
+				reject(instance, "data", lines);
+				return 0xFFu;
+			}
+			if (command->flags & SIM_NOR_OUTPUT)
+			{
+				return output(nor);
+			}
+			nor->page[(nor->address + nor->count) & (SIM_NOR_PAGE - 1u)] = in;
+			nor->count++;
+			return 0xFFu;
+		default:
+			return 0xFFu;
+	}
+}
+
+/*!
+* @brief PCS negated: execute the write instructions, back to the command phase.
+*/
+static void deselect(uint8_t instance)
+{
+	sim_nor_t *nor = &nors[instance];
+	const sim_nor_command_t *command = nor->command;
+	uint32_t base;
+	uint32_t i;
+
+	if ((nor->phase == PHASE_IGNORE) || (nor->phase == PHASE_COMMAND) || (command == NULL))
+	{
+		nor->phase = PHASE_COMMAND;
+		return;
+	}
+	nor->phase = PHASE_COMMAND;
+
+	if (command->opcode == 0x06u)
+	{
+		nor->sr1 |= SIM_NOR_SR1_WEL;
+	}
+	else if (command->opcode == 0x04u)
+	{
+		nor->sr1 &= (uint8_t)~SIM_NOR_SR1_WEL;
+	}
+	if (!(command->flags & SIM_NOR_WRITE) || !(nor->sr1 & SIM_NOR_SR1_WEL) ||
+		((command->flags & SIM_NOR_ADDRESS) && (nor->address_bytes != 3u)))
+	{
+		return;
+	}
+
+	switch (command->opcode)
+	{
+		case 0x01u:
+			if (nor->count == 0u)
+			{
+				return;
+			}
+			if (nor->count > 1u)
+			{
+				nor->sr2 = nor->page[1];
+			}
+			break;
+		case 0x31u:
+			if (nor->count == 0u)
+			{
+				return;
+			}
+			nor->sr2 = nor->page[0];
+			break;
+		case 0x20u:
+		case 0xD8u:
+			base = nor->address & ~((command->opcode == 0x20u) ? (SIM_NOR_SECTOR - 1u) : (SIM_NOR_BLOCK - 1u));
+			memset(&nor->memory[base], 0xFF, (command->opcode == 0x20u) ? SIM_NOR_SECTOR : SIM_NOR_BLOCK);
+			break;
+		default:													/* Page program: only clears bits */
+			if (nor->count == 0u)
+			{
+				return;
+			}
+			base = nor->address & ~(SIM_NOR_PAGE - 1u);
+			for (i = 0; i < SIM_NOR_PAGE; i++)
+			{
+				nor->memory[base + i] &= nor->page[i];
+			}
+			break;
+	}
+	nor->sr1 |= SIM_NOR_SR1_BUSY;
+	sim_schedule(SIM_US_TO_CYCLES(command->busy_us), ready, instance);
+}
+
+uint32_t sim_nor_transfer(uint8_t instance, uint32_t tx, uint8_t bits, uint8_t lines)
+{
+	uint32_t rx = 0;
+	uint8_t  shift;
+
+	if (bits == 0u)
+	{
+		deselect(instance);
+		return 0;
+	}
+	for (shift = bits; shift >= 8u; shift -= 8u)
+	{
+		rx = (rx << 8) | step(instance, (uint8_t)(tx >> (shift - 8u)), lines);
+	}
+	return rx;
+}
+
+void sim_nor_reset(void)
+{
+	uint8_t instance;
+	for (instance = 0; instance < SIM_NOR_COUNT; instance++)
+	{
+		sim_cancel(ready, instance);
+		nors[instance].sr1 = 0;
+		nors[instance].phase = PHASE_COMMAND;
+	}
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim_internal.h"
+
+/*!
+ * NVIC model
+ * ===================================================
+ * ISER/ICER, ISPR/ICPR read back the shared enable and pending state, IP holds the priority of
+ * each line and the handlers are bound by name to the application, like the weak vector table of
+ * startup_S32K148.S. A pending, enabled line preempts when its IP value is lower than the one of
+ * the handler currently running.
+ */
+
+#define SIM_IRQ_COUNT		(S32_NVIC_IP_COUNT)
+#define SIM_THREAD_PRIO		(0x100u)
+
+#define SIM_VECTORS(X) \
+	X(DMA0) X(DMA1) X(DMA2) X(DMA3) \
+	X(DMA4) X(DMA5) X(DMA6) X(DMA7) \
+	X(DMA8) X(DMA9) X(DMA10) X(DMA11) \
+	X(DMA12) X(DMA13) X(DMA14) X(DMA15) \
+	X(DMA_Error) X(MCM) X(FTFC) X(Read_Collision) \
+	X(LVD_LVW) X(FTFC_Fault) X(WDOG_EWM) X(RCM) \
+	X(LPI2C0_Master) X(LPI2C0_Slave) X(LPSPI0) X(LPSPI1) \
+	X(LPSPI2) X(LPI2C1_Master) X(LPI2C1_Slave) X(LPUART0_RxTx) \
+	X(LPUART1_RxTx) X(LPUART2_RxTx) X(ADC0) X(ADC1) \
+	X(CMP0) X(ERM_single_fault) X(ERM_double_fault) X(RTC) \
+	X(RTC_Seconds) X(LPIT0_Ch0) X(LPIT0_Ch1) X(LPIT0_Ch2) \
+	X(LPIT0_Ch3) X(PDB0) X(SAI1_Tx) X(SAI1_Rx) \
+	X(SCG) X(LPTMR0) X(PORTA) X(PORTB) \
+	X(PORTC) X(PORTD) X(PORTE) X(SWI) \
+	X(QSPI) X(PDB1) X(FLEXIO) X(SAI0_Tx) \
+	X(SAI0_Rx) X(ENET_TIMER) X(ENET_TX) X(ENET_RX) \
+	X(ENET_ERR) X(ENET_STOP) X(ENET_WAKE) X(CAN0_ORed) \
+	X(CAN0_Error) X(CAN0_Wake_Up) X(CAN0_ORed_0_15_MB) X(CAN0_ORed_16_31_MB) \
+	X(CAN1_ORed) X(CAN1_Error) X(CAN1_ORed_0_15_MB) X(CAN1_ORed_16_31_MB) \
+	X(CAN2_ORed) X(CAN2_Error) X(CAN2_ORed_0_15_MB) X(CAN2_ORed_16_31_MB) \
+	X(FTM0_Ch0_Ch1) X(FTM0_Ch2_Ch3) X(FTM0_Ch4_Ch5) X(FTM0_Ch6_Ch7) \
+	X(FTM0_Fault) X(FTM0_Ovf_Reload) X(FTM1_Ch0_Ch1) X(FTM1_Ch2_Ch3) \
+	X(FTM1_Ch4_Ch5) X(FTM1_Ch6_Ch7) X(FTM1_Fault) X(FTM1_Ovf_Reload) \
+	X(FTM2_Ch0_Ch1) X(FTM2_Ch2_Ch3) X(FTM2_Ch4_Ch5) X(FTM2_Ch6_Ch7) \
+	X(FTM2_Fault) X(FTM2_Ovf_Reload) X(FTM3_Ch0_Ch1) X(FTM3_Ch2_Ch3) \
+	X(FTM3_Ch4_Ch5) X(FTM3_Ch6_Ch7) X(FTM3_Fault) X(FTM3_Ovf_Reload) \
+	X(FTM4_Ch0_Ch1) X(FTM4_Ch2_Ch3) X(FTM4_Ch4_Ch5) X(FTM4_Ch6_Ch7) \
+	X(FTM4_Fault) X(FTM4_Ovf_Reload) X(FTM5_Ch0_Ch1) X(FTM5_Ch2_Ch3) \
+	X(FTM5_Ch4_Ch5) X(FTM5_Ch6_Ch7) X(FTM5_Fault) X(FTM5_Ovf_Reload) \
+	X(FTM6_Ch0_Ch1) X(FTM6_Ch2_Ch3) X(FTM6_Ch4_Ch5) X(FTM6_Ch6_Ch7) \
+	X(FTM6_Fault) X(FTM6_Ovf_Reload) X(FTM7_Ch0_Ch1) X(FTM7_Ch2_Ch3) \
+	X(FTM7_Ch4_Ch5) X(FTM7_Ch6_Ch7) X(FTM7_Fault) X(FTM7_Ovf_Reload)
+
+#define SIM_DECLARE(name)	extern void name##_IRQHandler(void) __attribute__((weak));
+SIM_VECTORS(SIM_DECLARE)
+
+typedef struct
+{
+	IRQn_Type irq;
+	void (*handler)(void);
+} sim_vector_t;
+
+#define SIM_VECTOR(name)	{ name##_IRQn, name##_IRQHandler },
+static const sim_vector_t vectors[] =
+{
+	SIM_VECTORS(SIM_VECTOR)
+};
+
+static uint32_t running_prio = SIM_THREAD_PRIO;
+
+static void (*handler_of(uint32_t irq))(void)
+{
+	uint32_t i;
+	for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++)
+	{
+		if ((uint32_t)vectors[i].irq == irq)
+		{
+			return vectors[i].handler;
+		}
+	}
+	return NULL;
+}
+
+void sim_nvic_reset(void)
+{
+	running_prio = SIM_THREAD_PRIO;
+}
+
+void sim_irq_raise(IRQn_Type irq)
+{
+	S32_NVIC_Type *nvic = SIM_VIEW(S32_NVIC);
+	nvic->ISPR[(uint32_t)irq >> 5] |= 1u << ((uint32_t)irq & 0x1Fu);
+	nvic->ICPR[(uint32_t)irq >> 5] = nvic->ISPR[(uint32_t)irq >> 5];
+}
+
+/*!
+* @brief Highest priority line that is pending, enabled and allowed to preempt, -1 if none.
+*/
+static int32_t next_irq(void)
+{
+	S32_NVIC_Type *nvic = SIM_VIEW(S32_NVIC);
+	int32_t best = -1;
+	uint32_t best_prio = running_prio;
+	uint32_t irq;
+
+	for (irq = 0; irq < SIM_IRQ_COUNT; irq++)
+	{
+		uint32_t mask = 1u << (irq & 0x1Fu);
+		if ((nvic->ISPR[irq >> 5] & nvic->ISER[irq >> 5] & mask) && (nvic->IP[irq] < best_prio))
+		{
+			best = (int32_t)irq;
+			best_prio = nvic->IP[irq];
+		}
+	}
+	return best;
+}
+
+bool sim_irq_pending(void)
+{
+	S32_NVIC_Type *nvic = SIM_VIEW(S32_NVIC);
+	uint32_t i;
+	for (i = 0; i < S32_NVIC_ISPR_COUNT; i++)
+	{
+		if (nvic->ISPR[i] & nvic->ISER[i])
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void sim_irq_dispatch(void)
+{
+	S32_NVIC_Type *nvic = SIM_VIEW(S32_NVIC);
+	int32_t irq;
+
+	while (!sim_primask() && ((irq = next_irq()) >= 0))
+	{
+		uint32_t word = (uint32_t)irq >> 5;
+		uint32_t mask = 1u << ((uint32_t)irq & 0x1Fu);
+		uint32_t saved_prio = running_prio;
+		void (*handler)(void) = handler_of((uint32_t)irq);
+
+		nvic->ISPR[word] &= ~mask;								/* Exception entry clears pending */
+		nvic->ICPR[word] = nvic->ISPR[word];
+		nvic->IABR[word] |= mask;
+		running_prio = nvic->IP[irq];
+		sim_stats.irqs++;
+
+		if (handler != NULL)
+		{
+			handler();
+		}
+		else
+		{
+			fprintf(stderr, "sim: unhandled interrupt %d\n", (int)irq);
+			SIM_stop(4);
+		}
+
+		running_prio = saved_prio;
+		nvic->IABR[word] &= ~mask;
+	}
+}
+
+/*!
+* @brief ISER/ICER and ISPR/ICPR are write-1-to-set / write-1-to-clear views of one state.
+*/
+void sim_nvic_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	S32_NVIC_Type *nvic = SIM_VIEW(S32_NVIC);
+	uint32_t index = (offset & 0x7Fu) >> 2;
+	(void)instance;
+
+	if (offset < 0x80u)												/* ISER */
+	{
+		nvic->ISER[index] = old_word | new_word;
+		nvic->ICER[index] = nvic->ISER[index];
+	}
+	else if ((offset >= 0x80u) && (offset < 0x100u))				/* ICER */
+	{
+		nvic->ISER[index] &= ~new_word;
+		nvic->ICER[index] = nvic->ISER[index];
+	}
+	else if ((offset >= 0x100u) && (offset < 0x180u))				/* ISPR */
+	{
+		nvic->ISPR[index] = old_word | new_word;
+		nvic->ICPR[index] = nvic->ISPR[index];
+	}
+	else if ((offset >= 0x180u) && (offset < 0x200u))				/* ICPR */
+	{
+		nvic->ISPR[index] &= ~new_word;
+		nvic->ICPR[index] = nvic->ISPR[index];
+	}
+	else if (offset == 0xE00u)										/* STIR */
+	{
+		sim_irq_raise((IRQn_Type)(new_word & 0x1FFu));
+	}
+}
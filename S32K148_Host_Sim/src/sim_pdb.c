@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim_internal.h"
+
+/*!
+ * PDB model
+ * ===================================================
+ * A software trigger (TRGSEL = 15, SWTRIG) starts the counter on the bus clock divided by
+ * PRESCALER and MULT. Enabled pre-triggers fire at their CHnDLYm (TOS), at the start of the
+ * cycle (bypass) or right after the previous pre-trigger (back-to-back) and hardware trigger
+ * the ADC SC1 register of the same number: PDB0 CHn pre-trigger m starts ADC0 SC1[8n + m].
+ * IDLY raises PDBIF (interrupt or DMA request) and MOD ends the cycle, restarting it in
+ * continuous mode. Register loads through LDOK take effect immediately.
+ *
+ * With TRGSEL = 0 the PDB is started by its TRGMUX output (TRGMUX_PDB0/PDB1 SEL0): a source
+ * pulsed through sim_trgmux_pulse starts every enabled PDB selecting it, in the same cycle.
+ */
+
+#define SIM_PDB_COUNT		(2u)
+#define SIM_PDB_SWTRIG		(15u)		/* TRGSEL value of the software trigger */
+#define SIM_PDB_TRGMUX		(0u)		/* TRGSEL value of the TRGMUX output */
+
+static PDB_Type * const pdbs[SIM_PDB_COUNT] = PDB_BASE_PTRS;
+static const IRQn_Type pdb_irqs[SIM_PDB_COUNT] = PDB_IRQS;
+static uint64_t started[SIM_PDB_COUNT];
+
+static uint64_t tick_cycles(PDB_Type *pdb)
+{
+	static const uint8_t mults[4] = { 1u, 10u, 20u, 40u };
+	return (1ull << ((pdb->SC & PDB_SC_PRESCALER_MASK) >> PDB_SC_PRESCALER_SHIFT))
+		   * mults[(pdb->SC & PDB_SC_MULT_MASK) >> PDB_SC_MULT_SHIFT];
+}
+
+static void pretrigger(uint32_t arg)
+{
+	uint8_t   instance = (uint8_t)(arg >> 16);
+	uint8_t   ch = (uint8_t)(arg >> 8);
+	uint8_t   m = (uint8_t)arg;
+	PDB_Type *pdb = SIM_VIEW(pdbs[instance]);
+
+	pdb->CH[ch].S |= PDB_S_CF(1u << m);
+	sim_adc_trigger(instance, (uint8_t)(ch * PDB_DLY_COUNT + m));
+}
+
+static void interrupt_delay(uint32_t instance)
+{
+	PDB_Type *pdb = SIM_VIEW(pdbs[instance]);
+
+	pdb->SC |= PDB_SC_PDBIF_MASK;
+	if (pdb->SC & PDB_SC_DMAEN_MASK)
+	{
+		sim_dma_request((uint8_t)(EDMA_REQ_PDB0 + instance));
+	}
+	else if (pdb->SC & PDB_SC_PDBIE_MASK)
+	{
+		sim_irq_raise(pdb_irqs[instance]);
+	}
+}
+
+static void stop(uint8_t instance)
+{
+	uint32_t ch;
+	uint32_t m;
+
+	for (ch = 0; ch < PDB_CH_COUNT; ch++)
+	{
+		for (m = 0; m < PDB_DLY_COUNT; m++)
+		{
+			sim_cancel(pretrigger, ((uint32_t)instance << 16) | (ch << 8) | m);
+		}
+	}
+	sim_cancel(interrupt_delay, instance);
+}
+
+static void cycle_end(uint32_t instance);
+
+/*!
+* @brief Start one counter cycle: schedule the pre-triggers, IDLY and the MOD wrap.
+*/
+static void cycle_start(uint8_t instance)
+{
+	PDB_Type *pdb = SIM_VIEW(pdbs[instance]);
+	uint64_t  tick = tick_cycles(pdb);
+	uint32_t  ch;
+	uint32_t  m;
+
+	stop(instance);
+	sim_cancel(cycle_end, instance);
+	started[instance] = sim_now();
+
+	for (ch = 0; ch < PDB_CH_COUNT; ch++)
+	{
+		uint32_t c1 = pdb->CH[ch].C1;
+		uint64_t at = 0;
+		for (m = 0; m < PDB_DLY_COUNT; m++)
+		{
+			uint32_t bit = 1u << m;
+			if (!(c1 & PDB_C1_EN(bit)))
+			{
+				continue;
+			}
+			if (c1 & PDB_C1_BB(bit))
+			{
+				/* Back-to-back: follows the previous pre-trigger, the ADC queues it behind */
+			}
+			else if (c1 & PDB_C1_TOS(bit))
+			{
+				at = (uint64_t)(pdb->CH[ch].DLY[m] & PDB_DLY_DLY_MASK) * tick;
+			}
+			else
+			{
+				at = 0;
+			}
+			sim_schedule(at, pretrigger, ((uint32_t)instance << 16) | (ch << 8) | m);
+		}
+	}
+	if (pdb->SC & (PDB_SC_PDBIE_MASK | PDB_SC_DMAEN_MASK))
+	{
+		sim_schedule((uint64_t)(pdb->IDLY & PDB_IDLY_IDLY_MASK) * tick, interrupt_delay, instance);
+	}
+	sim_schedule(((uint64_t)(pdb->MOD & PDB_MOD_MOD_MASK) + 1u) * tick, cycle_end, instance);
+}
+
+static void cycle_end(uint32_t instance)
+{
+	PDB_Type *pdb = SIM_VIEW(pdbs[instance]);
+	if ((pdb->SC & PDB_SC_PDBEN_MASK) && (pdb->SC & PDB_SC_CONT_MASK))
+	{
+		cycle_start((uint8_t)instance);
+	}
+}
+
+void sim_pdb_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	PDB_Type *pdb = SIM_VIEW(pdbs[instance]);
+
+	if (offset == 0x0u)												/* SC */
+	{
+		/* LDOK and SWTRIG self clear, PDBIF is cleared by writing 0 */
+		uint32_t sc = (new_word & ~(PDB_SC_LDOK_MASK | PDB_SC_SWTRIG_MASK | PDB_SC_PDBIF_MASK))
+					| (old_word & new_word & PDB_SC_PDBIF_MASK);
+		pdb->SC = sc;
+		if (!(sc & PDB_SC_PDBEN_MASK))
+		{
+			stop(instance);
+			sim_cancel(cycle_end, instance);
+		}
+		else if ((new_word & PDB_SC_SWTRIG_MASK) &&
+				 (((sc & PDB_SC_TRGSEL_MASK) >> PDB_SC_TRGSEL_SHIFT) == SIM_PDB_SWTRIG))
+		{
+			cycle_start(instance);
+		}
+	}
+	else if ((offset >= 0x10u) && (offset < 0xB0u) && (((offset - 0x10u) % 0x28u) == 0x4u))
+	{
+		uint32_t ch = (offset - 0x10u) / 0x28u;						/* CHnS: CF and ERR are write 0 to clear */
+		pdb->CH[ch].S = old_word & new_word;
+	}
+}
+
+void sim_trgmux_pulse(uint8_t source)
+{
+	static const uint8_t outputs[SIM_PDB_COUNT] = { TRGMUX_PDB0_INDEX, TRGMUX_PDB1_INDEX };
+	TRGMUX_Type *trgmux = SIM_VIEW(TRGMUX);
+	uint8_t instance;
+
+	for (instance = 0; instance < SIM_PDB_COUNT; instance++)
+	{
+		PDB_Type *pdb = SIM_VIEW(pdbs[instance]);
+		if ((pdb->SC & PDB_SC_PDBEN_MASK) &&
+			(((pdb->SC & PDB_SC_TRGSEL_MASK) >> PDB_SC_TRGSEL_SHIFT) == SIM_PDB_TRGMUX) &&
+			((trgmux->TRGMUXn[outputs[instance]] & TRGMUX_TRGMUXn_SEL0_MASK) == source))
+		{
+			cycle_start(instance);
+		}
+	}
+}
+
+void sim_pdb_read(uint8_t instance, uint32_t offset)
+{
+	PDB_Type *pdb = SIM_VIEW(pdbs[instance]);
+
+	if (offset == 0x8u)												/* CNT */
+	{
+		uint64_t count = 0;
+		if (sim_is_scheduled(cycle_end, instance))
+		{
+			count = (sim_now() - started[instance]) / tick_cycles(pdb);
+		}
+		SIM_RO(pdb->CNT) = (uint32_t)count & PDB_CNT_CNT_MASK;
+	}
+}
+
+void sim_pdb_reset(void)
+{
+	uint8_t instance;
+	for (instance = 0; instance < SIM_PDB_COUNT; instance++)
+	{
+		PDB_Type *pdb = SIM_VIEW(pdbs[instance]);
+		pdb->MOD  = 0xFFFFu;
+		pdb->IDLY = 0xFFFFu;
+	}
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim_internal.h"
+
+/*!
+ * PORT and GPIO models
+ * ===================================================
+ * PSOR/PCOR/PTOR act on PDOR, PDIR reflects the driven level of outputs and the stimulus level
+ * of inputs, and input edges are detected according to PCR[IRQC] into ISF/ISFR and PORTx_IRQn.
+ */
+
+#define SIM_PORT_COUNT		(5u)
+
+static PORT_Type * const ports[SIM_PORT_COUNT] = PORT_BASE_PTRS;
+static GPIO_Type * const gpios[SIM_PORT_COUNT] = GPIO_BASE_PTRS;
+static const IRQn_Type port_irqs[SIM_PORT_COUNT] = PORT_IRQS;
+static const uint8_t port_requests[SIM_PORT_COUNT] =
+{
+	EDMA_REQ_PORTA, EDMA_REQ_PORTB, EDMA_REQ_PORTC, EDMA_REQ_PORTD, EDMA_REQ_PORTE
+};
+
+static uint32_t inputs[SIM_PORT_COUNT];				/* Level applied to each pin from outside */
+
+static void gpio_update(uint8_t port)
+{
+	GPIO_Type *gpio = SIM_VIEW(gpios[port]);
+	SIM_RO(gpio->PDIR) = (gpio->PDOR & gpio->PDDR) | (inputs[port] & ~gpio->PDDR & ~gpio->PIDR);
+}
+
+/*!
+* @brief Set the ISF of a pin if its IRQC configuration matches the level change.
+*/
+static void port_detect(uint8_t port, uint8_t pin, uint8_t before, uint8_t after)
+{
+	PORT_Type *regs = SIM_VIEW(ports[port]);
+	uint32_t irqc = (regs->PCR[pin] & PORT_PCR_IRQC_MASK) >> PORT_PCR_IRQC_SHIFT;
+	bool hit;
+
+	switch (irqc)
+	{
+		case 0x1u: case 0x9u:  hit = !before && after;			break;	/* Rising edge */
+		case 0x2u: case 0xAu:  hit = before && !after;			break;	/* Falling edge */
+		case 0x3u: case 0xBu:  hit = before != after;			break;	/* Either edge */
+		case 0x8u:             hit = !after;					break;	/* Logic 0 */
+		case 0xCu:             hit = after;						break;	/* Logic 1 */
+		default:               hit = false;						break;
+	}
+	if (!hit)
+	{
+		return;
+	}
+	regs->PCR[pin] |= PORT_PCR_ISF_MASK;
+	regs->ISFR |= 1u << pin;
+	if (irqc >= 0x8u)
+	{
+		sim_irq_raise(port_irqs[port]);
+	}
+	else
+	{
+		sim_dma_request(port_requests[port]);
+	}
+}
+
+void SIM_GPIO_set_input(uint8_t port, uint8_t pin, uint8_t level)
+{
+	uint8_t before = (uint8_t)((inputs[port] >> pin) & 1u);
+	uint8_t after  = level ? 1u : 0u;
+
+	inputs[port] = (inputs[port] & ~(1u << pin)) | ((uint32_t)after << pin);
+	gpio_update(port);
+	port_detect(port, pin, before, after);
+	sim_irq_dispatch();
+}
+
+void sim_gpio_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	GPIO_Type *gpio = SIM_VIEW(gpios[instance]);
+	(void)old_word;
+
+	switch (offset)
+	{
+		case 0x04u: gpio->PDOR |= new_word;  gpio->PSOR = 0; break;	/* PSOR */
+		case 0x08u: gpio->PDOR &= ~new_word; gpio->PCOR = 0; break;	/* PCOR */
+		case 0x0Cu: gpio->PDOR ^= new_word;  gpio->PTOR = 0; break;	/* PTOR */
+		case 0x10u: SIM_RO(gpio->PDIR) = old_word;               break;	/* PDIR is read only */
+		default:                                             break;
+	}
+	gpio_update(instance);
+}
+
+void sim_port_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	PORT_Type *regs = SIM_VIEW(ports[instance]);
+	uint32_t pin;
+
+	if (offset < 0x80u)														/* PCR[n] */
+	{
+		pin = offset >> 2;
+		regs->PCR[pin] = SIM_W1C(old_word, new_word, PORT_PCR_ISF_MASK);
+		if ((old_word & PORT_PCR_ISF_MASK) && !(regs->PCR[pin] & PORT_PCR_ISF_MASK))
+		{
+			regs->ISFR &= ~(1u << pin);
+		}
+	}
+	else if ((offset == 0x80u) || (offset == 0x84u))						/* GPCLR / GPCHR */
+	{
+		uint32_t first = (offset == 0x80u) ? 0u : 16u;
+		for (pin = 0; pin < 16u; pin++)
+		{
+			if (new_word & (1u << (16u + pin)))
+			{
+				regs->PCR[first + pin] = (regs->PCR[first + pin] & 0xFFFF0000u) | (new_word & 0xFFFFu);
+			}
+		}
+		regs->GPCLR = 0;
+		regs->GPCHR = 0;
+	}
+	else if (offset == 0xA0u)												/* ISFR */
+	{
+		regs->ISFR = old_word & ~new_word;
+		for (pin = 0; pin < 32u; pin++)
+		{
+			if (new_word & (1u << pin))
+			{
+				regs->PCR[pin] &= ~PORT_PCR_ISF_MASK;
+			}
+		}
+	}
+}
+
+void sim_port_reset(void)
+{
+	uint8_t port;
+	for (port = 0; port < SIM_PORT_COUNT; port++)
+	{
+		inputs[port] = 0;
+		gpio_update(port);
+	}
+}
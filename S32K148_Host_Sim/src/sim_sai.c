@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "sim_internal.h"
+
+/*!
+ * SAI model
+ * ===================================================
+ * The transmitter generates the bit clock from the bus clock (TCR2[DIV], MSEL = 0) and runs
+ * while TCSR[TE] is set: each slot of the frame (TCR4[FRSZ], TCR5[W0W/WNW]) takes one word from
+ * the FIFO of every line enabled in TCR3[TCE] and not masked in TMR, setting FEF when a FIFO is
+ * empty (underrun). A receiver synchronous to the transmitter (RCR2[SYNC] = 1, RCSR[RE]) takes
+ * the word of the same slot on each line enabled in RCR3[RCE] and not masked in RMR: the word the
+ * transmitter sent on that line, or the answer of the codec set by SIM_SAI_set_device, which sees
+ * the words of all transmit lines in the slot. A full receive FIFO sets FEF (overrun) and drops
+ * the word.
+ *
+ * FRF is valid whether TE is set or not, so the transmit FIFOs can be filled before the bit clock
+ * starts. The DMA requests are levels: they are withdrawn as soon as FRF clears.
+ *
+ * FIFOs are 8 words per line. FRF follows TCR1[TFW] / RCR1[RFW]; with FRDE it raises the
+ * SAIn TX / RX DMA request (SAI1 shares them with FlexIO shifters 3 / 2), and FRIE, FWIE, FEIE
+ * raise SAIn_Tx_IRQn / SAIn_Rx_IRQn. With FCOMB = 2 (combine on software accesses) successive
+ * TDR writes and RDR reads go round robin over the enabled lines, whatever TDR/RDR index is used.
+ */
+
+#define SIM_SAI_COUNT		(2u)
+#define SIM_SAI_LINES		(4u)
+#define SIM_SAI_FIFO		(8u)
+
+typedef struct
+{
+	uint32_t word[SIM_SAI_LINES][SIM_SAI_FIFO];
+	uint8_t  head[SIM_SAI_LINES];
+	uint8_t  count[SIM_SAI_LINES];
+	uint8_t  wfp[SIM_SAI_LINES];				/* FIFO pointers with their wrap bit, as in TFR/RFR */
+	uint8_t  rfp[SIM_SAI_LINES];
+	uint8_t  combine;							/* Next line of the FCOMB = 2 round robin */
+} sim_sai_fifo_t;
+
+typedef struct
+{
+	sim_sai_fifo_t tx;
+	sim_sai_fifo_t rx;
+	uint8_t        slot;
+	bool           warned;
+} sim_sai_t;
+
+static SAI_Type * const sais[SIM_SAI_COUNT] = SAI_BASE_PTRS;
+static const IRQn_Type sai_tx_irqs[SIM_SAI_COUNT] = SAI_TX_IRQS;
+static const IRQn_Type sai_rx_irqs[SIM_SAI_COUNT] = SAI_RX_IRQS;
+static const uint8_t sai_lines[SIM_SAI_COUNT] = { 4u, 1u };
+static const uint8_t sai_tx_req[SIM_SAI_COUNT] = { EDMA_REQ_SAI0_TX, EDMA_REQ_FLEXIO_SHIFTER3_SAI1_TX };
+static const uint8_t sai_rx_req[SIM_SAI_COUNT] = { EDMA_REQ_SAI0_RX, EDMA_REQ_FLEXIO_SHIFTER2_SAI1_RX };
+static sim_sai_t state[SIM_SAI_COUNT];
+static uint32_t (*device)(uint8_t instance, uint8_t line, uint8_t slot, const uint32_t *tx);
+
+void SIM_SAI_set_device(uint32_t (*codec)(uint8_t instance, uint8_t line, uint8_t slot, const uint32_t *tx))
+{
+	device = codec;
+}
+
+static void fifo_reset(sim_sai_fifo_t *fifo)
+{
+	memset(fifo, 0, sizeof(*fifo));
+}
+
+static bool fifo_push(sim_sai_fifo_t *fifo, uint8_t line, uint32_t word)
+{
+	if (fifo->count[line] == SIM_SAI_FIFO)
+	{
+		return false;
+	}
+	fifo->word[line][(fifo->head[line] + fifo->count[line]) % SIM_SAI_FIFO] = word;
+	fifo->count[line]++;
+	fifo->wfp[line] = (uint8_t)((fifo->wfp[line] + 1u) & 0xFu);
+	return true;
+}
+
+static bool fifo_pop(sim_sai_fifo_t *fifo, uint8_t line, uint32_t *word)
+{
+	if (fifo->count[line] == 0u)
+	{
+		return false;
+	}
+	*word = fifo->word[line][fifo->head[line]];
+	fifo->head[line] = (uint8_t)((fifo->head[line] + 1u) % SIM_SAI_FIFO);
+	fifo->count[line]--;
+	fifo->rfp[line] = (uint8_t)((fifo->rfp[line] + 1u) & 0xFu);
+	return true;
+}
+
+/*!
+* @brief Next enabled line of the FCOMB = 2 round robin, starting at fifo->combine.
+*/
+static uint8_t combine_line(sim_sai_fifo_t *fifo, uint8_t enabled, uint8_t lines)
+{
+	uint8_t line = fifo->combine;
+	uint8_t i;
+
+	for (i = 0; i < lines; i++, line = (uint8_t)((line + 1u) % lines))
+	{
+		if (enabled & (1u << line))
+		{
+			break;
+		}
+	}
+	fifo->combine = (uint8_t)((line + 1u) % lines);
+	return line;
+}
+
+/*!
+* @brief Recompute the FIFO flags and pointers, raise the interrupt and DMA requests they enable.
+*/
+static void update(uint8_t instance)
+{
+	SAI_Type  *sai = SIM_VIEW(sais[instance]);
+	sim_sai_t *s = &state[instance];
+	uint8_t    tce = (uint8_t)((sai->TCR3 & SAI_TCR3_TCE_MASK) >> SAI_TCR3_TCE_SHIFT);
+	uint8_t    rce = (uint8_t)((sai->RCR3 & SAI_RCR3_RCE_MASK) >> SAI_RCR3_RCE_SHIFT);
+	uint8_t    tfw = (uint8_t)(sai->TCR1 & SAI_TCR1_TFW_MASK);
+	uint8_t    rfw = (uint8_t)(sai->RCR1 & SAI_RCR1_RFW_MASK);
+	uint32_t   tcsr = sai->TCSR & ~(SAI_TCSR_FRF_MASK | SAI_TCSR_FWF_MASK | SAI_TCSR_BCE_MASK);
+	uint32_t   rcsr = sai->RCSR & ~(SAI_RCSR_FRF_MASK | SAI_RCSR_FWF_MASK | SAI_RCSR_BCE_MASK);
+	uint8_t    line;
+
+	for (line = 0; line < SIM_SAI_LINES; line++)
+	{
+		if (tce & (1u << line))
+		{
+			tcsr |= (s->tx.count[line] <= tfw) ? SAI_TCSR_FRF_MASK : 0u;	/* Room for a burst */
+			tcsr |= (s->tx.count[line] == 0u) ? SAI_TCSR_FWF_MASK : 0u;
+		}
+		if (rce & (1u << line))
+		{
+			rcsr |= (s->rx.count[line] > rfw) ? SAI_RCSR_FRF_MASK : 0u;
+			rcsr |= (s->rx.count[line] == SIM_SAI_FIFO) ? SAI_RCSR_FWF_MASK : 0u;
+		}
+		SIM_RO(sai->TFR[line]) = SAI_TFR_WFP(s->tx.wfp[line]) | SAI_TFR_RFP(s->tx.rfp[line]);
+		SIM_RO(sai->RFR[line]) = SAI_RFR_WFP(s->rx.wfp[line]) | SAI_RFR_RFP(s->rx.rfp[line]);
+		if (s->rx.count[line] != 0u)
+		{
+			SIM_RO(sai->RDR[line]) = s->rx.word[line][s->rx.head[line]];
+		}
+	}
+	if ((sai->RCR4 & SAI_RCR4_FCOMB_MASK) == SAI_RCR4_FCOMB(2))
+	{
+		uint8_t next = s->rx.combine;
+		uint8_t peek = combine_line(&s->rx, rce, sai_lines[instance]);
+		s->rx.combine = next;													/* Only a look at the next line */
+		for (line = 0; line < SIM_SAI_LINES; line++)
+		{
+			SIM_RO(sai->RDR[line]) = s->rx.word[peek][s->rx.head[peek]];
+		}
+	}
+	if (tcsr & SAI_TCSR_TE_MASK)
+	{
+		tcsr |= SAI_TCSR_BCE_MASK;
+	}
+	if ((rcsr & SAI_RCSR_RE_MASK) && (tcsr & SAI_TCSR_TE_MASK))
+	{
+		rcsr |= SAI_RCSR_BCE_MASK;
+	}
+	sai->TCSR = tcsr;
+	sai->RCSR = rcsr;
+
+	if (((tcsr & SAI_TCSR_FRIE_MASK) && (tcsr & SAI_TCSR_FRF_MASK)) ||
+		((tcsr & SAI_TCSR_FWIE_MASK) && (tcsr & SAI_TCSR_FWF_MASK)) ||
+		((tcsr & SAI_TCSR_FEIE_MASK) && (tcsr & SAI_TCSR_FEF_MASK)))
+	{
+		sim_irq_raise(sai_tx_irqs[instance]);
+	}
+	if (((rcsr & SAI_RCSR_FRIE_MASK) && (rcsr & SAI_RCSR_FRF_MASK)) ||
+		((rcsr & SAI_RCSR_FWIE_MASK) && (rcsr & SAI_RCSR_FWF_MASK)) ||
+		((rcsr & SAI_RCSR_FEIE_MASK) && (rcsr & SAI_RCSR_FEF_MASK)))
+	{
+		sim_irq_raise(sai_rx_irqs[instance]);
+	}
+	if ((tcsr & SAI_TCSR_FRDE_MASK) && (tcsr & SAI_TCSR_FRF_MASK))
+	{
+		sim_dma_request(sai_tx_req[instance]);
+	}
+	else
+	{
+		sim_dma_request_clear(sai_tx_req[instance]);
+	}
+	if ((rcsr & SAI_RCSR_RE_MASK) && (rcsr & SAI_RCSR_FRDE_MASK) && (rcsr & SAI_RCSR_FRF_MASK))
+	{
+		sim_dma_request(sai_rx_req[instance]);
+	}
+	else
+	{
+		sim_dma_request_clear(sai_rx_req[instance]);
+	}
+}
+
+/*!
+* @brief Duration of a slot in bus cycles: its word width times the bit clock period.
+*/
+static uint64_t slot_cycles(uint8_t instance, uint8_t slot)
+{
+	SAI_Type *sai = SIM_VIEW(sais[instance]);
+	uint32_t  bits = (slot == 0u) ? ((sai->TCR5 & SAI_TCR5_W0W_MASK) >> SAI_TCR5_W0W_SHIFT)
+								  : ((sai->TCR5 & SAI_TCR5_WNW_MASK) >> SAI_TCR5_WNW_SHIFT);
+
+	if ((sai->TCR2 & SAI_TCR2_MSEL_MASK) && !state[instance].warned)
+	{
+		fprintf(stderr, "sim: SAI%u bit clock source MSEL != 0 is modeled as the bus clock\n", instance);
+		state[instance].warned = true;
+	}
+	return (uint64_t)(bits + 1u) * 2u * ((sai->TCR2 & SAI_TCR2_DIV_MASK) + 1u);
+}
+
+static void slot_end(uint32_t instance)
+{
+	SAI_Type  *sai = SIM_VIEW(sais[instance]);
+	sim_sai_t *s = &state[instance];
+	uint8_t    tce = (uint8_t)((sai->TCR3 & SAI_TCR3_TCE_MASK) >> SAI_TCR3_TCE_SHIFT);
+	uint8_t    rce = (uint8_t)((sai->RCR3 & SAI_RCR3_RCE_MASK) >> SAI_RCR3_RCE_SHIFT);
+	bool       rx = (sai->RCSR & SAI_RCSR_RE_MASK) && (((sai->RCR2 & SAI_RCR2_SYNC_MASK) >> SAI_RCR2_SYNC_SHIFT) == 1u);
+	uint8_t    frame = (uint8_t)(((sai->TCR4 & SAI_TCR4_FRSZ_MASK) >> SAI_TCR4_FRSZ_SHIFT) + 1u);
+	uint32_t   words[SIM_SAI_LINES] = { 0u };
+	uint8_t    line;
+
+	if (!(sai->TCSR & SAI_TCSR_TE_MASK))
+	{
+		return;
+	}
+	for (line = 0; line < sai_lines[instance]; line++)
+	{
+		if ((tce & (1u << line)) && !(sai->TMR & (1u << s->slot)))
+		{
+			if (!fifo_pop(&s->tx, line, &words[line]))
+			{
+				sai->TCSR |= SAI_TCSR_FEF_MASK;									/* Underrun: the slot goes out as 0 */
+			}
+		}
+	}
+	for (line = 0; line < sai_lines[instance]; line++)
+	{
+		if (rx && (rce & (1u << line)) && !(sai->RMR & (1u << s->slot)))
+		{
+			uint32_t word = (device != NULL) ? device((uint8_t)instance, line, s->slot, words) : words[line];
+			if (!fifo_push(&s->rx, line, word))
+			{
+				sai->RCSR |= SAI_RCSR_FEF_MASK;									/* Overrun: the word is lost */
+			}
+		}
+	}
+	if ((s->slot == 0u) && (sai->TCSR & SAI_TCSR_WSIE_MASK))
+	{
+		sai->TCSR |= SAI_TCSR_WSF_MASK;
+	}
+	s->slot = (uint8_t)((s->slot + 1u) % frame);
+	update((uint8_t)instance);
+	sim_schedule(slot_cycles((uint8_t)instance, s->slot), slot_end, instance);
+}
+
+void sim_sai_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	SAI_Type  *sai = SIM_VIEW(sais[instance]);
+	sim_sai_t *s = &state[instance];
+	uint8_t    line;
+
+	switch (offset)
+	{
+		case 0x08u:																/* TCSR */
+			sai->TCSR = SIM_W1C(old_word, new_word, SAI_TCSR_WSF_MASK | SAI_TCSR_SEF_MASK | SAI_TCSR_FEF_MASK)
+					  & ~SAI_TCSR_FR_MASK;
+			if (new_word & (SAI_TCSR_FR_MASK | SAI_TCSR_SR_MASK))
+			{
+				fifo_reset(&s->tx);
+			}
+			if ((new_word & SAI_TCSR_TE_MASK) && !(old_word & SAI_TCSR_TE_MASK))
+			{
+				s->slot = 0;
+				sim_cancel(slot_end, instance);
+				sim_schedule(slot_cycles(instance, 0), slot_end, instance);
+			}
+			break;
+		case 0x20u:																/* TDR[0..3] */
+		case 0x24u:
+		case 0x28u:
+		case 0x2Cu:
+			line = (uint8_t)((offset - 0x20u) / 4u);
+			if ((sai->TCR4 & SAI_TCR4_FCOMB_MASK) == SAI_TCR4_FCOMB(2))
+			{
+				line = combine_line(&s->tx, (uint8_t)((sai->TCR3 & SAI_TCR3_TCE_MASK) >> SAI_TCR3_TCE_SHIFT),
+									sai_lines[instance]);
+			}
+			if ((line < sai_lines[instance]) && !fifo_push(&s->tx, line, new_word))
+			{
+				fprintf(stderr, "sim: SAI%u TDR[%u] written with a full FIFO, word dropped\n", instance, line);
+			}
+			break;
+		case 0x88u:																/* RCSR */
+			sai->RCSR = SIM_W1C(old_word, new_word, SAI_RCSR_WSF_MASK | SAI_RCSR_SEF_MASK | SAI_RCSR_FEF_MASK)
+					  & ~SAI_RCSR_FR_MASK;
+			if (new_word & (SAI_RCSR_FR_MASK | SAI_RCSR_SR_MASK))
+			{
+				fifo_reset(&s->rx);
+			}
+			if ((new_word & SAI_RCSR_RE_MASK) && !(old_word & SAI_RCSR_RE_MASK) &&
+				(((sai->RCR2 & SAI_RCR2_SYNC_MASK) >> SAI_RCR2_SYNC_SHIFT) != 1u) && !s->warned)
+			{
+				fprintf(stderr, "sim: SAI%u receiver is only modeled synchronous to the transmitter\n", instance);
+				s->warned = true;
+			}
+			break;
+		default:
+			break;
+	}
+	update(instance);
+}
+
+void sim_sai_read(uint8_t instance, uint32_t offset)
+{
+	SAI_Type  *sai = SIM_VIEW(sais[instance]);
+	sim_sai_t *s = &state[instance];
+	uint32_t   word;
+	uint8_t    line;
+
+	if ((offset >= 0xA0u) && (offset < 0xB0u))									/* RDR[0..3] */
+	{
+		line = (uint8_t)((offset - 0xA0u) / 4u);
+		if ((sai->RCR4 & SAI_RCR4_FCOMB_MASK) == SAI_RCR4_FCOMB(2))
+		{
+			line = combine_line(&s->rx, (uint8_t)((sai->RCR3 & SAI_RCR3_RCE_MASK) >> SAI_RCR3_RCE_SHIFT),
+								sai_lines[instance]);
+		}
+		if (line < sai_lines[instance])
+		{
+			(void)fifo_pop(&s->rx, line, &word);
+		}
+		update(instance);
+	}
+}
+
+void sim_sai_reset(void)
+{
+	uint8_t instance;
+	for (instance = 0; instance < SIM_SAI_COUNT; instance++)
+	{
+		SAI_Type *sai = SIM_VIEW(sais[instance]);
+		memset(&state[instance], 0, sizeof(state[instance]));
+		SIM_RO(sai->VERID) = 0x03000000u;
+		SIM_RO(sai->PARAM) = SAI_PARAM_FRAME(4u) | SAI_PARAM_FIFO(3u) | SAI_PARAM_DATALINE(sai_lines[instance]);
+	}
+}
@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim_internal.h"
+
+/*!
+ * LPIT and LPTMR models
+ * ===================================================
+ * LPIT channels run the 32-bit periodic counter mode (MODE = 0) on the PCC clock, or count the
+ * expiries of the previous channel when TCTRL[CHAIN] is set. Each expiry sets MSR[TIFn], raises
+ * the channel IRQ when MIER enables it and triggers the DMAMUX periodic channel of the same
+ * number. Trigger control (TSOT/TSOI/TROT) is not modeled. LPTMR runs the time counter mode.
+ */
+
+#define SIM_LPO_1K_HZ		(1000u)
+#define SIM_RTC_HZ			(32768u)
+
+enum
+{
+	LPIT_MCR_OFFSET    = 0x08u,
+	LPIT_MSR_OFFSET    = 0x0Cu,
+	LPIT_SETTEN_OFFSET = 0x14u,
+	LPIT_CLRTEN_OFFSET = 0x18u,
+	LPIT_TMR_OFFSET    = 0x20u
+};
+
+static const IRQn_Type lpit_irqs[] = LPIT_IRQS;
+
+static struct
+{
+	uint64_t start;								/* Cycle the current period started */
+	uint64_t period;							/* Period in bus cycles, 0 for a chained channel */
+	uint32_t count;								/* Count of a chained channel */
+	bool     running;
+} lpit[LPIT_TMR_COUNT];
+
+static struct
+{
+	uint64_t start;								/* Cycle the counter was last at 0 */
+	uint64_t tick;								/* Counter period in bus cycles */
+	bool     running;
+} lptmr;
+
+static uint64_t ticks_to_cycles(uint64_t ticks, uint32_t clock_hz)
+{
+	return (ticks * SIM_BUS_CLOCK_HZ + clock_hz - 1u) / clock_hz;
+}
+
+/*!
+ * LPIT
+ * ===================================================
+ */
+static void lpit_expire(uint32_t channel);
+
+static void lpit_load(uint8_t channel)
+{
+	LPIT_Type *regs = SIM_VIEW(LPIT0);
+	uint32_t clock_hz = sim_pcc_clock_hz(PCC_LPIT_INDEX);
+
+	lpit[channel].start = sim_now();
+	lpit[channel].count = regs->TMR[channel].TVAL;
+	if ((channel > 0u) && (regs->TMR[channel].TCTRL & LPIT_TMR_TCTRL_CHAIN_MASK))
+	{
+		lpit[channel].period = 0;						/* Decremented by the previous channel */
+	}
+	else if (clock_hz != 0u)
+	{
+		lpit[channel].period = ticks_to_cycles((uint64_t)regs->TMR[channel].TVAL + 1u, clock_hz);
+		sim_schedule(lpit[channel].period, lpit_expire, channel);
+	}
+	else
+	{
+		lpit[channel].period = 0;						/* No functional clock: the counter is frozen */
+	}
+}
+
+static void lpit_start(uint8_t channel)
+{
+	if (!lpit[channel].running)
+	{
+		lpit[channel].running = true;
+		lpit_load(channel);
+	}
+}
+
+static void lpit_stop(uint8_t channel)
+{
+	lpit[channel].running = false;
+	sim_cancel(lpit_expire, channel);
+}
+
+static void lpit_expire(uint32_t channel)
+{
+	LPIT_Type *regs = SIM_VIEW(LPIT0);
+	uint8_t    next = (uint8_t)(channel + 1u);
+
+	regs->MSR |= 1u << channel;
+	if (regs->MIER & (1u << channel))
+	{
+		sim_irq_raise(lpit_irqs[channel]);
+	}
+	sim_dma_periodic((uint8_t)channel);
+
+	if ((next < LPIT_TMR_COUNT) && lpit[next].running && (regs->TMR[next].TCTRL & LPIT_TMR_TCTRL_CHAIN_MASK))
+	{
+		if (lpit[next].count == 0u)
+		{
+			lpit_expire(next);
+			lpit[next].count = regs->TMR[next].TVAL;
+		}
+		else
+		{
+			lpit[next].count--;
+		}
+	}
+	if (lpit[channel].running && (lpit[channel].period != 0u))
+	{
+		lpit_load((uint8_t)channel);						/* TVAL changes take effect on reload */
+	}
+}
+
+static void lpit_update_enables(uint32_t old_enables, uint32_t new_enables)
+{
+	uint8_t channel;
+	for (channel = 0; channel < LPIT_TMR_COUNT; channel++)
+	{
+		if ((new_enables & ~old_enables) & (1u << channel))
+		{
+			lpit_start(channel);
+		}
+		else if ((old_enables & ~new_enables) & (1u << channel))
+		{
+			lpit_stop(channel);
+		}
+	}
+}
+
+static uint32_t lpit_enables(void)
+{
+	LPIT_Type *regs = SIM_VIEW(LPIT0);
+	uint32_t enables = 0;
+	uint8_t  channel;
+
+	if (regs->MCR & LPIT_MCR_M_CEN_MASK)
+	{
+		for (channel = 0; channel < LPIT_TMR_COUNT; channel++)
+		{
+			enables |= (regs->TMR[channel].TCTRL & LPIT_TMR_TCTRL_T_EN_MASK) << channel;
+		}
+	}
+	return enables;
+}
+
+void sim_lpit_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	LPIT_Type *regs = SIM_VIEW(LPIT0);
+	uint32_t   old_enables = 0;
+	uint8_t    channel;
+	(void)instance;
+
+	for (channel = 0; channel < LPIT_TMR_COUNT; channel++)
+	{
+		old_enables |= (lpit[channel].running ? 1u : 0u) << channel;
+	}
+
+	if (offset == LPIT_MSR_OFFSET)
+	{
+		regs->MSR = SIM_W1C(old_word, new_word, 0xFu);
+	}
+	else if (offset == LPIT_SETTEN_OFFSET)
+	{
+		for (channel = 0; channel < LPIT_TMR_COUNT; channel++)
+		{
+			if (new_word & (1u << channel))
+			{
+				regs->TMR[channel].TCTRL |= LPIT_TMR_TCTRL_T_EN_MASK;
+			}
+		}
+		regs->SETTEN = 0;
+	}
+	else if (offset == LPIT_CLRTEN_OFFSET)
+	{
+		for (channel = 0; channel < LPIT_TMR_COUNT; channel++)
+		{
+			if (new_word & (1u << channel))
+			{
+				regs->TMR[channel].TCTRL &= ~LPIT_TMR_TCTRL_T_EN_MASK;
+			}
+		}
+		regs->CLRTEN = 0;
+	}
+	else if (offset == LPIT_MCR_OFFSET)
+	{
+		if (new_word & LPIT_MCR_SW_RST_MASK)
+		{
+			regs->MSR  = 0;
+			regs->MIER = 0;
+			for (channel = 0; channel < LPIT_TMR_COUNT; channel++)
+			{
+				regs->TMR[channel].TVAL  = 0;
+				regs->TMR[channel].TCTRL = 0;
+			}
+		}
+	}
+	lpit_update_enables(old_enables, lpit_enables());
+}
+
+void sim_lpit_read(uint8_t instance, uint32_t offset)
+{
+	LPIT_Type *regs = SIM_VIEW(LPIT0);
+	uint8_t    channel;
+	(void)instance;
+
+	if ((offset >= LPIT_TMR_OFFSET) && ((offset & 0xFu) == 0x4u))		/* CVAL */
+	{
+		channel = (uint8_t)((offset - LPIT_TMR_OFFSET) >> 4);
+		if (!lpit[channel].running)
+		{
+			SIM_RO(regs->TMR[channel].CVAL) = 0xFFFFFFFFu;
+		}
+		else if (lpit[channel].period == 0u)
+		{
+			SIM_RO(regs->TMR[channel].CVAL) = lpit[channel].count;
+		}
+		else
+		{
+			uint64_t elapsed = (sim_now() - lpit[channel].start) * (regs->TMR[channel].TVAL + 1ull) / lpit[channel].period;
+			SIM_RO(regs->TMR[channel].CVAL) = regs->TMR[channel].TVAL - (uint32_t)elapsed;
+		}
+	}
+}
+
+/*!
+ * LPTMR
+ * ===================================================
+ */
+static void lptmr_compare(uint32_t arg);
+
+static uint32_t lptmr_clock_hz(void)
+{
+	LPTMR_Type *regs = SIM_VIEW(LPTMR0);
+	SCG_Type   *scg  = SIM_VIEW(SCG);
+	uint32_t    div;
+
+	switch ((regs->PSR & LPTMR_PSR_PCS_MASK) >> LPTMR_PSR_PCS_SHIFT)
+	{
+		case 0u:														/* SIRCDIV2 */
+			div = (scg->SIRCDIV & SCG_SIRCDIV_SIRCDIV2_MASK) >> SCG_SIRCDIV_SIRCDIV2_SHIFT;
+			return (div == 0u) ? 0u : 8000000u >> (div - 1u);
+		case 1u:
+			return SIM_LPO_1K_HZ;
+		case 2u:
+			return SIM_RTC_HZ;
+		default:
+			return sim_pcc_clock_hz(PCC_LPTMR0_INDEX);
+	}
+}
+
+static uint32_t lptmr_count(void)
+{
+	LPTMR_Type *regs = SIM_VIEW(LPTMR0);
+	uint64_t    ticks;
+
+	if (!lptmr.running || (lptmr.tick == 0u))
+	{
+		return 0;
+	}
+	ticks = (sim_now() - lptmr.start) / lptmr.tick;
+	return (regs->CSR & LPTMR_CSR_TFC_MASK) ? (uint32_t)(ticks & 0xFFFFu) : (uint32_t)ticks;
+}
+
+static void lptmr_schedule(void)
+{
+	LPTMR_Type *regs = SIM_VIEW(LPTMR0);
+	uint64_t    ticks = (regs->CMR & 0xFFFFu) + 1ull;
+
+	sim_cancel(lptmr_compare, 0);
+	if (lptmr.running && (lptmr.tick != 0u))
+	{
+		if (regs->CSR & LPTMR_CSR_TFC_MASK)
+		{
+			ticks += ((sim_now() - lptmr.start) / lptmr.tick) & ~0xFFFFull;
+			ticks = (lptmr.start + ticks * lptmr.tick > sim_now()) ? ticks : ticks + 0x10000u;
+		}
+		sim_schedule(lptmr.start + ticks * lptmr.tick - sim_now(), lptmr_compare, 0);
+	}
+}
+
+static void lptmr_compare(uint32_t arg)
+{
+	LPTMR_Type *regs = SIM_VIEW(LPTMR0);
+	(void)arg;
+
+	regs->CSR |= LPTMR_CSR_TCF_MASK;
+	if (regs->CSR & LPTMR_CSR_TIE_MASK)
+	{
+		sim_irq_raise(LPTMR0_IRQn);
+	}
+	if (regs->CSR & LPTMR_CSR_TDRE_MASK)
+	{
+		sim_dma_request(EDMA_REQ_LPTMR0);
+	}
+	if (!(regs->CSR & LPTMR_CSR_TFC_MASK))
+	{
+		lptmr.start = sim_now();										/* Counter resets on compare */
+	}
+	lptmr_schedule();
+}
+
+void sim_lptmr_write(uint8_t instance, uint32_t offset, uint32_t old_word, uint32_t new_word)
+{
+	LPTMR_Type *regs = SIM_VIEW(LPTMR0);
+	(void)instance;
+
+	switch (offset)
+	{
+		case 0x0u:														/* CSR */
+			regs->CSR = SIM_W1C(old_word, new_word, LPTMR_CSR_TCF_MASK);
+			if ((new_word & LPTMR_CSR_TEN_MASK) && !lptmr.running)
+			{
+				uint32_t clock_hz = lptmr_clock_hz();
+				uint32_t prescale = (regs->PSR & LPTMR_PSR_PBYP_MASK) ? 1u
+								  : 2u << ((regs->PSR & LPTMR_PSR_PRESCALE_MASK) >> LPTMR_PSR_PRESCALE_SHIFT);
+				lptmr.running = true;
+				lptmr.start   = sim_now();
+				lptmr.tick    = (clock_hz == 0u) ? 0u : ticks_to_cycles(prescale, clock_hz);
+			}
+			else if (!(new_word & LPTMR_CSR_TEN_MASK))
+			{
+				lptmr.running = false;
+				regs->CSR &= ~LPTMR_CSR_TCF_MASK;						/* Disabling clears TCF and the counter */
+			}
+			lptmr_schedule();
+			break;
+		case 0x8u:														/* CMR */
+			lptmr_schedule();
+			break;
+		case 0xCu:														/* CNR: any write captures the counter */
+			regs->CNR = lptmr_count();
+			break;
+		default:
+			break;
+	}
+}
+
+void sim_lptmr_read(uint8_t instance, uint32_t offset)
+{
+	(void)instance;
+	(void)offset;
+}
+
+void sim_timers_reset(void)
+{
+	LPIT_Type  *lpit_regs  = SIM_VIEW(LPIT0);
+	LPTMR_Type *lptmr_regs = SIM_VIEW(LPTMR0);
+	uint8_t     channel;
+
+	SIM_RO(lpit_regs->VERID) = 0x01000000u;
+	SIM_RO(lpit_regs->PARAM) = 0x00000404u;
+	for (channel = 0; channel < LPIT_TMR_COUNT; channel++)
+	{
+		lpit[channel].running = false;
+		SIM_RO(lpit_regs->TMR[channel].CVAL) = 0xFFFFFFFFu;
+	}
+	lptmr.running = false;
+	lptmr_regs->CSR = 0;
+	lptmr_regs->PSR = 0;
+	lptmr_regs->CMR = 0;
+	lptmr_regs->CNR = 0;
+}
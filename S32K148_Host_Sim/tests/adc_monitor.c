@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * ADC limit monitor event ring
+ * ===================================================
+ * Check of adc_monitor.c (S32K148_Project_ADC_FlexScan) on the ADC0, PDB0 and eDMA models.
+ * Entry 1 of a 4 entry list reports bursts of out-of-window results, numbered in their value:
+ *
+ * 	- a short burst comes out in order without overrun,
+ * 	- a stalled reader finds a burst of exactly one ring, or of 40 events, as the last ring - 1
+ * 	  events in order with the others counted in overruns, never as an empty ring,
+ * 	- a ring lapped before its lap interrupt is served reads as empty, not as stale events.
+ *
+ * The exit status is 1 when a check fails.
+ */
+
+#include <stdio.h>
+#include "device_registers.h"
+#include "clocks_and_modes.h"
+#include "adc_monitor.h"
+
+#define ENTRIES			(4u)
+#define SPIKE_ADCH		(1u)				/* ADCH of entry 1 */
+#define SPIKE_BASE		(3100u)				/* Above the window of every entry */
+#define SCAN_HZ			(10000u)
+#define SCAN_CYCLES		(SIM_BUS_CLOCK_HZ / SCAN_HZ)
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+static ADC_Monitor_t mon;
+static uint32_t burst;						/* Out-of-window results still to produce */
+static uint32_t spikes;						/* Out-of-window results produced */
+static uint32_t failures;
+
+void DMA9_IRQHandler(void)
+{
+	ADC_Monitor_IRQHandler(&mon);
+}
+
+static void check(int ok, const char *what, int line)
+{
+	if (!ok)
+	{
+		printf("adc_monitor.c:%d: %s failed\n", line, what);
+		failures++;
+	}
+}
+
+/*!
+* @brief ADC0 inputs: mid scale, entry 1 out of its window while a burst lasts.
+*/
+static uint16_t source(uint8_t instance, uint8_t channel, uint64_t cycles)
+{
+	(void)instance;
+	(void)cycles;
+	if ((channel == SPIKE_ADCH) && (burst != 0u))
+	{
+		burst--;
+		return (uint16_t)(SPIKE_BASE + (spikes++ % 900u));
+	}
+	return 2048u;
+}
+
+/*!
+* @brief Produce count out-of-window results and let their DMA services complete.
+*/
+static void spike(uint32_t count)
+{
+	burst = count;
+	while (burst != 0u)
+	{
+		SIM_advance(SCAN_CYCLES);
+	}
+	SIM_advance(SCAN_CYCLES);
+}
+
+/*!
+* @brief Take count events, 1 if they are results first .. first + count - 1 of entry 1.
+*/
+static uint32_t take(uint32_t first, uint32_t count)
+{
+	ADC_Monitor_Event_t event;
+	uint32_t ok = 1;
+	uint32_t i;
+
+	for (i = first; i < first + count; i++)
+	{
+		ok &= ADC_Monitor_Get(&mon, &event) &&
+			  ((event.sc1 & ADC_SC1_ADCH_MASK) == SPIKE_ADCH) && (event.result == SPIKE_BASE + (i % 900u));
+	}
+	return ok;
+}
+
+int __wrap_sim_app_main(void)
+{
+	ADC_Monitor_Channel_t list[ENTRIES];
+	ADC_Monitor_Event_t event;
+	uint32_t overruns;
+	uint8_t k;
+
+	SOSC_init_8MHz();
+	SPLL_init_160MHz();
+	NormalRUNmode_80MHz();
+	SIM_ADC_set_source(source);
+	for (k = 0; k < ENTRIES; k++)
+	{
+		list[k].adch = k;
+		list[k].low  = 1000;
+		list[k].high = 3000;
+	}
+	CHECK(ADC_Monitor_init(&mon, list, ENTRIES, 7));
+	CHECK(ADC_Monitor_start(&mon, SCAN_HZ));
+	SIM_irq_enable();
+
+	/* The reader keeps up */
+	spike(5);
+	CHECK(take(0, 5));
+	CHECK(!ADC_Monitor_Get(&mon, &event));
+	CHECK(mon.overruns == 0u);
+
+	/* The reader stalls for exactly one ring */
+	spike(ADC_MONITOR_EVENTS);
+	CHECK(ADC_Monitor_reported(&mon) == 5u + ADC_MONITOR_EVENTS);
+	CHECK(take(6, ADC_MONITOR_EVENTS - 1u));
+	CHECK(!ADC_Monitor_Get(&mon, &event));
+	CHECK(mon.overruns == 1u);
+
+	/* ...and for 40 events */
+	spike(40);
+	CHECK(take(21 + 40 - (ADC_MONITOR_EVENTS - 1u), ADC_MONITOR_EVENTS - 1u));
+	CHECK(!ADC_Monitor_Get(&mon, &event));
+	CHECK(mon.overruns == 1u + 40u - (ADC_MONITOR_EVENTS - 1u));
+	CHECK(mon.laps == (21u + 40u) / ADC_MONITOR_EVENTS);
+
+	/* The lap interrupt is held off while the ring wraps */
+	overruns = mon.overruns;
+	spike(ADC_MONITOR_EVENTS - ((21u + 40u) % ADC_MONITOR_EVENTS) - 1u);
+	CHECK(take(61, ADC_MONITOR_EVENTS - ((21u + 40u) % ADC_MONITOR_EVENTS) - 1u));
+	SIM_irq_disable();
+	spike(2);
+	CHECK(!ADC_Monitor_Get(&mon, &event));
+	SIM_irq_enable();
+	CHECK(take(ADC_MONITOR_EVENTS * 4u - 1u, 2));
+	CHECK(!ADC_Monitor_Get(&mon, &event));
+	CHECK(mon.overruns == overruns);
+
+	printf("adc_monitor: %u events, %u lap interrupts, %u overruns, %u failed\n",
+		   (unsigned)ADC_Monitor_reported(&mon), (unsigned)mon.laps, (unsigned)mon.overruns, (unsigned)failures);
+	SIM_stop(failures != 0u);
+	return 0;
+}
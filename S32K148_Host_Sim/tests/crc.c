@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * CRC paths of S32K148_Project_CRC
+ * ===================================================
+ * Check of crc.c on the CRC peripheral model, with the bitwise engine of crc_sw.c as the
+ * reference, for CRC-32, CRC-16/CCITT and CRC-8 SAE J1850:
+ *
+ * 	- before the application, the peripheral path gives the check value of each algorithm and
+ * 	  the CRC of buffers of every alignment, with lengths around the word boundaries,
+ * 	- a stream context moved to another path (CRC_save) after every frame, and streams fed
+ * 	  frame by frame in turn on the shared peripheral, one-shot calculations in between, give
+ * 	  the CRC of their whole data,
+ * 	- the DMA-fed mode gives the CRC of buffers with every head alignment, shorter than a minor
+ * 	  loop, of whole minor loops and with a tail, added to a stream after CPU-fed data,
+ * 	- the application then runs to its idle loop; when the simulation stops, crc_check[] must
+ * 	  hold the check values, crc_block[] the CRC of the 16 KB block and crc_stream[] and
+ * 	  crc_dma[] the same.
+ *
+ * The exit status is 1 when a check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "device_registers.h"
+#include "crc.h"
+
+#define CRC_ALGOS		(3u)
+#define CAL_BLOCK_SIZE	(16384u)				/* Test block of main.c */
+#define BUFFER_SIZE		(80u)
+#define FRAME_SIZE		(7u)					/* Odd frames: every alignment on the way */
+#define CRC_DMA_CH		(0u)					/* Channel of main.c, its DMA0_IRQHandler */
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+extern uint32_t crc_check[CRC_ALGOS];
+extern uint32_t crc_block[CRC_ALGOS];
+extern uint32_t crc_stream[CRC_ALGOS];
+extern uint32_t crc_dma[CRC_ALGOS];
+
+static const CRC_Algo_t * const algos[CRC_ALGOS] = { &CRC_ALGO_32, &CRC_ALGO_16_CCITT, &CRC_ALGO_8_SAE_J1850 };
+
+static uint32_t tables[CRC_ALGOS][CRC_SLICES][256];
+static CRC_Engine_t engines[CRC_ALGOS];
+static uint32_t block[CAL_BLOCK_SIZE / 4u];
+static uint8_t buffer[BUFFER_SIZE + 4u];
+static uint32_t failures;
+static uint32_t dma_result;
+static uint32_t dma_calls;
+
+static void check(int ok, const char *what, int line)
+{
+	if (!ok)
+	{
+		printf("crc.c:%d: %s failed\n", line, what);
+		failures++;
+	}
+}
+
+/*!
+* @brief Reference CRC: bitwise software engine.
+*/
+static uint32_t reference(uint8_t algo, const uint8_t *data, uint32_t size)
+{
+	return CRC_SW_calculate(&engines[algo], CRC_BITWISE, data, size);
+}
+
+/*!
+* @brief Peripheral path against the reference, every start alignment and lengths 0 to 12 and
+* around BUFFER_SIZE.
+*/
+static void check_peripheral(uint8_t algo)
+{
+	uint32_t offset;
+	uint32_t size;
+
+	CHECK(CRC_HW_calculate(algos[algo], (const uint8_t *)"123456789", 9) == algos[algo]->check);
+	for (offset = 0; offset < 4u; offset++)
+	{
+		for (size = 0; size <= BUFFER_SIZE; size = (size == 12u) ? (BUFFER_SIZE - 3u) : (size + 1u))
+		{
+			CHECK(CRC_run(&engines[algo], CRC_HW, buffer + offset, size) == reference(algo, buffer + offset, size));
+		}
+	}
+}
+
+/*!
+* @brief Streams: one context switched between the paths at every frame, then three streams in
+* turn on the peripheral (two of this algorithm, one of the next) with a one-shot calculation
+* between the frames.
+*/
+static void check_streams(uint8_t algo)
+{
+	uint8_t  other = (uint8_t)((algo + 1u) % CRC_ALGOS);
+	CRC_Stream_t a;
+	CRC_Stream_t b;
+	CRC_Stream_t c;
+	uint32_t offset;
+	uint32_t size;
+	uint8_t  path = CRC_HW;
+
+	CRC_begin(&a, &engines[algo], CRC_HW);
+	for (offset = 0; offset < BUFFER_SIZE; offset += size)
+	{
+		size = (BUFFER_SIZE - offset < FRAME_SIZE) ? (BUFFER_SIZE - offset) : FRAME_SIZE;
+		CRC_update(&a, buffer + offset, size);
+		CRC_save(&a);
+		path = (uint8_t)((path + 1u) % CRC_PATHS);		/* HW, bitwise, table, slice-by-8, HW... */
+		a.path = (CRC_Path_t)path;
+	}
+	CHECK(a.length == BUFFER_SIZE);
+	CHECK(CRC_finish(&a) == reference(algo, buffer, BUFFER_SIZE));
+
+	CRC_begin(&a, &engines[algo], CRC_HW);
+	CRC_begin(&b, &engines[algo], CRC_HW);
+	CRC_begin(&c, &engines[other], CRC_HW);
+	for (offset = 0; offset < BUFFER_SIZE; offset += size)
+	{
+		size = (BUFFER_SIZE - offset < FRAME_SIZE) ? (BUFFER_SIZE - offset) : FRAME_SIZE;
+		CRC_update(&a, buffer + offset, size);
+		CRC_update(&b, buffer + 1u + offset, size);
+		(void)CRC_HW_calculate(algos[other], buffer, offset);
+		CRC_update(&c, buffer + offset, size);
+	}
+	CHECK(CRC_finish(&a) == reference(algo, buffer, BUFFER_SIZE));
+	CHECK(CRC_finish(&b) == reference(algo, buffer + 1u, BUFFER_SIZE));
+	CHECK(CRC_finish(&c) == reference(other, buffer, BUFFER_SIZE));
+
+	CRC_update(&a, buffer + BUFFER_SIZE, 3u);			/* Continued after CRC_finish */
+	CHECK(CRC_finish(&a) == reference(algo, buffer, BUFFER_SIZE + 3u));
+}
+
+static void dma_done(CRC_Stream_t *stream, void *arg)
+{
+	*(uint32_t *)arg = CRC_finish(stream);
+	dma_calls++;
+}
+
+/*!
+* @brief DMA-fed mode: the first prefix bytes through CRC_update, then size bytes by the DMA.
+* Returns once the completion callback ran; the core sleeps until the DMA interrupt.
+*/
+static uint32_t dma_crc(uint8_t algo, const uint8_t *data, uint32_t prefix, uint32_t size)
+{
+	CRC_Stream_t stream;
+	uint32_t calls = dma_calls;
+
+	CRC_begin(&stream, &engines[algo], CRC_HW);
+	CRC_update(&stream, data, prefix);
+	CHECK(CRC_DMA_update(&stream, data + prefix, size, dma_done, &dma_result) == 1u);
+	SIM_irq_disable();
+	while (CRC_DMA_busy())
+	{
+		SIM_wait_for_interrupt();
+		SIM_irq_enable();
+		SIM_irq_disable();
+	}
+	SIM_irq_enable();
+	CHECK(dma_calls == calls + 1u);
+	CHECK(stream.length == prefix + size);
+	return dma_result;
+}
+
+/*!
+* @brief DMA-fed mode against the reference, every head alignment, sizes below a minor loop,
+* of whole minor loops and with a tail; a busy channel refuses a second buffer.
+*/
+static void check_dma(uint8_t algo)
+{
+	static const uint32_t sizes[] = { 5u, CRC_DMA_MINOR_BYTES - 1u, CRC_DMA_MINOR_BYTES,
+									  3u * CRC_DMA_MINOR_BYTES + 5u };
+	const uint8_t *data = (const uint8_t *)block;
+	CRC_Stream_t stream;
+	uint32_t offset;
+	uint8_t  i;
+
+	for (offset = 0; offset < 4u; offset++)
+	{
+		for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+		{
+			CHECK(dma_crc(algo, data, offset, sizes[i]) == reference(algo, data, offset + sizes[i]));
+		}
+	}
+
+	CRC_begin(&stream, &engines[algo], CRC_SLICE8);
+	CHECK(CRC_DMA_update(&stream, data, CRC_DMA_MINOR_BYTES, dma_done, &dma_result) == 0u);	/* Not on the peripheral */
+	CRC_begin(&stream, &engines[algo], CRC_HW);
+	CHECK(CRC_DMA_update(&stream, data, 2u * CRC_DMA_MINOR_BYTES, dma_done, &dma_result) == 1u);
+	CHECK(CRC_DMA_update(&stream, data, CRC_DMA_MINOR_BYTES, dma_done, &dma_result) == 0u);	/* Busy */
+	CHECK(CRC_finish(&stream) == reference(algo, data, 2u * CRC_DMA_MINOR_BYTES));		/* Waits for the DMA */
+}
+
+/*!
+* @brief Results of the application, checked when the simulation stops.
+*/
+static void check_application(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < CRC_ALGOS; i++)
+	{
+		uint32_t expected = reference(i, (const uint8_t *)block, CAL_BLOCK_SIZE);
+		CHECK(crc_check[i] == algos[i]->check);
+		CHECK(crc_block[i] == expected);
+		CHECK(crc_stream[i] == expected);
+		CHECK(crc_dma[i] == expected);
+		printf("crc: %s block 0x%08X\n", algos[i]->name, (unsigned)expected);
+	}
+	printf("crc: %u failed\n", (unsigned)failures);
+	if (failures != 0u)
+	{
+		_exit(1);
+	}
+}
+
+int __real_sim_app_main(void);
+
+int __wrap_sim_app_main(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < sizeof(buffer); i++)
+	{
+		buffer[i] = (uint8_t)(i * 0x9Du + 0x5Bu);
+	}
+	for (i = 0; i < (CAL_BLOCK_SIZE / 4u); i++)			/* Test pattern of main.c */
+	{
+		block[i] = i * 0x9E3779B9u;
+	}
+
+	for (i = 0; i < CRC_ALGOS; i++)
+	{
+		CRC_SW_init(&engines[i], algos[i], tables[i], CRC_SLICES);
+		check_peripheral((uint8_t)i);
+	}
+	for (i = 0; i < CRC_ALGOS; i++)
+	{
+		check_streams((uint8_t)i);
+	}
+	CRC_DMA_init(CRC_DMA_CH);
+	for (i = 0; i < CRC_ALGOS; i++)
+	{
+		check_dma((uint8_t)i);
+	}
+
+	atexit(check_application);
+	return __real_sim_app_main();
+}
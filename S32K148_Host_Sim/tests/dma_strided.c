@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * Strided DMA transfers
+ * ===================================================
+ * Check of DMA_TCD_Strided (dma.c of S32K148_Project_ADC_FlexScan) on the eDMA model. Each walk
+ * runs for a few major loops, one software request per minor loop; element e of minor loop m of
+ * major loop n must be copied from source base + e * element + m * minor + n * major to the
+ * same place of the destination walk, nothing else may be written and SADDR/DADDR must end at
+ * base + majors * major:
+ *
+ * 	- column gather, reversed elements, negative minor and major strides, one MLOFF shared by
+ * 	  both sides, more than 1023 bytes per minor loop without MLOFF, the 16-bit element limits,
+ * 	- every walk DMA_TCD_Strided refuses (returns 0), next to the accepted limits.
+ *
+ * The exit status is 1 when a check fails.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "device_registers.h"
+#include "dma.h"
+
+#define ARENA			(65536u)
+#define CHANNEL			(0u)
+
+typedef struct
+{
+	DMA_Size_t size;
+	uint16_t elements;
+	uint16_t minors;
+	uint16_t majors;						/* Major loops run */
+	uint32_t sbase;							/* Offset of the first source element in src */
+	DMA_Stride_t sstride;
+	uint32_t dbase;							/* Offset of the first destination element in dst */
+	DMA_Stride_t dstride;
+}Walk_t;
+
+static const Walk_t walks[] = {
+	/* Column of a 6 x 10 word matrix per minor loop, the next column in the next one */
+	{ DMA_SIZE_4BYTES, 6, 5, 2,  1000, {   40,    4,     0 },  2000, {  4,   24,  120 } },
+	/* Reversed half words */
+	{ DMA_SIZE_2BYTES, 8, 4, 2,  9000, {   -2,  -16,   -64 },  2000, {  2,   16,   64 } },
+	/* Negative minor and major strides, on both sides */
+	{ DMA_SIZE_1BYTE,  5, 6, 3,  5000, {    1,  -32,     7 }, 20000, {  3,   15, -500 } },
+	/* Same MLOFF (52) for both sides */
+	{ DMA_SIZE_4BYTES, 3, 4, 2,  1000, {    4,   64,   512 }, 20000, { -4,   40, -300 } },
+	/* 1200 bytes per minor loop, contiguous minor loops (no MLOFF) */
+	{ DMA_SIZE_4BYTES, 300, 2, 1, 8000, {   4, 1200,     0 }, 20000, { -4, -1200,  0 } },
+	/* Element steps at the 16-bit limits */
+	{ DMA_SIZE_1BYTE,  2, 2, 2, 40000, { -32768, 1, 2 },    100, { 1, 2, 4 } },
+	{ DMA_SIZE_1BYTE,  2, 1, 2,   100, { 1, 2, 4 },         100, { 32767, 65534, 3 } },
+};
+
+static const Walk_t refused[] = {
+	{ DMA_SIZE_4BYTES, 0, 4, 0, 0, { 4, 16, 0 }, 0, { 4, 16, 0 } },					/* No element */
+	{ DMA_SIZE_4BYTES, 4, 0, 0, 0, { 4, 16, 0 }, 0, { 4, 16, 0 } },					/* No minor loop */
+	{ DMA_SIZE_4BYTES, 4, 32768, 0, 0, { 4, 16, 0 }, 0, { 4, 16, 0 } },				/* CITER 15 bits */
+	{ DMA_SIZE_1BYTE,  2, 2, 0, 0, { 32768, 0, 0 }, 0, { 1, 2, 0 } },				/* SOFF */
+	{ DMA_SIZE_1BYTE,  2, 2, 0, 0, { 1, 2, 0 }, 0, { -32769, 0, 0 } },				/* DOFF */
+	{ DMA_SIZE_4BYTES, 4, 2, 0, 0, { 4, 32, 0 }, 0, { 4, 48, 0 } },					/* MLOFF 16 and 32 */
+	{ DMA_SIZE_4BYTES, 256, 2, 0, 0, { 4, 1028, 0 }, 0, { 4, 1024, 0 } },			/* 1024 bytes with MLOFF */
+	{ DMA_SIZE_1BYTE,  1, 2, 0, 0, { 1, 1 + (1 << 19), 0 }, 0, { 1, 1, 0 } },		/* MLOFF 2^19 */
+	{ DMA_SIZE_1BYTE,  1, 2, 0, 0, { 1, 1, 0 }, 0, { 1, 1 - (1 << 19) - 1, 0 } },	/* MLOFF -2^19 - 1 */
+};
+
+static const Walk_t limits[] = {
+	{ DMA_SIZE_4BYTES, 4, 32767, 0, 0, { 4, 16, 0 }, 0, { 4, 16, 0 } },
+	{ DMA_SIZE_1BYTE,  2, 2, 0, 0, { 32767, 0, 0 }, 0, { -32768, -65536, 0 } },
+	{ DMA_SIZE_4BYTES, 255, 2, 0, 0, { 4, 1024, 0 }, 0, { 4, 1020, 0 } },			/* 1020 bytes with MLOFF 4 */
+	{ DMA_SIZE_4BYTES, 256, 2, 0, 0, { 4, 1024, 0 }, 0, { 4, 1024, 0 } },			/* 1024 bytes, no MLOFF */
+	{ DMA_SIZE_1BYTE,  1, 2, 0, 0, { 1, (1 << 19), 0 }, 0, { 1, 1, 0 } },			/* MLOFF 2^19 - 1 */
+	{ DMA_SIZE_1BYTE,  1, 2, 0, 0, { 1, 1, 0 }, 0, { 1, 1 - (1 << 19), 0 } },		/* MLOFF -2^19 */
+};
+
+static uint8_t src[ARENA];
+static uint8_t dst[ARENA];
+static uint8_t ref[ARENA];
+static TCD_t tcd __attribute__ ((aligned(32)));
+static uint32_t failures;
+
+/*!
+* @brief Count and report a failed check of entry index of a walk table.
+*/
+static void check_entry(int ok, const char *what, const char *table, uint32_t index)
+{
+	if (!ok)
+	{
+		printf("dma_strided.c: %s[%u]: %s failed\n", table, (unsigned)index, what);
+		failures++;
+	}
+}
+
+/*!
+* @brief Address of element e of minor loop m of major loop n.
+*/
+static int32_t at(uint32_t base, const DMA_Stride_t * stride, int32_t e, int32_t m, int32_t n)
+{
+	return (int32_t)base + e * stride->element + m * stride->minor + n * stride->major;
+}
+
+static uint8_t compile(const Walk_t * w)
+{
+	return DMA_TCD_Strided(&tcd, &src[w->sbase], &w->sstride, &dst[w->dbase], &w->dstride,
+						   w->size, w->elements, w->minors);
+}
+
+/*!
+* @brief Run a walk on the eDMA and compare the destination with the walk done in C.
+*/
+static void run(const Walk_t * w, uint32_t index)
+{
+	uint32_t size = DMA_SIZE_BYTES(w->size);
+	uint32_t in_arena = 1;
+	int32_t e, m, n;
+
+	for (e = 0; e < (int32_t)ARENA; e++)
+	{
+		src[e] = (uint8_t)(e ^ (e >> 8) ^ 0x5Au);
+	}
+	memset(dst, 0xEE, sizeof(dst));
+	memset(ref, 0xEE, sizeof(ref));
+	for (n = 0; n < w->majors; n++)
+	{
+		for (m = 0; m < w->minors; m++)
+		{
+			for (e = 0; e < w->elements; e++)
+			{
+				int32_t s = at(w->sbase, &w->sstride, e, m, n);
+				int32_t d = at(w->dbase, &w->dstride, e, m, n);
+
+				if ((s < 0) || (s + (int32_t)size > (int32_t)ARENA) || (d < 0) || (d + (int32_t)size > (int32_t)ARENA))
+				{
+					in_arena = 0;
+					continue;
+				}
+				memcpy(&ref[d], &src[s], size);
+			}
+		}
+	}
+	check_entry(in_arena, "walk inside the arena", "walks", index);
+	check_entry(compile(w) == 1u, "DMA_TCD_Strided accepts the walk", "walks", index);
+
+	DMA_TCD_Push(CHANNEL, &tcd);
+	for (n = 0; n < w->majors; n++)
+	{
+		for (m = 0; m < w->minors; m++)
+		{
+			DMA->SSRT = DMA_SSRT_SSRT(CHANNEL);
+			do
+			{
+				SIM_advance(64);
+			}
+			while (DMA->TCD[CHANNEL].CSR & (DMA_TCD_CSR_START_MASK | DMA_TCD_CSR_ACTIVE_MASK));
+		}
+		check_entry((DMA->TCD[CHANNEL].CSR & DMA_TCD_CSR_DONE_MASK) != 0u, "major loop done", "walks", index);
+		DMA->CDNE = DMA_CDNE_CDNE(CHANNEL);
+	}
+	check_entry((DMA->ERR & (1u << CHANNEL)) == 0u, "no configuration error", "walks", index);
+	DMA->CERR = DMA_CERR_CERR(CHANNEL);
+	check_entry(memcmp(dst, ref, sizeof(dst)) == 0, "destination matches the walk", "walks", index);
+	check_entry(DMA->TCD[CHANNEL].SADDR == (uint32_t)at((uint32_t)(uintptr_t)&src[w->sbase], &w->sstride, 0, 0, w->majors),
+		  "SADDR at the next major loop", "walks", index);
+	check_entry(DMA->TCD[CHANNEL].DADDR == (uint32_t)at((uint32_t)(uintptr_t)&dst[w->dbase], &w->dstride, 0, 0, w->majors),
+		  "DADDR at the next major loop", "walks", index);
+}
+
+int __wrap_sim_app_main(void)
+{
+	uint32_t i;
+
+	SIM->PLATCGC |= SIM_PLATCGC_CGCDMA_MASK;		/* DMA Clock Gating Control Enable */
+	DMA->CR |= DMA_CR_EMLM_MASK;					/* Minor loop offsets */
+
+	for (i = 0; i < sizeof(walks) / sizeof(walks[0]); i++)
+	{
+		run(&walks[i], i);
+	}
+	for (i = 0; i < sizeof(refused) / sizeof(refused[0]); i++)
+	{
+		check_entry(compile(&refused[i]) == 0u, "DMA_TCD_Strided refuses the walk", "refused", i);
+	}
+	for (i = 0; i < sizeof(limits) / sizeof(limits[0]); i++)
+	{
+		check_entry(compile(&limits[i]) == 1u, "DMA_TCD_Strided accepts the limit", "limits", i);
+	}
+
+	printf("dma_strided: %u walks, %u refused, %u limits, %u failed\n",
+		   (unsigned)(sizeof(walks) / sizeof(walks[0])), (unsigned)(sizeof(refused) / sizeof(refused[0])),
+		   (unsigned)(sizeof(limits) / sizeof(limits[0])), (unsigned)failures);
+	SIM_stop(failures != 0u);
+	return 0;
+}
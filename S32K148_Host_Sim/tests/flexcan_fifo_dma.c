@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * FlexCAN RX FIFO drained by the eDMA
+ * ===================================================
+ * Check of FlexCAN_FIFO_DMA.c (S32K148_Project_FlexCan_FIFO) on the CAN0 and eDMA models:
+ *
+ * 	- 100 frames read as they arrive come out in order, with one DMA interrupt per half ring,
+ * 	- a reader stalled for 40 frames finds the last slots - 1 of them in order and the others
+ * 	  counted in overruns,
+ * 	- frames lost in the FIFO while the DMA channel is held off are counted in fifo_overflows.
+ *
+ * The exit status is 1 when a check fails.
+ */
+
+#include <stdio.h>
+#include "device_registers.h"
+#include "FlexCAN_FIFO_DMA.h"
+
+#define RING_SLOTS		(16u)
+#define FRAME_ID		(0x123u)
+#define FRAME_GAP		(10000u)			/* Bus cycles between two frames, 250 us */
+#define FIFO_DEPTH		(6u)
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+static FLEXCAN_FIFO_DMA_t rx;
+static FLEXCAN_FIFO_Frame_t ring[RING_SLOTS];
+static uint32_t failures;
+
+void DMA0_IRQHandler(void)
+{
+	FLEXCAN_FIFO_DMA_IRQHandler(&rx);
+}
+
+static void check(int ok, const char *what, int line)
+{
+	if (!ok)
+	{
+		printf("flexcan_fifo_dma.c:%d: %s failed\n", line, what);
+		failures++;
+	}
+}
+
+/*!
+* @brief One frame on the bus, its payload carries the sequence number and its complement.
+*/
+static void send(uint32_t sequence)
+{
+	uint32_t payload[2] = { sequence, ~sequence };
+
+	SIM_CAN_inject(0, FRAME_ID, 0, 8, 0, payload);
+	SIM_advance(FRAME_GAP);
+}
+
+/*!
+* @brief Take the oldest frame of the ring, 1 if it is frame sequence.
+*/
+static uint32_t take(uint32_t sequence)
+{
+	const FLEXCAN_FIFO_Frame_t * frame = FLEXCAN_FIFO_DMA_peek(&rx);
+	uint32_t ok = (frame != NULL) && (FLEXCAN_FIFO_ID(frame) == FRAME_ID) && (FLEXCAN_FIFO_DLC(frame) == 8u) &&
+				  (frame->payload[0] == sequence) && (frame->payload[1] == ~sequence);
+
+	FLEXCAN_FIFO_DMA_release(&rx);
+	return ok;
+}
+
+/*!
+* @brief CAN0 at 500 kbit/s from the 8 MHz SOSCDIV2, RX FIFO with 8 filters all accepting
+* FRAME_ID, left in freeze mode for FLEXCAN_FIFO_DMA_init.
+*/
+static void CAN0_freeze_with_fifo(void)
+{
+	uint32_t i;
+
+	PCC->PCCn[PCC_FlexCAN0_INDEX] |= PCC_PCCn_CGC_MASK;
+	CAN0->MCR |= CAN_MCR_MDIS_MASK;
+	CAN0->CTRL1 &= ~CAN_CTRL1_CLKSRC_MASK;
+	CAN0->MCR &= ~CAN_MCR_MDIS_MASK;
+	while (!(CAN0->MCR & CAN_MCR_FRZACK_MASK));
+	CAN0->MCR |= CAN_MCR_RFEN_MASK | CAN_MCR_SRXDIS_MASK;
+	CAN0->CTRL1 |= CAN_CTRL1_PSEG2(3) | CAN_CTRL1_PSEG1(3) | CAN_CTRL1_PROPSEG(6) | CAN_CTRL1_RJW(3);
+	for (i = 0; i < 8u; i++)
+	{
+		CAN0->RAMn[24u + i] = FRAME_ID << 19;		/* ID filter table after the FIFO (MB6, MB7) */
+	}
+	CAN0->RXFGMASK = 0x7FFu << 19;
+}
+
+int __wrap_sim_app_main(void)
+{
+	uint32_t in_order = 0;
+	uint32_t i;
+
+	CAN0_freeze_with_fifo();
+	FLEXCAN_FIFO_DMA_init(&rx, 0, 0, ring, RING_SLOTS);
+	CAN0->MCR &= ~(CAN_MCR_HALT_MASK | CAN_MCR_FRZ_MASK);
+	while (CAN0->MCR & CAN_MCR_FRZACK_MASK);
+	while (CAN0->MCR & CAN_MCR_NOTRDY_MASK);
+	SIM_irq_enable();
+
+	/* The reader keeps up */
+	for (i = 0; i < 100u; i++)
+	{
+		send(i);
+		in_order += take(i);
+	}
+	CHECK(in_order == 100u);
+	CHECK(FLEXCAN_FIFO_DMA_peek(&rx) == NULL);
+
+	/* The reader stalls for 40 frames: the DMA laps it */
+	for (i = 100; i < 140u; i++)
+	{
+		send(i);
+	}
+	CHECK(FLEXCAN_FIFO_DMA_pending(&rx) == 40u);
+	CHECK(FLEXCAN_FIFO_DMA_peek(&rx) != NULL);
+	CHECK(rx.overruns == 40u - (RING_SLOTS - 1u));
+	CHECK(FLEXCAN_FIFO_DMA_pending(&rx) == RING_SLOTS - 1u);
+	in_order = 0;
+	for (i = 140u - (RING_SLOTS - 1u); i < 140u; i++)
+	{
+		in_order += take(i);
+	}
+	CHECK(in_order == RING_SLOTS - 1u);
+	CHECK(FLEXCAN_FIFO_DMA_pending(&rx) == 0u);
+	CHECK(rx.halves == 140u / (RING_SLOTS / 2u));	/* Interrupts per half ring, not per frame */
+	CHECK(rx.fifo_overflows == 0u);
+
+	/* The DMA channel is held off: the FIFO keeps FIFO_DEPTH frames and flags the loss */
+	DMA->CERQ = DMA_CERQ_CERQ(0);
+	for (i = 140; i < 142u + FIFO_DEPTH; i++)
+	{
+		send(i);
+	}
+	DMA->SERQ = DMA_SERQ_SERQ(0);
+	SIM_advance(FRAME_GAP);
+	in_order = 0;
+	for (i = 140; i < 140u + FIFO_DEPTH; i++)
+	{
+		in_order += take(i);
+	}
+	CHECK(in_order == FIFO_DEPTH);
+	CHECK(FLEXCAN_FIFO_DMA_pending(&rx) == 0u);
+	CHECK(rx.fifo_overflows == 1u);					/* Seen by the interrupt of the half at 144 */
+
+	printf("flexcan_fifo_dma: %u DMA interrupts, %u overruns, %u FIFO overflows, %u failed\n",
+		   (unsigned)rx.halves, (unsigned)rx.overruns, (unsigned)rx.fifo_overflows, (unsigned)failures);
+	SIM_stop(failures != 0u);
+	return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * NOR flash data log of S32K148_Project_LPSPI_4bits
+ * ===================================================
+ * The application runs against a 1 MB NOR flash model on LPSPI1 PCS1 whose array starts
+ * programmed to 0x00, so the log only reads back right if it erases each sector it enters.
+ * Simulated time does not depend on the host, so after SIM_RUN_MS_nor_log (400 ms, Makefile)
+ * the log is always at the same record. When the simulation stops:
+ *
+ * 	- the JEDEC ID gave the size of the model and QE was set (quad data phases),
+ * 	- exactly LOG_RECORDS records were completed, into a second sector, with LOG_MISSES pages
+ * 	  read from the flash, and each record read back equal (log_errors),
+ * 	- the array holds every completed record {sequence, address, 0x5555AAAA ^ sequence,
+ * 	  ~sequence} at its address, and the rest of the current sector is erased.
+ *
+ * The exit status is 1 when a check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "device_registers.h"
+#include "NOR_Flash.h"
+
+#define NOR_SIZE		(1u << 20)
+#define RECORD_SIZE		(16u)					/* record[4] of main.c */
+#define LOG_RECORDS		(361u)					/* Completed in 400 ms */
+#define LOG_MISSES		(23u)					/* Page cache misses meanwhile */
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+extern NOR_Flash_t flash;
+extern uint32_t record[4];
+extern uint32_t log_errors;
+
+static uint8_t memory[NOR_SIZE];
+static uint32_t failures;
+
+static void check(int ok, const char *what, int line)
+{
+	if (!ok)
+	{
+		printf("nor_log.c:%d: %s failed\n", line, what);
+		failures++;
+	}
+}
+
+/*!
+* @brief Results of the application, checked when the simulation stops.
+*/
+static void check_application(void)
+{
+	uint32_t records = record[0];				/* Record records may be half programmed */
+	uint32_t end = (records + 1u) * RECORD_SIZE;
+	uint32_t sector_end = (end + NOR_SECTOR_SIZE - 1u) & ~(NOR_SECTOR_SIZE - 1u);
+	uint32_t bad = 0;
+	uint32_t k;
+
+	CHECK(flash.size == NOR_SIZE);
+	CHECK(flash.quad == 1u);
+	CHECK(log_errors == 0u);
+	CHECK(records == LOG_RECORDS);
+	CHECK(flash.misses == LOG_MISSES);
+	CHECK(records * RECORD_SIZE > NOR_SECTOR_SIZE);	/* A second sector was erased */
+	CHECK(end <= NOR_SIZE);						/* The log has not wrapped */
+	if (end <= NOR_SIZE)
+	{
+		for (k = 0; k < records; k++)
+		{
+			uint32_t expected[4] = { k, k * RECORD_SIZE, 0x5555AAAAu ^ k, ~k };
+			bad += (memcmp(&memory[k * RECORD_SIZE], expected, RECORD_SIZE) != 0);
+		}
+		for (k = end; k < sector_end; k++)
+		{
+			bad += (memory[k] != 0xFFu);
+		}
+	}
+	CHECK(bad == 0u);
+
+	printf("nor_log: %u records, %u log errors, %u bad in the array, %u cache hits, %u misses, %u failed\n",
+		   (unsigned)records, (unsigned)log_errors, (unsigned)bad, (unsigned)flash.hits,
+		   (unsigned)flash.misses, (unsigned)failures);
+	if (failures != 0u)
+	{
+		_exit(1);
+	}
+}
+
+int __real_sim_app_main(void);
+
+int __wrap_sim_app_main(void)
+{
+	memset(memory, 0x00, sizeof(memory));		/* Stale content */
+	SIM_NOR_attach(1, 1, memory, sizeof(memory));
+	atexit(check_application);
+	return __real_sim_app_main();
+}
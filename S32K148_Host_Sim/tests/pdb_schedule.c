@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * PDB schedule compiler ranges
+ * ===================================================
+ * Check of pdb_schedule.c (S32K148_Project_ADC_FlexScan): whatever divider PDB_Sched_compile
+ * picks, the programmed counts fit the 16-bit registers and every delay comes before the end
+ * of the period:
+ *
+ * 	- a delay or IDLY that rounds up to the period (0x10000 counts) is PDB_SCHED_RANGE,
+ * 	- DLY = 0xFFFF compiles in continuous mode, not in one-shot mode where MOD = DLY + 1,
+ * 	- random continuous and one-shot schedules: MOD, DLY and IDLY <= 0xFFFF, DLY and IDLY
+ * 	  <= MOD in continuous mode and < MOD in one-shot mode.
+ *
+ * The exit status is 1 when a check fails.
+ */
+
+#include <stdio.h>
+#include "device_registers.h"
+#include "pdb_schedule.h"
+
+#define PERIOD_MAX_NS	(819200u)			/* 0x10000 counts of the undivided 80 MHz clock */
+#define SCHEDULES		(20000u)
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)
+
+static uint32_t failures;
+
+static void check(int ok, const char *what, int line)
+{
+	if (!ok)
+	{
+		printf("pdb_schedule.c:%d: %s failed\n", line, what);
+		failures++;
+	}
+}
+
+/*!
+* @brief xorshift32, a reproducible sequence of schedules.
+*/
+static uint32_t random32(void)
+{
+	static uint32_t x = 0x2545F491u;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return x;
+}
+
+/*!
+* @brief 1 if the counts of a compiled schedule fit the registers and the period.
+*/
+static uint32_t fits(const PDB_Schedule_t * sched, const PDB_Program_t * prog)
+{
+	uint32_t last = (sched->continuous) ? prog->mod : prog->mod - 1u;
+	uint32_t ok = (prog->mod <= 0xFFFFu) && ((sched->idly_ns == 0u) || (prog->idly <= last));
+	uint8_t ch, m;
+
+	for (ch = 0; ch < PDB_CH_COUNT; ch++)
+	{
+		for (m = 0; m < PDB_DLY_COUNT; m++)
+		{
+			ok &= (sched->pt[ch][m].mode != PDB_SCHED_AT) || (prog->dly[ch][m] <= last);
+		}
+	}
+	return ok;
+}
+
+int __wrap_sim_app_main(void)
+{
+	PDB_Schedule_t sched = { 0 };
+	PDB_Program_t prog;
+	uint32_t compiled = 0;
+	uint32_t bad = 0;
+	uint32_t n;
+
+	/* A delay or IDLY 1 ns before the end of a 0x10000-count period rounds to the period at
+	 * every divider */
+	sched.period_ns  = PERIOD_MAX_NS;
+	sched.trgsel     = 15u;
+	sched.continuous = 1u;
+	sched.pt[0][0].mode = PDB_SCHED_AT;
+	sched.pt[0][0].delay_ns = PERIOD_MAX_NS - 1u;
+	CHECK(PDB_Sched_compile(&sched, &prog) == PDB_SCHED_RANGE);
+	sched.pt[0][0].delay_ns = 0u;
+	sched.idly_ns = PERIOD_MAX_NS - 1u;
+	CHECK(PDB_Sched_compile(&sched, &prog) == PDB_SCHED_RANGE);
+
+	/* DLY = 0xFFFF: fits MOD in continuous mode, not the one-shot MOD = DLY + 1 */
+	sched.idly_ns = 0u;
+	sched.pt[0][0].delay_ns = PERIOD_MAX_NS - 10u;
+	CHECK(PDB_Sched_compile(&sched, &prog) == PDB_SCHED_OK);
+	CHECK(fits(&sched, &prog) && (prog.dly[0][0] == 0xFFFFu) && (prog.mod == 0xFFFFu));
+	sched.continuous = 0u;
+	sched.trgsel     = 0u;
+	CHECK(PDB_Sched_compile(&sched, &prog) == PDB_SCHED_RANGE);
+
+	/* Random schedules around the 16-bit limit of each divider */
+	for (n = 0; n < SCHEDULES; n++)
+	{
+		uint8_t k;
+
+		sched = (PDB_Schedule_t){ 0 };
+		sched.period_ns  = 1000u + random32() % (PERIOD_MAX_NS * (1u << (random32() % 13u)));
+		sched.continuous = (uint8_t)(random32() & 1u);
+		sched.trgsel     = sched.continuous ? 15u : 0u;
+		sched.idly_ns    = (random32() & 1u) ? sched.period_ns - 1u - random32() % 64u : 0u;
+		for (k = 0; k < 4u; k++)
+		{
+			uint32_t pt = random32() % PDB_SCHED_PRETRIGGERS;
+
+			sched.pt[pt / PDB_DLY_COUNT][pt % PDB_DLY_COUNT].mode = PDB_SCHED_AT;
+			sched.pt[pt / PDB_DLY_COUNT][pt % PDB_DLY_COUNT].delay_ns =
+				(k == 0u) ? sched.period_ns - 1u - random32() % 64u : random32() % sched.period_ns;
+		}
+		if (PDB_Sched_compile(&sched, &prog) == PDB_SCHED_OK)
+		{
+			compiled++;
+			bad += !fits(&sched, &prog);
+		}
+	}
+	CHECK(bad == 0u);
+	CHECK(compiled > SCHEDULES / 4u);
+
+	printf("pdb_schedule: %u of %u schedules compiled, %u out of range, %u failed\n",
+		   (unsigned)compiled, (unsigned)SCHEDULES, (unsigned)bad, (unsigned)failures);
+	SIM_stop(failures != 0u);
+	return 0;
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * ADC decimation filter reference
+ * ===================================================
+ * Host check of adc_decim.c (S32K148_Project_ADC_FlexScan) against a double-precision model of
+ * the two stages: boxcar sum scaled to 15 bits, FIR with round half up and saturation to 15
+ * bits, output scaled to the channel resolution.
+ *
+ * 	adc_decim_ref
+ *
+ * runs each filter configuration over a noisy DC level, a full-scale square wave and a ramp
+ * (with garbage in the upper bits of the result words), fed at once and in blocks of 1 to 37
+ * results, and compares every output with the model. The exit status is 1 on any mismatch.
+ *
+ * Built twice by the Makefile: adc_decim_ref with the portable C multiply-accumulate and
+ * adc_decim_ref_dsp with the SMLAD path of the FIR, where ADC_DECIM_SMLAD models the instruction
+ * and also fails the check if an accumulation ever leaves 32 bits (the Q flag of the M4).
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "adc_decim.h"
+
+#define SAMPLES			(20000u)
+#define MAX_BLOCK		(37u)
+
+typedef struct
+{
+	const char *name;
+	uint8_t boxcar_log2;
+	const int16_t *taps;
+	uint8_t ntaps;
+	uint8_t decimation;
+	uint8_t bits;
+} config_t;
+
+static const int16_t lowpass_4[16] = ADC_DECIM_LOWPASS_4;
+static const int16_t smooth_3[3]   = { 8192, 16384, 8192 };
+static const int16_t overshoot[3]  = { 32767, 32767, -32766 };	/* Saturates both ways on steps */
+static int16_t flat_32[ADC_DECIM_MAX_TAPS];
+
+static const config_t configs[] =
+{
+	{ "pass-through 12 bit",        0, NULL,       0,  1, 12 },
+	{ "boxcar 8, FIR /4, 14 bit",   3, lowpass_4, 16,  4, 14 },
+	{ "boxcar 16, FIR /4, 16 bit",  4, lowpass_4, 16,  4, 16 },
+	{ "boxcar 256, 16 bit",         8, NULL,       0,  1, 16 },
+	{ "boxcar 2, 3 taps /2, 15 bit",1, smooth_3,   3,  2, 15 },
+	{ "overshoot 3 taps, 13 bit",   2, overshoot,  3,  1, 13 },
+	{ "32 taps /3, 16 bit",         5, flat_32,   32,  3, 16 },
+};
+
+static uint32_t input[SAMPLES];
+static uint16_t output[SAMPLES + 1u];
+static uint16_t expected[SAMPLES + 1u];
+
+#if defined(ADC_DECIM_SMLAD)
+static uint32_t smlad_overflows;
+
+/*!
+* @brief SMLAD of the ARMv7-M ARM: both products and acc added at full precision, the low 32
+* bits kept; a sum that does not fit sets the Q flag, counted here.
+*/
+int32_t ADC_DECIM_SMLAD(uint32_t x, uint32_t y, int32_t acc)
+{
+	int64_t sum = (int64_t)(int16_t)x * (int16_t)y + (int64_t)(int16_t)(x >> 16) * (int16_t)(y >> 16) + acc;
+
+	if (sum != (int32_t)sum)
+	{
+		smlad_overflows++;
+	}
+	return (int32_t)(uint32_t)sum;
+}
+#endif
+
+/*!
+* @brief Outputs of the model for count results.
+*/
+static uint32_t model(const config_t *c, const uint32_t *in, uint32_t count, uint16_t *out)
+{
+	double line[ADC_DECIM_MAX_TAPS] = { 0 };
+	uint32_t length = 1u << c->boxcar_log2;
+	uint32_t written = 0;
+	uint32_t inputs = 0;
+	uint32_t i;
+	uint32_t k;
+
+	for (i = 0; i + length <= count; i += length)
+	{
+		double sum = 0.0;
+		double y;
+
+		for (k = 0; k < length; k++)
+		{
+			sum += (double)(in[i + k] & 0xFFFu);
+		}
+		y = floor(sum * 32768.0 / (4096.0 * length));		/* Boxcar sum to 15 bits */
+
+		if (c->taps != NULL)
+		{
+			double acc = 0.0;
+			memmove(&line[1], &line[0], (ADC_DECIM_MAX_TAPS - 1u) * sizeof(line[0]));
+			line[0] = y;
+			if (++inputs % c->decimation != 0u)
+			{
+				continue;
+			}
+			for (k = 0; k < c->ntaps; k++)
+			{
+				acc += line[k] * c->taps[k];
+			}
+			y = floor((acc + 16384.0) / 32768.0);
+			y = (y < 0.0) ? 0.0 : (y > 32767.0) ? 32767.0 : y;
+		}
+		out[written++] = (uint16_t)((c->bits <= 15u) ? floor(y / (double)(1u << (15u - c->bits)))
+													 : y * (double)(1u << (c->bits - 15u)));
+	}
+	return written;
+}
+
+/*!
+* @brief One configuration over one signal, fed at once or in blocks of 1 to MAX_BLOCK.
+* @return Mismatches
+*/
+static uint32_t run(const config_t *c, const char *signal, uint8_t blocks)
+{
+	ADC_Decim_t f;
+	uint32_t count = model(c, input, SAMPLES, expected);
+	uint32_t written = 0;
+	uint32_t errors = 0;
+	uint32_t i;
+	uint32_t n;
+
+	if (!ADC_Decim_init(&f, c->boxcar_log2, c->taps, c->ntaps, c->decimation, c->bits))
+	{
+		printf("%s: rejected by ADC_Decim_init\n", c->name);
+		return 1;
+	}
+	for (i = 0, n = 1; i < SAMPLES; i += n, n = (n % MAX_BLOCK) + 1u)
+	{
+		if (!blocks)
+		{
+			n = SAMPLES;
+		}
+		if (n > SAMPLES - i)
+		{
+			n = SAMPLES - i;
+		}
+		written += ADC_Decim_run(&f, &input[i], n, &output[written]);
+	}
+	if (written != count)
+	{
+		printf("%s, %s: %u outputs, model %u\n", c->name, signal, (unsigned)written, (unsigned)count);
+		return 1;
+	}
+	for (i = 0; i < count; i++)
+	{
+		if (output[i] != expected[i])
+		{
+			if (errors < 4u)
+			{
+				printf("%s, %s: output %u is %u, model %u\n", c->name, signal, (unsigned)i,
+					   (unsigned)output[i], (unsigned)expected[i]);
+			}
+			errors++;
+		}
+	}
+	return errors;
+}
+
+int main(void)
+{
+	static const char * const signals[] = { "noisy DC", "square wave", "ramp" };
+	uint32_t seed = 1;
+	uint32_t errors = 0;
+	uint32_t i;
+	uint8_t  s;
+	uint8_t  c;
+
+	for (i = 0; i < ADC_DECIM_MAX_TAPS; i++)
+	{
+		flat_32[i] = 1024;
+	}
+	for (s = 0; s < sizeof(signals) / sizeof(signals[0]); s++)
+	{
+		for (i = 0; i < SAMPLES; i++)
+		{
+			uint32_t x;
+			seed = seed * 1103515245u + 12345u;
+			if (s == 0u)
+			{
+				x = 1234u + ((seed >> 16) % 7u) - 3u;				/* +-3 LSB */
+			}
+			else if (s == 1u)
+			{
+				x = ((i / 300u) & 1u) ? 4095u : 0u;
+			}
+			else
+			{
+				x = i % 4096u;
+			}
+			input[i] = x | 0xABC0000u;								/* Not a result bit */
+		}
+		for (c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+		{
+			errors += run(&configs[c], signals[s], 0);
+			errors += run(&configs[c], signals[s], 1);
+		}
+	}
+#if defined(ADC_DECIM_SMLAD)
+	printf("SMLAD path: %u accumulator overflows\n", (unsigned)smlad_overflows);
+	errors += smlad_overflows;
+#else
+	printf("portable path\n");
+#endif
+	printf("%u configurations, %u signals: %u mismatches\n", (unsigned)(sizeof(configs) / sizeof(configs[0])),
+		   (unsigned)(sizeof(signals) / sizeof(signals[0])), (unsigned)errors);
+	return (errors != 0u) ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * FlexCAN bit timing calculator
+ * ===================================================
+ * Host front end of FlexCAN_Timing.h: the same solver steps, evaluated at run time.
+ *
+ * 	can_timing CLK_HZ BITRATE [SP_PERMILLE [DATA_BITRATE [DATA_SP_PERMILLE [DELAY_NS]]]]
+ *
+ * 	can_timing 40000000 500000 800 2000000 750 250
+ *
+ * prints CTRL1 (classic timing) and CBT for the nominal bit rate, FDCBT and the FDCTRL TDC bits
+ * for the data bit rate, with the reached bit rate, sample point and propagation time. The exit
+ * status is 1 when a register set misses the request (the FLEXCAN_TIMING_ASSERT condition).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "FlexCAN_Timing.h"
+
+typedef struct
+{
+	int32_t presc, tq_raw, tq, tseg1, tseg2, phase1, prop, sjw;
+	int32_t presdiv, propseg, pseg1, pseg2, rjw;
+	int32_t ppm, sp, tdcoff, tdc, errors;
+} timing_t;
+
+/* One solver per register kind, the FLEXCAN_TIMING enum steps in order */
+#define TIMING_SOLVER(kind) \
+static void solve_##kind(timing_t * t, int64_t clk, int32_t rate, int32_t sp, int32_t delay) \
+{ \
+	int64_t p0 = FLEXCAN_TIMING_P0_(kind, clk, rate); \
+	int32_t raw; \
+	t->presc   = (int32_t)FLEXCAN_TIMING_PRESC_(kind, clk, rate, p0, delay); \
+	t->tq_raw  = (int32_t)FLEXCAN_TIMING_TQ_(clk, rate, t->presc); \
+	t->tq      = FLEXCAN_TIMING_CLAMP_(kind, t->tq_raw); \
+	raw        = FLEXCAN_TIMING_TSEG1_RAW_(t->tq, sp); \
+	t->tseg1   = FLEXCAN_TIMING_TSEG1_(kind, raw, t->tq); \
+	t->tseg2   = t->tq - 1 - t->tseg1; \
+	t->phase1  = FLEXCAN_TIMING_PHASE1_(kind, t->tseg1, t->tseg2); \
+	t->prop    = t->tseg1 - t->phase1; \
+	t->sjw     = FLEXCAN_TIMING_SJW_(kind, t->phase1, t->tseg2); \
+	t->presdiv = t->presc - 1; \
+	t->propseg = t->prop - FLEXCAN_##kind##_PROP_BIAS; \
+	t->pseg1   = t->phase1 - 1; \
+	t->pseg2   = t->tseg2 - 1; \
+	t->rjw     = t->sjw - 1; \
+	t->ppm     = FLEXCAN_TIMING_PPM_(clk, rate, t->presc, t->tq); \
+	t->sp      = FLEXCAN_TIMING_SP_(t->tseg1, t->tq); \
+	t->tdcoff  = t->presc * (1 + t->tseg1); \
+	t->tdc     = FLEXCAN_TIMING_TDC_(kind, t->presc, t->tdcoff); \
+	t->errors  = FLEXCAN_TIMING_ERRORS_(kind, clk, sp, delay, t->presc, t->tq_raw, t->tseg1, \
+										t->tseg2, t->prop, t->ppm, t->sp, t->tdc); \
+}
+
+TIMING_SOLVER(CTRL1)
+TIMING_SOLVER(CBT)
+TIMING_SOLVER(FDCBT)
+
+static void report(const char * reg, const timing_t * t, int64_t clk, int32_t sp, uint32_t word,
+				   const char * const fields[5])
+{
+	printf("%-6s 0x%08X  %s=%d %s=%d %s=%d %s=%d %s=%d\n", reg, word,
+		   fields[0], t->presdiv, fields[1], t->propseg, fields[2], t->pseg1,
+		   fields[3], t->pseg2, fields[4], t->rjw);
+	printf("       %d tq of %.2f ns, %.1f bit/s (%+d ppm), sample point %d.%d%% (asked %d.%d%%), "
+		   "propagation %d ns\n",
+		   t->tq, 1e9 * t->presc / (double)clk, (double)clk / ((double)t->presc * t->tq),
+		   t->ppm, t->sp / 10, t->sp % 10, sp / 10, sp % 10, FLEXCAN_TIMING_NS_(t->prop, t->presc, clk));
+	if (t->errors & FLEXCAN_TIMING_ERR_BITRATE)
+	{
+		printf("       error: no prescaler divides the clock to the bit rate\n");
+	}
+	if (t->errors & FLEXCAN_TIMING_ERR_SAMPLE)
+	{
+		printf("       error: sample point off by more than %d per mille\n", FLEXCAN_TIMING_SP_TOL);
+	}
+	if (t->errors & FLEXCAN_TIMING_ERR_RANGE)
+	{
+		printf("       error: %d tq per bit do not fit the register fields\n", t->tq_raw);
+	}
+	if (t->errors & FLEXCAN_TIMING_ERR_DELAY)
+	{
+		printf("       error: %s shorter than the delay\n",
+			   (reg[0] == 'F') ? "sample point without TDC" : "propagation segment");
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	static const char * const ctrl1_fields[5] = { "PRESDIV", "PROPSEG", "PSEG1", "PSEG2", "RJW" };
+	static const char * const cbt_fields[5]   = { "EPRESDIV", "EPROPSEG", "EPSEG1", "EPSEG2", "ERJW" };
+	static const char * const fdcbt_fields[5] = { "FPRESDIV", "FPROPSEG", "FPSEG1", "FPSEG2", "FRJW" };
+	timing_t ctrl1, cbt, fdcbt;
+	int64_t clk;
+	int32_t rate, sp, data_rate, data_sp, delay;
+	int status = 0;
+
+	if ((argc < 3) || (argc > 7))
+	{
+		fprintf(stderr, "usage: %s CLK_HZ BITRATE [SP_PERMILLE [DATA_BITRATE [DATA_SP_PERMILLE [DELAY_NS]]]]\n",
+				argv[0]);
+		return 2;
+	}
+	clk       = strtoll(argv[1], NULL, 0);
+	rate      = (int32_t)strtol(argv[2], NULL, 0);
+	sp        = (argc > 3) ? (int32_t)strtol(argv[3], NULL, 0) : 800;
+	data_rate = (argc > 4) ? (int32_t)strtol(argv[4], NULL, 0) : 0;
+	data_sp   = (argc > 5) ? (int32_t)strtol(argv[5], NULL, 0) : 750;
+	delay     = (argc > 6) ? (int32_t)strtol(argv[6], NULL, 0) : 250;
+	if ((clk <= 0) || (clk > 0x7FFFFFFF) || (rate <= 0) || (sp <= 0) || (sp >= 1000) ||
+		(data_rate < 0) || (data_sp <= 0) || (data_sp >= 1000) || (delay < 0))
+	{
+		fprintf(stderr, "%s: arguments out of range\n", argv[0]);
+		return 2;
+	}
+
+	printf("clock %lld Hz, delay %d ns\n\nnominal %d bit/s\n", (long long)clk, delay, rate);
+	solve_CTRL1(&ctrl1, clk, rate, sp, delay);
+	report("CTRL1", &ctrl1, clk, sp, FLEXCAN_CTRL1_TIMING_(ctrl1.presdiv, ctrl1.propseg, ctrl1.pseg1, ctrl1.pseg2, ctrl1.rjw), ctrl1_fields);
+	solve_CBT(&cbt, clk, rate, sp, delay);
+	report("CBT", &cbt, clk, sp, FLEXCAN_CBT_TIMING_(cbt.presdiv, cbt.propseg, cbt.pseg1, cbt.pseg2, cbt.rjw), cbt_fields);
+	status = (ctrl1.errors != 0) || (cbt.errors != 0);
+
+	if (data_rate != 0)
+	{
+		printf("\ndata %d bit/s\n", data_rate);
+		solve_FDCBT(&fdcbt, clk, data_rate, data_sp, delay);
+		report("FDCBT", &fdcbt, clk, data_sp, FLEXCAN_FDCBT_TIMING_(fdcbt.presdiv, fdcbt.propseg, fdcbt.pseg1, fdcbt.pseg2, fdcbt.rjw), fdcbt_fields);
+		printf("FDCTRL 0x%08X  TDCEN=%d TDCOFF=%d%s\n", FLEXCAN_FDCTRL_TDC_(fdcbt.tdc, fdcbt.tdcoff), fdcbt.tdc,
+			   fdcbt.tdc ? fdcbt.tdcoff : 0, fdcbt.tdc ? "" : " (TDC not usable: FPRESDIV > 1 or TDCOFF > 31)");
+		if (fdcbt.presc != cbt.presc)
+		{
+			printf("       note: nominal and data prescalers differ (%d, %d)\n", cbt.presc, fdcbt.presc);
+		}
+		status |= (fdcbt.errors != 0);
+	}
+	return status;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*!
+ * CRC software path benchmark
+ * ===================================================
+ * Host front end of crc_bench.c for the software engines of S32K148_Project_CRC (bitwise,
+ * table, slice-by-8; the peripheral path is checked on the simulator by tests/crc.c).
+ *
+ * 	crc_bench [LENGTH]
+ *
+ * times CRC-32, CRC-16/CCITT and CRC-8 SAE J1850 over a LENGTH byte buffer (default 16384) per
+ * size class and prints the path CRC_BENCH_run selects. The times are nanoseconds of the host.
+ * The exit status is 1 when an engine misses the check value of its algorithm.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "crc_sw.h"
+#include "crc_bench.h"
+
+#define MAX_LENGTH	(1u << 20)
+
+static uint32_t tables[CRC_SLICES][256];
+
+static uint32_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+static void print(char *line)
+{
+	fputs(line, stdout);
+}
+
+int main(int argc, char **argv)
+{
+	static const CRC_Algo_t * const algos[] = { &CRC_ALGO_32, &CRC_ALGO_16_CCITT, &CRC_ALGO_8_SAE_J1850 };
+	static uint8_t buffer[MAX_LENGTH];
+	uint32_t length = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 16384u;
+	CRC_Engine_t engine;
+	CRC_Bench_t bench;
+	int status = 0;
+	uint32_t i;
+	uint8_t path;
+
+	if ((length == 0u) || (length > MAX_LENGTH))
+	{
+		fprintf(stderr, "usage: crc_bench [LENGTH], 1 to %u bytes\n", MAX_LENGTH);
+		return 2;
+	}
+	for (i = 0; i < length; i++)
+	{
+		buffer[i] = (uint8_t)((i * 0x9E3779B9u) >> 24);
+	}
+
+	for (i = 0; i < sizeof(algos) / sizeof(algos[0]); i++)
+	{
+		CRC_SW_init(&engine, algos[i], tables, CRC_SLICES);
+		for (path = CRC_BITWISE; path <= CRC_SLICE8; path++)
+		{
+			if (CRC_SW_calculate(&engine, (CRC_Path_t)path, (const uint8_t *)"123456789", 9) != algos[i]->check)
+			{
+				printf("%s: path %u misses the check value 0x%08X\n", algos[i]->name, path, (unsigned)algos[i]->check);
+				status = 1;
+			}
+		}
+		CRC_BENCH_run(&engine, (1u << CRC_BITWISE) | (1u << CRC_TABLE) | (1u << CRC_SLICE8), CRC_SW_calculate,
+					  now_ns, buffer, length, &bench);
+		CRC_BENCH_report(&engine, &bench, print);
+	}
+	printf("host times in ns\n");
+	return status;
+}
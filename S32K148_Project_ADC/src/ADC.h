@@ -34,6 +34,8 @@
 #define ADC_H_
 #include "device_registers.h"	/* include peripheral declarations S32K144 */
 
+#define ADC_MV_PER_LSB_Q16 (((5000u << 16) + (0xFFFu / 2u)) / 0xFFFu)	/* 0-5V range, 12-bit: mv per LSB in Q16 */
+
 void convertAdcChan(uint16_t);
 void ADC_init(void);
 void ADC_init_HWTrigger(char Channel);
@@ -30,6 +30,7 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <stddef.h>
 #include "device_registers.h"           /* include peripheral declarations */
 #include "ADC.h"
 
@@ -128,7 +129,17 @@ uint32_t ADC_channel_read (void)
 {
 	uint16_t adc_raw_result = 0;
 	adc_raw_result = ADC0 -> R[0];      						/* For SW trigger mode, R[0] is used */
-	return (uint32_t)((5000 * adc_raw_result) / 0xFFF); 		/* Convert result to mV for 0-5 V range */
+	return (adc_raw_result * ADC_MV_PER_LSB_Q16 + 0x8000u) >> 16;	/* Convert result to mV for 0-5 V range, rounded */
+}
+
+/*!
+* @brief Read the ADC channel result without conversion.
+*
+* @return[uint16_t] Raw result, for ADC_scale_sample.
+*/
+uint16_t ADC_channel_read_raw (void)
+{
+	return (uint16_t)ADC0 -> R[0];      						/* For SW trigger mode, R[0] is used */
 }
 
 /*!
@@ -188,20 +199,86 @@ void ADC_calibration_init (int16_t gain, int16_t offset)
                                   	  	  	  	  	  	  	  	/* AVGE, AVGS = 0 HW average function disabled */
 }
 
+/* Checksum of a calibration record: complement of the sum of its words before check */
+static uint32_t ADC_calibration_check (const ADC_Cal_t *cal)
+{
+	const uint32_t *word = (const uint32_t *)cal;
+	uint32_t sum = 0;
+	uint8_t i;
+
+	for (i = 0; i < (offsetof(ADC_Cal_t, check) / 4u); i++)
+	{
+		sum += word[i];
+	}
+	return ~sum;
+}
+
+/*!
+* @brief Copy the calibration results of ADC0 into a record, after ADC_calibration_init.
+*
+* @param[ADC_Cal_t *cal] Record to fill, to be stored in flash
+* @param[uint16_t vref_mV] Reference voltage of the board in mV
+*/
+void ADC_calibration_save (ADC_Cal_t *cal, uint16_t vref_mV)
+{
+	cal -> magic   = ADC_CAL_MAGIC;
+	cal -> clps    = (uint16_t)ADC0 -> CLPS;
+	cal -> clp3    = (uint16_t)ADC0 -> CLP3;
+	cal -> clp2    = (uint16_t)ADC0 -> CLP2;
+	cal -> clp1    = (uint16_t)ADC0 -> CLP1;
+	cal -> clp0    = (uint16_t)ADC0 -> CLP0;
+	cal -> clpx    = (uint16_t)ADC0 -> CLPX;
+	cal -> clp9    = (uint16_t)ADC0 -> CLP9;
+	cal -> ug      = (uint16_t)ADC0 -> UG;
+	cal -> usr_ofs = (uint16_t)ADC0 -> USR_OFS;
+	cal -> vref_mV = vref_mV;
+	cal -> check   = ADC_calibration_check(cal);
+}
+
+/*!
+* @brief ADC Initialization for SW trigger with the calibration of a stored record,
+* in place of ADC_calibration_init after a reset.
+*
+* @param[const ADC_Cal_t *cal] Record written by ADC_calibration_save (flash or RAM)
+* @return 0 if the record is erased or corrupt: ADC_calibration_init must run
+*/
+uint8_t ADC_calibration_restore (const ADC_Cal_t *cal)
+{
+	if ((cal -> magic != ADC_CAL_MAGIC) || (cal -> check != ADC_calibration_check(cal)))
+	{
+		return 0;
+	}
+
+	ADC_init();													/* SW trigger, 12-bit */
+
+	ADC0 -> CLPS    = cal -> clps;								/* Results of the stored calibration */
+	ADC0 -> CLP3    = cal -> clp3;
+	ADC0 -> CLP2    = cal -> clp2;
+	ADC0 -> CLP1    = cal -> clp1;
+	ADC0 -> CLP0    = cal -> clp0;
+	ADC0 -> CLPX    = cal -> clpx;
+	ADC0 -> CLP9    = cal -> clp9;
+	ADC0 -> UG      = cal -> ug;
+	ADC0 -> USR_OFS = cal -> usr_ofs;
+	return 1;
+}
+
 /*! Configuration of 4 channels from the ADC0, those channels are
  * 	trigger from the PDB, the results are saved with the DMA.
- * 		ADC0->SC1[4] Pot
- * 		ADC0->SC1[5] Pot
- * 		ADC0->SC1[6] 3.3V (You must connect any voltage at PTB0)
- * 		ADC0->SC1[7] 3.3V (You must connect any voltage at PTB0)
+ * 		ADC0->SC1[2] Pot
+ * 		ADC0->SC1[3] Pot
+ * 		ADC0->SC1[4] 3.3V (You must connect any voltage at PTB0)
+ * 		ADC0->SC1[5] 3.3V (You must connect any voltage at PTB0)
+ * 	SC1[2..5] are used because R[2..5] is 16-byte aligned, which lets the
+ * 	DMA read the results with a source modulo.
  *
  * 		@param [uint8_t PotCh] Enters the Pot Channel of the EVB
  */
 void ADC_Config(uint8_t Pot_Ch){
+	ADC0->SC1[2] = ADC_SC1_ADCH_MASK;	/* Channel 2 is disabled */
+	ADC0->SC1[3] = ADC_SC1_ADCH_MASK;	/* Channel 3 is disabled */
 	ADC0->SC1[4] = ADC_SC1_ADCH_MASK;	/* Channel 4 is disabled */
 	ADC0->SC1[5] = ADC_SC1_ADCH_MASK;	/* Channel 5 is disabled */
-	ADC0->SC1[6] = ADC_SC1_ADCH_MASK;	/* Channel 6 is disabled */
-	ADC0->SC1[7] = ADC_SC1_ADCH_MASK;	/* Channel 7 is disabled */
 
 	ADC0->CFG1 = ADC_CFG1_ADIV(0)|	/* Divide ratio = 1 */
 				 ADC_CFG1_MODE(1);	/*	12-bit conversion */
@@ -211,10 +288,10 @@ void ADC_Config(uint8_t Pot_Ch){
 	ADC0->SC2 = ADC_SC2_ADTRG(1)|	/* ADTRG = 1: HW trigger */
 				ADC_SC2_DMAEN_MASK; /* DMA interrupt enable */
 
-	ADC0->SC1[4] = ADC_SC1_ADCH(Pot_Ch);	/* External channel as input (Pot) */
-	ADC0->SC1[5] = ADC_SC1_ADCH(Pot_Ch);	/* External channel as input (Pot) */
-	ADC0->SC1[6] = ADC_SC1_ADCH(4);		/* External channel 4 as input (voltage at PTB0) */
-	ADC0->SC1[7] = ADC_SC1_ADCH(4);		/* External channel 4 as input (voltage at PTB0) */
+	ADC0->SC1[2] = ADC_SC1_ADCH(Pot_Ch);	/* External channel as input (Pot) */
+	ADC0->SC1[3] = ADC_SC1_ADCH(Pot_Ch);	/* External channel as input (Pot) */
+	ADC0->SC1[4] = ADC_SC1_ADCH(4);		/* External channel 4 as input (voltage at PTB0) */
+	ADC0->SC1[5] = ADC_SC1_ADCH(4);		/* External channel 4 as input (voltage at PTB0) */
 	ADC0->SC3 = 0x00000000; 			/* Disable any configuration enabled of the calibration */
 }
 
@@ -33,6 +33,27 @@
 #ifndef ADC_H_
 #define ADC_H_
 
+#define ADC_MV_PER_LSB_Q16	(((5000u << 16) + (0xFFFu / 2u)) / 0xFFFu)	/* 0-5 V range, 12-bit: mV per LSB in Q16 */
+#define ADC_CAL_MAGIC		(0x43414C31u)								/* "CAL1": ADC_Cal_t holds a calibration */
+
+/* Results of one calibration (CAL) with the user corrections, in the layout kept in flash.
+ * Restoring it writes 9 registers instead of running the 14k ADCK calibration sequence. */
+typedef struct
+{
+	uint32_t magic;					/* ADC_CAL_MAGIC */
+	uint16_t clps;					/* CLPS, CLP3..CLP0, CLPX, CLP9 after CAL */
+	uint16_t clp3;
+	uint16_t clp2;
+	uint16_t clp1;
+	uint16_t clp0;
+	uint16_t clpx;
+	uint16_t clp9;
+	uint16_t ug;					/* UG user gain */
+	uint16_t usr_ofs;				/* USR_OFS user offset */
+	uint16_t vref_mV;				/* VREFH - VREFL the channel scales are computed for */
+	uint32_t check;					/* ~(sum of the words above) */
+}ADC_Cal_t;
+
 /* Public Function Prototypes*/
 
 void 	 ADC_channel_convert		(uint16_t adc_channel);
@@ -40,7 +61,10 @@ void 	 ADC_init					(void);
 void 	 ADC_HW_trigger_init		(int8_t adc_channel);
 uint8_t  ADC_conversion_complete	(void);
 uint32_t ADC_channel_read			(void);
+uint16_t ADC_channel_read_raw		(void);
 void 	 ADC_calibration_init		(int16_t gain, int16_t offset);
+void 	 ADC_calibration_save		(ADC_Cal_t *cal, uint16_t vref_mV);
+uint8_t  ADC_calibration_restore	(const ADC_Cal_t *cal);
 void	 ADC_Config					(uint8_t Pot_Ch);
 void 	 ADC_FlexScan_Config		(void);
 
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"           /* include peripheral declarations */
+#include "ADC_scale.h"
+
+/*!
+* @brief Precompute the conversion of a channel: reference of the calibration record,
+* resolution, input divider of the board and offset. The only divide happens here.
+*
+* @param[ADC_Scale_t *scale] Conversion to fill
+* @param[const ADC_Cal_t *cal] Calibration record (vref_mV)
+* @param[uint8_t bits] Resolution: 8, 10 or 12 (CFG1[MODE])
+* @param[uint16_t num] Input divider numerator, e.g. 3 for a 20k/10k divider; 1 without divider
+* @param[uint16_t den] Input divider denominator
+* @param[int16_t offset_mV] Added to every result, e.g. a measured zero error with the sign changed
+*
+* The full scale (vref_mV * num / den + offset_mV) must stay below 32768 mV (asserted): the
+* sample path computes raw * scale + offset in 32-bit signed Q16.
+*/
+void ADC_scale_init (ADC_Scale_t *scale, const ADC_Cal_t *cal, uint8_t bits, uint16_t num, uint16_t den, int16_t offset_mV)
+{
+	uint64_t full = (uint64_t)den * ((1u << bits) - 1u);		/* LSB count of vref_mV, times den */
+
+	DEV_ASSERT((den != 0u) && (((int64_t)cal -> vref_mV * num / den + offset_mV) < 32768));
+	scale -> scale  = (uint32_t)(((((uint64_t)cal -> vref_mV * num) << 16) + full / 2u) / full);
+	scale -> offset = (int32_t)offset_mV * 65536 + 0x8000;		/* Rounds the >> 16 to the nearest mV */
+}
+
+/*!
+* @brief Convert a buffer of results (e.g. filled by the DMA) to mV.
+*
+* Four samples per iteration from two word loads: the multiply-accumulates are independent
+* and the loop overhead is shared, which keeps the M4 pipeline busy on a 12-bit ADC stream.
+*
+* @param[const ADC_Scale_t *scale] Channel conversion
+* @param[const uint16_t *raw] Results, 4-byte aligned
+* @param[uint16_t *mV] Converted values, may be raw itself
+* @param[uint32_t count] Samples
+*/
+void ADC_scale_buffer (const ADC_Scale_t *scale, const uint16_t *raw, uint16_t *mV, uint32_t count)
+{
+	const uint32_t *pair = (const uint32_t *)raw;
+	uint32_t k = scale -> scale;
+	int32_t  c = scale -> offset;
+	int32_t  a, b, d, e;
+
+	for (; count >= 4u; count -= 4u, pair += 2, mV += 4)
+	{
+		uint32_t lo = pair[0];
+		uint32_t hi = pair[1];
+
+		a = (int32_t)((lo & 0xFFFFu) * k) + c;						/* Little-endian halves */
+		b = (int32_t)((lo >> 16) * k) + c;
+		d = (int32_t)((hi & 0xFFFFu) * k) + c;
+		e = (int32_t)((hi >> 16) * k) + c;
+		mV[0] = (uint16_t)(((a < 0) ? 0 : a) >> 16);
+		mV[1] = (uint16_t)(((b < 0) ? 0 : b) >> 16);
+		mV[2] = (uint16_t)(((d < 0) ? 0 : d) >> 16);
+		mV[3] = (uint16_t)(((e < 0) ? 0 : e) >> 16);
+	}
+	for (raw = (const uint16_t *)pair; count != 0u; count--)
+	{
+		*mV++ = (uint16_t)ADC_scale_sample(scale, *raw++);
+	}
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ADC_SCALE_H_
+#define ADC_SCALE_H_
+
+#include "device_registers.h"
+#include "ADC.h"
+
+/* Conversion of one channel, mV = (raw * scale + offset) >> 16. Computed once from the
+ * calibration record so the sample path is a multiply-accumulate and a shift, no divide. */
+typedef struct
+{
+	uint32_t scale;					/* mV per LSB, Q16 */
+	int32_t  offset;				/* mV, Q16, with the rounding half LSB */
+}ADC_Scale_t;
+
+/* Public Function Prototypes*/
+
+void 	 ADC_scale_init		(ADC_Scale_t *scale, const ADC_Cal_t *cal, uint8_t bits, uint16_t num, uint16_t den, int16_t offset_mV);
+void 	 ADC_scale_buffer	(const ADC_Scale_t *scale, const uint16_t *raw, uint16_t *mV, uint32_t count);
+
+/*!
+* @brief Convert one result to mV.
+*
+* @param[const ADC_Scale_t *scale] Channel conversion
+* @param[uint16_t raw] ADC result
+* @return[uint32_t] mV, 0 for results below a negative offset
+*/
+static inline uint32_t ADC_scale_sample (const ADC_Scale_t *scale, uint16_t raw)
+{
+	int32_t mV = (int32_t)(raw * scale -> scale) + scale -> offset;
+	return (mV < 0) ? 0u : ((uint32_t)mV >> 16);
+}
+
+#endif /* ADC_SCALE_H_ */
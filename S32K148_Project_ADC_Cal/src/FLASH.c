@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"	/* include peripheral declarations */
+#include "FLASH.h"
+
+/* The P-Flash cannot be read while one of its commands runs, so the launch and the wait for
+ * CCIF execute from RAM with the interrupts (vectors and handlers in flash) masked. */
+START_FUNCTION_DECLARATION_RAMSECTION
+static uint8_t FLASH_launch(void)
+END_FUNCTION_DECLARATION_RAMSECTION
+
+/*!
+* @brief Start the command loaded in FCCOB and wait for its end. Runs from RAM.
+*
+* @return FSTAT error flags, 0 on success
+*/
+START_FUNCTION_DEFINITION_RAMSECTION
+static uint8_t FLASH_launch(void)
+{
+	DISABLE_INTERRUPTS();
+	FTFC -> FSTAT = FTFC_FSTAT_CCIF_MASK;									/* Launch the command (w1c) */
+	while ((FTFC -> FSTAT & FTFC_FSTAT_CCIF_MASK) == 0u);					/* Wait for command completion */
+	ENABLE_INTERRUPTS();
+
+	return FTFC -> FSTAT & FLASH_ERRORS;
+}
+END_FUNCTION_DEFINITION_RAMSECTION
+
+/*!
+* @brief Load the command and its 24-bit flash address in FCCOB0-3.
+*/
+static void FLASH_command(uint8_t command, uint32_t address)
+{
+	while ((FTFC -> FSTAT & FTFC_FSTAT_CCIF_MASK) == 0u);					/* Previous command done */
+	FTFC -> FSTAT = FTFC_FSTAT_ACCERR_MASK | FTFC_FSTAT_FPVIOL_MASK;		/* Clear old errors (w1c) */
+
+	FTFC -> FCCOB[3] = command;												/* FCCOB0: command */
+	FTFC -> FCCOB[2] = (uint8_t)(address >> 16);							/* FCCOB1-3: flash address */
+	FTFC -> FCCOB[1] = (uint8_t)(address >> 8);
+	FTFC -> FCCOB[0] = (uint8_t)address;
+}
+
+/*!
+* @brief Erase one P-Flash sector. The interrupts are masked while the command runs
+* and enabled afterwards.
+*
+* @param[uint32_t address] Sector address, FLASH_SECTOR_SIZE aligned
+* @return FSTAT error flags, 0 on success
+*/
+uint8_t FLASH_erase_sector (uint32_t address)
+{
+	FLASH_command(FLASH_CMD_ERASE_SECTOR, address);
+	return FLASH_launch();
+}
+
+/*!
+* @brief Program erased P-Flash one phrase at a time. The last phrase is padded with 0xFF.
+*
+* @param[uint32_t address] Destination, FLASH_PHRASE_SIZE aligned
+* @param[const void *data] Source
+* @param[uint32_t size] Bytes
+* @return FSTAT error flags of the first failing phrase, 0 on success
+*/
+uint8_t FLASH_program (uint32_t address, const void *data, uint32_t size)
+{
+	const uint8_t *src = (const uint8_t *)data;
+	uint8_t status = 0;
+	uint8_t i;
+
+	for (; (size != 0u) && (status == 0u); address += FLASH_PHRASE_SIZE)
+	{
+		FLASH_command(FLASH_CMD_PROGRAM_PHRASE, address);
+		for (i = 0; i < FLASH_PHRASE_SIZE; i++)								/* FCCOB4-B: data in memory order */
+		{
+			FTFC -> FCCOB[4u + i] = (size != 0u) ? *src++ : 0xFFu;
+			size = (size != 0u) ? (size - 1u) : 0u;
+		}
+		status = FLASH_launch();
+	}
+	return status;
+}
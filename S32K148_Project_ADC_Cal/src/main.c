@@ -46,28 +46,51 @@
  *  	Press ENTER to send the Gain and Offset value.
  *
  * The UART is only used to display the ADC Result status in the terminal at 9600 baud: TeraTerm or other software.
+ * Messages are queued in a ring buffer sent by DMA (LPUART_DMA), so the core does not wait for each char.
  *
  * To perform a good calibration, the module must be calibrated ONCE along the project. If you calibrate the module more than once, 
  * the ADC readings will become imprecise.
  *
  * However, for this project and only to show the differences between ADC readings with different calibration parameters,
  * the calibration can be done several times because after each ADC reading the WDOG resets the MCU. 
+ *
+ * The results of each calibration (CLPx, UG, USR_OFS) are stored in the last P-Flash sector (ADC_CAL_ADDRESS).
+ * After the reset they are written back to the ADC (ADC_calibration_restore) instead of running the calibration
+ * again, and the pot is converted with a Q16 scale (ADC_scale) computed from the record: no divide per sample.
+ * Answering 'n' erases the record.
  * */
 
 #include "device_registers.h"           /* include peripheral declarations */
 #include "clocks_and_modes.h"
 #include "ADC.h"
+#include "ADC_scale.h"
+#include "FLASH.h"
 #include "LPUART.h"
+#include "LPUART_DMA.h"
 #include "WDOG.h"
 
 #define PTC6 (6)
 #define PTC7 (7)
 
+#define ADC_CAL_ADDRESS	(0x0017F000u)						/* Last P-Flash sector, outside m_text */
+#define ADC_CAL			((const ADC_Cal_t *)ADC_CAL_ADDRESS)
+#define VREF_MV			(5000u)								/* VREFH of the EVB */
+
 uint16_t answer = 0;
 uint16_t gain = 0;
 uint16_t offset = 0;
 uint32_t adc_mV_result = 0;
 uint8_t state = 0;
+uint8_t restored = 0;										/* ADC calibrated from the flash record */
+ADC_Cal_t adc_cal;
+ADC_Scale_t pot_scale;										/* AD44 pot: no divider, no offset */
+
+#define UART1_TX_SIZE	1024		/* Power of 2, holds the whole welcome message */
+#define UART1_RX_SIZE	16			/* Power of 2 */
+
+uint8_t UART1_tx[UART1_TX_SIZE];	/* Transmit ring of LPUART1 */
+uint8_t UART1_rx[UART1_RX_SIZE];	/* Receive ring of LPUART1 */
+LPUART_DMA_t UART1;
 
 /*!
 * @brief PORTn Initialization
@@ -90,6 +113,43 @@ void PORT_init (void)
 	PORTC -> PCR[PTC7] |= PORT_PCR_MUX(2);   					/* Port C7: MUX = UART1 TX */
 }
 
+/*!
+* @brief Wait for a char typed by the user.
+*
+* @return[char data] Received char
+*/
+char UART1_receive_char (void)
+{
+	int16_t data;
+
+	while ((data = LPUART_DMA_getc(&UART1)) < 0);	/* Wait for the RX DMA to store a char */
+	return (char)data;
+}
+
+/*!
+* @brief Stores received digits until ENTER key is pressed.
+*
+* @return[uint16_t data] 16-bit value typed by the user
+*/
+uint16_t UART1_receive_int (void)
+{
+	uint16_t data = 0;
+	char data_temp;
+
+	do
+	{
+		data_temp = UART1_receive_char();
+		if (data_temp != 13)							/* NOTE: 13 = CR (Carriage Return) in ASCII code */
+		{
+			data = (data * 10) + (data_temp - '0');		/* Add the digit */
+		}
+	}
+	while (data_temp != 13);							/* Do the data reading until CR (ENTER) is pressed */
+
+	LPUART_DMA_puts(&UART1, "\n\n");					/* Print two new lines */
+	return data;
+}
+
 void Enable_Interrupt(uint8_t vector_number)
 {
 	S32_NVIC->ISER[(uint32_t)(vector_number) >> 5U] = (uint32_t)(1U << ((uint32_t)(vector_number) & (uint32_t)0x1FU));
@@ -107,92 +167,127 @@ int main (void)
 
 	PORT_init();		    				/* Configure ports */
 	LPUART1_init();							/* LPUART1 initialization */
+	LPUART_DMA_init(&UART1, LPUART1, 0, 1, UART1_tx, UART1_TX_SIZE, UART1_rx, UART1_RX_SIZE);	/* TX on DMA CH0, RX on DMA CH1 */
 
 	/* Welcome message */
-	LPUART1_transmit_string("\r\n=============================================================================\r\n");
-	LPUART1_transmit_string("This code interactively shows how the internal calibration of the ADC module\r\n");
-	LPUART1_transmit_string("affects the reading of the result register (R). In addition to the internal\r\n");
-	LPUART1_transmit_string("calibration, there is the possibility of modifying two registers for the Gain\r\n");
-	LPUART1_transmit_string("(UG) and the Offset (USR_OFS) of the result by the user.\r\n\r\n");
+	LPUART_DMA_puts(&UART1, "\r\n=============================================================================\r\n");
+	LPUART_DMA_puts(&UART1, "This code interactively shows how the internal calibration of the ADC module\r\n");
+	LPUART_DMA_puts(&UART1, "affects the reading of the result register (R). In addition to the internal\r\n");
+	LPUART_DMA_puts(&UART1, "calibration, there is the possibility of modifying two registers for the Gain\r\n");
+	LPUART_DMA_puts(&UART1, "(UG) and the Offset (USR_OFS) of the result by the user.\r\n\r\n");
 
 	/* Instructions */
-	LPUART1_transmit_string("Instructions:\r\n");
-	LPUART1_transmit_string("	- Valid User Gain values are between 0 - 1023.\r\n");
-	LPUART1_transmit_string("	- Valid User Offset values are between 0 - 255.\r\n");
-	LPUART1_transmit_string("	- Offset and Gain values are in 2's-complement format.\r\n");
-	LPUART1_transmit_string("	- There are negative and positive values. MSB determines the sign.\r\n");
-	LPUART1_transmit_string("	- Press ENTER to send the Gain and Offset value. \r\n\r\n");
+	LPUART_DMA_puts(&UART1, "Instructions:\r\n");
+	LPUART_DMA_puts(&UART1, "	- Valid User Gain values are between 0 - 1023.\r\n");
+	LPUART_DMA_puts(&UART1, "	- Valid User Offset values are between 0 - 255.\r\n");
+	LPUART_DMA_puts(&UART1, "	- Offset and Gain values are in 2's-complement format.\r\n");
+	LPUART_DMA_puts(&UART1, "	- There are negative and positive values. MSB determines the sign.\r\n");
+	LPUART_DMA_puts(&UART1, "	- Press ENTER to send the Gain and Offset value. \r\n\r\n");
+
+	/* Calibration stored before the last reset */
+	restored = ADC_calibration_restore(ADC_CAL);
+	if (restored)
+	{
+		ADC_scale_init(&pot_scale, ADC_CAL, 12, 1, 1, 0);
+		ADC_channel_convert(44);                   				/* Convert Channel AD44 to pot on EVB */
+		while(ADC_conversion_complete() == 0){}         		/* Wait for conversion complete flag */
+		adc_mV_result = ADC_scale_sample(&pot_scale, ADC_channel_read_raw());	/* Multiply-shift to mV */
+
+		LPUART_DMA_puts(&UART1, "ADC result with the calibration restored from flash is: ");
+		LPUART_DMA_put_uint(&UART1, adc_mV_result);
+		LPUART_DMA_puts(&UART1, " mV with UG = ");
+		LPUART_DMA_put_uint(&UART1, ADC_CAL -> ug);
+		LPUART_DMA_puts(&UART1, " and USR_OFS = ");
+		LPUART_DMA_put_uint(&UART1, ADC_CAL -> usr_ofs);
+		LPUART_DMA_puts(&UART1, "\r\n\r\n");
+	}
 
 	/* Ask for initial calibration */
-	LPUART1_transmit_string("Would you like to calibrate the ADC module? y/n.\r\n\r\n");
-	LPUART1_transmit_string("> ");
+	LPUART_DMA_puts(&UART1, "Would you like to calibrate the ADC module? y/n.\r\n\r\n");
+	LPUART_DMA_puts(&UART1, "> ");
 
 	for(;;)
 	{
-		answer = LPUART1_receive_char();									/* Receive answer from the question above */
+		answer = UART1_receive_char();									/* Receive answer from the question above */
 
 		/* ADC module with calibration */
 		if(answer == 'y')
 		{
 			state = 1;
-			LPUART1_transmit_string("\r\n\r\n");
-			LPUART1_transmit_string("ADC module calibration. Which Gain value would you like to set? \r\n\r\n");
-			LPUART1_transmit_string("> ");
+			LPUART_DMA_puts(&UART1, "\r\n\r\n");
+			LPUART_DMA_puts(&UART1, "ADC module calibration. Which Gain value would you like to set? \r\n\r\n");
+			LPUART_DMA_puts(&UART1, "> ");
 
 			while (state == 1)
 			{
-				gain = LPUART1_receive_int();								/* Receive Gain Value */
+				gain = UART1_receive_int();								/* Receive Gain Value */
 
 				if ((gain >= 0) && (gain <= 1023))							/* Gain Value validation */
 				{
 					state = 2;
-					LPUART1_transmit_string("ADC module calibration. Which Offset value would you like to set?\r\n\r\n");
-					LPUART1_transmit_string("> ");
+					LPUART_DMA_puts(&UART1, "ADC module calibration. Which Offset value would you like to set?\r\n\r\n");
+					LPUART_DMA_puts(&UART1, "> ");
 
 					while (state == 2)
 					{
-						offset = LPUART1_receive_int();						/* Receive Offset Value */
+						offset = UART1_receive_int();						/* Receive Offset Value */
 
 						if ((offset >= 0) && (offset <= 255))				/* Offset Value validation */
 						{
 							state = 0;
 							ADC_calibration_init(gain, offset);				/* Convert Channel AD44 to pot on EVB */
+							ADC_calibration_save(&adc_cal, VREF_MV);		/* Keep the results for the next reset */
+							if ((FLASH_erase_sector(ADC_CAL_ADDRESS) != 0u) || (FLASH_program(ADC_CAL_ADDRESS, &adc_cal, sizeof(adc_cal)) != 0u))
+							{
+								LPUART_DMA_puts(&UART1, "Calibration could not be stored in flash.\r\n");
+							}
+							ADC_scale_init(&pot_scale, &adc_cal, 12, 1, 1, 0);
 							ADC_channel_convert(44);                   		/* Convert Channel AD44 to pot on EVB */
 							while(ADC_conversion_complete() == 0){}         /* Wait for conversion complete flag */
-							adc_mV_result = ADC_channel_read();       		/* Get channel's conversion results in mV */
+							adc_mV_result = ADC_scale_sample(&pot_scale, ADC_channel_read_raw());	/* Get channel's conversion results in mV */
 
 							/* Send ADC result by UART */
-							LPUART1_transmit_string("ADC result with calibration is: ");
-							LPUART1_int_to_char(adc_mV_result);				/* Convert data from int to char to be able to send by UART */
-							LPUART1_transmit_string(" mV with UG = ");
-							LPUART1_int_to_char(gain);						/* Convert data from int to char to be able to send by UART */
-							LPUART1_transmit_string(" and USR_OFS = ");
-							LPUART1_int_to_char(offset);					/* Convert data from int to char to be able to send by UART */
-							LPUART1_transmit_string("\r\n\r\n");
+							LPUART_DMA_puts(&UART1, "ADC result with calibration is: ");
+							LPUART_DMA_put_uint(&UART1, adc_mV_result);				/* Convert data from int to char to be able to send by UART */
+							LPUART_DMA_puts(&UART1, " mV with UG = ");
+							LPUART_DMA_put_uint(&UART1, gain);						/* Convert data from int to char to be able to send by UART */
+							LPUART_DMA_puts(&UART1, " and USR_OFS = ");
+							LPUART_DMA_put_uint(&UART1, offset);					/* Convert data from int to char to be able to send by UART */
+							LPUART_DMA_puts(&UART1, "\r\n\r\n");
 
+							while (!LPUART_DMA_tx_done(&UART1));			/* Let the message out before the reset */
 							WDOG_init(); 									/* Reboot MCU to erase the ADC calibration register */
 							Enable_Interrupt(WDOG_EWM_IRQn);				/* Enable WDOG interrupt vector */
 						}
 						else
 						{
 							/* Incorrect answer. Invalid Offset Value */
-							LPUART1_transmit_string("\r\n");
-							LPUART1_transmit_string("Incorrect Offset Value. Try again.\r\n\r\n");
-							LPUART1_transmit_string("> ");
+							LPUART_DMA_puts(&UART1, "\r\n");
+							LPUART_DMA_puts(&UART1, "Incorrect Offset Value. Try again.\r\n\r\n");
+							LPUART_DMA_puts(&UART1, "> ");
 						}
 					}
 				}
 				else
 				{
 					/* Incorrect answer. Invalid Gain Value */
-					LPUART1_transmit_string("\r\n");
-					LPUART1_transmit_string("Incorrect Gain Value. Try again.\r\n\r\n");
-					LPUART1_transmit_string("> ");
+					LPUART_DMA_puts(&UART1, "\r\n");
+					LPUART_DMA_puts(&UART1, "Incorrect Gain Value. Try again.\r\n\r\n");
+					LPUART_DMA_puts(&UART1, "> ");
 				}
 			}
 		}
 
 		/* ADC module without calibration */
+		else if((answer == 'n') && restored)
+		{
+			(void)FLASH_erase_sector(ADC_CAL_ADDRESS);			/* The ADC is calibrated until the reset */
+			LPUART_DMA_puts(&UART1, "\r\n\r\nStored calibration erased, the ADC is not calibrated after the reset.\r\n\r\n");
+
+			while (!LPUART_DMA_tx_done(&UART1));				/* Let the message out before the reset */
+			WDOG_init();										/* Reboot MCU to erase the ADC calibration register */
+			Enable_Interrupt(WDOG_EWM_IRQn);					/* Enable WDOG interrupt vector */
+		}
 		else if(answer == 'n')
 		{
 			ADC_init();											/* ADC initialization without calibration */
@@ -201,11 +296,12 @@ int main (void)
 			adc_mV_result = ADC_channel_read();       			/* Get channel's conversion results in mV */
 
 			/* Send ADC result by UART */
-			LPUART1_transmit_string("\r\n\r\n");
-			LPUART1_transmit_string("ADC result without calibration is: ");
-			LPUART1_int_to_char(adc_mV_result);					/* Convert data from int to char to be able to send by UART */
-			LPUART1_transmit_string(" mV\r\n\r\n");
+			LPUART_DMA_puts(&UART1, "\r\n\r\n");
+			LPUART_DMA_puts(&UART1, "ADC result without calibration is: ");
+			LPUART_DMA_put_uint(&UART1, adc_mV_result);					/* Convert data from int to char to be able to send by UART */
+			LPUART_DMA_puts(&UART1, " mV\r\n\r\n");
 
+			while (!LPUART_DMA_tx_done(&UART1));				/* Let the message out before the reset */
 			WDOG_init();										/* Reboot MCU to erase the ADC calibration register */
 			Enable_Interrupt(WDOG_EWM_IRQn);	/* Enable WDOG interrupt vector */
 		}
@@ -213,9 +309,9 @@ int main (void)
 		/* Incorrect answer. Input different of y/n */
 		else
 		{
-			LPUART1_transmit_string("\r\n\r\n");
-			LPUART1_transmit_string("Incorrect input. Try again.\r\n\r\n");
-			LPUART1_transmit_string("> ");
+			LPUART_DMA_puts(&UART1, "\r\n\r\n");
+			LPUART_DMA_puts(&UART1, "Incorrect input. Try again.\r\n\r\n");
+			LPUART_DMA_puts(&UART1, "> ");
 		}
 
 	}
@@ -231,3 +327,18 @@ void WDOG_EWM_IRQHandler (void)
     	WDOG -> CS |= WDOG_CS_FLG_MASK;      							/* Clear the flag */
     }
 }
+
+void DMA0_IRQHandler (void)
+{
+	LPUART_DMA_TxIRQHandler(&UART1);								/* Block sent, start the next one */
+}
+
+void DMA1_IRQHandler (void)
+{
+	LPUART_DMA_RxIRQHandler(&UART1);								/* Receive ring wrapped */
+}
+
+void LPUART1_RxTx_IRQHandler (void)
+{
+	LPUART_DMA_IRQHandler(&UART1);									/* Idle line / overrun */
+}
@@ -33,6 +33,23 @@
 #include "device_registers.h"	/* include peripheral declarations S32K144 */
 #include "FlexCAN_FD.h"
 #include <stdio.h>
+#include "LPUART.h"
+#include "FlexCAN_Timing.h"
+#include "FlexCAN_Layout.h"
+
+#define CAN_CLK_HZ		(40000000)	/* CLKSRC=1: BUSCLK */
+#define CAN_DELAY_NS	(250)		/* Transceiver loop delay and bus line, one way */
+
+/* Nominal phase 500 Kbit/s, data phase 2 Mbit/s, both sampled at 80% */
+FLEXCAN_TIMING(CAN_NOMINAL, CBT,   CAN_CLK_HZ, 500000,  800, CAN_DELAY_NS);
+FLEXCAN_TIMING(CAN_DATA,    FDCBT, CAN_CLK_HZ, 2000000, 800, CAN_DELAY_NS);
+FLEXCAN_TIMING_ASSERT(CAN_NOMINAL);
+FLEXCAN_TIMING_ASSERT(CAN_DATA);
+FLEXCAN_LAYOUT_ASSERT(CAN0_FD);
+
+/* Padding example: 32-byte MBs, MB0..MB4 scanned */
+FLEXCAN_LAYOUT(CAN0_PADDED, 32, 0, 5, 0);
+FLEXCAN_LAYOUT_ASSERT(CAN0_PADDED);
 
 uint32_t  RxCODE;              /* Received message buffer code */
 uint32_t  RxID;                /* Received message ID */
@@ -43,7 +60,7 @@ uint32_t  RxDATA8 [8];         /* Received message data (8 words) */
 uint32_t  RxDATA32[8];         /* Received message data (8 words) */
 
 void FLEXCAN0_init(void) {
-#define MSG_BUF_SIZE  18    /* Msg Buffer Size. (2 words hdr + 16 words data  = 18 words) */
+#define MSG_BUF_SIZE  CAN0_FD_MB_WORDS    /* Msg Buffer Size. (2 words hdr + 16 words data  = 18 words) */
 	uint32_t   i=0;
 
 	PCC->PCCn[PCC_FlexCAN0_INDEX] |= PCC_PCCn_CGC_MASK; /* CGC=1: enable clock to FlexCAN0 */
@@ -54,35 +71,20 @@ void FLEXCAN0_init(void) {
 
 	/* Good practice: wait for FRZACK=1 on freeze mode entry/exit */
 
-	CAN0->CBT =		CAN_CBT_EPSEG2(15)		/* Configure nominal phase: 500 KHz bit time, 40 MHz Sclock */
-							|CAN_CBT_EPSEG1(15)		/* Prescaler = CANCLK / Sclock = 40 MHz / 40 MHz = 1 */
-							|CAN_CBT_EPROPSEG(47)	/* EPRESDIV = Prescaler - 1 = 0 */
-							|CAN_CBT_ERJW(15);   	/* EPSEG2 = 15 */
-													/* EPSEG1 = 15 */
-													/* EPROPSEG = 47 */
-													/* ERJW = 15 */
-													/* BITRATEn =Fcanclk /( [(1 + (EPSEG1+1) + (EPSEG2+1) + (EPROPSEG + 1)] x (EPRESDIV+1)) */
-													/*         = 40 MHz /( [(1 + ( 15   +1) + ( 15   +1) + (   46    + 1)] x (    0   +1)) */
-													/*          = 40 MHz /( [1+16+16+47] x 1) = 40 MHz /(80x1) = 500 Kz */
-
-    /* Configure data phase: 2 MHz bit time, 40 MHz Sclock */
-	CAN0->FDCBT = 	CAN_CBT_EPSEG2(3)/* Prescaler = CANCLK / Sclock = 40 MHz / 40 MHz = 1 */
-							|CAN_CBT_EPSEG1(7)/* FPRESDIV = Prescaler - 1 = 0 */
-							|CAN_CBT_EPROPSEG(7)/* FPSEG2 = 3 */
-							|CAN_CBT_ERJW(3);/* FPSEG1 = 7 */
-	/* FPROPSEG = 7 */
-	/* FRJW = 3 */
-	/* BITRATEf =Fcanclk /( [(1 + (FPSEG1+1) + (FPSEG2+1) + (FPROPSEG)] x (FPRESDIV+!)) */
-	/*          = 40 MHz /( [(1 + (  7   +1) + (  3   +1) + (   7    )] x (    0   +1)) */
-	/*          = 40 MHz /( [1+8+4+7] x 1) = 40 MHz /(20x1) = 40 MHz / 20 = 2 MHz  */
+	CAN0->CBT = FLEXCAN_CBT_TIMING(CAN_NOMINAL);	/* Configure nominal phase: 500 KHz bit time, 40 MHz Sclock */
+													/* BTF=1: CBT replaces the CTRL1 timing fields */
+													/* BITRATEn = Fcanclk / ([1 + (EPROPSEG+1) + (EPSEG1+1) + (EPSEG2+1)] x (EPRESDIV+1)) */
+													/*          = 40 MHz / ([1 + 47 + 16 + 16] x 1) = 40 MHz / 80 = 500 KHz */
 
+	CAN0->FDCBT = FLEXCAN_FDCBT_TIMING(CAN_DATA);	/* Configure data phase: 2 MHz bit time, 40 MHz Sclock */
+													/* BITRATEf = Fcanclk / ([1 + FPROPSEG + (FPSEG1+1) + (FPSEG2+1)] x (FPRESDIV+1)) */
+													/*          = 40 MHz / ([1 + 11 + 4 + 4] x 1) = 40 MHz / 20 = 2 MHz */
 
 	CAN0->FDCTRL =	CAN_FDCTRL_FDRATE_MASK	/* Configure bit rate switch, data size, transcv'r delay  */
-			|CAN_FDCTRL_MBDSR0(3)	/* BRS=1: enable Bit Rate Swtich in frame's header */
-			|CAN_FDCTRL_TDCEN_MASK	/* MBDSR1: Not applicable */
-			|CAN_FDCTRL_TDCOFF(5);   /* MBDSR0=3: Region 0 has 64 bytes data in frame's payload */
+			|FLEXCAN_FDCTRL_LAYOUT(CAN0_FD)	/* BRS=1: enable Bit Rate Swtich in frame's header */
+			|FLEXCAN_FDCTRL_TDC(CAN_DATA);	/* MBDSR0=3: Region 0 has 64 bytes data in frame's payload */
 	/* TDCEN=1: enable Transceiver Delay Compensation */
-	/* TDCOFF=5: 5 CAN clocks (300us) offset used */
+	/* TDCOFF: secondary sample point at the data phase sample point, 16 CAN clocks */
 
 	for(i=0; i<128; i++ ) {    /* CAN0: clear 128 words RAM in FlexCAN 0 */
 		CAN0->RAMn[i] = 0;       /* Clear msg buf words. All buffers CODE=0 (inactive) */
@@ -107,7 +109,7 @@ void FLEXCAN0_init(void) {
 #endif
 	/* PRIO = 0: CANFD not used */
 	CAN0->CTRL2 |= CAN_CTRL2_ISOCANFDEN_MASK;       /* Enable CRC fix for ISO CAN FD */
-	CAN0->MCR = 0x0000081F;       /* Negate FlexCAN 1 halt state & enable CAN FD for 32 MBs */
+	CAN0->MCR = CAN_MCR_FDEN_MASK | FLEXCAN_MCR_LAYOUT(CAN0_FD);	/* Negate FlexCAN 1 halt state & enable CAN FD, MB0..MB4 */
 	while ((CAN0->MCR && CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT)  {}
 	/* Good practice: wait for FRZACK to clear (not in freeze mode) */
 	while ((CAN0->MCR && CAN_MCR_NOTRDY_MASK) >> CAN_MCR_NOTRDY_SHIFT)  {}
@@ -166,7 +168,8 @@ void FLEXCAN0_receive_msg(void) {
 */
 void FLEXCAN0_padding_init (void)
 {
-	#define MSG_BUF_SIZE (10) 								/* Message Buffer Size. (2 words hdr + 8 words data = 10 words) */
+	#undef MSG_BUF_SIZE
+	#define MSG_BUF_SIZE CAN0_PADDED_MB_WORDS 				/* Message Buffer Size. (2 words hdr + 8 words data = 10 words) */
 	uint32_t i = 0;											/* Counter */
 
 	PCC -> PCCn[PCC_FlexCAN0_INDEX] |= PCC_PCCn_CGC_MASK; 	/* CGC = 1 Enable clock to FLEXCAN0 */
@@ -177,16 +180,17 @@ void FLEXCAN0_padding_init (void)
 	/* Good practice: Wait for FRZACK = 1 on freeze mode entry/exit */
 	while (!((CAN0 -> MCR & CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT)){}
 
-	CAN0 -> CBT = 0x802FB9EF;  			 					/* Configure nominal phase: 500 KHz bit time, 40 MHz Sclock */
+	CAN0 -> CBT = FLEXCAN_CBT_TIMING(CAN_NOMINAL);			/* Configure nominal phase: 500 KHz bit time, 40 MHz Sclock */
 
 	/* BITRATEn = fCANCLK / ([(1 + (EPSEG1 + 1) + (EPSEG2 + 1) + (EPROPSEG + 1)] * (EPRESDIV + 1)) */
 	/*          = 40 MHz /  ([(1 + (15 + 1) + (15 + 1) + (46 + 1)] * (0 +1)) */
 	/*          = 40 MHz /  ([1 + 16 + 16 + 47] * 1) = 40 MHz / (80 * 1) = 500 KHz */
 
-	CAN0 -> FDCBT = 0x00131CE3; 							/* Configure data phase: 2 MHz bit time, 40 MHz Sclock */
+	CAN0 -> FDCBT = FLEXCAN_FDCBT_TIMING(CAN_DATA); 		/* Configure data phase: 2 MHz bit time, 40 MHz Sclock */
 
-	CAN0 -> FDCTRL = 0x80008500
-			       | 2 << CAN_FDCTRL_MBDSR0_SHIFT; 			/* Selects 32 bytes per message buffer */
+	CAN0 -> FDCTRL = CAN_FDCTRL_FDRATE_MASK					/* Bit rate switch */
+				   | FLEXCAN_FDCTRL_TDC(CAN_DATA)			/* Transceiver delay compensation at the data sample point */
+			       | FLEXCAN_FDCTRL_LAYOUT(CAN0_PADDED); 	/* Selects 32 bytes per message buffer */
 
 
 	for (i = 0; i < 128; i++)								/* Clear message buffer words. All buffers CODE = 0 (Inactive) */
@@ -214,7 +218,7 @@ void FLEXCAN0_padding_init (void)
 	#endif
 
 	CAN0 -> CTRL2 |= CAN_CTRL2_ISOCANFDEN_MASK;       		/* Enable CRC fix for ISO CAN FD */
-	CAN0 -> MCR = 0x0000081F;      		 					/* Negate FlexCAN 1 halt state & enable CAN FD for 32 MBs */
+	CAN0 -> MCR = CAN_MCR_FDEN_MASK | FLEXCAN_MCR_LAYOUT(CAN0_PADDED);	/* Negate FlexCAN 1 halt state & enable CAN FD, MB0..MB4 */
 
 	/* Good practice: Wait for FRZACK to clear (not in freeze mode) */
 	while ((CAN0 -> MCR && CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT){}
@@ -263,7 +267,7 @@ void FLEXCAN0_receive_8 (void)
 	snprintf(buffer, 200, "MB0: %10X %10X %10X %10X %10X %10X %10X %10X\n\r",
     RxDATA8[0], RxDATA8[1], RxDATA8[2], RxDATA8[3], RxDATA8[4], RxDATA8[5], RxDATA8[6], RxDATA8[7]);
 
-	print(buffer);
+	LPUART1_transmit_string(buffer);
 }
 
 /*!
@@ -306,7 +310,7 @@ void FLEXCAN0_receive_32 (void)
 	snprintf(buffer, 200, "MB4: %10X %10X %10X %10X %10X %10X %10X %10X\n\r",
     RxDATA32[0], RxDATA32[1], RxDATA32[2], RxDATA32[3], RxDATA32[4], RxDATA32[5], RxDATA32[6], RxDATA32[7]);
 
-	print(buffer);
+	LPUART1_transmit_string(buffer);
 }
 
 
@@ -325,25 +329,15 @@ void FLEXCAN_FD_Config(void){
 	while (!((CAN0->MCR & CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT));	/* Wait for Freeze Mode */
 
 
-	CAN0->CBT = CAN_CBT_BTF_MASK|		/* Enable extended CAN */
-				CAN_CBT_EPRESDIV(1)|	/* Sclock frequency = Fcanclk / (EPRESDIV + 1) */
-				CAN_CBT_ERJW(15)|		/* Resync Jump Width = ERJW + 1 */
-				CAN_CBT_EPROPSEG(46)|	/* Propagation Segment Time = (EPROPSEG + 1) × Time-Quanta */
-				CAN_CBT_EPSEG1(15)|		/* Phase Buffer Segment 1 = (EPSEG1 + 1) × Time-Quanta */
-				CAN_CBT_EPSEG2(15);		/* Phase Buffer Segment 1 = (EPSEG2 + 1) × Time-Quanta */
+	CAN0->CBT = FLEXCAN_CBT_TIMING(CAN_NOMINAL);	/* Extended CAN timing, nominal phase 500 Kbit/s */
 	/* BITRATEn =Fcanclk /( [(1 + (EPSEG1+1) + (EPSEG2+1) + (EPROPSEG + 1)] x (EPRESDIV+1)) */
 
-	CAN0->FDCBT = CAN_FDCBT_FPRESDIV(1)|	/* Sclock frequency = PE clock frequency / (FPRESDIV + 1) */
-				  CAN_FDCBT_FRJW(3)|		/* Resync Jump Width = FSJW + 1 */
-				  CAN_FDCBT_FPROPSEG(7)|	/* Time-Quantum = one Sclock period */
-				  CAN_FDCBT_FPSEG1(7)|		/* Phase Segment 1 = (FPSEG1 + 1) × Time-Quanta */
-				  CAN_FDCBT_FPSEG2(3);		/* Phase Segment 2 = (FPSEG2 + 1) × Time-Quanta */
+	CAN0->FDCBT = FLEXCAN_FDCBT_TIMING(CAN_DATA);	/* Data phase 2 Mbit/s */
 	/* BITRATEf =Fcanclk /( [(1 + (FPSEG1+1) + (FPSEG2+1) + (FPROPSEG)] x (FPRESDIV+1)) */
 
 	CAN0->FDCTRL = CAN_FDCTRL_FDRATE_MASK|	/* Rate Switch Enable */
-				   CAN_FDCTRL_MBDSR0(0b11)|	/* Message buffer size of 64 bytes */
-				   CAN_FDCTRL_TDCEN_MASK|	/* Transceiver Delay Compensation is Enable */
-				   CAN_FDCTRL_TDCOFF(5);	/* 300us offset use */
+				   FLEXCAN_FDCTRL_LAYOUT(CAN0_FD)|	/* Message buffer size of 64 bytes */
+				   FLEXCAN_FDCTRL_TDC(CAN_DATA);	/* Transceiver Delay Compensation at the data sample point */
 
 	for(count = 0; count < 128; count++){
 		CAN0->RAMn[count] = 0;				/* Clear all the buffer */
@@ -367,7 +361,7 @@ void FLEXCAN_FD_Config(void){
 
 	CAN0->CTRL2 |= CAN_CTRL2_ISOCANFDEN_MASK;	/* ISO CAN FD Enable */
 	CAN0->MCR = CAN_MCR_FDEN_MASK|				/* CAN FD is Enable */
-				CAN_MCR_MAXMB(0b11111);			/* Number Of The Last Message Buffer */
+				FLEXCAN_MCR_LAYOUT(CAN0_FD);		/* Number Of The Last Message Buffer */
 
 	CAN0->IMASK1 = 0x10;							/* Enable Interruption */
 	S32_NVIC->ICPR[2] = 1<<(CAN0_ORed_0_15_MB_IRQn  % 32);	/* Clear any pending IR for CAN*/
@@ -38,6 +38,8 @@
 /* UNCOMMENT THE NEXT LINE ON THE 2ND BOARD	AND COMMENT IT ON THE 1ST BOARD	*/
 //#define Node_2		/* Node 2 operates the ADC and wait for the request of Node 1 to transmit the values */
 
+#include "FlexCAN_Layout.h"
+
 #define NODE_A        /* If using 2 boards as 2 nodes, NODE A transmits first to NODE_B */
 #define SBC_MC33903   /* SBC requires SPI init + max 1MHz bit rate */
 
@@ -47,7 +49,9 @@ uint32_t RexLength;	/* Number of data bytes */
 uint32_t RexData[2];	/* Array where data is storage */
 uint32_t RexTime;	/* Message time */
 uint8_t count; 		/* Counter for loops */
-#define MsgBuffSize 18 /* Msg Buffer Size. (2 words hdr + 16 words data  = 18 words) */
+/* CAN-FD: 64-byte MBs, MB0..MB4 scanned (MB0 transmits, MB4 receives) */
+FLEXCAN_LAYOUT(CAN0_FD, 64, 0, 5, 0);
+#define MsgBuffSize CAN0_FD_MB_WORDS /* Msg Buffer Size. (2 words hdr + 16 words data  = 18 words) */
 
 void FLEXCAN0_init 			(void);
 void FLEXCAN0_transmit_msg 	(void);
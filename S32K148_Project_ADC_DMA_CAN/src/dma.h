@@ -33,44 +33,120 @@
 #ifndef DMA_H_
 #define DMA_H_
 
-/* Structure with the TCD fields. */
-typedef struct
+#include <stddef.h>
+
+/* Structure with the TCD fields, also viewed as the 8 words of the hardware TCD. */
+typedef union
 {
-	uint32_t SADDR;
-	uint16_t SOFF;
-	uint16_t ATTR;
-	union
-	{
-		uint32_t NBYTES_MLNO;
-		uint32_t NBYTES_MLOFFNO;
-		uint32_t NBYTES_MLOFFYES;
-	};
-	uint32_t SLAST;
-	uint32_t DADDR;
-	uint16_t DOFF;
-	union
-	{
-		uint16_t CITER_ELINKNO;
-		uint16_t CITER_ELINKYES;
-	};
-	uint32_t DLASTSGA;
-	uint16_t CSR;
-	union
+	struct
 	{
-		uint16_t BITER_ELINKNO;
-		uint16_t BITER_ELINKYES;
+		uint32_t SADDR;
+		uint16_t SOFF;
+		uint16_t ATTR;
+		union
+		{
+			uint32_t NBYTES_MLNO;
+			uint32_t NBYTES_MLOFFNO;
+			uint32_t NBYTES_MLOFFYES;
+		};
+		uint32_t SLAST;
+		uint32_t DADDR;
+		uint16_t DOFF;
+		union
+		{
+			uint16_t CITER_ELINKNO;
+			uint16_t CITER_ELINKYES;
+		};
+		uint32_t DLASTSGA;
+		uint16_t CSR;
+		union
+		{
+			uint16_t BITER_ELINKNO;
+			uint16_t BITER_ELINKYES;
+		};
 	};
+	uint32_t WORD[8];
 }TCD_t;
 
+/* TCD_t is the memory image of DMA->TCD[n]: DMA_TCD_Push and scatter/gather copy it as 8 words */
+_Static_assert(sizeof(TCD_t) == 32u, "TCD_t must match the 32-byte hardware TCD");
+_Static_assert(__builtin_offsetof(TCD_t, NBYTES_MLNO) == 0x08u, "TCD_t NBYTES offset");
+_Static_assert(__builtin_offsetof(TCD_t, DLASTSGA) == 0x18u, "TCD_t DLASTSGA offset");
+_Static_assert(__builtin_offsetof(TCD_t, BITER_ELINKNO) == 0x1Eu, "TCD_t BITER offset");
+
+/* Transfer sizes, ATTR[SSIZE]/ATTR[DSIZE] encoding */
+typedef enum
+{
+	DMA_SIZE_1BYTE   = 0u,
+	DMA_SIZE_2BYTES  = 1u,
+	DMA_SIZE_4BYTES  = 2u,
+	DMA_SIZE_16BYTES = 4u,		/* 16-byte burst */
+	DMA_SIZE_32BYTES = 5u		/* 32-byte burst */
+}DMA_Size_t;
+
+#define DMA_SIZE_BYTES(size)	(1u << (uint32_t)(size))	/* DMA_Size_t -> bytes per transfer */
+
+/* Address walk of one side of a strided transfer (DMA_TCD_Strided), in bytes. Element e of
+ * minor loop m of major loop n is at base + e * element + m * minor + n * major. */
+typedef struct
+{
+	int32_t element;	/* Between the elements of a minor loop (SOFF/DOFF, 16 bits) */
+	int32_t minor;		/* Between the first elements of consecutive minor loops */
+	int32_t major;		/* Between the first elements of consecutive major loops, 0: restart */
+}DMA_Stride_t;
+
+/* Continuous acquisition into a buffer split in two halves: the DMA fills one half while the
+ * application reads the other. ready[] and overruns are written by DMA_PingPong_IRQHandler. */
+typedef struct
+{
+	volatile uint32_t * buffer;		/* 2 * samples words, half 0 first */
+	uint32_t samples;				/* Words per half */
+	uint8_t ch;						/* DMA channel filling the buffer */
+	uint8_t fill;					/* Half the DMA is expected to complete next */
+	uint8_t read;					/* Half the application reads next */
+	volatile uint8_t ready[2];		/* 1: half filled and not released yet */
+	volatile uint32_t halves;		/* Halves completed */
+	volatile uint32_t overruns;		/* Halves overwritten before release or missed interrupts */
+}DMA_PingPong_t;
+
+#define FLEXSCAN_CHANNELS		3u	/* Entries of ADC_SC1A_CH */
+#define FLEXSCAN_SCANS_PER_HALF	2u	/* Scans of all channels per ping-pong half */
+
+extern uint32_t volatile ADC_Results[2u * FLEXSCAN_SCANS_PER_HALF * FLEXSCAN_CHANNELS];
+
 void DMA_init (void);
 void DMA_TCD_init (void);
 void DMA_SG_init(void);
 void DMA_TCDm_config(uint32_t * buff_source, uint8_t SOFF, uint32_t * buff_dest, uint8_t DOFF, uint32_t size, TCD_t * TCDm);
-void DMA_TCD_Push(uint8_t ch, TCD_t * TCDm );
-void DMA_Config(uint32_t Destination[4]);
+void DMA_TCD_Push(uint8_t ch, const TCD_t * TCDm );
+void DMA_Config(DMA_PingPong_t * stream, uint32_t * buffer, uint32_t samples);
 void DMAMUX_LC_init(void);
 void DMA_TCD_LC_Config(void);
 void DMAMUX_FlexScan_init(void);
-void DMA_TCD_FlexScan_Config(void);
+void DMA_TCD_FlexScan_Config(DMA_PingPong_t * stream);
+
+/* TCD builder */
+void DMA_TCD_Transfer(TCD_t * TCDm, const volatile void * source, int16_t SOFF, DMA_Size_t ssize,
+					  volatile void * dest, int16_t DOFF, DMA_Size_t dsize, uint32_t nbytes, uint16_t iterations);
+void DMA_TCD_Copy(TCD_t * TCDm, volatile void * dest, const volatile void * source, uint32_t length);
+void DMA_TCD_Last(TCD_t * TCDm, int32_t SLAST, int32_t DLAST);
+void DMA_TCD_MinorOffset(TCD_t * TCDm, int32_t MLOFF, uint8_t source, uint8_t dest);
+void DMA_TCD_MinorLink(TCD_t * TCDm, uint8_t ch);
+void DMA_TCD_MajorLink(TCD_t * TCDm, uint8_t ch);
+void DMA_TCD_ScatterGather(TCD_t * TCDm, const TCD_t * next);
+void DMA_TCD_Interrupts(TCD_t * TCDm, uint8_t half, uint8_t major);
+void DMA_TCD_KeepEnabled(TCD_t * TCDm);
+void DMA_TCD_Modulo(TCD_t * TCDm, uint8_t smod, uint8_t dmod);
+uint8_t DMA_TCD_Strided(TCD_t * TCDm, const volatile void * source, const DMA_Stride_t * sstride,
+						volatile void * dest, const DMA_Stride_t * dstride, DMA_Size_t size,
+						uint16_t elements, uint16_t minors);
+uint32_t DMA_TCD_Validate(const TCD_t * TCDm);
+
+/* Ping-pong buffering */
+void DMA_TCD_PingPong(TCD_t * TCDm);
+void DMA_PingPong_init(DMA_PingPong_t * stream, uint8_t ch, volatile uint32_t * buffer, uint32_t samples);
+void DMA_PingPong_IRQHandler(DMA_PingPong_t * stream);
+volatile uint32_t * DMA_PingPong_Get(DMA_PingPong_t * stream);
+void DMA_PingPong_Release(DMA_PingPong_t * stream);
 
 #endif /* DMA_H_ */
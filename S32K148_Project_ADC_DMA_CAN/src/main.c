@@ -36,6 +36,7 @@
 #include "ADC.h"
 #include "pdb.h"
 #include "FlexCAN_FD.h"
+#include "profile.h"
 
 /*!
  * Description:
@@ -59,7 +60,20 @@
 
 uint32_t ValuePOT;			/* Variable to save the Value of the POT received by Node_1 from Node_2 */
 uint32_t ValuePin;			/* Variable to save the Value of the PIN received by Node_1 from Node_2	*/
-uint32_t ADC_nodo2[4];		/* TCD Destination Array of the DMA to deposit the ADC0 measurements in Node_2 */
+uint32_t ADC_nodo2[4];		/* Last scan of the 4 ADC0 channels measured in Node_2 */
+
+#define ADC_SCANS_PER_HALF	8	/* Scans of the 4 ADC0 channels per ping-pong half */
+
+uint32_t ADC_Stream[2][ADC_SCANS_PER_HALF * 4];	/* TCD Destination of the DMA, filled one half at a time */
+DMA_PingPong_t ADC_Stream_State;				/* Halves ready, overrun counter */
+
+enum
+{
+	PROFILE_CAN0_MB_ISR,	/* CAN0_ORed_0_15_MB_IRQHandler cost */
+	PROFILE_CAN_REQUEST		/* Node_1: request queued in PORTC_IRQHandler -> answer received */
+};
+
+const char * const PROFILE_names[] = { "CAN0_ORed_0_15_MB_IRQHandler", "CAN request round trip" };
 
 void WDOG_disable (void)
 {
@@ -95,11 +109,14 @@ int main(void) {
 	SOSC_init_8MHz();      /* Initialize system oscillator for 8 MHz xtal */
 	SPLL_init_160MHz();    /* Initialize SPLL to 160 MHz with 8 MHz SOSC */
 	NormalRUNmode_80MHz(); /* Init clocks: 80 MHz sysclk & core, 40 MHz bus, 20 MHz flash */
+	PROFILE_init(PROFILE_names, 2);	/* Start the DWT cycle counter */
     GPIO_Config();		  	/* Configure PINs to work for CANFD and set up the interruption if Node_1 is defined */
     FLEXCAN_FD_Config();	/* Initialize FLEXCAN FD if Node_1 is defined ID = 0x5111 else if Node_2 is define ID = 0x555 */
 
 	#ifdef Node_2
-		DMA_Config(ADC_nodo2);	/* Set up DMAMUX CH3 with ADC0 COCO requests and set up the TCD Source and Destination */
+		DMA_Config(&ADC_Stream_State, ADC_Stream[0], ADC_SCANS_PER_HALF * 4);	/* DMA CH3: ADC0 COCO requests -> ADC_Stream */
+		S32_NVIC->ICPR[DMA3_IRQn>>5] = 1<<(DMA3_IRQn &0x1F);	/* Clear any pending IR for DMA CH3 */
+		S32_NVIC->ISER[DMA3_IRQn>>5] = 1<<(DMA3_IRQn &0x1F);	/* Enable IRQ for DMA CH3 (ping-pong halves) */
 		ADC_calibration_init(0,0);		/* Starts ADC calibration	*/
 		ADC_Config(44);			/* Set up the ADC0 Channels to be used by HW Trigger of the PDB */
 		PDB_Config();			/* Set up the PDB to trigger ADC */
@@ -107,6 +124,17 @@ int main(void) {
 
 
 	for (;;) {
+		#ifdef Node_2
+			volatile uint32_t * half = DMA_PingPong_Get(&ADC_Stream_State);
+
+			if (half != NULL) {
+				uint8_t ch;
+				for (ch = 0; ch < 4; ch++) {
+					ADC_nodo2[ch] = half[(ADC_SCANS_PER_HALF - 1) * 4 + ch];	/* Keep the last scan for the CAN answers */
+				}
+				DMA_PingPong_Release(&ADC_Stream_State);	/* Half can be filled again */
+			}
+		#endif
     }
     return 0;
 }
@@ -116,6 +144,15 @@ int main(void) {
  * ===========================================================================================
  */
 
+#ifdef Node_2
+/******************************************************************************
+ * DMA CH3 has filled one half of ADC_Stream, main() takes it from here.
+ *****************************************************************************/
+void DMA3_IRQHandler(void){
+	DMA_PingPong_IRQHandler(&ADC_Stream_State);
+}
+#endif
+
 #ifdef Node_1
 /******************************************************************************
  * When one of the switch is pressed down an interrupt is enabled and a CAN
@@ -126,6 +163,7 @@ int main(void) {
 void PORTC_IRQHandler(void){
 	if(Condition1_Pin12 && Condition2_Pin12){	/* POT Measure */
 		PORTC->PCR[12] |= PORT_PCR_ISF_MASK;	/* Turn off flag of interruption */
+		PROFILE_begin(PROFILE_CAN_REQUEST);
 		CAN0->IFLAG1 = CAN_IFLAG1_BUF0I_MASK;	/* Clear MB0 Flag */
 
 		CAN0->RAMn[ 0*MsgBuffSize +2] = 0xA;			/* Message word 1 */
@@ -141,6 +179,7 @@ void PORTC_IRQHandler(void){
 
 	if(Condition1_Pin13 && Condition2_Pin13){	/* Pin Measure */
 		PORTC->PCR[13] |= PORT_PCR_ISF_MASK;	/* Turn off flag of interruption */
+		PROFILE_begin(PROFILE_CAN_REQUEST);
 		CAN0->IFLAG1 = CAN_IFLAG1_BUF0I_MASK;	/* Clear MB0 Flag */
 
 		CAN0->RAMn[ 0*MsgBuffSize +2] = 0xB;			/* Message word 1 */
@@ -164,6 +203,7 @@ void PORTC_IRQHandler(void){
  * ADC.
  *****************************************************************************/
 void CAN0_ORed_0_15_MB_IRQHandler(void){
+	PROFILE_ISR_ENTER(PROFILE_CAN0_MB_ISR);
 	RexCode = (CAN0->RAMn[ 4*MsgBuffSize + 0] & 0x0F000000) >> 24;								/* Code field */
 	RexID = (CAN0->RAMn[ 4*MsgBuffSize + 1] & CAN_WMBn_ID_ID_MASK) >> CAN_WMBn_ID_ID_SHIFT;		/* Message ID */
 	RexLength = (CAN0->RAMn[ 4*MsgBuffSize + 0] & CAN_WMBn_CS_DLC_MASK) >> CAN_WMBn_CS_DLC_SHIFT;	/* Message length (32 bits) */
@@ -184,6 +224,7 @@ void CAN0_ORed_0_15_MB_IRQHandler(void){
 		if(RexData[0] == 0xB){	/* Pin Measure */
 			ValuePin = RexData[1];
 		}
+		PROFILE_end(PROFILE_CAN_REQUEST);
 	#endif
 
 #ifdef Node_2
@@ -215,4 +256,5 @@ void CAN0_ORed_0_15_MB_IRQHandler(void){
 	}
 #endif
 
+	PROFILE_ISR_EXIT(PROFILE_CAN0_MB_ISR);
 }
@@ -66,8 +66,8 @@ void PDB0_init(void)
  * 		PDB0 Period = (Sys. Clock / (Prescaler * Mult factor)) / Counts
  * 		PDB0 Period = 1s
  * 		Delay = 500ms
- * 	Channel 4 is triggered at delay complete, and channel 5, 6, 7 are in
- * 	Back-to-Back mode (wait for n+1 channel to be completed to start n
+ * 	Channel 2 is triggered at delay complete, and channel 3, 4, 5 are in
+ * 	Back-to-Back mode (wait for n-1 channel to be completed to start n
  * 	channel)
  */
 void PDB_Config(void){
@@ -82,10 +82,10 @@ void PDB_Config(void){
 			   PDB_SC_CONT_MASK;		/* Continuous mode Enable */
 	PDB0->MOD = 18750;					/* Counts */
 
-	PDB0->CH[0].C1 = (PDB_C1_BB(0xE0)| 	/* Back-to-back for pre-triggers 5/6/7 (wait for channel 4 to be finish)*/
-					  PDB_C1_TOS(0x10)| /* Trigger channel 4 when delay is complete */
-					  PDB_C1_EN(0xF0));	/* Triggers 4/5/6/7 enabled */
-	PDB0->CH[0].DLY[4] = 9375;			/* Delay set to half of the period */
+	PDB0->CH[0].C1 = (PDB_C1_BB(0x38)| 	/* Back-to-back for pre-triggers 3/4/5 (wait for channel 2 to be finish)*/
+					  PDB_C1_TOS(0x04)| /* Trigger channel 2 when delay is complete */
+					  PDB_C1_EN(0x3C));	/* Triggers 2/3/4/5 enabled */
+	PDB0->CH[0].DLY[2] = 9375;			/* Delay set to half of the period */
 
 	PDB0->SC |= PDB_SC_PDBEN_MASK|	/* Enable PDB */
 				PDB_SC_LDOK_MASK;	/* Load MOD and DLY */
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"
+#include "profile.h"
+#include <stdio.h>
+
+#if defined(__linux__)
+#include <stdlib.h>
+#include <time.h>
+#endif
+
+PROFILE_Entry_t PROFILE_Table[PROFILE_ENTRIES];
+
+static uint32_t PROFILE_overhead;		/*< Cycles of an empty PROFILE_begin/PROFILE_end pair */
+
+#if defined(__linux__)
+/*!
+* @brief Host time base: monotonic clock converted to core clock cycles.
+*/
+uint32_t PROFILE_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec) * (PROFILE_CORE_CLOCK_HZ / 1000000u) / 1000u);
+}
+
+static void PROFILE_print_host(char *line)
+{
+	fputs(line, stdout);
+}
+
+static void PROFILE_report_host(void)
+{
+	PROFILE_report(PROFILE_print_host);
+}
+#endif
+
+/*!
+* @brief Clear every entry, keeping its name.
+*/
+void PROFILE_reset(void)
+{
+	uint8_t id;
+	uint8_t bin;
+
+	for (id = 0; id < PROFILE_ENTRIES; id++)
+	{
+		PROFILE_Table[id].count = 0;
+		PROFILE_Table[id].min   = 0xFFFFFFFFu;
+		PROFILE_Table[id].max   = 0;
+		PROFILE_Table[id].total = 0;
+		for (bin = 0; bin < PROFILE_BINS; bin++)
+		{
+			PROFILE_Table[id].hist[bin] = 0;
+		}
+	}
+}
+
+/*!
+* @brief Start the cycle counter, name the entries and measure the marker overhead.
+*
+* @param[const char * const names[]] Label of each entry, index = entry id
+* @param[uint8_t count] Number of labels (up to PROFILE_ENTRIES)
+*/
+void PROFILE_init(const char * const names[], uint8_t count)
+{
+	uint8_t id;
+	uint32_t start;
+	uint32_t best = 0xFFFFFFFFu;
+
+#if defined(__linux__)
+	atexit(PROFILE_report_host);						/* Report when the host run stops */
+#else
+	PROFILE_DEMCR |= PROFILE_DEMCR_TRCENA;				/* Enable the DWT */
+	PROFILE_DWT_CYCCNT = 0;
+	PROFILE_DWT_CTRL |= PROFILE_DWT_CYCCNTENA;			/* Start the cycle counter */
+#endif
+
+	for (id = 0; id < PROFILE_ENTRIES; id++)
+	{
+		PROFILE_Table[id].name = (id < count) ? names[id] : NULL;
+	}
+
+	PROFILE_overhead = 0;
+	for (id = 0; id < 8u; id++)							/* Shortest of 8 empty samples */
+	{
+		start = PROFILE_now();
+		PROFILE_Table[0].start = PROFILE_now();
+		if (PROFILE_Table[0].start - start < best)
+		{
+			best = PROFILE_Table[0].start - start;
+		}
+	}
+	PROFILE_overhead = best;
+	PROFILE_reset();
+}
+
+/*!
+* @brief Add one sample to entry id.
+*
+* @param[uint8_t id] Entry index
+* @param[uint32_t cycles] Raw sample in core clock cycles, marker overhead included
+*/
+void PROFILE_record(uint8_t id, uint32_t cycles)
+{
+	PROFILE_Entry_t *entry = &PROFILE_Table[id];
+	uint8_t bin = 0;
+
+	cycles = (cycles > PROFILE_overhead) ? (cycles - PROFILE_overhead) : 0;
+	if (cycles != 0u)
+	{
+		bin = (uint8_t)(31u - (uint32_t)__builtin_clz(cycles));	/* CLZ on the Cortex-M4 */
+	}
+
+	entry->count++;
+	entry->total += cycles;
+	entry->hist[bin]++;
+	if (cycles < entry->min)
+	{
+		entry->min = cycles;
+	}
+	if (cycles > entry->max)
+	{
+		entry->max = cycles;
+	}
+}
+
+/*!
+* @brief Print one block per named entry: min/mean/max in cycles and microseconds, then the
+* non-empty histogram bins.
+*
+* @param[void (*print)(char *)] Line output, e.g. LPUART1_transmit_string
+*/
+void PROFILE_report(void (*print)(char *))
+{
+	char line[96];
+	uint8_t id;
+	uint8_t bin;
+
+	for (id = 0; id < PROFILE_ENTRIES; id++)
+	{
+		PROFILE_Entry_t *entry = &PROFILE_Table[id];
+		uint32_t mean;
+
+		if (entry->name == NULL)
+		{
+			continue;
+		}
+		if (entry->count == 0u)
+		{
+			snprintf(line, sizeof(line), "%s: no samples\n\r", entry->name);
+			print(line);
+			continue;
+		}
+		mean = (uint32_t)(entry->total / entry->count);
+		snprintf(line, sizeof(line), "%s: n=%lu min=%lu mean=%lu max=%lu cycles (max %lu us)\n\r",
+				 entry->name, (unsigned long)entry->count, (unsigned long)entry->min, (unsigned long)mean,
+				 (unsigned long)entry->max, (unsigned long)(entry->max / (PROFILE_CORE_CLOCK_HZ / 1000000u)));
+		print(line);
+		for (bin = 0; bin < PROFILE_BINS; bin++)
+		{
+			if (entry->hist[bin] != 0u)
+			{
+				snprintf(line, sizeof(line), "  [%10lu..%10lu] %lu\n\r", (unsigned long)(bin ? (1ul << bin) : 0ul),
+						 (unsigned long)((2ul << bin) - 1ul), (unsigned long)entry->hist[bin]);
+				print(line);
+			}
+		}
+	}
+}
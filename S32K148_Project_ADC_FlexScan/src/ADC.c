@@ -128,7 +128,7 @@ uint32_t ADC_channel_read (void)
 {
 	uint16_t adc_raw_result = 0;
 	adc_raw_result = ADC0 -> R[0];      						/* For SW trigger mode, R[0] is used */
-	return (uint32_t)((5000 * adc_raw_result) / 0xFFF); 		/* Convert result to mV for 0-5 V range */
+	return (adc_raw_result * ADC_MV_PER_LSB_Q16 + 0x8000u) >> 16;	/* Convert result to mV for 0-5 V range, rounded */
 }
 
 /*!
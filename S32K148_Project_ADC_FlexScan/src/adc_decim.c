@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "adc_decim.h"
+
+/*!
+ * Oversampling and decimation
+ * ===================================================
+ * The hardware averager (SC3[AVGE]) holds the ADC for every averaged sample. Here the ADC
+ * keeps converting at the full rate into DMA buffers and each channel is decimated in
+ * software with its own ratio. The boxcar adds one bit of resolution per 4x of
+ * oversampling, on white noise, and the FIR shapes the band before the last decimation.
+ *
+ * The FIR is the hot loop. It reads two delay-line samples and two taps per word and
+ * accumulates both products with SMLAD. The delay-line samples fit in 15 bits, and taps that
+ * sum to 32768 keep the sum within 32 bits.
+ */
+
+#if defined(ADC_DECIM_SMLAD)
+/* Model of the instruction, supplied by the host check of the DSP path (tools/adc_decim_ref.c) */
+int32_t ADC_DECIM_SMLAD(uint32_t x, uint32_t y, int32_t acc);
+#endif
+
+/*!
+* @brief acc + x.lo * y.lo + x.hi * y.hi on signed halfwords (SMLAD).
+*/
+static inline int32_t ADC_Decim_smlad(uint32_t x, uint32_t y, int32_t acc)
+{
+#if defined(ADC_DECIM_SMLAD)
+	return ADC_DECIM_SMLAD(x, y, acc);
+#elif defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+	__asm ("smlad %0, %1, %2, %3" : "=r" (acc) : "r" (x), "r" (y), "r" (acc));
+	return acc;
+#else
+	return acc + (int16_t)x * (int16_t)y + (int16_t)(x >> 16) * (int16_t)(y >> 16);
+#endif
+}
+
+/*!
+* @brief Two halfwords at any halfword address, one LDR on the M4.
+*/
+static inline uint32_t ADC_Decim_pair(const int16_t * p)
+{
+	uint32_t word;
+
+	memcpy(&word, p, sizeof(word));
+	return word;
+}
+
+/*!
+* @brief Configure the stages of a channel and clear its state.
+*
+* @param[ADC_Decim_t * f] Channel filter
+* @param[uint8_t boxcar_log2] log2 of the samples summed per boxcar output (0 - ADC_DECIM_MAX_BOXCAR)
+* @param[const int16_t * taps] Q15 FIR coefficients summing to 32768, NULL for no FIR
+* @param[uint8_t ntaps] FIR length (1 - ADC_DECIM_MAX_TAPS)
+* @param[uint8_t decimation] FIR decimation factor (1 - 255)
+* @param[uint8_t bits] Output resolution (12 - 16)
+* @return 0 if a parameter is out of range
+*/
+uint8_t ADC_Decim_init(ADC_Decim_t * f, uint8_t boxcar_log2, const int16_t * taps, uint8_t ntaps,
+					   uint8_t decimation, uint8_t bits)
+{
+	if ((boxcar_log2 > ADC_DECIM_MAX_BOXCAR) || (bits < 12u) || (bits > 16u) ||
+		((taps != NULL) && ((ntaps == 0u) || (ntaps > ADC_DECIM_MAX_TAPS) || (decimation == 0u))))
+	{
+		return 0;
+	}
+	f->taps        = taps;
+	f->ntaps       = (taps != NULL) ? ntaps : 0u;
+	f->decimation  = (taps != NULL) ? decimation : 1u;
+	f->boxcar_log2 = boxcar_log2;
+	f->bits        = bits;
+	ADC_Decim_reset(f);
+	return 1;
+}
+
+/*!
+* @brief Drop the partial boxcar sum and the FIR history, e.g. after a gap in the stream.
+*
+* @param[ADC_Decim_t * f] Channel filter
+*/
+void ADC_Decim_reset(ADC_Decim_t * f)
+{
+	f->acc   = 0;
+	f->count = 0;
+	f->phase = 0;
+	f->pos   = 0;
+	memset(f->line, 0, sizeof(f->line));
+}
+
+/*!
+* @brief FIR output of the current window, 15 bits, saturated like USAT.
+*/
+static inline uint32_t ADC_Decim_fir(const ADC_Decim_t * f)
+{
+	const int16_t * x = &f->line[f->pos];	/* x[k]: sample k inputs ago */
+	const int16_t * c = f->taps;
+	int32_t acc = 0;
+	uint8_t k;
+
+	for (k = 0; (uint8_t)(k + 1u) < f->ntaps; k += 2u)
+	{
+		acc = ADC_Decim_smlad(ADC_Decim_pair(&x[k]), ADC_Decim_pair(&c[k]), acc);
+	}
+	if (k < f->ntaps)
+	{
+		acc += x[k] * c[k];
+	}
+	acc = (acc + (1 << (ADC_DECIM_FRAC_BITS - 1u))) >> ADC_DECIM_FRAC_BITS;
+	return (acc < 0) ? 0u : (acc > 0x7FFF) ? 0x7FFFu : (uint32_t)acc;
+}
+
+/*!
+* @brief Decimate a block of ADC results of one channel.
+*
+* @param[ADC_Decim_t * f] Channel filter
+* @param[const volatile uint32_t * in] ADC results (R[n] words, 12-bit), e.g. an ADC_Seq_row
+* @param[uint32_t count] Results in the block
+* @param[uint16_t * out] Outputs, up to count / (2^boxcar_log2 * decimation) + 1
+* @return Outputs written
+*/
+uint32_t ADC_Decim_run(ADC_Decim_t * f, const volatile uint32_t * in, uint32_t count, uint16_t * out)
+{
+	uint32_t length = 1u << f->boxcar_log2;
+	int32_t shift = (int32_t)(12u + f->boxcar_log2) - (int32_t)ADC_DECIM_FRAC_BITS;	/* Boxcar sum to 15 bits */
+	uint32_t written = 0;
+
+	while (count != 0u)
+	{
+		uint32_t n = length - f->count;
+		uint32_t acc = f->acc;
+		uint32_t x;
+
+		if (n > count)
+		{
+			n = count;
+		}
+		count -= n;
+		f->count += (uint16_t)n;
+		for (; n >= 4u; n -= 4u, in += 4)		/* Integrate */
+		{
+			acc += (in[0] & 0xFFFu) + (in[1] & 0xFFFu) + (in[2] & 0xFFFu) + (in[3] & 0xFFFu);
+		}
+		for (; n != 0u; n--, in++)
+		{
+			acc += *in & 0xFFFu;
+		}
+		f->acc = acc;
+		if (f->count < length)
+		{
+			break;								/* Partial sum, continued by the next block */
+		}
+
+		x = (shift >= 0) ? (acc >> shift) : (acc << -shift);	/* Dump */
+		f->acc   = 0;
+		f->count = 0;
+
+		if (f->ntaps != 0u)
+		{
+			f->pos = (f->pos == 0u) ? (uint8_t)(f->ntaps - 1u) : (uint8_t)(f->pos - 1u);
+			f->line[f->pos]            = (int16_t)x;
+			f->line[f->pos + f->ntaps] = (int16_t)x;
+			if (++f->phase < f->decimation)
+			{
+				continue;
+			}
+			f->phase = 0;
+			x = ADC_Decim_fir(f);
+		}
+		out[written++] = (uint16_t)((f->bits <= ADC_DECIM_FRAC_BITS) ? (x >> (ADC_DECIM_FRAC_BITS - f->bits))
+																	: (x << (f->bits - ADC_DECIM_FRAC_BITS)));
+	}
+	return written;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ADC_DECIM_H_
+#define ADC_DECIM_H_
+
+#include <stdint.h>
+
+#define ADC_DECIM_MAX_TAPS		32u		/* FIR length */
+#define ADC_DECIM_MAX_BOXCAR	8u		/* log2 of the boxcar length: up to 256 samples */
+#define ADC_DECIM_FRAC_BITS		15u		/* Resolution between the stages: 0 - 32767 full scale */
+
+/* 16-tap Hamming windowed low-pass in Q15 for a FIR decimation of 4 (cut-off at 0.1 fs) */
+#define ADC_DECIM_LOWPASS_4		{ -114, -159, -139, 291, 1450, 3284, 5246, 6525, \
+								  6525, 5246, 3284, 1450, 291, -139, -159, -114 }
+
+/* Decimation of one channel: integrate-and-dump over 2^boxcar_log2 12-bit samples (CIC of
+ * order 1), then an optional decimating FIR with Q15 taps whose sum is 32768. Both stages
+ * keep their state between calls, so any block size can be fed. Output rate is the input
+ * rate / (2^boxcar_log2 * decimation), in bits of resolution. */
+typedef struct
+{
+	const int16_t * taps;				/* Q15 coefficients, NULL for the boxcar only */
+	uint8_t ntaps;						/* FIR length (1 - ADC_DECIM_MAX_TAPS) */
+	uint8_t decimation;					/* FIR inputs per output */
+	uint8_t boxcar_log2;				/* Samples per boxcar output: 1 << boxcar_log2 */
+	uint8_t bits;						/* Output resolution (12 - 16) */
+	uint8_t phase;						/* FIR inputs since the last output */
+	uint8_t pos;						/* Newest sample in line[pos] and line[pos + ntaps] */
+	uint16_t count;						/* Samples in acc */
+	uint32_t acc;						/* Boxcar sum */
+	int16_t line[2u * ADC_DECIM_MAX_TAPS];	/* FIR delay line, written twice so a window is contiguous */
+}ADC_Decim_t;
+
+uint8_t ADC_Decim_init(ADC_Decim_t * f, uint8_t boxcar_log2, const int16_t * taps, uint8_t ntaps,
+					   uint8_t decimation, uint8_t bits);
+void ADC_Decim_reset(ADC_Decim_t * f);
+uint32_t ADC_Decim_run(ADC_Decim_t * f, const volatile uint32_t * in, uint32_t count, uint16_t * out);
+
+#endif /* ADC_DECIM_H_ */
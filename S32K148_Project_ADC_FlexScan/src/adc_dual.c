@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"	/* include peripheral declarations */
+#include "adc_dual.h"
+
+static ADC_Type * const ADC_Dual_adc[2] = { ADC0, ADC1 };
+static PDB_Type * const ADC_Dual_pdb[2] = { PDB0, PDB1 };
+static const uint8_t ADC_Dual_pcc_adc[2] = { PCC_ADC0_INDEX, PCC_ADC1_INDEX };
+static const uint8_t ADC_Dual_pcc_pdb[2] = { PCC_PDB0_INDEX, PCC_PDB1_INDEX };
+static const uint8_t ADC_Dual_trgmux[2] = { TRGMUX_PDB0_INDEX, TRGMUX_PDB1_INDEX };
+static const uint8_t ADC_Dual_request[2] = { EDMA_REQ_PDB0, EDMA_REQ_PDB1 };
+
+/*!
+* @brief Split a channel list across the converters. Entries tied to a converter are placed
+* first, the others balance the two sides; the result slot of every entry is recorded.
+*
+* @param[ADC_Dual_t * dual] Scan to fill
+* @param[const uint8_t * list] ADCH numbers, optionally with ADC_DUAL_ADC0 or ADC_DUAL_ADC1
+* @param[uint8_t count] Entries (1 - ADC_DUAL_MAX)
+* @return 0 if a converter would need more than ADC_DUAL_PER_ADC conversions
+*/
+uint8_t ADC_Dual_plan(ADC_Dual_t * dual, const uint8_t * list, uint8_t count)
+{
+	uint8_t n[2] = { 0, 0 };
+	uint8_t pass, i, adc;
+
+	if ((count == 0u) || (count > ADC_DUAL_MAX))
+	{
+		return 0;
+	}
+	for (pass = 0; pass < 2u; pass++)						/* Tied entries, then free ones */
+	{
+		for (i = 0; i < count; i++)
+		{
+			uint8_t tied = list[i] & (ADC_DUAL_ADC0 | ADC_DUAL_ADC1);
+
+			if ((pass == 0u) != (tied != 0u))
+			{
+				continue;
+			}
+			adc = (tied == ADC_DUAL_ADC1) ? 1u : (tied == ADC_DUAL_ADC0) ? 0u : (n[1] < n[0]) ? 1u : 0u;
+			if (n[adc] == ADC_DUAL_PER_ADC)
+			{
+				return 0;
+			}
+			dual->adch[adc][n[adc]] = ADC_DUAL_ADCH(list[i]);
+			dual->slot[i] = (uint8_t)(2u * n[adc] + adc);	/* Halfword adc of word n */
+			n[adc]++;
+		}
+	}
+
+	dual->count   = count;
+	dual->width   = (n[0] > n[1]) ? n[0] : n[1];
+	dual->used[0] = n[0];
+	dual->used[1] = n[1];
+	for (adc = 0; adc < 2u; adc++)							/* Pad with the last channel */
+	{
+		for (i = n[adc]; (n[adc] != 0u) && (i < dual->width); i++)
+		{
+			dual->adch[adc][i] = dual->adch[adc][n[adc] - 1u];
+		}
+	}
+	return 1;
+}
+
+/*!
+* @brief Configure the converters and the DMA channels for a planned scan.
+*
+* ADCn converts SC1[0..width-1] on PDBn pre-triggers. PDBn requests DMA channel dma_ch + n at
+* IDLY, which copies R[0..width-1] into one frame in a single minor loop; the minor loop offset
+* brings the source back to R[0] and the destination steps to the next frame.
+*
+* @param[ADC_Dual_t * dual] Scan planned by ADC_Dual_plan
+* @param[volatile uint32_t * frames] 2 * frames_per_half * width words
+* @param[uint32_t frames_per_half] Frames per ping-pong half
+* @param[uint8_t dma_ch] DMA channel of ADC0, dma_ch + 1 is used for ADC1
+*/
+void ADC_Dual_init(ADC_Dual_t * dual, volatile uint32_t * frames, uint32_t frames_per_half, uint8_t dma_ch)
+{
+	TCD_t TCDm __attribute__ ((aligned(32)));
+	uint32_t words = frames_per_half * dual->width;		/* Words per half */
+	uint8_t adc, k;
+
+	dual->dma_ch = dma_ch;
+
+	SIM->PLATCGC |= SIM_PLATCGC_CGCDMA_MASK;			/* DMA Clock Gating Control Enable */
+	PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;	/* Enable clock for DMAMUX */
+	DMA->CR |= DMA_CR_EMLM_MASK;						/* Minor loop offsets */
+
+	for (adc = 0; adc < 2u; adc++)
+	{
+		ADC_Type * base = ADC_Dual_adc[adc];
+		uint8_t ch = (uint8_t)(dma_ch + adc);
+
+		DMA_PingPong_init(&dual->stream[adc], ch, frames, words);
+		if (dual->used[adc] == 0u)
+		{
+			continue;
+		}
+
+		PCC->PCCn[ADC_Dual_pcc_adc[adc]] &= ~PCC_PCCn_CGC_MASK;	/* Disable clock to change PCS */
+		PCC->PCCn[ADC_Dual_pcc_adc[adc]] |= PCC_PCCn_PCS(1);	/* PCS = 1 Select SOSCDIV2 */
+		PCC->PCCn[ADC_Dual_pcc_adc[adc]] |= PCC_PCCn_CGC_MASK;	/* Enable bus clock in ADC */
+
+		base->CFG1 = ADC_CFG1_ADIV(0) |					/* Divide ratio = 1 */
+					 ADC_CFG1_MODE(1);					/* 12-bit conversion */
+		base->CFG2 = ADC_CFG2_SMPLTS(12);				/* Sample time is 13 ADC clks */
+		base->SC2  = ADC_SC2_ADTRG_MASK;				/* HW trigger (PDB), results collected at IDLY */
+		base->SC3  = 0;									/* One conversion per trigger, no averaging */
+		for (k = 0; k < dual->width; k++)
+		{
+			base->SC1[k] = ADC_SC1_ADCH(dual->adch[adc][k]);	/* Converted on PDB pre-trigger k */
+		}
+
+		DMAMUX->CHCFG[ch] = 0;								/* Disable the channel to change the source */
+		DMAMUX->CHCFG[ch] = DMAMUX_CHCFG_SOURCE(ADC_Dual_request[adc]) | DMAMUX_CHCFG_ENBL_MASK;
+
+		DMA_TCD_Transfer(&TCDm, &base->R[0], 4, DMA_SIZE_2BYTES,			/* Low half of R[0..width-1]... */
+						 (volatile uint16_t *)frames + adc, 4, DMA_SIZE_2BYTES,	/* ...to halfword adc of each word */
+						 2u * dual->width, (uint16_t)(2u * frames_per_half));	/* One frame per request */
+		DMA_TCD_MinorOffset(&TCDm, -4 * (int32_t)dual->width, 1, 0);		/* Source back to R[0] */
+		DMA_TCD_Last(&TCDm, 0, -(int32_t)(8u * words));					/* Destination back to the first half */
+		DMA_TCD_PingPong(&TCDm);
+		DMA_TCD_Push(ch, &TCDm);
+		DMA->SERQ = DMA_SERQ_SERQ(ch);
+
+		S32_NVIC->ICPR[(DMA0_IRQn + ch) / 32] = 1u << ((DMA0_IRQn + ch) % 32);
+		S32_NVIC->ISER[(DMA0_IRQn + ch) / 32] = 1u << ((DMA0_IRQn + ch) % 32);
+	}
+}
+
+/*!
+* @brief Start both PDBs on the same TRGMUX edge (SIM_SW_TRIG). Every period each converter
+* starts its first conversion after delay_us, runs the others back-to-back and its results are
+* collected at collect_us, which must leave time for width conversions.
+*
+* @param[ADC_Dual_t * dual] Initialized scan
+* @param[uint32_t period_us] Frame period
+* @param[uint32_t delay_us] First conversion, from the period start
+* @param[uint32_t collect_us] DMA request (IDLY), after the last conversion and before period_us
+* @return 0 if the times do not fit the PDB counter
+*/
+uint8_t ADC_Dual_start(ADC_Dual_t * dual, uint32_t period_us, uint32_t delay_us, uint32_t collect_us)
+{
+	uint32_t ticks = period_us * ADC_DUAL_PDB_CLOCK_MHZ;
+	uint8_t prescaler = 0;
+	uint8_t adc;
+
+	while ((ticks >> prescaler) > 0x10000u)
+	{
+		if (++prescaler > 7u)
+		{
+			return 0;
+		}
+	}
+	if ((delay_us >= collect_us) || (collect_us >= period_us))
+	{
+		return 0;
+	}
+
+	for (adc = 0; adc < 2u; adc++)
+	{
+		PDB_Type * pdb = ADC_Dual_pdb[adc];
+		uint32_t pretriggers = (1u << dual->width) - 1u;
+
+		if (dual->used[adc] == 0u)
+		{
+			continue;
+		}
+		PCC->PCCn[ADC_Dual_pcc_pdb[adc]] |= PCC_PCCn_CGC_MASK;	/* Enable clock for PDB */
+
+		pdb->SC = PDB_SC_PRESCALER(prescaler) |		/* Same counter clock on both PDBs */
+				  PDB_SC_TRGSEL(0)            |		/* TRGMUX output: started together */
+				  PDB_SC_MULT(0)              |		/* Mult factor = 1 */
+				  PDB_SC_DMAEN_MASK           |		/* IDLY requests the DMA */
+				  PDB_SC_CONT_MASK;					/* Continuous mode: same period, no drift */
+		pdb->MOD  = ((ticks >> prescaler) - 1u);
+		pdb->IDLY = (collect_us * ADC_DUAL_PDB_CLOCK_MHZ) >> prescaler;
+
+		pdb->CH[0].C1 = PDB_C1_EN(pretriggers)            |	/* Pre-triggers 0..width-1 */
+						PDB_C1_TOS(1)                     |	/* Pre-trigger 0 at DLY[0] */
+						PDB_C1_BB(pretriggers & ~1u);			/* The others after the previous conversion */
+		pdb->CH[0].DLY[0] = (delay_us * ADC_DUAL_PDB_CLOCK_MHZ) >> prescaler;
+
+		pdb->SC |= PDB_SC_PDBEN_MASK |					/* Enable PDB */
+				   PDB_SC_LDOK_MASK;					/* Load MOD, IDLY and DLY */
+
+		TRGMUX->TRGMUXn[ADC_Dual_trgmux[adc]] = TRGMUX_TRGMUXn_SEL0(TRGMUX_TRIG_SOURCE_SIM_SW_TRIG);
+	}
+
+	SIM->MISCTRL1 &= ~SIM_MISCTRL1_SW_TRG_MASK;
+	SIM->MISCTRL1 |= SIM_MISCTRL1_SW_TRG_MASK;			/* One edge starts both PDBs */
+	return 1;
+}
+
+/*!
+* @brief Stop both PDBs, the DMA channels keep their position.
+*/
+void ADC_Dual_stop(void)
+{
+	PDB0->SC &= ~PDB_SC_PDBEN_MASK;
+	PDB1->SC &= ~PDB_SC_PDBEN_MASK;
+	SIM->MISCTRL1 &= ~SIM_MISCTRL1_SW_TRG_MASK;
+}
+
+/*!
+* @brief Body of the IRQ handler of DMA channel dma_ch + adc.
+*
+* @param[ADC_Dual_t * dual] Scan
+* @param[uint8_t adc] 0 for ADC0, 1 for ADC1
+*/
+void ADC_Dual_IRQHandler(ADC_Dual_t * dual, uint8_t adc)
+{
+	DMA_PingPong_IRQHandler(&dual->stream[adc]);
+}
+
+/*!
+* @brief Oldest half of frames filled by both converters.
+*
+* @param[ADC_Dual_t * dual] Scan
+* @return frames_per_half frames of width words, NULL if no half is ready
+*/
+volatile uint32_t * ADC_Dual_Get(ADC_Dual_t * dual)
+{
+	volatile uint32_t * half = NULL;
+	uint8_t adc;
+
+	for (adc = 0; adc < 2u; adc++)
+	{
+		if (dual->used[adc] != 0u)
+		{
+			half = DMA_PingPong_Get(&dual->stream[adc]);
+			if (half == NULL)
+			{
+				return NULL;
+			}
+		}
+	}
+	return half;
+}
+
+/*!
+* @brief Give the half returned by ADC_Dual_Get back to the DMA.
+*
+* @param[ADC_Dual_t * dual] Scan
+*/
+void ADC_Dual_Release(ADC_Dual_t * dual)
+{
+	uint8_t adc;
+
+	for (adc = 0; adc < 2u; adc++)
+	{
+		if (dual->used[adc] != 0u)
+		{
+			DMA_PingPong_Release(&dual->stream[adc]);
+		}
+	}
+}
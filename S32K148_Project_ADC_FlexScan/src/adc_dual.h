@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ADC_DUAL_H_
+#define ADC_DUAL_H_
+
+#include "device_registers.h"
+#include "dma.h"
+
+#define ADC_DUAL_PER_ADC		8u		/* Conversions per converter and frame: PDB CH0 pre-triggers 0-7 */
+#define ADC_DUAL_MAX			(2u * ADC_DUAL_PER_ADC)
+#define ADC_DUAL_PDB_CLOCK_MHZ	80u		/* PDB counter clock, SYS_CLK of NormalRUNmode_80MHz */
+
+/* Channel list entries: the ADCH number, plus the converter when the input is wired to one
+ * of them only. Entries without a converter go to the one with fewer conversions. */
+#define ADC_DUAL_ADC0			0x40u
+#define ADC_DUAL_ADC1			0x80u
+#define ADC_DUAL_ADCH(entry)	((entry) & 0x3Fu)
+
+/* Scan of a channel list split across ADC0 and ADC1, both started by the same TRGMUX edge
+ * (PDB0 and PDB1 in continuous mode). Each frame is width words: the low halfword of word k
+ * is the k-th ADC0 result, the high halfword the k-th ADC1 result. The shorter side repeats
+ * its last channel, which costs no time as the converters run in parallel. The frames form a
+ * ping-pong buffer; both DMA channels must have completed a half before it is handed out. */
+typedef struct
+{
+	uint8_t count;								/* Entries of the channel list */
+	uint8_t width;								/* Conversions per converter per frame, words per frame */
+	uint8_t used[2];							/* Converters with conversions: used[adc] != 0 */
+	uint8_t adch[2][ADC_DUAL_PER_ADC];			/* SC1[k] channel of ADC0 and ADC1 */
+	uint8_t slot[ADC_DUAL_MAX];					/* Halfword of the frame holding list entry i */
+	uint8_t dma_ch;								/* DMA channel of ADC0, dma_ch + 1 for ADC1 */
+	DMA_PingPong_t stream[2];					/* Halves completed per converter */
+}ADC_Dual_t;
+
+uint8_t ADC_Dual_plan(ADC_Dual_t * dual, const uint8_t * list, uint8_t count);
+void ADC_Dual_init(ADC_Dual_t * dual, volatile uint32_t * frames, uint32_t frames_per_half, uint8_t dma_ch);
+uint8_t ADC_Dual_start(ADC_Dual_t * dual, uint32_t period_us, uint32_t delay_us, uint32_t collect_us);
+void ADC_Dual_stop(void);
+void ADC_Dual_IRQHandler(ADC_Dual_t * dual, uint8_t adc);
+volatile uint32_t * ADC_Dual_Get(ADC_Dual_t * dual);
+void ADC_Dual_Release(ADC_Dual_t * dual);
+
+/*!
+* @brief Result of a channel list entry in a frame.
+*
+* @param[const ADC_Dual_t * dual] Scan
+* @param[const volatile uint32_t * frame] Frame of a half returned by ADC_Dual_Get
+* @param[uint8_t entry] Index in the channel list given to ADC_Dual_plan
+*/
+static inline uint16_t ADC_Dual_result(const ADC_Dual_t * dual, const volatile uint32_t * frame, uint8_t entry)
+{
+	return ((const volatile uint16_t *)frame)[dual->slot[entry]];
+}
+
+#endif /* ADC_DUAL_H_ */
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"	/* include peripheral declarations */
+#include "adc_monitor.h"
+
+/*!
+ * Limit monitoring
+ * ===================================================
+ * PDB0 converts SC1[0] at the start of each slot and raises a DMA request at IDLY, once the
+ * conversion is over. The ADC compare function (ACFE, ACREN, ACFGT = 0) only completes
+ * results outside [CV1, CV2]:
+ *   dma_ch     PDB0 request: {CV1, CV2} of the next entry, minor and major loop link to dma_ch + 1.
+ *   dma_ch + 1 SC1[0] of the next entry, the channel the next slot converts.
+ *   dma_ch + 2 ADC0 COCO request, out-of-window results only: {SC1[0], R[0]} into the event ring
+ *              (destination modulo), one minor loop per event and one major loop per lap of the
+ *              ring. The write position is 16 - CITER and the major loop IRQ counts the laps, so
+ *              ADC_Monitor_Get tells a full ring from an empty one and how many events were lost.
+ * In-window results cost no CPU cycle and no DMA transfer.
+ */
+
+/*!
+* @brief Entry of the limits and SC1 tables loaded after entry - 1 is converted.
+*/
+static inline uint8_t ADC_Monitor_slot(const ADC_Monitor_t * mon, uint8_t entry)
+{
+	return (uint8_t)((entry + mon->count - 1u) % mon->count);
+}
+
+/*!
+* @brief Build the limit tables and configure ADC0 and the DMA channels.
+*
+* @param[ADC_Monitor_t * mon] Monitor
+* @param[const ADC_Monitor_Channel_t * list] Channel list with its limits, converted in order
+* @param[uint8_t count] Entries (1 - ADC_MONITOR_MAX_CHANNELS)
+* @param[uint8_t dma_ch] First of three DMA channels
+* @return 0 if the list is empty or too long
+*/
+uint8_t ADC_Monitor_init(ADC_Monitor_t * mon, const ADC_Monitor_Channel_t * list, uint8_t count, uint8_t dma_ch)
+{
+	TCD_t TCDm[3] __attribute__ ((aligned(32)));
+	uint8_t k;
+
+	if ((count == 0u) || (count > ADC_MONITOR_MAX_CHANNELS))
+	{
+		return 0;
+	}
+	mon->count    = count;
+	mon->dma_ch   = dma_ch;
+	mon->laps     = 0;
+	mon->read     = 0;
+	mon->overruns = 0;
+	for (k = 0; k < count; k++)
+	{
+		ADC_Monitor_set_limits(mon, k, list[k].low, list[k].high);
+		mon->sc1[ADC_Monitor_slot(mon, k)] = ADC_SC1_ADCH(list[k].adch);
+	}
+
+	PCC->PCCn[PCC_ADC0_INDEX] &= ~PCC_PCCn_CGC_MASK;	/* Disable clock to change PCS */
+	PCC->PCCn[PCC_ADC0_INDEX] |= PCC_PCCn_PCS(6);		/* PCS = 6 Select SPLLDIV2 */
+	PCC->PCCn[PCC_ADC0_INDEX] |= PCC_PCCn_CGC_MASK;		/* Enable bus clock in ADC */
+
+	ADC0->CFG1 = ADC_CFG1_ADIV(0) |						/* Divide ratio = 1 */
+				 ADC_CFG1_MODE(1);						/* 12-bit conversion */
+	ADC0->CFG2 = ADC_CFG2_SMPLTS(12);					/* Sample time is 13 ADC clks */
+	ADC0->SC3  = 0;										/* One conversion per trigger, no averaging */
+	ADC0->SC2  = ADC_SC2_ADTRG_MASK |					/* HW trigger (PDB) */
+				 ADC_SC2_DMAEN_MASK |					/* DMA request on COCO */
+				 ADC_SC2_ACFE_MASK  |					/* Compare function enabled... */
+				 ADC_SC2_ACREN_MASK;					/* ...on the range, ACFGT = 0: outside [CV1, CV2] */
+	ADC0->CV[0] = list[0].low;							/* First entry, the DMA loads the others */
+	ADC0->CV[1] = list[0].high;
+	ADC0->SC1[0] = ADC_SC1_ADCH(list[0].adch);
+
+	SIM->PLATCGC |= SIM_PLATCGC_CGCDMA_MASK;			/* DMA Clock Gating Control Enable */
+	PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;	/* Enable clock for DMAMUX */
+	DMA->CR |= DMA_CR_EMLM_MASK;						/* Minor loop offsets for the limits */
+	DMAMUX->CHCFG[dma_ch] = 0;
+	DMAMUX->CHCFG[dma_ch] = DMAMUX_CHCFG_SOURCE(EDMA_REQ_PDB0) | DMAMUX_CHCFG_ENBL_MASK;
+	DMAMUX->CHCFG[dma_ch + 2u] = 0;
+	DMAMUX->CHCFG[dma_ch + 2u] = DMAMUX_CHCFG_SOURCE(EDMA_REQ_ADC0) | DMAMUX_CHCFG_ENBL_MASK;
+
+	DMA_TCD_Transfer(&TCDm[0], mon->limits, 4, DMA_SIZE_4BYTES,		/* {CV1, CV2} pair... */
+					 &ADC0->CV[0], 4, DMA_SIZE_4BYTES, 8, count);		/* ...to the compare values */
+	DMA_TCD_MinorOffset(&TCDm[0], -8, 0, 1);							/* Destination back to CV1 */
+	DMA_TCD_Last(&TCDm[0], -8 * (int32_t)count, 0);
+	DMA_TCD_MinorLink(&TCDm[0], (uint8_t)(dma_ch + 1u));				/* Then the channel */
+	DMA_TCD_MajorLink(&TCDm[0], (uint8_t)(dma_ch + 1u));
+	DMA_TCD_KeepEnabled(&TCDm[0]);
+
+	DMA_TCD_Transfer(&TCDm[1], mon->sc1, 4, DMA_SIZE_4BYTES,			/* Channel of the next entry... */
+					 &ADC0->SC1[0], 0, DMA_SIZE_4BYTES, 4, count);	/* ...to SC1[0] */
+
+	DMA_TCD_Transfer(&TCDm[2], &ADC0->SC1[0], (int16_t)((uint32_t)&ADC0->R[0] - (uint32_t)&ADC0->SC1[0]), DMA_SIZE_4BYTES,
+					 mon->events, 4, DMA_SIZE_4BYTES, 8, ADC_MONITOR_EVENTS);	/* SC1[0] and R[0] to the ring */
+	DMA_TCD_MinorOffset(&TCDm[2], -2 * ((int32_t)&ADC0->R[0] - (int32_t)&ADC0->SC1[0]), 1, 0);	/* Source back to SC1[0] */
+	DMA_TCD_Last(&TCDm[2], 0, 0);
+	DMA_TCD_Modulo(&TCDm[2], 0, ADC_MONITOR_RING_LOG2);				/* Ring wraps with the major loop */
+	DMA_TCD_KeepEnabled(&TCDm[2]);
+	DMA_TCD_Interrupts(&TCDm[2], 0, 1);								/* IRQ per lap */
+
+	DMA_TCD_Push(dma_ch, &TCDm[0]);
+	DMA_TCD_Push((uint8_t)(dma_ch + 1u), &TCDm[1]);
+	DMA_TCD_Push((uint8_t)(dma_ch + 2u), &TCDm[2]);
+	DMA->SERQ = DMA_SERQ_SERQ(dma_ch);
+	DMA->SERQ = DMA_SERQ_SERQ(dma_ch + 2u);
+
+	S32_NVIC->ICPR[(DMA0_IRQn + dma_ch + 2u) / 32] = 1u << ((DMA0_IRQn + dma_ch + 2u) % 32);
+	S32_NVIC->ISER[(DMA0_IRQn + dma_ch + 2u) / 32] = 1u << ((DMA0_IRQn + dma_ch + 2u) % 32);
+	return 1;
+}
+
+/*!
+* @brief Start PDB0 with one slot per entry, scan_hz complete scans per second.
+*
+* @param[ADC_Monitor_t * mon] Initialized monitor
+* @param[uint32_t scan_hz] Scans per second
+* @return 0 if a slot cannot hold a conversion and both DMA services, or is too long
+*/
+uint8_t ADC_Monitor_start(ADC_Monitor_t * mon, uint32_t scan_hz)
+{
+	uint32_t rate = scan_hz * mon->count;				/* Slots per second */
+	uint32_t ticks = (scan_hz != 0u) ? (ADC_MONITOR_PDB_CLOCK_HZ + rate / 2u) / rate : 0u;
+	uint32_t dma = (ADC_MONITOR_DMA_NS * (ADC_MONITOR_PDB_CLOCK_HZ / 1000000u) + 999u) / 1000u;
+	uint32_t idly = (ADC_MONITOR_CONVERSION_ADCK * (ADC_MONITOR_PDB_CLOCK_HZ / 1000u) + (ADC_MONITOR_ADCK_HZ / 1000u) - 1u)
+				  / (ADC_MONITOR_ADCK_HZ / 1000u) + dma;	/* After the conversion and its event */
+	uint8_t prescaler = 0;
+
+	if (ticks < idly + dma)
+	{
+		return 0;
+	}
+	while ((ticks >> prescaler) > 0x10000u)
+	{
+		if (++prescaler > 7u)
+		{
+			return 0;
+		}
+	}
+
+	PCC->PCCn[PCC_PDB0_INDEX] |= PCC_PCCn_CGC_MASK;		/* Enable clock for PDB */
+
+	PDB0->SC = PDB_SC_PRESCALER(prescaler) |	/* PDB frequency is: PDB clock (System Clock) / 2^PRESCALER */
+			   PDB_SC_TRGSEL(15)           |	/* Software trigger selected */
+			   PDB_SC_MULT(0)              |	/* Mult factor = 1 */
+			   PDB_SC_DMAEN_MASK           |	/* IDLY requests the DMA: next entry */
+			   PDB_SC_CONT_MASK;				/* Continuous mode: one slot per period */
+	PDB0->MOD  = (ticks >> prescaler) - 1u;
+	PDB0->IDLY = (idly + (1u << prescaler) - 1u) >> prescaler;
+
+	PDB0->CH[0].C1 = PDB_C1_TOS(1) |			/* Trigger channel 0 when delay is complete */
+					 PDB_C1_EN(0x01);			/* Trigger 0 enabled */
+	PDB0->CH[0].DLY[0] = 0;						/* Conversion at the start of the slot */
+
+	PDB0->SC |= PDB_SC_PDBEN_MASK |				/* Enable PDB */
+				PDB_SC_LDOK_MASK;				/* Load MOD, IDLY and DLY */
+
+	PDB0->SC |= PDB_SC_SWTRIG_MASK;				/* Software Initial PDB trigger */
+	return 1;
+}
+
+/*!
+* @brief Stop the slot timer.
+*/
+void ADC_Monitor_stop(void)
+{
+	PDB0->SC &= ~PDB_SC_PDBEN_MASK;
+}
+
+/*!
+* @brief Change the window of an entry, used from its next conversion on. Results below low
+* or above high are reported; low = 0 and high = 0xFFF never report.
+*
+* @param[ADC_Monitor_t * mon] Monitor
+* @param[uint8_t entry] Index in the channel list
+* @param[uint16_t low] Lowest result in the window
+* @param[uint16_t high] Highest result in the window
+*/
+void ADC_Monitor_set_limits(ADC_Monitor_t * mon, uint8_t entry, uint16_t low, uint16_t high)
+{
+	uint8_t slot = ADC_Monitor_slot(mon, entry);
+
+	mon->limits[2u * slot]      = ADC_CV_CV(low);
+	mon->limits[2u * slot + 1u] = ADC_CV_CV(high);
+}
+
+/*!
+* @brief Events written by the DMA since ADC_Monitor_init.
+*
+* @param[const ADC_Monitor_t * mon] Monitor
+*/
+uint32_t ADC_Monitor_reported(const ADC_Monitor_t * mon)
+{
+	uint8_t ch = (uint8_t)(mon->dma_ch + 2u);
+	uint32_t laps;
+	uint32_t written;
+
+	do
+	{
+		laps = mon->laps;
+		written = laps * ADC_MONITOR_EVENTS
+				+ (ADC_MONITOR_EVENTS - (DMA->TCD[ch].CITER.ELINKNO & DMA_TCD_CITER_ELINKNO_CITER_MASK));
+	}
+	while (laps != mon->laps);			/* Lap IRQ in between: read again */
+	return written;
+}
+
+/*!
+* @brief Body of the IRQ handler of DMA channel dma_ch + 2: the event ring has wrapped.
+*
+* @param[ADC_Monitor_t * mon] Monitor
+*/
+void ADC_Monitor_IRQHandler(ADC_Monitor_t * mon)
+{
+	DMA->CINT = DMA_CINT_CINT(mon->dma_ch + 2u);	/* Clear Interruption request flag */
+	mon->laps++;
+}
+
+/*!
+* @brief Oldest out-of-window result not read yet. If the DMA has lapped the reader, the lost
+* events are counted in overruns and reading resumes at the oldest event the DMA will not
+* overwrite next.
+*
+* @param[ADC_Monitor_t * mon] Monitor
+* @param[ADC_Monitor_Event_t * event] Copy of the event
+* @return 0 if no event is pending
+*/
+uint8_t ADC_Monitor_Get(ADC_Monitor_t * mon, ADC_Monitor_Event_t * event)
+{
+	uint32_t written = ADC_Monitor_reported(mon);
+	uint32_t pending = written - mon->read;
+
+	if ((int32_t)pending <= 0)
+	{
+		return 0;						/* Empty, or wrapped with the lap IRQ not served yet */
+	}
+	if (pending >= ADC_MONITOR_EVENTS)
+	{
+		mon->overruns += pending - (ADC_MONITOR_EVENTS - 1u);	/* Including the entry written next */
+		mon->read = written - (ADC_MONITOR_EVENTS - 1u);
+	}
+	*event = mon->events[mon->read & (ADC_MONITOR_EVENTS - 1u)];
+	mon->read++;
+	return 1;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ADC_MONITOR_H_
+#define ADC_MONITOR_H_
+
+#include "device_registers.h"
+#include "dma.h"
+
+#define ADC_MONITOR_MAX_CHANNELS	32u			/* Entries of a channel list */
+#define ADC_MONITOR_EVENTS			16u			/* Event ring, power of 2 */
+#define ADC_MONITOR_RING_LOG2		7u			/* log2(ADC_MONITOR_EVENTS * sizeof(ADC_Monitor_Event_t)) */
+#define ADC_MONITOR_ADCK_HZ			40000000u	/* ADC0 clock: SPLLDIV2 of SPLL_init_160MHz */
+#define ADC_MONITOR_PDB_CLOCK_HZ	80000000u	/* PDB counter clock, SYS_CLK of NormalRUNmode_80MHz */
+#define ADC_MONITOR_CONVERSION_ADCK	33u			/* 13 clocks sample + 12-bit conversion */
+#define ADC_MONITOR_DMA_NS			1000u		/* One DMA service: event log or limits and SC1 */
+
+typedef struct
+{
+	uint8_t adch;								/* ADC0 input (SC1[ADCH]) */
+	uint16_t low;								/* Results below are reported */
+	uint16_t high;								/* Results above are reported */
+}ADC_Monitor_Channel_t;
+
+typedef struct
+{
+	uint32_t sc1;								/* SC1[0] of the conversion: ADCH tells the input */
+	uint32_t result;							/* R[0] */
+}ADC_Monitor_Event_t;
+
+/* Limit monitoring of an ADC0 channel list: the ADC compare function (out of [CV1, CV2]) drops
+ * every in-window result without COCO, so only out-of-window results reach the DMA, which logs
+ * them in the event ring and interrupts once per lap of the ring. PDB0 paces one slot per entry
+ * and its IDLY DMA request loads the limits and the channel of the next entry. */
+typedef struct
+{
+	ADC_Monitor_Event_t events[ADC_MONITOR_EVENTS] __attribute__ ((aligned(1u << ADC_MONITOR_RING_LOG2)));
+	uint32_t limits[2u * ADC_MONITOR_MAX_CHANNELS];	/* {CV1, CV2} of entries 1..count-1 then 0 */
+	uint32_t sc1[ADC_MONITOR_MAX_CHANNELS];			/* SC1[0] of entries 1..count-1 then 0 */
+	uint8_t count;									/* Entries of the channel list */
+	uint8_t dma_ch;									/* dma_ch: limits, +1: SC1, +2: events */
+	volatile uint32_t laps;							/* Event ring major loops since init */
+	uint32_t read;									/* Events taken by ADC_Monitor_Get since init */
+	uint32_t overruns;								/* Events overwritten before ADC_Monitor_Get */
+}ADC_Monitor_t;
+
+uint8_t ADC_Monitor_init(ADC_Monitor_t * mon, const ADC_Monitor_Channel_t * list, uint8_t count, uint8_t dma_ch);
+uint8_t ADC_Monitor_start(ADC_Monitor_t * mon, uint32_t scan_hz);
+void ADC_Monitor_stop(void);
+void ADC_Monitor_set_limits(ADC_Monitor_t * mon, uint8_t entry, uint16_t low, uint16_t high);
+uint32_t ADC_Monitor_reported(const ADC_Monitor_t * mon);
+void ADC_Monitor_IRQHandler(ADC_Monitor_t * mon);
+uint8_t ADC_Monitor_Get(ADC_Monitor_t * mon, ADC_Monitor_Event_t * event);
+
+#endif /* ADC_MONITOR_H_ */
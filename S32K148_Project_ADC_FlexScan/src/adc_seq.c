@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"	/* include peripheral declarations */
+#include "adc_seq.h"
+
+/*!
+ * Channel sequencer
+ * ===================================================
+ * PDB0 triggers ADC0 SC1[0] once per slot, count slots per scan. Three DMA channels run the
+ * list from there:
+ *   dma_ch     ADC0 COCO request: R[0] to the result matrix, stepping one row (repeat words)
+ *              per entry. Minor loop link to dma_ch + 1, major loop (end of scan) to dma_ch + 2.
+ *   dma_ch + 1 Writes the next {CFG2, SC1[0]} command, so every entry has its own sample time.
+ *   dma_ch + 2 Writes the column of the next scan into DADDR of dma_ch, then links dma_ch + 1.
+ *              It walks 2 * repeat scans and raises the ping-pong interrupts of the matrix.
+ * The ADC only converts on the next PDB trigger, so the slot must cover the conversion and
+ * both DMA services; ADC_Seq_start checks that.
+ */
+
+/*!
+* @brief Build the command and column tables and configure ADC0 and the DMA channels.
+*
+* @param[ADC_Seq_t * seq] Sequencer
+* @param[const ADC_Seq_Channel_t * list] Channel list, converted in order
+* @param[uint8_t count] Entries (1 - ADC_SEQ_MAX_CHANNELS)
+* @param[uint8_t repeat] Scans per ping-pong half (1 - ADC_SEQ_MAX_REPEAT)
+* @param[volatile uint32_t * results] 2 * count * repeat words
+* @param[uint8_t dma_ch] First of three DMA channels
+* @return 0 if the list, the repetition count or a sample time is out of range
+*/
+uint8_t ADC_Seq_init(ADC_Seq_t * seq, const ADC_Seq_Channel_t * list, uint8_t count, uint8_t repeat,
+					 volatile uint32_t * results, uint8_t dma_ch)
+{
+	TCD_t TCDm[3] __attribute__ ((aligned(32)));
+	uint32_t words = (uint32_t)count * repeat;		/* Words per half */
+	uint32_t k, r;
+
+	if ((count == 0u) || (count > ADC_SEQ_MAX_CHANNELS) || (repeat == 0u) || (repeat > ADC_SEQ_MAX_REPEAT))
+	{
+		return 0;
+	}
+	seq->max_sample = 0;
+	for (k = 0; k < count; k++)
+	{
+		const ADC_Seq_Channel_t * entry = &list[(k + 1u) % count];	/* Command k follows result k */
+
+		if ((list[k].sample == 0u) || (list[k].sample > 256u))
+		{
+			return 0;
+		}
+		if (list[k].sample > seq->max_sample)
+		{
+			seq->max_sample = list[k].sample;
+		}
+		seq->cmd[2u * k]      = ADC_CFG2_SMPLTS(entry->sample - 1u);
+		seq->cmd[2u * k + 1u] = ADC_SC1_ADCH(entry->adch);
+	}
+	for (r = 0; r < 2u * repeat; r++)								/* Scan r + 1 starts after scan r */
+	{
+		uint32_t next = (r + 1u) % (2u * repeat);
+
+		seq->column[r] = (uint32_t)&results[(next / repeat) * words + (next % repeat)];
+	}
+	seq->results = results;
+	seq->count   = count;
+	seq->repeat  = repeat;
+	seq->dma_ch  = dma_ch;
+
+	PCC->PCCn[PCC_ADC0_INDEX] &= ~PCC_PCCn_CGC_MASK;	/* Disable clock to change PCS */
+	PCC->PCCn[PCC_ADC0_INDEX] |= PCC_PCCn_PCS(6);		/* PCS = 6 Select SPLLDIV2 */
+	PCC->PCCn[PCC_ADC0_INDEX] |= PCC_PCCn_CGC_MASK;		/* Enable bus clock in ADC */
+
+	ADC0->CFG1 = ADC_CFG1_ADIV(0) |						/* Divide ratio = 1 */
+				 ADC_CFG1_MODE(1);						/* 12-bit conversion */
+	ADC0->SC2  = ADC_SC2_ADTRG_MASK |					/* HW trigger (PDB) */
+				 ADC_SC2_DMAEN_MASK;					/* DMA request on COCO */
+	ADC0->SC3  = 0;										/* One conversion per trigger, no averaging */
+	ADC0->CFG2 = ADC_CFG2_SMPLTS(list[0].sample - 1u);	/* First command, the DMA writes the others */
+	ADC0->SC1[0] = ADC_SC1_ADCH(list[0].adch);
+
+	SIM->PLATCGC |= SIM_PLATCGC_CGCDMA_MASK;			/* DMA Clock Gating Control Enable */
+	PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;	/* Enable clock for DMAMUX */
+	DMA->CR |= DMA_CR_EMLM_MASK;						/* Minor loop offsets for the commands */
+	DMAMUX->CHCFG[dma_ch] = 0;
+	DMAMUX->CHCFG[dma_ch] = DMAMUX_CHCFG_SOURCE(EDMA_REQ_ADC0) | DMAMUX_CHCFG_ENBL_MASK;
+
+	DMA_TCD_Transfer(&TCDm[0], &ADC0->R[0], 0, DMA_SIZE_4BYTES,		/* ADC0 R[0]... */
+					 results, (int16_t)(4u * repeat), DMA_SIZE_4BYTES,	/* ...down the column of the scan */
+					 4, count);
+	DMA_TCD_Last(&TCDm[0], 0, 0);										/* DADDR is rewritten by dma_ch + 2 */
+	DMA_TCD_MinorLink(&TCDm[0], (uint8_t)(dma_ch + 1u));				/* Next command after each result */
+	DMA_TCD_MajorLink(&TCDm[0], (uint8_t)(dma_ch + 2u));				/* Next column after the scan */
+	DMA_TCD_KeepEnabled(&TCDm[0]);
+
+	DMA_TCD_Transfer(&TCDm[1], seq->cmd, 4, DMA_SIZE_4BYTES,			/* {CFG2, SC1} pair... */
+					 &ADC0->CFG2, (int16_t)((uint32_t)&ADC0->SC1[0] - (uint32_t)&ADC0->CFG2), DMA_SIZE_4BYTES,
+					 8, count);											/* ...to CFG2 then SC1[0] */
+	DMA_TCD_MinorOffset(&TCDm[1], 2 * ((int32_t)&ADC0->CFG2 - (int32_t)&ADC0->SC1[0]), 0, 1);	/* Back to CFG2 */
+	DMA_TCD_Last(&TCDm[1], -8 * (int32_t)count, 0);
+
+	DMA_TCD_Transfer(&TCDm[2], seq->column, 4, DMA_SIZE_4BYTES,		/* Column of the next scan... */
+					 &DMA->TCD[dma_ch].DADDR, 0, DMA_SIZE_4BYTES,		/* ...to the result channel */
+					 4, (uint16_t)(2u * repeat));
+	DMA_TCD_MinorLink(&TCDm[2], (uint8_t)(dma_ch + 1u));				/* Then the next command */
+	DMA_TCD_MajorLink(&TCDm[2], (uint8_t)(dma_ch + 1u));
+	DMA_TCD_PingPong(&TCDm[2]);											/* IRQ after each half of the scans */
+
+	DMA_PingPong_init(&seq->stream, (uint8_t)(dma_ch + 2u), results, words);
+	DMA_TCD_Push(dma_ch, &TCDm[0]);
+	DMA_TCD_Push((uint8_t)(dma_ch + 1u), &TCDm[1]);
+	DMA_TCD_Push((uint8_t)(dma_ch + 2u), &TCDm[2]);
+	DMA->SERQ = DMA_SERQ_SERQ(dma_ch);
+
+	S32_NVIC->ICPR[(DMA0_IRQn + dma_ch + 2u) / 32] = 1u << ((DMA0_IRQn + dma_ch + 2u) % 32);
+	S32_NVIC->ISER[(DMA0_IRQn + dma_ch + 2u) / 32] = 1u << ((DMA0_IRQn + dma_ch + 2u) % 32);
+	return 1;
+}
+
+/*!
+* @brief Start PDB0 with one slot per entry, scan_hz complete scans per second.
+*
+* @param[ADC_Seq_t * seq] Initialized sequencer
+* @param[uint32_t scan_hz] Scans per second
+* @return 0 if a slot is shorter than the longest conversion or too long for the PDB counter
+*/
+uint8_t ADC_Seq_start(ADC_Seq_t * seq, uint32_t scan_hz)
+{
+	uint32_t rate = scan_hz * seq->count;				/* Slots per second */
+	uint32_t ticks = (ADC_SEQ_PDB_CLOCK_HZ + rate / 2u) / rate;
+	uint32_t busy = (uint32_t)(((uint64_t)(seq->max_sample + ADC_SEQ_CONVERSION_ADCK) * ADC_SEQ_PDB_CLOCK_HZ
+					+ ADC_SEQ_ADCK_HZ - 1u) / ADC_SEQ_ADCK_HZ)
+				  + (ADC_SEQ_DMA_NS * (ADC_SEQ_PDB_CLOCK_HZ / 1000000u) + 999u) / 1000u;
+	uint8_t prescaler = 0;
+
+	if ((scan_hz == 0u) || (ticks < busy))
+	{
+		return 0;
+	}
+	while ((ticks >> prescaler) > 0x10000u)
+	{
+		if (++prescaler > 7u)
+		{
+			return 0;
+		}
+	}
+
+	PCC->PCCn[PCC_PDB0_INDEX] |= PCC_PCCn_CGC_MASK;		/* Enable clock for PDB */
+
+	PDB0->SC = PDB_SC_PRESCALER(prescaler) |	/* PDB frequency is: PDB clock (System Clock) / 2^PRESCALER */
+			   PDB_SC_TRGSEL(15)           |	/* Software trigger selected */
+			   PDB_SC_MULT(0)              |	/* Mult factor = 1 */
+			   PDB_SC_CONT_MASK;				/* Continuous mode: one slot per period */
+	PDB0->MOD = (ticks >> prescaler) - 1u;
+
+	PDB0->CH[0].C1 = PDB_C1_TOS(1) |			/* Trigger channel 0 when delay is complete */
+					 PDB_C1_EN(0x01);			/* Trigger 0 enabled */
+	PDB0->CH[0].DLY[0] = 0;						/* Conversion at the start of the slot */
+
+	PDB0->SC |= PDB_SC_PDBEN_MASK |				/* Enable PDB */
+				PDB_SC_LDOK_MASK;				/* Load MOD and DLY */
+
+	PDB0->SC |= PDB_SC_SWTRIG_MASK;				/* Software Initial PDB trigger */
+	return 1;
+}
+
+/*!
+* @brief Stop the slot timer, the DMA channels keep their position in the list.
+*/
+void ADC_Seq_stop(void)
+{
+	PDB0->SC &= ~PDB_SC_PDBEN_MASK;
+}
+
+/*!
+* @brief Body of the IRQ handler of DMA channel dma_ch + 2.
+*
+* @param[ADC_Seq_t * seq] Sequencer
+*/
+void ADC_Seq_IRQHandler(ADC_Seq_t * seq)
+{
+	DMA_PingPong_IRQHandler(&seq->stream);
+}
+
+/*!
+* @brief Oldest completed half of the result matrix.
+*
+* @param[ADC_Seq_t * seq] Sequencer
+* @return count * repeat words, read with ADC_Seq_row; NULL if no half is ready
+*/
+volatile uint32_t * ADC_Seq_Get(ADC_Seq_t * seq)
+{
+	return DMA_PingPong_Get(&seq->stream);
+}
+
+/*!
+* @brief Give the half returned by ADC_Seq_Get back to the DMA.
+*
+* @param[ADC_Seq_t * seq] Sequencer
+*/
+void ADC_Seq_Release(ADC_Seq_t * seq)
+{
+	DMA_PingPong_Release(&seq->stream);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ADC_SEQ_H_
+#define ADC_SEQ_H_
+
+#include "device_registers.h"
+#include "dma.h"
+
+#define ADC_SEQ_MAX_CHANNELS	32u			/* Entries of a channel list */
+#define ADC_SEQ_MAX_REPEAT		64u			/* Scans per ping-pong half */
+#define ADC_SEQ_ADCK_HZ			40000000u	/* ADC0 clock: SPLLDIV2 of SPLL_init_160MHz */
+#define ADC_SEQ_PDB_CLOCK_HZ	80000000u	/* PDB counter clock, SYS_CLK of NormalRUNmode_80MHz */
+#define ADC_SEQ_CONVERSION_ADCK	20u			/* 12-bit conversion after the sample phase, in ADC clocks */
+#define ADC_SEQ_DMA_NS			1000u		/* Result read and next command write between conversions */
+
+typedef struct
+{
+	uint8_t adch;							/* ADC0 input (SC1[ADCH]) */
+	uint16_t sample;						/* Sample time in ADC clocks (1 - 256) */
+}ADC_Seq_Channel_t;
+
+/* ADC0 scan of any channel list without CPU: PDB0 triggers one conversion per slot, DMA moves
+ * each result and writes the next command ({CFG2, SC1[0]}) to the ADC. Results form a
+ * channel-major matrix per ping-pong half: half[channel * repeat + scan]. */
+typedef struct
+{
+	uint32_t cmd[2u * ADC_SEQ_MAX_CHANNELS];	/* {CFG2, SC1} of entries 1..count-1 then 0 */
+	uint32_t column[2u * ADC_SEQ_MAX_REPEAT];	/* Result address of scans 1..2*repeat-1 then 0 */
+	volatile uint32_t * results;				/* 2 * count * repeat words */
+	uint16_t max_sample;						/* Longest sample time of the list */
+	uint8_t count;								/* Entries of the channel list */
+	uint8_t repeat;								/* Scans per ping-pong half */
+	uint8_t dma_ch;								/* dma_ch: results, +1: commands, +2: columns */
+	DMA_PingPong_t stream;						/* Halves of results completed */
+}ADC_Seq_t;
+
+uint8_t ADC_Seq_init(ADC_Seq_t * seq, const ADC_Seq_Channel_t * list, uint8_t count, uint8_t repeat,
+					 volatile uint32_t * results, uint8_t dma_ch);
+uint8_t ADC_Seq_start(ADC_Seq_t * seq, uint32_t scan_hz);
+void ADC_Seq_stop(void);
+void ADC_Seq_IRQHandler(ADC_Seq_t * seq);
+volatile uint32_t * ADC_Seq_Get(ADC_Seq_t * seq);
+void ADC_Seq_Release(ADC_Seq_t * seq);
+
+/*!
+* @brief Results of one channel list entry in a half, one word per scan in acquisition order.
+*
+* @param[const ADC_Seq_t * seq] Sequencer
+* @param[const volatile uint32_t * half] Half returned by ADC_Seq_Get
+* @param[uint8_t entry] Index in the channel list given to ADC_Seq_init
+*/
+static inline const volatile uint32_t * ADC_Seq_row(const ADC_Seq_t * seq, const volatile uint32_t * half, uint8_t entry)
+{
+	return &half[(uint32_t)entry * seq->repeat];
+}
+
+#endif /* ADC_SEQ_H_ */
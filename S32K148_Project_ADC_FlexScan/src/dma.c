@@ -36,9 +36,9 @@
 uint8_t TCD0_Source[] = {"Hello World"};	/*< TCD 0 source (11 byte string) 	*/
 uint8_t volatile TCD0_Dest = 0;             /*< TCD 0 destination (1 byte) 	*/
 uint8_t volatile TCD_LC_Dest[11];			/*< Linking Channel destination (11 byte string) */
-uint32_t volatile ADC_SC1A_CH[3] = {30,29,44}; /*< Array to set up the external channels to measure: */
+uint32_t volatile ADC_SC1A_CH[FLEXSCAN_CHANNELS] = {30,29,44}; /*< Array to set up the external channels to measure: */
 											/*< 8 -> PTB13, 9-> PTB14, 12-> Potentiometer			*/
-uint32_t volatile ADC_Results[16];			/*< Destination of the results of each ADC sample made */
+uint32_t volatile ADC_Results[2u * FLEXSCAN_SCANS_PER_HALF * FLEXSCAN_CHANNELS];	/*< Ping-pong destination of the ADC samples */
 
 void DMA_init(void)
 {
@@ -47,6 +47,425 @@ void DMA_init(void)
  /* 2. Enabling desired channels by setting ERQ bit (not needed when START bit used) 		*/
 }
 
+/*!
+* @brief Iteration count field of CITER/BITER, which is narrower with minor loop linking.
+*/
+static inline uint16_t DMA_iterations(uint16_t iter)
+{
+	return (iter & DMA_TCD_CITER_ELINKYES_ELINK_MASK) ? (iter & DMA_TCD_CITER_ELINKYES_CITER_LE_MASK)
+													  : (iter & DMA_TCD_CITER_ELINKNO_CITER_MASK);
+}
+
+/*!
+ * TCD builder
+ * ===================================================
+ * DMA_TCD_Transfer fills a TCD_t image in RAM with the common case: source and destination
+ * stepping by SOFF/DOFF with transfers of any size, nbytes per minor loop, iterations minor
+ * loops per major loop, both addresses restored after the major loop and the channel disabled
+ * (DREQ) at the end. The other DMA_TCD_ functions add one feature each to that image:
+ * adjustments after the major loop, minor loop offsets, channel linking, scatter/gather and
+ * interrupts. DMA_TCD_Validate reports the configuration errors the eDMA would raise in ES and
+ * DMA_TCD_Push loads the image into a channel.
+ */
+
+/*!
+* @brief Basic transfer: every other TCD field is cleared.
+*
+* @param[TCD_t * TCDm] TCD image to fill
+* @param[const volatile void * source] Source address
+* @param[int16_t SOFF] Bytes added to the source address after each transfer
+* @param[DMA_Size_t ssize] Source transfer size
+* @param[volatile void * dest] Destination address
+* @param[int16_t DOFF] Bytes added to the destination address after each transfer
+* @param[DMA_Size_t dsize] Destination transfer size
+* @param[uint32_t nbytes] Bytes per minor loop, multiple of both transfer sizes
+* @param[uint16_t iterations] Minor loops per major loop (1 - 32767)
+*/
+void DMA_TCD_Transfer(TCD_t * TCDm, const volatile void * source, int16_t SOFF, DMA_Size_t ssize,
+					  volatile void * dest, int16_t DOFF, DMA_Size_t dsize, uint32_t nbytes, uint16_t iterations)
+{
+	int32_t source_transfers = (int32_t)(nbytes / DMA_SIZE_BYTES(ssize)) * iterations;	/* Transfers per major loop */
+	int32_t dest_transfers   = (int32_t)(nbytes / DMA_SIZE_BYTES(dsize)) * iterations;
+
+	TCDm->SADDR         = DMA_TCD_SADDR_SADDR((uint32_t) source);	/* Source Address */
+	TCDm->SOFF          = DMA_TCD_SOFF_SOFF(SOFF);					/* Src. addr offset after transfers */
+	TCDm->ATTR          = DMA_TCD_ATTR_SMOD(0)      |				/* Src. modulo feature not used */
+						  DMA_TCD_ATTR_SSIZE(ssize) |				/* Src. read 2**ssize bytes per transfer */
+						  DMA_TCD_ATTR_DMOD(0)      |				/* Dest. modulo feature not used */
+						  DMA_TCD_ATTR_DSIZE(dsize);				/* Dest. write 2**dsize bytes per transfer */
+
+	TCDm->NBYTES_MLNO   = DMA_TCD_NBYTES_MLNO_NBYTES(nbytes);		/* Bytes per minor loop */
+	TCDm->SLAST         = DMA_TCD_SLAST_SLAST(-(SOFF * source_transfers));	/* Src addr back to start after major loop */
+
+	TCDm->DADDR         = DMA_TCD_DADDR_DADDR((uint32_t) dest);		/* Destination Address */
+	TCDm->DOFF          = DMA_TCD_DOFF_DOFF(DOFF);					/* Dest. addr offset after transfers */
+	TCDm->CITER_ELINKNO = DMA_TCD_CITER_ELINKNO_CITER(iterations) |	/* Minor loop iterations */
+						  DMA_TCD_CITER_ELINKNO_ELINK(0);			/* No minor loop chan link */
+
+	TCDm->DLASTSGA      = DMA_TCD_DLASTSGA_DLASTSGA(-(DOFF * dest_transfers));	/* Dest addr back to start after major loop */
+	TCDm->CSR           = DMA_TCD_CSR_START(0)       |				/* Clear START status flag */
+						  DMA_TCD_CSR_INTMAJOR(0)    |				/* No IRQ after major loop */
+						  DMA_TCD_CSR_INTHALF(0)     |				/* No IRQ after 1/2 major loop */
+						  DMA_TCD_CSR_DREQ(1)        |				/* Disable chan after major loop */
+						  DMA_TCD_CSR_ESG(0)         |				/* Disable Scatter Gather */
+						  DMA_TCD_CSR_MAJORELINK(0)  |				/* No major loop chan link */
+						  DMA_TCD_CSR_MAJORLINKCH(0) |				/* Chan # if major loop ch link */
+						  DMA_TCD_CSR_BWC(0);						/* No eDMA stalls after R/W */
+	TCDm->BITER_ELINKNO = DMA_TCD_BITER_ELINKNO_BITER(iterations) |	/* Initial iteration count */
+						  DMA_TCD_BITER_ELINKNO_ELINK(0);			/* No minor loop chan link */
+}
+
+/*!
+* @brief Memory to memory copy in a single minor loop, using the widest transfer size (up to a
+* 32-byte burst) that the alignment of both addresses and the length allow.
+*
+* @param[TCD_t * TCDm] TCD image to fill
+* @param[volatile void * dest] Destination buffer
+* @param[const volatile void * source] Source buffer
+* @param[uint32_t length] Bytes to copy (1 - 1023 if minor loop offsets are enabled in DMA->CR)
+*/
+void DMA_TCD_Copy(TCD_t * TCDm, volatile void * dest, const volatile void * source, uint32_t length)
+{
+	uint32_t alignment = (uint32_t) dest | (uint32_t) source | length;
+	DMA_Size_t size;
+
+	if ((alignment & 0x1Fu) == 0u)		size = DMA_SIZE_32BYTES;
+	else if ((alignment & 0xFu) == 0u)	size = DMA_SIZE_16BYTES;
+	else if ((alignment & 0x3u) == 0u)	size = DMA_SIZE_4BYTES;
+	else if ((alignment & 0x1u) == 0u)	size = DMA_SIZE_2BYTES;
+	else								size = DMA_SIZE_1BYTE;
+
+	/* Bursts move 16/32 bytes per transfer but still step the address by the bytes moved */
+	DMA_TCD_Transfer(TCDm, source, (int16_t)DMA_SIZE_BYTES(size), size,
+					 dest, (int16_t)DMA_SIZE_BYTES(size), size, length, 1);
+}
+
+/*!
+* @brief Replace the address adjustments applied after the major loop.
+*
+* @param[TCD_t * TCDm] TCD image
+* @param[int32_t SLAST] Bytes added to the source address
+* @param[int32_t DLAST] Bytes added to the destination address (not with scatter/gather)
+*/
+void DMA_TCD_Last(TCD_t * TCDm, int32_t SLAST, int32_t DLAST)
+{
+	TCDm->SLAST    = DMA_TCD_SLAST_SLAST(SLAST);
+	TCDm->DLASTSGA = DMA_TCD_DLASTSGA_DLASTSGA(DLAST);
+}
+
+/*!
+* @brief Add MLOFF to the source and/or destination address after each minor loop.
+* Requires DMA->CR[EMLM] = 1 and limits nbytes to 1023.
+*
+* @param[TCD_t * TCDm] TCD image
+* @param[int32_t MLOFF] Signed minor loop offset (20 bits)
+* @param[uint8_t source] 1: apply to the source address
+* @param[uint8_t dest] 1: apply to the destination address
+*/
+void DMA_TCD_MinorOffset(TCD_t * TCDm, int32_t MLOFF, uint8_t source, uint8_t dest)
+{
+	TCDm->NBYTES_MLOFFYES = DMA_TCD_NBYTES_MLOFFYES_SMLOE(source) |	/* Src. minor loop offset enable */
+							DMA_TCD_NBYTES_MLOFFYES_DMLOE(dest)   |	/* Dest. minor loop offset enable */
+							DMA_TCD_NBYTES_MLOFFYES_MLOFF(MLOFF)  |	/* Offset after each minor loop */
+							DMA_TCD_NBYTES_MLOFFYES_NBYTES(TCDm->NBYTES_MLNO);
+}
+
+/*!
+* @brief Start channel ch after each minor loop except the last one. Limits the iteration count
+* to 511.
+*
+* @param[TCD_t * TCDm] TCD image
+* @param[uint8_t ch] Linked channel
+*/
+void DMA_TCD_MinorLink(TCD_t * TCDm, uint8_t ch)
+{
+	uint16_t iterations = TCDm->BITER_ELINKNO & DMA_TCD_BITER_ELINKNO_BITER_MASK;
+
+	TCDm->CITER_ELINKYES = DMA_TCD_CITER_ELINKYES_CITER_LE(iterations) |	/* Minor loop iterations */
+						   DMA_TCD_CITER_ELINKYES_ELINK_MASK           |	/* Enable Linking Channel after Minor Loop */
+						   DMA_TCD_CITER_ELINKYES_LINKCH(ch);				/* Link to channel ch after minor loop */
+	TCDm->BITER_ELINKYES = DMA_TCD_BITER_ELINKYES_BITER(iterations)    |	/* Initial iteration count */
+						   DMA_TCD_BITER_ELINKYES_ELINK_MASK           |	/* Enable Linking Channel after Minor Loop */
+						   DMA_TCD_BITER_ELINKYES_LINKCH(ch);				/* Link to channel ch after minor loop */
+}
+
+/*!
+* @brief Start channel ch when the major loop completes.
+*
+* @param[TCD_t * TCDm] TCD image
+* @param[uint8_t ch] Linked channel
+*/
+void DMA_TCD_MajorLink(TCD_t * TCDm, uint8_t ch)
+{
+	TCDm->CSR = (TCDm->CSR & ~DMA_TCD_CSR_MAJORLINKCH_MASK) |
+				DMA_TCD_CSR_MAJORELINK_MASK |					/* Activate major loop chan link */
+				DMA_TCD_CSR_MAJORLINKCH(ch);					/* Chan # of the major loop ch link */
+}
+
+/*!
+* @brief Load next into the channel when the major loop completes. The channel stays enabled
+* (DREQ = 0) and DLASTSGA becomes the address of next, so it must be 32-byte aligned.
+*
+* @param[TCD_t * TCDm] TCD image
+* @param[const TCD_t * next] TCD image loaded after the major loop
+*/
+void DMA_TCD_ScatterGather(TCD_t * TCDm, const TCD_t * next)
+{
+	TCDm->DLASTSGA = DMA_TCD_DLASTSGA_DLASTSGA((uint32_t) next);	/* Next TCD in memory */
+	TCDm->CSR = (TCDm->CSR & ~DMA_TCD_CSR_DREQ_MASK) |			/* DREQ = 0: Keep DMA CH active after major loop */
+				DMA_TCD_CSR_ESG_MASK;							/* ESG = 1: Enable Scatter Gather feature */
+}
+
+/*!
+* @brief Select the channel interrupts.
+*
+* @param[TCD_t * TCDm] TCD image
+* @param[uint8_t half] 1: IRQ when CITER reaches half of BITER
+* @param[uint8_t major] 1: IRQ after the major loop
+*/
+void DMA_TCD_Interrupts(TCD_t * TCDm, uint8_t half, uint8_t major)
+{
+	TCDm->CSR = (TCDm->CSR & ~(DMA_TCD_CSR_INTHALF_MASK | DMA_TCD_CSR_INTMAJOR_MASK)) |
+				DMA_TCD_CSR_INTHALF(half) |
+				DMA_TCD_CSR_INTMAJOR(major);
+}
+
+/*!
+* @brief Keep the hardware request enabled after the major loop (DREQ = 0).
+*
+* @param[TCD_t * TCDm] TCD image
+*/
+void DMA_TCD_KeepEnabled(TCD_t * TCDm)
+{
+	TCDm->CSR &= ~DMA_TCD_CSR_DREQ_MASK;
+}
+
+/*!
+* @brief Restrict the source and/or destination address to an aligned window of 2**mod bytes.
+* SLAST/DLASTSGA still apply to the full address, set them with DMA_TCD_Last.
+*
+* @param[TCD_t * TCDm] TCD image
+* @param[uint8_t smod] Source modulo (0: disabled)
+* @param[uint8_t dmod] Destination modulo (0: disabled)
+*/
+void DMA_TCD_Modulo(TCD_t * TCDm, uint8_t smod, uint8_t dmod)
+{
+	TCDm->ATTR = (TCDm->ATTR & ~(DMA_TCD_ATTR_SMOD_MASK | DMA_TCD_ATTR_DMOD_MASK)) |
+				 DMA_TCD_ATTR_SMOD(smod) |
+				 DMA_TCD_ATTR_DMOD(dmod);
+}
+
+/*!
+* @brief Strided gather/scatter: elements transfers of the given size per minor loop, minors
+* minor loops per major loop, each address following its DMA_Stride_t. Typical uses are a column
+* of a matrix per minor loop (element = row pitch, minor = element size) or a block of lines out
+* of an image (minor = line pitch). SOFF/DOFF step the elements, MLOFF moves to the next minor
+* loop and SLAST/DLASTSGA to the next major loop. MLOFF is shared by both addresses, so when both
+* need one it must be the same. A minor loop offset requires DMA->CR[EMLM] = 1.
+*
+* The eDMA adds MLOFF after the last minor loop too, before SLAST/DLASTSGA: the adjustments
+* after the major loop start from base + minors * minor.
+*
+* @param[TCD_t * TCDm] TCD image to fill
+* @param[const volatile void * source] Address of the first source element
+* @param[const DMA_Stride_t * sstride] Source walk
+* @param[volatile void * dest] Address of the first destination element
+* @param[const DMA_Stride_t * dstride] Destination walk
+* @param[DMA_Size_t size] Transfer size of both sides
+* @param[uint16_t elements] Transfers per minor loop
+* @param[uint16_t minors] Minor loops per major loop (1 - 32767)
+* @return 0 if the walk does not fit the TCD: element step beyond 16 bits, different minor loop
+* offsets for source and destination, MLOFF beyond 20 bits or more than 1023 bytes per minor loop
+* with a minor loop offset
+*/
+uint8_t DMA_TCD_Strided(TCD_t * TCDm, const volatile void * source, const DMA_Stride_t * sstride,
+						volatile void * dest, const DMA_Stride_t * dstride, DMA_Size_t size,
+						uint16_t elements, uint16_t minors)
+{
+	int32_t nbytes = (int32_t)elements * (int32_t)DMA_SIZE_BYTES(size);
+	int32_t smloff = sstride->minor - (int32_t)elements * sstride->element;	/* Next minor loop from past the last element */
+	int32_t dmloff = dstride->minor - (int32_t)elements * dstride->element;
+	int32_t mloff  = (smloff != 0) ? smloff : dmloff;
+
+	if ((elements == 0u) || (minors == 0u) || (minors > 32767u) ||
+		(sstride->element < INT16_MIN) || (sstride->element > INT16_MAX) ||
+		(dstride->element < INT16_MIN) || (dstride->element > INT16_MAX))
+	{
+		return 0;
+	}
+	if ((smloff != 0) && (dmloff != 0) && (smloff != dmloff))
+	{
+		return 0;												/* One MLOFF for both addresses */
+	}
+	if ((mloff != 0) && ((nbytes > 1023) || (mloff < -(1 << 19)) || (mloff >= (1 << 19))))
+	{
+		return 0;												/* NBYTES 10 bits, MLOFF 20 bits */
+	}
+
+	DMA_TCD_Transfer(TCDm, source, (int16_t)sstride->element, size,
+					 dest, (int16_t)dstride->element, size, (uint32_t)nbytes, minors);
+	if (mloff != 0)
+	{
+		DMA_TCD_MinorOffset(TCDm, mloff, (smloff != 0) ? 1u : 0u, (dmloff != 0) ? 1u : 0u);
+	}
+	DMA_TCD_Last(TCDm, sstride->major - (int32_t)minors * sstride->minor,
+					   dstride->major - (int32_t)minors * dstride->minor);
+	return 1;
+}
+
+/*!
+* @brief Turn the major loop into an endless ping-pong over the destination buffer: the channel
+* stays enabled, DLASTSGA brings the destination back to the first half and an IRQ is raised
+* when each half is full. The iteration count must be even.
+*
+* @param[TCD_t * TCDm] TCD image
+*/
+void DMA_TCD_PingPong(TCD_t * TCDm)
+{
+	DEV_ASSERT((DMA_iterations(TCDm->BITER_ELINKNO) & 1u) == 0u);
+
+	DMA_TCD_KeepEnabled(TCDm);
+	DMA_TCD_Interrupts(TCDm, 1, 1);		/* IRQ after each half */
+}
+
+/*!
+* @brief Check a TCD image for the configuration errors the eDMA reports in DMA->ES.
+*
+* @param[const TCD_t * TCDm] TCD image
+* @return DMA_ES_xxx_MASK bits (NCE, SAE, SOE, DAE, DOE, SGE) of every error found, 0 if valid
+*/
+uint32_t DMA_TCD_Validate(const TCD_t * TCDm)
+{
+	uint32_t errors = 0;
+	uint32_t ssize  = (TCDm->ATTR & DMA_TCD_ATTR_SSIZE_MASK) >> DMA_TCD_ATTR_SSIZE_SHIFT;
+	uint32_t dsize  = (TCDm->ATTR & DMA_TCD_ATTR_DSIZE_MASK) >> DMA_TCD_ATTR_DSIZE_SHIFT;
+	uint32_t smask  = DMA_SIZE_BYTES(ssize) - 1u;
+	uint32_t dmask  = DMA_SIZE_BYTES(dsize) - 1u;
+	uint32_t nbytes = TCDm->NBYTES_MLNO;
+	uint16_t citer  = DMA_iterations(TCDm->CITER_ELINKNO);
+	uint16_t biter  = DMA_iterations(TCDm->BITER_ELINKNO);
+
+	if (TCDm->NBYTES_MLOFFYES & (DMA_TCD_NBYTES_MLOFFYES_SMLOE_MASK | DMA_TCD_NBYTES_MLOFFYES_DMLOE_MASK))
+	{
+		nbytes &= DMA_TCD_NBYTES_MLOFFYES_NBYTES_MASK;
+	}
+
+	if ((ssize == 3u) || (ssize > 5u) || (dsize == 3u) || (dsize > 5u) ||	/* Reserved sizes */
+		(nbytes == 0u) || (nbytes & smask) || (nbytes & dmask) ||			/* Whole transfers per minor loop */
+		(citer == 0u) || (citer != biter) ||
+		((TCDm->CITER_ELINKNO ^ TCDm->BITER_ELINKNO) & DMA_TCD_CITER_ELINKNO_ELINK_MASK))
+	{
+		errors |= DMA_ES_NCE_MASK;
+	}
+	if (TCDm->SADDR & smask)
+	{
+		errors |= DMA_ES_SAE_MASK;
+	}
+	if ((uint32_t)(int16_t)TCDm->SOFF & smask)
+	{
+		errors |= DMA_ES_SOE_MASK;
+	}
+	if (TCDm->DADDR & dmask)
+	{
+		errors |= DMA_ES_DAE_MASK;
+	}
+	if ((uint32_t)(int16_t)TCDm->DOFF & dmask)
+	{
+		errors |= DMA_ES_DOE_MASK;
+	}
+	if ((TCDm->CSR & DMA_TCD_CSR_ESG_MASK) && (TCDm->DLASTSGA & 0x1Fu))
+	{
+		errors |= DMA_ES_SGE_MASK;
+	}
+	return errors;
+}
+
+/*!
+ * Ping-pong buffering
+ * ===================================================
+ * A channel set up with DMA_TCD_PingPong fills the two halves of a buffer forever. Its IRQ
+ * handler calls DMA_PingPong_IRQHandler, which marks the half just completed as ready; the
+ * application takes it with DMA_PingPong_Get and gives it back with DMA_PingPong_Release
+ * before the DMA wraps around to it. No data is copied by the CPU.
+ */
+
+/*!
+* @brief Describe the buffer filled by a ping-pong channel.
+*
+* @param[DMA_PingPong_t * stream] Stream state
+* @param[uint8_t ch] DMA channel
+* @param[volatile uint32_t * buffer] Buffer of 2 * samples words
+* @param[uint32_t samples] Words per half
+*/
+void DMA_PingPong_init(DMA_PingPong_t * stream, uint8_t ch, volatile uint32_t * buffer, uint32_t samples)
+{
+	stream->buffer   = buffer;
+	stream->samples  = samples;
+	stream->ch       = ch;
+	stream->fill     = 0;
+	stream->read     = 0;
+	stream->ready[0] = 0;
+	stream->ready[1] = 0;
+	stream->halves   = 0;
+	stream->overruns = 0;
+}
+
+/*!
+* @brief Body of the DMA channel IRQ handler. The half that completed is told by CITER: it
+* is above half of BITER right after the major loop reloads it and at or below half after the
+* half interrupt, as long as the IRQ is served within half a buffer.
+*
+* @param[DMA_PingPong_t * stream] Stream state
+*/
+void DMA_PingPong_IRQHandler(DMA_PingPong_t * stream)
+{
+	uint8_t ch = stream->ch;
+	uint16_t citer = DMA_iterations(DMA->TCD[ch].CITER.ELINKNO);
+	uint16_t biter = DMA_iterations(DMA->TCD[ch].BITER.ELINKNO);
+	uint8_t half = (citer > (biter / 2u)) ? 1u : 0u;
+
+	DMA->CDNE = DMA_CDNE_CDNE(ch);		/* Clear Done Status Flag after the major loop */
+	DMA->CINT = DMA_CINT_CINT(ch);		/* Clear Interruption request flag */
+
+	if (half != stream->fill)
+	{
+		stream->overruns++;				/* Interrupt of the other half missed */
+	}
+	if (stream->ready[half ^ 1u])
+	{
+		stream->overruns++;				/* DMA is now writing a half the application still holds */
+	}
+	stream->ready[half] = 1;
+	stream->fill = half ^ 1u;
+	stream->halves++;
+}
+
+/*!
+* @brief Oldest filled half, in acquisition order.
+*
+* @param[DMA_PingPong_t * stream] Stream state
+* @return Pointer to stream->samples words, NULL if no half is ready
+*/
+volatile uint32_t * DMA_PingPong_Get(DMA_PingPong_t * stream)
+{
+	if (!stream->ready[stream->read])
+	{
+		return NULL;
+	}
+	return &stream->buffer[stream->read * stream->samples];
+}
+
+/*!
+* @brief Give the half returned by DMA_PingPong_Get back to the DMA.
+*
+* @param[DMA_PingPong_t * stream] Stream state
+*/
+void DMA_PingPong_Release(DMA_PingPong_t * stream)
+{
+	stream->ready[stream->read] = 0;
+	stream->read ^= 1u;
+}
+
 /*!
  * TCD0: Transfers string to a single memory location
  * ===================================================
@@ -56,35 +475,12 @@ void DMA_init(void)
  */
 void DMA_TCD_init(void)
 {
+	TCD_t TCDm __attribute__ ((aligned(32)));
 
-  DMA->TCD[0].SADDR        = DMA_TCD_SADDR_SADDR((uint32_t volatile) &TCD0_Source); /* Source Address. */
-  DMA->TCD[0].SOFF         = DMA_TCD_SOFF_SOFF(1);   /* Src. addr add 1 byte after Transfers   */
-  DMA->TCD[0].ATTR         = DMA_TCD_ATTR_SMOD(0)  | /* Src. modulo feature not used */
-                             DMA_TCD_ATTR_SSIZE(0) | /* Src. read 2**0 =1 byte per transfer */
-                             DMA_TCD_ATTR_DMOD(0)  | /* Dest. modulo feature not used */
-                             DMA_TCD_ATTR_DSIZE(0);  /* Dest. write 2**0 =1 byte per trans. */
-
-  DMA->TCD[0].NBYTES.MLNO  = DMA_TCD_NBYTES_MLNO_NBYTES(1); /* Transfer 1 byte /minor loop */
-  DMA->TCD[0].SLAST        = DMA_TCD_SLAST_SLAST(-11); 		/* Src addr change after major loop */
-
-  DMA->TCD[0].DADDR        = DMA_TCD_DADDR_DADDR((uint32_t volatile) &TCD0_Dest);	/* Destination Address. */
-  DMA->TCD[0].DOFF         = DMA_TCD_DOFF_DOFF(0);     			/* No dest adr offset after transfer */
-  DMA->TCD[0].CITER.ELINKNO= DMA_TCD_CITER_ELINKNO_CITER(11) | 	/* 11 minor loop iterations */
-                             DMA_TCD_CITER_ELINKNO_ELINK(0);   	/* No minor loop chan link */
-
-  DMA->TCD[0].DLASTSGA     = DMA_TCD_DLASTSGA_DLASTSGA(0); /* No dest chg after major loop */
-  DMA->TCD[0].CSR          = DMA_TCD_CSR_START(0)       |  /* Clear START status flag */
-                             DMA_TCD_CSR_INTMAJOR(0)    |  /* No IRQ after major loop */
-                             DMA_TCD_CSR_INTHALF(0)     |  /* No IRQ after 1/2 major loop */
-                             DMA_TCD_CSR_DREQ(1)        |  /* Disable chan after major loop */
-                             DMA_TCD_CSR_ESG(0)         |  /* Disable Scatter Gather */
-                             DMA_TCD_CSR_MAJORELINK(0)  |  /* No major loop chan link */
-                             DMA_TCD_CSR_ACTIVE(0)      |  /* Clear ACTIVE status flag */
-                             DMA_TCD_CSR_DONE(0)        |  /* Clear DONE status flag */
-                             DMA_TCD_CSR_MAJORLINKCH(0) |  /* Chan # if major loop ch link */
-                             DMA_TCD_CSR_BWC(0);           /* No eDMA stalls after R/W */
-  DMA->TCD[0].BITER.ELINKNO= DMA_TCD_BITER_ELINKNO_BITER(11) |  /* Initial iteration count */
-                             DMA_TCD_BITER_ELINKNO_ELINK(0);    /* No minor loop chan link */
+	DMA_TCD_Transfer(&TCDm, &TCD0_Source, 1, DMA_SIZE_1BYTE,	/* 1 byte from the string... */
+					 &TCD0_Dest, 0, DMA_SIZE_1BYTE,				/* ...to the same destination byte */
+					 1, 11);									/* 11 minor loops of 1 byte */
+	DMA_TCD_Push(0, &TCDm);
 }
 
 void DMA_SG_init(void){
@@ -99,6 +495,8 @@ void DMA_SG_init(void){
 * with the according information.
 * Depending on the inputs it may configure the TCD to transfer a string
 * to a string or a variable to a string or a string to a variable.
+* Bytes are moved one per minor loop; use DMA_TCD_Transfer or DMA_TCD_Copy
+* for wider transfers.
 *
 * @param[uint32_t * buff_source] Pointer to the direction Source Address
 * @param[uint8_t SOFF] Amount of bytes added to Source Address after transfer
@@ -110,35 +508,8 @@ void DMA_SG_init(void){
 */
 void DMA_TCDm_config(uint32_t * buff_source, uint8_t SOFF, uint32_t * buff_dest, uint8_t DOFF, uint32_t size, TCD_t * TCDm )
 {
-	TCDm->SADDR 		= DMA_TCD_SADDR_SADDR((uint32_t) buff_source); /* Source Address */
-	TCDm->SOFF  		= DMA_TCD_SOFF_SOFF(SOFF);   /* Src. addr add 1 byte after Transfers   */
-	TCDm->ATTR  		= DMA_TCD_ATTR_SMOD(0)  | /* Src. modulo feature not used */
-					      DMA_TCD_ATTR_SSIZE(0) | /* Src. read 2**0 =1 byte per transfer */
-						  DMA_TCD_ATTR_DMOD(0)  | /* Dest. modulo feature not used */
-					      DMA_TCD_ATTR_DSIZE(0);  /* Dest. write 2**0 =1 byte per trans. */
-
-	TCDm->NBYTES_MLOFFNO= DMA_TCD_NBYTES_MLNO_NBYTES(1); /* Transfer 1 byte /minor loop */
-	TCDm->SLAST         = DMA_TCD_SLAST_SLAST(-(SOFF*size)); 		/* No Src addr change after major loop */
-
-	TCDm->DADDR        	= DMA_TCD_DADDR_DADDR((uint32_t) buff_dest);	/* Destination Address. */
-	TCDm->DOFF         	= DMA_TCD_DOFF_DOFF(DOFF);     			/* No dest adr offset after transfer */
-	TCDm->CITER_ELINKNO	= DMA_TCD_CITER_ELINKNO_CITER(size) | 	/* size defines the quantity of minor loop iterations */
-	                      DMA_TCD_CITER_ELINKNO_ELINK(0);   	/* No minor loop chan link */
-
-	TCDm->DLASTSGA     	= DMA_TCD_DLASTSGA_DLASTSGA(-(DOFF*size)); /* Dest chg depends on DOFF after major loop */
-	TCDm->CSR           = DMA_TCD_CSR_START(0)       |  /* Clear START status flag */
-	                      DMA_TCD_CSR_INTMAJOR(1)    |  /* IRQ after major loop */
-	                      DMA_TCD_CSR_INTHALF(0)     |  /* No IRQ after 1/2 major loop */
-	                      DMA_TCD_CSR_DREQ(1)        |  /* Disable chan after major loop */
-	                      DMA_TCD_CSR_ESG(0)         |  /* Disable Scatter Gather */
-	                      DMA_TCD_CSR_MAJORELINK(0)  |  /* No major loop chan link */
-	                      DMA_TCD_CSR_ACTIVE(0)      |  /* Clear ACTIVE status flag */
-	                      DMA_TCD_CSR_DONE(0)        |  /* Clear DONE status flag */
-	                      DMA_TCD_CSR_MAJORLINKCH(0) |  /* Chan # if major loop ch link */
-	                      DMA_TCD_CSR_BWC(0);           /* No eDMA stalls after R/W */
-	TCDm->BITER_ELINKNO = DMA_TCD_BITER_ELINKNO_BITER(size) |  /* size defines the initial iteration count */
-	                      DMA_TCD_BITER_ELINKNO_ELINK(0);    /* No minor loop chan link */
-
+	DMA_TCD_Transfer(TCDm, buff_source, SOFF, DMA_SIZE_1BYTE, buff_dest, DOFF, DMA_SIZE_1BYTE, 1, (uint16_t)size);
+	DMA_TCD_Interrupts(TCDm, 0, 1);								/* IRQ after major loop */
 }
 
 /*!
@@ -146,42 +517,44 @@ void DMA_TCDm_config(uint32_t * buff_source, uint8_t SOFF, uint32_t * buff_dest,
 * ===================================================
 * Fill out the TCD of the desired DMA channel using the
 * configuration saved in memory of the TCDm index selected.
+* The image is copied as 8 words, CSR last, so the channel
+* never sees a partially written TCD with START or ESG set.
 *
 * @param[uint8_t ch] DMA channel where you want to apply the TCD configuration
-* @param[TCD_t * TCDm] Pointer to the TCDm index which contains the TCD configuration to be applied.
+* @param[const TCD_t * TCDm] Pointer to the TCDm index which contains the TCD configuration to be applied.
 *
 */
-void DMA_TCD_Push(uint8_t ch, TCD_t * TCDm )
+void DMA_TCD_Push(uint8_t ch, const TCD_t * TCDm )
 {
-   DMA->TCD[ch].SADDR        = TCDm->SADDR;
-   DMA->TCD[ch].SOFF         = TCDm->SOFF;
-   DMA->TCD[ch].ATTR         = TCDm->ATTR;
-
-
-   DMA->TCD[ch].NBYTES.MLNO  = TCDm->NBYTES_MLOFFNO;
-   DMA->TCD[ch].SLAST        = TCDm->SLAST;
+	volatile uint32_t * dest = (volatile uint32_t *) &DMA->TCD[ch];
+	uint8_t word;
 
-   DMA->TCD[ch].DADDR        = TCDm->DADDR;
-   DMA->TCD[ch].DOFF         = TCDm->DOFF;
-   DMA->TCD[ch].CITER.ELINKNO= TCDm->CITER_ELINKNO;
+	DEV_ASSERT(DMA_TCD_Validate(TCDm) == 0u);
 
-
-   DMA->TCD[ch].DLASTSGA     = TCDm->DLASTSGA;
-   DMA->TCD[ch].CSR          = TCDm->CSR;
-
-   DMA->TCD[ch].BITER.ELINKNO= TCDm->BITER_ELINKNO;
+	DMA->CDNE = DMA_CDNE_CDNE(ch);		/* DONE must be clear before ESG or MAJORELINK can be set */
+	for (word = 0; word < 8u; word++)
+	{
+		dest[word] = TCDm->WORD[word];
+	}
 }
 
 /*! Configuration of the DMA for CAN Node 2
  * 	=====================================================
- * 	Enable DMA channel 3 for data transfer from 4 channels of the ADC0
- * 	to a ADC_Results using the DMA, the DMA transfer call starts when
- * 	the flag COCO from any channel is enable.
+ * 	Enable DMA channel 3 to move every ADC0 COCO result of SC1[2..5] to a
+ * 	ping-pong buffer, continuously. R[2..5] is a 16-byte aligned window,
+ * 	so the source address wraps with the modulo feature and every scan of
+ * 	the 4 channels lands in 4 consecutive words.
  *
- * 	@param[uint32_t Destination[4]] 4 size array that will be defined as the Destination Address
+ * 	@param[DMA_PingPong_t * stream] Stream state, filled by DMA3_IRQHandler
+ * 	@param[uint32_t * buffer] Buffer of 2 * samples words
+ * 	@param[uint32_t samples] Words per half, multiple of 4
  *
  */
-void DMA_Config(uint32_t Destination[4]){
+void DMA_Config(DMA_PingPong_t * stream, uint32_t * buffer, uint32_t samples){
+	TCD_t TCDm __attribute__ ((aligned(32)));
+
+	DEV_ASSERT((samples % 4u) == 0u);
+
 	SIM->PLATCGC |= SIM_PLATCGC_CGCDMA_MASK;			/* DMA Clock Gating Control Enable */
 
 	PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;	/* Enable DMA Clock */
@@ -190,26 +563,14 @@ void DMA_Config(uint32_t Destination[4]){
 	DMAMUX->CHCFG[3] |= DMAMUX_CHCFG_SOURCE(42);        /* ADC0 COCO is the source of the DMA channel 3 */
 	DMAMUX->CHCFG[3] |= DMAMUX_CHCFG_ENBL_MASK;         /* Enable the DMA channel 3 */
 
-	/* Configure TCD*/
-	//Source
-	DMA->TCD[3].SADDR = (uint32_t)&ADC0->R[4];		/* Data Source */
-	DMA->TCD[3].SOFF = DMA_TCD_SOFF_SOFF(2);		/* Offset Source 1 Byte */
-	DMA->TCD[3].SLAST = DMA_TCD_SLAST_SLAST(-20);	/* An adjust of -5 is needed because are 4 channels*/
-
-	//Destination
-	DMA->TCD[3].DADDR = (uint32_t)&Destination[0];       	/* Data Destination */
-	DMA->TCD[3].DOFF = DMA_TCD_DOFF_DOFF(2);   				/* Offset Source 1 Byte */
-	DMA->TCD[3].DLASTSGA = DMA_TCD_DLASTSGA_DLASTSGA(-20);	/* An adjust of -5 is needed */
-
-	DMA->TCD[3].ATTR = DMA_TCD_ATTR_SSIZE(1)|	/* 16 bits transfer from Source */
-					   DMA_TCD_ATTR_DSIZE(1);	/* 16 bits receive to Destination */
-
-	DMA->TCD[3].NBYTES.MLOFFNO = DMA_TCD_NBYTES_MLOFFYES_NBYTES(2);   	/* Minor Byte Transfer Count is 2-bytes */
-	DMA->TCD[3].CITER.ELINKYES = DMA_TCD_CITER_ELINKYES_CITER_LE(10);	/* Current Major Iteration Count is 1 */
-	DMA->TCD[3].BITER.ELINKYES = DMA_TCD_BITER_ELINKYES_BITER(10);
-
-	DMA->TCD[3].CSR = DMA_TCD_CSR_MAJORELINK_MASK|	/* The channel-to-channel linking is enable */
-					  DMA_TCD_CSR_MAJORLINKCH(1);   /* The channel is not explicitly started*/
+	DMA_TCD_Transfer(&TCDm, &ADC0->R[2], 4, DMA_SIZE_4BYTES,	/* ADC0 R[2], R[3], R[4], R[5]... */
+					 &buffer[0], 4, DMA_SIZE_4BYTES,			/* ...to the buffer, one result per request */
+					 4, (uint16_t)(2u * samples));				/* Both halves per major loop */
+	DMA_TCD_Modulo(&TCDm, 4, 0);								/* Source wraps in the 16 bytes of R[2..5] */
+	DMA_TCD_Last(&TCDm, 0, -(int32_t)(8u * samples));			/* Destination back to the first half */
+	DMA_TCD_PingPong(&TCDm);
+	DMA_PingPong_init(stream, 3, buffer, samples);
+	DMA_TCD_Push(3, &TCDm);
 
 	DMA->ERQ |= DMA_ERQ_ERQ3_MASK;    /* The DMA request signal for CH3 is enabled */
 
@@ -234,68 +595,18 @@ void DMAMUX_LC_init(void){
  *
  */
 void DMA_TCD_LC_Config(void){
-	  DMA->TCD[0].SADDR        = DMA_TCD_SADDR_SADDR((uint32_t volatile) &TCD0_Source[0]); /* Source Address. */
-	  DMA->TCD[0].SOFF         = DMA_TCD_SOFF_SOFF(1);   /* Src. addr add 1 byte after Transfers   */
-	  DMA->TCD[0].ATTR         = DMA_TCD_ATTR_SMOD(0)  | /* Src. modulo feature not used */
-	                             DMA_TCD_ATTR_SSIZE(0) | /* Src. read 2**0 =1 byte per transfer */
-	                             DMA_TCD_ATTR_DMOD(0)  | /* Dest. modulo feature not used */
-	                             DMA_TCD_ATTR_DSIZE(0);  /* Dest. write 2**0 =1 byte per trans. */
-
-	  DMA->TCD[0].NBYTES.MLNO  = DMA_TCD_NBYTES_MLNO_NBYTES(1); /* Transfer 1 byte /minor loop */
-	  DMA->TCD[0].SLAST        = DMA_TCD_SLAST_SLAST(-6); 		/* Src addr change -6 bytes after major loop */
-
-	  DMA->TCD[0].DADDR        = DMA_TCD_DADDR_DADDR((uint32_t volatile) &TCD_LC_Dest[0]);	/* Destination Address. */
-	  DMA->TCD[0].DOFF         = DMA_TCD_DOFF_DOFF(1);     			/* Dest. adr add 1 byte after transfers */
-	  DMA->TCD[0].CITER.ELINKYES= DMA_TCD_CITER_ELINKYES_CITER_LE(6)| 	/* 6 minor loop iterations */
-	  	  	  	  	  	  	  	 DMA_TCD_CITER_ELINKYES_ELINK_MASK|	/* Enable Linking Channel after Minor Loop */
-			  	  	  	  	  	 DMA_TCD_CITER_ELINKYES_LINKCH(1);  /* Link to channel 1 after minor loop */
-
-	  DMA->TCD[0].DLASTSGA     = DMA_TCD_DLASTSGA_DLASTSGA(-6); /* Dest. chg -6 bytes after major loop */
-	  DMA->TCD[0].CSR          = DMA_TCD_CSR_START(0)       |  /* Clear START status flag */
-	                             DMA_TCD_CSR_INTMAJOR(0)    |  /* No IRQ after major loop */
-	                             DMA_TCD_CSR_INTHALF(0)     |  /* No IRQ after 1/2 major loop */
-	                             DMA_TCD_CSR_DREQ(1)        |  /* Disable chan after major loop */
-	                             DMA_TCD_CSR_ESG(0)         |  /* Disable Scatter Gather */
-	                             DMA_TCD_CSR_MAJORELINK(0)  |  /* Activate major loop chan link */
-	                             DMA_TCD_CSR_ACTIVE(0)      |  /* Clear ACTIVE status flag */
-	                             DMA_TCD_CSR_DONE(0)        |  /* Clear DONE status flag */
-	                             DMA_TCD_CSR_MAJORLINKCH(0) |  /* Chan # if major loop ch link (Channel 1 in this case) */
-	                             DMA_TCD_CSR_BWC(0);           /* No eDMA stalls after R/W */
-	  DMA->TCD[0].BITER.ELINKYES= DMA_TCD_BITER_ELINKYES_BITER(6) |  /* Initial iteration count */
-			  	  	  	  	  	 DMA_TCD_BITER_ELINKYES_ELINK_MASK|   /*  Minor loop Linking Channel */
-	  	  	  	  	  	  	  	 DMA_TCD_BITER_ELINKYES_LINKCH(1);	/* Minor Loop to CH 1 */
-
-
-	  /*Set up DMA TCD CH 1 */
-
-	  DMA->TCD[1].SADDR        = DMA_TCD_SADDR_SADDR((uint32_t volatile) &TCD0_Source[6]); /* Source Address. */
-	  DMA->TCD[1].SOFF         = DMA_TCD_SOFF_SOFF(1);   /* Src. addr add 1 byte after Transfers   */
-	  DMA->TCD[1].ATTR         = DMA_TCD_ATTR_SMOD(0)  | /* Src. modulo feature not used */
-			  	  	  	  	  	  DMA_TCD_ATTR_SSIZE(0) | /* Src. read 2**0 =1 byte per transfer */
-								  DMA_TCD_ATTR_DMOD(0)  | /* Dest. modulo feature not used */
-								  DMA_TCD_ATTR_DSIZE(0);  /* Dest. write 2**0 =1 byte per trans. */
-
-	  DMA->TCD[1].NBYTES.MLNO  = DMA_TCD_NBYTES_MLNO_NBYTES(1); /* Transfer 1 byte /minor loop */
-	  DMA->TCD[1].SLAST        = DMA_TCD_SLAST_SLAST(-5); 		/* Src addr change -5 bytes after major loop */
-
-	  DMA->TCD[1].DADDR        = DMA_TCD_DADDR_DADDR((uint32_t volatile) &TCD_LC_Dest[6]);	/* Destination Address. */
-	  DMA->TCD[1].DOFF         = DMA_TCD_DOFF_DOFF(1);     			/* Dest. adr add 1 byte after transfer */
-	  DMA->TCD[1].CITER.ELINKNO= DMA_TCD_CITER_ELINKNO_CITER(5) | 	/* 5 minor loop iterations */
-			  	  	  	  	  	 DMA_TCD_CITER_ELINKNO_ELINK(0);   	/* No minor loop chan link */
-
-	  DMA->TCD[1].DLASTSGA     = DMA_TCD_DLASTSGA_DLASTSGA(-5); /* Dest chg -5 bytes after major loop */
-	  DMA->TCD[1].CSR          = DMA_TCD_CSR_START(0)       |  /* Clear START status flag */
-	                           DMA_TCD_CSR_INTMAJOR(1)    |  /* IRQ after major loop */
-	                           DMA_TCD_CSR_INTHALF(0)     |  /* No IRQ after 1/2 major loop */
-	                           DMA_TCD_CSR_DREQ(1)        |  /* Disable chan after major loop */
-	                           DMA_TCD_CSR_ESG(0)         |  /* Disable Scatter Gather */
-	                           DMA_TCD_CSR_MAJORELINK(0)  |  /* No major loop chan link */
-	                           DMA_TCD_CSR_ACTIVE(0)      |  /* Clear ACTIVE status flag */
-	                           DMA_TCD_CSR_DONE(0)        |  /* Clear DONE status flag */
-	                           DMA_TCD_CSR_MAJORLINKCH(0) |  /* Chan # if major loop ch link */
-	                           DMA_TCD_CSR_BWC(0);           /* No eDMA stalls after R/W */
-	  DMA->TCD[1].BITER.ELINKNO= DMA_TCD_BITER_ELINKNO_BITER(5) |  /* Initial iteration count */
-	                           DMA_TCD_BITER_ELINKNO_ELINK(0);    /* No minor loop chan link */
+	TCD_t TCDm[2] __attribute__ ((aligned(32)));
+
+	DMA_TCD_Transfer(&TCDm[0], &TCD0_Source[0], 1, DMA_SIZE_1BYTE,	/* "Hello " ... */
+					 &TCD_LC_Dest[0], 1, DMA_SIZE_1BYTE, 1, 6);		/* ...in 6 minor loops of 1 byte */
+	DMA_TCD_MinorLink(&TCDm[0], 1);									/* Link to channel 1 after minor loop */
+
+	DMA_TCD_Transfer(&TCDm[1], &TCD0_Source[6], 1, DMA_SIZE_1BYTE,	/* "World" ... */
+					 &TCD_LC_Dest[6], 1, DMA_SIZE_1BYTE, 1, 5);		/* ...in 5 minor loops of 1 byte */
+	DMA_TCD_Interrupts(&TCDm[1], 0, 1);								/* IRQ after major loop */
+
+	DMA_TCD_Push(0, &TCDm[0]);
+	DMA_TCD_Push(1, &TCDm[1]);
 }
 
 /*!
@@ -313,74 +624,29 @@ void DMAMUX_FlexScan_init(void){
 /*!
  * DMA  Feature
  * ===================================================
- * Set up DMA TCD 0 to start filling a string and generate a link to channel 1 after
- * its major loop has ended, set up DMA TCD 1 to finish filling up the string with the
- * remaining amount of bytes.
+ * Set up DMA TCD 0 to move each ADC0 result to ADC_Results and link to channel 1 after
+ * every minor loop and after the major loop, set up DMA TCD 1 to write the next channel
+ * of ADC_SC1A_CH to ADC0 SC1[0]. ADC_Results is filled as a ping-pong buffer, each half
+ * holding FLEXSCAN_SCANS_PER_HALF complete scans, and channel 0 never stops.
+ *
+ * @param[DMA_PingPong_t * stream] Stream state, filled by DMA0_IRQHandler
  *
  */
-void DMA_TCD_FlexScan_Config(void){
-	  DMA->TCD[0].SADDR        = DMA_TCD_SADDR_SADDR((uint32_t volatile) &(ADC0->R[0])); /* Source Address to ADC0 Result Register */
-	  DMA->TCD[0].SOFF         = DMA_TCD_SOFF_SOFF(0);   /* Stay the same source address after Transfers   */
-	  DMA->TCD[0].ATTR         = DMA_TCD_ATTR_SMOD(0)  | /* Src. modulo feature not used */
-	                             DMA_TCD_ATTR_SSIZE(2) | /* Src. read 32 bits per transfer */
-	                             DMA_TCD_ATTR_DMOD(0)  | /* Dest. modulo feature not used */
-	                             DMA_TCD_ATTR_DSIZE(2);  /* Dest. write 32 bits per trans. */
-
-	  DMA->TCD[0].NBYTES.MLNO  = DMA_TCD_NBYTES_MLNO_NBYTES(4); /* Transfer 4 byte /minor loop */
-	  DMA->TCD[0].SLAST        = DMA_TCD_SLAST_SLAST(0); 		/* No Source Address change after major loop */
-
-	  DMA->TCD[0].DADDR        = DMA_TCD_DADDR_DADDR((uint32_t volatile) &ADC_Results[0]);	/* Destination Address to ADC_Results array. */
-	  DMA->TCD[0].DOFF         = DMA_TCD_DOFF_DOFF(4);     			/* Dest. adr add 4 bytes after transfers */
-	  DMA->TCD[0].CITER.ELINKYES=DMA_TCD_CITER_ELINKYES_CITER_LE(12)| 	/* 12 minor loop iterations */
-	  	  	  	  	  	  	  	 DMA_TCD_CITER_ELINKYES_ELINK_MASK|	/* Enable Linking Channel after Minor Loop */
-			  	  	  	  	  	 DMA_TCD_CITER_ELINKYES_LINKCH(1);  /* Link to channel 1 after minor loop */
-
-	  DMA->TCD[0].DLASTSGA     = DMA_TCD_DLASTSGA_DLASTSGA(-48); /* Dest. chg -48 bytes after major loop */
-	  DMA->TCD[0].CSR          = DMA_TCD_CSR_START(0)       |  /* Clear START status flag */
-	                             DMA_TCD_CSR_INTMAJOR(1)    |  /* IRQ after major loop */
-	                             DMA_TCD_CSR_INTHALF(0)     |  /* No IRQ after 1/2 major loop */
-	                             DMA_TCD_CSR_DREQ(1)        |  /* Disable chan after major loop */
-	                             DMA_TCD_CSR_ESG(0)         |  /* Disable Scatter Gather */
-	                             DMA_TCD_CSR_MAJORELINK(1)  |  /* Activate major loop chan link */
-	                             DMA_TCD_CSR_ACTIVE(0)      |  /* Clear ACTIVE status flag */
-	                             DMA_TCD_CSR_DONE(0)        |  /* Clear DONE status flag */
-	                             DMA_TCD_CSR_MAJORLINKCH(1) |  /* Chan # if major loop ch link (Channel 1 in this case) */
-	                             DMA_TCD_CSR_BWC(0);           /* No eDMA stalls after R/W */
-	  DMA->TCD[0].BITER.ELINKYES= DMA_TCD_BITER_ELINKYES_BITER(12)|  /* Initial iteration count */
-	  	  	  	  	  	  	  	 DMA_TCD_BITER_ELINKYES_ELINK_MASK|	/* Enable Linking Channel after Minor Loop */
-			  	  	  	  	  	 DMA_TCD_BITER_ELINKYES_LINKCH(1); /* Minor loop Linking Channel */
-
-
-	  /*Set up DMA TCD CH 1 */
-
-	  DMA->TCD[1].SADDR        = DMA_TCD_SADDR_SADDR((uint32_t volatile) &ADC_SC1A_CH[0]); /* Source Address to Array with ADC channels to read */
-	  DMA->TCD[1].SOFF         = DMA_TCD_SOFF_SOFF(4);   /* Src. addr add 4 byte after Transfers   */
-	  DMA->TCD[1].ATTR         = DMA_TCD_ATTR_SMOD(0)  | /* Src. modulo feature not used */
-			  	  	  	  	  	  DMA_TCD_ATTR_SSIZE(2) | /* Src. read 32 bits per transfer */
-								  DMA_TCD_ATTR_DMOD(0)  | /* Dest. modulo feature not used */
-								  DMA_TCD_ATTR_DSIZE(2);  /* Dest. write 32 bits per trans. */
-
-	  DMA->TCD[1].NBYTES.MLNO  = DMA_TCD_NBYTES_MLNO_NBYTES(4); /* Transfers 4 byte /minor loop */
-	  DMA->TCD[1].SLAST        = DMA_TCD_SLAST_SLAST(-12); 		/* Src addr change -12 bytes after major loop */
-
-	  DMA->TCD[1].DADDR        = DMA_TCD_DADDR_DADDR((uint32_t volatile) &(ADC0->SC1[0]));	/* Destination Address to ADC SC1_A register*/
-	  DMA->TCD[1].DOFF         = DMA_TCD_DOFF_DOFF(0);     			/* No destination change after transfer */
-	  DMA->TCD[1].CITER.ELINKNO= DMA_TCD_CITER_ELINKNO_CITER(3) | 	/* 3 minor loop iterations */
-			  	  	  	  	  	 DMA_TCD_CITER_ELINKNO_ELINK(0);   	/* No minor loop chan link */
-
-	  DMA->TCD[1].DLASTSGA     = DMA_TCD_DLASTSGA_DLASTSGA(0); /* No dest. change after major loop */
-	  DMA->TCD[1].CSR          = DMA_TCD_CSR_START(0)       |  /* Clear START status flag */
-	                           DMA_TCD_CSR_INTMAJOR(0)    |  /* No IRQ after major loop */
-	                           DMA_TCD_CSR_INTHALF(0)     |  /* No IRQ after 1/2 major loop */
-	                           DMA_TCD_CSR_DREQ(1)        |  /* Disable chan after major loop */
-	                           DMA_TCD_CSR_ESG(0)         |  /* Disable Scatter Gather */
-	                           DMA_TCD_CSR_MAJORELINK(0)  |  /* No major loop chan link */
-	                           DMA_TCD_CSR_ACTIVE(0)      |  /* Clear ACTIVE status flag */
-	                           DMA_TCD_CSR_DONE(0)        |  /* Clear DONE status flag */
-	                           DMA_TCD_CSR_MAJORLINKCH(0) |  /* Chan # if major loop ch link */
-	                           DMA_TCD_CSR_BWC(0);           /* No eDMA stalls after R/W */
-	  DMA->TCD[1].BITER.ELINKNO= DMA_TCD_BITER_ELINKNO_BITER(3) |  /* Initial iteration count */
-	                           DMA_TCD_BITER_ELINKNO_ELINK(0);    /* No minor loop chan link */
+void DMA_TCD_FlexScan_Config(DMA_PingPong_t * stream){
+	TCD_t TCDm[2] __attribute__ ((aligned(32)));
+	uint32_t samples = FLEXSCAN_SCANS_PER_HALF * FLEXSCAN_CHANNELS;
+
+	DMA_TCD_Transfer(&TCDm[0], &ADC0->R[0], 0, DMA_SIZE_4BYTES,		/* ADC0 R[0]... */
+					 &ADC_Results[0], 4, DMA_SIZE_4BYTES,			/* ...to ADC_Results, both halves per major loop */
+					 4, (uint16_t)(2u * samples));
+	DMA_TCD_MinorLink(&TCDm[0], 1);									/* Next ADC channel after each result */
+	DMA_TCD_MajorLink(&TCDm[0], 1);									/* ...and after the last one */
+	DMA_TCD_PingPong(&TCDm[0]);
+
+	DMA_TCD_Transfer(&TCDm[1], &ADC_SC1A_CH[0], 4, DMA_SIZE_4BYTES,	/* Channel list... */
+					 &ADC0->SC1[0], 0, DMA_SIZE_4BYTES, 4, FLEXSCAN_CHANNELS);	/* ...to ADC0 SC1[0] */
+
+	DMA_PingPong_init(stream, 0, ADC_Results, samples);
+	DMA_TCD_Push(0, &TCDm[0]);
+	DMA_TCD_Push(1, &TCDm[1]);
 }
-
-
@@ -36,7 +36,18 @@
  * This example intends to show how to combine ADC, DMA and PDB to implement an ADC flexible storage.
  * In this project, PDB triggers ADC0 CH0 measurements which will be saved inside an internal memory buffer through DMA,
  * this way the MCU doesn't need to read the ADC result register because the transfers will be done by DMA.
- * The ADC readings are stored in the ADC_Results[] array inside the dma.c driver.
+ * The ADC readings are stored in the ADC_Results[] array inside the dma.c driver, which is used as a
+ * ping-pong buffer: the DMA fills one half while main() reads the other, so sampling never stops.
+ * FLEXSCAN_MODE selects other scans of the same kind:
+ *  - FLEXSCAN_MODE_DUAL splits the channel list DUAL_list across ADC0 and ADC1 (adc_dual.c): PDB0 and
+ *    PDB1 are started by the same TRGMUX edge and their DMA requests merge both converters' results
+ *    into one frame per period in DUAL_Frames.
+ *  - FLEXSCAN_MODE_SEQ scans the 24 entries of SEQ_list 10000 times per second (adc_seq.c), each with its
+ *    own sample time, into the channel-major matrix SEQ_Results without CPU. Entry 0 is a slow channel:
+ *    adc_decim.c turns its 10 kHz samples into 14-bit values at 312.5 Hz in SEQ_Slow.
+ *  - FLEXSCAN_MODE_MONITOR watches the 8 entries of MON_list 1000 times per second with the ADC compare
+ *    function (adc_monitor.c): only results outside their window reach the DMA, which interrupts the CPU
+ *    once per 16 of them.
  * */
 
 #include "device_registers.h"
@@ -44,6 +55,63 @@
 #include "clocks_and_modes.h"
 #include "pdb.h"
 #include "ADC.h"
+#include "profile.h"
+#include "adc_dual.h"
+#include "adc_seq.h"
+#include "adc_decim.h"
+#include "adc_monitor.h"
+
+#define FLEXSCAN_MODE_SINGLE	0u		/* ADC_SC1A_CH rewritten by a linked DMA channel */
+#define FLEXSCAN_MODE_DUAL		1u		/* DUAL_list on ADC0 and ADC1 */
+#define FLEXSCAN_MODE_SEQ		2u		/* SEQ_list by the channel sequencer */
+#define FLEXSCAN_MODE_MONITOR	3u		/* MON_list limit monitoring */
+#define FLEXSCAN_MODE			FLEXSCAN_MODE_SINGLE
+
+#define DUAL_DMA_CH				2u		/* DMA channels 2 (ADC0) and 3 (ADC1) */
+#define DUAL_FRAMES_PER_HALF	4u
+#define SEQ_DMA_CH				4u		/* DMA channels 4 (results), 5 (commands) and 6 (columns) */
+#define SEQ_SCANS_PER_HALF		10u
+#define SEQ_CHANNELS			24u
+#define MON_DMA_CH				7u		/* DMA channels 7 (limits), 8 (channel) and 9 (events) */
+#define MON_CHANNELS			8u
+
+enum
+{
+	PROFILE_DMA0_ISR		/* DMA0_IRQHandler cost */
+};
+
+const char * const PROFILE_names[] = { "DMA0_IRQHandler" };
+
+DMA_PingPong_t ADC_Stream;						/* Halves of ADC_Results ready, overrun counter */
+uint32_t ADC_Last[FLEXSCAN_CHANNELS];			/* Last result of each channel of ADC_SC1A_CH */
+
+#if FLEXSCAN_MODE == FLEXSCAN_MODE_DUAL
+/* First entry wired to ADC0 only, the others are split across both converters */
+const uint8_t DUAL_list[] = { 12u | ADC_DUAL_ADC0, 0u, 1u, 2u, 3u, 4u, 5u };
+ADC_Dual_t ADC_Dual;
+uint32_t volatile DUAL_Frames[2u * DUAL_FRAMES_PER_HALF * ADC_DUAL_PER_ADC];
+uint16_t DUAL_Last[sizeof(DUAL_list)];			/* Last result of each entry of DUAL_list */
+#elif FLEXSCAN_MODE == FLEXSCAN_MODE_SEQ
+/* ADC0 inputs 0-15 and 32-39, the high impedance ones (0, 32) sampled longer */
+const ADC_Seq_Channel_t SEQ_list[SEQ_CHANNELS] = {
+	{  0, 64 }, {  1, 13 }, {  2, 13 }, {  3, 13 }, {  4, 13 }, {  5, 13 }, {  6, 13 }, {  7, 13 },
+	{  8, 13 }, {  9, 13 }, { 10, 13 }, { 11, 13 }, { 12, 13 }, { 13, 13 }, { 14, 13 }, { 15, 13 },
+	{ 32, 64 }, { 33, 13 }, { 34, 13 }, { 35, 13 }, { 36, 13 }, { 37, 13 }, { 38, 13 }, { 39, 13 } };
+ADC_Seq_t ADC_Seq;
+uint32_t volatile SEQ_Results[2u * SEQ_SCANS_PER_HALF * SEQ_CHANNELS];
+uint32_t SEQ_Sum[SEQ_CHANNELS];					/* Sum of each channel over the last half */
+const int16_t SEQ_Lowpass[16] = ADC_DECIM_LOWPASS_4;
+ADC_Decim_t SEQ_Slow_Filter;					/* Entry 0: boxcar of 8, FIR decimation by 4 */
+uint16_t SEQ_Slow;								/* Last 14-bit value of entry 0 */
+#elif FLEXSCAN_MODE == FLEXSCAN_MODE_MONITOR
+/* Supply and temperature health inputs, in ADC counts (12-bit, 5 V) */
+const ADC_Monitor_Channel_t MON_list[MON_CHANNELS] = {
+	{ 0, 3030, 3522 }, { 1, 1925, 2170 }, { 2, 1269, 1433 }, { 3, 737, 901 },
+	{ 4,  400, 3600 }, { 5,  400, 3600 }, { 6,    0, 2458 }, { 7,   0, 2458 } };
+ADC_Monitor_t ADC_Monitor;
+uint32_t MON_Alarms[MON_CHANNELS];				/* Out-of-window results per entry */
+ADC_Monitor_Event_t MON_Last;					/* Last out-of-window result */
+#endif
 
 void WDOG_disable (void)
 {
@@ -58,24 +126,110 @@ int main(void)
 	SOSC_init_8MHz();      			/* Initialize system oscillator for 8 MHz xtal */
 	SPLL_init_160MHz();    			/* Initialize SPLL to 160 MHz with 8 MHz SOSC */
 	NormalRUNmode_80MHz();			/* Init clocks: 80 MHz sysclk & core, 40 MHz bus, 20 MHz flash */
+	PROFILE_init(PROFILE_names, 1);	/* Start the DWT cycle counter */
+#if FLEXSCAN_MODE == FLEXSCAN_MODE_DUAL
+	if (ADC_Dual_plan(&ADC_Dual, DUAL_list, sizeof(DUAL_list))) {
+		ADC_Dual_init(&ADC_Dual, DUAL_Frames, DUAL_FRAMES_PER_HALF, DUAL_DMA_CH);
+		ADC_Dual_start(&ADC_Dual, 100, 1, 40);	/* Frame every 100 us, results collected at 40 us */
+	}
+#elif FLEXSCAN_MODE == FLEXSCAN_MODE_SEQ
+	ADC_Decim_init(&SEQ_Slow_Filter, 3, SEQ_Lowpass, 16, 4, 14);
+	if (ADC_Seq_init(&ADC_Seq, SEQ_list, SEQ_CHANNELS, SEQ_SCANS_PER_HALF, SEQ_Results, SEQ_DMA_CH)) {
+		ADC_Seq_start(&ADC_Seq, 10000);	/* 24 channels at 10 kHz */
+	}
+#elif FLEXSCAN_MODE == FLEXSCAN_MODE_MONITOR
+	if (ADC_Monitor_init(&ADC_Monitor, MON_list, MON_CHANNELS, MON_DMA_CH)) {
+		ADC_Monitor_start(&ADC_Monitor, 1000);	/* Every input checked each ms */
+	}
+#else
 	ADC_FlexScan_Config();			/* Initialize ADC0 CH0 with HW Trigger and DMA Request */
 	DMAMUX_FlexScan_init();			/* Initialize DMA to take requests from ADC0	*/
-	DMA_TCD_FlexScan_Config();		/* Set up TCD CH0 to save measurements from ADC0 and link to CH1 to change ADC0 channel to measure */
+	DMA_TCD_FlexScan_Config(&ADC_Stream);	/* Set up TCD CH0 to save measurements from ADC0 and link to CH1 to change ADC0 channel to measure */
 	DMA->SERQ = DMA_SERQ_SERQ(0);	/* Enable Requests for DMA Channel 0 */
 
 	PDB_FlexScan_Config();			/* Configure PDB to trigger ADC0 every second */
 
 	S32_NVIC->ISER[0/32] |= 1<<(0%32);	/*	Enable interruption for DMA CH0	*/
+#endif
+
+        for(;;) {
+#if FLEXSCAN_MODE == FLEXSCAN_MODE_DUAL
+			volatile uint32_t * half = ADC_Dual_Get(&ADC_Dual);
+
+			if (half != NULL) {
+				uint8_t i;
+				for (i = 0; i < sizeof(DUAL_list); i++) {
+					DUAL_Last[i] = ADC_Dual_result(&ADC_Dual, &half[(DUAL_FRAMES_PER_HALF - 1) * ADC_Dual.width], i);
+				}
+				ADC_Dual_Release(&ADC_Dual);	/* Both sides of the half can be filled again */
+			}
+#elif FLEXSCAN_MODE == FLEXSCAN_MODE_SEQ
+			volatile uint32_t * half = ADC_Seq_Get(&ADC_Seq);
 
-        for(;;) {       
+			if (half != NULL) {
+				uint16_t slow[SEQ_SCANS_PER_HALF / 32u + 1u];
+				uint8_t e, r;
+				if (ADC_Decim_run(&SEQ_Slow_Filter, ADC_Seq_row(&ADC_Seq, half, 0), SEQ_SCANS_PER_HALF, slow) != 0u) {
+					SEQ_Slow = slow[0];		/* At most one output per half */
+				}
+				for (e = 0; e < SEQ_CHANNELS; e++) {
+					const volatile uint32_t * row = ADC_Seq_row(&ADC_Seq, half, e);	/* Consecutive scans of entry e */
+					SEQ_Sum[e] = 0;
+					for (r = 0; r < SEQ_SCANS_PER_HALF; r++) {
+						SEQ_Sum[e] += row[r];
+					}
+				}
+				ADC_Seq_Release(&ADC_Seq);	/* Half can be filled again */
+			}
+#elif FLEXSCAN_MODE == FLEXSCAN_MODE_MONITOR
+			while (ADC_Monitor_Get(&ADC_Monitor, &MON_Last)) {
+				uint8_t e;
+				for (e = 0; e < MON_CHANNELS; e++) {
+					if (MON_list[e].adch == (MON_Last.sc1 & ADC_SC1_ADCH_MASK)) {
+						MON_Alarms[e]++;
+					}
+				}
+			}
+#else
+			volatile uint32_t * half = DMA_PingPong_Get(&ADC_Stream);
 
+			if (half != NULL) {
+				uint8_t ch;
+				for (ch = 0; ch < FLEXSCAN_CHANNELS; ch++) {
+					ADC_Last[ch] = half[(FLEXSCAN_SCANS_PER_HALF - 1) * FLEXSCAN_CHANNELS + ch];	/* Last scan of the half */
+				}
+				DMA_PingPong_Release(&ADC_Stream);	/* Half can be filled again */
+			}
+#endif
         }
 
 	return 0;
 }
 
 void DMA0_IRQHandler (void) {
-	DMA->CDNE = DMA_CDNE_CDNE(0);	/* Clear Done Status Flag of DMA Channel 0 */
-	DMA->CINT = DMA_CINT_CINT(0);	/* Clear Interruption request flag of DMA Channel 0 */
-	PDB0->SC &=~ PDB_SC_PDBEN_MASK;	/* Turn off PDB to stop getting samples after DMA CH0 major loop */
+	PROFILE_ISR_ENTER(PROFILE_DMA0_ISR);
+	DMA_PingPong_IRQHandler(&ADC_Stream);	/* One half of ADC_Results is ready, PDB keeps running */
+	PROFILE_ISR_EXIT(PROFILE_DMA0_ISR);
+}
+
+#if FLEXSCAN_MODE == FLEXSCAN_MODE_DUAL
+void DMA2_IRQHandler (void) {
+	ADC_Dual_IRQHandler(&ADC_Dual, 0);		/* ADC0 side of DUAL_Frames */
+}
+
+void DMA3_IRQHandler (void) {
+	ADC_Dual_IRQHandler(&ADC_Dual, 1);		/* ADC1 side of DUAL_Frames */
+}
+#endif
+
+#if FLEXSCAN_MODE == FLEXSCAN_MODE_SEQ
+void DMA6_IRQHandler (void) {
+	ADC_Seq_IRQHandler(&ADC_Seq);			/* Half of SEQ_Results completed */
+}
+#endif
+
+#if FLEXSCAN_MODE == FLEXSCAN_MODE_MONITOR
+void DMA9_IRQHandler (void) {
+	ADC_Monitor_IRQHandler(&ADC_Monitor);	/* Event ring wrapped */
 }
+#endif
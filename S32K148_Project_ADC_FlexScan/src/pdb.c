@@ -62,62 +62,64 @@ void PDB0_init(void)
 
 }
 
-/*!	PDB0 configuration for a period of 1s
- * 		PDB0 Period = (Sys. Clock / (Prescaler * Mult factor)) / Counts
- * 		PDB0 Period = 1s
- * 		Delay = 500ms
- * 	Channel 4 is triggered at delay complete, and channel 5, 6, 7 are in
- * 	Back-to-Back mode (wait for n+1 channel to be completed to start n
- * 	channel)
+/*!	PDB0 configuration for a period of 600 ms
+ * 	Channel 2 is triggered 300 ms after the period start, and channel 3, 4, 5 are in
+ * 	Back-to-Back mode (wait for n-1 channel to be completed to start n
+ * 	channel). Conversions of 3.75 us: 10 + 20 ADC clocks of SOSCDIV2 (ADC_Config).
+ * 	PDB_Sched_compile picks the prescaler and computes MOD and DLY; PDB0 is left
+ * 	disabled if the schedule does not compile and its status is returned.
  */
-void PDB_Config(void){
-	PCC->PCCn[PCC_PDB0_INDEX] &=~ PCC_PCCn_CGC_MASK;	/* Enable clock for PDB */
-	PCC->PCCn[PCC_PDB0_INDEX] |= PCC_PCCn_PCS(0b001);	/* Enable clock for PDB */
-	PCC->PCCn[PCC_PDB0_INDEX] |= PCC_PCCn_CGC_MASK;		/* Enable clock for PDB */
-
-
-	PDB0->SC = PDB_SC_PRESCALER(0b111)| /* Prescaler = 128 */
-			   PDB_SC_TRGSEL(15)|		/* Software trigger selected */
-			   PDB_SC_MULT(0b10)|		/* Mult factor = 20 */
-			   PDB_SC_CONT_MASK;		/* Continuous mode Enable */
-	PDB0->MOD = 18750;					/* Counts */
-
-	PDB0->CH[0].C1 = (PDB_C1_BB(0xE0)| 	/* Back-to-back for pre-triggers 5/6/7 (wait for channel 4 to be finish)*/
-					  PDB_C1_TOS(0x10)| /* Trigger channel 4 when delay is complete */
-					  PDB_C1_EN(0xF0));	/* Triggers 4/5/6/7 enabled */
-	PDB0->CH[0].DLY[4] = 9375;			/* Delay set to half of the period */
-
-	PDB0->SC |= PDB_SC_PDBEN_MASK|	/* Enable PDB */
-				PDB_SC_LDOK_MASK;	/* Load MOD and DLY */
-
-	PDB0->SC |= PDB_SC_SWTRIG_MASK; /* Software Initial PDB trigger */
+PDB_Sched_Status_t PDB_Config(void){
+	PDB_Schedule_t sched = { 0 };
+	PDB_Program_t prog;
+	PDB_Sched_Status_t status;
+	uint8_t m;
+
+	sched.period_ns  = 600000000u;		/* 600 ms */
+	sched.trgsel     = 15u;				/* Software trigger selected */
+	sched.continuous = 1u;				/* Continuous mode Enable */
+	sched.pt[0][2].mode = PDB_SCHED_AT;
+	sched.pt[0][2].delay_ns = 300000000u;	/* Half of the period */
+	for (m = 2; m <= 5u; m++)
+	{
+		if (m != 2u)
+		{
+			sched.pt[0][m].mode = PDB_SCHED_BACK_TO_BACK;	/* Wait for channel m - 1 to finish */
+		}
+		sched.pt[0][m].conversion_ns = 3750u;
+	}
+
+	status = PDB_Sched_compile(&sched, &prog);
+	DEV_ASSERT(status == PDB_SCHED_OK);
+	if (status == PDB_SCHED_OK)
+	{
+		PDB_Sched_load(PDB0, &prog);	/* Enable PDB, Software Initial PDB trigger */
+	}
+	return status;
 }
 
 /*!	PDB0 configuration for a period of 1s
- * 		PDB0 Period = (Sys. Clock / (Prescaler * Mult factor)) / Counts
- * 		PDB0 Period = 2s
- * 		Delay = 1s
- * 	Channel 0 is triggered at delay complete.
+ * 	Channel 0 is triggered 500 ms after the period start. Conversions of 33 us:
+ * 	13 + 20 ADC clocks of SOSCDIV2 / 8 (ADC_FlexScan_Config). Returns the status of
+ * 	PDB_Sched_compile, PDB0 is only enabled with PDB_SCHED_OK.
  */
-void PDB_FlexScan_Config(void){
-	PCC->PCCn[PCC_PDB0_INDEX] &=~ PCC_PCCn_CGC_MASK;	/* Enable clock for PDB */
-	PCC->PCCn[PCC_PDB0_INDEX] |= PCC_PCCn_PCS(0b001);	/* Enable clock for PDB */
-	PCC->PCCn[PCC_PDB0_INDEX] |= PCC_PCCn_CGC_MASK;		/* Enable clock for PDB */
-
-
-	PDB0->SC = PDB_SC_PRESCALER(0b111)| /* Prescaler = 128 */
-			   PDB_SC_TRGSEL(15)|		/* Software trigger selected */
-			   PDB_SC_MULT(0b10)|		/* Mult factor = 20 */
-			   PDB_SC_CONT_MASK;		/* Continuous mode Enable */
-	PDB0->MOD = 31250;					/* Counts */
-
-	PDB0->CH[0].C1 =  PDB_C1_TOS(1)| /* Trigger channel 0 when delay is complete */
-					  PDB_C1_EN(0x01);	/* Trigger 0 enabled */
-	PDB0->CH[0].DLY[0] = 15625;			/* Delay set to half of the period */
-
-	PDB0->SC |= PDB_SC_PDBEN_MASK|	/* Enable PDB */
-				PDB_SC_LDOK_MASK;	/* Load MOD and DLY */
-
-	PDB0->SC |= PDB_SC_SWTRIG_MASK; /* Software Initial PDB trigger */
+PDB_Sched_Status_t PDB_FlexScan_Config(void){
+	PDB_Schedule_t sched = { 0 };
+	PDB_Program_t prog;
+	PDB_Sched_Status_t status;
+
+	sched.period_ns  = 1000000000u;		/* 1 s */
+	sched.trgsel     = 15u;				/* Software trigger selected */
+	sched.continuous = 1u;				/* Continuous mode Enable */
+	sched.pt[0][0].mode = PDB_SCHED_AT;
+	sched.pt[0][0].delay_ns = 500000000u;	/* Half of the period */
+	sched.pt[0][0].conversion_ns = 33000u;
+
+	status = PDB_Sched_compile(&sched, &prog);
+	DEV_ASSERT(status == PDB_SCHED_OK);
+	if (status == PDB_SCHED_OK)
+	{
+		PDB_Sched_load(PDB0, &prog);	/* Enable PDB, Software Initial PDB trigger */
+	}
+	return status;
 }
-
@@ -34,9 +34,10 @@
 #define DRIVERS_PDB_PDB_H_
 
 #include "device_registers.h"
+#include "pdb_schedule.h"
 
 void PDB0_init(void);
-void PDB_Config(void);
-void PDB_FlexScan_Config(void);
+PDB_Sched_Status_t PDB_Config(void);
+PDB_Sched_Status_t PDB_FlexScan_Config(void);
 
 #endif /* DRIVERS_PDB_PDB_H_ */
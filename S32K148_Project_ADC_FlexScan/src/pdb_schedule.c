@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"	/* include peripheral declarations */
+#include "pdb_schedule.h"
+
+/*!
+ * PDB schedule compiler
+ * ===================================================
+ * PDB_Sched_compile turns a schedule in ns into register values:
+ *  - Counter clock: every PRESCALER x MULT divider that holds the period in MOD, and the delays
+ *    and IDLY below it in 16 bits, is tried, and the one whose counts round the period, the
+ *    delays and IDLY the least wins. Ties go to the
+ *    finer resolution. That is the residual jitter of the sample instants against the trigger.
+ *  - Pre-triggers: TOS at DLYm, or BB, chained in the ring CH0 0-7, CH1 0-7, back to CH0 0.
+ *  - Verification: the conversions are replayed in time with the programmed counts. A
+ *    pre-trigger that would start while the ADC is still converting (a PDB sequence error), a
+ *    broken back-to-back chain or conversions running past the period are reported.
+ * PDB_Sched_load writes the result, so no MOD or DLY value is computed by hand.
+ */
+
+static const uint8_t PDB_Sched_mult[4] = { 1u, 10u, 20u, 40u };		/* SC[MULT] encoding */
+
+/*!
+* @brief Counts of ns at a divider, rounded to the nearest.
+*/
+static inline uint32_t PDB_Sched_ticks(uint32_t ns, uint32_t divider)
+{
+	uint64_t den = (uint64_t)divider * 1000000000u;
+
+	return (uint32_t)(((uint64_t)ns * PDB_SCHED_CLOCK_HZ + den / 2u) / den);
+}
+
+/*!
+* @brief ns of counts at a divider, rounded to the nearest.
+*/
+static inline uint32_t PDB_Sched_ns(uint32_t ticks, uint32_t divider)
+{
+	return (uint32_t)(((uint64_t)ticks * divider * 1000000000u + PDB_SCHED_CLOCK_HZ / 2u) / PDB_SCHED_CLOCK_HZ);
+}
+
+/*!
+* @brief Rounding error of ns at a divider, in ps.
+*/
+static uint32_t PDB_Sched_error_ps(uint32_t ns, uint32_t divider)
+{
+	uint64_t programmed = (uint64_t)PDB_Sched_ticks(ns, divider) * divider * 1000000u / (PDB_SCHED_CLOCK_HZ / 1000000u);
+	uint64_t requested = (uint64_t)ns * 1000u;
+
+	return (uint32_t)((programmed > requested) ? (programmed - requested) : (requested - programmed));
+}
+
+/*!
+* @brief Compile a schedule into PDB register values and check its timing.
+*
+* @param[const PDB_Schedule_t * sched] Schedule
+* @param[PDB_Program_t * prog] Register values, tick, rounding error and conversion instants
+* @return PDB_SCHED_OK or the first problem found, prog is only complete with PDB_SCHED_OK
+*/
+PDB_Sched_Status_t PDB_Sched_compile(const PDB_Schedule_t * sched, PDB_Program_t * prog)
+{
+	uint32_t end_ns[PDB_SCHED_PRETRIGGERS];
+	uint8_t known[PDB_SCHED_PRETRIGGERS];
+	uint32_t best_error = UINT32_MAX;
+	uint32_t divider = 0;
+	uint32_t period, period_ns, last;
+	uint8_t best_p = 0, best_m = 0;
+	uint8_t p, m, i, pass, ch;
+
+	if ((sched->period_ns == 0u) || (sched->idly_ns >= sched->period_ns))
+	{
+		return PDB_SCHED_RANGE;
+	}
+	for (i = 0; i < PDB_SCHED_PRETRIGGERS; i++)
+	{
+		const PDB_Sched_Pretrigger_t * pt = &sched->pt[i / PDB_DLY_COUNT][i % PDB_DLY_COUNT];
+
+		if ((pt->mode == PDB_SCHED_AT) && (pt->delay_ns >= sched->period_ns))
+		{
+			return PDB_SCHED_RANGE;
+		}
+	}
+
+	/* Counter clock with the least rounding of all programmed instants */
+	for (p = 0; p < 8u; p++)
+	{
+		for (m = 0; m < 4u; m++)
+		{
+			uint32_t d = (1u << p) * PDB_Sched_mult[m];
+			uint32_t ticks = PDB_Sched_ticks(sched->period_ns, d);
+			uint32_t limit;
+			uint32_t error;
+			uint8_t fits = 1;
+
+			if ((ticks == 0u) || (ticks > 0x10000u))
+			{
+				continue;
+			}
+			limit = ticks - 1u;							/* DLY and IDLY within MOD (16 bits)... */
+			if (!sched->continuous && (limit > 0xFFFEu))
+			{
+				limit = 0xFFFEu;						/* ...and one-shot MOD = last + 1 too */
+			}
+			error = PDB_Sched_error_ps(sched->period_ns, d);
+			if (sched->idly_ns != 0u)
+			{
+				uint32_t e = PDB_Sched_error_ps(sched->idly_ns, d);
+				error = (e > error) ? e : error;
+				fits = (PDB_Sched_ticks(sched->idly_ns, d) <= limit) ? fits : 0u;
+			}
+			for (i = 0; i < PDB_SCHED_PRETRIGGERS; i++)
+			{
+				const PDB_Sched_Pretrigger_t * pt = &sched->pt[i / PDB_DLY_COUNT][i % PDB_DLY_COUNT];
+
+				if (pt->mode == PDB_SCHED_AT)
+				{
+					uint32_t e = PDB_Sched_error_ps(pt->delay_ns, d);
+					error = (e > error) ? e : error;
+					fits = (PDB_Sched_ticks(pt->delay_ns, d) <= limit) ? fits : 0u;
+				}
+			}
+			if (!fits)
+			{
+				continue;								/* A delay rounds up to the period */
+			}
+			if ((error < best_error) || ((error == best_error) && (d < divider)))
+			{
+				best_error = error;
+				divider = d;
+				best_p = p;
+				best_m = m;
+			}
+		}
+	}
+	if (divider == 0u)
+	{
+		return PDB_SCHED_RANGE;
+	}
+	period    = PDB_Sched_ticks(sched->period_ns, divider);
+	period_ns = PDB_Sched_ns(period, divider);
+
+	prog->sc = PDB_SC_PRESCALER(best_p) | PDB_SC_MULT(best_m) | PDB_SC_TRGSEL(sched->trgsel) |
+			   PDB_SC_CONT(sched->continuous ? 1u : 0u) | sched->flags;
+	prog->idly     = (sched->idly_ns != 0u) ? PDB_Sched_ticks(sched->idly_ns, divider) : 0xFFFFu;
+	prog->tick_ps  = (uint32_t)((uint64_t)divider * 1000000u / (PDB_SCHED_CLOCK_HZ / 1000000u));
+	prog->error_ns = (best_error + 500u) / 1000u;
+	last = (sched->idly_ns != 0u) ? prog->idly : 0u;
+
+	/* Pre-trigger registers; the instants of the TOS ones are known */
+	for (i = 0; i < PDB_SCHED_PRETRIGGERS; i++)
+	{
+		const PDB_Sched_Pretrigger_t * pt = &sched->pt[i / PDB_DLY_COUNT][i % PDB_DLY_COUNT];
+		uint32_t bit = 1u << (i % PDB_DLY_COUNT);
+		uint32_t dly = 0;
+
+		ch = (uint8_t)(i / PDB_DLY_COUNT);
+		if (i % PDB_DLY_COUNT == 0u)
+		{
+			prog->c1[ch] = 0;
+		}
+		known[i] = 0;
+		if (pt->mode == PDB_SCHED_AT)
+		{
+			dly = PDB_Sched_ticks(pt->delay_ns, divider);
+			prog->c1[ch] |= PDB_C1_EN(bit) | PDB_C1_TOS(bit);
+			prog->start_ns[ch][i % PDB_DLY_COUNT] = PDB_Sched_ns(dly, divider);
+			end_ns[i] = prog->start_ns[ch][i % PDB_DLY_COUNT] + pt->conversion_ns;
+			known[i] = 1;
+			last = (dly > last) ? dly : last;
+		}
+		else if (pt->mode == PDB_SCHED_BACK_TO_BACK)
+		{
+			const PDB_Sched_Pretrigger_t * prev = &sched->pt[((i + PDB_SCHED_PRETRIGGERS - 1u) % PDB_SCHED_PRETRIGGERS) / PDB_DLY_COUNT]
+															[((i + PDB_SCHED_PRETRIGGERS - 1u) % PDB_SCHED_PRETRIGGERS) % PDB_DLY_COUNT];
+			if (prev->mode == PDB_SCHED_OFF)
+			{
+				return PDB_SCHED_CHAIN;
+			}
+			prog->c1[ch] |= PDB_C1_EN(bit) | PDB_C1_BB(bit);
+		}
+		prog->dly[ch][i % PDB_DLY_COUNT] = dly;
+	}
+
+	/* Back-to-back pre-triggers start when their predecessor's conversion ends */
+	for (pass = 0; pass < PDB_SCHED_PRETRIGGERS; pass++)
+	{
+		for (i = 0; i < PDB_SCHED_PRETRIGGERS; i++)
+		{
+			uint8_t prev = (uint8_t)((i + PDB_SCHED_PRETRIGGERS - 1u) % PDB_SCHED_PRETRIGGERS);
+
+			if (!known[i] && known[prev] && (sched->pt[i / PDB_DLY_COUNT][i % PDB_DLY_COUNT].mode == PDB_SCHED_BACK_TO_BACK))
+			{
+				prog->start_ns[i / PDB_DLY_COUNT][i % PDB_DLY_COUNT] = end_ns[prev];
+				end_ns[i] = end_ns[prev] + sched->pt[i / PDB_DLY_COUNT][i % PDB_DLY_COUNT].conversion_ns;
+				known[i] = 1;
+			}
+		}
+	}
+
+	/* One ADC: each conversion must start after the previous one in time has ended */
+	prog->busy_ns = 0;
+	for (i = 0; i < PDB_SCHED_PRETRIGGERS; i++)
+	{
+		uint8_t j;
+
+		if (sched->pt[i / PDB_DLY_COUNT][i % PDB_DLY_COUNT].mode == PDB_SCHED_OFF)
+		{
+			continue;
+		}
+		if (!known[i])
+		{
+			return PDB_SCHED_CHAIN;						/* Back-to-back ring without a TOS start */
+		}
+		for (j = 0; j < PDB_SCHED_PRETRIGGERS; j++)
+		{
+			uint32_t start_i = prog->start_ns[i / PDB_DLY_COUNT][i % PDB_DLY_COUNT];
+			uint32_t start_j = prog->start_ns[j / PDB_DLY_COUNT][j % PDB_DLY_COUNT];
+
+			if ((j != i) && known[j] && (start_j <= start_i) && (start_i < end_ns[j]) &&
+				((start_j < start_i) || (j < i)))
+			{
+				return PDB_SCHED_OVERLAP;
+			}
+		}
+		prog->busy_ns = (end_ns[i] > prog->busy_ns) ? end_ns[i] : prog->busy_ns;
+	}
+	if (prog->busy_ns > period_ns)
+	{
+		return PDB_SCHED_LATE;
+	}
+
+	/* Continuous: MOD is the period. One-shot: the counter stops after the last event and the
+	 * next trigger restarts it */
+	prog->mod = sched->continuous ? (period - 1u) : (last + 1u);
+	return PDB_SCHED_OK;
+}
+
+/*!
+* @brief Program a PDB with a compiled schedule and enable it; a software-triggered schedule
+* is started.
+*
+* @param[PDB_Type * pdb] PDB0 or PDB1
+* @param[const PDB_Program_t * prog] Result of PDB_Sched_compile
+*/
+void PDB_Sched_load(PDB_Type * pdb, const PDB_Program_t * prog)
+{
+	uint8_t ch, m;
+
+	PCC->PCCn[(pdb == PDB0) ? PCC_PDB0_INDEX : PCC_PDB1_INDEX] |= PCC_PCCn_CGC_MASK;	/* Enable clock for PDB */
+
+	pdb->SC   = prog->sc;							/* PDBEN = 0 while reprogramming */
+	pdb->MOD  = prog->mod;
+	pdb->IDLY = prog->idly;
+	for (ch = 0; ch < PDB_CH_COUNT; ch++)
+	{
+		pdb->CH[ch].C1 = prog->c1[ch];
+		for (m = 0; m < PDB_DLY_COUNT; m++)
+		{
+			pdb->CH[ch].DLY[m] = prog->dly[ch][m];
+		}
+	}
+	pdb->SC |= PDB_SC_PDBEN_MASK |					/* Enable PDB */
+			   PDB_SC_LDOK_MASK;					/* Load MOD, IDLY and DLY */
+
+	if (((prog->sc & PDB_SC_TRGSEL_MASK) >> PDB_SC_TRGSEL_SHIFT) == 15u)
+	{
+		pdb->SC |= PDB_SC_SWTRIG_MASK;				/* Software Initial PDB trigger */
+	}
+}
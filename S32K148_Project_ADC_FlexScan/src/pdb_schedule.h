@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PDB_SCHEDULE_H_
+#define PDB_SCHEDULE_H_
+
+#include "device_registers.h"
+
+#define PDB_SCHED_CLOCK_HZ		80000000u	/* PDB counter clock, SYS_CLK of NormalRUNmode_80MHz (whole MHz) */
+#define PDB_SCHED_PRETRIGGERS	(PDB_CH_COUNT * PDB_DLY_COUNT)	/* CH0 0-7 then CH1 0-7: the back-to-back ring */
+
+/* Pre-trigger modes */
+#define PDB_SCHED_OFF			0u			/* Disabled */
+#define PDB_SCHED_AT			1u			/* At delay_ns from the trigger (TOS) */
+#define PDB_SCHED_BACK_TO_BACK	2u			/* When the conversion of the previous pre-trigger of the ring completes (BB) */
+
+typedef struct
+{
+	uint8_t mode;							/* PDB_SCHED_xxx */
+	uint32_t delay_ns;						/* PDB_SCHED_AT: from the trigger */
+	uint32_t conversion_ns;					/* ADC time of the conversion it starts, for the timing checks */
+}PDB_Sched_Pretrigger_t;
+
+/* What a PDB must do in one period, in ns from its trigger. With a hardware trigger in one-shot
+ * mode every trigger restarts the schedule, so the samples stay locked to the trigger source
+ * (e.g. the FTM initialization trigger at each PWM period start) and never drift. */
+typedef struct
+{
+	uint32_t period_ns;						/* Continuous: counter period; one-shot: trigger period */
+	uint32_t idly_ns;						/* PDBIF (interrupt or DMA request), 0: not used */
+	uint32_t flags;							/* PDB_SC_PDBIE_MASK, PDB_SC_DMAEN_MASK, PDB_SC_PDBEIE_MASK as needed */
+	uint8_t trgsel;							/* PDB_SC_TRGSEL: 15 software, 0 TRGMUX */
+	uint8_t continuous;						/* 1: restart after each period, 0: wait for the next trigger */
+	PDB_Sched_Pretrigger_t pt[PDB_CH_COUNT][PDB_DLY_COUNT];
+}PDB_Schedule_t;
+
+/* Register values of a compiled schedule and what they achieve */
+typedef struct
+{
+	uint32_t sc;							/* PRESCALER, MULT, TRGSEL, CONT and flags (PDBEN, LDOK by PDB_Sched_load) */
+	uint32_t mod;
+	uint32_t idly;
+	uint32_t c1[PDB_CH_COUNT];
+	uint32_t dly[PDB_CH_COUNT][PDB_DLY_COUNT];
+	uint32_t tick_ps;						/* Counter resolution */
+	uint32_t error_ns;						/* Largest difference between a requested and a programmed instant */
+	uint32_t start_ns[PDB_CH_COUNT][PDB_DLY_COUNT];	/* Conversion start of each enabled pre-trigger */
+	uint32_t busy_ns;						/* End of the last conversion */
+}PDB_Program_t;
+
+typedef enum
+{
+	PDB_SCHED_OK = 0,
+	PDB_SCHED_RANGE,						/* Period or delay out of the counter range */
+	PDB_SCHED_CHAIN,						/* Back-to-back pre-trigger without an enabled predecessor */
+	PDB_SCHED_OVERLAP,						/* Pre-trigger while the ADC still converts: sequence error */
+	PDB_SCHED_LATE							/* Conversions not over at the end of the period */
+}PDB_Sched_Status_t;
+
+PDB_Sched_Status_t PDB_Sched_compile(const PDB_Schedule_t * sched, PDB_Program_t * prog);
+void PDB_Sched_load(PDB_Type * pdb, const PDB_Program_t * prog);
+
+/*!
+* @brief Delay that centers the sample phase of a conversion on an instant, e.g. the center
+* of a center-aligned PWM period (half the period from the FTM initialization trigger).
+*
+* @param[uint32_t center_ns] Instant to sample, from the PDB trigger
+* @param[uint32_t sample_ns] Sample phase of the conversion (SMPLTS + 1 ADC clocks)
+*/
+static inline uint32_t PDB_Sched_centered(uint32_t center_ns, uint32_t sample_ns)
+{
+	return center_ns - sample_ns / 2u;
+}
+
+#endif /* PDB_SCHEDULE_H_ */
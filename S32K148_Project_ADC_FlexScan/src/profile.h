@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include "device_registers.h"
+
+/*!
+ * Description:
+ * =============================================================================================
+ * Cycle counter instrumentation. Each profiled section or handler owns an entry of PROFILE_Table
+ * that keeps the number of samples, min/max/total cycles and a log2 histogram (bin n counts the
+ * samples of 2^n to 2^(n+1)-1 cycles). PROFILE_begin/PROFILE_end bracket the measured code; the
+ * cost of the markers themselves is measured by PROFILE_init and removed from every sample.
+ *
+ * Interrupt latency is measured with a second entry: PROFILE_begin where the event is armed
+ * (DMA request enabled, frame queued...) and PROFILE_end as the first statement of the handler.
+ *
+ * On the S32K148 the time base is the DWT cycle counter (core clock). On a Linux host build the
+ * same API is backed by clock_gettime(CLOCK_MONOTONIC) scaled to PROFILE_CORE_CLOCK_HZ, so the
+ * reports read the same. The host clock measures the code as the host runs it: compute sections
+ * cost what they cost on the host CPU, and each register access in S32K148_Host_Sim adds the
+ * trap round trip (microseconds). The simulated time of S32K148_Host_Sim (SIM_cycles, printed
+ * in the simulator report) is the other way round: register accesses and peripheral waits are
+ * counted in bus cycles, code running from RAM costs nothing. Neither is the target timing;
+ * compare host profiles between paths of similar register traffic only.
+ */
+
+#define PROFILE_ENTRIES			(8u)				/* Entries of PROFILE_Table */
+#define PROFILE_BINS			(32u)				/* log2 histogram bins */
+#define PROFILE_CORE_CLOCK_HZ	(80000000u)			/* CORE_CLK of NormalRUNmode_80MHz() */
+
+/* DWT and DEMCR registers (not part of S32K148.h) */
+#define PROFILE_DEMCR			(*(volatile uint32_t *)0xE000EDFCu)
+#define PROFILE_DEMCR_TRCENA	(1u << 24)
+#define PROFILE_DWT_CTRL		(*(volatile uint32_t *)0xE0001000u)
+#define PROFILE_DWT_CYCCNTENA	(1u << 0)
+#define PROFILE_DWT_CYCCNT		(*(volatile uint32_t *)0xE0001004u)
+
+typedef struct
+{
+	const char *name;					/* Label printed by PROFILE_report */
+	uint32_t start;						/* Time stamp of the last PROFILE_begin */
+	uint32_t count;						/* Number of samples */
+	uint32_t min;						/* Shortest sample in cycles */
+	uint32_t max;						/* Longest sample in cycles */
+	uint64_t total;						/* Sum of the samples, mean = total / count */
+	uint32_t hist[PROFILE_BINS];		/* hist[n]: samples of 2^n to 2^(n+1)-1 cycles */
+}PROFILE_Entry_t;
+
+extern PROFILE_Entry_t PROFILE_Table[PROFILE_ENTRIES];
+
+void PROFILE_init(const char * const names[], uint8_t count);
+void PROFILE_record(uint8_t id, uint32_t cycles);
+void PROFILE_report(void (*print)(char *));
+void PROFILE_reset(void);
+
+#if defined(__linux__)
+uint32_t PROFILE_now(void);
+#else
+/*!
+* @brief Current time stamp in core clock cycles.
+*/
+static inline uint32_t PROFILE_now(void)
+{
+	return PROFILE_DWT_CYCCNT;
+}
+#endif
+
+/*!
+* @brief Start a sample of entry id.
+*/
+static inline void PROFILE_begin(uint8_t id)
+{
+	PROFILE_Table[id].start = PROFILE_now();
+}
+
+/*!
+* @brief Close the sample of entry id opened by PROFILE_begin.
+*/
+static inline void PROFILE_end(uint8_t id)
+{
+	PROFILE_record(id, PROFILE_now() - PROFILE_Table[id].start);
+}
+
+/* Handler entry/exit hooks, first and last statement of an IRQHandler */
+#define PROFILE_ISR_ENTER(id)	PROFILE_begin(id)
+#define PROFILE_ISR_EXIT(id)	PROFILE_end(id)
+
+#endif /* PROFILE_H_ */
@@ -33,34 +33,383 @@
 #include "crc.h"
 #include "device_registers.h"
 
-#define POLY (0x04C11DB7)
+static const CRC_Algo_t *CRC_configured;		/*< Algorithm programmed in CTRL/GPOLY, NULL after CRC_init */
+static CRC_Stream_t *CRC_owner;					/*< Stream whose partial CRC is in the peripheral */
 
-uint32_t CRC_32bits_calculate(uint8_t *data, uint32_t size)
+/* DMA mode state, stream != NULL while the channel feeds the peripheral */
+static struct
+{
+	uint8_t ch;
+	CRC_Stream_t * volatile stream;
+	const uint8_t *rest;						/* Bytes fed by the handler after the major loop */
+	uint32_t rest_size;
+	CRC_DMA_Callback_t done;
+	void *arg;
+} CRC_dma;
+
+/* Bit reversal inside each byte, the inverse of CTRL[TOT] = 1 */
+static uint32_t CRC_bits_in_bytes(uint32_t value)
 {
-	/*! CRC-32 Algorithm: \n
-	 * polynomial = 0x04C11DB7 \n
-	 * seed = 0xFFFFFFFF \n
-	 * Bits in a byte are transposed for writes. \n
-	 * Both bits in bytes and bytes are transposed for read. \n
-	 * XOR on reading. \n
-	*/
+	uint32_t result = 0;
+	uint8_t  i;
+
+	for (i = 0; i < 32u; i++)
+	{
+		if (value & (1u << i))
+		{
+			result |= 1u << ((i & ~7u) + 7u - (i & 7u));
+		}
+	}
+	return result;
+}
 
+/*!
+* @brief Enable the CRC clock. The peripheral is programmed by the first calculation.
+*/
+void CRC_init(void)
+{
 	PCC->PCCn[PCC_CRC_INDEX] |= PCC_PCCn_CGC_MASK;	/* enable CRC clock */
+	CRC_configured = NULL;
+	CRC_owner = NULL;
+}
+
+/*!
+* @brief Program the algorithm if it changed and load a register (CRC_SW form) as the seed.
+*/
+static void CRC_HW_load(const CRC_Algo_t *algo, uint32_t crc)
+{
+	uint8_t  shift = (algo->width == 8u) ? 8u : 0u;	/* 8-bit CRC in DATAL[15:8] */
+	uint32_t seed;
+
+	if (CRC_configured != algo)
+	{
+		if (!(PCC->PCCn[PCC_CRC_INDEX] & PCC_PCCn_CGC_MASK))
+		{
+			CRC_init();
+		}
+		CRC->CTRL = ((algo->width == 32u) ? CRC_CTRL_TCRC(1) : 0u)	/* 32 or 16-bit CRC protocol */
+				  | (algo->reflect ? (CRC_CTRL_TOT(1)				/* Bits in a byte are transposed on writes */
+				  | CRC_CTRL_TOTR(2)) : 0u);						/* Both bits in bytes and bytes are transposed on reads */
+		CRC->GPOLY = algo->poly << shift;
+		CRC_configured = algo;
+	}
+
+	if (algo->reflect)								/* The seed is transposed as the data */
+	{
+		seed = CRC_bits_in_bytes(CRC_SW_reflect(crc, algo->width) << shift);
+	}
+	else
+	{
+		seed = (crc >> (32u - algo->width)) << shift;
+	}
+
+	CRC->CTRL |= CRC_CTRL_WAS_MASK;					/* Set CRC_CTRL[WAS] to program the seed value. */
+	CRC->DATAu.DATA = seed;
+	CRC->CTRL &= ~CRC_CTRL_WAS_MASK;				/* Clear CRC_CTRL[WAS] to start writing data values. */
+}
+
+/*!
+* @brief Feed a buffer: 32-bit writes, 8-bit writes for the unaligned head and the tail.
+*/
+static void CRC_HW_feed(const uint8_t *data, uint32_t size)
+{
+	for (; size && ((uint32_t)data & 3u); size--)	/* Head up to the word boundary */
+	{
+		CRC->DATAu.DATA_8.LL = *data++;
+	}
+	for (; size >= 4u; size -= 4u, data += 4)		/* First byte in memory first */
+	{
+		CRC->DATAu.DATA = __builtin_bswap32(*(const uint32_t *)data);	/* REV */
+	}
+	for (; size; size--)
+	{
+		CRC->DATAu.DATA_8.LL = *data++;
+	}
+}
+
+/*!
+* @brief Read the register back in the CRC_SW form.
+*/
+static uint32_t CRC_HW_store(const CRC_Algo_t *algo)
+{
+	uint32_t crc  = CRC->DATAu.DATA;
+	uint32_t mask = (algo->width == 32u) ? 0xFFFFFFFFu : ((1u << algo->width) - 1u);
+
+	if (algo->reflect)
+	{
+		return (crc >> ((algo->width == 32u) ? 0u : 16u)) & mask;	/* Transposed 16-bit register in DATAH */
+	}
+	return ((crc >> ((algo->width == 8u) ? 8u : 0u)) & mask) << (32u - algo->width);
+}
+
+/* Calls needing the peripheral wait for a DMA transfer in progress */
+static void CRC_HW_wait(void)
+{
+	while (CRC_dma.stream != NULL) {}
+}
+
+/* Save the partial CRC of the stream holding the peripheral */
+static void CRC_HW_release(void)
+{
+	CRC_HW_wait();
+	if (CRC_owner != NULL)
+	{
+		CRC_owner->crc = CRC_HW_store(CRC_owner->engine->algo);
+		CRC_owner = NULL;
+	}
+}
+
+/* Give the peripheral to a stream, its partial CRC as the seed */
+static void CRC_HW_acquire(CRC_Stream_t *stream)
+{
+	CRC_HW_wait();
+	if (CRC_owner != stream)
+	{
+		CRC_HW_release();
+		CRC_HW_load(stream->engine->algo, stream->crc);
+		CRC_owner = stream;
+	}
+}
+
+/*!
+* @brief CRC of one buffer on the CRC peripheral. A stream holding the peripheral is saved first.
+*
+* @param[const CRC_Algo_t *algo] Algorithm, 8, 16 or 32 bits
+* @param[const uint8_t *data] Buffer, any alignment
+* @param[uint32_t size] Bytes
+* @return CRC value
+*/
+uint32_t CRC_HW_calculate(const CRC_Algo_t *algo, const uint8_t *data, uint32_t size)
+{
+	CRC_HW_release();
+	CRC_HW_load(algo, CRC_SW_start(algo));
+	CRC_HW_feed(data, size);
+	return CRC_SW_finish(algo, CRC_HW_store(algo));
+}
+
+/*!
+* @brief Start a stream.
+*
+* @param[CRC_Stream_t *stream] Context, owned by the caller
+* @param[const CRC_Engine_t *engine] Engine of the algorithm
+* @param[CRC_Path_t path] CRC_HW or a software path, used by every CRC_update of the stream
+*/
+void CRC_begin(CRC_Stream_t *stream, const CRC_Engine_t *engine, CRC_Path_t path)
+{
+	CRC_HW_wait();
+	if (CRC_owner == stream)						/* Restarted without CRC_finish */
+	{
+		CRC_owner = NULL;
+	}
+	stream->engine = engine;
+	stream->path   = path;
+	stream->crc    = CRC_SW_start(engine->algo);
+	stream->length = 0;
+}
 
-	CRC->CTRL |= CRC_CTRL_TCRC(1);	/* enable 32-bit CRC protocol */
-	CRC->CTRL |= CRC_CTRL_TOT(1);	/* Bits in a byte are transposed, while bytes are not transposed. */
-	CRC->CTRL |= CRC_CTRL_TOTR(2);	/* Both bits in bytes and bytes are transposed. */
-	CRC->CTRL |= CRC_CTRL_FXOR(1);	/* XOR on reading. */
+/*!
+* @brief Add a buffer to a stream. On the peripheral, a stream switching in saves the partial
+* CRC of the previous one and reloads its own as the seed.
+*
+* @param[CRC_Stream_t *stream] Context from CRC_begin
+* @param[const uint8_t *data] Buffer, any alignment
+* @param[uint32_t size] Bytes
+*/
+void CRC_update(CRC_Stream_t *stream, const uint8_t *data, uint32_t size)
+{
+	if (stream->path == CRC_HW)
+	{
+		CRC_HW_acquire(stream);
+		CRC_HW_feed(data, size);
+	}
+	else
+	{
+		stream->crc = CRC_SW_update(stream->engine, stream->path, stream->crc, data, size);
+	}
+	stream->length += size;
+}
 
-		CRC->GPOLY = POLY;	
+/*!
+* @brief Bring the partial CRC of a stream into its context and free the peripheral, so the
+* context can be copied, stored or resumed later (on any path of the same engine).
+*/
+void CRC_save(CRC_Stream_t *stream)
+{
+	CRC_HW_wait();
+	if (CRC_owner == stream)
+	{
+		CRC_HW_release();
+	}
+}
 
-	CRC->CTRL |= CRC_CTRL_WAS_MASK;	/* Set CRC_CTRL[WAS] to program the seed value. */
-	CRC->DATAu.DATA = 0xFFFFFFFF;	/* seed value */
+/*!
+* @brief CRC value of a stream. The context stays valid: CRC_update can continue it.
+*/
+uint32_t CRC_finish(CRC_Stream_t *stream)
+{
+	CRC_save(stream);
+	return CRC_SW_finish(stream->engine->algo, stream->crc);
+}
+
+/*!
+* @brief CRC of one buffer through the given path.
+*/
+uint32_t CRC_run(const CRC_Engine_t *engine, CRC_Path_t path, const uint8_t *data, uint32_t size)
+{
+	if (path == CRC_HW)
+	{
+		return CRC_HW_calculate(engine->algo, data, size);
+	}
+	return CRC_SW_calculate(engine, path, data, size);
+}
 
-	CRC->CTRL &= ~CRC_CTRL_WAS_MASK;	/* Clear CRC_CTRL[WAS] to start writing data values. */
-	for(;size--;)
-	CRC->DATAu.DATA = *data++;	/* write data values */
+/*!
+* @brief CRC of one buffer through the path chosen for its size class (see CRC_BENCH_run).
+*
+* @param[const CRC_Engine_t *engine] Engine of the algorithm
+* @param[const uint8_t *data] Buffer, any alignment
+* @param[uint32_t size] Bytes
+* @return CRC value
+*/
+uint32_t CRC_calculate(const CRC_Engine_t *engine, const uint8_t *data, uint32_t size)
+{
+	return CRC_run(engine, (CRC_Path_t)engine->path[CRC_SW_size_class(size)], data, size);
+}
 
-return (uint32_t) CRC->DATAu.DATA;
+/*!
+* @brief CRC-32 of a buffer on the CRC peripheral (polynomial 0x04C11DB7, seed 0xFFFFFFFF,
+* reflected, final XOR).
+*/
+uint32_t CRC_32bits_calculate(uint8_t *data, uint32_t size)
+{
+	return CRC_HW_calculate(&CRC_ALGO_32, data, size);
 }
 
+/*!
+* @brief Route the always enabled DMAMUX request to a channel for the DMA mode.
+*
+* @param[uint8_t ch] DMA channel, its DMAn_IRQHandler calls CRC_DMA_IRQHandler
+*/
+void CRC_DMA_init(uint8_t ch)
+{
+	IRQn_Type irq = (IRQn_Type)(DMA0_IRQn + ch);
+
+	CRC_dma.ch = ch;
+	CRC_dma.stream = NULL;
+
+	SIM->PLATCGC |= SIM_PLATCGC_CGCDMA_MASK;			/* DMA Clock Gating Control Enable */
+	PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;	/* Enable clock for DMAMUX */
+	DMAMUX->CHCFG[ch] = 0;								/* Disable the channel to change the source */
+	DMAMUX->CHCFG[ch] = DMAMUX_CHCFG_SOURCE(EDMA_REQ_DMAMUX_ALWAYS_ENABLED0) | DMAMUX_CHCFG_ENBL_MASK;	/* Requests while ERQ is set */
+
+	S32_NVIC->ICPR[irq / 32] = 1u << (irq % 32);		/* Clear any pending IRQ */
+	S32_NVIC->ISER[irq / 32] = 1u << (irq % 32);		/* Enable IRQ */
+}
+
+/*!
+* @brief Add a buffer to a CRC_HW stream in the background: the eDMA writes its words into
+* CRC DATA, CRC_DMA_MINOR_BYTES per minor loop so other channels are served in between.
+* The unaligned head is written before the start, the bytes after the last minor loop by the
+* handler, which then calls done. A buffer shorter than a minor loop is fed at once and done is
+* called before returning.
+*
+* The DMA cannot reverse the bytes of a word, so CTRL[TOT] transposes the bytes (and the bits
+* of a reflected algorithm) during the transfer.
+*
+* @param[CRC_Stream_t *stream] Stream started with the CRC_HW path
+* @param[const uint8_t *data] Buffer (RAM or flash), stays valid until done
+* @param[uint32_t size] Bytes
+* @param[CRC_DMA_Callback_t done] Called from the DMA handler, CRC_finish(stream) gives the CRC
+* @param[void *arg] Argument of done
+* @return 0 if a transfer is in progress or the stream is not on the peripheral
+*/
+uint8_t CRC_DMA_update(CRC_Stream_t *stream, const uint8_t *data, uint32_t size, CRC_DMA_Callback_t done, void *arg)
+{
+	const CRC_Algo_t *algo = stream->engine->algo;
+	uint8_t  ch = CRC_dma.ch;
+	uint32_t head = (4u - ((uint32_t)data & 3u)) & 3u;
+	uint32_t loops;
+
+	if ((CRC_dma.stream != NULL) || (stream->path != CRC_HW))
+	{
+		return 0;
+	}
+	if (head > size)
+	{
+		head = size;
+	}
+	loops = (size - head) / CRC_DMA_MINOR_BYTES;
+	if (loops > CRC_DMA_MAX_LOOPS)
+	{
+		loops = CRC_DMA_MAX_LOOPS;
+	}
+
+	CRC_HW_acquire(stream);
+	CRC_HW_feed(data, head);
+	stream->length += size;
+	if (loops == 0u)
+	{
+		CRC_HW_feed(data + head, size - head);
+		done(stream, arg);
+		return 1;
+	}
+
+	CRC_dma.rest      = data + head + loops * CRC_DMA_MINOR_BYTES;
+	CRC_dma.rest_size = size - head - loops * CRC_DMA_MINOR_BYTES;
+	CRC_dma.done      = done;
+	CRC_dma.arg       = arg;
+	CRC_dma.stream    = stream;
+
+	CRC->CTRL = (CRC->CTRL & ~CRC_CTRL_TOT_MASK) | CRC_CTRL_TOT(algo->reflect ? 2u : 3u);	/* Bytes (and bits) transposed */
+
+	DMA->TCD[ch].SADDR = DMA_TCD_SADDR_SADDR((uint32_t) (data + head));	/* Word aligned */
+	DMA->TCD[ch].SOFF = DMA_TCD_SOFF_SOFF(4);
+	DMA->TCD[ch].ATTR = DMA_TCD_ATTR_SSIZE(2) | DMA_TCD_ATTR_DSIZE(2);		/* 32-bit reads and writes */
+	DMA->TCD[ch].NBYTES.MLNO = DMA_TCD_NBYTES_MLNO_NBYTES(CRC_DMA_MINOR_BYTES);
+	DMA->TCD[ch].SLAST = 0;
+	DMA->TCD[ch].DADDR = DMA_TCD_DADDR_DADDR((uint32_t) &CRC->DATAu.DATA);
+	DMA->TCD[ch].DOFF = DMA_TCD_DOFF_DOFF(0);								/* Every word into DATA */
+	DMA->TCD[ch].CITER.ELINKNO = DMA_TCD_CITER_ELINKNO_CITER(loops);
+	DMA->TCD[ch].BITER.ELINKNO = DMA_TCD_BITER_ELINKNO_BITER(loops);
+	DMA->TCD[ch].DLASTSGA = 0;
+	DMA->TCD[ch].CSR = DMA_TCD_CSR_INTMAJOR_MASK |		/* IRQ after the last minor loop */
+					   DMA_TCD_CSR_DREQ_MASK;			/* Clear ERQ: stop the always enabled requests */
+	DMA->SERQ = DMA_SERQ_SERQ(ch);
+	return 1;
+}
+
+/*!
+* @brief 1 while a CRC_DMA_update transfer is in progress.
+*/
+uint8_t CRC_DMA_busy(void)
+{
+	return CRC_dma.stream != NULL;
+}
+
+/*!
+* @brief Completion of the DMA mode, called from the DMAn_IRQHandler of the channel.
+*/
+void CRC_DMA_IRQHandler(void)
+{
+	CRC_Stream_t *stream = CRC_dma.stream;
+	uint32_t remaining;
+
+	DMA->CINT = DMA_CINT_CINT(CRC_dma.ch);				/* Clear Interruption request flag */
+	if (stream == NULL)
+	{
+		return;
+	}
+
+	CRC->CTRL = (CRC->CTRL & ~CRC_CTRL_TOT_MASK) | CRC_CTRL_TOT(stream->engine->algo->reflect ? 1u : 0u);
+	CRC_dma.stream = NULL;
+
+	remaining = CRC_dma.rest_size;
+	if (remaining >= CRC_DMA_MINOR_BYTES)				/* Beyond CRC_DMA_MAX_LOOPS: next transfer */
+	{
+		stream->length -= remaining;
+		(void)CRC_DMA_update(stream, CRC_dma.rest, remaining, CRC_dma.done, CRC_dma.arg);
+		return;
+	}
+	CRC_HW_feed(CRC_dma.rest, remaining);
+	CRC_dma.done(stream, CRC_dma.arg);
+}
@@ -34,6 +34,61 @@
 #define CRC_H_
 
 #include "device_registers.h"
-uint32_t CRC_32bits_calculate(uint8_t *data, uint32_t size);
+#include "crc_sw.h"
+
+/*!
+ * Description:
+ * ===================================================
+ * CRC peripheral path and the per buffer size dispatcher.
+ *
+ * The peripheral is programmed (CTRL, GPOLY) only when the algorithm changes; each call then
+ * writes the seed and feeds the buffer with 32-bit writes, the unaligned head and the tail with
+ * 8-bit writes. CTRL[TOT] transposes the bits in each byte of a reflected algorithm and the
+ * words are byte reversed (REV) so the first byte in memory is processed first.
+ *
+ * The 8-bit algorithms run in the 16-bit mode with the polynomial and seed shifted into the
+ * upper byte: the low byte of the register stays zero and the CRC is read from DATAL[15:8].
+ *
+ * Streams (CRC_begin/CRC_update/CRC_finish) compute a CRC over buffers delivered one by one
+ * (CAN frames, flash sectors) without a gather copy. Their partial CRC is kept in the CRC_SW
+ * register form, so several streams share the single peripheral: the stream switching in saves
+ * the partial CRC of the previous owner and reloads its own as the seed. The calls of streams
+ * sharing the peripheral must come from the same context (not from competing interrupts).
+ */
+
+/*!
+* @brief Stream context, plain data between CRC_save and the next CRC_update.
+*/
+typedef struct
+{
+	const CRC_Engine_t *engine;
+	CRC_Path_t path;					/* CRC_HW or a software path */
+	uint32_t crc;						/* Partial CRC, CRC_SW form; stale while the stream holds the peripheral */
+	uint32_t length;					/* Bytes added so far */
+} CRC_Stream_t;
+
+#define CRC_DMA_MINOR_BYTES		(1024u)		/* Bytes per DMA minor loop (service request) */
+#define CRC_DMA_MAX_LOOPS		(32767u)	/* CITER limit without channel linking */
+
+/*!
+* @brief Completion of CRC_DMA_update, called from the DMA handler.
+*/
+typedef void (*CRC_DMA_Callback_t)(CRC_Stream_t *stream, void *arg);
+
+void     CRC_init				(void);
+uint32_t CRC_HW_calculate		(const CRC_Algo_t *algo, const uint8_t *data, uint32_t size);
+uint32_t CRC_calculate			(const CRC_Engine_t *engine, const uint8_t *data, uint32_t size);
+uint32_t CRC_run				(const CRC_Engine_t *engine, CRC_Path_t path, const uint8_t *data, uint32_t size);
+uint32_t CRC_32bits_calculate	(uint8_t *data, uint32_t size);
+
+void     CRC_begin				(CRC_Stream_t *stream, const CRC_Engine_t *engine, CRC_Path_t path);
+void     CRC_update				(CRC_Stream_t *stream, const uint8_t *data, uint32_t size);
+void     CRC_save				(CRC_Stream_t *stream);
+uint32_t CRC_finish				(CRC_Stream_t *stream);
+
+void     CRC_DMA_init			(uint8_t ch);
+uint8_t  CRC_DMA_update			(CRC_Stream_t *stream, const uint8_t *data, uint32_t size, CRC_DMA_Callback_t done, void *arg);
+uint8_t  CRC_DMA_busy			(void);
+void     CRC_DMA_IRQHandler		(void);
 
 #endif /* CRC_H_ */
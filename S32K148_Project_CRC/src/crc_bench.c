@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "crc_bench.h"
+#include <stdio.h>
+
+static const char * const CRC_path_names[CRC_PATHS] = { "bitwise", "table", "slice8", "hw" };
+
+/*!
+* @brief Time the enabled paths per size class and select the fastest correct one.
+*
+* @param[CRC_Engine_t *engine] Engine, its path[] is updated
+* @param[uint32_t paths] Bit mask of the paths to time, (1u << CRC_HW) only where the peripheral exists
+* @param[CRC_Run_t run] Calculation of one buffer through a path
+* @param[uint32_t (*now)(void)] Time stamp in cycles
+* @param[const uint8_t *buffer] Test data
+* @param[uint32_t length] Bytes of buffer, sizes above are clipped
+* @param[CRC_Bench_t *bench] Measurements
+*/
+void CRC_BENCH_run(CRC_Engine_t *engine, uint32_t paths, CRC_Run_t run, uint32_t (*now)(void),
+				   const uint8_t *buffer, uint32_t length, CRC_Bench_t *bench)
+{
+	uint32_t limit = 16u;
+	uint32_t reference;
+	uint32_t result;
+	uint32_t start;
+	uint32_t time;
+	uint8_t  cls;
+	uint8_t  path;
+	uint8_t  i;
+
+	for (cls = 0; cls < CRC_SIZE_CLASSES; cls++, limit <<= 2)
+	{
+		uint32_t size = (limit < length) ? limit : length;
+		uint32_t best = CRC_BENCH_SKIPPED;
+
+		bench->size[cls] = size;
+		reference = CRC_SW_calculate(engine, CRC_BITWISE, buffer, size);
+
+		for (path = 0; path < CRC_PATHS; path++)
+		{
+			bench->cycles[cls][path] = CRC_BENCH_SKIPPED;
+			if (!(paths & (1u << path)))
+			{
+				continue;
+			}
+			for (i = 0; i < CRC_BENCH_REPEAT; i++)
+			{
+				start  = now();
+				result = run(engine, (CRC_Path_t)path, buffer, size);
+				time   = now() - start;
+				if (result != reference)
+				{
+					bench->cycles[cls][path] = CRC_BENCH_SKIPPED;
+					break;
+				}
+				if (time < bench->cycles[cls][path])
+				{
+					bench->cycles[cls][path] = time;
+				}
+			}
+			if (bench->cycles[cls][path] < best)
+			{
+				best = bench->cycles[cls][path];
+				engine->path[cls] = path;
+			}
+		}
+	}
+}
+
+/*!
+* @brief One line per size class: time of each path and the path selected.
+*
+* @param[void (*print)(char *)] Line output, e.g. LPUART1_transmit_string
+*/
+void CRC_BENCH_report(const CRC_Engine_t *engine, const CRC_Bench_t *bench, void (*print)(char *))
+{
+	char line[112];
+	int  used;
+	uint8_t cls;
+	uint8_t path;
+
+	snprintf(line, sizeof(line), "%s, time per buffer (-: skipped)\n\r", engine->algo->name);
+	print(line);
+	for (cls = 0; cls < CRC_SIZE_CLASSES; cls++)
+	{
+		used = snprintf(line, sizeof(line), "%6lu B:", (unsigned long)bench->size[cls]);
+		for (path = 0; path < CRC_PATHS; path++)
+		{
+			if (bench->cycles[cls][path] == CRC_BENCH_SKIPPED)
+			{
+				used += snprintf(line + used, sizeof(line) - (uint32_t)used, " %8s %9s", CRC_path_names[path], "-");
+			}
+			else
+			{
+				used += snprintf(line + used, sizeof(line) - (uint32_t)used, " %8s %9lu", CRC_path_names[path],
+								 (unsigned long)bench->cycles[cls][path]);
+			}
+		}
+		snprintf(line + used, sizeof(line) - (uint32_t)used, " -> %s\n\r", CRC_path_names[engine->path[cls]]);
+		print(line);
+	}
+}
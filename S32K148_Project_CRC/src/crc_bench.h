@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRC_BENCH_H_
+#define CRC_BENCH_H_
+
+#include "crc_sw.h"
+
+/*!
+ * Description:
+ * ===================================================
+ * Path selection by measurement. For each size class of CRC_Engine_t.path, CRC_BENCH_run times
+ * every enabled path over a buffer of the class limit (16 B to 16 KB), keeps the best of
+ * CRC_BENCH_REPEAT runs, checks the result against the bitwise reference and stores the
+ * fastest correct path in the engine, so CRC_calculate then dispatches on the buffer size.
+ *
+ * The paths and the time base are passed in: the target runs CRC_run (peripheral included)
+ * with the DWT cycle counter, the host tool runs CRC_SW_calculate with clock_gettime.
+ */
+
+#define CRC_BENCH_REPEAT	(4u)			/* Runs per path and size, best kept */
+#define CRC_BENCH_SKIPPED	(0xFFFFFFFFu)	/* cycles[][] of a path not run or with a wrong result */
+
+typedef uint32_t (*CRC_Run_t)(const CRC_Engine_t *engine, CRC_Path_t path, const uint8_t *data, uint32_t size);
+
+typedef struct
+{
+	uint32_t size[CRC_SIZE_CLASSES];					/* Buffer size measured per class */
+	uint32_t cycles[CRC_SIZE_CLASSES][CRC_PATHS];		/* Best time per class and path */
+} CRC_Bench_t;
+
+void CRC_BENCH_run		(CRC_Engine_t *engine, uint32_t paths, CRC_Run_t run, uint32_t (*now)(void),
+						 const uint8_t *buffer, uint32_t length, CRC_Bench_t *bench);
+void CRC_BENCH_report	(const CRC_Engine_t *engine, const CRC_Bench_t *bench, void (*print)(char *));
+
+#endif /* CRC_BENCH_H_ */
@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "crc_sw.h"
+#include <string.h>
+
+const CRC_Algo_t CRC_ALGO_32          = { "CRC-32",          32u, 1u, 0x04C11DB7u, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xCBF43926u };
+const CRC_Algo_t CRC_ALGO_16_CCITT    = { "CRC-16/CCITT",    16u, 0u, 0x00001021u, 0x0000FFFFu, 0x00000000u, 0x000029B1u };
+const CRC_Algo_t CRC_ALGO_8_SAE_J1850 = { "CRC-8/SAE-J1850", 8u, 0u, 0x0000001Du, 0x000000FFu, 0x000000FFu, 0x0000004Bu };
+
+/*!
+* @brief Reverse the low bits of value.
+*/
+uint32_t CRC_SW_reflect(uint32_t value, uint8_t bits)
+{
+	uint32_t result = 0;
+	uint8_t  i;
+
+	for (i = 0; i < bits; i++)
+	{
+		result = (result << 1) | ((value >> i) & 1u);
+	}
+	return result;
+}
+
+/* Unaligned little endian load, a single LDR on the Cortex-M4 */
+static inline uint32_t load32(const uint8_t *data)
+{
+	uint32_t word;
+	memcpy(&word, data, sizeof(word));
+	return word;
+}
+
+/*!
+* @brief Build the lookup tables of an engine and select its default paths.
+*
+* @param[CRC_Engine_t *engine] Engine to initialize
+* @param[const CRC_Algo_t *algo] Algorithm
+* @param[uint32_t (*table)[256]] Storage for slices tables of 256 words
+* @param[uint8_t slices] 1 (byte table only) or CRC_SLICES
+*/
+void CRC_SW_init(CRC_Engine_t *engine, const CRC_Algo_t *algo, uint32_t (*table)[256], uint8_t slices)
+{
+	uint32_t poly = algo->reflect ? CRC_SW_reflect(algo->poly, algo->width) : (algo->poly << (32u - algo->width));
+	uint32_t crc;
+	uint32_t i;
+	uint8_t  k;
+
+	engine->algo   = algo;
+	engine->table  = table;
+	engine->slices = (slices >= CRC_SLICES) ? CRC_SLICES : 1u;
+
+	for (i = 0; i < 256u; i++)
+	{
+		if (algo->reflect)
+		{
+			crc = i;
+			for (k = 0; k < 8u; k++)
+			{
+				crc = (crc & 1u) ? ((crc >> 1) ^ poly) : (crc >> 1);
+			}
+		}
+		else
+		{
+			crc = i << 24;
+			for (k = 0; k < 8u; k++)
+			{
+				crc = (crc & 0x80000000u) ? ((crc << 1) ^ poly) : (crc << 1);
+			}
+		}
+		table[0][i] = crc;
+	}
+
+	for (k = 1; k < engine->slices; k++)				/* table[k][i]: byte i followed by k zero bytes */
+	{
+		for (i = 0; i < 256u; i++)
+		{
+			crc = table[k - 1u][i];
+			table[k][i] = algo->reflect ? ((crc >> 8) ^ table[0][crc & 0xFFu]) : ((crc << 8) ^ table[0][crc >> 24]);
+		}
+	}
+
+	for (k = 0; k < CRC_SIZE_CLASSES; k++)
+	{
+		engine->path[k] = (engine->slices == CRC_SLICES) ? CRC_SLICE8 : CRC_TABLE;
+	}
+}
+
+/*!
+* @brief Size class of a buffer: 0 up to 16 bytes, then x4 per class up to 4 KB, 5 above.
+*/
+uint8_t CRC_SW_size_class(uint32_t size)
+{
+	uint8_t  cls = 0;
+	uint32_t limit = 16u;
+
+	while ((size > limit) && (cls < (CRC_SIZE_CLASSES - 1u)))
+	{
+		limit <<= 2;
+		cls++;
+	}
+	return cls;
+}
+
+/*!
+* @brief Register value before the first byte.
+*/
+uint32_t CRC_SW_start(const CRC_Algo_t *algo)
+{
+	return algo->reflect ? CRC_SW_reflect(algo->init, algo->width) : (algo->init << (32u - algo->width));
+}
+
+/*!
+* @brief CRC value of a register returned by the update steps.
+*/
+uint32_t CRC_SW_finish(const CRC_Algo_t *algo, uint32_t crc)
+{
+	return (algo->reflect ? crc : (crc >> (32u - algo->width))) ^ algo->xorout;
+}
+
+/*!
+* @brief Bit by bit update, reference for the table paths.
+*/
+uint32_t CRC_SW_bitwise(const CRC_Algo_t *algo, uint32_t crc, const uint8_t *data, uint32_t size)
+{
+	uint32_t poly = algo->reflect ? CRC_SW_reflect(algo->poly, algo->width) : (algo->poly << (32u - algo->width));
+	uint8_t  bit;
+
+	while (size--)
+	{
+		if (algo->reflect)
+		{
+			crc ^= *data++;
+			for (bit = 0; bit < 8u; bit++)
+			{
+				crc = (crc & 1u) ? ((crc >> 1) ^ poly) : (crc >> 1);
+			}
+		}
+		else
+		{
+			crc ^= (uint32_t)*data++ << 24;
+			for (bit = 0; bit < 8u; bit++)
+			{
+				crc = (crc & 0x80000000u) ? ((crc << 1) ^ poly) : (crc << 1);
+			}
+		}
+	}
+	return crc;
+}
+
+/*!
+* @brief One table lookup per byte.
+*/
+uint32_t CRC_SW_table(const CRC_Engine_t *engine, uint32_t crc, const uint8_t *data, uint32_t size)
+{
+	const uint32_t *t0 = engine->table[0];
+
+	if (engine->algo->reflect)
+	{
+		while (size--)
+		{
+			crc = (crc >> 8) ^ t0[(crc ^ *data++) & 0xFFu];
+		}
+	}
+	else
+	{
+		while (size--)
+		{
+			crc = (crc << 8) ^ t0[(crc >> 24) ^ *data++];
+		}
+	}
+	return crc;
+}
+
+/*!
+* @brief Slice-by-8: 8 bytes per step, the tail through the byte table. Falls back to the byte
+* table for an engine built without the slice tables.
+*/
+uint32_t CRC_SW_slice8(const CRC_Engine_t *engine, uint32_t crc, const uint8_t *data, uint32_t size)
+{
+	uint32_t (*t)[256] = engine->table;
+	uint32_t w1;
+	uint32_t w2;
+
+	if (engine->slices != CRC_SLICES)
+	{
+		return CRC_SW_table(engine, crc, data, size);
+	}
+
+	if (engine->algo->reflect)
+	{
+		for (; size >= 8u; size -= 8u, data += 8)
+		{
+			w1 = load32(data) ^ crc;
+			w2 = load32(data + 4);
+			crc = t[7][w1 & 0xFFu] ^ t[6][(w1 >> 8) & 0xFFu] ^ t[5][(w1 >> 16) & 0xFFu] ^ t[4][w1 >> 24]
+				^ t[3][w2 & 0xFFu] ^ t[2][(w2 >> 8) & 0xFFu] ^ t[1][(w2 >> 16) & 0xFFu] ^ t[0][w2 >> 24];
+		}
+	}
+	else
+	{
+		for (; size >= 8u; size -= 8u, data += 8)
+		{
+			w1 = __builtin_bswap32(load32(data)) ^ crc;		/* REV on the Cortex-M4 */
+			w2 = load32(data + 4);
+			crc = t[7][w1 >> 24] ^ t[6][(w1 >> 16) & 0xFFu] ^ t[5][(w1 >> 8) & 0xFFu] ^ t[4][w1 & 0xFFu]
+				^ t[3][w2 & 0xFFu] ^ t[2][(w2 >> 8) & 0xFFu] ^ t[1][(w2 >> 16) & 0xFFu] ^ t[0][w2 >> 24];
+		}
+	}
+	return CRC_SW_table(engine, crc, data, size);
+}
+
+/*!
+* @brief Update a register through a software path.
+*
+* @param[const CRC_Engine_t *engine] Engine of the algorithm
+* @param[CRC_Path_t path] CRC_BITWISE, CRC_TABLE or CRC_SLICE8
+* @param[uint32_t crc] Register from CRC_SW_start or a previous update
+* @param[const uint8_t *data] Buffer, any alignment
+* @param[uint32_t size] Bytes
+* @return Updated register, crc unchanged for a path not handled in software
+*/
+uint32_t CRC_SW_update(const CRC_Engine_t *engine, CRC_Path_t path, uint32_t crc, const uint8_t *data, uint32_t size)
+{
+	switch (path)
+	{
+		case CRC_BITWISE:
+			return CRC_SW_bitwise(engine->algo, crc, data, size);
+		case CRC_TABLE:
+			return CRC_SW_table(engine, crc, data, size);
+		case CRC_SLICE8:
+			return CRC_SW_slice8(engine, crc, data, size);
+		default:
+			return crc;
+	}
+}
+
+/*!
+* @brief CRC of one buffer through a software path.
+*
+* @param[const CRC_Engine_t *engine] Engine of the algorithm
+* @param[CRC_Path_t path] CRC_BITWISE, CRC_TABLE or CRC_SLICE8
+* @param[const uint8_t *data] Buffer, any alignment
+* @param[uint32_t size] Bytes
+* @return CRC value, 0 for a path not handled in software
+*/
+uint32_t CRC_SW_calculate(const CRC_Engine_t *engine, CRC_Path_t path, const uint8_t *data, uint32_t size)
+{
+	if (path > CRC_SLICE8)
+	{
+		return 0;
+	}
+	return CRC_SW_finish(engine->algo, CRC_SW_update(engine, path, CRC_SW_start(engine->algo), data, size));
+}
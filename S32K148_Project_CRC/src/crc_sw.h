@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CRC_SW_H_
+#define CRC_SW_H_
+
+#include <stdint.h>
+
+/*!
+ * Description:
+ * ===================================================
+ * Software CRC engines, no peripheral access (the same file builds on a Linux host).
+ *
+ * An algorithm is described by its Rocksoft parameters (width, polynomial, init, reflection,
+ * final XOR). An engine adds the lookup tables of one algorithm:
+ * 	- bitwise:   no table, one shift per bit (reference),
+ * 	- table:     one 256-entry table, one lookup per byte,
+ * 	- slice-by-8: eight 256-entry tables, two 32-bit loads and eight lookups per 8 bytes.
+ *
+ * The tables are built into caller storage by CRC_SW_init (1 KB per slice), so a project only
+ * pays RAM for the algorithms and the slice count it uses.
+ *
+ * Reflected algorithms keep their register LSB first; the others keep it left aligned in 32
+ * bits, so a single MSB first implementation covers the 8, 16 and 32-bit widths.
+ */
+
+#define CRC_SLICES		(8u)		/* Tables of a slice-by-8 engine */
+
+/*!
+* @brief CRC algorithm parameters.
+*/
+typedef struct
+{
+	const char *name;				/* Label of the reports */
+	uint8_t  width;					/* 8, 16 or 32 bits */
+	uint8_t  reflect;				/* 1: reflected input and output (LSB first) */
+	uint32_t poly;					/* Polynomial, normal form (0x04C11DB7 for CRC-32) */
+	uint32_t init;					/* Register value before the first byte */
+	uint32_t xorout;				/* XOR on the final register */
+	uint32_t check;					/* CRC of the ASCII string "123456789" */
+} CRC_Algo_t;
+
+extern const CRC_Algo_t CRC_ALGO_32;			/* CRC-32 (Ethernet, zlib) */
+extern const CRC_Algo_t CRC_ALGO_16_CCITT;		/* CRC-16/CCITT-FALSE */
+extern const CRC_Algo_t CRC_ALGO_8_SAE_J1850;	/* CRC-8 SAE J1850 */
+
+/*!
+* @brief Calculation paths, CRC_HW is the CRC peripheral (crc.c).
+*/
+typedef enum
+{
+	CRC_BITWISE = 0,
+	CRC_TABLE,
+	CRC_SLICE8,
+	CRC_HW,
+	CRC_PATHS
+} CRC_Path_t;
+
+#define CRC_SIZE_CLASSES	(6u)		/* Buffer size classes of CRC_Engine_t.path: up to 16, 64, 256, 1K, 4K bytes, above */
+
+/*!
+* @brief Software engine of one algorithm and the path chosen per buffer size class.
+*/
+typedef struct
+{
+	const CRC_Algo_t *algo;
+	uint32_t (*table)[256];				/* table[0]: byte table, table[1..7]: slice-by-8 */
+	uint8_t  slices;					/* 1 (CRC_TABLE only) or CRC_SLICES */
+	uint8_t  path[CRC_SIZE_CLASSES];	/* Path of CRC_calculate per size class (CRC_BENCH_run) */
+} CRC_Engine_t;
+
+void     CRC_SW_init		(CRC_Engine_t *engine, const CRC_Algo_t *algo, uint32_t (*table)[256], uint8_t slices);
+uint8_t  CRC_SW_size_class	(uint32_t size);
+uint32_t CRC_SW_calculate	(const CRC_Engine_t *engine, CRC_Path_t path, const uint8_t *data, uint32_t size);
+
+/* Raw register steps: start, update over any number of buffers, final value */
+uint32_t CRC_SW_start		(const CRC_Algo_t *algo);
+uint32_t CRC_SW_update		(const CRC_Engine_t *engine, CRC_Path_t path, uint32_t crc, const uint8_t *data, uint32_t size);
+uint32_t CRC_SW_bitwise		(const CRC_Algo_t *algo, uint32_t crc, const uint8_t *data, uint32_t size);
+uint32_t CRC_SW_table		(const CRC_Engine_t *engine, uint32_t crc, const uint8_t *data, uint32_t size);
+uint32_t CRC_SW_slice8		(const CRC_Engine_t *engine, uint32_t crc, const uint8_t *data, uint32_t size);
+uint32_t CRC_SW_finish		(const CRC_Algo_t *algo, uint32_t crc);
+uint32_t CRC_SW_reflect		(uint32_t value, uint8_t bits);
+
+#endif /* CRC_SW_H_ */
@@ -34,12 +34,45 @@
  * =============================================================
  * The cyclic redundancy check (CRC) module generates 16/32-bit CRC code for error detection.
  * This is a program to show a basic configuration of CRC module following Reference Manual steps.
+ *
+ * CRC-32, CRC-16/CCITT and CRC-8 SAE J1850 are then computed over a 16 KB block (standing for the
+ * calibration data checked at boot) through the software engines (bitwise, table, slice-by-8)
+ * and the peripheral. CRC_BENCH_run times every path per buffer size class with the DWT cycle
+ * counter and selects the fastest one for CRC_calculate; the measurements are left in
+ * crc_bench[] and the selected paths in crc_engine[].path for the debugger.
+ *
+ * The block is then received again as 64-byte frames and each frame is added to three streams
+ * (one per algorithm) that share the CRC peripheral; crc_stream[] matches crc_block[].
+ *
+ * Finally the block is checked in the background: DMA channel 0 writes its words into the CRC
+ * peripheral while the core counts idle loops in crc_dma_idle, and the completion callback
+ * stores the result in crc_dma[] (== crc_block[]).
  */
 
 #include "crc.h"
+#include "crc_bench.h"
+#include "profile.h"
 #include "device_registers.h"
 #include "clocks_and_modes.h"
 
+#define CAL_BLOCK_SIZE	(16384u)				/* Bytes of the test block */
+#define FRAME_SIZE		(64u)					/* Bytes per streamed frame */
+#define CRC_ALGOS		(3u)
+#define CRC_DMA_CH		(0u)					/* DMA channel of the background checks */
+
+static const CRC_Algo_t * const crc_algos[CRC_ALGOS] = { &CRC_ALGO_32, &CRC_ALGO_16_CCITT, &CRC_ALGO_8_SAE_J1850 };
+
+static uint32_t crc_tables[CRC_ALGOS][CRC_SLICES][256];	/* 8 KB of slice-by-8 tables per algorithm */
+CRC_Engine_t crc_engine[CRC_ALGOS];
+CRC_Bench_t  crc_bench[CRC_ALGOS];
+uint32_t     crc_check[CRC_ALGOS];						/* CRC of "123456789" per algorithm, == check */
+uint32_t     crc_block[CRC_ALGOS];						/* CRC of the block through the selected paths */
+uint32_t     crc_stream[CRC_ALGOS];						/* CRC of the block streamed frame by frame */
+uint32_t     crc_dma[CRC_ALGOS];						/* CRC of the block fed by the DMA */
+uint32_t     crc_dma_idle;								/* Core loops while the DMA was feeding */
+
+static uint32_t cal_block[CAL_BLOCK_SIZE / 4u];
+
 void WDOG_disable (void)
 {
   WDOG->CNT=0xD928C520;     /* Unlock watchdog 		*/
@@ -47,13 +80,28 @@ void WDOG_disable (void)
   WDOG->CS = 0x00002100;    /* Disable watchdog 		*/
 }
 
+void DMA0_IRQHandler(void)
+{
+	CRC_DMA_IRQHandler();
+}
+
+/* Background check done: the result goes to the slot passed as argument */
+static void CRC_dma_done(CRC_Stream_t *stream, void *arg)
+{
+	*(uint32_t *)arg = CRC_finish(stream);
+}
+
 int main(void)
 {
 	/* Initialization
 	 * ========================
 	 */
+	static const char * const names[CRC_ALGOS] = { "CRC-32 16 KB", "CRC-16/CCITT 16 KB", "CRC-8/SAE-J1850 16 KB" };
 	uint8_t test = 0x41;	/* test = A */
 	uint32_t crc = 0x00000000;
+	CRC_Stream_t streams[CRC_ALGOS];
+	uint32_t offset;
+	uint32_t i;
 
 	WDOG_disable();			/* Disable WDOG */
 	SOSC_init_8MHz();		/* Initialize system oscilator for 8 MHz xtal */
@@ -61,7 +109,54 @@ int main(void)
 	NormalRUNmode_80MHz();	/* Init clocks: 80 MHz sysclk & core, 40 MHz bus, 20 MHz flash */
 
 	crc = CRC_32bits_calculate(&test, 1);				/* Calculate 32-bit CRC */
-														/* crc = 547335706 */
+														/* crc = 0xD3D99E8B */
+
+	for (i = 0; i < (CAL_BLOCK_SIZE / 4u); i++)			/* Test pattern */
+	{
+		cal_block[i] = i * 0x9E3779B9u;
+	}
+
+	PROFILE_init(names, CRC_ALGOS);
+	for (i = 0; i < CRC_ALGOS; i++)
+	{
+		CRC_SW_init(&crc_engine[i], crc_algos[i], crc_tables[i], CRC_SLICES);
+		crc_check[i] = CRC_HW_calculate(crc_algos[i], (const uint8_t *)"123456789", 9);
+		CRC_BENCH_run(&crc_engine[i], 0xFu, CRC_run, PROFILE_now, (const uint8_t *)cal_block, CAL_BLOCK_SIZE, &crc_bench[i]);
+	}
+
+	for (i = 0; i < CRC_ALGOS; i++)						/* Checks through the selected paths */
+	{
+		PROFILE_begin((uint8_t)i);
+		crc_block[i] = CRC_calculate(&crc_engine[i], (const uint8_t *)cal_block, CAL_BLOCK_SIZE);
+		PROFILE_end((uint8_t)i);
+	}
+
+	for (i = 0; i < CRC_ALGOS; i++)
+	{
+		CRC_begin(&streams[i], &crc_engine[i], CRC_HW);
+	}
+	for (offset = 0; offset < CAL_BLOCK_SIZE; offset += FRAME_SIZE)	/* Each frame to every stream */
+	{
+		for (i = 0; i < CRC_ALGOS; i++)
+		{
+			CRC_update(&streams[i], (const uint8_t *)cal_block + offset, FRAME_SIZE);
+		}
+	}
+	for (i = 0; i < CRC_ALGOS; i++)
+	{
+		crc_stream[i] = CRC_finish(&streams[i]);
+	}
+
+	CRC_DMA_init(CRC_DMA_CH);
+	for (i = 0; i < CRC_ALGOS; i++)						/* One background check after the other */
+	{
+		CRC_begin(&streams[i], &crc_engine[i], CRC_HW);
+		(void)CRC_DMA_update(&streams[i], (const uint8_t *)cal_block, CAL_BLOCK_SIZE, CRC_dma_done, &crc_dma[i]);
+		while (CRC_DMA_busy())							/* Free for other work */
+		{
+			crc_dma_idle++;
+		}
+	}
 
 	/*! Wait forever
 	 * ========================
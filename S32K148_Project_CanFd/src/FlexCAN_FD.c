@@ -32,6 +32,21 @@
 
 #include "device_registers.h"	/* include peripheral declarations S32K144 */
 #include "FlexCAN_FD.h"
+#include "FlexCAN_Timing.h"
+#include "FlexCAN_Layout.h"
+
+#define CAN_CLK_HZ		(40000000)	/* CLKSRC=1: BUSCLK */
+#define CAN_DELAY_NS	(250)		/* Transceiver loop delay and bus line, one way */
+
+/* Nominal phase 500 Kbit/s, data phase 2 Mbit/s, both sampled at 80% */
+FLEXCAN_TIMING(CAN_NOMINAL, CBT,   CAN_CLK_HZ, 500000,  800, CAN_DELAY_NS);
+FLEXCAN_TIMING(CAN_DATA,    FDCBT, CAN_CLK_HZ, 2000000, 800, CAN_DELAY_NS);
+FLEXCAN_TIMING_ASSERT(CAN_NOMINAL);
+FLEXCAN_TIMING_ASSERT(CAN_DATA);
+
+/* CAN-FD: 64-byte MBs, MB0..MB4 scanned (MB0 transmits, MB4 receives) */
+FLEXCAN_LAYOUT(CAN0_FD, 64, 0, 5, 0);
+FLEXCAN_LAYOUT_ASSERT(CAN0_FD);
 
 uint32_t  RxCODE;              /* Received message buffer code */
 uint32_t  RxID;                /* Received message ID */
@@ -40,7 +55,7 @@ uint32_t  RxDATA[2];           /* Received message data (2 words) */
 uint32_t  RxTIMESTAMP;         /* Received message time */
 
 void FLEXCAN0_init(void) {
-#define MSG_BUF_SIZE  18    /* Msg Buffer Size. (2 words hdr + 16 words data  = 18 words) */
+#define MSG_BUF_SIZE  CAN0_FD_MB_WORDS    /* Msg Buffer Size. (2 words hdr + 16 words data  = 18 words) */
 	uint32_t   i=0;
 
 	PCC->PCCn[PCC_FlexCAN0_INDEX] |= PCC_PCCn_CGC_MASK; /* CGC=1: enable clock to FlexCAN0 */
@@ -51,35 +66,20 @@ void FLEXCAN0_init(void) {
 
 	/* Good practice: wait for FRZACK=1 on freeze mode entry/exit */
 
-	CAN0->CBT =		CAN_CBT_EPSEG2(15)		/* Configure nominal phase: 500 KHz bit time, 40 MHz Sclock */
-							|CAN_CBT_EPSEG1(15)		/* Prescaler = CANCLK / Sclock = 40 MHz / 40 MHz = 1 */
-							|CAN_CBT_EPROPSEG(47)	/* EPRESDIV = Prescaler - 1 = 0 */
-							|CAN_CBT_ERJW(15);   	/* EPSEG2 = 15 */
-													/* EPSEG1 = 15 */
-													/* EPROPSEG = 47 */
-													/* ERJW = 15 */
-													/* BITRATEn =Fcanclk /( [(1 + (EPSEG1+1) + (EPSEG2+1) + (EPROPSEG + 1)] x (EPRESDIV+1)) */
-													/*         = 40 MHz /( [(1 + ( 15   +1) + ( 15   +1) + (   46    + 1)] x (    0   +1)) */
-													/*          = 40 MHz /( [1+16+16+47] x 1) = 40 MHz /(80x1) = 500 Kz */
-
-    /* Configure data phase: 2 MHz bit time, 40 MHz Sclock */
-	CAN0->FDCBT = 	CAN_CBT_EPSEG2(3)/* Prescaler = CANCLK / Sclock = 40 MHz / 40 MHz = 1 */
-							|CAN_CBT_EPSEG1(7)/* FPRESDIV = Prescaler - 1 = 0 */
-							|CAN_CBT_EPROPSEG(7)/* FPSEG2 = 3 */
-							|CAN_CBT_ERJW(3);/* FPSEG1 = 7 */
-	/* FPROPSEG = 7 */
-	/* FRJW = 3 */
-	/* BITRATEf =Fcanclk /( [(1 + (FPSEG1+1) + (FPSEG2+1) + (FPROPSEG)] x (FPRESDIV+!)) */
-	/*          = 40 MHz /( [(1 + (  7   +1) + (  3   +1) + (   7    )] x (    0   +1)) */
-	/*          = 40 MHz /( [1+8+4+7] x 1) = 40 MHz /(20x1) = 40 MHz / 20 = 2 MHz  */
+	CAN0->CBT = FLEXCAN_CBT_TIMING(CAN_NOMINAL);	/* Configure nominal phase: 500 KHz bit time, 40 MHz Sclock */
+													/* BTF=1: CBT replaces the CTRL1 timing fields */
+													/* BITRATEn = Fcanclk / ([1 + (EPROPSEG+1) + (EPSEG1+1) + (EPSEG2+1)] x (EPRESDIV+1)) */
+													/*          = 40 MHz / ([1 + 47 + 16 + 16] x 1) = 40 MHz / 80 = 500 KHz */
 
+	CAN0->FDCBT = FLEXCAN_FDCBT_TIMING(CAN_DATA);	/* Configure data phase: 2 MHz bit time, 40 MHz Sclock */
+													/* BITRATEf = Fcanclk / ([1 + FPROPSEG + (FPSEG1+1) + (FPSEG2+1)] x (FPRESDIV+1)) */
+													/*          = 40 MHz / ([1 + 11 + 4 + 4] x 1) = 40 MHz / 20 = 2 MHz */
 
 	CAN0->FDCTRL =	CAN_FDCTRL_FDRATE_MASK	/* Configure bit rate switch, data size, transcv'r delay  */
-			|CAN_FDCTRL_MBDSR0(3)	/* BRS=1: enable Bit Rate Swtich in frame's header */
-			|CAN_FDCTRL_TDCEN_MASK	/* MBDSR1: Not applicable */
-			|CAN_FDCTRL_TDCOFF(5);   /* MBDSR0=3: Region 0 has 64 bytes data in frame's payload */
+			|FLEXCAN_FDCTRL_LAYOUT(CAN0_FD)	/* BRS=1: enable Bit Rate Swtich in frame's header */
+			|FLEXCAN_FDCTRL_TDC(CAN_DATA);	/* MBDSR0=3: Region 0 has 64 bytes data in frame's payload */
 	/* TDCEN=1: enable Transceiver Delay Compensation */
-	/* TDCOFF=5: 5 CAN clocks (300us) offset used */
+	/* TDCOFF: secondary sample point at the data phase sample point, 16 CAN clocks */
 
 	for(i=0; i<128; i++ ) {    /* CAN0: clear 128 words RAM in FlexCAN 0 */
 		CAN0->RAMn[i] = 0;       /* Clear msg buf words. All buffers CODE=0 (inactive) */
@@ -104,7 +104,7 @@ void FLEXCAN0_init(void) {
 #endif
 	/* PRIO = 0: CANFD not used */
 	CAN0->CTRL2 |= CAN_CTRL2_ISOCANFDEN_MASK;       /* Enable CRC fix for ISO CAN FD */
-	CAN0->MCR = 0x0000081F;       /* Negate FlexCAN 1 halt state & enable CAN FD for 32 MBs */
+	CAN0->MCR = CAN_MCR_FDEN_MASK | FLEXCAN_MCR_LAYOUT(CAN0_FD);	/* Negate FlexCAN 1 halt state & enable CAN FD, MB0..MB4 */
 	while ((CAN0->MCR && CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT)  {}
 	/* Good practice: wait for FRZACK to clear (not in freeze mode) */
 	while ((CAN0->MCR && CAN_MCR_NOTRDY_MASK) >> CAN_MCR_NOTRDY_SHIFT)  {}
@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLEXCAN_TIMING_H_
+#define FLEXCAN_TIMING_H_
+
+#include <stdint.h>
+
+/*!
+ * Description:
+ * ===================================================
+ * Bit timing solver for the three FlexCAN timing registers. From the protocol engine clock, the
+ * target bit rate, the sample point and the signal delay it picks the prescaler and the segments,
+ * evaluated by the compiler:
+ *
+ * 	FLEXCAN_TIMING(CAN_NOMINAL, CBT,   40000000, 500000,  800, 250);
+ * 	FLEXCAN_TIMING(CAN_DATA,    FDCBT, 40000000, 2000000, 750, 250);
+ * 	FLEXCAN_TIMING_ASSERT(CAN_NOMINAL);
+ *
+ * 	CAN0->CBT    = FLEXCAN_CBT_TIMING(CAN_NOMINAL);
+ * 	CAN0->FDCBT  = FLEXCAN_FDCBT_TIMING(CAN_DATA);
+ * 	CAN0->FDCTRL = ... | FLEXCAN_FDCTRL_TDC(CAN_DATA);
+ *
+ * FLEXCAN_TIMING declares enum constants <name>_PRESDIV, _PROPSEG, _PSEG1, _PSEG2, _RJW (register
+ * field values), _PRESC, _TQ, _TSEG1, _TSEG2 (in time quanta), _RATE_PPM, _SP (sample point
+ * reached, per mille), _TDCOFF, _TDC and _ERRORS, so bit field drivers can use the fields one by
+ * one. The kind is CTRL1 (classic timing), CBT (extended nominal timing) or FDCBT (data phase).
+ *
+ * 	- The prescaler is the smallest one giving an exact bit rate, which leaves the most time
+ * 	  quanta per bit; for nominal timing the propagation segment must also fit the delay.
+ * 	- TSEG1 = PROPSEG + PSEG1 puts the sample point as close as possible to the request.
+ * 	- PSEG1 = PSEG2 where possible, the propagation segment takes the rest; RJW is the largest
+ * 	  allowed (min(PSEG1, PSEG2)).
+ * 	- TDCOFF puts the secondary sample point of the data phase at the sample point, measured from
+ * 	  the delayed transmitted edge: (FPRESDIV + 1) * (FPROPSEG + FPSEG1 + 2) CAN clocks.
+ *
+ * delay_ns is the one-way delay between the two farthest nodes: transceiver loop delay plus bus
+ * line (about 5 ns/m). The nominal propagation segment has to cover it twice; in the data phase
+ * the transmitter sees its own bits one loop late, which only TDC (data prescaler 1 or 2)
+ * compensates.
+ *
+ * The steps are plain expressions, S32K148_Host_Sim/tools/can_timing.c runs the same macros at
+ * run time to print the registers and the report for any clock and bit rate.
+ */
+
+/* Register limits, in time quanta. PROP_BIAS: PROPSEG field = Prop_Seg - PROP_BIAS */
+#define FLEXCAN_CTRL1_PRESC_MAX		(256)
+#define FLEXCAN_CTRL1_PROP_MIN		(1)
+#define FLEXCAN_CTRL1_PROP_MAX		(8)
+#define FLEXCAN_CTRL1_SEG1_MAX		(8)
+#define FLEXCAN_CTRL1_SEG2_MAX		(8)
+#define FLEXCAN_CTRL1_RJW_MAX		(4)
+#define FLEXCAN_CTRL1_PROP_BIAS		(1)
+#define FLEXCAN_CTRL1_TQ_MIN		(8)
+#define FLEXCAN_CTRL1_TDC			(0)		/* Nominal phase: no delay compensation */
+
+#define FLEXCAN_CBT_PRESC_MAX		(1024)
+#define FLEXCAN_CBT_PROP_MIN		(1)
+#define FLEXCAN_CBT_PROP_MAX		(64)
+#define FLEXCAN_CBT_SEG1_MAX		(32)
+#define FLEXCAN_CBT_SEG2_MAX		(32)
+#define FLEXCAN_CBT_RJW_MAX			(32)
+#define FLEXCAN_CBT_PROP_BIAS		(1)
+#define FLEXCAN_CBT_TQ_MIN			(8)
+#define FLEXCAN_CBT_TDC				(0)
+
+#define FLEXCAN_FDCBT_PRESC_MAX		(1024)
+#define FLEXCAN_FDCBT_PROP_MIN		(0)
+#define FLEXCAN_FDCBT_PROP_MAX		(31)
+#define FLEXCAN_FDCBT_SEG1_MAX		(8)
+#define FLEXCAN_FDCBT_SEG2_MAX		(8)
+#define FLEXCAN_FDCBT_RJW_MAX		(8)
+#define FLEXCAN_FDCBT_PROP_BIAS		(0)
+#define FLEXCAN_FDCBT_TQ_MIN		(5)
+#define FLEXCAN_FDCBT_TDC			(1)		/* Data phase: transceiver delay compensation */
+
+#define FLEXCAN_TDCOFF_MAX			(31)
+#define FLEXCAN_TDC_PRESC_MAX		(2)		/* TDC works with FPRESDIV 0 or 1 only */
+
+/* Tolerances behind the _ERRORS bits, may be set before the include */
+#ifndef FLEXCAN_TIMING_RATE_TOL_PPM
+#define FLEXCAN_TIMING_RATE_TOL_PPM	(0)		/* Bit rate: exact */
+#endif
+#ifndef FLEXCAN_TIMING_SP_TOL
+#define FLEXCAN_TIMING_SP_TOL		(20)	/* Sample point: 2% */
+#endif
+
+/* <name>_ERRORS bits */
+#define FLEXCAN_TIMING_ERR_BITRATE	(0x01)	/* No prescaler divides the clock to the bit rate */
+#define FLEXCAN_TIMING_ERR_SAMPLE	(0x02)	/* Sample point off by more than FLEXCAN_TIMING_SP_TOL */
+#define FLEXCAN_TIMING_ERR_RANGE	(0x04)	/* Bit time does not fit the register fields */
+#define FLEXCAN_TIMING_ERR_DELAY	(0x08)	/* Propagation segment (nominal) or sample point without
+											   TDC (data) shorter than the delay */
+
+/* Solver steps, for the enum below and for the host tool */
+#define FLEXCAN_TIMING_MIN_(a, b)	(((a) < (b)) ? (a) : (b))
+#define FLEXCAN_TIMING_MAX_(a, b)	(((a) > (b)) ? (a) : (b))
+#define FLEXCAN_TIMING_TQ_MAX_(kind)	(1 + FLEXCAN_##kind##_PROP_MAX + FLEXCAN_##kind##_SEG1_MAX + FLEXCAN_##kind##_SEG2_MAX)
+#define FLEXCAN_TIMING_NS_(tq, presc, clk)	((int32_t)((int64_t)(tq) * (presc) * 1000000000LL / (clk)))
+
+/* Smallest prescaler for at most TQ_MAX quanta per bit */
+#define FLEXCAN_TIMING_P0_(kind, clk, rate) \
+	(((clk) + (int64_t)(rate) * FLEXCAN_TIMING_TQ_MAX_(kind) - 1) / ((int64_t)(rate) * FLEXCAN_TIMING_TQ_MAX_(kind)))
+
+/* Prescaler p divides clk to a whole number of quanta per bit in range (and to a propagation
+ * segment long enough for the delay when there is no TDC) */
+#define FLEXCAN_TIMING_FITS_(kind, clk, rate, p, delay) \
+	(((p) <= FLEXCAN_##kind##_PRESC_MAX) && \
+	 (((clk) % ((int64_t)(p) * (rate))) == 0) && \
+	 (((clk) / ((int64_t)(p) * (rate))) >= FLEXCAN_##kind##_TQ_MIN) && \
+	 (((clk) / ((int64_t)(p) * (rate))) <= FLEXCAN_TIMING_TQ_MAX_(kind)) && \
+	 (FLEXCAN_##kind##_TDC || \
+	  ((int64_t)FLEXCAN_##kind##_PROP_MAX * (p) * 1000000000LL >= 2LL * (delay) * (clk))))
+
+/* First fitting prescaler from p0 on, p0 (inexact bit rate) if none does */
+#define FLEXCAN_TIMING_PRESC_(kind, clk, rate, p0, delay) \
+	(FLEXCAN_TIMING_FITS_(kind, clk, rate, (p0), delay)     ? (p0)     : \
+	 FLEXCAN_TIMING_FITS_(kind, clk, rate, (p0) + 1, delay) ? (p0) + 1 : \
+	 FLEXCAN_TIMING_FITS_(kind, clk, rate, (p0) + 2, delay) ? (p0) + 2 : \
+	 FLEXCAN_TIMING_FITS_(kind, clk, rate, (p0) + 3, delay) ? (p0) + 3 : \
+	 FLEXCAN_TIMING_FITS_(kind, clk, rate, (p0) + 4, delay) ? (p0) + 4 : \
+	 FLEXCAN_TIMING_FITS_(kind, clk, rate, (p0) + 5, delay) ? (p0) + 5 : \
+	 FLEXCAN_TIMING_FITS_(kind, clk, rate, (p0) + 6, delay) ? (p0) + 6 : \
+	 FLEXCAN_TIMING_FITS_(kind, clk, rate, (p0) + 7, delay) ? (p0) + 7 : (p0))
+
+/* Quanta per bit, rounded */
+#define FLEXCAN_TIMING_TQ_(clk, rate, presc) \
+	(((clk) + (int64_t)(presc) * (rate) / 2) / ((int64_t)(presc) * (rate)))
+
+#define FLEXCAN_TIMING_CLAMP_(kind, tq) \
+	FLEXCAN_TIMING_MAX_(FLEXCAN_TIMING_MIN_((tq), FLEXCAN_TIMING_TQ_MAX_(kind)), FLEXCAN_##kind##_TQ_MIN)
+
+/* Sync + TSEG1 quanta closest to the sample point */
+#define FLEXCAN_TIMING_TSEG1_RAW_(tq, sp)	(((tq) * (sp) + 500) / 1000 - 1)
+
+/* TSEG1 within the fields: PSEG2 from 2 to SEG2_MAX, PROPSEG + PSEG1 within their maxima */
+#define FLEXCAN_TIMING_TSEG1_(kind, raw, tq) \
+	FLEXCAN_TIMING_MAX_(FLEXCAN_TIMING_MIN_(FLEXCAN_TIMING_MIN_(FLEXCAN_TIMING_MAX_((raw), \
+		(tq) - 1 - FLEXCAN_##kind##_SEG2_MAX), (tq) - 3), \
+		FLEXCAN_##kind##_PROP_MAX + FLEXCAN_##kind##_SEG1_MAX), FLEXCAN_##kind##_PROP_MIN + 1)
+
+/* Phase segment 1 equal to phase segment 2 unless the propagation segment overflows */
+#define FLEXCAN_TIMING_PHASE1_(kind, tseg1, tseg2) \
+	FLEXCAN_TIMING_MAX_(FLEXCAN_TIMING_MIN_(FLEXCAN_TIMING_MIN_((tseg2), FLEXCAN_##kind##_SEG1_MAX), \
+		(tseg1) - FLEXCAN_##kind##_PROP_MIN), (tseg1) - FLEXCAN_##kind##_PROP_MAX)
+
+#define FLEXCAN_TIMING_SJW_(kind, phase1, tseg2) \
+	FLEXCAN_TIMING_MIN_(FLEXCAN_TIMING_MIN_((phase1), (tseg2)), FLEXCAN_##kind##_RJW_MAX)
+
+/* Bit rate error in ppm */
+#define FLEXCAN_TIMING_PPM_(clk, rate, presc, tq) \
+	((int32_t)(((int64_t)(clk) - (int64_t)(rate) * (presc) * (tq)) * 1000000LL / ((int64_t)(rate) * (presc) * (tq))))
+
+/* Sample point in per mille */
+#define FLEXCAN_TIMING_SP_(tseg1, tq)	((1 + (tseg1)) * 1000 / (tq))
+
+#define FLEXCAN_TIMING_TDC_(kind, presc, tdcoff) \
+	(FLEXCAN_##kind##_TDC && ((presc) <= FLEXCAN_TDC_PRESC_MAX) && ((tdcoff) <= FLEXCAN_TDCOFF_MAX))
+
+#define FLEXCAN_TIMING_ERRORS_(kind, clk, sp, delay, presc, tq_raw, tseg1, tseg2, prop, ppm, sp_reached, tdc) \
+	((((ppm) > FLEXCAN_TIMING_RATE_TOL_PPM) || ((ppm) < -FLEXCAN_TIMING_RATE_TOL_PPM) ? FLEXCAN_TIMING_ERR_BITRATE : 0) | \
+	 (((sp_reached) - (sp) > FLEXCAN_TIMING_SP_TOL) || ((sp) - (sp_reached) > FLEXCAN_TIMING_SP_TOL) ? FLEXCAN_TIMING_ERR_SAMPLE : 0) | \
+	 (((tq_raw) < FLEXCAN_##kind##_TQ_MIN) || ((tq_raw) > FLEXCAN_TIMING_TQ_MAX_(kind)) || \
+	  ((presc) > FLEXCAN_##kind##_PRESC_MAX) || ((tseg2) < 2) || ((tseg2) > FLEXCAN_##kind##_SEG2_MAX) ? FLEXCAN_TIMING_ERR_RANGE : 0) | \
+	 ((FLEXCAN_##kind##_TDC ? (!(tdc) && (FLEXCAN_TIMING_NS_(1 + (tseg1), presc, clk) < (delay))) \
+							: (FLEXCAN_TIMING_NS_(prop, presc, clk) < 2 * (delay))) ? FLEXCAN_TIMING_ERR_DELAY : 0))
+
+/*!
+* @brief Solve a bit timing into enum constants <name>_*.
+*
+* @param[name] Prefix of the constants
+* @param[kind] CTRL1, CBT or FDCBT
+* @param[clk_hz] Protocol engine clock (CLKSRC selection) in Hz
+* @param[bitrate] Bit rate in bit/s
+* @param[sp_permille] Sample point in per mille of the bit time
+* @param[delay_ns] One-way delay between the farthest nodes in ns
+*/
+#define FLEXCAN_TIMING(name, kind, clk_hz, bitrate, sp_permille, delay_ns) \
+	enum \
+	{ \
+		name##_P0_        = FLEXCAN_TIMING_P0_(kind, clk_hz, bitrate), \
+		name##_PRESC      = FLEXCAN_TIMING_PRESC_(kind, clk_hz, bitrate, name##_P0_, delay_ns), \
+		name##_TQ_RAW_    = FLEXCAN_TIMING_TQ_(clk_hz, bitrate, name##_PRESC), \
+		name##_TQ         = FLEXCAN_TIMING_CLAMP_(kind, name##_TQ_RAW_), \
+		name##_TSEG1_RAW_ = FLEXCAN_TIMING_TSEG1_RAW_(name##_TQ, sp_permille), \
+		name##_TSEG1      = FLEXCAN_TIMING_TSEG1_(kind, name##_TSEG1_RAW_, name##_TQ), \
+		name##_TSEG2      = name##_TQ - 1 - name##_TSEG1, \
+		name##_PHASE1_    = FLEXCAN_TIMING_PHASE1_(kind, name##_TSEG1, name##_TSEG2), \
+		name##_PROP_      = name##_TSEG1 - name##_PHASE1_, \
+		name##_SJW_       = FLEXCAN_TIMING_SJW_(kind, name##_PHASE1_, name##_TSEG2), \
+		name##_PRESDIV    = name##_PRESC - 1, \
+		name##_PROPSEG    = name##_PROP_ - FLEXCAN_##kind##_PROP_BIAS, \
+		name##_PSEG1      = name##_PHASE1_ - 1, \
+		name##_PSEG2      = name##_TSEG2 - 1, \
+		name##_RJW        = name##_SJW_ - 1, \
+		name##_RATE_PPM   = FLEXCAN_TIMING_PPM_(clk_hz, bitrate, name##_PRESC, name##_TQ), \
+		name##_SP         = FLEXCAN_TIMING_SP_(name##_TSEG1, name##_TQ), \
+		name##_TDCOFF     = name##_PRESC * (1 + name##_TSEG1), \
+		name##_TDC        = FLEXCAN_TIMING_TDC_(kind, name##_PRESC, name##_TDCOFF), \
+		name##_ERRORS     = FLEXCAN_TIMING_ERRORS_(kind, clk_hz, sp_permille, delay_ns, name##_PRESC, \
+							name##_TQ_RAW_, name##_TSEG1, name##_TSEG2, name##_PROP_, \
+							name##_RATE_PPM, name##_SP, name##_TDC) \
+	}
+
+/* Build stops when the solution misses the request */
+#define FLEXCAN_TIMING_ASSERT(name) \
+	_Static_assert(name##_ERRORS == 0, #name ": CAN bit timing out of tolerance, see FlexCAN_Timing.h")
+
+/* Register values from field values. CTRL1: timing fields only, to be ORed with the other bits */
+#define FLEXCAN_CTRL1_TIMING_(presdiv, propseg, pseg1, pseg2, rjw) \
+	(((uint32_t)(presdiv) << 24) | ((uint32_t)(rjw) << 22) | ((uint32_t)(pseg1) << 19) | \
+	 ((uint32_t)(pseg2) << 16) | ((uint32_t)(propseg) << 0))
+
+#define FLEXCAN_CBT_TIMING_(presdiv, propseg, pseg1, pseg2, rjw) \
+	((1u << 31) | ((uint32_t)(presdiv) << 21) | ((uint32_t)(rjw) << 16) | \
+	 ((uint32_t)(propseg) << 10) | ((uint32_t)(pseg1) << 5) | ((uint32_t)(pseg2) << 0))
+
+#define FLEXCAN_FDCBT_TIMING_(presdiv, propseg, pseg1, pseg2, rjw) \
+	(((uint32_t)(presdiv) << 20) | ((uint32_t)(rjw) << 16) | \
+	 ((uint32_t)(propseg) << 10) | ((uint32_t)(pseg1) << 5) | ((uint32_t)(pseg2) << 0))
+
+/* FDCTRL TDCEN and TDCOFF, 0 when TDC cannot be used */
+#define FLEXCAN_FDCTRL_TDC_(tdc, tdcoff)	((tdc) ? ((1u << 15) | ((uint32_t)(tdcoff) << 8)) : 0u)
+
+/* Register values of a solved timing */
+#define FLEXCAN_TIMING_FIELDS_(name)	name##_PRESDIV, name##_PROPSEG, name##_PSEG1, name##_PSEG2, name##_RJW
+#define FLEXCAN_TIMING_APPLY_(macro, args)	macro args
+#define FLEXCAN_CTRL1_TIMING(name)	FLEXCAN_TIMING_APPLY_(FLEXCAN_CTRL1_TIMING_, (FLEXCAN_TIMING_FIELDS_(name)))
+#define FLEXCAN_CBT_TIMING(name)	FLEXCAN_TIMING_APPLY_(FLEXCAN_CBT_TIMING_, (FLEXCAN_TIMING_FIELDS_(name)))
+#define FLEXCAN_FDCBT_TIMING(name)	FLEXCAN_TIMING_APPLY_(FLEXCAN_FDCBT_TIMING_, (FLEXCAN_TIMING_FIELDS_(name)))
+#define FLEXCAN_FDCTRL_TDC(name)	FLEXCAN_FDCTRL_TDC_(name##_TDC, name##_TDCOFF)
+
+#endif /* FLEXCAN_TIMING_H_ */
@@ -43,6 +43,7 @@
 #include "device_registers.h"
 #include "clocks_and_modes.h"
 #include "dma.h"
+#include "profile.h"
 
 #define SOFF 1		/*	Define the source byte offset of the TCD after transfer	*/
 #define DOFF 1		/*	Define the destination byte offset of the TCD after transfer	*/
@@ -55,6 +56,14 @@ uint8_t volatile TCD0_Destination[SIZE1+SIZE2];			/*< (SIZE1+SIZE2) bytes length
 
 TCD_t TCDm[2] __attribute__ ((aligned(32)));	/* Define an array of 2 TCD_t variables aligned to 32 bits to maintain structure */
 
+enum
+{
+	PROFILE_DMA0_LATENCY,	/* Channel request enabled -> DMA0_IRQHandler entry */
+	PROFILE_DMA0_ISR		/* DMA0_IRQHandler cost */
+};
+
+const char * const PROFILE_names[] = { "DMA0 latency", "DMA0_IRQHandler" };
+
 void WDOG_disable (void)
 {
 	WDOG->CNT=0xD928C520;     /* Unlock watchdog 		*/
@@ -69,6 +78,7 @@ int main(void) {
 	SPLL_init_160MHz();    /* Initialize SPLL to 160 MHz with 8 MHz SOSC */
 	NormalRUNmode_80MHz(); /* Init clocks: 80 MHz sysclk & core, 40 MHz bus, 20 MHz flash */
 	DMA_SG_init();		   /* Initiliaze DMAMUX to always generate DMA requests */
+	PROFILE_init(PROFILE_names, 2);	/* Start the DWT cycle counter */
 
 	S32_NVIC->ICPR[0] |= 1 << (0 % 32);  /* IRQ0-DMA0 ch0: clr any pending IRQ	*/
 	S32_NVIC->ISER[0] |= 1 << (0 % 32);  /* IRQ0-DMA0 ch0: enable IRQ 			*/
@@ -82,6 +92,7 @@ int main(void) {
 	DMA_TCDm_config((uint32_t *)&TCD0_Source_2[0], SOFF, (uint32_t *)&TCD0_Destination[6], DOFF, SIZE2, &TCDm[1]); /* saving TCD config in RAM */
 
 	DMA_TCD_Push(0,&TCDm[0]);	/* "Push" TCD with index 0 to DMA channel 0 */
+	PROFILE_begin(PROFILE_DMA0_LATENCY);
 	DMA->SERQ = DMA_SERQ_SERQ(0);	/*	Enable DMA CH0 request	*/
 
     for (;;) {
@@ -98,7 +109,10 @@ int main(void) {
 
 void DMA0_IRQHandler (void)
 {
+	 PROFILE_end(PROFILE_DMA0_LATENCY);	/* Request to handler entry, both scatter/gather TCDs */
+	 PROFILE_ISR_ENTER(PROFILE_DMA0_ISR);
 	 DMA->CDNE |= DMA_CDNE_CADN(0x0);	/* Clear all Done status bit */
 	 DMA->CINT |= 0;					/* Clear Interrupt request */
+	 PROFILE_ISR_EXIT(PROFILE_DMA0_ISR);
 	 /* Set a breakpoint here and keep an eye on the TCD0_Destination Array inside the DMA driver */
 }
@@ -32,16 +32,35 @@
 
 #include "device_registers.h"	/* include peripheral declarations */
 #include "FlexCAN.h"
+#include "FlexCAN_TX.h"
+#include "FlexCAN_RX.h"
+#include "FlexCAN_Timing.h"
+#include "FlexCAN_Layout.h"
 
-uint32_t  RxCODE;              /*< Received message buffer code 			*/
-uint32_t  RxID;                /*< Received message ID 					*/
-uint32_t  RxLENGTH;            /*< Recieved message number of data bytes 	*/
-uint32_t  RxDATA[2];           /*< Received message data (2 words) 		*/
-uint32_t  RxTIMESTAMP;         /*< Received message time 					*/
+#define TX_QUEUE_SIZE	16
+#define RX_RING_SLOTS	32		/* Power of 2 */
+
+FLEXCAN_LAYOUT(CAN0_LAYOUT, 8, 0, 4, 4);	/* CAN 2.0: 8-byte MBs, MB0..3 receive, MB4..7 transmit */
+FLEXCAN_LAYOUT_ASSERT(CAN0_LAYOUT);
+
+#if defined(S32K11x_SERIES)
+#define CAN_CLK_HZ		40000000	/* CLKSRC=0: 40 MHz PE clock */
+#else
+#define CAN_CLK_HZ		8000000		/* CLKSRC=0: SOSCDIV2 = 8 MHz */
+#endif
+#define CAN_DELAY_NS	250			/* Transceiver loop delay and bus line, one way */
+
+FLEXCAN_TIMING(CAN_NOMINAL, CTRL1, CAN_CLK_HZ, 500000, 750, CAN_DELAY_NS);	/* 500 KHz, SP 75% */
+FLEXCAN_TIMING_ASSERT(CAN_NOMINAL);
+
+FLEXCAN_TX_t FLEXCAN0_tx;								/*< MB4..7 transmit queue 	*/
+static FLEXCAN_TX_Frame_t TxQueue[TX_QUEUE_SIZE];		/*< Frames waiting for an MB */
+FLEXCAN_RX_t FLEXCAN0_rx;								/*< MB0..3 receive ring 	*/
+static uint32_t RxRing[RX_RING_SLOTS * CAN0_LAYOUT_MB_WORDS];	/*< Received MB images */
 
 void FLEXCAN0_init(void)
 {
-#define MSG_BUF_SIZE  4		/* Msg Buffer Size. (CAN 2.0AB: 2 hdr +  2 data= 4 words) */
+#define MSG_BUF_SIZE  CAN0_LAYOUT_MB_WORDS	/* Msg Buffer Size. (CAN 2.0AB: 2 hdr +  2 data= 4 words) */
   uint32_t   i=0;
 
   PCC->PCCn[PCC_FlexCAN0_INDEX] |= PCC_PCCn_CGC_MASK; /* CGC=1: enable clock to FlexCAN0 */
@@ -56,20 +75,11 @@ void FLEXCAN0_init(void)
 	 * ===================================================
 	 * wait for FRZACK=1 on freeze mode entry/exit
 	 */
-  CAN0->CTRL1 = 0
-      #if defined(S32K11x_SERIES)
-      |CAN_CTRL1_PRESDIV(4)   /* PRESDIV=4: Sclock=PEclock/(PRESDIV+1) = 40MHz/5 = 8MHz    */
-      #endif
-      |CAN_CTRL1_PSEG2(3)	    /* Configure for 500 KHz bit time 								*/
-		  |CAN_CTRL1_PSEG1(3) 		/* Time quanta freq = 16 time quanta x 500 KHz bit time= 8MHz 	*/
-		  |CAN_CTRL1_PROPSEG(6)		/* PRESDIV+1 = Fclksrc/Ftq = 8 MHz/8 MHz = 1 					*/
-		  |CAN_CTRL1_RJW(3)			/*    so PRESDIV = 0 											*/
-		  |CAN_CTRL1_SMP(1); 		/* PSEG2 = Phase_Seg2 - 1 = 4 - 1 = 3 							*/
-								            /* PSEG1 = PSEG2 = 3 											*/
-									/* PROPSEG= Prop_Seg - 1 = 7 - 1 = 6 							*/
-									/* RJW: since Phase_Seg2 >=4, RJW+1=4 so RJW=3. 				*/
+  CAN0->CTRL1 = FLEXCAN_CTRL1_TIMING(CAN_NOMINAL)	/* Configure for 500 KHz bit time, SP 75% */
+		  |CAN_CTRL1_SMP(1); 		/* Time quanta, PRESDIV, PROPSEG, PSEG1/2 and RJW	*/
+									/*   are solved at compile time by FLEXCAN_TIMING 	*/
+									/* 8 MHz: 16 tq, PRESDIV=0, PROPSEG=6, PSEG1=PSEG2=3 	*/
 									/* SMP = 1: use 3 bits per CAN sample 							*/
-									/* CLKSRC=0 (unchanged): Fcanclk= Fosc= 8 MHz 					*/
 
   for(i=0; i<128; i++ )
   {   					/* CAN0: clear 32 msg bufs x 4 words/msg buf = 128 words */
@@ -80,69 +90,59 @@ void FLEXCAN0_init(void)
     CAN0->RXIMR[i] = 0xFFFFFFFF;  	/* Check all ID bits for incoming messages */
   }
   CAN0->RXMGMASK = 0x1FFFFFFF;  				/* Global acceptance mask: check all ID bits 	*/
-  CAN0->RAMn[ 4*MSG_BUF_SIZE + 0] = 0x04000000; /* Msg Buf 4, word 0: Enable for reception 	*/
+  for(i=CAN0_LAYOUT_RX_FIRST; i<CAN0_LAYOUT_RX_FIRST+CAN0_LAYOUT_RX_COUNT; i++ )
+  {                                             /* Same ID in MB0..3: a burst fills them in turn */
+    CAN0->RAMn[ i*MSG_BUF_SIZE + 0] = 0x04000000; /* Msg Buf i, word 0: Enable for reception 	*/
                                                 /* EDL,BRS,ESI=0: CANFD not used 				*/
-                                                /* CODE=4: MB set to RX inactive 				*/
+                                                /* CODE=4: MB set to RX empty 					*/
                                                 /* IDE=0: Standard ID 							*/
                                                 /* SRR, RTR, TIME STAMP = 0: not applicable 	*/
 #ifdef NODE_A                                   /* Node A receives msg with std ID 0x511 		*/
-  CAN0->RAMn[ 4*MSG_BUF_SIZE + 1] = 0x14440000; /* Msg Buf 4, word 1: Standard ID = 0x111 		*/
+    CAN0->RAMn[ i*MSG_BUF_SIZE + 1] = 0x14440000; /* Msg Buf i, word 1: Standard ID = 0x511 	*/
 #else                                           /* Node B to receive msg with std ID 0x555 	*/
-  CAN0->RAMn[ 4*MSG_BUF_SIZE + 1] = 0x15540000; /* Msg Buf 4, word 1: Standard ID = 0x555 		*/
+    CAN0->RAMn[ i*MSG_BUF_SIZE + 1] = 0x15540000; /* Msg Buf i, word 1: Standard ID = 0x555 	*/
 #endif
+  }
                                 /* PRIO = 0: CANFD not used */
-  CAN0->MCR = 0x0000001F;       /* Negate FlexCAN 1 halt state for 32 MBs */
+  CAN0->MCR = FLEXCAN_MCR_LAYOUT(CAN0_LAYOUT);	/* Negate FlexCAN 1 halt state, MAXMB: last MB in use (MB7) */
 
   while ((CAN0->MCR && CAN_MCR_FRZACK_MASK) >> CAN_MCR_FRZACK_SHIFT)  {}
   /* Good practice: wait for FRZACK to clear (not in freeze mode) */
 
   while ((CAN0->MCR && CAN_MCR_NOTRDY_MASK) >> CAN_MCR_NOTRDY_SHIFT)  {}
   /* Good practice: wait for NOTRDY to clear (module ready) */
+
+  FLEXCAN_TX_init(&FLEXCAN0_tx, 0, CAN0_LAYOUT_TX_FIRST, CAN0_LAYOUT_TX_COUNT, MSG_BUF_SIZE, TxQueue, TX_QUEUE_SIZE);
+  	  	  	  	  	  	  	  	  	  	  	  	/* MB4..7 transmit through the queue:			*/
+  	  	  	  	  	  	  	  	  	  	  	  	/* LPRIOEN=1, LBUF=0, IRQ at each TX completion */
+  FLEXCAN_RX_init(&FLEXCAN0_rx, 0, CAN0_LAYOUT_RX_FIRST, CAN0_LAYOUT_RX_COUNT, MSG_BUF_SIZE, RxRing, RX_RING_SLOTS);
+  	  	  	  	  	  	  	  	  	  	  	  	/* MB0..3 drain into RxRing from the MB IRQ 	*/
 }
 
 void FLEXCAN0_transmit_msg(void)
 {
-	/*! Assumption:
+	/*! Queue the frame:
 	 * =================================
-	 * Message buffer CODE is INACTIVE
+	 * Returns at once. The frame goes to a free MB among MB4..7 or waits in TxQueue
+	 * for the TX interrupt to free one.
 	 */
-	CAN0->IFLAG1 = 0x00000001;	/* Clear CAN 0 MB 0 flag without clearing others*/
+  FLEXCAN_TX_Frame_t frame;
 
-  CAN0->RAMn[ 0*MSG_BUF_SIZE + 2] = 0xA5112233;	/* MB0 word 2: data word 0 */
-  CAN0->RAMn[ 0*MSG_BUF_SIZE + 3] = 0x44556677; /* MB0 word 3: data word 1 */
+  frame.payload[0] = 0xA5112233;				/* Data word 0 */
+  frame.payload[1] = 0x44556677;				/* Data word 1 */
 #ifdef NODE_A
-  CAN0->RAMn[ 0*MSG_BUF_SIZE + 1] = 0x15540000; /* MB0 word 1: Tx msg with STD ID 0x555 */
+  frame.ID = 0x555;								/* Tx msg with STD ID 0x555 */
 #else
-  CAN0->RAMn[ 0*MSG_BUF_SIZE + 1] = 0x14440000; /* MB0 word 1: Tx msg with STD ID 0x511 */
+  frame.ID = 0x511;								/* Tx msg with STD ID 0x511 */
 #endif
-  CAN0->RAMn[ 0*MSG_BUF_SIZE + 0] = 0x0C400000 | 8 << CAN_WMBn_CS_DLC_SHIFT;
-  	  	  	  	  	  	  	  	  	  	  	  	/* MB0 word 0: 								*/
-                                                /* EDL,BRS,ESI=0: CANFD not used 				*/
-                                                /* CODE=0xC: Activate msg buf to transmit 		*/
-                                                /* IDE=0: Standard ID 							*/
-                                                /* SRR=1 Tx frame (not req'd for std ID) 		*/
-                                                /* RTR = 0: data, not remote tx request frame	*/
-                                                /* DLC = 8 bytes 								*/
+  frame.prio  = 0;								/* PRIO = 0: first among the local frames */
+  frame.flags = 0;								/* Standard ID, CANFD not used 			*/
+  frame.dlc   = 8;								/* DLC = 8 bytes 						*/
+  FLEXCAN_TX_send(&FLEXCAN0_tx, &frame);
 }
 
-void FLEXCAN0_receive_msg(void)
+void CAN0_ORed_0_15_MB_IRQHandler(void)
 {
-/*! Receive msg from ID 0x556 using msg buffer 4
- * =============================================
- */
-  uint8_t j;
-  uint32_t dummy;
-
-  RxCODE   = (CAN0->RAMn[ 4*MSG_BUF_SIZE + 0] & 0x07000000) >> 24;	/* Read CODE field */
-  RxID     = (CAN0->RAMn[ 4*MSG_BUF_SIZE + 1] & CAN_WMBn_ID_ID_MASK)  >> CAN_WMBn_ID_ID_SHIFT;	/* Read ID 			*/
-  RxLENGTH = (CAN0->RAMn[ 4*MSG_BUF_SIZE + 0] & CAN_WMBn_CS_DLC_MASK) >> CAN_WMBn_CS_DLC_SHIFT;	/* Read Message Length */
-
-  for (j=0; j<2; j++)
-  {  /* Read two words of data (8 bytes) */
-    RxDATA[j] = CAN0->RAMn[ 4*MSG_BUF_SIZE + 2 + j];
-  }
-  RxTIMESTAMP = (CAN0->RAMn[ 0*MSG_BUF_SIZE + 0] & 0x000FFFF);
-  dummy = CAN0->TIMER;             /* Read TIMER to unlock message buffers */
-  CAN0->IFLAG1 = 0x00000010;       /* Clear CAN 0 MB 4 flag without clearing others*/
+  FLEXCAN_RX_IRQHandler(&FLEXCAN0_rx);			/* MB0..3 full: copy them into the ring 	*/
+  FLEXCAN_TX_IRQHandler(&FLEXCAN0_tx);			/* MB4..7 done: reload them from the queue */
 }
-
@@ -35,8 +35,13 @@
 
 #define NODE_A        /* If using 2 boards as 2 nodes, NODE A & B use different CAN IDs */
 
+#include "FlexCAN_TX.h"
+#include "FlexCAN_RX.h"
+
+extern FLEXCAN_TX_t FLEXCAN0_tx;
+extern FLEXCAN_RX_t FLEXCAN0_rx;
+
 void FLEXCAN0_init (void);
 void FLEXCAN0_transmit_msg (void);
-void FLEXCAN0_receive_msg (void);
 
 #endif /* FLEXCAN_H_ */
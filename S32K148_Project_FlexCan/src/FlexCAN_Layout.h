@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLEXCAN_LAYOUT_H_
+#define FLEXCAN_LAYOUT_H_
+
+#include <stdint.h>
+
+/*!
+ * Description:
+ * ===================================================
+ * Message buffer layout planner. The FlexCAN RAM of the S32K148 is one 512-byte region
+ * (FDCTRL[MBDSR0] only, no MBDSR1) holding 32 MBs of 8 bytes, 21 of 16, 12 of 32 or 7 of 64.
+ * From the payload size, the RX FIFO filter elements and the RX/TX MB counts the compiler
+ * places the buffers and derives the register fields:
+ *
+ * 	FLEXCAN_LAYOUT(CAN0_LAYOUT, 8, 0, 4, 4);		8-byte MBs, no FIFO, 4 RX and 4 TX MBs
+ * 	FLEXCAN_LAYOUT_ASSERT(CAN0_LAYOUT);
+ * 	FLEXCAN_LAYOUT_TYPE(CAN0_LAYOUT);				CAN0_LAYOUT_MB_t: cs, id, data[2]
+ *
+ * 	CAN0->MCR    = (CAN0->MCR & ~FLEXCAN_MCR_LAYOUT_MASK) | FLEXCAN_MCR_LAYOUT(CAN0_LAYOUT);
+ * 	CAN0->CTRL2  = ... | FLEXCAN_CTRL2_LAYOUT(CAN0_LAYOUT);
+ * 	CAN0->FDCTRL = ... | FLEXCAN_FDCTRL_LAYOUT(CAN0_LAYOUT);
+ * 	FLEXCAN_LAYOUT_MBS(CAN0_LAYOUT, CAN0->RAMn)[CAN0_LAYOUT_RX_FIRST].cs = ...;
+ *
+ * The RAM is filled in this order:
+ *
+ * 	- RX FIFO (fifo_filters > 0, 8-byte MBs only): output and storage in MB0..MB5, then the ID
+ * 	  filter table, 4 elements per MB, from RAMn[24] (CTRL2[RFFN] = filters / 8 - 1),
+ * 	- RX MBs from <name>_RX_FIRST, matched before the TX MBs,
+ * 	- TX MBs from <name>_TX_FIRST,
+ * 	- MCR[MAXMB] stops at the last TX MB; the <name>_FREE MBs left in the RAM are not scanned.
+ *
+ * FLEXCAN_LAYOUT declares enum constants <name>_PAYLOAD, _MB_WORDS, _MBDSR, _MB_COUNT (MBs the
+ * RAM holds at that size), _FIFO, _FILTERS, _RFFN, _FIFO_MBS, _RX_FIRST, _RX_COUNT, _TX_FIRST,
+ * _TX_COUNT, _MBS (MBs in use), _MAXMB, _FREE and _ERRORS; bit field drivers size their MB
+ * arrays with them.
+ */
+
+#define FLEXCAN_RAM_WORDS			(128)	/* 512 bytes of MB RAM per instance */
+#define FLEXCAN_MAX_MBS				(32)
+#define FLEXCAN_FIFO_MBS			(6)		/* RX FIFO output and storage: MB0..MB5 */
+#define FLEXCAN_FIFO_FILTERS_MAX	(128)	/* RFFN = 15 */
+
+/* <name>_ERRORS bits */
+#define FLEXCAN_LAYOUT_ERR_PAYLOAD	(0x01)	/* Payload is not 8, 16, 32 or 64 bytes */
+#define FLEXCAN_LAYOUT_ERR_FIFO		(0x02)	/* The RX FIFO needs 8-byte MBs (no CAN-FD) */
+#define FLEXCAN_LAYOUT_ERR_FILTERS	(0x04)	/* FIFO filter elements not a multiple of 8 up to 128 */
+#define FLEXCAN_LAYOUT_ERR_RAM		(0x08)	/* More MBs than the RAM holds at this size */
+
+/* Planner steps */
+#define FLEXCAN_LAYOUT_MBDSR_(bytes) \
+	(((bytes) == 64) ? 3 : ((bytes) == 32) ? 2 : ((bytes) == 16) ? 1 : 0)
+
+#define FLEXCAN_LAYOUT_MB_COUNT_(words) \
+	(((FLEXCAN_RAM_WORDS / (words)) < FLEXCAN_MAX_MBS) ? (FLEXCAN_RAM_WORDS / (words)) : FLEXCAN_MAX_MBS)
+
+/* MBs taken by the RX FIFO and its ID filter table */
+#define FLEXCAN_LAYOUT_FIFO_MBS_(filters)	(((filters) > 0) ? FLEXCAN_FIFO_MBS + (filters) / 4 : 0)
+
+#define FLEXCAN_LAYOUT_ERRORS_(bytes, filters, mbs, mb_count) \
+	((((bytes) != 8) && ((bytes) != 16) && ((bytes) != 32) && ((bytes) != 64) ? FLEXCAN_LAYOUT_ERR_PAYLOAD : 0) | \
+	 (((filters) > 0) && ((bytes) != 8) ? FLEXCAN_LAYOUT_ERR_FIFO : 0) | \
+	 (((filters) < 0) || ((filters) % 8 != 0) || ((filters) > FLEXCAN_FIFO_FILTERS_MAX) ? FLEXCAN_LAYOUT_ERR_FILTERS : 0) | \
+	 (((mbs) > (mb_count)) || ((mbs) == 0) ? FLEXCAN_LAYOUT_ERR_RAM : 0))
+
+/*!
+* @brief Plan a message buffer layout into enum constants <name>_*.
+*
+* @param[name] Prefix of the constants
+* @param[payload_bytes] Payload per MB: 8, 16, 32 or 64 (FDCTRL[MBDSR0])
+* @param[fifo_filters] RX FIFO ID filter elements, 8 to 128 by 8; 0 without RX FIFO
+* @param[rx_mbs] RX message buffers after the FIFO
+* @param[tx_mbs] TX message buffers after the RX MBs
+*/
+#define FLEXCAN_LAYOUT(name, payload_bytes, fifo_filters, rx_mbs, tx_mbs) \
+	enum \
+	{ \
+		name##_PAYLOAD  = (payload_bytes), \
+		name##_MB_WORDS = 2 + (payload_bytes) / 4, \
+		name##_MBDSR    = FLEXCAN_LAYOUT_MBDSR_(payload_bytes), \
+		name##_MB_COUNT = FLEXCAN_LAYOUT_MB_COUNT_(name##_MB_WORDS), \
+		name##_FIFO     = ((fifo_filters) > 0), \
+		name##_FILTERS  = (fifo_filters), \
+		name##_RFFN     = name##_FIFO ? (fifo_filters) / 8 - 1 : 0, \
+		name##_FIFO_MBS = FLEXCAN_LAYOUT_FIFO_MBS_(fifo_filters), \
+		name##_RX_FIRST = name##_FIFO_MBS, \
+		name##_RX_COUNT = (rx_mbs), \
+		name##_TX_FIRST = name##_RX_FIRST + (rx_mbs), \
+		name##_TX_COUNT = (tx_mbs), \
+		name##_MBS      = name##_TX_FIRST + (tx_mbs), \
+		name##_MAXMB    = (name##_MBS > 0) ? name##_MBS - 1 : 0, \
+		name##_FREE     = name##_MB_COUNT - name##_MBS, \
+		name##_ERRORS   = FLEXCAN_LAYOUT_ERRORS_(payload_bytes, fifo_filters, name##_MBS, name##_MB_COUNT) \
+	}
+
+/* Build stops when the layout does not fit */
+#define FLEXCAN_LAYOUT_ASSERT(name) \
+	_Static_assert(name##_ERRORS == 0, #name ": FlexCAN message buffers do not fit, see FlexCAN_Layout.h")
+
+/* Message buffer of the layout: C/S word, ID word and the payload words */
+#define FLEXCAN_LAYOUT_TYPE(name) \
+	typedef struct \
+	{ \
+		uint32_t cs; \
+		uint32_t id; \
+		uint32_t data[name##_PAYLOAD / 4]; \
+	} name##_MB_t; \
+	_Static_assert(sizeof(name##_MB_t) == 4u * name##_MB_WORDS, #name ": MB stride")
+
+/* Accessors over the RAMn array: MBs of the layout type, raw MB words, FIFO ID filter elements */
+#define FLEXCAN_LAYOUT_MBS(name, ram)		((volatile name##_MB_t *)(ram))
+#define FLEXCAN_LAYOUT_MB(name, ram, mb)	(&(ram)[(uint32_t)(mb) * name##_MB_WORDS])
+#define FLEXCAN_LAYOUT_FILTER(name, ram, k)	(&(ram)[4u * FLEXCAN_FIFO_MBS + (uint32_t)(k)])
+
+/* Register fields of the layout */
+#define FLEXCAN_MCR_LAYOUT_MASK		(0x2000007Fu)	/* RFEN, MAXMB */
+#define FLEXCAN_CTRL2_LAYOUT_MASK	(0x0F000000u)	/* RFFN */
+#define FLEXCAN_FDCTRL_LAYOUT_MASK	(0x00030000u)	/* MBDSR0 */
+
+#define FLEXCAN_MCR_LAYOUT(name)	(((uint32_t)name##_FIFO << 29) | (uint32_t)name##_MAXMB)
+#define FLEXCAN_CTRL2_LAYOUT(name)	((uint32_t)name##_RFFN << 24)
+#define FLEXCAN_FDCTRL_LAYOUT(name)	((uint32_t)name##_MBDSR << 16)
+
+#endif /* FLEXCAN_LAYOUT_H_ */
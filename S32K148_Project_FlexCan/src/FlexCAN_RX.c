@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"	/* include peripheral declarations */
+#include "FlexCAN_RX.h"
+
+/*!
+ * Description:
+ * ===================================================
+ * The application sets up the RX message buffers (CODE=EMPTY, ID, masks) as usual and then
+ * calls FLEXCAN_RX_init, which enables their interrupts. FLEXCAN_RX_IRQHandler, called from
+ * CANn_ORed_0_15_MB_IRQHandler, drains every flagged MB in one pass, lowest MB first:
+ *
+ * 	- the MB words (C/S, ID, payload) are copied into the next ring slot in one run,
+ * 	- C/S is written back to EMPTY so the MB takes the next frame at once,
+ * 	- IFLAG1 is re-read until no RX flag is left, then TIMER releases the MB lock.
+ *
+ * The consumer gets a pointer into the ring with FLEXCAN_RX_peek and hands the slot back with
+ * FLEXCAN_RX_release; the payload is never copied again.
+ */
+
+#define FLEXCAN_MB_CODE_SHIFT		(24u)
+#define FLEXCAN_MB_CODE_MASK		(0x0F000000u)
+#define FLEXCAN_MB_CODE_RX_EMPTY	(0x4u)
+#define FLEXCAN_MB_CODE_RX_OVERRUN	(0x6u)
+
+static CAN_Type * const FLEXCAN_bases[] = CAN_BASE_PTRS;
+static const IRQn_Type FLEXCAN_irqs_0_15[] = CAN_ORed_0_15_MB_IRQS;
+static const IRQn_Type FLEXCAN_irqs_16_31[] = CAN_ORed_16_31_MB_IRQS;
+
+static void NVIC_enable(IRQn_Type irq)
+{
+	S32_NVIC->ICPR[(uint32_t)irq >> 5u] = 1u << ((uint32_t)irq & 0x1Fu);	/* Clear any pending IR */
+	S32_NVIC->ISER[(uint32_t)irq >> 5u] = 1u << ((uint32_t)irq & 0x1Fu);	/* Enable IRQ */
+}
+
+/*!
+* @brief Attach a frame ring to RX message buffers already set up for reception.
+*
+* @param[FLEXCAN_RX_t * rx] Ring state
+* @param[uint8_t instance] FlexCAN instance, configured by its init function
+* @param[uint8_t first_mb] First RX message buffer
+* @param[uint8_t mb_count] Number of RX message buffers
+* @param[uint8_t mb_words] Words per MB: 4 (8-byte payload) up to 18 (64-byte payload)
+* @param[uint32_t * ring] Storage for slots * mb_words words
+* @param[uint16_t slots] Number of frames in the ring, power of 2
+*/
+void FLEXCAN_RX_init(FLEXCAN_RX_t * rx, uint8_t instance, uint8_t first_mb, uint8_t mb_count,
+					 uint8_t mb_words, uint32_t * ring, uint16_t slots)
+{
+	CAN_Type * base;
+
+	DEV_ASSERT(instance < CAN_INSTANCE_COUNT);
+	DEV_ASSERT((mb_count > 0u) && ((uint32_t)first_mb + mb_count <= 32u));
+	DEV_ASSERT((mb_words >= 4u) && (mb_words <= 18u));
+	DEV_ASSERT((slots != 0u) && ((slots & (slots - 1u)) == 0u) && (slots <= 32768u));
+
+	base = FLEXCAN_bases[instance];
+
+	rx->instance    = instance;
+	rx->first_mb    = first_mb;
+	rx->mb_count    = mb_count;
+	rx->mb_words    = mb_words;
+	rx->mb_mask     = (uint32_t)(((1ull << mb_count) - 1u) << first_mb);
+	rx->ring        = ring;
+	rx->slot_mask   = (uint16_t)(slots - 1u);
+	rx->head        = 0;
+	rx->tail        = 0;
+	rx->received    = 0;
+	rx->overruns    = 0;
+	rx->overwritten = 0;
+
+	base->IMASK1 |= rx->mb_mask;			/* IRQ at every reception, frames already in are drained */
+	if (rx->mb_mask & 0x0000FFFFu)
+	{
+		NVIC_enable(FLEXCAN_irqs_0_15[instance]);
+	}
+	if (rx->mb_mask & 0xFFFF0000u)
+	{
+		NVIC_enable(FLEXCAN_irqs_16_31[instance]);
+	}
+}
+
+/*!
+* @brief Oldest received frame, left in the ring until FLEXCAN_RX_release.
+*
+* @param[FLEXCAN_RX_t * rx] Ring
+* @return Frame, NULL if the ring is empty
+*/
+const FLEXCAN_RX_Frame_t * FLEXCAN_RX_peek(FLEXCAN_RX_t * rx)
+{
+	uint16_t tail = rx->tail;
+
+	if (rx->head == tail)
+	{
+		return NULL;
+	}
+	return (const FLEXCAN_RX_Frame_t *) &rx->ring[(uint32_t)(tail & rx->slot_mask) * rx->mb_words];
+}
+
+/*!
+* @brief Give the slot of the frame returned by FLEXCAN_RX_peek back to the ring.
+*
+* @param[FLEXCAN_RX_t * rx] Ring
+*/
+void FLEXCAN_RX_release(FLEXCAN_RX_t * rx)
+{
+	if (rx->head != rx->tail)
+	{
+		rx->tail = (uint16_t)(rx->tail + 1u);
+	}
+}
+
+/*!
+* @brief Number of frames waiting in the ring.
+*
+* @param[FLEXCAN_RX_t * rx] Ring
+* @return Frames not released yet
+*/
+uint16_t FLEXCAN_RX_pending(FLEXCAN_RX_t * rx)
+{
+	return (uint16_t)(rx->head - rx->tail);
+}
+
+/*!
+* @brief RX MB interrupt: move every full RX MB into the ring.
+*
+* @param[FLEXCAN_RX_t * rx] Ring
+*/
+void FLEXCAN_RX_IRQHandler(FLEXCAN_RX_t * rx)
+{
+	CAN_Type * base = FLEXCAN_bases[rx->instance];
+	uint32_t flags = base->IFLAG1 & rx->mb_mask;
+	uint16_t head = rx->head;
+
+	if (flags == 0u)
+	{
+		return;
+	}
+	while (flags != 0u)
+	{
+		uint32_t mb = (uint32_t)__builtin_ctz(flags);		/* Lowest flagged MB: RBIT + CLZ */
+		volatile uint32_t * buf = &base->RAMn[mb * rx->mb_words];
+		uint32_t cs = buf[0];								/* C/S read locks the MB */
+
+		if ((uint16_t)(head - rx->tail) <= rx->slot_mask)
+		{
+			uint32_t * slot = &rx->ring[(uint32_t)(head & rx->slot_mask) * rx->mb_words];
+			uint32_t word;
+
+			slot[0] = cs;
+			for (word = 1u; word < rx->mb_words; word++)
+			{
+				slot[word] = buf[word];						/* ID and payload */
+			}
+			head++;
+			rx->received++;
+		}
+		else
+		{
+			rx->overruns++;									/* Ring full: the frame is dropped */
+		}
+		if (((cs & FLEXCAN_MB_CODE_MASK) >> FLEXCAN_MB_CODE_SHIFT) == FLEXCAN_MB_CODE_RX_OVERRUN)
+		{
+			rx->overwritten++;
+		}
+		buf[0] = (cs & CAN_WMBn_CS_IDE_MASK) |
+				 (FLEXCAN_MB_CODE_RX_EMPTY << FLEXCAN_MB_CODE_SHIFT);	/* MB free for the next frame */
+		base->IFLAG1 = 1u << mb;							/* W1C, other flags untouched */
+
+		flags &= flags - 1u;
+		if (flags == 0u)
+		{
+			rx->head = head;								/* Publish before looking again */
+			flags = base->IFLAG1 & rx->mb_mask;				/* Frames that came during the pass */
+		}
+	}
+	(void)base->TIMER;										/* Release the lock of the last MB */
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLEXCAN_TX_H_
+#define FLEXCAN_TX_H_
+
+#include <stdint.h>
+
+/* Largest payload kept per queued frame: 64 bytes (CAN-FD) */
+#define FLEXCAN_TX_MAX_WORDS	(16u)
+
+/* Most TX message buffers one queue can use */
+#define FLEXCAN_TX_MAX_MBS		(8u)
+
+/* FLEXCAN_TX_Frame_t flags */
+#define FLEXCAN_TX_EXTENDED		(0x01u)		/* 29-bit ID instead of 11-bit */
+#define FLEXCAN_TX_FD			(0x02u)		/* CAN-FD frame (EDL) */
+#define FLEXCAN_TX_BRS			(0x04u)		/* CAN-FD frame with bit rate switch */
+
+/*!
+* @brief Frame handed to the transmit queue.
+*/
+typedef struct
+{
+	uint32_t ID;							/* 11-bit or 29-bit identifier, right aligned */
+	uint8_t  prio;							/* Local priority 0 (first) to 7, MB PRIO field */
+	uint8_t  flags;							/* FLEXCAN_TX_EXTENDED, FLEXCAN_TX_FD, FLEXCAN_TX_BRS */
+	uint8_t  dlc;							/* Data length code, 0 to 15 */
+	uint32_t payload[FLEXCAN_TX_MAX_WORDS];
+} FLEXCAN_TX_Frame_t;
+
+/* Transmit scheduler over a contiguous range of message buffers. Frames are kept in a queue
+ * sorted by local priority and ID and go to whichever TX MB is free; the MB interrupt
+ * reports completions and reloads the freed MBs, so the caller never waits for the bus.
+ * MCR[LPRIOEN] adds the PRIO field in front of the ID for the internal arbitration and
+ * CTRL1[LBUF] = 0 lets the lowest arbitration value win instead of the lowest MB. */
+typedef struct
+{
+	uint8_t  instance;						/* 0 for CAN0, 1 for CAN1, 2 for CAN2 */
+	uint8_t  first_mb;						/* First TX message buffer */
+	uint8_t  mb_count;						/* TX message buffers, up to FLEXCAN_TX_MAX_MBS */
+	uint8_t  mb_words;						/* Words per MB: 4 for 8-byte payloads, 18 for 64 */
+	uint32_t mb_mask;						/* IFLAG1/IMASK1 bits of the TX MBs */
+	volatile uint32_t busy;					/* MBs holding a frame for the bus */
+	volatile uint32_t aborting;				/* MB asked to give way to a higher priority frame */
+	uint64_t rank[FLEXCAN_TX_MAX_MBS];		/* Arbitration value of the frame in each TX MB */
+	FLEXCAN_TX_Frame_t * queue;				/* Frames waiting for an MB, highest priority first */
+	uint8_t  queue_size;
+	volatile uint8_t queue_count;
+	volatile uint32_t sent;					/* Frames transmitted */
+	volatile uint32_t preempted;			/* Frames pulled back from an MB and queued again */
+	volatile uint32_t dropped;				/* Frames refused because the queue was full */
+}FLEXCAN_TX_t;
+
+void 	FLEXCAN_TX_init			(FLEXCAN_TX_t * tx, uint8_t instance, uint8_t first_mb, uint8_t mb_count,
+								 uint8_t mb_words, FLEXCAN_TX_Frame_t * queue, uint8_t queue_size);
+uint8_t FLEXCAN_TX_send			(FLEXCAN_TX_t * tx, const FLEXCAN_TX_Frame_t * frame);
+uint8_t FLEXCAN_TX_idle			(FLEXCAN_TX_t * tx);
+void 	FLEXCAN_TX_IRQHandler	(FLEXCAN_TX_t * tx);
+
+#endif /* FLEXCAN_TX_H_ */
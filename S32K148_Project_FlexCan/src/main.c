@@ -34,8 +34,10 @@
  * Description:
  * ====================================================================
  * A FlexCAN module is initialized for 500 KHz (2 usec period) bit time
- * based on an 8 MHz crystal. Message buffer 0 transmits 8 byte messages
- * and message buffer 4 can receive 8 byte messages.
+ * based on an 8 MHz crystal. Message buffers 0 to 3 receive 8 byte messages
+ * into a ring filled by the MB interrupt (FlexCAN_RX.c) and message buffers
+ * 4 to 7 transmit 8 byte messages through a queue emptied by the same
+ * interrupt (FlexCAN_TX.c), as laid out by FLEXCAN_LAYOUT in FlexCAN.c.
  *
  * To enable signals to the CAN bus, the SBC must be powered with external 12V.
  * EVBs with SBC MC33903 require CAN transceiver configuration with SPI.
@@ -81,6 +83,7 @@ void PORT_init (void)
 int main(void)
 {
 	uint32_t rx_msg_count = 0;	/*< Receive message counter */
+	const FLEXCAN_RX_Frame_t * rx_frame;	/*< Received message, read in place in the ring */
 
 		/*!
 		 * Initialization:
@@ -104,8 +107,8 @@ int main(void)
 	 */
 	  for (;;)
 	  {                        			/* Loop: if a msg is received, transmit a msg */
-		if ((CAN0->IFLAG1 >> 4) & 1) {  /* If CAN 0 MB 4 flag is set (received msg), read MB4 */
-		  FLEXCAN0_receive_msg ();      /* Read message */
+		rx_frame = FLEXCAN_RX_peek(&FLEXCAN0_rx);
+		if (rx_frame != NULL) {         /* If a msg waits in the ring (filled by the MB0..3 IRQ) */
 		  rx_msg_count++;               /* Increment receive msg counter */
 
 		  if (rx_msg_count == 1000) {   /* If 1000 messages have been received, */
@@ -113,7 +116,8 @@ int main(void)
 			rx_msg_count = 0;           /*   and reset message counter */
 		  }
 
-		  FLEXCAN0_transmit_msg ();     /* Transmit message using MB0 */
+		  FLEXCAN_RX_release(&FLEXCAN0_rx);	/* Done with rx_frame: slot back to the ring */
+		  FLEXCAN0_transmit_msg ();     /* Queue message for MB4..7 */
 		}
 	  }
 }
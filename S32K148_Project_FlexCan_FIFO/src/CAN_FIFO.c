@@ -32,10 +32,18 @@
 
 #include "CAN_FIFO.h"
 #include "register_bit_fields.h"
+#include "FlexCAN_TX.h"
+#include "FlexCAN_FIFO_DMA.h"
+#include "FlexCAN_Timing.h"
+#include "FlexCAN_Layout.h"
 #include "stdint.h"
 
 #define __IOM volatile 							/* The compiler won't optimize this macro */
 
+/* CAN Classic: 8-byte MBs, RX FIFO with 8 ID filter elements (MB0..MB7), MB8..MB11 transmit */
+FLEXCAN_LAYOUT(CAN0_LAYOUT, 8, 8, 0, 4);
+FLEXCAN_LAYOUT_ASSERT(CAN0_LAYOUT);
+
 /*!
 * @brief Bit field declaration for the transmission and reception message buffers. See "Message Buffer Structure"
 *        and "Rx FIFO Structure" in RM.
@@ -64,14 +72,14 @@ typedef struct
 	  __IOM uint32_t STD_ID     : 11;
 	        uint32_t            : 3;
 	  __IOM uint32_t payload[2];				/* 8 bytes (2 words) for payload */
-	} Classic_RX_FIFO[6];						/* FIFO size of 6 */
+	} Classic_RX_FIFO[FLEXCAN_FIFO_MBS];		/* FIFO size of 6 */
 
 	struct
 	{
 	        uint32_t            : 19;
 	  __IOM uint32_t STD_ID     : 11;
 	        uint32_t            : 2;
-	} ID_TABLE_RXFIFO[8];						/* 8 ID elements of 32 bits each */
+	} ID_TABLE_RXFIFO[CAN0_LAYOUT_FILTERS];		/* 8 ID elements of 32 bits each */
 
 	struct
 	{
@@ -90,9 +98,11 @@ typedef struct
 	  __IOM uint32_t STD_ID     : 11;
 	  __IOM uint32_t PRIO       : 3;
 	  __IOM uint32_t payload[2];				/* 8 bytes (2 words) for payload */
-	} Classic_MessageBuffer[24];				/* 24 MBs available */
+	} Classic_MessageBuffer[CAN0_LAYOUT_MB_COUNT - CAN0_LAYOUT_FIFO_MBS];	/* MBs after the FIFO area */
 } CAN0_MB_t;
 
+_Static_assert(sizeof(CAN0_MB_t) == 4u * CAN0_LAYOUT_MB_COUNT * CAN0_LAYOUT_MB_WORDS, "CAN0_MB_t must match the MB layout");
+
 /*!
 * @brief Type casting of the structure declared above to the corresponding CAN0 memory area.
 *        Refer to the header file "register_bit_fields.h" located inside the project's
@@ -114,32 +124,58 @@ typedef struct
 	uint8_t RJW;
 } CAN_bit_timings_t;
 
-/* CAN bit timings for 500 Kbit/s with 16 time quantas */
+#define CAN_CLK_HZ		8000000		/* CLKSRC=0: SOSCDIV2 */
+#define CAN_DELAY_NS	250			/* Transceiver loop delay and bus line, one way */
+
+/* CAN bit timings for 500 Kbit/s sampled at 81.2%, solved at compile time from the 8 MHz CAN clock */
+FLEXCAN_TIMING(CAN_NOMINAL, CTRL1, CAN_CLK_HZ, 500000, 812, CAN_DELAY_NS);
+FLEXCAN_TIMING_ASSERT(CAN_NOMINAL);
+
 CAN_bit_timings_t timings =
 {
-	.PRESDIV = 0,
-    .PROPSEG = 5,
-    .PSEG1 = 5,
-    .PSEG2 = 2,
-    .RJW = 2,
-
-	/* (PRESDIV + 1) * (PROPSEG + PSEG1 + PSEG2 + 4) = 16 quantas */
-	/* Resynchronization Jump Width = RJW + 1 = 3 */
+	.PRESDIV = CAN_NOMINAL_PRESDIV,
+    .PROPSEG = CAN_NOMINAL_PROPSEG,
+    .PSEG1 = CAN_NOMINAL_PSEG1,
+    .PSEG2 = CAN_NOMINAL_PSEG2,
+    .RJW = CAN_NOMINAL_RJW,
+
+	/* (PRESDIV + 1) * (PROPSEG + PSEG1 + PSEG2 + 4) = CAN_NOMINAL_PRESC * CAN_NOMINAL_TQ */
+	/* Resynchronization Jump Width = RJW + 1 */
 	/* Bit Timing = FlaxCan CLK / time quantas = 8 MHz / 16 = 500 Kbit/s */
 };
 
 
 /*!
-* @brief Enum for the index of RX FIFO used for reception and the Message Buffer used for transmission.
-* 		 There are a total of 24 MBs available, however in this project only 1 MB is used for TX.
-* 		 RX FIFO and the TX Message Buffer are the 0th of each type.
+* @brief Index of the RX FIFO used for reception. With 8 ID filter elements the FIFO and its
+* 		 table take MB0 to MB7; MB8 to MB11 (Classic_MessageBuffer[0..3]) are TX MBs managed
+* 		 by the transmit queue (FlexCAN_TX.c).
 */
 typedef enum
 {
-    TX_MB = 0,
     RX_FIFO = 0
 } MB_index_Enum;
 
+#define TX_FIRST_MB		(CAN0_LAYOUT_TX_FIRST)		/* MB8..MB11 transmit, after the RX FIFO area */
+#define TX_MB_COUNT		(CAN0_LAYOUT_TX_COUNT)
+#define TX_MB_WORDS		(CAN0_LAYOUT_MB_WORDS)		/* 2 header words + payload words */
+#define TX_QUEUE_SIZE	(16u)
+
+/* Transmit queue over the TX message buffers */
+static FLEXCAN_TX_t tx;
+static FLEXCAN_TX_Frame_t tx_queue[TX_QUEUE_SIZE];
+
+/* Comment out to read the RX FIFO by polling BUF5I instead of the DMA ring */
+#define RX_FIFO_DMA
+
+#define RX_DMA_CH		(0u)		/* DMA channel draining the RX FIFO */
+#define RX_RING_SLOTS	(32u)		/* Power of 2: IRQ every 16 frames */
+
+#if defined(RX_FIFO_DMA)
+/* Receive ring filled by the DMA from the RX FIFO output */
+static FLEXCAN_FIFO_DMA_t rx;
+static FLEXCAN_FIFO_Frame_t rx_ring[RX_RING_SLOTS];
+#endif
+
 
 /*!
 * @brief FlexCAN Initialization for Classic Frames transmission and reception at 500 Kbits/s with RX_FIFO enabled
@@ -173,7 +209,10 @@ status_t FlexCAN_init_RXFIFO (void)
     CAN0 -> CAN0_MCR_b.IDAM = CAN0_MCR_IDAM_00;
 
     /* Choose 8 ID filter elements for RX FIFO */
-    CAN0 -> CAN0_CTRL2_b.RFFN = 0;
+    CAN0 -> CAN0_CTRL2_b.RFFN = CAN0_LAYOUT_RFFN;
+
+    /* Last MB in use is the last TX MB (MB11) */
+    CAN0 -> CAN0_MCR_b.MAXMB = CAN0_LAYOUT_MAXMB;
 
     /* CAN Bit Timing (CBT) configuration for a bit rate of 500 Kbit/s with 16 time quantas, in accordance with Bosch 2012 specification */
     CAN0 -> CAN0_CTRL1_b.PRESDIV = timings.PRESDIV;
@@ -182,6 +221,11 @@ status_t FlexCAN_init_RXFIFO (void)
     CAN0 -> CAN0_CTRL1_b.PSEG2   = timings.PSEG2;
     CAN0 -> CAN0_CTRL1_b.RJW     = timings.RJW;
 
+#if defined(RX_FIFO_DMA)
+    /* Every frame of the RX FIFO is moved to the ring by the DMA (MCR[DMA], writable in freeze mode) */
+    FLEXCAN_FIFO_DMA_init(&rx, 0, RX_DMA_CH, rx_ring, RX_RING_SLOTS);
+#endif
+
     /* Exit from freeze mode */
     CAN0 -> CAN0_MCR_b.HALT = CAN0_MCR_HALT_0;
     CAN0 -> CAN0_MCR_b.FRZ  = CAN0_MCR_FRZ_0;
@@ -192,6 +236,9 @@ status_t FlexCAN_init_RXFIFO (void)
     /* Block for module ready flag */
     while(CAN0 -> CAN0_MCR_b.NOTRDY);
 
+    /* Hand the TX message buffers to the queue: local priority (LPRIOEN) and lowest ID first (LBUF=0) */
+    FLEXCAN_TX_init(&tx, 0, TX_FIRST_MB, TX_MB_COUNT, TX_MB_WORDS, tx_queue, TX_QUEUE_SIZE);
+
     /* Success initialization */
     return Success;
 }
@@ -239,41 +286,40 @@ status_t FlexCAN_install_ID (uint32_t id)
 
 
 /*!
-* @brief Transmit a single CAN frame
+* @brief Queue a CAN frame for transmission. The frame takes the first free TX message buffer
+* 		 or waits in the queue; FlexCAN sends the loaded MBs by priority and the MB interrupt
+* 		 reloads them, so the function never waits for the bus.
 *
 * @param [frame] 	 The reference to the frame that is going to be transmitted
 *
-* @return Success    If the frame was sent immediately
+* @return Success    If the frame was queued
+* @return BufferFull If the queue is full, the frame is dropped
 */
 status_t FlexCAN_transmit_frame (frame_t* frame)
 {
-	/* Insert the payload for transmission. CAN Classic has 2 words (8 bytes) for payload */
+    FLEXCAN_TX_Frame_t tx_frame;
+
+    /* Copy the payload. CAN Classic has 2 words (8 bytes) for payload */
     for(uint8_t i = 0; i < MAX_MTU_WORDS; i++)
     {
-        CAN0_MB -> Classic_MessageBuffer[TX_MB].payload[i] = frame -> payload[i];
+        tx_frame.payload[i] = frame -> payload[i];
     }
 
-    /* Set the frame's destination ID */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].STD_ID = frame -> ID;
+    tx_frame.ID    = frame -> ID;					/* Destination ID */
+    tx_frame.prio  = 0;								/* Local priority, ahead of the ID in the MB arbitration */
+    tx_frame.flags = 0;
+    tx_frame.dlc   = 8;
 
-    /* Configure transmission message buffer. See "Message Buffer Structure" in RM */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].EDL =  0;   	/* No extended data length */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].BRS =  0;   	/* No bit-rate switch */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].ESI =  0;		/* No applies */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].SRR =  0;		/* No applies */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].IDE =  0;   	/* Standard UD */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].RTR =  0;		/* No remote request made */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].DLC = 0x8;  	/* 8 bytes of payload */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].CODE = 0xC; 	/* After TX, the MB automatically returns to the INACTIVE state */
-
-    /* After a successful transmission the interrupt flag of the corresponding message buffer is set */
-    while(!(CAN0 -> CAN0_IFLAG1_b.BUF31TO8I));
+    return FLEXCAN_TX_send(&tx, &tx_frame) ? Success : BufferFull;
+}
 
-    /* Clear the flag previously polled (W1C register) */
-    CAN0 -> CAN0_IFLAG1_b.BUF31TO8I = 1;
 
-    /* Return successful transmission request status */
-    return Success;
+/*!
+* @brief TX message buffer interrupt: completed MBs are reloaded from the queue
+*/
+void CAN0_ORed_0_15_MB_IRQHandler (void)
+{
+    FLEXCAN_TX_IRQHandler(&tx);
 }
 
 
@@ -290,6 +336,28 @@ status_t FlexCAN_receive_frame (frame_t* frame)
     /* Default output and return values */
     status_t status = Failure;
 
+#if defined(RX_FIFO_DMA)
+    /* Oldest frame the DMA moved from the RX FIFO */
+    const FLEXCAN_FIFO_Frame_t * rx_frame = FLEXCAN_FIFO_DMA_peek(&rx);
+
+    if(rx_frame != NULL)
+    {
+        /* Harvest the ID */
+        frame -> ID = FLEXCAN_FIFO_ID(rx_frame);
+
+        /* Harvest the payload */
+        for(uint8_t i = 0; i < MAX_MTU_WORDS; i++)
+        {
+            frame -> payload[i] = rx_frame -> payload[i];
+        }
+
+        /* Hand the slot back to the DMA */
+        FLEXCAN_FIFO_DMA_release(&rx);
+
+        /* Return success status code */
+        status = Success;
+    }
+#else
     /* Check if the RX FIFO received */
     if(CAN0 -> CAN0_IFLAG1_b.BUF5I)
     {
@@ -303,10 +371,22 @@ status_t FlexCAN_receive_frame (frame_t* frame)
         }
 
         /* Force update of the RX FIFO by clearing its flag (W1C register) */
-        CAN0 -> CAN0_IFLAG1_b.BUF5I = 1;
+        CAN0 -> CAN0_IFLAG1 = 1u << 5;         /* Whole word: TX flags untouched */
 
         /* Return success status code */
         status = Success;
     }
+#endif
     return status;
 }
+
+
+#if defined(RX_FIFO_DMA)
+/*!
+* @brief RX DMA channel interrupt: half of the ring filled, or its end
+*/
+void DMA0_IRQHandler (void)
+{
+    FLEXCAN_FIFO_DMA_IRQHandler(&rx);
+}
+#endif
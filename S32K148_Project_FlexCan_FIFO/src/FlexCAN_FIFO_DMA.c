@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"	/* include peripheral declarations */
+#include "FlexCAN_FIFO_DMA.h"
+
+/*!
+ * Description:
+ * ===================================================
+ * The application enables the RX FIFO (MCR[RFEN]) and its ID filter table as usual and calls
+ * FLEXCAN_FIFO_DMA_init while FlexCAN is still in freeze mode, where MCR[DMA] is writable:
+ *
+ * 	- the FIFO output (MB0, 16 bytes) is the source of a 4-word minor loop; SMOD keeps the
+ * 	  source address inside those 16 bytes, so every request reads C/S, ID, DATA0 and DATA1
+ * 	  and the read of DATA1 pops the FIFO,
+ * 	- the destination walks the ring one slot per frame and DLASTSGA wraps it at the end,
+ * 	- INTHALF and INTMAJOR interrupt twice per ring, never per frame.
+ *
+ * The write position is slots - CITER plus the ring laps counted by FLEXCAN_FIFO_DMA_IRQHandler
+ * (called from the DMAn_IRQHandler of the application), so the reader knows how many frames
+ * are pending and how many were overwritten before it got to them. In DMA mode IFLAG1[BUF5I]
+ * belongs to the DMA request and must not be cleared by the CPU, and IMASK1[BUF5M] stays 0.
+ */
+
+#define FLEXCAN_IFLAG1_FIFO_AVAILABLE	(1u << 5)	/* BUF5I: DMA request in DMA mode */
+#define FLEXCAN_IFLAG1_FIFO_WARNING		(1u << 6)	/* BUF6I: 5 frames in the FIFO */
+#define FLEXCAN_IFLAG1_FIFO_OVERFLOW	(1u << 7)	/* BUF7I: frame lost, FIFO full */
+#define FLEXCAN_FIFO_FRAME_BYTES		(16u)
+#define FLEXCAN_FIFO_SMOD				(4u)		/* 2^4 = 16-byte source window */
+
+static CAN_Type * const FLEXCAN_bases[] = CAN_BASE_PTRS;
+static const uint8_t FLEXCAN_dma_requests[] = FEATURE_CAN_EDMA_REQUESTS;
+
+static void NVIC_enable(IRQn_Type irq)
+{
+	S32_NVIC->ICPR[(uint32_t)irq >> 5u] = 1u << ((uint32_t)irq & 0x1Fu);	/* Clear any pending IR */
+	S32_NVIC->ISER[(uint32_t)irq >> 5u] = 1u << ((uint32_t)irq & 0x1Fu);	/* Enable IRQ */
+}
+
+/*!
+* @brief Frames written by the DMA since init. halves tells which half the DMA is in; a CITER
+* behind that half means the DMA crossed the half or the end and its IRQ is not served yet.
+*
+* @param[FLEXCAN_FIFO_DMA_t * rx] Ring
+* @return Frames written
+*/
+static uint32_t FLEXCAN_FIFO_DMA_written(FLEXCAN_FIFO_DMA_t * rx)
+{
+	uint32_t half = rx->slots / 2u;
+	uint32_t halves;
+	uint32_t position;
+
+	do
+	{
+		halves = rx->halves;
+		position = rx->slots - (DMA->TCD[rx->ch].CITER.ELINKNO & DMA_TCD_CITER_ELINKNO_CITER_MASK);
+	}
+	while (halves != rx->halves);					/* IRQ in between: read again */
+
+	if ((halves & 1u) && (position < half))
+	{
+		position += rx->slots;						/* Wrapped, major loop IRQ pending */
+	}
+	return (halves / 2u) * rx->slots + position;
+}
+
+/*!
+* @brief Switch the RX FIFO of a frozen FlexCAN to DMA mode and start filling the ring.
+*
+* @param[FLEXCAN_FIFO_DMA_t * rx] Ring state
+* @param[uint8_t instance] FlexCAN instance, in freeze mode with MCR[RFEN] = 1
+* @param[uint8_t ch] DMA channel
+* @param[FLEXCAN_FIFO_Frame_t * ring] Storage for the frames
+* @param[uint16_t slots] Number of frames in the ring, power of 2 from 2 to 16384
+*/
+void FLEXCAN_FIFO_DMA_init(FLEXCAN_FIFO_DMA_t * rx, uint8_t instance, uint8_t ch,
+						   FLEXCAN_FIFO_Frame_t * ring, uint16_t slots)
+{
+	CAN_Type * base;
+
+	DEV_ASSERT(instance < CAN_INSTANCE_COUNT);
+	DEV_ASSERT((slots >= 2u) && ((slots & (slots - 1u)) == 0u) && (slots <= 16384u));
+	base = FLEXCAN_bases[instance];
+	DEV_ASSERT((base->MCR & (CAN_MCR_FRZACK_MASK | CAN_MCR_RFEN_MASK)) == (CAN_MCR_FRZACK_MASK | CAN_MCR_RFEN_MASK));
+
+	rx->instance       = instance;
+	rx->ch             = ch;
+	rx->ring           = ring;
+	rx->slots          = slots;
+	rx->read           = 0;
+	rx->halves         = 0;
+	rx->overruns       = 0;
+	rx->fifo_overflows = 0;
+
+	SIM->PLATCGC |= SIM_PLATCGC_CGCDMA_MASK;			/* DMA Clock Gating Control Enable */
+	PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;	/* Enable clock for DMAMUX */
+
+	DMAMUX->CHCFG[ch] = 0;								/* Disable the channel to change the source */
+	DMAMUX->CHCFG[ch] = DMAMUX_CHCFG_SOURCE(FLEXCAN_dma_requests[instance]) | DMAMUX_CHCFG_ENBL_MASK;
+
+	DMA->TCD[ch].SADDR = DMA_TCD_SADDR_SADDR((uint32_t) &base->RAMn[0]);	/* FIFO output, 16-byte aligned */
+	DMA->TCD[ch].SOFF = DMA_TCD_SOFF_SOFF(4);								/* C/S, ID, DATA0, DATA1 */
+	DMA->TCD[ch].ATTR = DMA_TCD_ATTR_SMOD(FLEXCAN_FIFO_SMOD) |				/* Source back to C/S after DATA1 */
+						DMA_TCD_ATTR_SSIZE(2) | DMA_TCD_ATTR_DSIZE(2);		/* 32-bit accesses to the FlexCAN RAM */
+	DMA->TCD[ch].NBYTES.MLNO = DMA_TCD_NBYTES_MLNO_NBYTES(FLEXCAN_FIFO_FRAME_BYTES);	/* One frame per request */
+	DMA->TCD[ch].SLAST = 0;
+	DMA->TCD[ch].DADDR = DMA_TCD_DADDR_DADDR((uint32_t) ring);
+	DMA->TCD[ch].DOFF = DMA_TCD_DOFF_DOFF(4);
+	DMA->TCD[ch].CITER.ELINKNO = DMA_TCD_CITER_ELINKNO_CITER(slots);
+	DMA->TCD[ch].BITER.ELINKNO = DMA_TCD_BITER_ELINKNO_BITER(slots);
+	DMA->TCD[ch].DLASTSGA = DMA_TCD_DLASTSGA_DLASTSGA(-(int32_t)(slots * FLEXCAN_FIFO_FRAME_BYTES));	/* Wrap the ring */
+	DMA->TCD[ch].CSR = DMA_TCD_CSR_INTHALF_MASK |		/* IRQ at the half of the ring */
+					   DMA_TCD_CSR_INTMAJOR_MASK;		/* and at its end, DREQ = 0: never stops */
+	NVIC_enable((IRQn_Type)(DMA0_IRQn + ch));
+	DMA->SERQ = DMA_SERQ_SERQ(ch);
+
+	base->IFLAG1 = FLEXCAN_IFLAG1_FIFO_WARNING | FLEXCAN_IFLAG1_FIFO_OVERFLOW;	/* Clear stale FIFO flags (W1C) */
+	base->IMASK1 &= ~(FLEXCAN_IFLAG1_FIFO_AVAILABLE | FLEXCAN_IFLAG1_FIFO_WARNING |
+					  FLEXCAN_IFLAG1_FIFO_OVERFLOW);	/* FIFO flags are served by the DMA and its IRQ */
+	base->MCR |= CAN_MCR_DMA_MASK;						/* Frame available requests the DMA */
+}
+
+/*!
+* @brief Oldest received frame, left in the ring until FLEXCAN_FIFO_DMA_release. If the DMA
+* has lapped the reader, the lost frames are counted in overruns and reading resumes at the
+* oldest frame still in the ring.
+*
+* @param[FLEXCAN_FIFO_DMA_t * rx] Ring
+* @return Frame, NULL if the ring is empty
+*/
+const FLEXCAN_FIFO_Frame_t * FLEXCAN_FIFO_DMA_peek(FLEXCAN_FIFO_DMA_t * rx)
+{
+	uint32_t written = FLEXCAN_FIFO_DMA_written(rx);
+	uint32_t pending = written - rx->read;
+
+	if (pending == 0u)
+	{
+		return NULL;
+	}
+	if (pending >= rx->slots)						/* The slot at read is being rewritten */
+	{
+		rx->overruns += pending - (rx->slots - 1u);
+		rx->read = written - (rx->slots - 1u);
+	}
+	return &rx->ring[rx->read & (rx->slots - 1u)];
+}
+
+/*!
+* @brief Give the slot of the frame returned by FLEXCAN_FIFO_DMA_peek back to the ring.
+*
+* @param[FLEXCAN_FIFO_DMA_t * rx] Ring
+*/
+void FLEXCAN_FIFO_DMA_release(FLEXCAN_FIFO_DMA_t * rx)
+{
+	if (FLEXCAN_FIFO_DMA_written(rx) != rx->read)
+	{
+		rx->read++;
+	}
+}
+
+/*!
+* @brief Number of frames waiting in the ring.
+*
+* @param[FLEXCAN_FIFO_DMA_t * rx] Ring
+* @return Frames not released yet, more than the ring size after an overrun
+*/
+uint32_t FLEXCAN_FIFO_DMA_pending(FLEXCAN_FIFO_DMA_t * rx)
+{
+	return FLEXCAN_FIFO_DMA_written(rx) - rx->read;
+}
+
+/*!
+* @brief DMA channel IRQ body: half or whole ring filled. Also counts the FIFO overflows,
+* which have no interrupt of their own in DMA mode.
+*
+* @param[FLEXCAN_FIFO_DMA_t * rx] Ring
+*/
+void FLEXCAN_FIFO_DMA_IRQHandler(FLEXCAN_FIFO_DMA_t * rx)
+{
+	CAN_Type * base = FLEXCAN_bases[rx->instance];
+	uint32_t flags = base->IFLAG1 & (FLEXCAN_IFLAG1_FIFO_WARNING | FLEXCAN_IFLAG1_FIFO_OVERFLOW);
+
+	DMA->CINT = DMA_CINT_CINT(rx->ch);				/* Clear Interruption request flag */
+	rx->halves++;
+
+	if (flags & FLEXCAN_IFLAG1_FIFO_OVERFLOW)
+	{
+		rx->fifo_overflows++;
+	}
+	if (flags != 0u)
+	{
+		base->IFLAG1 = flags;						/* W1C, BUF5I (DMA request) untouched */
+	}
+}
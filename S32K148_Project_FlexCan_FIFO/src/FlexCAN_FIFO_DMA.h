@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLEXCAN_FIFO_DMA_H_
+#define FLEXCAN_FIFO_DMA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+* @brief Legacy RX FIFO entry as the DMA copies it from the FIFO output (MB0): C/S word,
+* ID word and the 8-byte payload. Consumers read it in place in the ring.
+*/
+typedef struct
+{
+	uint32_t cs;							/* SRR, IDE, RTR, DLC, TIME STAMP */
+	uint32_t id;							/* Standard IDs in bits 28:18 */
+	uint32_t payload[2];					/* Big endian bytes per word */
+} FLEXCAN_FIFO_Frame_t;
+
+#define FLEXCAN_FIFO_EXTENDED(frame)	(((frame)->cs >> 21) & 1u)
+#define FLEXCAN_FIFO_ID(frame)			(FLEXCAN_FIFO_EXTENDED(frame) ? ((frame)->id & 0x1FFFFFFFu) \
+																	  : (((frame)->id >> 18) & 0x7FFu))
+#define FLEXCAN_FIFO_DLC(frame)			(((frame)->cs >> 16) & 0xFu)
+#define FLEXCAN_FIFO_TIMESTAMP(frame)	((frame)->cs & 0xFFFFu)
+
+/* Legacy RX FIFO drained by the eDMA. With MCR[DMA] the FIFO requests the DMA channel for
+ * every frame; the channel copies the 16-byte output into the next ring slot and the read of
+ * its last word pops the FIFO. The ring is never stopped: the DMA interrupts only at the half
+ * and at the end of the ring, so no CPU time is spent per frame. Single producer (DMA), single
+ * consumer (application). */
+typedef struct
+{
+	uint8_t  instance;						/* 0 for CAN0, 1 for CAN1, 2 for CAN2 */
+	uint8_t  ch;							/* DMA channel filling the ring */
+	FLEXCAN_FIFO_Frame_t * ring;
+	uint16_t slots;							/* Ring size in frames, power of 2 */
+	uint32_t read;							/* Frames taken by the application since init */
+	volatile uint32_t halves;				/* Half rings completed by the DMA */
+	volatile uint32_t overruns;				/* Frames lost: the DMA lapped the reader */
+	volatile uint32_t fifo_overflows;		/* FIFO overflow flags: frames lost before the DMA */
+}FLEXCAN_FIFO_DMA_t;
+
+void 							FLEXCAN_FIFO_DMA_init		(FLEXCAN_FIFO_DMA_t * rx, uint8_t instance, uint8_t ch,
+															 FLEXCAN_FIFO_Frame_t * ring, uint16_t slots);
+const FLEXCAN_FIFO_Frame_t * 	FLEXCAN_FIFO_DMA_peek		(FLEXCAN_FIFO_DMA_t * rx);
+void 							FLEXCAN_FIFO_DMA_release	(FLEXCAN_FIFO_DMA_t * rx);
+uint32_t 						FLEXCAN_FIFO_DMA_pending	(FLEXCAN_FIFO_DMA_t * rx);
+void 							FLEXCAN_FIFO_DMA_IRQHandler	(FLEXCAN_FIFO_DMA_t * rx);
+
+#endif /* FLEXCAN_FIFO_DMA_H_ */
@@ -47,6 +47,11 @@
  * arrives before reading the first one, the information of the first and the second message would
  * be still available thanks to the FIFO mechanism.
  *
+ * With RX_FIFO_DMA (CAN_FIFO.c) the FIFO requests the eDMA for each frame (MCR[DMA]); the DMA
+ * moves every 16-byte FIFO entry into a 32-frame ring and interrupts only at its half and end,
+ * so reception costs no CPU per frame and the 6-deep FIFO keeps up with a fully loaded bus.
+ * Without it, FlexCAN_receive_frame polls IFLAG1[BUF5I] and pops one frame at a time.
+ *
  * The FIFO is not available when using FlexCan FD for the S32K1xx family.
  *
  * Instructions:
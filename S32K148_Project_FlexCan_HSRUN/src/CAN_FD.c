@@ -32,10 +32,18 @@
 
 #include "CAN_FD.h"
 #include "register_bit_fields.h"
+#include "FlexCAN_TX.h"
+#include "FlexCAN_RX.h"
+#include "FlexCAN_Timing.h"
+#include "FlexCAN_Layout.h"
 #include "stdint.h"
 
 #define __IOM volatile 							/* The compiler won't optimize this macro */
 
+/* CAN-FD: 64-byte MBs, no FIFO, MB0 receives, MB1..MB6 transmit */
+FLEXCAN_LAYOUT(CAN0_LAYOUT, 64, 0, 1, 6);
+FLEXCAN_LAYOUT_ASSERT(CAN0_LAYOUT);
+
 /*!
 * @brief Bit field declaration for the transmission and reception message buffers. See "Message Buffer Structure" in RM.
 * 		 NOTE: Since this example manages CAN-FD (8 bytes for header and 64 bytes for payload)
@@ -59,9 +67,11 @@ typedef struct
       __IOM uint32_t EXT_ID     : 29;
       __IOM uint32_t PRIO       : 3;
       __IOM uint32_t payload[16];				/* 64 bytes (16 words) for payload */
-    } FD_MessageBuffer[7];						/* 7 MBs available */
+    } FD_MessageBuffer[CAN0_LAYOUT_MB_COUNT];		/* 7 MBs available */
 } CAN0_MB_t;
 
+_Static_assert(sizeof(CAN0_MB_t) == 4u * CAN0_LAYOUT_MB_COUNT * CAN0_LAYOUT_MB_WORDS, "CAN0_MB_t must match the MB layout");
+
 /*!
 * @brief Type casting of the structure declared above to the corresponding CAN0 memory area.
 *        Refer to the header file "register_bit_fields.h" located inside the project's
@@ -89,43 +99,63 @@ typedef struct
 } CAN_bit_timings_t;
 
 
-/* CAN bit timings for nominal phase at 1 Mbit/s with 56 time quantas and a divider of 2
- * and data phase at 4 Mbit/s with 28 time quantas */
+#define CAN_CLK_HZ		112000000	/* CLKSRC=1: SYS_CLK */
+#define CAN_DELAY_NS	250			/* Transceiver loop delay and bus line, one way */
+
+/* CAN bit timings for nominal phase at 1 Mbit/s sampled at 80%
+ * and data phase at 4 Mbit/s sampled at 75%, solved at compile time */
+FLEXCAN_TIMING(CAN_NOMINAL, CBT,   CAN_CLK_HZ, 1000000, 800, CAN_DELAY_NS);
+FLEXCAN_TIMING(CAN_DATA,    FDCBT, CAN_CLK_HZ, 4000000, 750, CAN_DELAY_NS);
+FLEXCAN_TIMING_ASSERT(CAN_NOMINAL);
+FLEXCAN_TIMING_ASSERT(CAN_DATA);
+
 CAN_bit_timings_t timings =
 {
-	.EPRESDIV = 1,
-    .EPROPSEG = 25,
-    .EPSEG1 = 15,
-    .EPSEG2 = 12,
-    .ERJW = 12,
-    .FPRESDIV = 0,
-    .FPROPSEG = 15,
-    .FPSEG1 = 6,
-    .FPSEG2 = 4,
-    .FRJW = 4
+	.EPRESDIV = CAN_NOMINAL_PRESDIV,
+    .EPROPSEG = CAN_NOMINAL_PROPSEG,
+    .EPSEG1 = CAN_NOMINAL_PSEG1,
+    .EPSEG2 = CAN_NOMINAL_PSEG2,
+    .ERJW = CAN_NOMINAL_RJW,
+    .FPRESDIV = CAN_DATA_PRESDIV,
+    .FPROPSEG = CAN_DATA_PROPSEG,
+    .FPSEG1 = CAN_DATA_PSEG1,
+    .FPSEG2 = CAN_DATA_PSEG2,
+    .FRJW = CAN_DATA_RJW
 
 	/* NOMINAL PHASE */
-	/* (EPRESDIV + 1) * (EPROPSEG + EPSEG1 + EPSEG2 + 4) = (2 * 56 quantas) = 112 */
-	/* Extended Resynchronization Jump Width = ERJW + 1 = 13 */
+	/* (EPRESDIV + 1) * (EPROPSEG + EPSEG1 + EPSEG2 + 4) = 112 */
 	/* Bit Timing = FlaxCan CLK / time quantas = 112 MHz / 112 = 1 Mbit/s */
 
 	/* DATA PHASE */
-	/* (FPRESDIV + 1) * (FPROPSEG + FPSEG1 + FPSEG2 + 3) = 28 quantas */
-	/* Fast Resynchronization Jump Width = FRJW + 1 = 5 */
+	/* (FPRESDIV + 1) * (FPROPSEG + FPSEG1 + FPSEG2 + 3) = 28 */
 	/* Bit Timing = FlaxCan CLK / time quantas = 112 MHz / 28 = 4 Mbit/s */
 };
 
 
 /*!
-* @brief Enum for the index of the 2 Message Buffers (MB) used, 0th for TX and the 1st for RX.
-* 		 There are a total of 7 MBs available, however in this project only 2 MBs are used.
+* @brief Index of the RX Message Buffer (MB). It uses the individual mask RXIMR0 of its MB.
+* 		 There are a total of 7 MBs available: MB1 to MB6 are TX MBs managed by the transmit
+* 		 queue (FlexCAN_TX.c).
 */
 typedef enum
 {
-    TX_MB = 0,
-    RX_MB = 1
+    RX_MB = CAN0_LAYOUT_RX_FIRST
 } MB_index_Enum;
 
+#define TX_FIRST_MB		(CAN0_LAYOUT_TX_FIRST)		/* MB1..MB6 transmit */
+#define TX_MB_COUNT		(CAN0_LAYOUT_TX_COUNT)
+#define MB_WORDS		(CAN0_LAYOUT_MB_WORDS)		/* 2 header words + payload words */
+#define TX_QUEUE_SIZE	(16u)
+#define RX_RING_SLOTS	(32u)		/* Frames buffered between the MB interrupt and FlexCAN_receive_frame */
+
+/* Transmit queue over the TX message buffers */
+static FLEXCAN_TX_t tx;
+static FLEXCAN_TX_Frame_t tx_queue[TX_QUEUE_SIZE];
+
+/* Receive ring filled from the RX message buffer interrupt */
+static FLEXCAN_RX_t rx;
+static uint32_t rx_ring[RX_RING_SLOTS * MB_WORDS];
+
 
 /*!
 * @brief FlexCAN Initialization for FD Frames transmission and reception at 4 Mbit/s and 1 Mbit/s in data and nominal phases respectively
@@ -150,7 +180,7 @@ status_t FlexCAN_init_FD (void)
     CAN0 -> CAN0_MCR_b.FDEN = CAN0_MCR_FDEN_1;
     CAN0 -> CAN0_CTRL2_b.ISOCANFDEN = CAN0_CTRL2_ISOCANFDEN_1;
 
-    /* CAN Bit Timing (CBT) configuration for a nominal phase of 1 Mbit/s with 56 time quantas */
+    /* CAN Bit Timing (CBT) configuration for a nominal phase of 1 Mbit/s */
     CAN0 -> CAN0_CBT_b.BTF 		= CAN0_CBT_BTF_1;
     CAN0 -> CAN0_CBT_b.EPRESDIV = timings.EPRESDIV;
     CAN0 -> CAN0_CBT_b.EPROPSEG = timings.EPROPSEG;
@@ -158,19 +188,19 @@ status_t FlexCAN_init_FD (void)
     CAN0 -> CAN0_CBT_b.EPSEG2   = timings.EPSEG2;
     CAN0 -> CAN0_CBT_b.ERJW     = timings.ERJW;
 
-    /* CAN-FD Bit Timing (FDCBT) for a data phase of 4 Mbit/s with 28 time quantas */
+    /* CAN-FD Bit Timing (FDCBT) for a data phase of 4 Mbit/s */
     CAN0 -> CAN0_FDCBT_b.FPRESDIV = timings.FPRESDIV;
     CAN0 -> CAN0_FDCBT_b.FPROPSEG = timings.FPROPSEG;
     CAN0 -> CAN0_FDCBT_b.FPSEG1   = timings.FPSEG1;
-    CAN0 -> CAN0_FDCBT_b.FPSEG2   = timings.EPSEG2;
+    CAN0 -> CAN0_FDCBT_b.FPSEG2   = timings.FPSEG2;
     CAN0 -> CAN0_FDCBT_b.FRJW     = timings.FRJW;
 
     CAN0 -> CAN0_FDCTRL_b.FDRATE = CAN0_FDCTRL_FDRATE_1;  	/* Enable bit rate switch in data phase of frame */
-    CAN0 -> CAN0_FDCTRL_b.TDCEN  = CAN0_FDCTRL_TDCEN_1;   	/* Enable transceiver delay compensation */
-    CAN0 -> CAN0_FDCTRL_b.TDCOFF = 5;                     	/* Setup 5 cycles for data phase sampling delay */
-    CAN0 -> CAN0_FDCTRL_b.MBDSR0 = CAN0_FDCTRL_MBDSR0_11; 	/* Setup 64 bytes per message buffer (7 MB's) */
+    CAN0 -> CAN0_FDCTRL_b.TDCEN  = CAN_DATA_TDC;          	/* Enable transceiver delay compensation */
+    CAN0 -> CAN0_FDCTRL_b.TDCOFF = CAN_DATA_TDCOFF;       	/* Secondary sample point at the data phase sample point */
+    CAN0 -> CAN0_FDCTRL_b.MBDSR0 = CAN0_LAYOUT_MBDSR;     	/* Setup 64 bytes per message buffer (7 MB's) */
 
-    CAN0 -> CAN0_MCR_b.MAXMB  = 1;                 			/* Maximum number of MB's as 2 */
+    CAN0 -> CAN0_MCR_b.MAXMB  = CAN0_LAYOUT_MAXMB;			/* Maximum number of MB's as 7 (one for RX and six for TX) */
     CAN0 -> CAN0_MCR_b.SRXDIS = CAN0_MCR_SRXDIS_1; 			/* Disable self-reception of frames if ID matches */
     CAN0 -> CAN0_MCR_b.IRMQ   = CAN0_MCR_IRMQ_1;   			/* Enable individual message buffer ID masking */
 
@@ -184,6 +214,12 @@ status_t FlexCAN_init_FD (void)
     /* Block for module ready flag */
     while(CAN0 -> CAN0_MCR_b.NOTRDY);
 
+    /* Hand the TX message buffers to the queue: local priority (LPRIOEN) and lowest ID first (LBUF=0) */
+    FLEXCAN_TX_init(&tx, 0, TX_FIRST_MB, TX_MB_COUNT, MB_WORDS, tx_queue, TX_QUEUE_SIZE);
+
+    /* The RX MB is drained into the ring by the MB interrupt, whatever the super-loop is doing */
+    FLEXCAN_RX_init(&rx, 0, RX_MB, CAN0_LAYOUT_RX_COUNT, MB_WORDS, rx_ring, RX_RING_SLOTS);
+
     /* Success initialization */
     return Success;
 }
@@ -237,74 +273,73 @@ status_t FlexCAN_install_ID (uint32_t id)
 
 
 /*!
-* @brief Transmit a single CAN frame
+* @brief Queue a CAN frame for transmission. The frame takes the first free TX message buffer
+* 		 or waits in the queue; FlexCAN sends the loaded MBs by priority and the MB interrupt
+* 		 reloads them, so the function never waits for the bus.
 *
 * @param [frame] 	 The reference to the frame that is going to be transmitted
 *
-* @return Success    If the frame was sent immediately
+* @return Success    If the frame was queued
+* @return BufferFull If the queue is full, the frame is dropped
 */
 status_t FlexCAN_transmit_frame (fd_frame_t* frame)
 {
-	/* Insert the payload for transmission. CAN-FD has 16 words (64 bytes) for payload */
+    FLEXCAN_TX_Frame_t tx_frame;
+
+    /* Copy the payload. CAN-FD has 16 words (64 bytes) for payload */
     for(uint8_t i = 0; i < MAX_MTU_WORDS; i++)
     {
-        CAN0_MB -> FD_MessageBuffer[TX_MB].payload[i] = frame -> payload[i];
+        tx_frame.payload[i] = frame -> payload[i];
     }
 
-    /* Set the frame's destination ID */
-    CAN0_MB -> FD_MessageBuffer[TX_MB].EXT_ID = frame -> ID;
-
-    /* Configure transmission message buffer. See "Message Buffer Structure" in RM */
-    CAN0_MB -> FD_MessageBuffer[TX_MB].EDL =  1;			/* Extended data length */
-    CAN0_MB -> FD_MessageBuffer[TX_MB].BRS =  1;			/* Bit-rate switch */
-    CAN0_MB -> FD_MessageBuffer[TX_MB].ESI =  0;			/* No applies */
-    CAN0_MB -> FD_MessageBuffer[TX_MB].SRR =  0;			/* No applies */
-    CAN0_MB -> FD_MessageBuffer[TX_MB].IDE =  1;			/* Extended ID */
-    CAN0_MB -> FD_MessageBuffer[TX_MB].RTR =  0;			/* No remote request made */
-    CAN0_MB -> FD_MessageBuffer[TX_MB].DLC = 0xF;			/* 64 bytes of payload */
-    CAN0_MB -> FD_MessageBuffer[TX_MB].CODE = 0xC; 			/* After TX, the MB automatically returns to the INACTIVE state */
+    tx_frame.ID    = frame -> ID;					/* Destination ID */
+    tx_frame.prio  = 0;								/* Local priority, ahead of the ID in the MB arbitration */
+    tx_frame.flags = FLEXCAN_TX_EXTENDED | FLEXCAN_TX_FD | FLEXCAN_TX_BRS;
+    tx_frame.dlc   = 0xF;
 
-    /* After a successful transmission the interrupt flag of the corresponding message buffer is set */
-    while(!(CAN0 -> CAN0_IFLAG1_b.BUF0I));
+    return FLEXCAN_TX_send(&tx, &tx_frame) ? Success : BufferFull;
+}
 
-    /* Clear the flag previously polled (W1C register) */
-    CAN0 -> CAN0_IFLAG1_b.BUF0I = 1;
 
-    /* Return successful transmission request status */
-    return Success;
+/*!
+* @brief Message buffer interrupt: the RX MB is copied into the ring, completed TX MBs are
+* 		 reloaded from the queue
+*/
+void CAN0_ORed_0_15_MB_IRQHandler (void)
+{
+    FLEXCAN_RX_IRQHandler(&rx);
+    FLEXCAN_TX_IRQHandler(&tx);
 }
 
 
 /*!
-* @brief Receive a single CAN frame
+* @brief Take the oldest CAN frame from the receive ring
 *
 * @param [frame]  A reference to a frame for transmitting
 *
 * @return Success If a frame was read successfully
-* @return Failure If at least an error occurred
+* @return Failure If no frame is waiting
 */
 status_t FlexCAN_receive_frame (fd_frame_t* frame)
 {
     /* Default output and return values */
     status_t status = Failure;
+    const FLEXCAN_RX_Frame_t * rx_frame = FLEXCAN_RX_peek(&rx);
 
-    /* Check the RX message buffer */
-    if(CAN0 -> CAN0_IFLAG1_b.BUF4TO1I )
+    /* Frames were already moved out of the RX MB by the MB interrupt */
+    if(rx_frame != NULL)
     {
         /* Harvest the ID */
-        frame -> ID = CAN0_MB -> FD_MessageBuffer[RX_MB].EXT_ID;
+        frame -> ID = FLEXCAN_RX_ID(rx_frame);
 
         /* Harvest the payload */
         for(uint8_t i = 0; i < MAX_MTU_WORDS; i++)
         {
-            frame -> payload[i] = CAN0_MB -> FD_MessageBuffer[RX_MB].payload[i];
+            frame -> payload[i] = rx_frame -> payload[i];
         }
 
-        /* Dummy read of the timer for unlocking the MB */
-        (void)CAN0 -> CAN0_TIMER;
-
-        /* Clear the flag previously polled (W1C register) */
-        CAN0 -> CAN0_IFLAG1_b.BUF4TO1I = 1;
+        /* Slot back to the ring */
+        FLEXCAN_RX_release(&rx);
 
         /* Return success status code */
         status = Success;
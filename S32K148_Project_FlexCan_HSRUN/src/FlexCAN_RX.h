@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLEXCAN_RX_H_
+#define FLEXCAN_RX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+* @brief Received frame as a copy of its message buffer: C/S word, ID word and the payload
+* words of the MB size. Consumers read it in place in the ring.
+*/
+typedef struct
+{
+	uint32_t cs;							/* EDL, BRS, ESI, CODE, SRR, IDE, RTR, DLC, TIME STAMP */
+	uint32_t id;							/* PRIO and ID, standard IDs in bits 28:18 */
+	uint32_t payload[];						/* mb_words - 2 words, big endian bytes per word */
+} FLEXCAN_RX_Frame_t;
+
+#define FLEXCAN_RX_EXTENDED(frame)	(((frame)->cs >> 21) & 1u)
+#define FLEXCAN_RX_ID(frame)		(FLEXCAN_RX_EXTENDED(frame) ? ((frame)->id & 0x1FFFFFFFu) \
+																: (((frame)->id >> 18) & 0x7FFu))
+#define FLEXCAN_RX_DLC(frame)		(((frame)->cs >> 16) & 0xFu)
+#define FLEXCAN_RX_TIMESTAMP(frame)	((frame)->cs & 0xFFFFu)
+
+/* Receive ring over a contiguous range of message buffers. The MB interrupt copies every
+ * flagged MB into the next slot and frees the MB at once, so bursts spread over all the RX MBs
+ * and then wait in the ring. Single producer (MB interrupt), single consumer (application). */
+typedef struct
+{
+	uint8_t  instance;						/* 0 for CAN0, 1 for CAN1, 2 for CAN2 */
+	uint8_t  first_mb;						/* First RX message buffer */
+	uint8_t  mb_count;						/* RX message buffers, first_mb + mb_count <= 32 */
+	uint8_t  mb_words;						/* Words per MB and per slot: 4 up to 18 */
+	uint32_t mb_mask;						/* IFLAG1/IMASK1 bits of the RX MBs */
+	uint32_t * ring;						/* slots * mb_words words */
+	uint16_t slot_mask;						/* Number of slots - 1 */
+	volatile uint16_t head;					/* Next slot written by the MB interrupt */
+	volatile uint16_t tail;					/* Oldest slot not released by the application */
+	volatile uint32_t received;				/* Frames stored in the ring */
+	volatile uint32_t overruns;				/* Frames lost: ring full */
+	volatile uint32_t overwritten;			/* Frames lost in an MB before the interrupt (CODE=OVERRUN) */
+}FLEXCAN_RX_t;
+
+void 						FLEXCAN_RX_init			(FLEXCAN_RX_t * rx, uint8_t instance, uint8_t first_mb,
+													 uint8_t mb_count, uint8_t mb_words, uint32_t * ring,
+													 uint16_t slots);
+const FLEXCAN_RX_Frame_t * 	FLEXCAN_RX_peek			(FLEXCAN_RX_t * rx);
+void 						FLEXCAN_RX_release		(FLEXCAN_RX_t * rx);
+uint16_t 					FLEXCAN_RX_pending		(FLEXCAN_RX_t * rx);
+void 						FLEXCAN_RX_IRQHandler	(FLEXCAN_RX_t * rx);
+
+#endif /* FLEXCAN_RX_H_ */
@@ -32,10 +32,17 @@
 
 #include "CAN_PNET.h"
 #include "register_bit_fields.h"
+#include "FlexCAN_TX.h"
+#include "FlexCAN_Timing.h"
+#include "FlexCAN_Layout.h"
 #include "stdint.h"
 
 #define __IOM volatile 							/* The compiler won't optimize this macro */
 
+/* CAN Classic: 8-byte MBs, no FIFO, reception through the Wake Up MBs, MB0..MB3 transmit */
+FLEXCAN_LAYOUT(CAN0_LAYOUT, 8, 0, 0, 4);
+FLEXCAN_LAYOUT_ASSERT(CAN0_LAYOUT);
+
 /*!
 * @brief Bit field declaration for the transmission and reception message buffers. See "Message Buffer Structure" in RM.
 * 		 NOTE: Since this example manages CAN Classic (8 bytes for header and 8 bytes for payload)
@@ -60,9 +67,11 @@ typedef struct
       __IOM uint32_t STD_ID     : 11;
       __IOM uint32_t PRIO       : 3;
       __IOM uint32_t payload[2];				/* 8 bytes (2 words) for payload */
-    } Classic_MessageBuffer[32];				/* 32 MBs available */
+    } Classic_MessageBuffer[CAN0_LAYOUT_MB_COUNT];	/* 32 MBs available */
 } CAN0_MB_t;
 
+_Static_assert(sizeof(CAN0_MB_t) == 4u * CAN0_LAYOUT_MB_COUNT * CAN0_LAYOUT_MB_WORDS, "CAN0_MB_t must match the MB layout");
+
 /*!
 * @brief Type casting of the structure declared above to the corresponding CAN0 memory area.
 *        Refer to the header file "register_bit_fields.h" located inside the project's
@@ -84,29 +93,39 @@ typedef struct
 	uint8_t RJW;
 } CAN_bit_timings_t;
 
-/* CAN bit timings for 250 Kbit/s with 16 time quantas and a a divider of 2*/
+#define CAN_CLK_HZ		8000000		/* CLKSRC=0: SOSCDIV2 */
+#define CAN_DELAY_NS	250			/* Transceiver loop delay and bus line, one way */
+
+/* CAN bit timings for 250 Kbit/s sampled at 81.2%, solved at compile time from the 8 MHz CAN clock */
+FLEXCAN_TIMING(CAN_NOMINAL, CTRL1, CAN_CLK_HZ, 250000, 812, CAN_DELAY_NS);
+FLEXCAN_TIMING_ASSERT(CAN_NOMINAL);
+
 CAN_bit_timings_t timings =
 {
-	.PRESDIV = 1,
-    .PROPSEG = 5,
-    .PSEG1 = 5,
-    .PSEG2 = 2,
-    .RJW = 2,
-
-	/* (PRESDIV + 1) * (PROPSEG + PSEG1 + PSEG2 + 4) = (2 * 16 quantas) = 32  */
-	/* Resynchronization Jump Width = RJW + 1 = 3 */
+	.PRESDIV = CAN_NOMINAL_PRESDIV,
+    .PROPSEG = CAN_NOMINAL_PROPSEG,
+    .PSEG1 = CAN_NOMINAL_PSEG1,
+    .PSEG2 = CAN_NOMINAL_PSEG2,
+    .RJW = CAN_NOMINAL_RJW,
+
+	/* (PRESDIV + 1) * (PROPSEG + PSEG1 + PSEG2 + 4) = CAN_NOMINAL_PRESC * CAN_NOMINAL_TQ */
+	/* Resynchronization Jump Width = RJW + 1 */
 	/* Bit Timing = FlaxCan CLK / time quantas = 8 MHz / 32 = 250 Kbit/s */
 };
 
 
 /*!
-* @brief Enum for the index of the Message Buffer (MB) used, 0th for TX.
-* 		 There are a total of 32 MBs available, however in this project only 1 MB for TX is used.
+* @brief Reception goes through the Wake Up Message Buffers. MB0 to MB3 are TX MBs managed by
+* 		 the transmit queue (FlexCAN_TX.c).
 */
-typedef enum
-{
-    TX_MB = 0,
-} MB_index_Enum;
+#define TX_FIRST_MB		(CAN0_LAYOUT_TX_FIRST)		/* MB0..MB3 transmit */
+#define TX_MB_COUNT		(CAN0_LAYOUT_TX_COUNT)
+#define TX_MB_WORDS		(CAN0_LAYOUT_MB_WORDS)		/* 2 header words + payload words */
+#define TX_QUEUE_SIZE	(16u)
+
+/* Transmit queue over the TX message buffers */
+static FLEXCAN_TX_t tx;
+static FLEXCAN_TX_Frame_t tx_queue[TX_QUEUE_SIZE];
 
 
 /*!
@@ -128,6 +147,9 @@ status_t FlexCAN_init_PNET (void)
     /* Block for freeze mode entry */
     while(!(CAN0 -> CAN0_MCR_b.FRZACK));
 
+    /* Scan the TX MBs only: the Wake Up MBs are outside the MB RAM */
+    CAN0 -> CAN0_MCR_b.MAXMB = CAN0_LAYOUT_MAXMB;
+
     /* Enable Pretended Networking Mode */
     CAN0 -> CAN0_MCR_b.PNET_EN = CAN0_MCR_PNET_EN_1;
 
@@ -157,6 +179,9 @@ status_t FlexCAN_init_PNET (void)
     /* Block for module ready flag */
     while(CAN0 -> CAN0_MCR_b.NOTRDY);
 
+    /* Hand the TX message buffers to the queue: local priority (LPRIOEN) and lowest ID first (LBUF=0) */
+    FLEXCAN_TX_init(&tx, 0, TX_FIRST_MB, TX_MB_COUNT, TX_MB_WORDS, tx_queue, TX_QUEUE_SIZE);
+
     /* Success initialization */
     return Success;
 }
@@ -205,41 +230,40 @@ status_t FlexCAN_install_ID (uint32_t id)
 
 
 /*!
-* @brief Transmit a single CAN frame
+* @brief Queue a CAN frame for transmission. The frame takes the first free TX message buffer
+* 		 or waits in the queue; FlexCAN sends the loaded MBs by priority and the MB interrupt
+* 		 reloads them, so the function never waits for the bus.
 *
 * @param [frame] 	 The reference to the frame that is going to be transmitted
 *
-* @return Success    If the frame was sent immediately
+* @return Success    If the frame was queued
+* @return BufferFull If the queue is full, the frame is dropped
 */
 status_t FlexCAN_transmit_frame (frame_t* frame)
 {
-    /* Insert the payload for transmission. CAN Classic has 2 words (8 bytes) for payload */
+    FLEXCAN_TX_Frame_t tx_frame;
+
+    /* Copy the payload. CAN Classic has 2 words (8 bytes) for payload */
     for(uint8_t i = 0; i < MAX_MTU_WORDS; i++)
     {
-        CAN0_MB -> Classic_MessageBuffer[TX_MB].payload[i] = frame -> payload[i];
+        tx_frame.payload[i] = frame -> payload[i];
     }
 
-    /* Set the frame's destination ID */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].STD_ID = frame -> ID;
-
-    /* Configure transmission message buffer. See "Message Buffer Structure" in RM */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].EDL =  0;   	/* No extended data length */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].BRS =  0;   	/* No bit-rate switch */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].ESI =  0;		/* No applies */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].SRR =  0;		/* No applies */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].IDE =  0;   	/* Standard ID */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].RTR =  0;		/* No remote request made */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].DLC = 0x8;  	/* 8 bytes of payload */
-    CAN0_MB -> Classic_MessageBuffer[TX_MB].CODE = 0xC; 	/* After TX, the MB automatically returns to the INACTIVE state */
+    tx_frame.ID    = frame -> ID;					/* Destination ID */
+    tx_frame.prio  = 0;								/* Local priority, ahead of the ID in the MB arbitration */
+    tx_frame.flags = 0;
+    tx_frame.dlc   = 8;
 
-    /* After a successful transmission the interrupt flag of the corresponding message buffer is set */
-    while(!(CAN0 -> CAN0_IFLAG1_b.BUF0I));
+    return FLEXCAN_TX_send(&tx, &tx_frame) ? Success : BufferFull;
+}
 
-    /* Clear the flag previously polled (W1C register) */
-    CAN0 -> CAN0_IFLAG1_b.BUF0I = 1;
 
-    /* Return successful transmission request status */
-    return Success;
+/*!
+* @brief TX message buffer interrupt: completed MBs are reloaded from the queue
+*/
+void CAN0_ORed_0_15_MB_IRQHandler (void)
+{
+    FLEXCAN_TX_IRQHandler(&tx);
 }
 
 
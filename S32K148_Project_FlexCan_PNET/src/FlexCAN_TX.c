@@ -0,0 +1,444 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"	/* include peripheral declarations */
+#include "FlexCAN_TX.h"
+
+/*!
+ * Description:
+ * ===================================================
+ * FLEXCAN_TX_init takes a range of message buffers of an initialized FlexCAN for transmission:
+ *
+ * 	Send:  the frame is inserted in the queue after the frames of higher or equal priority and
+ * 	       the best frames are copied into the free TX MBs at once. FlexCAN then picks among
+ * 	       the active MBs by PRIO and ID on its own, so up to mb_count frames are in flight.
+ * 	IRQ:   each TX MB flag frees its MB, which is reloaded from the head of the queue.
+ * 	Order: a frame is not loaded while another frame with the same ID is still in an MB, so
+ * 	       frames of one ID leave in the order they were sent.
+ * 	Inversion: when every TX MB is busy and the best waiting frame outranks the worst frame
+ * 	       in an MB, that MB is aborted (MCR[AEN]) and its frame goes back to the queue.
+ *
+ * FLEXCAN_TX_IRQHandler is called from CANn_ORed_0_15_MB_IRQHandler (and the 16_31 one when
+ * the range goes above MB 15) of the application.
+ */
+
+#define FLEXCAN_MB_CODE_SHIFT		(24u)
+#define FLEXCAN_MB_CODE_MASK		(0x0F000000u)
+#define FLEXCAN_MB_CODE_TX_INACTIVE	(0x8u)
+#define FLEXCAN_MB_CODE_TX_ABORT	(0x9u)
+#define FLEXCAN_MB_CODE_TX_DATA		(0xCu)
+#define FLEXCAN_MB_CS_EDL			(0x80000000u)
+#define FLEXCAN_MB_CS_BRS			(0x40000000u)
+#define FLEXCAN_MB_ID_PRIO_SHIFT	(29u)
+#define FLEXCAN_MB_ID_STD_SHIFT		(18u)
+#define FLEXCAN_RANK_ID_MASK		(0x3FFFFFFFull)		/* Rank without the PRIO bits */
+
+static CAN_Type * const FLEXCAN_bases[] = CAN_BASE_PTRS;
+static const IRQn_Type FLEXCAN_irqs_0_15[] = CAN_ORed_0_15_MB_IRQS;
+static const IRQn_Type FLEXCAN_irqs_16_31[] = CAN_ORed_16_31_MB_IRQS;
+static const uint8_t FLEXCAN_dlc_bytes[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64 };
+
+static void NVIC_enable(IRQn_Type irq)
+{
+	S32_NVIC->ICPR[(uint32_t)irq >> 5u] = 1u << ((uint32_t)irq & 0x1Fu);	/* Clear any pending IR */
+	S32_NVIC->ISER[(uint32_t)irq >> 5u] = 1u << ((uint32_t)irq & 0x1Fu);	/* Enable IRQ */
+}
+
+static volatile uint32_t * FLEXCAN_TX_mb(FLEXCAN_TX_t * tx, uint32_t mb)
+{
+	return &FLEXCAN_bases[tx->instance]->RAMn[mb * tx->mb_words];
+}
+
+/*!
+* @brief Payload words to copy for a DLC, limited by the MB size.
+*/
+static uint32_t FLEXCAN_TX_words(FLEXCAN_TX_t * tx, uint8_t dlc, uint8_t flags)
+{
+	uint32_t bytes = FLEXCAN_dlc_bytes[dlc & 0xFu];
+	uint32_t words;
+
+	if (!(flags & FLEXCAN_TX_FD) && (bytes > 8u))
+	{
+		bytes = 8u;							/* Classic frames carry 8 bytes at most */
+	}
+	words = (bytes + 3u) / 4u;
+	return (words < tx->mb_words - 2u) ? words : (uint32_t)(tx->mb_words - 2u);
+}
+
+/*!
+* @brief Internal arbitration value, lower wins: PRIO, then the ID bits in the order they go
+* on the wire (base ID, IDE, ID extension), so a standard frame beats an extended frame with
+* the same base ID.
+*/
+static uint64_t FLEXCAN_TX_rank(uint8_t prio, uint32_t id, uint8_t flags)
+{
+	uint32_t wire = (flags & FLEXCAN_TX_EXTENDED) ? (((id & CAN_WMBn_ID_ID_MASK) << 1) | 1u)
+												  : ((id & 0x7FFu) << 19);
+	return ((uint64_t)(prio & 0x7u) << 30) | wire;
+}
+
+static uint64_t FLEXCAN_TX_frame_rank(const FLEXCAN_TX_Frame_t * frame)
+{
+	return FLEXCAN_TX_rank(frame->prio, frame->ID, frame->flags);
+}
+
+/*!
+* @brief Copy a frame into a free TX MB and activate it.
+*/
+static void FLEXCAN_TX_load(FLEXCAN_TX_t * tx, uint32_t mb, const FLEXCAN_TX_Frame_t * frame)
+{
+	volatile uint32_t * buf = FLEXCAN_TX_mb(tx, mb);
+	uint32_t words = FLEXCAN_TX_words(tx, frame->dlc, frame->flags);
+	uint32_t cs = (FLEXCAN_MB_CODE_TX_DATA << FLEXCAN_MB_CODE_SHIFT) |	/* CODE=0xC: transmit, INACTIVE after */
+				  CAN_WMBn_CS_SRR_MASK |								/* SRR=1: required for extended IDs */
+				  CAN_WMBn_CS_DLC(frame->dlc);
+	uint32_t i;
+
+	for (i = 0; i < words; i++)
+	{
+		buf[2u + i] = frame->payload[i];
+	}
+	if (frame->flags & FLEXCAN_TX_EXTENDED)
+	{
+		buf[1] = ((uint32_t)frame->prio << FLEXCAN_MB_ID_PRIO_SHIFT) | (frame->ID & CAN_WMBn_ID_ID_MASK);
+		cs |= CAN_WMBn_CS_IDE_MASK;
+	}
+	else
+	{
+		buf[1] = ((uint32_t)frame->prio << FLEXCAN_MB_ID_PRIO_SHIFT) | ((frame->ID & 0x7FFu) << FLEXCAN_MB_ID_STD_SHIFT);
+	}
+	if (frame->flags & FLEXCAN_TX_FD)
+	{
+		cs |= FLEXCAN_MB_CS_EDL | ((frame->flags & FLEXCAN_TX_BRS) ? FLEXCAN_MB_CS_BRS : 0u);
+	}
+	tx->rank[mb - tx->first_mb] = FLEXCAN_TX_frame_rank(frame);	/* Kept in RAM: MB reads are slower */
+	tx->busy |= 1u << mb;
+	buf[0] = cs;							/* C/S last: the MB joins the arbitration now */
+}
+
+/*!
+* @brief Rebuild the frame of an aborted MB so that it can be queued again.
+*/
+static void FLEXCAN_TX_unload(FLEXCAN_TX_t * tx, uint32_t mb, FLEXCAN_TX_Frame_t * frame)
+{
+	volatile uint32_t * buf = FLEXCAN_TX_mb(tx, mb);
+	uint32_t cs = buf[0];
+	uint32_t id = buf[1];
+	uint32_t words;
+	uint32_t i;
+
+	frame->flags = (uint8_t)(((cs & CAN_WMBn_CS_IDE_MASK) ? FLEXCAN_TX_EXTENDED : 0u) |
+							 ((cs & FLEXCAN_MB_CS_EDL) ? FLEXCAN_TX_FD : 0u) |
+							 ((cs & FLEXCAN_MB_CS_BRS) ? FLEXCAN_TX_BRS : 0u));
+	frame->prio = (uint8_t)(id >> FLEXCAN_MB_ID_PRIO_SHIFT);
+	frame->ID = (cs & CAN_WMBn_CS_IDE_MASK) ? (id & CAN_WMBn_ID_ID_MASK)
+											: ((id & CAN_WMBn_ID_ID_MASK) >> FLEXCAN_MB_ID_STD_SHIFT);
+	frame->dlc = (uint8_t)((cs & CAN_WMBn_CS_DLC_MASK) >> CAN_WMBn_CS_DLC_SHIFT);
+	words = FLEXCAN_TX_words(tx, frame->dlc, frame->flags);
+	for (i = 0; i < words; i++)
+	{
+		frame->payload[i] = buf[2u + i];
+	}
+}
+
+/*!
+* @brief Insert a frame in the queue by rank.
+*
+* @param[uint8_t ahead] 0: behind the frames of the same rank (new frame),
+* 						1: in front of them (frame pulled back from an MB, older than those)
+* @return 1 if queued, 0 if the queue is full
+*/
+static uint8_t FLEXCAN_TX_insert(FLEXCAN_TX_t * tx, const FLEXCAN_TX_Frame_t * frame, uint8_t ahead)
+{
+	uint64_t rank = FLEXCAN_TX_frame_rank(frame);
+	uint32_t i = tx->queue_count;
+
+	if (i == tx->queue_size)
+	{
+		return 0u;
+	}
+	while ((i > 0u) && (ahead ? (rank <= FLEXCAN_TX_frame_rank(&tx->queue[i - 1u]))
+							  : (rank < FLEXCAN_TX_frame_rank(&tx->queue[i - 1u]))))
+	{
+		tx->queue[i] = tx->queue[i - 1u];
+		i--;
+	}
+	tx->queue[i] = *frame;
+	tx->queue_count++;
+	return 1u;
+}
+
+static void FLEXCAN_TX_remove(FLEXCAN_TX_t * tx, uint32_t index)
+{
+	uint32_t i;
+
+	for (i = index; i + 1u < tx->queue_count; i++)
+	{
+		tx->queue[i] = tx->queue[i + 1u];
+	}
+	tx->queue_count--;
+}
+
+/*!
+* @brief Best queued frame whose ID is not already in an MB.
+*
+* @return Queue index, -1 if none
+*/
+static int32_t FLEXCAN_TX_next(FLEXCAN_TX_t * tx)
+{
+	uint32_t i;
+	uint32_t mb;
+
+	for (i = 0; i < tx->queue_count; i++)
+	{
+		uint64_t id = FLEXCAN_TX_frame_rank(&tx->queue[i]) & FLEXCAN_RANK_ID_MASK;
+
+		for (mb = tx->first_mb; mb < (uint32_t)tx->first_mb + tx->mb_count; mb++)
+		{
+			if ((tx->busy & (1u << mb)) && ((tx->rank[mb - tx->first_mb] & FLEXCAN_RANK_ID_MASK) == id))
+			{
+				break;
+			}
+		}
+		if (mb == (uint32_t)tx->first_mb + tx->mb_count)
+		{
+			return (int32_t)i;
+		}
+	}
+	return -1;
+}
+
+/*!
+* @brief Move queued frames into the free TX MBs; with none free, abort the worst MB if the
+* best waiting frame outranks it. Called with the TX MB interrupts held off.
+*/
+static void FLEXCAN_TX_schedule(FLEXCAN_TX_t * tx)
+{
+	int32_t next = FLEXCAN_TX_next(tx);
+	uint32_t worst = 0;
+	uint64_t worst_rank = 0;
+	uint32_t mb;
+
+	while (next >= 0)
+	{
+		for (mb = tx->first_mb; mb < (uint32_t)tx->first_mb + tx->mb_count; mb++)
+		{
+			if (!(tx->busy & (1u << mb)))
+			{
+				break;
+			}
+		}
+		if (mb == (uint32_t)tx->first_mb + tx->mb_count)
+		{
+			break;							/* All TX MBs busy */
+		}
+		FLEXCAN_TX_load(tx, mb, &tx->queue[next]);
+		FLEXCAN_TX_remove(tx, (uint32_t)next);
+		next = FLEXCAN_TX_next(tx);
+	}
+
+	if ((next < 0) || (tx->aborting != 0u) || (tx->queue_count == tx->queue_size))
+	{
+		return;							/* One abort at a time, with room to queue its frame */
+	}
+	for (mb = tx->first_mb; mb < (uint32_t)tx->first_mb + tx->mb_count; mb++)
+	{
+		if (tx->rank[mb - tx->first_mb] >= worst_rank)
+		{
+			worst_rank = tx->rank[mb - tx->first_mb];
+			worst = mb;
+		}
+	}
+	if ((FLEXCAN_TX_frame_rank(&tx->queue[next]) < worst_rank) &&
+		!(FLEXCAN_bases[tx->instance]->IFLAG1 & (1u << worst)))		/* Not already done, IRQ held off */
+	{
+		volatile uint32_t * buf = FLEXCAN_TX_mb(tx, worst);
+		tx->aborting = 1u << worst;
+		buf[0] = (buf[0] & ~FLEXCAN_MB_CODE_MASK) | (FLEXCAN_MB_CODE_TX_ABORT << FLEXCAN_MB_CODE_SHIFT);
+	}
+}
+
+/*!
+* @brief Hand a range of MBs of an initialized FlexCAN to the transmit queue.
+*
+* @param[FLEXCAN_TX_t * tx] Queue state
+* @param[uint8_t instance] FlexCAN instance, configured by its init function
+* @param[uint8_t first_mb] First TX message buffer
+* @param[uint8_t mb_count] Number of TX message buffers
+* @param[uint8_t mb_words] Words per MB: 4 (8-byte payload) up to 18 (64-byte payload)
+* @param[FLEXCAN_TX_Frame_t * queue] Storage for the frames waiting for an MB
+* @param[uint8_t queue_size] Number of frames in queue
+*/
+void FLEXCAN_TX_init(FLEXCAN_TX_t * tx, uint8_t instance, uint8_t first_mb, uint8_t mb_count,
+					 uint8_t mb_words, FLEXCAN_TX_Frame_t * queue, uint8_t queue_size)
+{
+	CAN_Type * base;
+	uint32_t last = (uint32_t)first_mb + mb_count - 1u;
+	uint32_t mb;
+
+	DEV_ASSERT(instance < CAN_INSTANCE_COUNT);
+	DEV_ASSERT((mb_count > 0u) && (mb_count <= FLEXCAN_TX_MAX_MBS) && (last < 32u));
+	DEV_ASSERT((mb_words >= 4u) && (mb_words <= 18u) && ((last + 1u) * mb_words <= CAN_RAMn_COUNT));
+
+	base = FLEXCAN_bases[instance];
+
+	tx->instance    = instance;
+	tx->first_mb    = first_mb;
+	tx->mb_count    = mb_count;
+	tx->mb_words    = mb_words;
+	tx->mb_mask     = ((1u << mb_count) - 1u) << first_mb;
+	tx->busy        = 0;
+	tx->aborting    = 0;
+	tx->queue       = queue;
+	tx->queue_size  = queue_size;
+	tx->queue_count = 0;
+	tx->sent        = 0;
+	tx->preempted   = 0;
+	tx->dropped     = 0;
+
+	base->MCR |= CAN_MCR_FRZ_MASK | CAN_MCR_HALT_MASK;	/* Request freeze mode entry */
+	while (!(base->MCR & CAN_MCR_FRZACK_MASK)) {}
+
+	base->MCR |= CAN_MCR_LPRIOEN_MASK |				/* PRIO field joins the TX arbitration */
+				 CAN_MCR_AEN_MASK;					/* Abort keeps the frame if not yet sent */
+	if ((base->MCR & CAN_MCR_MAXMB_MASK) < last)
+	{
+		base->MCR = (base->MCR & ~CAN_MCR_MAXMB_MASK) | CAN_MCR_MAXMB(last);
+	}
+	base->CTRL1 &= ~CAN_CTRL1_LBUF_MASK;			/* LBUF=0: lowest PRIO and ID goes first */
+	for (mb = first_mb; mb <= last; mb++)
+	{
+		FLEXCAN_TX_mb(tx, mb)[0] = FLEXCAN_MB_CODE_TX_INACTIVE << FLEXCAN_MB_CODE_SHIFT;
+	}
+	base->IFLAG1 = tx->mb_mask;						/* Clear stale flags (W1C) */
+	base->IMASK1 |= tx->mb_mask;					/* IRQ at every TX completion */
+
+	base->MCR &= ~(CAN_MCR_FRZ_MASK | CAN_MCR_HALT_MASK);	/* Exit freeze mode */
+	while (base->MCR & CAN_MCR_FRZACK_MASK) {}
+	while (base->MCR & CAN_MCR_NOTRDY_MASK) {}
+
+	if (tx->mb_mask & 0x0000FFFFu)
+	{
+		NVIC_enable(FLEXCAN_irqs_0_15[instance]);
+	}
+	if (tx->mb_mask & 0xFFFF0000u)
+	{
+		NVIC_enable(FLEXCAN_irqs_16_31[instance]);
+	}
+}
+
+/*!
+* @brief Queue a frame for transmission without waiting for the bus. Called from one context
+* only (main loop or one ISR of lower priority than the MB interrupt).
+*
+* @param[FLEXCAN_TX_t * tx] Queue
+* @param[const FLEXCAN_TX_Frame_t * frame] Frame, copied
+* @return 1 if the frame was accepted, 0 if the queue is full
+*/
+uint8_t FLEXCAN_TX_send(FLEXCAN_TX_t * tx, const FLEXCAN_TX_Frame_t * frame)
+{
+	CAN_Type * base = FLEXCAN_bases[tx->instance];
+	uint8_t accepted;
+
+	base->IMASK1 &= ~tx->mb_mask;		/* Hold the TX completions while the queue changes */
+	accepted = 0;
+	if ((tx->queue_count + ((tx->aborting != 0u) ? 1u : 0u)) < tx->queue_size)	/* Room for an aborted frame */
+	{
+		accepted = FLEXCAN_TX_insert(tx, frame, 0u);
+	}
+	if (accepted)
+	{
+		FLEXCAN_TX_schedule(tx);
+	}
+	else
+	{
+		tx->dropped++;
+	}
+	base->IMASK1 |= tx->mb_mask;		/* Flags raised meanwhile interrupt now */
+	return accepted;
+}
+
+/*!
+* @brief Check whether every queued frame has left.
+*
+* @param[FLEXCAN_TX_t * tx] Queue
+* @return 1 if no frame waits in the queue or in an MB
+*/
+uint8_t FLEXCAN_TX_idle(FLEXCAN_TX_t * tx)
+{
+	return (uint8_t)((tx->busy == 0u) && (tx->queue_count == 0u));
+}
+
+/*!
+* @brief TX MB interrupt: account for the finished MBs and reload them from the queue.
+*
+* @param[FLEXCAN_TX_t * tx] Queue
+*/
+void FLEXCAN_TX_IRQHandler(FLEXCAN_TX_t * tx)
+{
+	CAN_Type * base = FLEXCAN_bases[tx->instance];
+	uint32_t flags = base->IFLAG1 & tx->mb_mask & tx->busy;
+	FLEXCAN_TX_Frame_t pulled;
+	uint8_t requeue = 0;
+	uint32_t mb;
+
+	if (!(base->IMASK1 & tx->mb_mask))
+	{
+		return;								/* Pended just before FLEXCAN_TX_send masked the MBs */
+	}
+	base->IFLAG1 = flags;					/* W1C, other flags untouched */
+	for (mb = tx->first_mb; mb < (uint32_t)tx->first_mb + tx->mb_count; mb++)
+	{
+		if (!(flags & (1u << mb)))
+		{
+			continue;
+		}
+		if (((FLEXCAN_TX_mb(tx, mb)[0] & FLEXCAN_MB_CODE_MASK) >> FLEXCAN_MB_CODE_SHIFT) == FLEXCAN_MB_CODE_TX_ABORT)
+		{
+			FLEXCAN_TX_unload(tx, mb, &pulled);	/* Aborted before reaching the bus */
+			requeue = 1u;
+			tx->preempted++;
+		}
+		else
+		{
+			tx->sent++;							/* INACTIVE: transmitted, even if an abort was asked */
+		}
+		tx->busy &= ~(1u << mb);
+		tx->aborting &= ~(1u << mb);
+	}
+
+	if (requeue && !FLEXCAN_TX_insert(tx, &pulled, 1u))	/* Slot kept free by FLEXCAN_TX_send */
+	{
+		tx->dropped++;
+	}
+	FLEXCAN_TX_schedule(tx);					/* The frame that caused the abort takes the MB */
+}
@@ -64,6 +64,9 @@ volatile uint32_t frame_count = 0;
 /* Reception frame */
 volatile frame_t Reception_frame;
 
+/* Set by the wake up ISR: the TX interrupts also end WFI and must not trigger a reply */
+volatile uint8_t frame_received = 0;
+
 /*!
 * @brief PORTn Initialization
 */
@@ -164,7 +167,11 @@ int main (void)
         __asm volatile("WFI");
 
         /* Transmit a frame back after waking up and executing the reception ISR */
-        status = FlexCAN_transmit_frame(&Transmission_frame);
+        if(frame_received)
+        {
+            frame_received = 0;
+            status = FlexCAN_transmit_frame(&Transmission_frame);
+        }
 
     }
     return 0;
@@ -192,6 +199,7 @@ void CAN0_Wake_Up_IRQHandler (void)
 
     /* Increment the reception counter */
     frame_count++;
+    frame_received = 1;
 
     /* Each 1000 frames received, the green LED will toggle and counter resets */
     if(frame_count == 1000)
@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"
+#include "LPSPI_DMA.h"
+
+/*!
+ * Description:
+ * ===================================================
+ * LPSPIn is left configured by its init function (clock, CCR delays, CFGR1 master and pin
+ * configuration). LPSPI_DMA_init adds the FIFO watermarks and the DMA requests, and clears
+ * NOSTALL so that a full RX FIFO holds the clock instead of losing words.
+ *
+ * A job is a list of segments. For each segment the TX channel writes the command word to TCR
+ * and then the data words to TDR (no data for TXMSK commands); a last command word with CONT
+ * cleared ends the job, so PCS is always negated at the end. Each TCD of the chain loads the
+ * next one (ESG) and the last one stops the requests (DREQ) and interrupts. The RX channel has
+ * one TCD per receiving segment, chained the same way.
+ *
+ * The job is over when the RX channel is done (if the job receives) and the LPSPI is idle
+ * after the TX channel: TX FIFO empty, module not busy. The last frames may still be on the
+ * wire when the TX channel finishes, so its IRQ hands over to the LPSPI TCF interrupt.
+ * The next job of the queue is started before the callback of the finished one runs.
+ *
+ * The handlers LPSPI_DMA_IRQHandler, LPSPI_DMA_TxIRQHandler and LPSPI_DMA_RxIRQHandler are
+ * called from LPSPIn_IRQHandler and the two DMAn_IRQHandler of the application, which must
+ * keep them at the same priority so they do not preempt each other.
+ */
+
+#define LPSPI_DMA_PENDING_TX	(0x01u)
+#define LPSPI_DMA_PENDING_RX	(0x02u)
+
+#define LPSPI_SR_W1C_MASK		(LPSPI_SR_WCF_MASK | LPSPI_SR_FCF_MASK | LPSPI_SR_TCF_MASK | \
+								 LPSPI_SR_TEF_MASK | LPSPI_SR_REF_MASK | LPSPI_SR_DMF_MASK)
+
+static LPSPI_Type * const LPSPI_bases[] = LPSPI_BASE_PTRS;
+static const IRQn_Type LPSPI_irqs[] = LPSPI_IRQS;
+static const uint32_t LPSPI_zero = 0;	/* Clocked out by segments without TX data */
+
+static void NVIC_enable(IRQn_Type irq)
+{
+	S32_NVIC->ICPR[(uint32_t)irq >> 5u] = 1u << ((uint32_t)irq & 0x1Fu);	/* Clear any pending IR */
+	S32_NVIC->ISER[(uint32_t)irq >> 5u] = 1u << ((uint32_t)irq & 0x1Fu);	/* Enable IRQ */
+}
+
+/*!
+* @brief Bytes of a FIFO word in memory for the frame size of a command.
+*
+* @param[uint32_t tcr] Command word
+* @return 1, 2 or 4
+*/
+static uint8_t LPSPI_DMA_word_size(uint32_t tcr)
+{
+	uint32_t bits = ((tcr & LPSPI_TCR_FRAMESZ_MASK) >> LPSPI_TCR_FRAMESZ_SHIFT) + 1u;
+
+	return (bits <= 8u) ? 1u : ((bits <= 16u) ? 2u : 4u);
+}
+
+/*!
+* @brief Fill a TCD image: count minor loops of one word of size bytes. The TCD loads next
+* when it is done, or stops the requests and interrupts if next is NULL.
+*
+* @param[LPSPI_DMA_TCD_t * tcd] TCD image
+* @param[uint32_t source] Source address
+* @param[int16_t soff] Source step
+* @param[uint32_t dest] Destination address
+* @param[int16_t doff] Destination step
+* @param[uint8_t size] 1, 2 or 4 bytes
+* @param[uint16_t count] Words
+* @param[LPSPI_DMA_TCD_t * next] Next TCD of the chain, NULL for the last one
+*/
+static void LPSPI_DMA_tcd(LPSPI_DMA_TCD_t * tcd, uint32_t source, int16_t soff, uint32_t dest, int16_t doff,
+						  uint8_t size, uint16_t count, LPSPI_DMA_TCD_t * next)
+{
+	uint16_t code = (uint16_t)(size >> 1);		/* 0: 8 bits, 1: 16 bits, 2: 32 bits */
+
+	tcd->SADDR = source;
+	tcd->SOFF = (uint16_t) soff;
+	tcd->ATTR = (uint16_t)(DMA_TCD_ATTR_SSIZE(code) | DMA_TCD_ATTR_DSIZE(code));
+	tcd->NBYTES = size;							/* One FIFO word per request */
+	tcd->SLAST = 0;
+	tcd->DADDR = dest;
+	tcd->DOFF = (uint16_t) doff;
+	tcd->CITER = count;
+	tcd->BITER = count;
+	if (next != NULL)
+	{
+		tcd->DLASTSGA = (uint32_t) next;		/* Scatter/gather: load the next TCD */
+		tcd->CSR = DMA_TCD_CSR_ESG_MASK;
+	}
+	else
+	{
+		tcd->DLASTSGA = 0;
+		tcd->CSR = DMA_TCD_CSR_DREQ_MASK |		/* Stop requests after the chain */
+				   DMA_TCD_CSR_INTMAJOR_MASK;	/* IRQ: this side of the job is done */
+	}
+}
+
+/*!
+* @brief Load a TCD image into a channel and enable its requests.
+*
+* @param[uint8_t ch] DMA channel
+* @param[const LPSPI_DMA_TCD_t * tcd] First TCD of the chain
+*/
+static void LPSPI_DMA_push(uint8_t ch, const LPSPI_DMA_TCD_t * tcd)
+{
+	DMA->CDNE = DMA_CDNE_CDNE(ch);				/* DONE must be clear to set ESG */
+	DMA->TCD[ch].SADDR = tcd->SADDR;
+	DMA->TCD[ch].SOFF = tcd->SOFF;
+	DMA->TCD[ch].ATTR = tcd->ATTR;
+	DMA->TCD[ch].NBYTES.MLNO = tcd->NBYTES;
+	DMA->TCD[ch].SLAST = tcd->SLAST;
+	DMA->TCD[ch].DADDR = tcd->DADDR;
+	DMA->TCD[ch].DOFF = tcd->DOFF;
+	DMA->TCD[ch].CITER.ELINKNO = tcd->CITER;
+	DMA->TCD[ch].DLASTSGA = tcd->DLASTSGA;
+	DMA->TCD[ch].BITER.ELINKNO = tcd->BITER;
+	DMA->TCD[ch].CSR = tcd->CSR;
+	DMA->SERQ = DMA_SERQ_SERQ(ch);				/* Enable TDF/RDF requests for the channel */
+}
+
+/*!
+* @brief Build the TCD chains of the job at the head of the queue and start both channels.
+* Called with the LPSPI idle, from the application or from an IRQ.
+*
+* @param[LPSPI_DMA_t * spi] Driver
+*/
+static void LPSPI_DMA_start(LPSPI_DMA_t * spi)
+{
+	LPSPI_DMA_Job_t * job = spi->head;
+	LPSPI_Type * base = spi->base;
+	uint8_t tx_count = 0;
+	uint8_t rx_count = 0;
+	uint8_t i;
+
+	for (i = 0; i < job->segment_count; i++)
+	{
+		const LPSPI_DMA_Segment_t * segment = &job->segments[i];
+		uint32_t tcr = segment->tcr;
+		uint8_t size = LPSPI_DMA_word_size(tcr);
+
+		if (segment->rx == NULL)
+		{
+			tcr |= LPSPI_TCR_RXMSK_MASK;		/* Nothing to receive: keep the RX FIFO empty */
+		}
+		spi->command[i] = tcr;
+		LPSPI_DMA_tcd(&spi->tx_tcd[tx_count], (uint32_t) &spi->command[i], 0, (uint32_t) &base->TCR, 0,
+					  4u, 1u, &spi->tx_tcd[tx_count + 1u]);
+		tx_count++;
+		if (!(tcr & LPSPI_TCR_TXMSK_MASK))
+		{
+			if (segment->tx != NULL)
+			{
+				LPSPI_DMA_tcd(&spi->tx_tcd[tx_count], (uint32_t) segment->tx, (int16_t) size, (uint32_t) &base->TDR, 0,
+							  size, segment->count, &spi->tx_tcd[tx_count + 1u]);
+			}
+			else
+			{
+				LPSPI_DMA_tcd(&spi->tx_tcd[tx_count], (uint32_t) &LPSPI_zero, 0, (uint32_t) &base->TDR, 0,
+							  size, segment->count, &spi->tx_tcd[tx_count + 1u]);
+			}
+			tx_count++;
+		}
+		if (segment->rx != NULL)
+		{
+			LPSPI_DMA_tcd(&spi->rx_tcd[rx_count], (uint32_t) &base->RDR, 0, (uint32_t) segment->rx, (int16_t) size,
+						  size, segment->count, &spi->rx_tcd[rx_count + 1u]);
+			rx_count++;
+		}
+	}
+
+	/* Closing command: same PCS and timing with CONT cleared, negates PCS after the last frame */
+	spi->command[i] = (spi->command[i - 1u] & ~(LPSPI_TCR_CONT_MASK | LPSPI_TCR_CONTC_MASK | LPSPI_TCR_TXMSK_MASK)) |
+					  LPSPI_TCR_RXMSK_MASK;
+	LPSPI_DMA_tcd(&spi->tx_tcd[tx_count], (uint32_t) &spi->command[i], 0, (uint32_t) &base->TCR, 0, 4u, 1u, NULL);
+
+	job->state = LPSPI_DMA_ACTIVE;
+	spi->pending = LPSPI_DMA_PENDING_TX;
+	base->SR = LPSPI_SR_W1C_MASK;				/* Clear the flags of the previous job */
+	if (rx_count != 0u)
+	{
+		spi->rx_tcd[rx_count - 1u].DLASTSGA = 0;
+		spi->rx_tcd[rx_count - 1u].CSR = DMA_TCD_CSR_DREQ_MASK | DMA_TCD_CSR_INTMAJOR_MASK;
+		spi->pending |= LPSPI_DMA_PENDING_RX;
+		LPSPI_DMA_push(spi->rx_ch, &spi->rx_tcd[0]);
+	}
+	LPSPI_DMA_push(spi->tx_ch, &spi->tx_tcd[0]);
+}
+
+/*!
+* @brief One side of the job in progress is done. When both are, retire the job, start the
+* next one and call back.
+*
+* @param[LPSPI_DMA_t * spi] Driver
+* @param[uint8_t side] LPSPI_DMA_PENDING_TX or LPSPI_DMA_PENDING_RX
+*/
+static void LPSPI_DMA_complete(LPSPI_DMA_t * spi, uint8_t side)
+{
+	LPSPI_DMA_Job_t * job = spi->head;
+	uint32_t sr;
+
+	spi->pending &= (uint8_t) ~side;
+	if ((spi->pending != 0u) || (job == NULL))
+	{
+		return;
+	}
+
+	sr = spi->base->SR;
+	spi->base->SR = sr & (LPSPI_SR_TEF_MASK | LPSPI_SR_REF_MASK);	/* Clear the FIFO errors (W1C) */
+	if (sr & (LPSPI_SR_TEF_MASK | LPSPI_SR_REF_MASK))
+	{
+		job->state = LPSPI_DMA_ERROR;
+		spi->errors++;
+	}
+	else
+	{
+		job->state = LPSPI_DMA_DONE;
+	}
+	spi->jobs++;
+
+	spi->head = job->next;
+	if (spi->head != NULL)
+	{
+		LPSPI_DMA_start(spi);					/* Keep the bus busy, then call back */
+	}
+	if (job->callback != NULL)
+	{
+		job->callback(job);
+	}
+}
+
+/*!
+* @brief Check that the LPSPI has sent everything: TX FIFO empty and module not busy.
+*
+* @param[LPSPI_Type * base] LPSPI
+* @return 1 if idle
+*/
+static uint8_t LPSPI_DMA_idle(LPSPI_Type * base)
+{
+	return ((base->FSR & LPSPI_FSR_TXCOUNT_MASK) == 0u) && ((base->SR & LPSPI_SR_MBF_MASK) == 0u);
+}
+
+/*!
+* @brief Attach a job queue to an initialized LPSPI master.
+*
+* @param[LPSPI_DMA_t * spi] Driver state
+* @param[LPSPI_Type * base] LPSPI0, LPSPI1 or LPSPI2, configured as master by its init function
+* @param[uint8_t tx_ch] DMA channel for the TX FIFO
+* @param[uint8_t rx_ch] DMA channel for the RX FIFO
+*/
+void LPSPI_DMA_init(LPSPI_DMA_t * spi, LPSPI_Type * base, uint8_t tx_ch, uint8_t rx_ch)
+{
+	uint8_t instance = 0;
+	uint32_t cr = base->CR;
+
+	while ((instance < LPSPI_INSTANCE_COUNT) && (LPSPI_bases[instance] != base))
+	{
+		instance++;
+	}
+	DEV_ASSERT(instance < LPSPI_INSTANCE_COUNT);
+
+	spi->base    = base;
+	spi->tx_ch   = tx_ch;
+	spi->rx_ch   = rx_ch;
+	spi->head    = NULL;
+	spi->tail    = NULL;
+	spi->pending = 0;
+	spi->jobs    = 0;
+	spi->errors  = 0;
+
+	SIM->PLATCGC |= SIM_PLATCGC_CGCDMA_MASK;			/* DMA Clock Gating Control Enable */
+	PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;	/* Enable clock for DMAMUX */
+
+	DMAMUX->CHCFG[tx_ch] = 0;							/* Disable the channel to change the source */
+	DMAMUX->CHCFG[tx_ch] = DMAMUX_CHCFG_SOURCE(EDMA_REQ_LPSPI0_TX + 2u * instance) | DMAMUX_CHCFG_ENBL_MASK;
+	DMAMUX->CHCFG[rx_ch] = 0;
+	DMAMUX->CHCFG[rx_ch] = DMAMUX_CHCFG_SOURCE(EDMA_REQ_LPSPI0_RX + 2u * instance) | DMAMUX_CHCFG_ENBL_MASK;
+	NVIC_enable((IRQn_Type)(DMA0_IRQn + tx_ch));
+	NVIC_enable((IRQn_Type)(DMA0_IRQn + rx_ch));
+
+	base->CR = cr & ~LPSPI_CR_MEN_MASK;					/* CFGR1 and FCR are written with the module disabled */
+	base->CFGR1 &= ~LPSPI_CFGR1_NOSTALL_MASK;			/* Stall on a full RX FIFO: TX and RX in lock-step */
+	base->FCR = LPSPI_FCR_TXWATER(2) |					/* TDF while 2 words or less wait: room for a burst */
+				LPSPI_FCR_RXWATER(0);					/* RDF as soon as a word is received */
+	base->IER = 0;
+	base->DER = LPSPI_DER_TDDE_MASK |					/* TDF requests the TX channel */
+				LPSPI_DER_RDDE_MASK;					/* RDF requests the RX channel */
+	base->CR = cr | LPSPI_CR_MEN_MASK | LPSPI_CR_RTF_MASK | LPSPI_CR_RRF_MASK;	/* Enable with empty FIFOs */
+	base->SR = LPSPI_SR_W1C_MASK;
+	NVIC_enable(LPSPI_irqs[instance]);
+}
+
+/*!
+* @brief Queue a job. It starts at once if the LPSPI is idle.
+*
+* @param[LPSPI_DMA_t * spi] Driver
+* @param[LPSPI_DMA_Job_t * job] Job, untouched by the application until it is done
+*/
+void LPSPI_DMA_submit(LPSPI_DMA_t * spi, LPSPI_DMA_Job_t * job)
+{
+	uint8_t i;
+
+	DEV_ASSERT((job->segment_count != 0u) && (job->segment_count <= LPSPI_DMA_SEGMENTS));
+	for (i = 0; i < job->segment_count; i++)
+	{
+		DEV_ASSERT((job->segments[i].count != 0u) && (job->segments[i].count <= 32767u));
+		DEV_ASSERT(((job->segments[i].tcr & LPSPI_TCR_WIDTH_MASK) == 0u) ||
+				   (job->segments[i].tx == NULL) || (job->segments[i].rx == NULL));	/* 2/4 lines: half duplex */
+	}
+
+	job->next = NULL;
+	job->state = LPSPI_DMA_QUEUED;
+
+	DISABLE_INTERRUPTS();
+	if (spi->head == NULL)
+	{
+		spi->head = job;
+		spi->tail = job;
+		LPSPI_DMA_start(spi);
+	}
+	else
+	{
+		spi->tail->next = job;
+		spi->tail = job;
+	}
+	ENABLE_INTERRUPTS();
+}
+
+/*!
+* @brief Check for jobs queued or in progress.
+*
+* @param[LPSPI_DMA_t * spi] Driver
+* @return 1 if a job is not done
+*/
+uint8_t LPSPI_DMA_busy(LPSPI_DMA_t * spi)
+{
+	return spi->head != NULL;
+}
+
+/*!
+* @brief LPSPIn_IRQHandler body: the last frames of the job have left the LPSPI.
+*
+* @param[LPSPI_DMA_t * spi] Driver
+*/
+void LPSPI_DMA_IRQHandler(LPSPI_DMA_t * spi)
+{
+	LPSPI_Type * base = spi->base;
+
+	base->SR = LPSPI_SR_TCF_MASK;						/* Clear Transfer Complete Flag (W1C) */
+	if (LPSPI_DMA_idle(base))
+	{
+		base->IER &= ~LPSPI_IER_TCIE_MASK;
+		LPSPI_DMA_complete(spi, LPSPI_DMA_PENDING_TX);
+	}
+}
+
+/*!
+* @brief TX DMA channel IRQ body: the whole job is in the TX FIFO, wait for it to be sent.
+*
+* @param[LPSPI_DMA_t * spi] Driver
+*/
+void LPSPI_DMA_TxIRQHandler(LPSPI_DMA_t * spi)
+{
+	LPSPI_Type * base = spi->base;
+
+	DMA->CINT = DMA_CINT_CINT(spi->tx_ch);				/* Clear Interruption request flag */
+	base->SR = LPSPI_SR_TCF_MASK;						/* TCF of the frames already sent */
+	base->IER |= LPSPI_IER_TCIE_MASK;					/* IRQ when PCS is negated */
+	if (LPSPI_DMA_idle(base))							/* Already out: no TCF will come */
+	{
+		base->IER &= ~LPSPI_IER_TCIE_MASK;
+		LPSPI_DMA_complete(spi, LPSPI_DMA_PENDING_TX);
+	}
+}
+
+/*!
+* @brief RX DMA channel IRQ body: every word of the job is in memory.
+*
+* @param[LPSPI_DMA_t * spi] Driver
+*/
+void LPSPI_DMA_RxIRQHandler(LPSPI_DMA_t * spi)
+{
+	DMA->CINT = DMA_CINT_CINT(spi->rx_ch);				/* Clear Interruption request flag */
+	LPSPI_DMA_complete(spi, LPSPI_DMA_PENDING_RX);
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LPSPI_DMA_H_
+#define LPSPI_DMA_H_
+
+#include <stddef.h>
+#include "device_registers.h"
+
+#ifndef LPSPI_DMA_SEGMENTS
+#define LPSPI_DMA_SEGMENTS		(4u)	/* Segments per job */
+#endif
+
+/* Job states */
+#define LPSPI_DMA_QUEUED		(1u)
+#define LPSPI_DMA_ACTIVE		(2u)
+#define LPSPI_DMA_DONE			(3u)
+#define LPSPI_DMA_ERROR			(4u)	/* Done, but the LPSPI reported a FIFO error (TEF/REF) */
+
+/* TCD image in RAM, loaded by the eDMA scatter/gather (32 bytes aligned) */
+typedef struct
+{
+	uint32_t SADDR;
+	uint16_t SOFF;
+	uint16_t ATTR;
+	uint32_t NBYTES;
+	uint32_t SLAST;
+	uint32_t DADDR;
+	uint16_t DOFF;
+	uint16_t CITER;
+	uint32_t DLASTSGA;
+	uint16_t CSR;
+	uint16_t BITER;
+}LPSPI_DMA_TCD_t;
+
+/* One command of a job: the TCR word (PCS, WIDTH, FRAMESZ, CONT/CONTC, TXMSK...) followed by
+ * count FIFO words, one per frame up to 32 bits and (FRAMESZ + 32) / 32 words per frame above.
+ * A word is 1 byte in memory for frames up to 8 bits, 2 bytes up to 16 bits, 4 bytes above.
+ *
+ * 	tx = NULL:	zeros are clocked out (or nothing is loaded when TCR has TXMSK: the count words
+ * 				are received in a single frame, which FRAMESZ must cover)
+ * 	rx = NULL:	RXMSK is added to the command and the received words are discarded
+ *
+ * WIDTH 1 or 2 (2 or 4 data lines) is half duplex: tx and rx cannot both be given. */
+typedef struct
+{
+	uint32_t tcr;
+	const void * tx;
+	void * rx;
+	uint16_t count;					/* FIFO words, 1 to 32767 */
+}LPSPI_DMA_Segment_t;
+
+typedef struct LPSPI_DMA_Job LPSPI_DMA_Job_t;
+
+/* Called from the DMA/LPSPI interrupts once the last frame of the job has left the LPSPI
+ * (PCS negated) and every received word is in memory. */
+typedef void (*LPSPI_DMA_Callback_t)(LPSPI_DMA_Job_t * job);
+
+struct LPSPI_DMA_Job
+{
+	const LPSPI_DMA_Segment_t * segments;
+	uint8_t segment_count;			/* 1 to LPSPI_DMA_SEGMENTS */
+	LPSPI_DMA_Callback_t callback;	/* NULL to poll state */
+	void * context;					/* For the callback */
+	LPSPI_DMA_Job_t * next;			/* Queue link, owned by the driver */
+	volatile uint8_t state;			/* LPSPI_DMA_QUEUED ... LPSPI_DMA_ERROR */
+};
+
+/* Job queue of one LPSPI master. The TX channel, triggered by TDF, loads the command and the
+ * data of each segment into the TX FIFO through a scatter/gather chain; the RX channel,
+ * triggered by RDF, empties the RX FIFO into the buffers of the receiving segments. The
+ * master stalls while the RX FIFO is full (NOSTALL = 0), so both channels run in lock-step
+ * and no word is lost whatever the DMA latency. */
+typedef struct
+{
+	LPSPI_DMA_TCD_t tx_tcd[2u * LPSPI_DMA_SEGMENTS + 1u] __attribute__ ((aligned (32)));
+	LPSPI_DMA_TCD_t rx_tcd[LPSPI_DMA_SEGMENTS] __attribute__ ((aligned (32)));
+	uint32_t command[LPSPI_DMA_SEGMENTS + 1u];	/* TCR words of the job, then the closing one */
+	LPSPI_Type * base;				/* LPSPI0, LPSPI1 or LPSPI2 */
+	uint8_t tx_ch;					/* DMA channel feeding the TX FIFO */
+	uint8_t rx_ch;					/* DMA channel draining the RX FIFO */
+	LPSPI_DMA_Job_t * volatile head;	/* Job in progress, NULL if idle */
+	LPSPI_DMA_Job_t * tail;			/* Last job queued */
+	volatile uint8_t pending;		/* Sides of the job in progress still running */
+	volatile uint32_t jobs;			/* Jobs completed since init */
+	volatile uint32_t errors;		/* Jobs completed with LPSPI_DMA_ERROR */
+}LPSPI_DMA_t;
+
+void 		LPSPI_DMA_init			(LPSPI_DMA_t * spi, LPSPI_Type * base, uint8_t tx_ch, uint8_t rx_ch);
+void 		LPSPI_DMA_submit		(LPSPI_DMA_t * spi, LPSPI_DMA_Job_t * job);
+uint8_t 	LPSPI_DMA_busy			(LPSPI_DMA_t * spi);
+void 		LPSPI_DMA_IRQHandler	(LPSPI_DMA_t * spi);
+void 		LPSPI_DMA_TxIRQHandler	(LPSPI_DMA_t * spi);
+void 		LPSPI_DMA_RxIRQHandler	(LPSPI_DMA_t * spi);
+
+#endif /* LPSPI_DMA_H_ */
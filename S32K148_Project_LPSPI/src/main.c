@@ -34,16 +34,31 @@
  * Description:
  * ==============================================================================
  * A simple LPSPI transfer is performed using FIFOs which can improve throughput. 
- * After initialization, a 16 bit frame is transmitted at 1 Mbps. Software will 
- * poll flags rather than using interrupts and/or DMA.
+ * After initialization, 16 bit frames are exchanged at 1 Mbps. The frames are queued
+ * as jobs: DMA channel 0 feeds the TX FIFO and DMA channel 1 empties the RX FIFO, so
+ * the CPU only sees one interrupt per job instead of polling every frame.
  */
 
 #include "device_registers.h"           /* include peripheral declarations */
 #include "LPSPI.h"
+#include "LPSPI_DMA.h"
 #include "clocks_and_modes.h"
 
-  uint16_t tx_16bits = 0xFD00;  
-  uint16_t LPSPI1_16bits_read;
+#define FRAMES	(8u)					/* 16 bit frames per job */
+
+  uint16_t tx_16bits[FRAMES] = { 0xFD00, 0xFD01, 0xFD02, 0xFD03, 0xFD04, 0xFD05, 0xFD06, 0xFD07 };
+  uint16_t LPSPI1_16bits_read[FRAMES];
+  uint32_t counter = 0;
+
+  LPSPI_DMA_t SPI1;
+  const LPSPI_DMA_Segment_t frames =
+  {
+	  .tcr   = LPSPI_TCR_CPHA_MASK | LPSPI_TCR_PRESCALE(2) | LPSPI_TCR_PCS(0) | LPSPI_TCR_FRAMESZ(15),
+	  .tx    = tx_16bits,
+	  .rx    = LPSPI1_16bits_read,
+	  .count = FRAMES,
+  };
+  LPSPI_DMA_Job_t job = { .segments = &frames, .segment_count = 1 };
 
 void WDOG_disable (void)
 {
@@ -72,10 +87,14 @@ void PORT_init (void)
 	  PORTA->PCR[29]|=PORT_PCR_MUX(5); /* Port B17: MUX = ALT3, LPSPI1_SIN */
 }
 
-int main(void)
+void job_done(LPSPI_DMA_Job_t * done)
 {
-  uint32_t counter = 0;
+  counter++;                                      /* FRAMES half words exchanged */
+  LPSPI_DMA_submit(&SPI1, done);                  /* Queue the same exchange again */
+}
 
+int main(void)
+{
 	/*!
 	 * Initialization:
 	 * =======================
@@ -86,6 +105,10 @@ int main(void)
   NormalRUNmode_80MHz();   /* Init clocks: 80 MHz sysclk & core, 40 MHz bus, 20 MHz flash */
   LPSPI1_init_master();    /* Initialize LPSPI 1 as master */
   PORT_init();             /* Configure ports */
+  LPSPI_DMA_init(&SPI1, LPSPI1, 0, 1);            /* TX FIFO on DMA CH0, RX FIFO on DMA CH1 */
+
+  job.callback = job_done;
+  LPSPI_DMA_submit(&SPI1, &job);                  /* Exchange tx_16bits with LPSPI1_16bits_read */
 
 	/*!
 	 * Infinite for:
@@ -93,8 +116,20 @@ int main(void)
 	 */
   for(;;)
   {
-    LPSPI1_transmit_16bits(tx_16bits);       		/* Transmit half word (16 bits) on LPSPI1 */
-    LPSPI1_16bits_read = LPSPI1_receive_16bits(); 	/* Receive half word on LSPI1 */
-    counter++;
   }
 }
+
+void DMA0_IRQHandler(void)
+{
+	LPSPI_DMA_TxIRQHandler(&SPI1);		/* Job loaded in the TX FIFO */
+}
+
+void DMA1_IRQHandler(void)
+{
+	LPSPI_DMA_RxIRQHandler(&SPI1);		/* Job received */
+}
+
+void LPSPI1_IRQHandler(void)
+{
+	LPSPI_DMA_IRQHandler(&SPI1);		/* Job sent */
+}
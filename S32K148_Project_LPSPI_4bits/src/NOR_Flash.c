@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "device_registers.h"
+#include "NOR_Flash.h"
+
+/*!
+ * Description:
+ * ===================================================
+ * Every instruction is one LPSPI_DMA job on the chip select of the flash, with one segment per
+ * phase: the opcode and the address share a 32 bit frame on 1 line, the dummy clocks of the
+ * fast reads are an 8 bit frame of zeros, and the data phase continues the transfer (CONTC)
+ * with its own width. Data words are byte swapped (BYSW) so the first byte on the wire is the
+ * first byte in memory. The job ends with CONT cleared, which negates the chip select.
+ *
+ * 	Read page, quad:	[6B A23-A0] [8 dummy clocks] [256 bytes in, 4 lines, TXMSK]
+ * 	Program, quad:		[32 A23-A0] [up to 256 bytes out, 4 lines]
+ * 	Erase sector:		[20 A23-A0]
+ * 	Status:				[05 xx] full duplex on 1 line
+ */
+
+#define NOR_CMD_WRITE_ENABLE	(0x06u)
+#define NOR_CMD_READ_SR1		(0x05u)
+#define NOR_CMD_READ_SR2		(0x35u)
+#define NOR_CMD_WRITE_SR2		(0x31u)
+#define NOR_CMD_JEDEC_ID		(0x9Fu)
+#define NOR_CMD_FAST_READ		(0x0Bu)
+#define NOR_CMD_FAST_READ_QUAD	(0x6Bu)		/* 1-1-4 */
+#define NOR_CMD_PROGRAM			(0x02u)
+#define NOR_CMD_PROGRAM_QUAD	(0x32u)		/* 1-1-4 */
+#define NOR_CMD_ERASE_SECTOR	(0x20u)
+
+#define NOR_SR2_QE				(0x02u)		/* Quad enable: IO2/IO3 are data lines */
+#define NOR_WAIT_POLLS			(100000u)	/* Status reads before giving up (> 2 s at 1 MHz) */
+
+/*!
+* @brief Run a job on the flash and wait for its end.
+*
+* @param[NOR_Flash_t * flash] Flash
+* @param[const LPSPI_DMA_Segment_t * segments] Phases of the instruction
+* @param[uint8_t count] Number of segments
+* @return 1 if the LPSPI reported no error
+*/
+static uint8_t NOR_run(NOR_Flash_t * flash, const LPSPI_DMA_Segment_t * segments, uint8_t count)
+{
+	LPSPI_DMA_Job_t job = { .segments = segments, .segment_count = count, .callback = NULL };
+
+	LPSPI_DMA_submit(flash->spi, &job);
+	DISABLE_INTERRUPTS();
+	while (job.state < LPSPI_DMA_DONE)
+	{
+		STANDBY();								/* Wakes on the pending DMA/LPSPI IRQ, even masked */
+		ENABLE_INTERRUPTS();					/* Let it run */
+		DISABLE_INTERRUPTS();
+	}
+	ENABLE_INTERRUPTS();
+	return job.state == LPSPI_DMA_DONE;
+}
+
+/*!
+* @brief Full duplex frame on 1 line: opcode in the first byte, answer in the following ones.
+*
+* @param[NOR_Flash_t * flash] Flash
+* @param[uint32_t word] Frame, MSB first
+* @param[uint8_t bits] 8, 16 or 32
+* @return Bits received
+*/
+static uint32_t NOR_command(NOR_Flash_t * flash, uint32_t word, uint8_t bits)
+{
+	LPSPI_DMA_Segment_t segment = { flash->tcr | LPSPI_TCR_FRAMESZ(bits - 1u), &flash->command, &flash->answer, 1u };
+
+	flash->command = word;
+	flash->answer = 0;
+	(void) NOR_run(flash, &segment, 1u);
+	return flash->answer;
+}
+
+/*!
+* @brief Set the write enable latch before a program, erase or status write.
+*
+* @param[NOR_Flash_t * flash] Flash
+*/
+static void NOR_write_enable(NOR_Flash_t * flash)
+{
+	(void) NOR_command(flash, NOR_CMD_WRITE_ENABLE, 8u);
+}
+
+/*!
+* @brief Read a whole page with the fast read (quad output when QE is set).
+*
+* @param[NOR_Flash_t * flash] Flash
+* @param[uint32_t page] Page number
+* @param[uint32_t * data] NOR_PAGE_SIZE bytes, word aligned
+* @return 1 if done
+*/
+static uint8_t NOR_read_page(NOR_Flash_t * flash, uint32_t page, uint32_t * data)
+{
+	LPSPI_DMA_Segment_t segments[3] =
+	{
+		{ flash->tcr | LPSPI_TCR_FRAMESZ(31) | LPSPI_TCR_CONT_MASK, &flash->command, NULL, 1u },	/* Opcode, address */
+		{ flash->tcr | LPSPI_TCR_FRAMESZ(7) | LPSPI_TCR_CONT_MASK | LPSPI_TCR_CONTC_MASK, NULL, NULL, 1u },	/* 8 dummy clocks */
+		{ 0, NULL, data, NOR_PAGE_SIZE / 4u },
+	};
+
+	flash->command = ((uint32_t)(flash->quad ? NOR_CMD_FAST_READ_QUAD : NOR_CMD_FAST_READ) << 24) | (page * NOR_PAGE_SIZE);
+	if (flash->quad)
+	{
+		segments[2].tcr = flash->tcr | LPSPI_TCR_WIDTH(2) | LPSPI_TCR_FRAMESZ(NOR_PAGE_SIZE * 8u - 1u) |	/* 1 frame, 4 lines */
+						  LPSPI_TCR_CONT_MASK | LPSPI_TCR_CONTC_MASK | LPSPI_TCR_TXMSK_MASK | LPSPI_TCR_BYSW_MASK;
+	}
+	else
+	{
+		segments[2].tcr = flash->tcr | LPSPI_TCR_FRAMESZ(31) |
+						  LPSPI_TCR_CONT_MASK | LPSPI_TCR_CONTC_MASK | LPSPI_TCR_BYSW_MASK;
+	}
+	return NOR_run(flash, segments, 3u);
+}
+
+/*!
+* @brief Cached copy of a page.
+*
+* @param[NOR_Flash_t * flash] Flash
+* @param[uint32_t page] Page number
+* @return Cache line, NULL if the page is not cached
+*/
+static NOR_Cache_Line_t * NOR_cache_find(NOR_Flash_t * flash, uint32_t page)
+{
+	uint8_t i;
+
+	for (i = 0; i < NOR_CACHE_LINES; i++)
+	{
+		if (flash->cache[i].valid && (flash->cache[i].page == page))
+		{
+			return &flash->cache[i];
+		}
+	}
+	return NULL;
+}
+
+/*!
+* @brief Load a page in the least recently used cache line.
+*
+* @param[NOR_Flash_t * flash] Flash
+* @param[uint32_t page] Page number
+* @return Cache line, NULL if the read failed
+*/
+static NOR_Cache_Line_t * NOR_cache_fill(NOR_Flash_t * flash, uint32_t page)
+{
+	NOR_Cache_Line_t * line = &flash->cache[0];
+	uint8_t i;
+
+	for (i = 1; (i < NOR_CACHE_LINES) && line->valid; i++)
+	{
+		if (!flash->cache[i].valid || (flash->cache[i].used < line->used))
+		{
+			line = &flash->cache[i];
+		}
+	}
+	line->valid = 0;
+	if (!NOR_read_page(flash, page, line->data))
+	{
+		return NULL;
+	}
+	line->page = page;
+	line->valid = 1;
+	return line;
+}
+
+/*!
+* @brief Identify the flash and enable its quad data lines.
+*
+* @param[NOR_Flash_t * flash] Driver state
+* @param[LPSPI_DMA_t * spi] Job queue of the LPSPI, initialized, with PCS[3:2] as IO2/IO3
+* @param[uint32_t tcr] CPOL/CPHA (SPI mode 0 or 3), PRESCALE and PCS of the flash
+* @return 1 if a flash with 3 byte addresses answered
+*/
+uint8_t NOR_init(NOR_Flash_t * flash, LPSPI_DMA_t * spi, uint32_t tcr)
+{
+	uint8_t capacity;
+	uint8_t sr2;
+
+	flash->spi    = spi;
+	flash->tcr    = tcr;
+	flash->quad   = 0;
+	flash->stamp  = 0;
+	flash->hits   = 0;
+	flash->misses = 0;
+	NOR_cache_flush(flash);
+
+	flash->id = NOR_command(flash, (uint32_t)NOR_CMD_JEDEC_ID << 24, 32u) & 0x00FFFFFFu;
+	capacity = (uint8_t) flash->id;
+	if ((capacity < 16u) || (capacity > 24u))			/* 64 KB to 16 MB */
+	{
+		return 0;
+	}
+	flash->size = 1u << capacity;
+	if (!NOR_wait(flash))
+	{
+		return 0;
+	}
+
+	sr2 = (uint8_t) NOR_command(flash, (uint32_t)NOR_CMD_READ_SR2 << 8, 16u);
+	if (!(sr2 & NOR_SR2_QE))
+	{
+		NOR_write_enable(flash);
+		(void) NOR_command(flash, ((uint32_t)NOR_CMD_WRITE_SR2 << 8) | sr2 | NOR_SR2_QE, 16u);	/* Non volatile */
+		(void) NOR_wait(flash);
+		sr2 = (uint8_t) NOR_command(flash, (uint32_t)NOR_CMD_READ_SR2 << 8, 16u);
+	}
+	flash->quad = (sr2 & NOR_SR2_QE) != 0u;
+	return 1;
+}
+
+/*!
+* @brief Read status register 1.
+*
+* @param[NOR_Flash_t * flash] Flash
+* @return NOR_SR1_BUSY, NOR_SR1_WEL...
+*/
+uint8_t NOR_status(NOR_Flash_t * flash)
+{
+	return (uint8_t) NOR_command(flash, (uint32_t)NOR_CMD_READ_SR1 << 8, 16u);
+}
+
+/*!
+* @brief Poll the status until the program, erase or status write is over.
+*
+* @param[NOR_Flash_t * flash] Flash
+* @return 1 if ready, 0 if still busy after NOR_WAIT_POLLS reads
+*/
+uint8_t NOR_wait(NOR_Flash_t * flash)
+{
+	uint32_t polls;
+
+	for (polls = 0; polls < NOR_WAIT_POLLS; polls++)
+	{
+		if (!(NOR_status(flash) & NOR_SR1_BUSY))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*!
+* @brief Read bytes through the page cache. Whole pages that are not cached are read straight
+* into a word aligned destination, so bulk reads do not evict the cache.
+*
+* @param[NOR_Flash_t * flash] Flash
+* @param[uint32_t address] Flash address
+* @param[void * data] Destination
+* @param[uint32_t length] Bytes
+* @return 1 if done, 0 if out of the flash or the LPSPI failed
+*/
+uint8_t NOR_read(NOR_Flash_t * flash, uint32_t address, void * data, uint32_t length)
+{
+	uint8_t * bytes = (uint8_t *) data;
+
+	if ((address > flash->size) || (length > flash->size - address))
+	{
+		return 0;
+	}
+	while (length != 0u)
+	{
+		uint32_t page = address / NOR_PAGE_SIZE;
+		uint32_t offset = address % NOR_PAGE_SIZE;
+		uint32_t chunk = (length < NOR_PAGE_SIZE - offset) ? length : NOR_PAGE_SIZE - offset;
+		NOR_Cache_Line_t * line = NOR_cache_find(flash, page);
+
+		if (line != NULL)
+		{
+			flash->hits++;
+		}
+		else if ((chunk == NOR_PAGE_SIZE) && (((uint32_t) bytes & 3u) == 0u))
+		{
+			flash->misses++;
+			if (!NOR_read_page(flash, page, (uint32_t *) bytes))
+			{
+				return 0;
+			}
+		}
+		else
+		{
+			flash->misses++;
+			line = NOR_cache_fill(flash, page);
+			if (line == NULL)
+			{
+				return 0;
+			}
+		}
+		if (line != NULL)
+		{
+			line->used = ++flash->stamp;
+			memcpy(bytes, (uint8_t *) line->data + offset, chunk);
+		}
+		address += chunk;
+		bytes += chunk;
+		length -= chunk;
+	}
+	return 1;
+}
+
+/*!
+* @brief Program bytes, one page program per page touched. Bits can only be cleared: the
+* range must have been erased, or the result is the AND of the old and new data.
+*
+* @param[NOR_Flash_t * flash] Flash
+* @param[uint32_t address] Flash address
+* @param[const void * data] Source
+* @param[uint32_t length] Bytes
+* @return 1 if done, 0 if out of the flash, the LPSPI failed or the flash stayed busy
+*/
+uint8_t NOR_program(NOR_Flash_t * flash, uint32_t address, const void * data, uint32_t length)
+{
+	const uint8_t * bytes = (const uint8_t *) data;
+	uint8_t * buffer = (uint8_t *) flash->buffer;
+
+	if ((address > flash->size) || (length > flash->size - address))
+	{
+		return 0;
+	}
+	while (length != 0u)
+	{
+		uint32_t offset = address % NOR_PAGE_SIZE;
+		uint32_t chunk = (length < NOR_PAGE_SIZE - offset) ? length : NOR_PAGE_SIZE - offset;
+		uint32_t first = offset & ~3u;								/* Whole words, padded with 0xFF */
+		uint32_t end = (offset + chunk + 3u) & ~3u;
+		NOR_Cache_Line_t * line = NOR_cache_find(flash, address / NOR_PAGE_SIZE);
+		LPSPI_DMA_Segment_t segments[2] =
+		{
+			{ flash->tcr | LPSPI_TCR_FRAMESZ(31) | LPSPI_TCR_CONT_MASK, &flash->command, NULL, 1u },	/* Opcode, address */
+			{ flash->tcr | LPSPI_TCR_WIDTH(flash->quad ? 2u : 0u) | LPSPI_TCR_FRAMESZ(31) |
+			  LPSPI_TCR_CONT_MASK | LPSPI_TCR_CONTC_MASK | LPSPI_TCR_BYSW_MASK, &buffer[first], NULL, (uint16_t)((end - first) / 4u) },
+		};
+		uint32_t i;
+
+		memset(&buffer[first], 0xFF, end - first);					/* 0xFF leaves a byte unchanged */
+		memcpy(&buffer[offset], bytes, chunk);
+		NOR_write_enable(flash);
+		flash->command = ((uint32_t)(flash->quad ? NOR_CMD_PROGRAM_QUAD : NOR_CMD_PROGRAM) << 24) | (address - offset + first);
+		if (!NOR_run(flash, segments, 2u) || !NOR_wait(flash))
+		{
+			if (line != NULL)
+			{
+				line->valid = 0;
+			}
+			return 0;
+		}
+		if (line != NULL)
+		{
+			for (i = 0; i < chunk; i++)
+			{
+				((uint8_t *) line->data)[offset + i] &= bytes[i];	/* Same result as the flash */
+			}
+		}
+		address += chunk;
+		bytes += chunk;
+		length -= chunk;
+	}
+	return 1;
+}
+
+/*!
+* @brief Erase the 4 KB sector holding an address (all bytes to 0xFF).
+*
+* @param[NOR_Flash_t * flash] Flash
+* @param[uint32_t address] Any address in the sector
+* @return 1 if done, 0 if out of the flash or the flash stayed busy
+*/
+uint8_t NOR_erase_sector(NOR_Flash_t * flash, uint32_t address)
+{
+	uint32_t sector = address & ~(NOR_SECTOR_SIZE - 1u);
+	uint8_t i;
+
+	if (address >= flash->size)
+	{
+		return 0;
+	}
+	for (i = 0; i < NOR_CACHE_LINES; i++)
+	{
+		if ((flash->cache[i].page * NOR_PAGE_SIZE & ~(NOR_SECTOR_SIZE - 1u)) == sector)
+		{
+			flash->cache[i].valid = 0;
+		}
+	}
+	NOR_write_enable(flash);
+	(void) NOR_command(flash, ((uint32_t)NOR_CMD_ERASE_SECTOR << 24) | sector, 32u);
+	return NOR_wait(flash);
+}
+
+/*!
+* @brief Drop every cached page, e.g. after the flash was written by another master.
+*
+* @param[NOR_Flash_t * flash] Flash
+*/
+void NOR_cache_flush(NOR_Flash_t * flash)
+{
+	uint8_t i;
+
+	for (i = 0; i < NOR_CACHE_LINES; i++)
+	{
+		flash->cache[i].valid = 0;
+		flash->cache[i].used = 0;
+	}
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef NOR_FLASH_H_
+#define NOR_FLASH_H_
+
+#include "LPSPI_DMA.h"
+
+#ifndef NOR_CACHE_LINES
+#define NOR_CACHE_LINES			(4u)	/* Pages kept in SRAM */
+#endif
+
+#define NOR_PAGE_SIZE			(256u)	/* Program and cache granule */
+#define NOR_SECTOR_SIZE			(0x1000u)	/* Erase granule */
+
+/* Status register 1 */
+#define NOR_SR1_BUSY			(0x01u)	/* Program, erase or status write in progress */
+#define NOR_SR1_WEL				(0x02u)	/* Write enable latch */
+
+/* Copy of a flash page in SRAM */
+typedef struct
+{
+	uint32_t data[NOR_PAGE_SIZE / 4u];
+	uint32_t page;					/* Flash address / NOR_PAGE_SIZE */
+	uint32_t used;					/* Access stamp, the smallest is replaced */
+	uint8_t valid;
+}NOR_Cache_Line_t;
+
+/* Serial NOR flash (W25Q style: 3 byte addresses, QE in status register 2) on a chip select of
+ * an LPSPI master whose PCS[3:2] pins carry IO2/IO3 (CFGR1[PCSCFG]). Instructions and addresses
+ * use 1 line, data uses 4 lines once QE is set: Fast Read Quad Output (6Bh) and Quad Page
+ * Program (32h). Without QE the driver falls back to Fast Read (0Bh) and Page Program (02h).
+ * Reads go through an LRU cache of NOR_CACHE_LINES pages; programs update the cached copies
+ * and erases drop them. The functions block until the flash is ready again. */
+typedef struct
+{
+	LPSPI_DMA_t * spi;				/* Job queue of the LPSPI, shared with other devices */
+	uint32_t tcr;					/* CPOL/CPHA, PRESCALE and PCS of the flash */
+	uint32_t size;					/* Bytes, from the JEDEC ID */
+	uint32_t id;					/* Manufacturer, memory type, capacity */
+	uint8_t quad;					/* 1: QE set, data on 4 lines */
+	uint32_t stamp;
+	uint32_t hits;					/* Pages read from the cache */
+	uint32_t misses;				/* Pages read from the flash */
+	NOR_Cache_Line_t cache[NOR_CACHE_LINES];
+	uint32_t command;				/* Opcode and address frame, read by the DMA */
+	uint32_t answer;				/* Frame received by the DMA */
+	uint32_t buffer[NOR_PAGE_SIZE / 4u];	/* Page program data, word aligned for the DMA */
+}NOR_Flash_t;
+
+uint8_t 	NOR_init			(NOR_Flash_t * flash, LPSPI_DMA_t * spi, uint32_t tcr);
+uint8_t 	NOR_status			(NOR_Flash_t * flash);
+uint8_t 	NOR_wait			(NOR_Flash_t * flash);
+uint8_t 	NOR_read			(NOR_Flash_t * flash, uint32_t address, void * data, uint32_t length);
+uint8_t 	NOR_program			(NOR_Flash_t * flash, uint32_t address, const void * data, uint32_t length);
+uint8_t 	NOR_erase_sector	(NOR_Flash_t * flash, uint32_t address);
+void 		NOR_cache_flush		(NOR_Flash_t * flash);
+
+#endif /* NOR_FLASH_H_ */
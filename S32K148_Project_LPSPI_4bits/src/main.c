@@ -41,47 +41,27 @@
  * with a QSPI interface (like a memory or a display device) and the MCU doesnt have QSPI module
  * or it is already used with another interface.
  *
- * In this example 4 data lines are used by the LPSPI at 1 MHz to show this capability.
- * The transfers are made via DMA.
+ * In this example a serial NOR flash on PCS1 is used as a data log at 1 MHz (SOUT = IO0,
+ * SIN = IO1, PCS2 = IO2, PCS3 = IO3). Instructions and addresses go on 1 line, the data on
+ * the 4 lines, and every transfer is an LPSPI_DMA job. Records of 16 bytes are appended,
+ * erasing each 4 KB sector when the log enters it, and read back through the page cache.
  * */
 
+#include <string.h>
 #include "device_registers.h" 							/* include peripheral declarations S32K148 */
 #include "clocks_and_modes.h"
-#include "dma.h"
+#include "LPSPI_DMA.h"
+#include "NOR_Flash.h"
 #include "LPSPI.h"
 
 
-#define SIZE  4
+LPSPI_DMA_t SPI1;
+NOR_Flash_t flash;
 
-/* Saving memory for 2 TCD structure (1 for LPSPI command transfer, 1 for data transfer) */
-TCD_t TCDm[2] __attribute__ ((aligned (32)));
-
-/* Dummy data for Blanking time */
-#define Cmd        0x11101011
-#define Addrs      0x07FF0000
-#define DummyD0D1  0x0000AAAA
-#define D2D3D4D5   0x5555AAAA
-
-/* Data */
-uint32_t Tx_Dn[SIZE] = { Cmd, Addrs, DummyD0D1, D2D3D4D5 };
-
-
-/* Word of commands for SPI TCR register */
-uint32_t lpspi_cmd[2] =
-{
-	  LPSPI_TCR_CPHA_MASK
-	| LPSPI_TCR_PRESCALE(2)
-	| LPSPI_TCR_PCS(1)
-	| LPSPI_TCR_WIDTH(0x2)
-	| LPSPI_TCR_FRAMESZ(31)
-	| LPSPI_TCR_CONT_MASK,
-
-	  LPSPI_TCR_CPHA_MASK
-	| LPSPI_TCR_PRESCALE(2)
-	| LPSPI_TCR_PCS(1)
-	| LPSPI_TCR_WIDTH(0x2)
-	| LPSPI_TCR_FRAMESZ(31),
- };
+uint32_t record[4];										/* Sequence, address, 2 data words */
+uint32_t readback[4];
+uint32_t log_address = 0;
+uint32_t log_errors = 0;
 
 
 /*!
@@ -146,29 +126,30 @@ int main (void)
 	LPSPI1_init_master();    				/* Initialize LPSPI 1 as master */
 	LPSPI1_4bitMode_enable(); 				/* Enabled 4 bit mode and DMA requests */
 
-	/* First we use the command with Continuous mode enable, length 32 and width 2 */
-	LPSPI1 -> TCR = lpspi_cmd[0];
-
-
-	/* eDMA Initialization */
-	DMA_init();              				/* Initialize DMA controller */
-
-	/* Save TCD for data transfer in index 0. Send Tx_Dn */
-	DMA_TCDm_config ((uint32_t *)&Tx_Dn[0], (uint32_t *)&LPSPI1 -> TDR, SIZE, &(TCDm[0]));
-
-	/* Scatter Gather enabled, when finished, it loads TCD index 1 */
-	TCDm[0].CSR      &=~ (DMA_TCD_CSR_DREQ(1));
-	TCDm[0].CSR      |=  DMA_TCD_CSR_ESG(1);
-	TCDm[0].DLASTSGA =   DMA_TCD_DLASTSGA_DLASTSGA (&TCDm[1]);
-
-	/* Save TCD for command change. CONT = 0 and the continuous transfer command to TCR is finished */
-	DMA_TCDm_config ((uint32_t *)&lpspi_cmd[1], (uint32_t *)&LPSPI1 -> TCR, 1, &(TCDm[1]));
-
-	/* Push TCD with index 0 to DMA channel 0 */
-	DMA_TCD_Push(0, &TCDm[0]);
+	/* TX FIFO on DMA Ch0, RX FIFO on DMA Ch1 */
+	LPSPI_DMA_init(&SPI1, LPSPI1, 0, 1);
 
-	/* Enable DMA Ch0 request */
-	DMA -> SERQ = DMA_SERQ_SERQ(0);
+	/* SPI mode 0 (CPOL = 0, CPHA = 0), 1 MHz, flash on PCS1 */
+	if (NOR_init(&flash, &SPI1, LPSPI_TCR_PRESCALE(2) | LPSPI_TCR_PCS(1)))
+	{
+		for (record[0] = 0; ; record[0]++)
+		{
+			if ((log_address % NOR_SECTOR_SIZE) == 0u)
+			{
+				(void) NOR_erase_sector(&flash, log_address);	/* Log enters a new sector */
+			}
+			record[1] = log_address;
+			record[2] = 0x5555AAAAu ^ record[0];
+			record[3] = ~record[0];
+			if (!NOR_program(&flash, log_address, record, sizeof(record)) ||
+				!NOR_read(&flash, log_address, readback, sizeof(readback)) ||
+				(memcmp(record, readback, sizeof(record)) != 0))
+			{
+				log_errors++;
+			}
+			log_address = (log_address + sizeof(record)) % flash.size;	/* Circular log */
+		}
+	}
 
 
 	/*!
@@ -178,3 +159,18 @@ int main (void)
 	{
 	}
 }
+
+void DMA0_IRQHandler (void)
+{
+	LPSPI_DMA_TxIRQHandler(&SPI1);			/* Job loaded in the TX FIFO */
+}
+
+void DMA1_IRQHandler (void)
+{
+	LPSPI_DMA_RxIRQHandler(&SPI1);			/* Job received */
+}
+
+void LPSPI1_IRQHandler (void)
+{
+	LPSPI_DMA_IRQHandler(&SPI1);			/* Job sent, PCS1 negated */
+}
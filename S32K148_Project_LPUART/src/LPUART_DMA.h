@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LPUART_DMA_H_
+#define LPUART_DMA_H_
+
+#include <stddef.h>
+#include "device_registers.h"
+
+/* Non-blocking LPUART port: transmit and receive go through single-producer/single-consumer
+ * ring buffers that the eDMA drains (TDMAE) and fills (RDMAE). Ring sizes are powers of 2
+ * up to 16384 bytes. The application is the producer of the TX ring and the consumer of the
+ * RX ring; DMA interrupts move the other end. */
+typedef struct
+{
+	LPUART_Type * base;				/* LPUART0, LPUART1 or LPUART2 */
+	uint8_t tx_ch;					/* DMA channel draining tx_buf */
+	uint8_t rx_ch;					/* DMA channel filling rx_buf */
+	uint8_t * tx_buf;
+	uint16_t tx_mask;				/* Ring size - 1 */
+	volatile uint16_t tx_head;		/* Next byte written by the application */
+	volatile uint16_t tx_tail;		/* Next byte sent by the DMA */
+	volatile uint16_t tx_len;		/* Bytes of the DMA transfer in progress, 0 if idle */
+	uint8_t * rx_buf;
+	uint16_t rx_mask;
+	uint32_t rx_read;				/* Bytes read by the application since init */
+	volatile uint32_t rx_wraps;		/* RX DMA major loops since init */
+	volatile uint32_t rx_idle;		/* Idle lines after received data (end of frames) */
+	volatile uint32_t rx_overruns;	/* Bytes lost: ring full or LPUART overrun */
+	volatile uint32_t tx_dropped;	/* Bytes not accepted by LPUART_DMA_puts */
+}LPUART_DMA_t;
+
+void 		LPUART_DMA_init			(LPUART_DMA_t * port, LPUART_Type * base, uint8_t tx_ch, uint8_t rx_ch,
+									 uint8_t * tx_buf, uint16_t tx_size, uint8_t * rx_buf, uint16_t rx_size);
+uint16_t 	LPUART_DMA_write		(LPUART_DMA_t * port, const void * data, uint16_t length);
+uint16_t 	LPUART_DMA_puts			(LPUART_DMA_t * port, const char * string);
+uint16_t 	LPUART_DMA_put_uint		(LPUART_DMA_t * port, uint32_t value);
+uint16_t 	LPUART_DMA_read			(LPUART_DMA_t * port, void * data, uint16_t length);
+int16_t 	LPUART_DMA_getc			(LPUART_DMA_t * port);
+uint8_t 	LPUART_DMA_tx_done		(LPUART_DMA_t * port);
+void 		LPUART_DMA_IRQHandler	(LPUART_DMA_t * port);
+void 		LPUART_DMA_TxIRQHandler	(LPUART_DMA_t * port);
+void 		LPUART_DMA_RxIRQHandler	(LPUART_DMA_t * port);
+
+#endif /* LPUART_DMA_H_ */
@@ -33,17 +33,26 @@
 /*!
  * Description:
  * ==========================================================================================
- * This example performs a simple UART transfer to a COM port on a PC. FIFOs, interrupts and
- * DMA are not implemented. The Open SDA interface can be used on the evaluation board, where 
- * the UART signals are transferred to a USB interface, which can connect to a PC which has a 
- * terminal emulation program such as PUTTY, TeraTerm or other software.
+ * This example performs a simple UART transfer to a COM port on a PC. The Open SDA interface can
+ * be used on the evaluation board, where the UART signals are transferred to a USB interface,
+ * which can connect to a PC which has a terminal emulation program such as PUTTY, TeraTerm or
+ * other software.
+ * Transmission and reception do not block the core: LPUART_DMA queues the text in a ring buffer
+ * drained by DMA channel 0 and DMA channel 1 stores every received char in another ring. The
+ * received chars are echoed and a new prompt is sent when the line goes idle.
  * */
 
 #include "device_registers.h" /* include peripheral declarations S32K144 */
 #include "clocks_and_modes.h"
 #include "LPUART.h"
+#include "LPUART_DMA.h"
 
-char data=0;
+#define UART1_TX_SIZE	256			/* Power of 2 */
+#define UART1_RX_SIZE	64			/* Power of 2 */
+
+uint8_t UART1_tx[UART1_TX_SIZE];	/* Transmit ring of LPUART1 */
+uint8_t UART1_rx[UART1_RX_SIZE];	/* Receive ring of LPUART1 */
+LPUART_DMA_t UART1;
 void PORT_init (void)
 {
 	/*!
@@ -80,18 +89,40 @@ int main(void)
   PORT_init();           /* Configure ports */
 
   LPUART1_init();        /* Initialize LPUART @ 9600*/
-  LPUART1_transmit_string("Running LPUART example\n\r");     /* Transmit char string */
-  LPUART1_transmit_string("Input character to echo...\n\r"); /* Transmit char string */
+  LPUART_DMA_init(&UART1, LPUART1, 0, 1, UART1_tx, UART1_TX_SIZE, UART1_rx, UART1_RX_SIZE);	/* TX on DMA CH0, RX on DMA CH1 */
+  LPUART_DMA_puts(&UART1, "Running LPUART example\n\r");     /* Queue char string */
+  LPUART_DMA_puts(&UART1, "Input character to echo...\n\r>"); /* Queue char string and prompt */
 
 	/*!
 	 * Infinite for:
 	 * ========================
 	 */
+	  uint32_t idle = 0;
 	  for(;;)
 	  {
-		  LPUART1_transmit_char('>');  		/* Transmit prompt character*/
-		  LPUART1_receive_and_echo_char();	/* Wait for input char, receive & echo it*/
+		  char echo[16];
+		  uint16_t length = LPUART_DMA_read(&UART1, echo, sizeof(echo));	/* Chars received so far */
+
+		  LPUART_DMA_write(&UART1, echo, length);	/* Echo them */
+		  if ((length == 0) && (idle != UART1.rx_idle))
+		  {
+			  idle = UART1.rx_idle;					/* Line idle: end of the input */
+			  LPUART_DMA_puts(&UART1, "\n\r>");	/* New line and prompt character */
+		  }
 	  }
 }
 
+void DMA0_IRQHandler(void)
+{
+	LPUART_DMA_TxIRQHandler(&UART1);	/* Block sent, start the next one */
+}
 
+void DMA1_IRQHandler(void)
+{
+	LPUART_DMA_RxIRQHandler(&UART1);	/* Receive ring wrapped */
+}
+
+void LPUART1_RxTx_IRQHandler(void)
+{
+	LPUART_DMA_IRQHandler(&UART1);		/* Idle line / overrun */
+}
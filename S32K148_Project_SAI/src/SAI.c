@@ -32,11 +32,15 @@
 
 #include "SAI.h"
 #include "device_registers.h"
+#include "SAI_Rate.h"
 
 #define BIT_SIZE            (8)   	/* Bit size per word */
 #define CHANNEL_MASK        (0xF) 	/* All channels */
 #define WATERMARK           (6)   	/* FIFO size is 8, then watermark is set to FIFO_SIZE/2 */
 
+SAI_RATE(SAI_STEREO, 40000000, 0, 625000, 2, BIT_SIZE);	/* Bus clock, 2 words of 8 bits: 10 MHz BCLK */
+SAI_RATE_ASSERT(SAI_STEREO);
+
 void SAI_init (void)
 {
     uint8_t SAI_index;
@@ -49,17 +53,17 @@ void SAI_init (void)
     SAI0->TCR4 = SAI_TCR4_FCONT_MASK 			/*! On FIFO error, the SAI will continue from
     											 *  the same word that caused the FIFO error	*/
     		    |SAI_TCR4_MF(1U) 				/* MSB is transmitted first. 					*/
-				|SAI_TCR4_SYWD(BIT_SIZE - 1)	/* Length of the frame sync in number of bit clocks.*/
+				|SAI_TCR4_SYWD(SAI_STEREO_SYWD)	/* Length of the frame sync in number of bit clocks.*/
                 |SAI_TCR4_FSE(0U) 				/* Frame sync asserts with the first bit of the frame. */
 				|SAI_TCR4_FSP(0U) 				/* Frame sync is active high.*/
-				|SAI_TCR4_FRSZ(1U);				/* One word in each frame */
+				|SAI_TCR4_FRSZ(SAI_STEREO_FRSZ);	/* Two words in each frame */
 
     /* Set as master */
     SAI0->TCR2 |= SAI_TCR2_BCD_MASK;
     SAI0->TCR4 |= SAI_TCR4_FSD_MASK;
 
     SAI0->TCR2 &= ~SAI_TCR2_MSEL_MASK;	/* Bit clock source setting: 		*/
-    SAI0->TCR2 |= SAI_TCR2_MSEL(0); 	/* Select bus clock as SAI clock 	*/
+    SAI0->TCR2 |= SAI_TCR2_MSEL(SAI_STEREO_MSEL);	/* Bus clock, from the rate plan */
 
     /* Asyncrhonous mode */
     SAI0->TCR2 &= ~SAI_TCR2_SYNC_MASK;
@@ -68,7 +72,7 @@ void SAI_init (void)
     if (SAI0->TCR2 & SAI_TCR2_BCD_MASK)
     {
     	SAI0->TCR2 &= ~SAI_TCR2_DIV_MASK;
-    	SAI0->TCR2 |= SAI_TCR2_DIV(1);
+    	SAI0->TCR2 |= SAI_TCR2_DIV(SAI_STEREO_DIV);
     }
 
     /* Left justified protocol */
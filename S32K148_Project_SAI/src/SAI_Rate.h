@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SAI_RATE_H_
+#define SAI_RATE_H_
+
+#include "device_registers.h"
+
+/*!
+ * Description:
+ * ===================================================
+ * Sample rate planner for the SAI transmitter/receiver clock. From the clocks available to the
+ * SAI, the frame rate wanted and the frame format it picks the master clock, the bit clock
+ * divider and the frame fields, evaluated by the compiler:
+ *
+ * 	SAI_RATE(TDM_RATE, 40000000, 12288000, 8000, 8, 32);
+ * 	SAI_RATE_ASSERT(TDM_RATE);
+ *
+ * 	SAI0->TCR2 = ... | SAI_RATE_TCR2(TDM_RATE);
+ * 	SAI0->TCR4 = ... | SAI_RATE_TCR4(TDM_RATE);
+ * 	SAI0->TCR5 = SAI_RATE_TCR5(TDM_RATE);
+ *
+ * SAI_RATE declares enum constants <name>_MSEL, _DIV, _FRSZ, _SYWD, _WNW (register field values),
+ * _CLK_HZ (master clock selected), _BCLK_HZ and _RATE_MHZ (bit clock and frame rate reached, the
+ * latter in mHz), _RATE_PPM (frame rate error, positive when fast) and _ERRORS.
+ *
+ * 	BCLK       = master clock / ((DIV + 1) * 2)
+ * 	frame rate = BCLK / (slots * bits)
+ *
+ * 	- For each master clock, DIV + 1 is master clock / (2 * slots * bits * rate) rounded to
+ * 	  the nearest divider in range, which gives the smallest error that clock can reach.
+ * 	- The bus clock (MSEL 0) is kept unless the SAI_MCLK input (MSEL 1, mclk_hz, 0 when not
+ * 	  fitted) gets strictly closer to the rate.
+ * 	- Two slot frames (I2S, left justified) get a frame sync one slot wide, TDM frames a frame
+ * 	  sync of one bit clock.
+ *
+ * A rounded divider makes the frame rate drift against the far end of the link, which then has
+ * to drop, repeat or resample audio: _RATE_PPM shows by how much, SAI_RATE_ASSERT stops the build
+ * beyond SAI_RATE_TOL_PPM.
+ */
+
+/* Register limits */
+#define SAI_RATE_DIV_MAX		(256)	/* DIV + 1 */
+#define SAI_RATE_SLOTS_MAX		(32)	/* FRSZ + 1 */
+#define SAI_RATE_BITS_MIN		(8)		/* WNW + 1 */
+#define SAI_RATE_BITS_MAX		(32)
+
+/* MSEL encoding */
+#define SAI_RATE_MSEL_BUS		(0)		/* Bus clock */
+#define SAI_RATE_MSEL_MCLK		(1)		/* Master clock option 1: SAI_MCLK input */
+
+/* Tolerance behind SAI_RATE_ERR_RATE, may be set before the include */
+#ifndef SAI_RATE_TOL_PPM
+#define SAI_RATE_TOL_PPM		(0)		/* Frame rate: exact */
+#endif
+
+/* <name>_ERRORS bits */
+#define SAI_RATE_ERR_RATE		(0x01)	/* Frame rate off by more than SAI_RATE_TOL_PPM */
+#define SAI_RATE_ERR_RANGE		(0x02)	/* Frame format or divider does not fit the register fields */
+
+/* Planner steps */
+#define SAI_RATE_MIN_(a, b)		(((a) < (b)) ? (a) : (b))
+#define SAI_RATE_MAX_(a, b)		(((a) > (b)) ? (a) : (b))
+#define SAI_RATE_ABS_(a)		(((a) < 0) ? -(a) : (a))
+
+/* Bit clock periods per frame, times 2 for the two edges of each bit clock */
+#define SAI_RATE_EDGES_(rate, slots, bits)	((int64_t)(rate) * (slots) * (bits) * 2)
+
+/* DIV + 1 closest to the rate, within the field */
+#define SAI_RATE_DIVIDER_(clk, rate, slots, bits) \
+	SAI_RATE_MAX_(SAI_RATE_MIN_(((int64_t)(clk) + SAI_RATE_EDGES_(rate, slots, bits) / 2) / \
+		SAI_RATE_EDGES_(rate, slots, bits), SAI_RATE_DIV_MAX), 1)
+
+/* Frame rate error in ppm with divider d, INT32_MAX without a clock */
+#define SAI_RATE_PPM_(clk, rate, slots, bits, d) \
+	(((clk) == 0) ? INT32_MAX : \
+	 (int32_t)(((int64_t)(clk) - SAI_RATE_EDGES_(rate, slots, bits) * (d)) * 1000000LL / \
+		(SAI_RATE_EDGES_(rate, slots, bits) * (d))))
+
+/* Frame sync width in bit clocks */
+#define SAI_RATE_SYNC_(slots, bits)		(((slots) == 2) ? (bits) : 1)
+
+/* Out of range: no clock, a field overflow, or a clock too slow for DIV = 0 or too fast for
+ * the largest divider */
+#define SAI_RATE_ERRORS_(ppm, clk, rate, slots, bits) \
+	((((ppm) > SAI_RATE_TOL_PPM) || ((ppm) < -SAI_RATE_TOL_PPM) ? SAI_RATE_ERR_RATE : 0) | \
+	 (((clk) == 0) || ((rate) <= 0) || ((slots) < 1) || ((slots) > SAI_RATE_SLOTS_MAX) || \
+	  ((bits) < SAI_RATE_BITS_MIN) || ((bits) > SAI_RATE_BITS_MAX) || \
+	  ((int64_t)(clk) * 2 < SAI_RATE_EDGES_(rate, slots, bits)) || \
+	  ((int64_t)(clk) * 2 > SAI_RATE_EDGES_(rate, slots, bits) * (2 * SAI_RATE_DIV_MAX + 1)) ? SAI_RATE_ERR_RANGE : 0))
+
+/*!
+* @brief Plan a frame rate into enum constants <name>_*.
+*
+* @param[name] Prefix of the constants
+* @param[bus_hz] Bus clock in Hz (MSEL 0)
+* @param[mclk_hz] Clock on the SAI_MCLK input in Hz (MSEL 1), 0 if none
+* @param[rate_hz] Frame (sample) rate in Hz
+* @param[slots] Words per frame (1 - 32)
+* @param[bits] Bits per word (8 - 32)
+*/
+#define SAI_RATE(name, bus_hz, mclk_hz, rate_hz, slots, bits) \
+	enum \
+	{ \
+		name##_BUS_DIV_   = SAI_RATE_DIVIDER_(bus_hz, rate_hz, slots, bits), \
+		name##_MCLK_DIV_  = SAI_RATE_DIVIDER_(mclk_hz, rate_hz, slots, bits), \
+		name##_BUS_PPM_   = SAI_RATE_PPM_(bus_hz, rate_hz, slots, bits, name##_BUS_DIV_), \
+		name##_MCLK_PPM_  = SAI_RATE_PPM_(mclk_hz, rate_hz, slots, bits, name##_MCLK_DIV_), \
+		name##_MSEL       = (SAI_RATE_ABS_((int64_t)name##_MCLK_PPM_) < SAI_RATE_ABS_((int64_t)name##_BUS_PPM_)) \
+							? SAI_RATE_MSEL_MCLK : SAI_RATE_MSEL_BUS, \
+		name##_CLK_HZ     = (name##_MSEL == SAI_RATE_MSEL_MCLK) ? (mclk_hz) : (bus_hz), \
+		name##_DIVIDER_   = (name##_MSEL == SAI_RATE_MSEL_MCLK) ? name##_MCLK_DIV_ : name##_BUS_DIV_, \
+		name##_DIV        = name##_DIVIDER_ - 1, \
+		name##_FRSZ       = (slots) - 1, \
+		name##_SYWD       = SAI_RATE_SYNC_(slots, bits) - 1, \
+		name##_WNW        = (bits) - 1, \
+		name##_BCLK_HZ    = name##_CLK_HZ / (2 * name##_DIVIDER_), \
+		name##_RATE_MHZ   = (int32_t)((int64_t)name##_CLK_HZ * 1000 / (2LL * name##_DIVIDER_ * (slots) * (bits))), \
+		name##_RATE_PPM   = (name##_MSEL == SAI_RATE_MSEL_MCLK) ? name##_MCLK_PPM_ : name##_BUS_PPM_, \
+		name##_ERRORS     = SAI_RATE_ERRORS_(name##_RATE_PPM, name##_CLK_HZ, rate_hz, slots, bits) \
+	}
+
+/* Build stops when the plan misses the request */
+#define SAI_RATE_ASSERT(name) \
+	_Static_assert(name##_ERRORS == 0, #name ": SAI frame rate out of tolerance, see SAI_Rate.h")
+
+/* Register fields of a plan, to be ORed with the other bits of the register */
+#define SAI_RATE_TCR2(name)		(SAI_TCR2_MSEL(name##_MSEL) | SAI_TCR2_DIV(name##_DIV))
+#define SAI_RATE_TCR4(name)		(SAI_TCR4_FRSZ(name##_FRSZ) | SAI_TCR4_SYWD(name##_SYWD))
+#define SAI_RATE_TCR5(name)		(SAI_TCR5_WNW(name##_WNW) | SAI_TCR5_W0W(name##_WNW) | SAI_TCR5_FBT(name##_WNW))
+
+#endif /* SAI_RATE_H_ */
@@ -42,70 +42,278 @@ uint32_t buffers[2][8] = {
 
 
 /*!
-* @brief DMA Initialization. Select SAI0 Tx channel source.
+* @brief Iteration count field of CITER/BITER, which is narrower with minor loop linking.
 */
-void DMA_init (void)
+static inline uint16_t DMA_iterations(uint16_t iter)
 {
-	/* Turn DMAMUX clock on */
-	PCC -> PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;
+	return (iter & DMA_TCD_CITER_ELINKYES_ELINK_MASK) ? (iter & DMA_TCD_CITER_ELINKYES_CITER_LE_MASK)
+													  : (iter & DMA_TCD_CITER_ELINKNO_CITER_MASK);
+}
 
-	/* Enable DMA channel */
-	DMAMUX -> CHCFG[0] = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(EDMA_REQ_SAI0_TX);
+/*!
+ * TCD builder
+ * ===================================================
+ * Subset of the TCD builder of the DMA examples: DMA_TCD_Transfer fills a TCD_t image in RAM,
+ * DMA_TCD_Strided derives SOFF/DOFF, MLOFF and SLAST/DLASTSGA from a stride description,
+ * DMA_TCD_Validate reports the configuration errors the eDMA would raise in ES and
+ * DMA_TCD_Push loads the image into a channel.
+ */
+
+/*!
+* @brief Basic transfer: every other TCD field is cleared.
+*
+* @param[TCD_t * TCDm] TCD image to fill
+* @param[const volatile void * source] Source address
+* @param[int16_t SOFF] Bytes added to the source address after each transfer
+* @param[DMA_Size_t ssize] Source transfer size
+* @param[volatile void * dest] Destination address
+* @param[int16_t DOFF] Bytes added to the destination address after each transfer
+* @param[DMA_Size_t dsize] Destination transfer size
+* @param[uint32_t nbytes] Bytes per minor loop, multiple of both transfer sizes
+* @param[uint16_t iterations] Minor loops per major loop (1 - 32767)
+*/
+void DMA_TCD_Transfer(TCD_t * TCDm, const volatile void * source, int16_t SOFF, DMA_Size_t ssize,
+					  volatile void * dest, int16_t DOFF, DMA_Size_t dsize, uint32_t nbytes, uint16_t iterations)
+{
+	int32_t source_transfers = (int32_t)(nbytes / DMA_SIZE_BYTES(ssize)) * iterations;	/* Transfers per major loop */
+	int32_t dest_transfers   = (int32_t)(nbytes / DMA_SIZE_BYTES(dsize)) * iterations;
+
+	TCDm->SADDR         = DMA_TCD_SADDR_SADDR((uint32_t) source);	/* Source Address */
+	TCDm->SOFF          = DMA_TCD_SOFF_SOFF(SOFF);					/* Src. addr offset after transfers */
+	TCDm->ATTR          = DMA_TCD_ATTR_SMOD(0)      |				/* Src. modulo feature not used */
+						  DMA_TCD_ATTR_SSIZE(ssize) |				/* Src. read 2**ssize bytes per transfer */
+						  DMA_TCD_ATTR_DMOD(0)      |				/* Dest. modulo feature not used */
+						  DMA_TCD_ATTR_DSIZE(dsize);				/* Dest. write 2**dsize bytes per transfer */
+
+	TCDm->NBYTES_MLNO   = DMA_TCD_NBYTES_MLNO_NBYTES(nbytes);		/* Bytes per minor loop */
+	TCDm->SLAST         = DMA_TCD_SLAST_SLAST(-(SOFF * source_transfers));	/* Src addr back to start after major loop */
 
+	TCDm->DADDR         = DMA_TCD_DADDR_DADDR((uint32_t) dest);		/* Destination Address */
+	TCDm->DOFF          = DMA_TCD_DOFF_DOFF(DOFF);					/* Dest. addr offset after transfers */
+	TCDm->CITER_ELINKNO = DMA_TCD_CITER_ELINKNO_CITER(iterations) |	/* Minor loop iterations */
+						  DMA_TCD_CITER_ELINKNO_ELINK(0);			/* No minor loop chan link */
+
+	TCDm->DLASTSGA      = DMA_TCD_DLASTSGA_DLASTSGA(-(DOFF * dest_transfers));	/* Dest addr back to start after major loop */
+	TCDm->CSR           = DMA_TCD_CSR_START(0)       |				/* Clear START status flag */
+						  DMA_TCD_CSR_INTMAJOR(0)    |				/* No IRQ after major loop */
+						  DMA_TCD_CSR_INTHALF(0)     |				/* No IRQ after 1/2 major loop */
+						  DMA_TCD_CSR_DREQ(1)        |				/* Disable chan after major loop */
+						  DMA_TCD_CSR_ESG(0)         |				/* Disable Scatter Gather */
+						  DMA_TCD_CSR_MAJORELINK(0)  |				/* No major loop chan link */
+						  DMA_TCD_CSR_MAJORLINKCH(0) |				/* Chan # if major loop ch link */
+						  DMA_TCD_CSR_BWC(0);						/* No eDMA stalls after R/W */
+	TCDm->BITER_ELINKNO = DMA_TCD_BITER_ELINKNO_BITER(iterations) |	/* Initial iteration count */
+						  DMA_TCD_BITER_ELINKNO_ELINK(0);			/* No minor loop chan link */
 }
 
+/*!
+* @brief Replace the address adjustments applied after the major loop.
+*
+* @param[TCD_t * TCDm] TCD image
+* @param[int32_t SLAST] Bytes added to the source address
+* @param[int32_t DLAST] Bytes added to the destination address (not with scatter/gather)
+*/
+void DMA_TCD_Last(TCD_t * TCDm, int32_t SLAST, int32_t DLAST)
+{
+	TCDm->SLAST    = DMA_TCD_SLAST_SLAST(SLAST);
+	TCDm->DLASTSGA = DMA_TCD_DLASTSGA_DLASTSGA(DLAST);
+}
 
 /*!
- * @brief Configure the TCD of the DMA to allow sending each character (byte) of the
- *        source string to one single memory location defined as the destination address.
- */
-void DMA_TCD_init(void)
+* @brief Add MLOFF to the source and/or destination address after each minor loop.
+* Requires DMA->CR[EMLM] = 1 and limits nbytes to 1023.
+*
+* @param[TCD_t * TCDm] TCD image
+* @param[int32_t MLOFF] Signed minor loop offset (20 bits)
+* @param[uint8_t source] 1: apply to the source address
+* @param[uint8_t dest] 1: apply to the destination address
+*/
+void DMA_TCD_MinorOffset(TCD_t * TCDm, int32_t MLOFF, uint8_t source, uint8_t dest)
 {
-	/* TCD0: Transfers string to a single memory location */
+	TCDm->NBYTES_MLOFFYES = DMA_TCD_NBYTES_MLOFFYES_SMLOE(source) |	/* Src. minor loop offset enable */
+							DMA_TCD_NBYTES_MLOFFYES_DMLOE(dest)   |	/* Dest. minor loop offset enable */
+							DMA_TCD_NBYTES_MLOFFYES_MLOFF(MLOFF)  |	/* Offset after each minor loop */
+							DMA_TCD_NBYTES_MLOFFYES_NBYTES(TCDm->NBYTES_MLNO);
+}
 
-	DMA -> CR |= DMA_CR_EMLM_MASK;
+/*!
+* @brief Keep the hardware request enabled after the major loop (DREQ = 0).
+*
+* @param[TCD_t * TCDm] TCD image
+*/
+void DMA_TCD_KeepEnabled(TCD_t * TCDm)
+{
+	TCDm->CSR &= ~DMA_TCD_CSR_DREQ_MASK;
+}
 
-	/* Source Address. */
-	DMA -> TCD[0].SADDR = DMA_TCD_SADDR_SADDR((uint32_t volatile) &buffers[0][0]);
+/*!
+* @brief Strided gather/scatter: elements transfers of the given size per minor loop, minors
+* minor loops per major loop, each address following its DMA_Stride_t. Typical uses are a column
+* of a matrix per minor loop (element = row pitch, minor = element size) or a block of lines out
+* of an image (minor = line pitch). SOFF/DOFF step the elements, MLOFF moves to the next minor
+* loop and SLAST/DLASTSGA to the next major loop. MLOFF is shared by both addresses, so when both
+* need one it must be the same. A minor loop offset requires DMA->CR[EMLM] = 1.
+*
+* The eDMA adds MLOFF after the last minor loop too, before SLAST/DLASTSGA: the adjustments
+* after the major loop start from base + minors * minor.
+*
+* @param[TCD_t * TCDm] TCD image to fill
+* @param[const volatile void * source] Address of the first source element
+* @param[const DMA_Stride_t * sstride] Source walk
+* @param[volatile void * dest] Address of the first destination element
+* @param[const DMA_Stride_t * dstride] Destination walk
+* @param[DMA_Size_t size] Transfer size of both sides
+* @param[uint16_t elements] Transfers per minor loop
+* @param[uint16_t minors] Minor loops per major loop (1 - 32767)
+* @return 0 if the walk does not fit the TCD: element step beyond 16 bits, different minor loop
+* offsets for source and destination, MLOFF beyond 20 bits or more than 1023 bytes per minor loop
+* with a minor loop offset
+*/
+uint8_t DMA_TCD_Strided(TCD_t * TCDm, const volatile void * source, const DMA_Stride_t * sstride,
+						volatile void * dest, const DMA_Stride_t * dstride, DMA_Size_t size,
+						uint16_t elements, uint16_t minors)
+{
+	int32_t nbytes = (int32_t)elements * (int32_t)DMA_SIZE_BYTES(size);
+	int32_t smloff = sstride->minor - (int32_t)elements * sstride->element;	/* Next minor loop from past the last element */
+	int32_t dmloff = dstride->minor - (int32_t)elements * dstride->element;
+	int32_t mloff  = (smloff != 0) ? smloff : dmloff;
 
-	DMA -> TCD[0].SOFF  = DMA_TCD_SOFF_SOFF(4*8);   				/* Source address add 32 bytes after each transfer */
+	if ((elements == 0u) || (minors == 0u) || (minors > 32767u) ||
+		(sstride->element < INT16_MIN) || (sstride->element > INT16_MAX) ||
+		(dstride->element < INT16_MIN) || (dstride->element > INT16_MAX))
+	{
+		return 0;
+	}
+	if ((smloff != 0) && (dmloff != 0) && (smloff != dmloff))
+	{
+		return 0;												/* One MLOFF for both addresses */
+	}
+	if ((mloff != 0) && ((nbytes > 1023) || (mloff < -(1 << 19)) || (mloff >= (1 << 19))))
+	{
+		return 0;												/* NBYTES 10 bits, MLOFF 20 bits */
+	}
 
-	DMA -> TCD[0].ATTR  = DMA_TCD_ATTR_SMOD(0)  					/* Source modulo feature not used */
-                        | DMA_TCD_ATTR_SSIZE(2)  					/* Source read 2^2 = 4 byte per transfer */
-                        | DMA_TCD_ATTR_DMOD(0)   					/* Destination modulo feature not used */
-                        | DMA_TCD_ATTR_DSIZE(2);  					/* Destination write 2^2 = 4 byte per transfer */
+	DMA_TCD_Transfer(TCDm, source, (int16_t)sstride->element, size,
+					 dest, (int16_t)dstride->element, size, (uint32_t)nbytes, minors);
+	if (mloff != 0)
+	{
+		DMA_TCD_MinorOffset(TCDm, mloff, (smloff != 0) ? 1u : 0u, (dmloff != 0) ? 1u : 0u);
+	}
+	DMA_TCD_Last(TCDm, sstride->major - (int32_t)minors * sstride->minor,
+					   dstride->major - (int32_t)minors * dstride->minor);
+	return 1;
+}
 
-	/* 8 bytes per transfer request (4 bytes for each channel).
-	 * The minor loop offset is applied to the SADDR (return to 4*8 * (2 transfers)) */
-	DMA -> TCD[0].NBYTES.MLOFFYES = DMA_TCD_NBYTES_MLOFFYES_NBYTES(8)
-		  	  	  	  	  	  	  | DMA_TCD_NBYTES_MLOFFYES_SMLOE_MASK
-								  | DMA_TCD_NBYTES_MLOFFYES_MLOFF(4-(4*8*2));
+/*!
+* @brief Check a TCD image for the configuration errors the eDMA reports in DMA->ES.
+*
+* @param[const TCD_t * TCDm] TCD image
+* @return DMA_ES_xxx_MASK bits (NCE, SAE, SOE, DAE, DOE, SGE) of every error found, 0 if valid
+*/
+uint32_t DMA_TCD_Validate(const TCD_t * TCDm)
+{
+	uint32_t errors = 0;
+	uint32_t ssize  = (TCDm->ATTR & DMA_TCD_ATTR_SSIZE_MASK) >> DMA_TCD_ATTR_SSIZE_SHIFT;
+	uint32_t dsize  = (TCDm->ATTR & DMA_TCD_ATTR_DSIZE_MASK) >> DMA_TCD_ATTR_DSIZE_SHIFT;
+	uint32_t smask  = DMA_SIZE_BYTES(ssize) - 1u;
+	uint32_t dmask  = DMA_SIZE_BYTES(dsize) - 1u;
+	uint32_t nbytes = TCDm->NBYTES_MLNO;
+	uint16_t citer  = DMA_iterations(TCDm->CITER_ELINKNO);
+	uint16_t biter  = DMA_iterations(TCDm->BITER_ELINKNO);
 
-	DMA -> TCD[0].SLAST = DMA_TCD_SLAST_SLAST(-(4*8*3-4)); 			/* Source address change after major loop */
+	if (TCDm->NBYTES_MLOFFYES & (DMA_TCD_NBYTES_MLOFFYES_SMLOE_MASK | DMA_TCD_NBYTES_MLOFFYES_DMLOE_MASK))
+	{
+		nbytes &= DMA_TCD_NBYTES_MLOFFYES_NBYTES_MASK;
+	}
 
-	/* Destination Address. */
-	DMA -> TCD[0].DADDR = DMA_TCD_DADDR_DADDR((uint32_t volatile) &(SAI0->TDR[0]));
+	if ((ssize == 3u) || (ssize > 5u) || (dsize == 3u) || (dsize > 5u) ||	/* Reserved sizes */
+		(nbytes == 0u) || (nbytes & smask) || (nbytes & dmask) ||			/* Whole transfers per minor loop */
+		(citer == 0u) || (citer != biter) ||
+		((TCDm->CITER_ELINKNO ^ TCDm->BITER_ELINKNO) & DMA_TCD_CITER_ELINKNO_ELINK_MASK))
+	{
+		errors |= DMA_ES_NCE_MASK;
+	}
+	if (TCDm->SADDR & smask)
+	{
+		errors |= DMA_ES_SAE_MASK;
+	}
+	if ((uint32_t)(int16_t)TCDm->SOFF & smask)
+	{
+		errors |= DMA_ES_SOE_MASK;
+	}
+	if (TCDm->DADDR & dmask)
+	{
+		errors |= DMA_ES_DAE_MASK;
+	}
+	if ((uint32_t)(int16_t)TCDm->DOFF & dmask)
+	{
+		errors |= DMA_ES_DOE_MASK;
+	}
+	if ((TCDm->CSR & DMA_TCD_CSR_ESG_MASK) && (TCDm->DLASTSGA & 0x1Fu))
+	{
+		errors |= DMA_ES_SGE_MASK;
+	}
+	return errors;
+}
 
-	DMA -> TCD[0].DOFF = DMA_TCD_DOFF_DOFF(0);     					/* No destination address offset after transfer */
+/*!
+* Fill out the TCD of the DMA Channel
+* ===================================================
+* Fill out the TCD of the desired DMA channel using the
+* configuration saved in memory of the TCDm index selected.
+* The image is copied as 8 words, CSR last, so the channel
+* never sees a partially written TCD with START or ESG set.
+*
+* @param[uint8_t ch] DMA channel where you want to apply the TCD configuration
+* @param[const TCD_t * TCDm] Pointer to the TCDm index which contains the TCD configuration to be applied.
+*
+*/
+void DMA_TCD_Push(uint8_t ch, const TCD_t * TCDm )
+{
+	volatile uint32_t * dest = (volatile uint32_t *) &DMA->TCD[ch];
+	uint8_t word;
+
+	DEV_ASSERT(DMA_TCD_Validate(TCDm) == 0u);
 
-	DMA -> TCD[0].CITER.ELINKNO = DMA_TCD_CITER_ELINKNO_CITER(8)  	/* 8 minor loop iterations */
-                                | DMA_TCD_CITER_ELINKNO_ELINK(0);   /* No minor loop channel linking */
+	DMA->CDNE = DMA_CDNE_CDNE(ch);		/* DONE must be clear before ESG or MAJORELINK can be set */
+	for (word = 0; word < 8u; word++)
+	{
+		dest[word] = TCDm->WORD[word];
+	}
+}
 
-	DMA -> TCD[0].DLASTSGA = DMA_TCD_DLASTSGA_DLASTSGA(0); 			/* No destination change after major loop */
+/*!
+* @brief DMA Initialization. Select SAI0 Tx channel source.
+*/
+void DMA_init (void)
+{
+	/* Turn DMAMUX clock on */
+	PCC -> PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;
+
+	/* Enable DMA channel */
+	DMAMUX -> CHCFG[0] = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(EDMA_REQ_SAI0_TX);
+
+}
+
+
+/*!
+ * @brief Configure the TCD of the DMA to interleave the two channel buffers into the transmit
+ *        FIFO: each SAI request moves sample n of buffers[0] then sample n of buffers[1].
+ *        The source walks down a column of buffers (element step of one row, 4*8 bytes), the
+ *        minor loop offset moves to the next column and SLAST back to the first one.
+ */
+void DMA_TCD_init(void)
+{
+	TCD_t TCDm __attribute__ ((aligned(32)));
+	static const DMA_Stride_t columns = { .element = sizeof(buffers[0]), .minor = sizeof(buffers[0][0]), .major = 0 };
+	static const DMA_Stride_t fifo    = { .element = 0, .minor = 0, .major = 0 };	/* Always TDR[0] */
 
-	DMA -> TCD[0].CSR = DMA_TCD_CSR_START(0)         				/* Clear START status flag. Channel is not explicitly started */
-                      | DMA_TCD_CSR_INTMAJOR(0)      				/* No IRQ after major loop */
-                      | DMA_TCD_CSR_INTHALF(0)      				/* No IRQ after 1/2 major loop */
-                      | DMA_TCD_CSR_DREQ(0)          				/* Disable channel after major loop */
-                      | DMA_TCD_CSR_ESG(0)           				/* Disable Scatter Gather */
-                      | DMA_TCD_CSR_MAJORELINK(0)    				/* No major loop channel linking */
-                      | DMA_TCD_CSR_ACTIVE(0)        				/* Clear ACTIVE status flag */
-                      | DMA_TCD_CSR_DONE(0)          				/* Clear DONE status flag */
-                      | DMA_TCD_CSR_MAJORLINKCH(0)   				/* No channel-to-channel linking */
-                      | DMA_TCD_CSR_BWC(0);          				/* No eDMA stalls after read/write */
+	DMA -> CR |= DMA_CR_EMLM_MASK;									/* Minor loop offsets */
 
-	DMA -> TCD[0].BITER.ELINKNO = DMA_TCD_BITER_ELINKNO_BITER(8)    /* Initial iteration count */
-                                | DMA_TCD_BITER_ELINKNO_ELINK(0);   /* No minor loop channel linking */
+	/* 2 channels * 4 bytes per transfer request, 8 samples per major loop */
+	(void)DMA_TCD_Strided(&TCDm, &buffers[0][0], &columns, &(SAI0->TDR[0]), &fifo, DMA_SIZE_4BYTES, 2, 8);
+	DMA_TCD_KeepEnabled(&TCDm);										/* Loop over the buffers forever */
+	DMA_TCD_Push(0, &TCDm);
 }
 
 
@@ -33,7 +33,81 @@
 #ifndef DMA_H_
 #define DMA_H_
 
+#include <stdint.h>
+
+/* Structure with the TCD fields, also viewed as the 8 words of the hardware TCD. */
+typedef union
+{
+	struct
+	{
+		uint32_t SADDR;
+		uint16_t SOFF;
+		uint16_t ATTR;
+		union
+		{
+			uint32_t NBYTES_MLNO;
+			uint32_t NBYTES_MLOFFNO;
+			uint32_t NBYTES_MLOFFYES;
+		};
+		uint32_t SLAST;
+		uint32_t DADDR;
+		uint16_t DOFF;
+		union
+		{
+			uint16_t CITER_ELINKNO;
+			uint16_t CITER_ELINKYES;
+		};
+		uint32_t DLASTSGA;
+		uint16_t CSR;
+		union
+		{
+			uint16_t BITER_ELINKNO;
+			uint16_t BITER_ELINKYES;
+		};
+	};
+	uint32_t WORD[8];
+}TCD_t;
+
+/* TCD_t is the memory image of DMA->TCD[n]: DMA_TCD_Push and scatter/gather copy it as 8 words */
+_Static_assert(sizeof(TCD_t) == 32u, "TCD_t must match the 32-byte hardware TCD");
+_Static_assert(__builtin_offsetof(TCD_t, NBYTES_MLNO) == 0x08u, "TCD_t NBYTES offset");
+_Static_assert(__builtin_offsetof(TCD_t, DLASTSGA) == 0x18u, "TCD_t DLASTSGA offset");
+_Static_assert(__builtin_offsetof(TCD_t, BITER_ELINKNO) == 0x1Eu, "TCD_t BITER offset");
+
+/* Transfer sizes, ATTR[SSIZE]/ATTR[DSIZE] encoding */
+typedef enum
+{
+	DMA_SIZE_1BYTE   = 0u,
+	DMA_SIZE_2BYTES  = 1u,
+	DMA_SIZE_4BYTES  = 2u,
+	DMA_SIZE_16BYTES = 4u,		/* 16-byte burst */
+	DMA_SIZE_32BYTES = 5u		/* 32-byte burst */
+}DMA_Size_t;
+
+#define DMA_SIZE_BYTES(size)	(1u << (uint32_t)(size))	/* DMA_Size_t -> bytes per transfer */
+
+/* Address walk of one side of a strided transfer (DMA_TCD_Strided), in bytes. Element e of
+ * minor loop m of major loop n is at base + e * element + m * minor + n * major. */
+typedef struct
+{
+	int32_t element;	/* Between the elements of a minor loop (SOFF/DOFF, 16 bits) */
+	int32_t minor;		/* Between the first elements of consecutive minor loops */
+	int32_t major;		/* Between the first elements of consecutive major loops, 0: restart */
+}DMA_Stride_t;
+
 void DMA_init     (void);
 void DMA_TCD_init (void);
 
+/* TCD builder */
+void DMA_TCD_Transfer(TCD_t * TCDm, const volatile void * source, int16_t SOFF, DMA_Size_t ssize,
+					  volatile void * dest, int16_t DOFF, DMA_Size_t dsize, uint32_t nbytes, uint16_t iterations);
+void DMA_TCD_Last(TCD_t * TCDm, int32_t SLAST, int32_t DLAST);
+void DMA_TCD_MinorOffset(TCD_t * TCDm, int32_t MLOFF, uint8_t source, uint8_t dest);
+void DMA_TCD_KeepEnabled(TCD_t * TCDm);
+uint8_t DMA_TCD_Strided(TCD_t * TCDm, const volatile void * source, const DMA_Stride_t * sstride,
+						volatile void * dest, const DMA_Stride_t * dstride, DMA_Size_t size,
+						uint16_t elements, uint16_t minors);
+uint32_t DMA_TCD_Validate(const TCD_t * TCDm);
+void DMA_TCD_Push(uint8_t ch, const TCD_t * TCDm);
+
 #endif /* DMA_H_ */
@@ -33,10 +33,18 @@
 #include "SAI.h"
 #include "device_registers.h"
 
+/* The 40 MHz bus clock has no integer divider to 8 kHz TDM8 frames of 32-bit words: DIV 9 gives
+ * 7812.5 Hz (-2.3 %), accepted here. 12.288 MHz on SAI_MCLK (PTD1) would give 8 kHz exactly. */
+#define SAI_RATE_TOL_PPM	(25000)
+#include "SAI_Rate.h"
+
 #define BIT_SIZE            (8)   						/* Bit size per word */
 #define CHANNEL_MASK        (0xF) 						/* All channels */
 #define WATERMARK           (6)   						/* FIFO size is 8, then watermark is set to FIFO_SIZE/2 */
 
+SAI_RATE(SAI_TDM8, 40000000, 0, 8000, 8, 32);				/* Bus clock, 8 kHz, 8 slots of 32 bits */
+SAI_RATE_ASSERT(SAI_TDM8);
+
 
 /*!
 * @brief SAI Initialization.
@@ -72,7 +80,7 @@ void SAI_init (void)
     /* Frame Sync Width: Configure the length of the frame synchronization in number of bit clocks.
      *                   The value written must be one less than the number of bit clocks */
     SAI0 -> TCR4 &= ~(SAI_TCR4_SYWD_MASK);
-    SAI0 -> TCR4 |= (SAI_TCR4_SYWD(0));
+    SAI0 -> TCR4 |= (SAI_TCR4_SYWD(SAI_TDM8_SYWD));
 
     /* Data order: MSB is transmitted first. */
     SAI0 -> TCR4 &= ~(SAI_TCR4_MF_MASK);
@@ -89,7 +97,7 @@ void SAI_init (void)
     /* Slot count: Configure the number of words in each frame.
      *             The value written must be one less than the number of words in the frame */
     SAI0 -> TCR4 &= ~(SAI_TCR4_FRSZ_MASK);
-    SAI0 -> TCR4 |= (SAI_TCR4_FRSZ(7));
+    SAI0 -> TCR4 |= (SAI_TCR4_FRSZ(SAI_TDM8_FRSZ));
 
 
 
@@ -105,26 +113,10 @@ void SAI_init (void)
 
     /* Sample */
 
-    /* Sample Rate Frequency Formula
-     *
-     * 		Bit Clock Frequency (BCLK)
-     * 		Master Clock SAI0 (MCLK_SAI) = Bus Clock (40 MHz)
-     * 		Bits per channel = 32 bits
-     * 		Number of channels = 8 channels
-     *
-     * 		BCLK = MCLK_SAI / ((DIV + 1) * 2)
-     * 		BCLK = bits per channel * number of channels * sample rate frequency
-     *
-     * 		To get a desired Sample Rate frequency the divisor (DIV) must be calculate
-     * 		as follows. Equate the two equations and solve for DIV
-     *
-     * 		DIV = [MCLK_SAI / (bits per channel * number of channels * sample rate frequency * 2)] - 1
-     * 		DIV = [40 MHz / (512 * sample rate frequency)] - 1
-     *
-     * 		For a desired Sample Rate Frequency of 8 kHz.... DIV = 8.77 ~ 9
-     */
+    /* Sample rate: BCLK = MCLK_SAI / ((DIV + 1) * 2) = bits per channel * channels * sample rate,
+     * MSEL and DIV planned by SAI_RATE (SAI_Rate.h) */
     SAI0 -> TCR2 &= ~(SAI_TCR2_MSEL_MASK | SAI_TCR2_DIV_MASK);
-    SAI0 -> TCR2 |= (SAI_TCR2_MSEL(0) | SAI_TCR2_DIV(9));
+    SAI0 -> TCR2 |= SAI_RATE_TCR2(SAI_TDM8);
 
     /* Enable 8 slots/channels in the audio frame (bits[7:0] are set to zero) */
     SAI0 -> TMR = 0xFF00;
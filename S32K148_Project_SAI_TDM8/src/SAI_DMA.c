@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"	/* include peripheral declarations */
+#include "SAI_DMA.h"
+
+/*!
+ * Description:
+ * ===================================================
+ * SAI_DMA_format sets up the frame of one SAI for both directions, with the data lines off.
+ * SAI_DMA_init attaches a DMA channel to the transmitter or the receiver:
+ *
+ * 	TX: FRDE requests the channel whenever a line FIFO holds FIFO - BURST words or less
+ * 	    (TFW); each request copies BURST words per line from the buffer into TDR.
+ * 	RX: FRDE requests the channel whenever a line FIFO holds BURST words or more (RFW);
+ * 	    each request copies BURST words per line from RDR into the buffer.
+ *
+ * With several lines the FIFOs are combined on software accesses (FCOMB = 2): successive TDR
+ * writes and RDR reads go round robin over the enabled lines, so one channel serves all of them
+ * and the buffer holds, per slot, one word per line.
+ *
+ * The channel walks a buffer of two periods and rewinds (SLAST / DLASTSGA) forever. INTHALF and
+ * INTMAJOR mark the end of each period; SAI_DMA_IRQHandler, called from the DMAn_IRQHandler of
+ * the application, compares CITER with the period expected next and calls the callback for every
+ * period completed. A callback that returns after the DMA has come back into its own period is
+ * counted in late (the period was sent or overwritten while it was being processed). An interrupt
+ * held off for a whole buffer (two periods) leaves CITER where it was and is not seen.
+ *
+ * SAI_DMA_ErrorIRQHandler, called from SAIn_Tx_IRQHandler / SAIn_Rx_IRQHandler, counts the FIFO
+ * errors: a transmit FIFO found empty or a receive FIFO found full by the shifter. Such an error
+ * shifts the slot order of that direction; SAI_DMA_stop and SAI_DMA_start realign it.
+ */
+
+#define SAI_TCSR_W1C_MASK	(SAI_TCSR_WSF_MASK | SAI_TCSR_SEF_MASK | SAI_TCSR_FEF_MASK)
+#define SAI_RCSR_W1C_MASK	(SAI_RCSR_WSF_MASK | SAI_RCSR_SEF_MASK | SAI_RCSR_FEF_MASK)
+
+static SAI_Type * const SAI_bases[] = SAI_BASE_PTRS;
+static const IRQn_Type SAI_tx_irqs[] = SAI_TX_IRQS;
+static const IRQn_Type SAI_rx_irqs[] = SAI_RX_IRQS;
+static const uint32_t SAI_pcc[] = { PCC_SAI0_INDEX, PCC_SAI1_INDEX };
+static const uint8_t SAI_tx_req[] = { EDMA_REQ_SAI0_TX, EDMA_REQ_FLEXIO_SHIFTER3_SAI1_TX };	/* SAI1 shares with FlexIO */
+static const uint8_t SAI_rx_req[] = { EDMA_REQ_SAI0_RX, EDMA_REQ_FLEXIO_SHIFTER2_SAI1_RX };
+
+static void NVIC_enable(IRQn_Type irq)
+{
+	S32_NVIC->ICPR[(uint32_t)irq >> 5u] = 1u << ((uint32_t)irq & 0x1Fu);	/* Clear any pending IR */
+	S32_NVIC->ISER[(uint32_t)irq >> 5u] = 1u << ((uint32_t)irq & 0x1Fu);	/* Enable IRQ */
+}
+
+static uint8_t SAI_DMA_instance(SAI_Type * base)
+{
+	uint8_t instance = 0;
+
+	while ((instance < SAI_INSTANCE_COUNT) && (SAI_bases[instance] != base))
+	{
+		instance++;
+	}
+	DEV_ASSERT(instance < SAI_INSTANCE_COUNT);
+	return instance;
+}
+
+static uint8_t SAI_DMA_bits_set(uint32_t mask)
+{
+	uint8_t count = 0;
+
+	for (; mask != 0u; mask &= mask - 1u)
+	{
+		count++;
+	}
+	return count;
+}
+
+/*!
+* @brief Configure the frame of an SAI: transmitter master on the bus clock, receiver synchronous
+* to it. Both directions are left disabled with their FIFOs reset and no data line enabled.
+*
+* @param[SAI_Type * base] SAI0 or SAI1
+* @param[const SAI_DMA_Format_t * format] Frame format
+*/
+void SAI_DMA_format(SAI_Type * base, const SAI_DMA_Format_t * format)
+{
+	uint8_t instance = SAI_DMA_instance(base);
+	uint32_t frame = SAI_TCR4_FRSZ(format->slots - 1u)		/* Words per frame */
+				   | SAI_TCR4_SYWD(format->sync_width - 1u)	/* Frame sync length in bit clocks */
+				   | SAI_TCR4_MF_MASK						/* MSB first */
+				   | SAI_TCR4_FSD_MASK;						/* Frame sync generated internally */
+	uint32_t words = SAI_TCR5_WNW(format->bits - 1u) | SAI_TCR5_W0W(format->bits - 1u) | SAI_TCR5_FBT(format->bits - 1u);
+
+	DEV_ASSERT((format->slots >= 1u) && (format->slots <= 16u));
+	DEV_ASSERT((format->bits >= 8u) && (format->bits <= 32u));
+	DEV_ASSERT((format->sync_width >= 1u) && (format->sync_width <= format->bits));
+
+	PCC->PCCn[SAI_pcc[instance]] |= PCC_PCCn_CGC_MASK;		/* Enable clock for SAI */
+
+	base->TCSR = 0;											/* Disable transmitter and receiver */
+	base->RCSR = 0;
+	base->TCSR = SAI_TCSR_DBGE_MASK | SAI_TCSR_FR_MASK;		/* Enabled in debug mode, reset FIFO */
+	base->RCSR = SAI_RCSR_DBGE_MASK | SAI_RCSR_FR_MASK;
+
+	/* Transmitter: bit clock = master clock / ((DIV + 1) * 2), frame sync generated */
+	base->TCR1 = SAI_TCR1_TFW(SAI_DMA_FIFO_SIZE - SAI_DMA_BURST);	/* Request with room for a burst */
+	base->TCR2 = SAI_TCR2_SYNC(0)							/* Asynchronous: the master */
+			   | SAI_TCR2_BCP(format->bclk_active_low)
+			   | SAI_TCR2_MSEL(format->msel)				/* Master clock */
+			   | SAI_TCR2_BCD_MASK							/* Bit clock generated internally */
+			   | SAI_TCR2_DIV(format->div);
+	base->TCR3 = 0;											/* Lines enabled by SAI_DMA_start */
+	base->TCR4 = frame;
+	base->TCR5 = words;
+	base->TMR  = format->slot_mask;
+
+	/* Receiver: same frame on the transmitter's bit clock and frame sync */
+	base->RCR1 = SAI_RCR1_RFW(SAI_DMA_BURST - 1u);			/* Request once a burst is available */
+	base->RCR2 = SAI_RCR2_SYNC(1)							/* Synchronous with the transmitter */
+			   | SAI_RCR2_BCP(format->bclk_active_low);
+	base->RCR3 = 0;
+	base->RCR4 = frame;
+	base->RCR5 = words;
+	base->RMR  = format->slot_mask;
+}
+
+/*!
+* @brief Point the channel back at the first period with a full major loop.
+*
+* @param[SAI_DMA_Stream_t * stream] Stream, channel not running
+*/
+static void SAI_DMA_rewind(SAI_DMA_Stream_t * stream)
+{
+	uint8_t ch = stream->ch;
+	uint16_t loops = (uint16_t)(2u * stream->loops_per_period);
+
+	if (stream->tx)
+	{
+		DMA->TCD[ch].SADDR = DMA_TCD_SADDR_SADDR((uint32_t) stream->buffer);
+	}
+	else
+	{
+		DMA->TCD[ch].DADDR = DMA_TCD_DADDR_DADDR((uint32_t) stream->buffer);
+	}
+	DMA->TCD[ch].CITER.ELINKNO = DMA_TCD_CITER_ELINKNO_CITER(loops);
+	DMA->TCD[ch].BITER.ELINKNO = DMA_TCD_BITER_ELINKNO_BITER(loops);
+	DMA->TCD[ch].CSR = DMA_TCD_CSR_INTHALF_MASK |			/* IRQ after the first period */
+					   DMA_TCD_CSR_INTMAJOR_MASK;			/* IRQ after the second, DREQ = 0: never stops */
+	stream->next = 0;
+}
+
+/*!
+* @brief Attach a DMA channel and a two period buffer to the transmitter or the receiver of an
+* SAI set up by SAI_DMA_format. The stream runs from SAI_DMA_start.
+*
+* @param[SAI_DMA_Stream_t * stream] Stream state
+* @param[SAI_Type * base] SAI0 or SAI1
+* @param[uint8_t tx] 1 for the transmitter, 0 for the receiver
+* @param[uint8_t ch] DMA channel
+* @param[uint8_t lines] Data lines, mask of D0..D3
+* @param[uint32_t * buffer] Two periods of period_words
+* @param[uint16_t period_words] Words per period: whole frames and whole FIFO bursts
+* @param[SAI_DMA_Callback_t callback] Called for each completed period
+* @param[void * context] Passed to the callback
+*/
+void SAI_DMA_init(SAI_DMA_Stream_t * stream, SAI_Type * base, uint8_t tx, uint8_t ch,
+				  uint8_t lines, uint32_t * buffer, uint16_t period_words,
+				  SAI_DMA_Callback_t callback, void * context)
+{
+	uint8_t instance = SAI_DMA_instance(base);
+	uint8_t nlines = SAI_DMA_bits_set(lines);
+	uint8_t first = 0;
+	uint32_t burst = SAI_DMA_BURST * nlines;				/* Words per FIFO request */
+
+	DEV_ASSERT((nlines != 0u) && (lines < (1u << (base->PARAM & SAI_PARAM_DATALINE_MASK))));
+	DEV_ASSERT((period_words % burst) == 0u);
+	DEV_ASSERT((period_words % (nlines * SAI_DMA_bits_set(~base->TMR &				/* Whole frames: unmasked slots */
+			    ((2u << ((base->TCR4 & SAI_TCR4_FRSZ_MASK) >> SAI_TCR4_FRSZ_SHIFT)) - 1u)))) == 0u);
+	DEV_ASSERT(2u * period_words / burst <= DMA_TCD_CITER_ELINKNO_CITER_MASK);
+
+	while (!(lines & (1u << first)))
+	{
+		first++;
+	}
+
+	stream->base             = base;
+	stream->tx               = tx;
+	stream->ch               = ch;
+	stream->lines            = lines;
+	stream->buffer           = buffer;
+	stream->period_words     = period_words;
+	stream->loops_per_period = (uint16_t)(period_words / burst);
+	stream->callback         = callback;
+	stream->context          = context;
+	stream->periods          = 0;
+	stream->late             = 0;
+	stream->fifo_errors      = 0;
+
+	SIM->PLATCGC |= SIM_PLATCGC_CGCDMA_MASK;				/* DMA Clock Gating Control Enable */
+	PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;		/* Enable clock for DMAMUX */
+	DMAMUX->CHCFG[ch] = 0;									/* Disable the channel to change the source */
+	DMAMUX->CHCFG[ch] = DMAMUX_CHCFG_SOURCE(tx ? SAI_tx_req[instance] : SAI_rx_req[instance]) | DMAMUX_CHCFG_ENBL_MASK;
+
+	DMA->TCD[ch].ATTR = DMA_TCD_ATTR_SSIZE(2) | DMA_TCD_ATTR_DSIZE(2);			/* 4 byte transfers */
+	DMA->TCD[ch].NBYTES.MLNO = DMA_TCD_NBYTES_MLNO_NBYTES(4u * burst);			/* One burst per request */
+	if (tx)
+	{
+		base->TCR4 = (base->TCR4 & ~SAI_TCR4_FCOMB_MASK) | SAI_TCR4_FCOMB((nlines > 1u) ? 2u : 0u);
+		DMA->TCD[ch].SOFF = DMA_TCD_SOFF_SOFF(4);									/* Next word of the buffer */
+		DMA->TCD[ch].SLAST = DMA_TCD_SLAST_SLAST(-(int32_t)(8u * period_words));	/* Back to the first period */
+		DMA->TCD[ch].DADDR = DMA_TCD_DADDR_DADDR((uint32_t) &base->TDR[first]);	/* Transmit FIFO(s) */
+		DMA->TCD[ch].DOFF = DMA_TCD_DOFF_DOFF(0);
+		DMA->TCD[ch].DLASTSGA = 0;
+		NVIC_enable(SAI_tx_irqs[instance]);
+	}
+	else
+	{
+		base->RCR4 = (base->RCR4 & ~SAI_RCR4_FCOMB_MASK) | SAI_RCR4_FCOMB((nlines > 1u) ? 2u : 0u);
+		DMA->TCD[ch].SADDR = DMA_TCD_SADDR_SADDR((uint32_t) &base->RDR[first]);	/* Receive FIFO(s) */
+		DMA->TCD[ch].SOFF = DMA_TCD_SOFF_SOFF(0);
+		DMA->TCD[ch].SLAST = 0;
+		DMA->TCD[ch].DOFF = DMA_TCD_DOFF_DOFF(4);									/* Next word of the buffer */
+		DMA->TCD[ch].DLASTSGA = DMA_TCD_DLASTSGA_DLASTSGA(-(int32_t)(8u * period_words));
+		NVIC_enable(SAI_rx_irqs[instance]);
+	}
+	SAI_DMA_rewind(stream);
+	NVIC_enable((IRQn_Type)(DMA0_IRQn + ch));
+}
+
+/*!
+* @brief Start the streams of one SAI together. The receiver is armed first, the transmit FIFOs
+* are filled from the two primed periods, then TE starts the bit clock so both directions begin
+* on the first slot of the same frame. Either stream can be NULL; a receive only SAI still
+* needs TE for its clocks and runs it with no transmit line.
+*
+* @param[SAI_DMA_Stream_t * tx] Transmit stream or NULL
+* @param[SAI_DMA_Stream_t * rx] Receive stream of the same SAI or NULL
+*/
+void SAI_DMA_start(SAI_DMA_Stream_t * tx, SAI_DMA_Stream_t * rx)
+{
+	SAI_Type * base = (tx != NULL) ? tx->base : rx->base;
+
+	DEV_ASSERT((tx == NULL) || (rx == NULL) || (tx->base == rx->base));
+
+	if (rx != NULL)
+	{
+		base->RCSR = (base->RCSR & ~SAI_RCSR_W1C_MASK) | SAI_RCSR_FR_MASK;		/* Reset FIFO */
+		base->RCR3 = SAI_RCR3_RCE(rx->lines);
+		SAI_DMA_rewind(rx);
+		DMA->SERQ = DMA_SERQ_SERQ(rx->ch);
+		base->RCSR = (base->RCSR & ~SAI_RCSR_W1C_MASK) | SAI_RCSR_FEF_MASK |		/* Clear a stale error */
+					 SAI_RCSR_FRDE_MASK | SAI_RCSR_FEIE_MASK | SAI_RCSR_RE_MASK;
+	}
+	if (tx != NULL)
+	{
+		base->TCSR = (base->TCSR & ~SAI_TCSR_W1C_MASK) | SAI_TCSR_FR_MASK;		/* Reset FIFO */
+		tx->callback(tx->context, &tx->buffer[0], tx->period_words);				/* Prime both periods */
+		tx->callback(tx->context, &tx->buffer[tx->period_words], tx->period_words);
+		SAI_DMA_rewind(tx);
+		DMA->SERQ = DMA_SERQ_SERQ(tx->ch);
+		base->TCR3 = SAI_TCR3_TCE(tx->lines);
+		base->TCSR = (base->TCSR & ~SAI_TCSR_W1C_MASK) | SAI_TCSR_FRDE_MASK;
+		while (base->TCSR & SAI_TCSR_FRF_MASK) {}									/* First bursts in the FIFOs */
+		base->TCSR = (base->TCSR & ~SAI_TCSR_W1C_MASK) | SAI_TCSR_FEF_MASK | SAI_TCSR_FEIE_MASK;
+	}
+	base->TCSR = (base->TCSR & ~SAI_TCSR_W1C_MASK) | SAI_TCSR_TE_MASK;			/* Bit clock and frame sync on */
+}
+
+/*!
+* @brief Stop streams of one SAI. The bit clock keeps running while the other direction of a
+* synchronous pair is still enabled.
+*
+* @param[SAI_DMA_Stream_t * tx] Transmit stream or NULL
+* @param[SAI_DMA_Stream_t * rx] Receive stream of the same SAI or NULL
+*/
+void SAI_DMA_stop(SAI_DMA_Stream_t * tx, SAI_DMA_Stream_t * rx)
+{
+	SAI_Type * base = (tx != NULL) ? tx->base : rx->base;
+
+	if (rx != NULL)
+	{
+		base->RCSR &= ~(SAI_RCSR_W1C_MASK | SAI_RCSR_RE_MASK | SAI_RCSR_FRDE_MASK | SAI_RCSR_FEIE_MASK);
+		base->RCR3 = 0;
+		DMA->CERQ = DMA_CERQ_CERQ(rx->ch);
+	}
+	if (tx != NULL)
+	{
+		base->TCSR &= ~(SAI_TCSR_W1C_MASK | SAI_TCSR_FRDE_MASK | SAI_TCSR_FEIE_MASK);
+		base->TCR3 = 0;
+		DMA->CERQ = DMA_CERQ_CERQ(tx->ch);
+	}
+	if (!(base->RCSR & SAI_RCSR_RE_MASK))
+	{
+		base->TCSR &= ~(SAI_TCSR_W1C_MASK | SAI_TCSR_TE_MASK);						/* No direction left */
+	}
+}
+
+/*!
+* @brief Period the channel is working on, from the minor loops done in the major loop.
+*
+* @param[SAI_DMA_Stream_t * stream] Stream
+*/
+static uint8_t SAI_DMA_position(SAI_DMA_Stream_t * stream)
+{
+	uint16_t citer = DMA->TCD[stream->ch].CITER.ELINKNO & DMA_TCD_CITER_ELINKNO_CITER_MASK;
+	uint16_t done = (uint16_t)(2u * stream->loops_per_period - citer);
+
+	return (done >= stream->loops_per_period) ? 1u : 0u;
+}
+
+/*!
+* @brief DMA channel IRQ body: hand every completed period to the callback.
+*
+* @param[SAI_DMA_Stream_t * stream] Stream
+*/
+void SAI_DMA_IRQHandler(SAI_DMA_Stream_t * stream)
+{
+	uint8_t period;
+
+	DMA->CINT = DMA_CINT_CINT(stream->ch);			/* Clear Interruption request flag */
+	while (SAI_DMA_position(stream) != stream->next)
+	{
+		period = stream->next;
+		stream->callback(stream->context, &stream->buffer[period * stream->period_words], stream->period_words);
+		stream->periods++;
+		stream->next = (uint8_t)(period ^ 1u);
+		if (SAI_DMA_position(stream) == period)
+		{
+			stream->late++;							/* The DMA is back in the period handed out */
+		}
+	}
+}
+
+/*!
+* @brief SAIn_Tx_IRQHandler / SAIn_Rx_IRQHandler body: count and clear FIFO errors.
+*
+* @param[SAI_DMA_Stream_t * stream] Stream
+*/
+void SAI_DMA_ErrorIRQHandler(SAI_DMA_Stream_t * stream)
+{
+	SAI_Type * base = stream->base;
+
+	if (stream->tx)
+	{
+		if (base->TCSR & SAI_TCSR_FEF_MASK)
+		{
+			stream->fifo_errors++;					/* Transmit FIFO empty: underrun */
+			base->TCSR = (base->TCSR & ~SAI_TCSR_W1C_MASK) | SAI_TCSR_FEF_MASK;
+		}
+	}
+	else
+	{
+		if (base->RCSR & SAI_RCSR_FEF_MASK)
+		{
+			stream->fifo_errors++;					/* Receive FIFO full: overrun */
+			base->RCSR = (base->RCSR & ~SAI_RCSR_W1C_MASK) | SAI_RCSR_FEF_MASK;
+		}
+	}
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SAI_DMA_H_
+#define SAI_DMA_H_
+
+#include <stddef.h>
+#include "device_registers.h"
+
+#define SAI_DMA_FIFO_SIZE		(8u)		/* Words per data line FIFO */
+#define SAI_DMA_BURST			(4u)		/* Words per line moved on each FIFO request (FIFO / 2) */
+
+/* Frame format shared by the transmitter and the receiver of one SAI: the transmitter is the
+ * master (bit clock generated, frame sync generated) and the receiver runs synchronous to it,
+ * so both directions see the same slots. msel/div/sync_width come from SAI_RATE (SAI_Rate.h). */
+typedef struct
+{
+	uint8_t  slots;					/* Words per frame, 1 to 16 */
+	uint8_t  bits;					/* Bits per word, 8 to 32, MSB first */
+	uint8_t  msel;					/* Master clock: 0 bus clock, 1 SAI_MCLK input */
+	uint8_t  div;					/* BCLK = master clock / ((div + 1) * 2) */
+	uint8_t  sync_width;			/* Frame sync length in bit clocks */
+	uint8_t  bclk_active_low;		/* 1: drive on falling edge, sample on rising edge */
+	uint16_t slot_mask;				/* Slots neither transmitted nor received (TMR/RMR) */
+}SAI_DMA_Format_t;
+
+/* Called once per period with the words of the period, in FIFO order: the unmasked slots of
+ * each frame, and for each slot one word per line when several lines are combined. */
+typedef void (*SAI_DMA_Callback_t)(void * context, uint32_t * period, uint16_t words);
+
+/* Continuous stream of one direction of an SAI: a DMA channel, triggered by the FIFO request
+ * flag, moves SAI_DMA_BURST words per line between the FIFO and a buffer of two periods and
+ * never stops. Each completed period is handed to the callback from the DMA interrupt while the
+ * DMA works on the other one: TX callbacks fill the period just sent, RX callbacks consume the
+ * period just received. */
+typedef struct
+{
+	SAI_Type * base;				/* SAI0 or SAI1, set up by SAI_DMA_format */
+	uint8_t tx;						/* 1: transmitter, 0: receiver */
+	uint8_t ch;						/* DMA channel */
+	uint8_t lines;					/* Data lines, mask of D0..D3 (SAI1 has D0 only) */
+	uint32_t * buffer;				/* Two periods of period_words */
+	uint16_t period_words;
+	uint16_t loops_per_period;		/* DMA minor loops (FIFO requests) per period */
+	SAI_DMA_Callback_t callback;
+	void * context;
+	volatile uint8_t next;			/* Period the DMA completes next */
+	volatile uint32_t periods;		/* Periods handed to the callback */
+	volatile uint32_t late;			/* Callback returned after the DMA entered its period again */
+	volatile uint32_t fifo_errors;	/* Transmit underruns / receive overruns (FEF) */
+}SAI_DMA_Stream_t;
+
+void 		SAI_DMA_format				(SAI_Type * base, const SAI_DMA_Format_t * format);
+void 		SAI_DMA_init				(SAI_DMA_Stream_t * stream, SAI_Type * base, uint8_t tx, uint8_t ch,
+										 uint8_t lines, uint32_t * buffer, uint16_t period_words,
+										 SAI_DMA_Callback_t callback, void * context);
+void 		SAI_DMA_start				(SAI_DMA_Stream_t * tx, SAI_DMA_Stream_t * rx);
+void 		SAI_DMA_stop				(SAI_DMA_Stream_t * tx, SAI_DMA_Stream_t * rx);
+void 		SAI_DMA_IRQHandler			(SAI_DMA_Stream_t * stream);
+void 		SAI_DMA_ErrorIRQHandler		(SAI_DMA_Stream_t * stream);
+
+#endif /* SAI_DMA_H_ */
@@ -0,0 +1,527 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include "device_registers.h"
+#include "SAI_TDM.h"
+
+/*!
+ * Description:
+ * ===================================================
+ * The loops move four samples per iteration with a scalar tail, so the M4 keeps its pointers
+ * and four values in registers and the strided slot loads become post-incremented LDRs.
+ *
+ * 	Q31 -> Q15: PKHTB keeps the upper halfwords of two samples in one instruction (truncation).
+ * 	Q15 -> Q31: a halfword pair expands with one shift and one mask.
+ * 	Q31 <-> float: VCVT.F32.S32 / VCVT.S32.F32 with 31 fraction bits, no multiply; the float to
+ * 	    Q31 direction saturates at -1.0 and 1.0 - 2^-31, the portable path clamps the same way.
+ *
+ * In place conversions that shrink (Q15 packing) walk forwards and the one that grows (Q15 to
+ * Q31) walks backwards, so no sample is overwritten before it is read. Float values share the
+ * words of the period through memcpy, which compiles to a plain register move.
+ */
+
+/*!
+* @brief Upper halfword of top, upper halfword of bottom in the lower half: PKHTB top, bottom, ASR #16.
+*/
+static inline uint32_t SAI_TDM_pack(uint32_t top, uint32_t bottom)
+{
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+	uint32_t packed;
+	__asm ("pkhtb %0, %1, %2, asr #16" : "=r" (packed) : "r" (top), "r" (bottom));
+	return packed;
+#else
+	return (top & 0xFFFF0000u) | (bottom >> 16);
+#endif
+}
+
+/*!
+* @brief Q31 word to float in [-1.0, 1.0).
+*/
+static inline float SAI_TDM_float(uint32_t word)
+{
+#if defined(__ARM_FP) && (__ARM_FP & 4)
+	float value;
+	__asm ("vmov %0, %1\n\tvcvt.f32.s32 %0, %0, #31" : "=t" (value) : "r" (word));
+	return value;
+#else
+	return (float)(int32_t)word * (1.0f / 2147483648.0f);
+#endif
+}
+
+/*!
+* @brief Float to Q31 word, saturated to [-1.0, 1.0 - 2^-31], rounded toward zero.
+*/
+static inline uint32_t SAI_TDM_q31(float value)
+{
+#if defined(__ARM_FP) && (__ARM_FP & 4)
+	uint32_t word;
+	__asm ("vcvt.s32.f32 %1, %1, #31\n\tvmov %0, %1" : "=r" (word), "+t" (value));
+	return word;
+#else
+	if (value >= 1.0f)
+	{
+		return 0x7FFFFFFFu;
+	}
+	if (value <= -1.0f)
+	{
+		return 0x80000000u;
+	}
+	return (uint32_t)(int32_t)(value * 2147483648.0f);
+#endif
+}
+
+static inline float SAI_TDM_load_float(const uint32_t * word)
+{
+	float value;
+	memcpy(&value, word, sizeof(value));
+	return value;
+}
+
+static inline void SAI_TDM_store_float(uint32_t * word, float value)
+{
+	memcpy(word, &value, sizeof(value));
+}
+
+/*!
+* @brief Right-justified slot words of the SAI to Q31, in place.
+*
+* @param[uint32_t * words] Slot words
+* @param[uint32_t count] Number of words
+* @param[uint8_t bits] Slot width (8 - 32)
+*/
+void SAI_TDM_to_q31(uint32_t * words, uint32_t count, uint8_t bits)
+{
+	uint32_t shift = 32u - bits;
+	uint32_t i;
+
+	DEV_ASSERT((bits >= 8u) && (bits <= 32u));
+
+	if (shift == 0u)
+	{
+		return;
+	}
+	for (i = 0; i + 4u <= count; i += 4u)
+	{
+		words[i]      <<= shift;
+		words[i + 1u] <<= shift;
+		words[i + 2u] <<= shift;
+		words[i + 3u] <<= shift;
+	}
+	for (; i < count; i++)
+	{
+		words[i] <<= shift;
+	}
+}
+
+/*!
+* @brief Q31 to right-justified, sign extended slot words for the SAI, in place (truncation).
+*
+* @param[uint32_t * words] Q31 samples
+* @param[uint32_t count] Number of words
+* @param[uint8_t bits] Slot width (8 - 32)
+*/
+void SAI_TDM_from_q31(uint32_t * words, uint32_t count, uint8_t bits)
+{
+	uint32_t shift = 32u - bits;
+	uint32_t i;
+
+	DEV_ASSERT((bits >= 8u) && (bits <= 32u));
+
+	if (shift == 0u)
+	{
+		return;
+	}
+	for (i = 0; i + 4u <= count; i += 4u)
+	{
+		words[i]      = (uint32_t)((int32_t)words[i] >> shift);
+		words[i + 1u] = (uint32_t)((int32_t)words[i + 1u] >> shift);
+		words[i + 2u] = (uint32_t)((int32_t)words[i + 2u] >> shift);
+		words[i + 3u] = (uint32_t)((int32_t)words[i + 3u] >> shift);
+	}
+	for (; i < count; i++)
+	{
+		words[i] = (uint32_t)((int32_t)words[i] >> shift);
+	}
+}
+
+/*!
+* @brief Q31 samples to packed Q15, in place: sample n ends up in halfword n of the buffer
+* (the first (count + 1) / 2 words).
+*
+* @param[uint32_t * words] Q31 samples
+* @param[uint32_t count] Number of samples
+*/
+void SAI_TDM_q31_to_q15(uint32_t * words, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i + 4u <= count; i += 4u)
+	{
+		uint32_t a = words[i];
+		uint32_t b = words[i + 1u];
+		uint32_t c = words[i + 2u];
+		uint32_t d = words[i + 3u];
+		words[i / 2u]      = SAI_TDM_pack(b, a);
+		words[i / 2u + 1u] = SAI_TDM_pack(d, c);
+	}
+	for (; i + 2u <= count; i += 2u)
+	{
+		words[i / 2u] = SAI_TDM_pack(words[i + 1u], words[i]);
+	}
+	if (i < count)
+	{
+		words[i / 2u] = words[i] >> 16;								/* Odd count: last sample alone */
+	}
+}
+
+/*!
+* @brief Packed Q15 samples (halfword n = sample n) to Q31 words, in place.
+*
+* @param[uint32_t * words] Buffer of count words, the Q15 samples in its first half
+* @param[uint32_t count] Number of samples
+*/
+void SAI_TDM_q15_to_q31(uint32_t * words, uint32_t count)
+{
+	uint32_t i = count;
+
+	if (i & 1u)
+	{
+		i--;
+		words[i] = words[i / 2u] << 16;								/* Odd count: last sample alone */
+	}
+	for (; i >= 4u; i -= 4u)
+	{
+		uint32_t ab = words[i / 2u - 2u];
+		uint32_t cd = words[i / 2u - 1u];
+		words[i - 1u] = cd & 0xFFFF0000u;
+		words[i - 2u] = cd << 16;
+		words[i - 3u] = ab & 0xFFFF0000u;
+		words[i - 4u] = ab << 16;
+	}
+	if (i != 0u)
+	{
+		uint32_t ab = words[0];
+		words[1] = ab & 0xFFFF0000u;
+		words[0] = ab << 16;
+	}
+}
+
+/*!
+* @brief Q31 samples to float, in place.
+*
+* @param[uint32_t * words] Q31 samples, float afterwards
+* @param[uint32_t count] Number of samples
+*/
+void SAI_TDM_q31_to_float(uint32_t * words, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i + 4u <= count; i += 4u)
+	{
+		float a = SAI_TDM_float(words[i]);
+		float b = SAI_TDM_float(words[i + 1u]);
+		float c = SAI_TDM_float(words[i + 2u]);
+		float d = SAI_TDM_float(words[i + 3u]);
+		SAI_TDM_store_float(&words[i], a);
+		SAI_TDM_store_float(&words[i + 1u], b);
+		SAI_TDM_store_float(&words[i + 2u], c);
+		SAI_TDM_store_float(&words[i + 3u], d);
+	}
+	for (; i < count; i++)
+	{
+		SAI_TDM_store_float(&words[i], SAI_TDM_float(words[i]));
+	}
+}
+
+/*!
+* @brief Float samples to Q31, in place, saturated.
+*
+* @param[uint32_t * words] Float samples, Q31 afterwards
+* @param[uint32_t count] Number of samples
+*/
+void SAI_TDM_float_to_q31(uint32_t * words, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i + 4u <= count; i += 4u)
+	{
+		uint32_t a = SAI_TDM_q31(SAI_TDM_load_float(&words[i]));
+		uint32_t b = SAI_TDM_q31(SAI_TDM_load_float(&words[i + 1u]));
+		uint32_t c = SAI_TDM_q31(SAI_TDM_load_float(&words[i + 2u]));
+		uint32_t d = SAI_TDM_q31(SAI_TDM_load_float(&words[i + 3u]));
+		words[i]      = a;
+		words[i + 1u] = b;
+		words[i + 2u] = c;
+		words[i + 3u] = d;
+	}
+	for (; i < count; i++)
+	{
+		words[i] = SAI_TDM_q31(SAI_TDM_load_float(&words[i]));
+	}
+}
+
+/*!
+* @brief Split a period into one plane per slot: planes[s * frames + f] = period[f * slots + s].
+*
+* @param[const uint32_t * period] Interleaved frames
+* @param[uint32_t * planes] slots planes of frames words, not overlapping the period
+* @param[uint8_t slots] Words per frame
+* @param[uint16_t frames] Frames in the period
+*/
+void SAI_TDM_deinterleave(const uint32_t * period, uint32_t * planes, uint8_t slots, uint16_t frames)
+{
+	uint32_t s;
+	uint32_t f;
+
+	for (s = 0; s < slots; s++)
+	{
+		const uint32_t * src = &period[s];
+		uint32_t * dst = &planes[s * frames];
+
+		for (f = 0; f + 4u <= frames; f += 4u)
+		{
+			uint32_t a = src[0];
+			uint32_t b = src[slots];
+			uint32_t c = src[2u * slots];
+			uint32_t d = src[3u * slots];
+			src += 4u * slots;
+			dst[0] = a;
+			dst[1] = b;
+			dst[2] = c;
+			dst[3] = d;
+			dst += 4;
+		}
+		for (; f < frames; f++)
+		{
+			*dst++ = *src;
+			src += slots;
+		}
+	}
+}
+
+/*!
+* @brief Rebuild a period from one plane per slot: period[f * slots + s] = planes[s * frames + f].
+*
+* @param[const uint32_t * planes] slots planes of frames words, not overlapping the period
+* @param[uint32_t * period] Interleaved frames
+* @param[uint8_t slots] Words per frame
+* @param[uint16_t frames] Frames in the period
+*/
+void SAI_TDM_interleave(const uint32_t * planes, uint32_t * period, uint8_t slots, uint16_t frames)
+{
+	uint32_t s;
+	uint32_t f;
+
+	for (s = 0; s < slots; s++)
+	{
+		const uint32_t * src = &planes[s * frames];
+		uint32_t * dst = &period[s];
+
+		for (f = 0; f + 4u <= frames; f += 4u)
+		{
+			uint32_t a = src[0];
+			uint32_t b = src[1];
+			uint32_t c = src[2];
+			uint32_t d = src[3];
+			src += 4;
+			dst[0] = a;
+			dst[slots] = b;
+			dst[2u * slots] = c;
+			dst[3u * slots] = d;
+			dst += 4u * slots;
+		}
+		for (; f < frames; f++)
+		{
+			*dst = *src++;
+			dst += slots;
+		}
+	}
+}
+
+/*!
+* @brief Split a Q31 period into one Q15 plane per slot, two samples per store.
+*
+* @param[const uint32_t * period] Interleaved Q31 frames
+* @param[int16_t * planes] slots planes of frames samples, 4-byte aligned
+* @param[uint8_t slots] Words per frame
+* @param[uint16_t frames] Frames in the period, even
+*/
+void SAI_TDM_deinterleave_q15(const uint32_t * period, int16_t * planes, uint8_t slots, uint16_t frames)
+{
+	uint32_t s;
+	uint32_t f;
+
+	DEV_ASSERT(((frames & 1u) == 0u) && (((uint32_t)(uintptr_t)planes & 3u) == 0u));
+
+	for (s = 0; s < slots; s++)
+	{
+		const uint32_t * src = &period[s];
+		uint32_t * dst = (uint32_t *)(void *)&planes[s * frames];
+
+		for (f = 0; f + 4u <= frames; f += 4u)
+		{
+			uint32_t a = src[0];
+			uint32_t b = src[slots];
+			uint32_t c = src[2u * slots];
+			uint32_t d = src[3u * slots];
+			src += 4u * slots;
+			dst[0] = SAI_TDM_pack(b, a);
+			dst[1] = SAI_TDM_pack(d, c);
+			dst += 2;
+		}
+		for (; f < frames; f += 2u)
+		{
+			*dst++ = SAI_TDM_pack(src[slots], src[0]);
+			src += 2u * slots;
+		}
+	}
+}
+
+/*!
+* @brief Rebuild a Q31 period from one Q15 plane per slot, two samples per load.
+*
+* @param[const int16_t * planes] slots planes of frames samples, 4-byte aligned
+* @param[uint32_t * period] Interleaved Q31 frames
+* @param[uint8_t slots] Words per frame
+* @param[uint16_t frames] Frames in the period, even
+*/
+void SAI_TDM_interleave_q15(const int16_t * planes, uint32_t * period, uint8_t slots, uint16_t frames)
+{
+	uint32_t s;
+	uint32_t f;
+
+	DEV_ASSERT(((frames & 1u) == 0u) && (((uint32_t)(uintptr_t)planes & 3u) == 0u));
+
+	for (s = 0; s < slots; s++)
+	{
+		const uint32_t * src = (const uint32_t *)(const void *)&planes[s * frames];
+		uint32_t * dst = &period[s];
+
+		for (f = 0; f + 4u <= frames; f += 4u)
+		{
+			uint32_t ab = src[0];
+			uint32_t cd = src[1];
+			src += 2;
+			dst[0]          = ab << 16;
+			dst[slots]      = ab & 0xFFFF0000u;
+			dst[2u * slots] = cd << 16;
+			dst[3u * slots] = cd & 0xFFFF0000u;
+			dst += 4u * slots;
+		}
+		for (; f < frames; f += 2u)
+		{
+			uint32_t ab = *src++;
+			dst[0]     = ab << 16;
+			dst[slots] = ab & 0xFFFF0000u;
+			dst += 2u * slots;
+		}
+	}
+}
+
+/*!
+* @brief Split a Q31 period into one float plane per slot.
+*
+* @param[const uint32_t * period] Interleaved Q31 frames
+* @param[float * planes] slots planes of frames samples
+* @param[uint8_t slots] Words per frame
+* @param[uint16_t frames] Frames in the period
+*/
+void SAI_TDM_deinterleave_float(const uint32_t * period, float * planes, uint8_t slots, uint16_t frames)
+{
+	uint32_t s;
+	uint32_t f;
+
+	for (s = 0; s < slots; s++)
+	{
+		const uint32_t * src = &period[s];
+		float * dst = &planes[s * frames];
+
+		for (f = 0; f + 4u <= frames; f += 4u)
+		{
+			float a = SAI_TDM_float(src[0]);
+			float b = SAI_TDM_float(src[slots]);
+			float c = SAI_TDM_float(src[2u * slots]);
+			float d = SAI_TDM_float(src[3u * slots]);
+			src += 4u * slots;
+			dst[0] = a;
+			dst[1] = b;
+			dst[2] = c;
+			dst[3] = d;
+			dst += 4;
+		}
+		for (; f < frames; f++)
+		{
+			*dst++ = SAI_TDM_float(*src);
+			src += slots;
+		}
+	}
+}
+
+/*!
+* @brief Rebuild a Q31 period from one float plane per slot, saturated.
+*
+* @param[const float * planes] slots planes of frames samples
+* @param[uint32_t * period] Interleaved Q31 frames
+* @param[uint8_t slots] Words per frame
+* @param[uint16_t frames] Frames in the period
+*/
+void SAI_TDM_interleave_float(const float * planes, uint32_t * period, uint8_t slots, uint16_t frames)
+{
+	uint32_t s;
+	uint32_t f;
+
+	for (s = 0; s < slots; s++)
+	{
+		const float * src = &planes[s * frames];
+		uint32_t * dst = &period[s];
+
+		for (f = 0; f + 4u <= frames; f += 4u)
+		{
+			uint32_t a = SAI_TDM_q31(src[0]);
+			uint32_t b = SAI_TDM_q31(src[1]);
+			uint32_t c = SAI_TDM_q31(src[2]);
+			uint32_t d = SAI_TDM_q31(src[3]);
+			src += 4;
+			dst[0]          = a;
+			dst[slots]      = b;
+			dst[2u * slots] = c;
+			dst[3u * slots] = d;
+			dst += 4u * slots;
+		}
+		for (; f < frames; f++)
+		{
+			*dst = SAI_TDM_q31(*src++);
+			dst += slots;
+		}
+	}
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SAI_TDM_H_
+#define SAI_TDM_H_
+
+#include <stdint.h>
+
+/* Slot and sample format kernels for the periods of SAI_DMA.
+ *
+ * A period holds frames of slots, one 32-bit word per slot (interleaved). The SAI delivers a
+ * b-bit slot right-justified in its word (FBT = b - 1), which SAI_TDM_to_q31 turns into Q31
+ * (left-justified, sign in bit 31) in place; SAI_TDM_from_q31 does the reverse for transmission.
+ * Q31 periods convert in place to float (-1.0 to 1.0) or to packed Q15, and are split into one
+ * plane per slot (deinterleave) or rebuilt from planes (interleave), optionally converting on the
+ * way. All kernels are single pass, unrolled, and use the M4 DSP / FPU instructions (PKHTB, VCVT
+ * with fraction bits) when built for them, with an equivalent portable C path otherwise. */
+
+void SAI_TDM_to_q31				(uint32_t * words, uint32_t count, uint8_t bits);
+void SAI_TDM_from_q31			(uint32_t * words, uint32_t count, uint8_t bits);
+void SAI_TDM_q31_to_q15			(uint32_t * words, uint32_t count);
+void SAI_TDM_q15_to_q31			(uint32_t * words, uint32_t count);
+void SAI_TDM_q31_to_float		(uint32_t * words, uint32_t count);
+void SAI_TDM_float_to_q31		(uint32_t * words, uint32_t count);
+
+void SAI_TDM_deinterleave		(const uint32_t * period, uint32_t * planes, uint8_t slots, uint16_t frames);
+void SAI_TDM_interleave			(const uint32_t * planes, uint32_t * period, uint8_t slots, uint16_t frames);
+void SAI_TDM_deinterleave_q15	(const uint32_t * period, int16_t * planes, uint8_t slots, uint16_t frames);
+void SAI_TDM_interleave_q15		(const int16_t * planes, uint32_t * period, uint8_t slots, uint16_t frames);
+void SAI_TDM_deinterleave_float	(const uint32_t * period, float * planes, uint8_t slots, uint16_t frames);
+void SAI_TDM_interleave_float	(const float * planes, uint32_t * period, uint8_t slots, uint16_t frames);
+
+#endif /* SAI_TDM_H_ */
@@ -48,12 +48,98 @@
  * This example uses SAI module to set a TDM protocol with 8 channels (TDM8).
  * Only SAI0_D1 (PTE1) is used as a physical channel to transmit the data.
  *
+ * The frames are streamed continuously by SAI_DMA: DMA CH0 feeds the transmit FIFO of SAI0_D1
+ * and DMA CH1 empties the receive FIFO of SAI0_D0 (PTA13), both from FIFO watermark requests,
+ * into buffers of two periods of TDM_FRAMES frames (2 ms). The transmit callback generates a
+ * Q15 sawtooth per slot into one plane per slot and interleaves the planes into the period just
+ * sent, the receive callback splits the period just received back into Q15 planes (SAI_TDM) and
+ * tracks the peak level of each slot. The CPU only runs the callbacks.
  */
 
 #include "SAI.h"
+#include "SAI_DMA.h"
+#include "SAI_TDM.h"
 #include "device_registers.h"
 #include "clocks_and_modes.h"
 
+/* The 40 MHz bus clock has no integer divider to 8 kHz TDM8 frames of 32-bit words: DIV 9 gives
+ * 7812.5 Hz (-2.3 %), accepted here. 12.288 MHz on SAI_MCLK (PTD1) would give 8 kHz exactly. */
+#define SAI_RATE_TOL_PPM	(25000)
+#include "SAI_Rate.h"
+
+#define TDM_SLOTS			(8u)						/* TDM8 */
+#define TDM_FRAMES			(16u)						/* Frames per period, 2 ms at 8 kHz */
+#define TDM_PERIOD			(TDM_SLOTS * TDM_FRAMES)	/* Words per period (one line) */
+
+SAI_RATE(TDM_RATE, 40000000, 0, 8000, TDM_SLOTS, 32);		/* Bus clock, 8 kHz, 32-bit words */
+SAI_RATE_ASSERT(TDM_RATE);
+
+static const SAI_DMA_Format_t TDM_format =
+{
+	.slots           = TDM_SLOTS,
+	.bits            = 32u,
+	.msel            = TDM_RATE_MSEL,
+	.div             = TDM_RATE_DIV,						/* 40 MHz / 20 / 256 bits: 7.8 kHz frames */
+	.sync_width      = TDM_RATE_SYWD + 1u,
+	.bclk_active_low = 0u,
+	.slot_mask       = 0u,
+};
+
+uint32_t TDM_tx[2u * TDM_PERIOD];							/* Two periods each way */
+uint32_t TDM_rx[2u * TDM_PERIOD];
+SAI_DMA_Stream_t TDM_tx_stream;
+SAI_DMA_Stream_t TDM_rx_stream;
+int16_t TDM_tx_planes[TDM_SLOTS][TDM_FRAMES] __attribute__((aligned(4)));	/* One Q15 plane per slot */
+int16_t TDM_rx_planes[TDM_SLOTS][TDM_FRAMES] __attribute__((aligned(4)));
+uint16_t TDM_phase[TDM_SLOTS];								/* Sawtooth of each slot */
+uint16_t TDM_peak[TDM_SLOTS];								/* Peak level received on each slot */
+
+/*!
+* @brief Transmit callback: Q15 sawtooth of frequency proportional to (slot + 1) on each slot.
+*/
+static void TDM_generate(void * context, uint32_t * period, uint16_t words)
+{
+	uint32_t slot;
+	uint32_t frame;
+	(void)context;
+	(void)words;
+
+	for (slot = 0; slot < TDM_SLOTS; slot++)
+	{
+		for (frame = 0; frame < TDM_FRAMES; frame++)
+		{
+			TDM_phase[slot] += (uint16_t)((slot + 1u) << 8);
+			TDM_tx_planes[slot][frame] = (int16_t)TDM_phase[slot];
+		}
+	}
+	SAI_TDM_interleave_q15(&TDM_tx_planes[0][0], period, TDM_SLOTS, TDM_FRAMES);
+}
+
+/*!
+* @brief Receive callback: peak level of each slot, on the upper 16 bits of the samples.
+*/
+static void TDM_measure(void * context, uint32_t * period, uint16_t words)
+{
+	uint32_t slot;
+	uint32_t frame;
+	(void)context;
+	(void)words;
+
+	SAI_TDM_deinterleave_q15(period, &TDM_rx_planes[0][0], TDM_SLOTS, TDM_FRAMES);
+	for (slot = 0; slot < TDM_SLOTS; slot++)
+	{
+		for (frame = 0; frame < TDM_FRAMES; frame++)
+		{
+			int16_t sample = TDM_rx_planes[slot][frame];
+			uint16_t level = (sample < 0) ? (uint16_t)(-(sample + 1)) : (uint16_t)sample;
+			if (level > TDM_peak[slot])
+			{
+				TDM_peak[slot] = level;
+			}
+		}
+	}
+}
+
 void PORT_init (void)
 {
 	/*!
@@ -102,8 +188,10 @@ int main (void)
 	NormalRUNmode_80MHz();				/* Init clocks: 80 MHz sysclk & core, 40 MHz bus, 20 MHz flash */
 
 	PORT_init();						/* Configure ports */
-    SAI_init();							/* Initialize SAI Module */
-    SAI_transfer();						/* SAI transfer... */
+	SAI_DMA_format(SAI0, &TDM_format);	/* TDM8 frame, receiver synchronous to the transmitter */
+	SAI_DMA_init(&TDM_tx_stream, SAI0, 1u, 0u, 1u << 1, TDM_tx, TDM_PERIOD, TDM_generate, NULL);	/* TX on D1, DMA CH0 */
+	SAI_DMA_init(&TDM_rx_stream, SAI0, 0u, 1u, 1u << 0, TDM_rx, TDM_PERIOD, TDM_measure, NULL);	/* RX on D0, DMA CH1 */
+	SAI_DMA_start(&TDM_tx_stream, &TDM_rx_stream);	/* Both directions from the same frame */
 
 	/*!
 	* Infinite for:
@@ -112,3 +200,23 @@ int main (void)
 	{
 	}
 }
+
+void DMA0_IRQHandler (void)
+{
+	SAI_DMA_IRQHandler(&TDM_tx_stream);		/* Period sent: generate the next one */
+}
+
+void DMA1_IRQHandler (void)
+{
+	SAI_DMA_IRQHandler(&TDM_rx_stream);		/* Period received: measure it */
+}
+
+void SAI0_Tx_IRQHandler (void)
+{
+	SAI_DMA_ErrorIRQHandler(&TDM_tx_stream);	/* Transmit underrun */
+}
+
+void SAI0_Rx_IRQHandler (void)
+{
+	SAI_DMA_ErrorIRQHandler(&TDM_rx_stream);	/* Receive overrun */
+}
@@ -128,7 +128,7 @@ uint32_t ADC_channel_read (void)
 {
 	uint16_t adc_raw_result = 0;
 	adc_raw_result = ADC0 -> R[0];      						/* For SW trigger mode, R[0] is used */
-	return (uint32_t)((5000 * adc_raw_result) / 0xFFF); 		/* Convert result to mV for 0-5 V range */
+	return (adc_raw_result * ADC_MV_PER_LSB_Q16 + 0x8000u) >> 16;	/* Convert result to mV for 0-5 V range, rounded */
 }
 
 /*!
@@ -190,18 +190,20 @@ void ADC_calibration_init (int16_t gain, int16_t offset)
 
 /*! Configuration of 4 channels from the ADC0, those channels are
  * 	trigger from the PDB, the results are saved with the DMA.
- * 		ADC0->SC1[4] Pot
- * 		ADC0->SC1[5] Pot
- * 		ADC0->SC1[6] 3.3V (You must connect any voltage at PTB0)
- * 		ADC0->SC1[7] 3.3V (You must connect any voltage at PTB0)
+ * 		ADC0->SC1[2] Pot
+ * 		ADC0->SC1[3] Pot
+ * 		ADC0->SC1[4] 3.3V (You must connect any voltage at PTB0)
+ * 		ADC0->SC1[5] 3.3V (You must connect any voltage at PTB0)
+ * 	SC1[2..5] are used because R[2..5] is 16-byte aligned, which lets the
+ * 	DMA read the results with a source modulo.
  *
  * 		@param [uint8_t PotCh] Enters the Pot Channel of the EVB
  */
 void ADC_Config(uint8_t Pot_Ch){
+	ADC0->SC1[2] = ADC_SC1_ADCH_MASK;	/* Channel 2 is disabled */
+	ADC0->SC1[3] = ADC_SC1_ADCH_MASK;	/* Channel 3 is disabled */
 	ADC0->SC1[4] = ADC_SC1_ADCH_MASK;	/* Channel 4 is disabled */
 	ADC0->SC1[5] = ADC_SC1_ADCH_MASK;	/* Channel 5 is disabled */
-	ADC0->SC1[6] = ADC_SC1_ADCH_MASK;	/* Channel 6 is disabled */
-	ADC0->SC1[7] = ADC_SC1_ADCH_MASK;	/* Channel 7 is disabled */
 
 	ADC0->CFG1 = ADC_CFG1_ADIV(0)|	/* Divide ratio = 1 */
 				 ADC_CFG1_MODE(1);	/*	12-bit conversion */
@@ -211,10 +213,10 @@ void ADC_Config(uint8_t Pot_Ch){
 	ADC0->SC2 = ADC_SC2_ADTRG(1)|	/* ADTRG = 1: HW trigger */
 				ADC_SC2_DMAEN_MASK; /* DMA interrupt enable */
 
-	ADC0->SC1[4] = ADC_SC1_ADCH(Pot_Ch);	/* External channel as input (Pot) */
-	ADC0->SC1[5] = ADC_SC1_ADCH(Pot_Ch);	/* External channel as input (Pot) */
-	ADC0->SC1[6] = ADC_SC1_ADCH(4);		/* External channel 4 as input (voltage at PTB0) */
-	ADC0->SC1[7] = ADC_SC1_ADCH(4);		/* External channel 4 as input (voltage at PTB0) */
+	ADC0->SC1[2] = ADC_SC1_ADCH(Pot_Ch);	/* External channel as input (Pot) */
+	ADC0->SC1[3] = ADC_SC1_ADCH(Pot_Ch);	/* External channel as input (Pot) */
+	ADC0->SC1[4] = ADC_SC1_ADCH(4);		/* External channel 4 as input (voltage at PTB0) */
+	ADC0->SC1[5] = ADC_SC1_ADCH(4);		/* External channel 4 as input (voltage at PTB0) */
 	ADC0->SC3 = 0x00000000; 			/* Disable any configuration enabled of the calibration */
 }
 
@@ -33,6 +33,8 @@
 #ifndef ADC_H_
 #define ADC_H_
 
+#define ADC_MV_PER_LSB_Q16	(((5000u << 16) + (0xFFFu / 2u)) / 0xFFFu)	/* 0-5 V range, 12-bit: mV per LSB in Q16 */
+
 /* Public Function Prototypes*/
 
 void 	 ADC_channel_convert		(uint16_t adc_channel);
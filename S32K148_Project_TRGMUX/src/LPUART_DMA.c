@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2014 - 2016, Freescale Semiconductor, Inc.
+ * Copyright (c) 2016 - 2018, NXP.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP "AS IS" AND ANY EXPRESSED OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL NXP OR ITS CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "device_registers.h"	/* include peripheral declarations */
+#include "LPUART_DMA.h"
+
+/*!
+ * Description:
+ * ===================================================
+ * LPUARTn is left configured by its LPUARTn_init (clock, baud rate, pins). LPUART_DMA_init adds:
+ *
+ * 	TX: the application copies into tx_buf and returns at once. The TX channel, triggered by
+ * 	    TDMAE, sends the contiguous bytes between tail and head (or the end of the ring) one
+ * 	    byte per request; its major loop IRQ advances tail and starts the next block.
+ * 	RX: the RX channel, triggered by RDMAE, writes every received byte into rx_buf forever
+ * 	    (DLASTSGA wraps back to the start). The write position is rx_size - CITER and the
+ * 	    major loop IRQ counts the wraps, so the reader can tell how many bytes are pending
+ * 	    and whether the ring has overflowed. The idle line interrupt marks the end of frames.
+ *
+ * The handlers LPUART_DMA_IRQHandler, LPUART_DMA_TxIRQHandler and LPUART_DMA_RxIRQHandler
+ * are called from LPUARTn_RxTx_IRQHandler and the two DMAn_IRQHandler of the application.
+ */
+
+#define LPUART_STAT_W1C_MASK	(LPUART_STAT_LBKDIF_MASK | LPUART_STAT_RXEDGIF_MASK | LPUART_STAT_IDLE_MASK | \
+								 LPUART_STAT_OR_MASK | LPUART_STAT_NF_MASK | LPUART_STAT_FE_MASK | \
+								 LPUART_STAT_PF_MASK | LPUART_STAT_MA1F_MASK | LPUART_STAT_MA2F_MASK)
+
+static LPUART_Type * const LPUART_bases[] = LPUART_BASE_PTRS;
+static const IRQn_Type LPUART_irqs[] = LPUART_RX_TX_IRQS;
+
+static void NVIC_enable(IRQn_Type irq)
+{
+	S32_NVIC->ICPR[(uint32_t)irq >> 5u] = 1u << ((uint32_t)irq & 0x1Fu);	/* Clear any pending IR */
+	S32_NVIC->ISER[(uint32_t)irq >> 5u] = 1u << ((uint32_t)irq & 0x1Fu);	/* Enable IRQ */
+}
+
+/*!
+* @brief Start the TX channel on the bytes from tail up to head or the end of the ring.
+* Called with the channel idle, from the application or from the TX IRQ.
+*
+* @param[LPUART_DMA_t * port] Port
+*/
+static void LPUART_DMA_tx_start(LPUART_DMA_t * port)
+{
+	uint16_t head = port->tx_head;
+	uint16_t tail = port->tx_tail;
+	uint16_t length = (head >= tail) ? (uint16_t)(head - tail) : (uint16_t)(port->tx_mask + 1u - tail);
+	uint8_t ch = port->tx_ch;
+
+	port->tx_len = length;
+	if (length == 0u)
+	{
+		return;
+	}
+
+	DMA->TCD[ch].SADDR = DMA_TCD_SADDR_SADDR((uint32_t) &port->tx_buf[tail]);	/* Oldest byte not sent */
+	DMA->TCD[ch].SOFF = DMA_TCD_SOFF_SOFF(1);									/* Next byte of the ring */
+	DMA->TCD[ch].ATTR = DMA_TCD_ATTR_SSIZE(0) | DMA_TCD_ATTR_DSIZE(0);			/* 1 byte transfers */
+	DMA->TCD[ch].NBYTES.MLNO = DMA_TCD_NBYTES_MLNO_NBYTES(1);					/* 1 byte per TDMAE request */
+	DMA->TCD[ch].SLAST = 0;
+	DMA->TCD[ch].DADDR = DMA_TCD_DADDR_DADDR((uint32_t) &port->base->DATA);	/* LPUART transmit buffer */
+	DMA->TCD[ch].DOFF = DMA_TCD_DOFF_DOFF(0);
+	DMA->TCD[ch].CITER.ELINKNO = DMA_TCD_CITER_ELINKNO_CITER(length);
+	DMA->TCD[ch].BITER.ELINKNO = DMA_TCD_BITER_ELINKNO_BITER(length);
+	DMA->TCD[ch].DLASTSGA = 0;
+	DMA->TCD[ch].CSR = DMA_TCD_CSR_INTMAJOR_MASK |		/* IRQ after the block: advance tail */
+					   DMA_TCD_CSR_DREQ_MASK;			/* Stop requests after the block */
+	DMA->SERQ = DMA_SERQ_SERQ(ch);						/* Enable TDMAE requests for the channel */
+}
+
+/*!
+* @brief Attach ring buffers to an initialized LPUART and start reception.
+*
+* @param[LPUART_DMA_t * port] Port state
+* @param[LPUART_Type * base] LPUART0, LPUART1 or LPUART2, configured by its init function
+* @param[uint8_t tx_ch] DMA channel for transmission
+* @param[uint8_t rx_ch] DMA channel for reception
+* @param[uint8_t * tx_buf] Transmit ring
+* @param[uint16_t tx_size] Transmit ring size, power of 2
+* @param[uint8_t * rx_buf] Receive ring, NULL to leave reception to the blocking functions
+* @param[uint16_t rx_size] Receive ring size, power of 2
+*/
+void LPUART_DMA_init(LPUART_DMA_t * port, LPUART_Type * base, uint8_t tx_ch, uint8_t rx_ch,
+					 uint8_t * tx_buf, uint16_t tx_size, uint8_t * rx_buf, uint16_t rx_size)
+{
+	uint8_t instance = 0;
+
+	while ((instance < LPUART_INSTANCE_COUNT) && (LPUART_bases[instance] != base))
+	{
+		instance++;
+	}
+	DEV_ASSERT(instance < LPUART_INSTANCE_COUNT);
+	DEV_ASSERT((tx_size & (tx_size - 1u)) == 0u && tx_size <= 16384u);
+	DEV_ASSERT((rx_size & (rx_size - 1u)) == 0u && rx_size <= 16384u);
+
+	port->base        = base;
+	port->tx_ch       = tx_ch;
+	port->rx_ch       = rx_ch;
+	port->tx_buf      = tx_buf;
+	port->tx_mask     = (uint16_t)(tx_size - 1u);
+	port->tx_head     = 0;
+	port->tx_tail     = 0;
+	port->tx_len      = 0;
+	port->rx_buf      = rx_buf;
+	port->rx_mask     = (uint16_t)(rx_size - 1u);
+	port->rx_read     = 0;
+	port->rx_wraps    = 0;
+	port->rx_idle     = 0;
+	port->rx_overruns = 0;
+	port->tx_dropped  = 0;
+
+	SIM->PLATCGC |= SIM_PLATCGC_CGCDMA_MASK;			/* DMA Clock Gating Control Enable */
+	PCC->PCCn[PCC_DMAMUX_INDEX] |= PCC_PCCn_CGC_MASK;	/* Enable clock for DMAMUX */
+
+	DMAMUX->CHCFG[tx_ch] = 0;							/* Disable the channel to change the source */
+	DMAMUX->CHCFG[tx_ch] = DMAMUX_CHCFG_SOURCE(EDMA_REQ_LPUART0_TX + 2u * instance) | DMAMUX_CHCFG_ENBL_MASK;
+	NVIC_enable((IRQn_Type)(DMA0_IRQn + tx_ch));
+	base->BAUD |= LPUART_BAUD_TDMAE_MASK;				/* TDRE requests DMA */
+
+	if (rx_buf != NULL)
+	{
+		DMAMUX->CHCFG[rx_ch] = 0;
+		DMAMUX->CHCFG[rx_ch] = DMAMUX_CHCFG_SOURCE(EDMA_REQ_LPUART0_RX + 2u * instance) | DMAMUX_CHCFG_ENBL_MASK;
+
+		DMA->TCD[rx_ch].SADDR = DMA_TCD_SADDR_SADDR((uint32_t) &base->DATA);	/* LPUART receive buffer */
+		DMA->TCD[rx_ch].SOFF = DMA_TCD_SOFF_SOFF(0);
+		DMA->TCD[rx_ch].ATTR = DMA_TCD_ATTR_SSIZE(0) | DMA_TCD_ATTR_DSIZE(0);	/* 1 byte transfers */
+		DMA->TCD[rx_ch].NBYTES.MLNO = DMA_TCD_NBYTES_MLNO_NBYTES(1);			/* 1 byte per RDMAE request */
+		DMA->TCD[rx_ch].SLAST = 0;
+		DMA->TCD[rx_ch].DADDR = DMA_TCD_DADDR_DADDR((uint32_t) rx_buf);
+		DMA->TCD[rx_ch].DOFF = DMA_TCD_DOFF_DOFF(1);
+		DMA->TCD[rx_ch].CITER.ELINKNO = DMA_TCD_CITER_ELINKNO_CITER(rx_size);
+		DMA->TCD[rx_ch].BITER.ELINKNO = DMA_TCD_BITER_ELINKNO_BITER(rx_size);
+		DMA->TCD[rx_ch].DLASTSGA = DMA_TCD_DLASTSGA_DLASTSGA(-(int32_t)rx_size);	/* Wrap to the start of the ring */
+		DMA->TCD[rx_ch].CSR = DMA_TCD_CSR_INTMAJOR_MASK;	/* IRQ per wrap, DREQ = 0: never stops */
+		NVIC_enable((IRQn_Type)(DMA0_IRQn + rx_ch));
+		DMA->SERQ = DMA_SERQ_SERQ(rx_ch);
+
+		base->STAT = (base->STAT & ~LPUART_STAT_W1C_MASK) |
+					 LPUART_STAT_IDLE_MASK | LPUART_STAT_OR_MASK;	/* Clear stale flags */
+		base->CTRL |= LPUART_CTRL_IDLECFG(1) |		/* Idle after 2 idle characters */
+					  LPUART_CTRL_ILT_MASK |		/* Idle count starts after the stop bit */
+					  LPUART_CTRL_ILIE_MASK |		/* IRQ at idle line: end of frame */
+					  LPUART_CTRL_ORIE_MASK;		/* IRQ at overrun */
+		base->BAUD |= LPUART_BAUD_RDMAE_MASK;		/* RDRF requests DMA */
+		NVIC_enable(LPUART_irqs[instance]);
+	}
+}
+
+/*!
+* @brief Queue bytes for transmission without waiting.
+*
+* @param[LPUART_DMA_t * port] Port
+* @param[const void * data] Bytes to send
+* @param[uint16_t length] Number of bytes
+* @return Bytes queued, less than length if the ring is full
+*/
+uint16_t LPUART_DMA_write(LPUART_DMA_t * port, const void * data, uint16_t length)
+{
+	const uint8_t * bytes = (const uint8_t *) data;
+	uint16_t head = port->tx_head;
+	uint16_t space = (uint16_t)((port->tx_tail - head - 1u) & port->tx_mask);	/* One slot kept empty */
+	uint16_t count;
+
+	if (length > space)
+	{
+		length = space;
+	}
+	for (count = 0; count < length; count++)
+	{
+		port->tx_buf[head] = bytes[count];
+		head = (uint16_t)((head + 1u) & port->tx_mask);
+	}
+	port->tx_head = head;							/* Publish the bytes, then check the DMA */
+
+	if (port->tx_len == 0u)							/* The TX IRQ restarts the DMA when it is busy */
+	{
+		LPUART_DMA_tx_start(port);
+	}
+	return length;
+}
+
+/*!
+* @brief Queue a whole string or nothing, so log lines are never cut.
+*
+* @param[LPUART_DMA_t * port] Port
+* @param[const char * string] Null terminated string
+* @return Bytes queued: the string length, or 0 if it did not fit (counted in tx_dropped)
+*/
+uint16_t LPUART_DMA_puts(LPUART_DMA_t * port, const char * string)
+{
+	uint16_t length = 0;
+	uint16_t space = (uint16_t)((port->tx_tail - port->tx_head - 1u) & port->tx_mask);
+
+	while (string[length] != '\0')
+	{
+		length++;
+	}
+	if (length > space)
+	{
+		port->tx_dropped += length;
+		return 0;
+	}
+	return LPUART_DMA_write(port, string, length);
+}
+
+/*!
+* @brief Queue the decimal digits of a value, all or nothing like LPUART_DMA_puts.
+*
+* @param[LPUART_DMA_t * port] Port
+* @param[uint32_t value] Value to print
+* @return Bytes queued
+*/
+uint16_t LPUART_DMA_put_uint(LPUART_DMA_t * port, uint32_t value)
+{
+	char digits[11];								/* 4294967295 and the terminator */
+	uint8_t i = sizeof(digits) - 1u;
+
+	digits[i] = '\0';
+	do
+	{
+		digits[--i] = (char)('0' + (value % 10u));	/* Least significant digit first */
+		value /= 10u;
+	}
+	while (value != 0u);
+	return LPUART_DMA_puts(port, &digits[i]);
+}
+
+/*!
+* @brief Take received bytes without waiting. If the DMA has lapped the reader, the lost bytes
+* are counted in rx_overruns and reading resumes at the oldest byte still in the ring.
+*
+* @param[LPUART_DMA_t * port] Port
+* @param[void * data] Destination
+* @param[uint16_t length] Maximum number of bytes
+* @return Bytes copied
+*/
+uint16_t LPUART_DMA_read(LPUART_DMA_t * port, void * data, uint16_t length)
+{
+	uint8_t * bytes = (uint8_t *) data;
+	uint32_t size = port->rx_mask + 1u;
+	uint32_t wraps;
+	uint32_t written;
+	uint32_t pending;
+	uint16_t count;
+
+	do
+	{
+		wraps = port->rx_wraps;
+		written = wraps * size + (size - (DMA->TCD[port->rx_ch].CITER.ELINKNO & DMA_TCD_CITER_ELINKNO_CITER_MASK));
+	}
+	while (wraps != port->rx_wraps);				/* Wrap IRQ in between: read again */
+
+	pending = written - port->rx_read;
+	if ((int32_t)pending < 0)
+	{
+		return 0;									/* Wrapped, wrap IRQ not served yet */
+	}
+	if (pending > size)
+	{
+		port->rx_overruns += pending - size;
+		port->rx_read = written - size;
+		pending = size;
+	}
+	if (length > pending)
+	{
+		length = (uint16_t)pending;
+	}
+	for (count = 0; count < length; count++)
+	{
+		bytes[count] = port->rx_buf[(port->rx_read + count) & port->rx_mask];
+	}
+	port->rx_read += length;
+	return length;
+}
+
+/*!
+* @brief Take one received byte without waiting.
+*
+* @param[LPUART_DMA_t * port] Port
+* @return The byte, -1 if none is pending
+*/
+int16_t LPUART_DMA_getc(LPUART_DMA_t * port)
+{
+	uint8_t data;
+
+	return (LPUART_DMA_read(port, &data, 1) == 1u) ? (int16_t)data : -1;
+}
+
+/*!
+* @brief Check that everything queued has left the transmitter, e.g. before a reset.
+*
+* @param[LPUART_DMA_t * port] Port
+* @return 1 if the TX ring is empty and the last character is out
+*/
+uint8_t LPUART_DMA_tx_done(LPUART_DMA_t * port)
+{
+	return (port->tx_len == 0u) && ((port->base->STAT & LPUART_STAT_TC_MASK) != 0u);
+}
+
+/*!
+* @brief LPUARTn_RxTx_IRQHandler body: count idle lines and clear overruns.
+*
+* @param[LPUART_DMA_t * port] Port
+*/
+void LPUART_DMA_IRQHandler(LPUART_DMA_t * port)
+{
+	uint32_t stat = port->base->STAT;
+
+	if (stat & LPUART_STAT_IDLE_MASK)
+	{
+		port->rx_idle++;								/* End of a frame */
+	}
+	if (stat & LPUART_STAT_OR_MASK)
+	{
+		port->rx_overruns++;							/* DMA too late: one character lost */
+	}
+	port->base->STAT = (stat & ~LPUART_STAT_W1C_MASK) |
+					   (stat & (LPUART_STAT_IDLE_MASK | LPUART_STAT_OR_MASK));	/* Clear the flags served (W1C) */
+}
+
+/*!
+* @brief TX DMA channel IRQ body: the block is out, send what was queued meanwhile.
+*
+* @param[LPUART_DMA_t * port] Port
+*/
+void LPUART_DMA_TxIRQHandler(LPUART_DMA_t * port)
+{
+	DMA->CINT = DMA_CINT_CINT(port->tx_ch);			/* Clear Interruption request flag */
+	port->tx_tail = (uint16_t)((port->tx_tail + port->tx_len) & port->tx_mask);
+	LPUART_DMA_tx_start(port);
+}
+
+/*!
+* @brief RX DMA channel IRQ body: the ring has wrapped.
+*
+* @param[LPUART_DMA_t * port] Port
+*/
+void LPUART_DMA_RxIRQHandler(LPUART_DMA_t * port)
+{
+	DMA->CINT = DMA_CINT_CINT(port->rx_ch);			/* Clear Interruption request flag */
+	port->rx_wraps++;
+}
@@ -78,6 +78,8 @@
  * NOTE: To change the input voltage for the CMP0 sampling, connect with a jumper or cable, the
  *       CMP0_IN0 pin (PTA0) with the potentiometer output (PTC28) of the EVB
  *       To see the LPUART1 messages, TeraTerm or other software could be used.
+ *       The messages are queued in a ring buffer that DMA channel 0 feeds to LPUART1 (LPUART_DMA), so the
+ *       main loop only copies text and never waits for the transmitter.
  * */
 
 #include "device_registers.h" 							/* include peripheral declarations S32K148 */
@@ -85,6 +87,7 @@
 #include "LPIT.h"
 #include "acmp.h"
 #include "LPUART.h"
+#include "LPUART_DMA.h"
 
 #define PTA0  (0)
 #define PTE3  (3)
@@ -93,6 +96,11 @@
 #define PTE21 (21)
 #define PTE22 (22)
 
+#define UART1_TX_SIZE	256								/* Power of 2 */
+
+uint8_t UART1_tx[UART1_TX_SIZE];						/* Transmit ring of LPUART1 */
+LPUART_DMA_t UART1;
+
 
 /*!
 * @brief PORTn Initialization
@@ -160,6 +168,7 @@ int main (void)
 
 	/* LPUART1 Initialization at 9600 baud */
 	LPUART1_init ( );
+	LPUART_DMA_init (&UART1, LPUART1, 0, 1, UART1_tx, UART1_TX_SIZE, NULL, 0);	/* TX on DMA CH0, no reception */
 
 	/* Select CMP0_OUT (14) as trigger source for the LPUART1_TX */
 	/* Refer to the S32K1xx_Trigger_Muxing.xlsx attached in the Reference Manual */
@@ -189,7 +198,7 @@ int main (void)
 	*/
 	for(;;)
 	{
-		LPUART1_transmit_string("LPUART1_Tx triggered by CMP0_OUT\r\n");
+		LPUART_DMA_puts(&UART1, "LPUART1_Tx triggered by CMP0_OUT\r\n");	/* Queued only when the whole line fits */
 	}
 
 	return 0;
@@ -225,3 +234,8 @@ void CMP0_IRQHandler (void)
 		CMP0 -> C0 |= CMP_C0_CFF_MASK;					/* Clear Analog Comparator Flag Falling (W1C) */
 	}
 }
+
+void DMA0_IRQHandler (void)
+{
+	LPUART_DMA_TxIRQHandler(&UART1);					/* Block sent, start the next one */
+}